@@ -0,0 +1,229 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::DBBackend
+//
+// Interface for external sources of database files, as an alternative to
+// reading them from the DB_DIR directory tree. This is intended for large
+// numbers of batch jobs, where the directory searches and file accesses
+// on a shared file system become a bottleneck at job start.
+//
+// A backend delivers all database files valid for a run's date with a
+// single request. The files are written through to a local cache
+// directory (by default $TMPDIR/podd_dbcache), one subdirectory per date,
+// where OpenDBFile then finds them. Further jobs on the same node
+// analyzing the same date reuse the cached files without contacting the
+// backend again. Files not delivered by the backend are searched for in
+// the usual way.
+//
+// CommandDBBackend runs a shell command that writes a bundle of database
+// files to its standard output. This way, any type of calibration
+// service can be used without linking the analyzer against additional
+// client libraries, for example
+//
+//   Podd::SetDBBackend( new Podd::CommandDBBackend(
+//     "curl -sf 'https://calib.example.org/podd?date=%d&time=%t'" ) );
+//
+// In the command, %d is replaced by the date (yyyymmdd), %t by the time
+// (hhmmss), and %u by the Unix time of the run. The bundle format is
+//
+//   @@@ db_run.dat
+//   <contents of db_run.dat>
+//   @@@ db_R.vdc.dat
+//   <contents of db_R.vdc.dat>
+//   ...
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "DBBackend.h"
+#include "TDatime.h"
+#include "TError.h"
+#include "TString.h"   // for Form
+#include "TSystem.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include <utility>
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+CommandDBBackend::CommandDBBackend( string command )
+  : fCommand(std::move(command))
+{
+}
+
+//_____________________________________________________________________________
+Int_t CommandDBBackend::Fetch( const TDatime& date, FileMap_t& files )
+{
+  // Run the command for 'date' and parse its output as a bundle of
+  // database files
+
+  const char* const here = "CommandDBBackend::Fetch";
+
+  string cmd;
+  for( string::size_type i = 0; i < fCommand.size(); ++i ) {
+    char c = fCommand[i];
+    if( c == '%' && i + 1 < fCommand.size() ) {
+      char f = fCommand[++i];
+      if( f == 'd' ) cmd += Form("%08d", date.GetDate());
+      else if( f == 't' ) cmd += Form("%06d", date.GetTime());
+      else if( f == 'u' ) cmd += Form("%u", date.Convert());
+      else { cmd += c; cmd += f; }
+    } else
+      cmd += c;
+  }
+
+  FILE* pipe = popen(cmd.c_str(), "r");
+  if( !pipe ) {
+    ::Error(here, "Cannot run database backend command \"%s\"", cmd.c_str());
+    return -1;
+  }
+  string text;
+  char buf[4096];
+  size_t n;
+  while( (n = fread(buf, 1, sizeof(buf), pipe)) > 0 )
+    text.append(buf, n);
+  int status = pclose(pipe);
+  if( status != 0 ) {
+    ::Error(here, "Database backend command \"%s\" failed with status %d",
+            cmd.c_str(), status);
+    return -2;
+  }
+  if( ParseBundle(text, files) != 0 ) {
+    ::Error(here, "Invalid output from database backend command \"%s\"",
+            cmd.c_str());
+    return -3;
+  }
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t CommandDBBackend::ParseBundle( const string& text, FileMap_t& files )
+{
+  // Split a bundle of database files (see class description) into 'files'.
+  // Returns 0 on success, -1 if the bundle is malformed.
+
+  static const string marker = "@@@ ";
+
+  files.clear();
+  string* cur = nullptr;
+  string::size_type pos = 0;
+  while( pos < text.size() ) {
+    auto eol = text.find('\n', pos);
+    if( eol == string::npos )
+      eol = text.size();
+    if( text.compare(pos, marker.size(), marker) == 0 ) {
+      string name = text.substr(pos + marker.size(), eol - pos - marker.size());
+      // File names must be plain names, not paths
+      if( name.empty() || name.find('/') != string::npos || name[0] == '.' )
+        return -1;
+      cur = &files[name];
+      cur->clear();
+    } else if( cur ) {
+      cur->append(text, pos, eol - pos);
+      cur->append("\n");
+    } else if( eol > pos )
+      return -1;  // Data before the first file marker
+    pos = eol + 1;
+  }
+  return 0;
+}
+
+// Current backend and local cache state
+//FIXME: make thread-safe
+static DBBackend*               db_backend = nullptr;
+static string                   db_cachedir;
+static map<UInt_t, set<string>> db_fetched;  // Date -> files available
+
+//_____________________________________________________________________________
+void SetDBBackend( DBBackend* backend, const char* cachedir )
+{
+  db_backend = backend;
+  db_fetched.clear();
+  if( cachedir && *cachedir )
+    db_cachedir = cachedir;
+  else {
+    const char* tmp = gSystem->Getenv("TMPDIR");
+    db_cachedir = string((tmp && *tmp) ? tmp : "/tmp") + "/podd_dbcache";
+  }
+}
+
+//_____________________________________________________________________________
+static Int_t FetchFromBackend( const TDatime& date, set<string>& available )
+{
+  // Make the backend's database files for 'date' available in the local
+  // cache, either from an earlier fetch or by fetching them now
+
+  const char* const here = "Podd::FetchFromBackend";
+
+  string dir = db_cachedir + Form("/%08d_%06d", date.GetDate(), date.GetTime());
+  string index = dir + "/.complete";
+  ifstream ifs(index.c_str());
+  if( ifs ) {
+    // Cached by an earlier job
+    string name;
+    while( getline(ifs, name) )
+      if( !name.empty() ) available.insert(name);
+    return 0;
+  }
+
+  DBBackend::FileMap_t files;
+  if( db_backend->Fetch(date, files) != 0 )
+    return -1;
+  if( gSystem->mkdir(dir.c_str(), true) != 0 &&
+      gSystem->AccessPathName(dir.c_str()) ) {
+    ::Error(here, "Cannot create database cache directory %s", dir.c_str());
+    return -2;
+  }
+  // Write each file under a temporary name first so that concurrent jobs
+  // never see partial files
+  string pid = Form(".%d", gSystem->GetPid());
+  for( const auto& file : files ) {
+    string path = dir + "/" + file.first;
+    string tmp = path + pid;
+    ofstream ofs(tmp.c_str());
+    ofs << file.second;
+    ofs.close();
+    if( !ofs || rename(tmp.c_str(), path.c_str()) != 0 ) {
+      ::Error(here, "Cannot write database cache file %s", path.c_str());
+      return -3;
+    }
+    available.insert(file.first);
+  }
+  string tmp = index + pid;
+  ofstream ofs(tmp.c_str());
+  for( const auto& name : available )
+    ofs << name << endl;
+  ofs.close();
+  if( !ofs || rename(tmp.c_str(), index.c_str()) != 0 )
+    ::Warning(here, "Cannot write database cache index %s", index.c_str());
+  return 0;
+}
+
+//_____________________________________________________________________________
+string GetBackendDBFile( const string& filename, const TDatime& date )
+{
+  // Return the path of the local copy of database file 'filename' (e.g.
+  // "db_run.dat") for 'date' if the current backend provides it, or an
+  // empty string otherwise.
+
+  if( !db_backend )
+    return {};
+  auto it = db_fetched.find(date.Get());
+  if( it == db_fetched.end() ) {
+    set<string> available;
+    if( FetchFromBackend(date, available) != 0 )
+      ::Warning("Podd::GetBackendDBFile", "Database backend %s failed. "
+                "Using local database files.", db_backend->GetName());
+    it = db_fetched.emplace(date.Get(), std::move(available)).first;
+  }
+  if( it->second.find(filename) == it->second.end() )
+    return {};
+  return db_cachedir + Form("/%08d_%06d/", date.GetDate(), date.GetTime())
+    + filename;
+}
+
+} // namespace Podd
@@ -0,0 +1,58 @@
+#ifndef Podd_DBBackend_h_
+#define Podd_DBBackend_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::DBBackend
+//
+// Interface for external sources of database files
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <map>
+#include <string>
+
+class TDatime;
+
+namespace Podd {
+
+class DBBackend {
+
+public:
+  typedef std::map<std::string, std::string> FileMap_t; // File name -> contents
+
+  DBBackend() = default;
+  virtual ~DBBackend() = default;
+
+  // Fetch all database files valid for 'date' in one go.
+  // Returns 0 on success, <0 on error.
+  virtual Int_t       Fetch( const TDatime& date, FileMap_t& files ) = 0;
+  virtual const char* GetName() const = 0;
+};
+
+// Backend reading a bundle of database files from the output of a
+// shell command, e.g. curl querying an HTTP calibration service
+class CommandDBBackend : public DBBackend {
+
+public:
+  explicit CommandDBBackend( std::string command );
+
+  virtual Int_t       Fetch( const TDatime& date, FileMap_t& files );
+  virtual const char* GetName() const { return fCommand.c_str(); }
+
+  static Int_t ParseBundle( const std::string& text, FileMap_t& files );
+
+private:
+  std::string fCommand;  // Command template (%d = yyyymmdd, %t = hhmmss, %u = Unix time)
+};
+
+// Select 'backend' (owned by the caller, nullptr to disable) as the source
+// of database files. Fetched files are cached in 'cachedir'.
+void  SetDBBackend( DBBackend* backend, const char* cachedir = nullptr );
+// Local copy of database file 'filename' for 'date' from the backend, if any
+std::string GetBackendDBFile( const std::string& filename, const TDatime& date );
+
+} // namespace Podd
+
+#endif
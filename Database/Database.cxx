@@ -10,6 +10,8 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "Database.h"
+#include "DatabaseCache.h"
+#include "DBBackend.h"
 #include "TDatime.h"
 #include "TObjArray.h"
 #include "TObjString.h"
@@ -23,12 +25,19 @@
 #include <cctype>    // for isspace
 #include <cstring>
 #include <cstdlib>   // for atof, atoi
+#include <cmath>
 #include <iterator>  // for std::distance
 #include <iostream>
 #include <sstream>
 #include <limits>
 #include <algorithm>
 #include <map>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>  // for access
+#include <set>
+#include <thread>
+#include <atomic>
 
 using namespace std;
 
@@ -111,6 +120,34 @@ vector<string> GetDBFileList( const char* name, const TDatime& date, const char*
     return fnames;
   }
 
+  // Construct the database file name. It is of the form db_<prefix>.dat.
+  // Subdetectors use the same files as their parent detectors!
+  // If filename does not start with "db_", make it so
+  if( filename.substr(0,3) != "db_" )
+    filename.insert(0,"db_");
+    // If filename does not end with ".dat", make it so
+#ifndef NDEBUG
+  // should never happen
+  assert( filename.length() >= 4 );
+#else
+  if( filename.length() < 4 ) { fnames.clear(); return fnames; }
+#endif
+  if( *filename.rbegin() == '.' ) {
+    filename += "dat";
+  } else if( filename.substr(filename.length()-4) != ".dat" ) {
+    filename += ".dat";
+  }
+
+  // If a database backend is active and provides this file, use the
+  // local copy fetched from it, without searching the directories.
+  // A file in the current directory still takes precedence.
+  string remote = GetBackendDBFile(filename, date);
+  if( !remote.empty() ) {
+    fnames.push_back( filename );
+    fnames.push_back( remote );
+    return fnames;
+  }
+
   // Build search list of directories
   vector<string> dnames;
   if( const char* dbdir = gSystem->Getenv("DB_DIR"))
@@ -122,9 +159,11 @@ vector<string> GetDBFileList( const char* name, const TDatime& date, const char*
   // Try to open the database directories in the search list.
   // The first directory that can be opened is taken as the database
   // directory. Subsequent directories are ignored.
+  // Directory listings are cached across calls, see DatabaseCache.
+  auto& cache = DatabaseCache::Instance();
+  const DatabaseCache::Directory_t* dir = nullptr;
   auto it = dnames.begin();
-  void* dirp = nullptr;
-  while( !(dirp = gSystem->OpenDirectory((*it).c_str())) &&
+  while( !(dir = cache.GetDirectory(*it)) &&
          (++it != dnames.end()) ) {}
 
   // None of the directories can be opened?
@@ -137,26 +176,13 @@ vector<string> GetDBFileList( const char* name, const TDatime& date, const char*
   string thedir = *it;
 
   // In the database directory, get the names of all subdirectories matching
-  // a YYYYMMDD pattern.
-  vector<string> time_dirs;
-  bool have_defaultdir = false;
-  while( const char* result = gSystem->GetDirEntry(dirp) ) {
-    string item = result;
-    if( item.length() == 8 ) {
-      Int_t pos = 0;
-      for( ; pos<8; ++pos )
-        if( !isdigit(item[pos])) break;
-      if( pos==8 )
-        time_dirs.push_back( item );
-    } else if ( item == defaultdir )
-      have_defaultdir = true;
-  }
-  gSystem->FreeDirectory(dirp);
+  // a YYYYMMDD pattern (already sorted).
+  vector<string> time_dirs = dir->time_dirs;
+  bool have_defaultdir = dir->have_defaultdir;
 
   // Search a date-coded subdirectory that corresponds to the requested date.
   bool found = false;
   if( !time_dirs.empty() ) {
-    sort( time_dirs.begin(), time_dirs.end() );
     for( it = time_dirs.begin(); it != time_dirs.end(); ++it ) {
       Int_t item_date = atoi((*it).c_str());
       if( it == time_dirs.begin() && date.GetDate() < item_date )
@@ -174,24 +200,6 @@ vector<string> GetDBFileList( const char* name, const TDatime& date, const char*
     }
   }
 
-  // Construct the database file name. It is of the form db_<prefix>.dat.
-  // Subdetectors use the same files as their parent detectors!
-  // If filename does not start with "db_", make it so
-  if( filename.substr(0,3) != "db_" )
-    filename.insert(0,"db_");
-    // If filename does not end with ".dat", make it so
-#ifndef NDEBUG
-  // should never happen
-  assert( filename.length() >= 4 );
-#else
-  if( filename.length() < 4 ) { fnames.clear(); return fnames; }
-#endif
-  if( *filename.rbegin() == '.' ) {
-    filename += "dat";
-  } else if( filename.substr(filename.length()-4) != ".dat" ) {
-    filename += ".dat";
-  }
-
   // Build the searchlist of file names in the order:
   // ./filename <dbdir>/<date-dir>/filename
   //    <dbdir>/DEFAULT/filename <dbdir>/filename
@@ -209,6 +217,13 @@ vector<string> GetDBFileList( const char* name, const TDatime& date, const char*
   return fnames;
 }
 
+// Recording of opened database files, see StartDBFileRecording()
+//FIXME: make thread-safe
+static bool db_recording = false;
+static vector<DBFileInfo> db_recorded;
+static void RecordDBFile( const char* name, const char* path );
+static Int_t GetDBFileInfo( const string& path, DBFileInfo& info, bool scan );
+
 //_____________________________________________________________________________
 FILE* OpenDBFile( const char* name, const TDatime& date,  const char* here,
                   const char* filemode, int debug_flag, const char*& openpath )
@@ -242,9 +257,16 @@ FILE* OpenDBFile( const char* name, const TDatime& date,  const char* here,
         cout << "<" << here << ">: Opened database file " << *it << endl;
       // continue until we succeed
     } while( !fi && ++it != fnames.end() );
-    if( fi )
+    if( fi ) {
       openpath = (*it).c_str();
+      // Let LoadDBvalue find a binary snapshot of this file, if any
+      struct stat st{};
+      if( fstat(fileno(fi), &st) == 0 )
+        DatabaseCache::Instance().SetFilePath(st.st_dev, st.st_ino, *it);
+    }
   }
+  if( db_recording )
+    RecordDBFile(name, openpath);
   if( !fi && debug_flag > 0 ) {
     ::Error(here, "Cannot open database file db_%s%sdat", name,
             (name[strlen(name) - 1] == '.' ? "" : "."));
@@ -523,22 +545,14 @@ Int_t ReadDBline( FILE* file, char* buf, Int_t bufsiz, string& line )
 }
 
 //_____________________________________________________________________________
-Int_t LoadDBvalue( FILE* file, const TDatime& date, const char* key, string& text )
+static Int_t ScanDBvalue( FILE* file, const TDatime& date, const char* key, string& text )
 {
-  // Load a data value tagged with 'key' from the database 'file'.
-  // Lines starting with "#" are ignored.
-  // If 'key' is found, then the most recent value seen (based on time stamps
-  // and position within the file) is returned in 'text'.
-  // Values with time stamps later than 'date' are ignored.
-  // This allows incremental organization of the database where
-  // only changes are recorded with time stamps.
-  // Return 0 if success, 1 if key not found, <0 if unexpected error.
+  // Find 'key' by scanning the entire database 'file'. This is the fallback
+  // for files that cannot be cached, see LoadDBvalue.
 
-  if( !file || !key ) return -255;
   TDatime keydate(950101, 0), prevdate(950101, 0);
 
   errno = 0;
-  errtxt.clear();
   rewind(file);
 
   static const Int_t bufsiz = 256;
@@ -577,6 +591,226 @@ Int_t LoadDBvalue( FILE* file, const TDatime& date, const char* key, string& tex
   return found ? 0 : 1;
 }
 
+// Parsed database files used by LoadDBvalue are kept in DatabaseCache.
+// Each file is read and split into lines just once. The key/value pairs
+// and time stamps are pre-parsed so that looking up a key needs to visit
+// only the lines with candidate keys and the time stamps.
+namespace {
+typedef DatabaseCache::Line_t DBLine_t;
+typedef DatabaseCache::File_t DBFileCache_t;
+
+//_____________________________________________________________________________
+void ParseDBline( const string& line, DBLine_t& dbl, bool warn )
+{
+  // Split database 'line' into key & value and/or time stamp, following the
+  // same rules as IsDBkey and IsDBdate
+
+  const char* ln = line.c_str();
+  const char* eq = strchr(ln, '=');
+  if( eq ) {
+    dbl.has_eq = true;
+    while( *ln == ' ' ) ++ln;
+    if( ln != eq ) {
+      const char* p = eq - 1;
+      while( *p == ' ' ) --p;
+      dbl.key.assign(ln, p - ln + 1);
+    }
+    ln = eq + 1;
+    while( *ln == ' ' ) ++ln;
+    dbl.value = ln;
+  }
+  dbl.is_date = (IsDBdate(line, dbl.date, warn && !eq) != 0);
+}
+
+//_____________________________________________________________________________
+Int_t ParseDBFile( FILE* file, DBFileCache_t& cache )
+{
+  // Read all lines of database 'file' into 'cache'.
+  // Returns 0 on success, -1 on read error.
+
+  errno = 0;
+  rewind(file);
+  static const Int_t bufsiz = 256;
+  char* buf = new char[bufsiz];
+  string dbline;
+  while( ReadDBline(file, buf, bufsiz, dbline) != EOF ) {
+    if( dbline.empty() ) continue;
+    auto idx = static_cast<UInt_t>(cache.lines.size());
+    cache.lines.emplace_back();
+    DBLine_t& dbl = cache.lines.back();
+    if( dbline.find("${") != string::npos ) {
+      // Text variable substitution depends on the current text variables
+      dbl.is_raw = true;
+      dbl.value = dbline;
+      cache.special.push_back(idx);
+      continue;
+    }
+    ParseDBline(dbline, dbl, true);
+    if( !dbl.key.empty() )
+      cache.keys[dbl.key].push_back(idx);
+    if( dbl.is_date )
+      cache.special.push_back(idx);
+  }
+  delete[] buf;
+  if( errno ) {
+    perror("LoadDBvalue");
+    return -1;
+  }
+  return 0;
+}
+
+//_____________________________________________________________________________
+string DBSnapshotName( const string& path )
+{
+  // Name of the binary snapshot of database file 'path'
+  return path + ".snap";
+}
+
+//_____________________________________________________________________________
+Int_t LoadDBSnapshot( const string& path, const struct stat& st,
+                      DBFileCache_t& cache )
+{
+  // Load the binary snapshot of the database file 'path', which has file
+  // status 'st', into 'cache'. The snapshot is used only if it was made
+  // from the current contents of the file.
+  // Returns 0 on success, <0 if no valid snapshot is available.
+
+  string snapname = DBSnapshotName(path);
+  if( access(snapname.c_str(), R_OK) != 0 )
+    return -1;  // No snapshot (may be called from PreloadDBFiles threads)
+  DBFileCache_t snap;
+  DatabaseCache::SnapshotInfo_t info;
+  if( DatabaseCache::ReadSnapshot(snapname, snap, info) != 0 ) {
+    ::Warning("LoadDBSnapshot", "Ignoring invalid database snapshot %s",
+              snapname.c_str());
+    return -2;
+  }
+  if( info.size != st.st_size )
+    return -3;
+  if( info.mtime != st.st_mtime ) {
+    // Probably copied without preserving times. Check the contents.
+    DBFileInfo current;
+    if( GetDBFileInfo(path, current, true) != 0 || current.hash != info.hash )
+      return -3;
+  }
+  cache = std::move(snap);
+  return 0;
+}
+
+//_____________________________________________________________________________
+const DBFileCache_t* GetDBFileCache( FILE* file, Int_t& err )
+{
+  // Get the parsed contents of database 'file', parsing the file if it is
+  // not yet in the cache or has changed since last parsed. If the file
+  // was opened via OpenDBFile and has an up-to-date binary snapshot,
+  // the snapshot is loaded instead of parsing the file.
+  // Returns nullptr if the file cannot be cached (e.g. if it is a pipe)
+  // and sets 'err' < 0 if a read error occurred.
+
+  err = 0;
+  struct stat st{};
+  if( fstat(fileno(file), &st) != 0 || !S_ISREG(st.st_mode) )
+    return nullptr;
+  auto& dbcache = DatabaseCache::Instance();
+  if( const auto* c = dbcache.FindFile(st.st_dev, st.st_ino, st.st_mtime,
+                                       st.st_ctime, st.st_size) )
+    return c;
+
+  DBFileCache_t cache;
+  const string& path = dbcache.GetFilePath(st.st_dev, st.st_ino);
+  if( path.empty() || LoadDBSnapshot(path, st, cache) != 0 ) {
+    if( (err = ParseDBFile(file, cache)) != 0 )
+      return nullptr;
+  }
+  cache.mtime = st.st_mtime;
+  cache.ctime = st.st_ctime;
+  cache.size  = st.st_size;
+  return dbcache.StoreFile(st.st_dev, st.st_ino, std::move(cache));
+}
+
+} // end anonymous namespace
+
+//_____________________________________________________________________________
+Int_t LoadDBvalue( FILE* file, const TDatime& date, const char* key, string& text )
+{
+  // Load a data value tagged with 'key' from the database 'file'.
+  // Lines starting with "#" are ignored.
+  // If 'key' is found, then the most recent value seen (based on time stamps
+  // and position within the file) is returned in 'text'.
+  // Values with time stamps later than 'date' are ignored.
+  // This allows incremental organization of the database where
+  // only changes are recorded with time stamps.
+  // Return 0 if success, 1 if key not found, <0 if unexpected error.
+  //
+  // The contents of regular files are parsed once and cached until the file
+  // is modified. On return, the file is positioned at its end.
+
+  if( !file || !key ) return -255;
+
+  errtxt.clear();
+
+  Int_t err = 0;
+  const DBFileCache_t* cache = GetDBFileCache(file, err);
+  if( err )
+    return err;
+  if( !cache )
+    return ScanDBvalue(file, date, key, text);
+  fseek(file, 0, SEEK_END);
+
+  // Lines to visit in file order: lines with keys matching 'key' (IsDBkey
+  // matches keys that are a leading part of 'key'), time stamps, and
+  // lines that need text variable substitution
+  vector<UInt_t> visit(cache->special);
+  size_t keylen = strlen(key);
+  string keystr;
+  keystr.reserve(keylen);
+  for( size_t i = 0; i < keylen; ++i ) {
+    keystr += key[i];
+    auto it = cache->keys.find(keystr);
+    if( it != cache->keys.end() )
+      visit.insert(visit.end(), it->second.begin(), it->second.end());
+  }
+  sort(visit.begin(), visit.end());
+  visit.erase(unique(visit.begin(), visit.end()), visit.end());
+
+  TDatime keydate(950101, 0), prevdate(950101, 0);
+  bool found = false, do_ignore = false;
+  vector<string> lines;
+  DBLine_t subst;
+  for( auto idx : visit ) {
+    const DBLine_t* dbl = &cache->lines[idx];
+    size_t nsubst = 1;
+    if( dbl->is_raw ) {
+      lines.assign(1, dbl->value);
+      if( gHaTextvars )
+        gHaTextvars->Substitute(lines);
+      nsubst = lines.size();
+    }
+    for( size_t j = 0; j < nsubst; ++j ) {
+      if( dbl->is_raw || j > 0 ) {
+        subst = DBLine_t();
+        ParseDBline(lines[j], subst, true);
+        dbl = &subst;
+      }
+      if( !do_ignore && dbl->has_eq ) {
+        // Same matching rule as IsDBkey
+        const string& k = dbl->key;
+        if( !k.empty() && k.size() <= keylen &&
+            strncmp(k.c_str(), key, k.size()) == 0 ) {
+          // Found a matching key for a newer date than before
+          text = dbl->value;
+          found = true;
+          prevdate = keydate;
+        }
+      } else if( dbl->is_date ) {
+        keydate = dbl->date;
+        do_ignore = (keydate > date || keydate < prevdate);
+      }
+    }
+  }
+  return found ? 0 : 1;
+}
+
 //_____________________________________________________________________________
 Int_t LoadDBvalue( FILE* file, const TDatime& date, const char* key, Double_t& value )
 {
@@ -619,14 +853,129 @@ Int_t LoadDBvalue( FILE* file, const TDatime& date, const char* key, TString& te
   return err;
 }
 
+// Conversion of database values to arrays of numbers.
+// For the common types, the conversion is done directly on the text with
+// the C library functions. The syntax accepted and the results are the same
+// as with reading the values one by one from an istringstream, which is
+// what is done for all other types.
+namespace {
+//_____________________________________________________________________________
+inline const char* SkipSpace( const char* p )
+{
+  while( isspace(static_cast<unsigned char>(*p)) ) ++p;
+  return p;
+}
+
+//_____________________________________________________________________________
+inline const char* ScanDigits( const char* p )
+{
+  while( isdigit(static_cast<unsigned char>(*p)) ) ++p;
+  return p;
+}
+
+//_____________________________________________________________________________
+const char* ScanFloat( const char* p )
+{
+  // Return end of the floating-point number starting at 'p', following
+  // the grammar of std::num_get: [sign] digits [. digits] [e [sign] digits]
+
+  const char* q = p;
+  if( *q == '+' || *q == '-' ) ++q;
+  const char* m = ScanDigits(q);
+  bool mantissa = (m != q);
+  if( *m == '.' ) {
+    const char* f = ScanDigits(m + 1);
+    mantissa = mantissa || (f != m + 1);
+    m = f;
+  }
+  if( mantissa && (*m == 'e' || *m == 'E') ) {
+    ++m;
+    if( *m == '+' || *m == '-' ) ++m;
+    m = ScanDigits(m);
+  }
+  return m;
+}
+
+//_____________________________________________________________________________
+inline Bool_t ParseValue( const char*& p, Double_t& val, string& tok )
+{
+  p = SkipSpace(p);
+  const char* e = ScanFloat(p);
+  if( e == p ) return false;
+  tok.assign(p, e);
+  char* end = nullptr;
+  errno = 0;
+  val = strtod(tok.c_str(), &end);
+  if( *end || (errno == ERANGE && std::abs(val) == HUGE_VAL) )
+    return false;
+  p = e;
+  return true;
+}
+
+//_____________________________________________________________________________
+inline Bool_t ParseValue( const char*& p, Float_t& val, string& tok )
+{
+  p = SkipSpace(p);
+  const char* e = ScanFloat(p);
+  if( e == p ) return false;
+  tok.assign(p, e);
+  char* end = nullptr;
+  errno = 0;
+  val = strtof(tok.c_str(), &end);
+  if( *end || (errno == ERANGE && std::abs(val) == HUGE_VALF) )
+    return false;
+  p = e;
+  return true;
+}
+
+//_____________________________________________________________________________
+inline Bool_t ParseValue( const char*& p, Int_t& val, string& )
+{
+  p = SkipSpace(p);
+  const char* q = p;
+  bool neg = (*q == '-');
+  if( *q == '+' || *q == '-' ) ++q;
+  const char* e = ScanDigits(q);
+  if( e == q ) return false;
+  Long64_t v = 0;
+  for( ; q != e; ++q ) {
+    v = 10 * v + (*q - '0');
+    if( v > static_cast<Long64_t>(kMaxInt) + 1 ) return false;
+  }
+  if( neg ) v = -v;
+  if( v > kMaxInt || v < kMinInt ) return false;
+  val = static_cast<Int_t>(v);
+  p = e;
+  return true;
+}
+
 //_____________________________________________________________________________
 template<class T>
-Int_t LoadDBarray( FILE* file, const TDatime& date, const char* key, vector <T>& values )
+void ParseDBarray( const string& text, vector<T>& values )
 {
-  string text;
-  Int_t err = LoadDBvalue(file, date, key, text);
-  if( err )
-    return err;
+  // Fast conversion for Double_t, Float_t, and Int_t
+
+  // Preallocate for the number of whitespace-separated items
+  size_t n = 0;
+  for( const char* p = SkipSpace(text.c_str()); *p; p = SkipSpace(p) ) {
+    ++n;
+    while( *p && !isspace(static_cast<unsigned char>(*p)) ) ++p;
+  }
+  values.clear();
+  values.reserve(n);
+  string tok;
+  const char* p = text.c_str();
+  T val;
+  while( ParseValue(p, val, tok) )
+    values.push_back(val);
+}
+
+//_____________________________________________________________________________
+template<class T>
+void StreamDBarray( string text, vector<T>& values )
+{
+  // Generic conversion using istringstream
+
   values.clear();
   text += " ";
   istringstream inp(text);
@@ -638,6 +987,37 @@ Int_t LoadDBarray( FILE* file, const TDatime& date, const char* key, vector <T>&
     else
       break;
   }
+}
+
+template<class T>
+inline void ConvertDBarray( const string& text, vector<T>& values )
+{
+  StreamDBarray(text, values);
+}
+inline void ConvertDBarray( const string& text, vector<Double_t>& values )
+{
+  ParseDBarray(text, values);
+}
+inline void ConvertDBarray( const string& text, vector<Float_t>& values )
+{
+  ParseDBarray(text, values);
+}
+inline void ConvertDBarray( const string& text, vector<Int_t>& values )
+{
+  ParseDBarray(text, values);
+}
+
+} // end anonymous namespace
+
+//_____________________________________________________________________________
+template<class T>
+Int_t LoadDBarray( FILE* file, const TDatime& date, const char* key, vector <T>& values )
+{
+  string text;
+  Int_t err = LoadDBvalue(file, date, key, text);
+  if( err )
+    return err;
+  ConvertDBarray(text, values);
   return 0;
 }
 
@@ -961,6 +1341,96 @@ nextitem:
   return ret;
 }
 
+//_____________________________________________________________________________
+static const DatabaseCache::TagIndex_t* GetTagIndex( FILE* file, off_t pos )
+{
+  // Get the index of tag lines of database 'file' for use by SeekDBdate and
+  // SeekDBconfig, building it if necessary. Returns nullptr if no index is
+  // available (e.g. because the file is not a regular file) or if 'pos'
+  // is not at the start of an indexed line. In that case, the caller
+  // must scan the file sequentially.
+
+  auto& dbcache = DatabaseCache::Instance();
+  struct stat st{};
+  if( pos < 0 || !dbcache.IsEnabled() || fstat(fileno(file), &st) != 0 ||
+      !S_ISREG(st.st_mode) )
+    return nullptr;
+  const DatabaseCache::TagIndex_t* index =
+    dbcache.FindTagIndex(st.st_dev, st.st_ino, st.st_mtime, st.st_ctime,
+                         st.st_size);
+  if( !index ) {
+    DatabaseCache::TagIndex_t newindex;
+    newindex.mtime = st.st_mtime;
+    newindex.ctime = st.st_ctime;
+    newindex.size  = st.st_size;
+    // Read the file in the same way as the sequential scans do
+    errno = 0;
+    rewind(file);
+    const int LEN = 256;
+    char buf[LEN];
+    off_t start = 0;
+    while( !errno && fgets(buf, LEN, file) ) {
+      off_t end = ftello(file);
+      newindex.starts.push_back(start);
+      size_t len = strlen(buf);
+      if( len >= 2 && buf[0] != '#' && strchr(buf, '[') ) {
+        if( buf[len - 1] == '\n' ) buf[len - 1] = 0;
+        DatabaseCache::Tag_t tag;
+        tag.start = start;
+        tag.end = end;
+        tag.text = buf;
+        tag.is_date = (IsDBdate(tag.text, tag.date, false) != 0);
+        newindex.tags.push_back(std::move(tag));
+      }
+      start = end;
+    }
+    bool ok = (errno == 0);
+    if( fseeko(file, pos, SEEK_SET) || !ok )
+      return nullptr;
+    index = dbcache.StoreTagIndex(st.st_dev, st.st_ino, std::move(newindex));
+  }
+  if( !binary_search(index->starts.begin(), index->starts.end(), pos) )
+    return nullptr;
+  return index;
+}
+
+//_____________________________________________________________________________
+static vector<DatabaseCache::Tag_t>::const_iterator
+FirstTag( const DatabaseCache::TagIndex_t* index, off_t pos )
+{
+  // First tag line at or after file position 'pos'
+
+  return lower_bound(index->tags.begin(), index->tags.end(), pos,
+                     []( const DatabaseCache::Tag_t& tag, off_t p ) {
+                       return tag.start < p;
+                     });
+}
+
+// Result of testing a line for a configuration tag
+enum EConfigTag { kNoConfigTag = 0, kOtherConfigTag, kConfigTagFound };
+
+//_____________________________________________________________________________
+static EConfigTag MatchConfigTag( const char* buf, const string& label,
+                                  const char* tag )
+{
+  // Check if the database line 'buf' is a configuration tag with the given
+  // 'label' (e.g. "[config=") and, if so, whether it is equal to 'tag'
+
+  char* cbuf = ::Compress(buf);
+  string line(cbuf);
+  delete[] cbuf;
+  auto llen = label.size();
+  auto lbrk = line.find(label);
+  if( lbrk != string::npos && lbrk + llen < line.size() ) {
+    auto rbrk = line.find(']', lbrk + llen);
+    if( rbrk != string::npos &&
+        line.substr(lbrk + llen, rbrk - lbrk - llen) == tag )
+      return kConfigTagFound;
+    return kOtherConfigTag;
+  }
+  return kNoConfigTag;
+}
+
 //_____________________________________________________________________________
 Int_t SeekDBconfig( FILE* file, const char* tag, const char* label,
                     Bool_t end_on_tag )
@@ -972,6 +1442,7 @@ Int_t SeekDBconfig( FILE* file, const char* tag, const char* label,
   // Return zero if not found, 1 otherwise.
   //
   // Configuration tags have the form [ config=tag ].
+  // Regular files are scanned using a cached index of their tag lines.
   // If 'label' is given explicitly, it replaces 'config' in the tag string,
   // for example label="version" will search for [ version=tag ].
   // If 'label' is empty (""), search for just [ tag ].
@@ -990,12 +1461,28 @@ Int_t SeekDBconfig( FILE* file, const char* tag, const char* label,
     _label.append(label);
     _label.append("=");
   }
-  auto llen = _label.size();
 
   bool found = false;
 
   errno = 0;
   off_t pos = ftello(file);
+  if( const auto* index = GetTagIndex(file, pos) ) {
+    // Only lines with tags need to be checked
+    for( auto it = FirstTag(index, pos); it != index->tags.end(); ++it ) {
+      EConfigTag m = MatchConfigTag(it->text.c_str(), _label, tag);
+      if( m == kConfigTagFound ) {
+        if( fseeko(file, it->end, SEEK_SET) ) {
+          perror(here);
+          break;
+        }
+        return 1;
+      } else if( m == kNoConfigTag && end_on_tag && IsTag(it->text.c_str()) )
+        break;
+    }
+    if( fseeko(file, pos, SEEK_SET) )
+      perror(here);
+    return 0;
+  }
   if( pos != -1 ) {
     bool quit = false;
     const int LEN = 256;
@@ -1004,18 +1491,11 @@ Int_t SeekDBconfig( FILE* file, const char* tag, const char* label,
       size_t len = strlen(buf);
       if( len < 2 || buf[0] == '#' ) continue;      //skip comments
       if( buf[len - 1] == '\n' ) buf[len - 1] = 0;     //delete trailing newline
-      char* cbuf = ::Compress(buf);
-      string line(cbuf);
-      delete[] cbuf;
-      auto lbrk = line.find(_label);
-      if( lbrk != string::npos && lbrk + llen < line.size() ) {
-        auto rbrk = line.find(']', lbrk + llen);
-        if( rbrk == string::npos ) continue;
-        if( line.substr(lbrk + llen, rbrk - lbrk - llen) == tag ) {
-          found = true;
-          break;
-        }
-      } else if( end_on_tag && IsTag(buf) )
+      EConfigTag m = MatchConfigTag(buf, _label, tag);
+      if( m == kConfigTagFound ) {
+        found = true;
+        break;
+      } else if( m == kNoConfigTag && end_on_tag && IsTag(buf) )
         quit = true;
     }
   }
@@ -1060,6 +1540,18 @@ Int_t SeekDBdate( FILE* file, const TDatime& date, Bool_t end_on_tag )
   }
   off_t foundpos = -1;
   bool found = false, quit = false;
+  if( const auto* index = GetTagIndex(file, pos) ) {
+    // Only lines with tags need to be checked
+    for( auto it = FirstTag(index, pos); it != index->tags.end(); ++it ) {
+      if( it->is_date && it->date <= date && it->date >= prevdate ) {
+        prevdate = it->date;
+        foundpos = it->end;
+        found = true;
+      } else if( end_on_tag && IsTag(it->text.c_str()) )
+        break;
+    }
+    quit = true;  // skip sequential scan
+  }
   while( !errno && !quit && fgets(buf, LEN, file) ) {
     size_t len = strlen(buf);
     if( len < 2 || buf[0] == '#' ) continue;
@@ -1084,5 +1576,248 @@ Int_t SeekDBdate( FILE* file, const TDatime& date, Bool_t end_on_tag )
   return found;
 }
 
+//_____________________________________________________________________________
+static Int_t GetDBFileInfo( const string& path, DBFileInfo& info, bool scan )
+{
+  // Get modification time and size of the file 'path'. If 'scan' is true,
+  // also hash the contents and collect the time stamps in the file.
+  // Returns 0 on success, -1 if the file cannot be accessed.
+
+  struct stat st{};
+  if( stat(path.c_str(), &st) != 0 )
+    return -1;
+  info.mtime = st.st_mtime;
+  info.size  = st.st_size;
+  if( !scan )
+    return 0;
+
+  ifstream ifs(path.c_str(), ios::binary);
+  if( !ifs )
+    return -1;
+  ULong64_t h = 14695981039346656037ULL;  // FNV-1a
+  string line;
+  TDatime tagdate;
+  info.tags.clear();
+  while( getline(ifs, line) ) {
+    for( char c : line ) {
+      h ^= static_cast<unsigned char>(c);
+      h *= 1099511628211ULL;
+    }
+    h ^= '\n';
+    h *= 1099511628211ULL;
+    if( line.find('[') != string::npos && IsDBdate(line, tagdate, false) )
+      info.tags.push_back(tagdate.Get());
+  }
+  info.hash = h;
+  return 0;
+}
+
+//_____________________________________________________________________________
+static void RecordDBFile( const char* name, const char* path )
+{
+  // Add the database file 'name', found at 'path' (nullptr if none found),
+  // to the list of recorded files
+
+  DBFileInfo info;
+  info.name = name;
+  if( path ) {
+    info.path = path;
+    if( GetDBFileInfo(info.path, info, true) != 0 )
+      info.path.clear();
+  }
+  db_recorded.push_back(std::move(info));
+}
+
+//_____________________________________________________________________________
+void StartDBFileRecording()
+{
+  // Start recording all database files opened via OpenDBFile.
+  // Recording is not nested; starting again discards the current record.
+
+  db_recorded.clear();
+  db_recording = true;
+}
+
+//_____________________________________________________________________________
+vector<DBFileInfo> StopDBFileRecording()
+{
+  // Stop recording and return the database files opened since
+  // StartDBFileRecording()
+
+  db_recording = false;
+  vector<DBFileInfo> ret;
+  ret.swap(db_recorded);
+  return ret;
+}
+
+//_____________________________________________________________________________
+Bool_t DBFilesUnchanged( const vector<DBFileInfo>& files,
+                         const TDatime& olddate, const TDatime& newdate )
+{
+  // Check whether reading the database 'files', recorded for 'olddate',
+  // would give the same results for 'newdate'. This is the case if
+  //  - for each file name, the same file would be opened for 'newdate'
+  //  - the file contents are unchanged
+  //  - no time stamp in any of the files lies between the two dates
+  //    so that the same sections would be read.
+
+  UInt_t lo = std::min(olddate.Get(), newdate.Get());
+  UInt_t hi = std::max(olddate.Get(), newdate.Get());
+  for( const auto& file : files ) {
+    string path;
+    for( const auto& candidate : GetDBFileList(file.name.c_str(), newdate) ) {
+      if( !gSystem->AccessPathName(candidate.c_str(), kReadPermission) ) {
+        path = candidate;
+        break;
+      }
+    }
+    if( path != file.path )
+      return false;
+    if( path.empty() )
+      continue;
+    DBFileInfo info;
+    if( GetDBFileInfo(path, info, false) != 0 )
+      return false;
+    if( info.mtime != file.mtime || info.size != file.size ) {
+      // Touched, but maybe not modified
+      if( GetDBFileInfo(path, info, true) != 0 || info.hash != file.hash )
+        return false;
+    }
+    for( auto tag : file.tags ) {
+      if( tag > lo && tag <= hi )
+        return false;
+    }
+  }
+  return true;
+}
+
+//_____________________________________________________________________________
+Int_t WriteDBSnapshot( const char* dbfile, const char* snapfile )
+{
+  // Parse the text database file 'dbfile' and save the result as a binary
+  // snapshot in 'snapfile'. If 'snapfile' is not given, the snapshot is
+  // written next to 'dbfile' with the name used by LoadDBvalue, i.e.
+  // <dbfile>.snap. LoadDBvalue then loads the snapshot instead of parsing
+  // 'dbfile', as long as 'dbfile' is unchanged.
+  // Returns 0 on success, <0 on error.
+
+  const char* const here = "WriteDBSnapshot";
+
+  if( !dbfile || !*dbfile )
+    return -255;
+  DBFileInfo info;
+  if( GetDBFileInfo(dbfile, info, true) != 0 ) {
+    ::Error(here, "Cannot access database file %s", dbfile);
+    return -1;
+  }
+  FILE* fi = fopen(dbfile, "r");
+  if( !fi ) {
+    ::Error(here, "Cannot open database file %s", dbfile);
+    return -1;
+  }
+  DBFileCache_t parsed;
+  Int_t err = ParseDBFile(fi, parsed);
+  fclose(fi);
+  if( err )
+    return -2;
+
+  DatabaseCache::SnapshotInfo_t snapinfo;
+  snapinfo.mtime = info.mtime;
+  snapinfo.size  = info.size;
+  snapinfo.hash  = info.hash;
+  string snapname = (snapfile && *snapfile) ? string(snapfile)
+                                            : DBSnapshotName(dbfile);
+  if( DatabaseCache::WriteSnapshot(snapname, parsed, snapinfo) != 0 ) {
+    ::Error(here, "Error writing database snapshot %s", snapname.c_str());
+    return -3;
+  }
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t PreloadDBFiles( const vector<string>& names, const TDatime& date,
+                      UInt_t nthreads )
+{
+  // Parse the database files 'names' for 'date', as they would be found by
+  // OpenDBFile, into the DatabaseCache using up to 'nthreads' threads.
+  // Subsequent LoadDBvalue calls for these files, e.g. from the modules'
+  // ReadDatabase, then need not read the files again.
+  // Files are only read and parsed in the worker threads; the cache itself
+  // is updated afterwards by the calling thread.
+  // Returns number of files loaded.
+
+  auto& dbcache = DatabaseCache::Instance();
+  if( !dbcache.IsEnabled() )
+    return 0;
+
+  // Resolve file names to paths, skipping duplicates and cached files
+  class Job_t {
+  public:
+    Job_t( string p, const struct stat& s ) : path(std::move(p)), st(s), ok(false) {}
+    string path;
+    struct stat st;
+    DBFileCache_t parsed;
+    bool ok;
+  };
+  vector<Job_t> jobs;
+  set<pair<Long64_t,Long64_t>> seen;
+  for( const auto& name : names ) {
+    for( const auto& path : GetDBFileList(name.c_str(), date) ) {
+      struct stat st{};
+      if( stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode) ||
+          access(path.c_str(), R_OK) != 0 )
+        continue;
+      // First readable candidate is the one OpenDBFile would open
+      if( seen.insert(make_pair(st.st_dev, st.st_ino)).second &&
+          !dbcache.FindFile(st.st_dev, st.st_ino, st.st_mtime, st.st_ctime,
+                            st.st_size) )
+        jobs.emplace_back(path, st);
+      break;
+    }
+  }
+  if( jobs.empty() )
+    return 0;
+
+  // Parse in parallel. Each job is independent.
+  std::atomic<size_t> next(0);
+  auto work = [&jobs, &next]() {
+    size_t i;
+    while( (i = next++) < jobs.size() ) {
+      Job_t& job = jobs[i];
+      if( LoadDBSnapshot(job.path, job.st, job.parsed) == 0 ) {
+        job.ok = true;
+        continue;
+      }
+      job.parsed = DBFileCache_t();
+      FILE* fi = fopen(job.path.c_str(), "r");
+      if( !fi )
+        continue;
+      job.ok = (ParseDBFile(fi, job.parsed) == 0);
+      fclose(fi);
+    }
+  };
+  nthreads = std::max(1U, std::min<UInt_t>(nthreads, jobs.size()));
+  vector<std::thread> threads;
+  for( UInt_t i = 1; i < nthreads; ++i )
+    threads.emplace_back(work);
+  work();
+  for( auto& t : threads )
+    t.join();
+
+  Int_t nloaded = 0;
+  for( auto& job : jobs ) {
+    if( !job.ok )
+      continue;
+    const struct stat& st = job.st;
+    job.parsed.mtime = st.st_mtime;
+    job.parsed.ctime = st.st_ctime;
+    job.parsed.size  = st.st_size;
+    dbcache.SetFilePath(st.st_dev, st.st_ino, job.path);
+    dbcache.StoreFile(st.st_dev, st.st_ino, std::move(job.parsed));
+    ++nloaded;
+  }
+  return nloaded;
+}
+
 } // namespace Podd
 
@@ -37,6 +37,24 @@ FILE*    OpenDBFile( const char* name, const TDatime& date, const char* here,
                      const char* filemode, int debug_flag, const char*& openpath );
 Int_t    ReadDBline( FILE* file, char* buf, Int_t bufsiz, std::string& line );
 
+// Record of a database file accessed via OpenDBFile, used to detect whether
+// reinitialization for a different date would read the same data
+class DBFileInfo {
+public:
+  DBFileInfo() : mtime(0), size(0), hash(0) {}
+  std::string         name;   // File name as requested by the caller
+  std::string         path;   // File actually opened (empty if none found)
+  Long64_t            mtime;  // Modification time of 'path'
+  Long64_t            size;   // Size of 'path' in bytes
+  ULong64_t           hash;   // Hash of the contents of 'path'
+  std::vector<UInt_t> tags;   // Time stamps in the file (TDatime::Get format)
+};
+
+void     StartDBFileRecording();
+std::vector<DBFileInfo> StopDBFileRecording();
+Bool_t   DBFilesUnchanged( const std::vector<DBFileInfo>& files,
+                           const TDatime& olddate, const TDatime& newdate );
+
 // Access functions for reading key/value pairs from database files
 Int_t    LoadDBvalue( FILE* file, const TDatime& date, const char* key, Double_t& value );
 Int_t    LoadDBvalue( FILE* file, const TDatime& date, const char* key, Int_t& value );
@@ -49,6 +67,11 @@ Int_t    LoadDBmatrix( FILE* file, const TDatime& date, const char* key,
                        std::vector<std::vector<T>>& values, UInt_t ncols );
 Int_t    LoadDatabase( FILE* file, const TDatime& date, const DBRequest* request, const char* prefix,
                        Int_t search = 0, const char* here = "Podd::LoadDatabase" );
+// Parse database files in parallel ahead of their use by LoadDBvalue
+Int_t    PreloadDBFiles( const std::vector<std::string>& names,
+                         const TDatime& date, UInt_t nthreads );
+// Save parsed database file as binary snapshot, loaded by LoadDBvalue
+Int_t    WriteDBSnapshot( const char* dbfile, const char* snapfile = nullptr );
 Int_t    SeekDBdate( FILE* file, const TDatime& date, Bool_t end_on_tag = false );
 Int_t    SeekDBconfig( FILE* file, const char* tag, const char* label = "config",
                        Bool_t end_on_tag = false );
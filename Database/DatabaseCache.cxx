@@ -0,0 +1,372 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::DatabaseCache
+//
+// Process-wide cache for the file-based database. It keeps
+//
+//  - the listings of the database directories searched by GetDBFileList,
+//    i.e. the date-coded and DEFAULT subdirectories, and
+//  - the parsed contents of database files read by LoadDBvalue, and
+//  - indices of the tag lines ("[...]") in database files, which let
+//    SeekDBdate and SeekDBconfig skip all other lines.
+//
+// Since database files such as db_run.dat or the detector files shared by
+// several subdetectors are read by many modules, and by every
+// initialization for each run analyzed in a session, each directory
+// and file is read only once as long as it remains unmodified.
+// Entries are invalidated when the modification time of the directory
+// or file changes. Files are identified by device and inode number, so
+// the same file opened via different paths is parsed only once.
+//
+// Caching can be turned off with SetEnabled(false), in which case every
+// request goes to the file system as before.
+//
+// Parsed files can also be saved as binary snapshots (see WriteDBSnapshot
+// and dbconvert --snapshot), which are loaded via mmap instead of parsing
+// the text file. The format is a header followed by the lines:
+//
+//   char[8]  "PoddDBS"    magic
+//   UInt_t   version      (1)
+//   UInt_t   0x01020304   byte order check
+//   Long64_t mtime, size  of the text file
+//   ULong64_t hash        of the text file
+//   UInt_t   nlines
+//   nlines x { UChar_t flags; UInt_t date; UInt_t nkey; char key[nkey];
+//              UInt_t nvalue; char value[nvalue] }
+//
+// Snapshots are native-endian and not meant to be portable between
+// architectures; a mismatching snapshot is ignored.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "DatabaseCache.h"
+#include "TSystem.h"
+#include <iostream>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace Podd {
+
+static const char   kSnapMagic[8] = "PoddDBS";
+static const UInt_t kSnapVersion  = 1;
+static const UInt_t kSnapOrder    = 0x01020304;
+enum { kHasEq = 1, kIsDate = 2, kIsRaw = 4 };
+
+//_____________________________________________________________________________
+DatabaseCache::DatabaseCache()
+  : fEnabled(true), fNDirHits(0), fNDirReads(0), fNFileHits(0), fNFileReads(0)
+{
+}
+
+//_____________________________________________________________________________
+DatabaseCache& DatabaseCache::Instance()
+{
+  //FIXME: make thread-safe
+  static DatabaseCache instance;
+  return instance;
+}
+
+//_____________________________________________________________________________
+const DatabaseCache::Directory_t* DatabaseCache::GetDirectory( const string& name )
+{
+  // Get the date-coded and default subdirectories of directory 'name'.
+  // Returns nullptr if the directory cannot be opened.
+
+  static const string defaultdir = "DEFAULT";
+
+  struct stat st{};
+  bool have_stat = (stat(name.c_str(), &st) == 0);
+  auto it = fDirs.find(name);
+  if( it != fDirs.end() ) {
+    const auto& d = it->second;
+    if( fEnabled && have_stat && d.mtime == st.st_mtime && d.ctime == st.st_ctime ) {
+      ++fNDirHits;
+      return &d;
+    }
+    fDirs.erase(it);
+  }
+
+  void* dirp = gSystem->OpenDirectory(name.c_str());
+  if( !dirp )
+    return nullptr;
+  ++fNDirReads;
+
+  Directory_t dir;
+  if( have_stat ) {
+    dir.mtime = st.st_mtime;
+    dir.ctime = st.st_ctime;
+  }
+  while( const char* result = gSystem->GetDirEntry(dirp) ) {
+    string item = result;
+    if( item.length() == 8 ) {
+      Int_t pos = 0;
+      for( ; pos<8; ++pos )
+        if( !isdigit(item[pos])) break;
+      if( pos==8 )
+        dir.time_dirs.push_back( item );
+    } else if ( item == defaultdir )
+      dir.have_defaultdir = true;
+  }
+  gSystem->FreeDirectory(dirp);
+  sort( dir.time_dirs.begin(), dir.time_dirs.end() );
+
+  return &(fDirs[name] = std::move(dir));
+}
+
+//_____________________________________________________________________________
+const DatabaseCache::File_t* DatabaseCache::FindFile( Long64_t dev, Long64_t ino,
+                                                      Long64_t mtime,
+                                                      Long64_t ctime,
+                                                      Long64_t size )
+{
+  // Find the parsed contents of the given file. Returns nullptr if the file
+  // is not cached or has changed (i.e. has a different status) since parsed.
+
+  if( !fEnabled )
+    return nullptr;
+  auto it = fFiles.find(FileID_t(dev, ino));
+  if( it == fFiles.end() )
+    return nullptr;
+  const auto& f = it->second;
+  if( f.mtime != mtime || f.ctime != ctime || f.size != size ) {
+    fFiles.erase(it);
+    return nullptr;
+  }
+  ++fNFileHits;
+  return &f;
+}
+
+//_____________________________________________________________________________
+const DatabaseCache::File_t* DatabaseCache::StoreFile( Long64_t dev, Long64_t ino,
+                                                       File_t file )
+{
+  // Put parsed file contents into the cache, replacing any previous
+  // contents for the same file
+
+  ++fNFileReads;
+  return &(fFiles[FileID_t(dev, ino)] = std::move(file));
+}
+
+//_____________________________________________________________________________
+const DatabaseCache::TagIndex_t* DatabaseCache::FindTagIndex( Long64_t dev,
+                                                              Long64_t ino,
+                                                              Long64_t mtime,
+                                                              Long64_t ctime,
+                                                              Long64_t size )
+{
+  // Find the tag index of the given file. Returns nullptr if the file
+  // is not indexed or has changed since indexed.
+
+  if( !fEnabled )
+    return nullptr;
+  auto it = fTagIndex.find(FileID_t(dev, ino));
+  if( it == fTagIndex.end() )
+    return nullptr;
+  const auto& t = it->second;
+  if( t.mtime != mtime || t.ctime != ctime || t.size != size ) {
+    fTagIndex.erase(it);
+    return nullptr;
+  }
+  return &t;
+}
+
+//_____________________________________________________________________________
+const DatabaseCache::TagIndex_t* DatabaseCache::StoreTagIndex( Long64_t dev,
+                                                               Long64_t ino,
+                                                               TagIndex_t index )
+{
+  return &(fTagIndex[FileID_t(dev, ino)] = std::move(index));
+}
+
+//_____________________________________________________________________________
+void DatabaseCache::SetFilePath( Long64_t dev, Long64_t ino, const string& path )
+{
+  fPaths[FileID_t(dev, ino)] = path;
+}
+
+//_____________________________________________________________________________
+const string& DatabaseCache::GetFilePath( Long64_t dev, Long64_t ino ) const
+{
+  // Path of the given file as opened by OpenDBFile, or empty if unknown
+
+  static const string empty;
+  auto it = fPaths.find(FileID_t(dev, ino));
+  return (it != fPaths.end()) ? it->second : empty;
+}
+
+//_____________________________________________________________________________
+template<typename T>
+static inline void Put( ofstream& ofs, const T& val )
+{
+  ofs.write(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+
+//_____________________________________________________________________________
+static inline void PutString( ofstream& ofs, const string& str )
+{
+  Put(ofs, static_cast<UInt_t>(str.size()));
+  ofs.write(str.data(), str.size());
+}
+
+//_____________________________________________________________________________
+Int_t DatabaseCache::WriteSnapshot( const string& path, const File_t& file,
+                                    const SnapshotInfo_t& info )
+{
+  // Write the parsed 'file' as a binary snapshot to 'path'. 'info'
+  // identifies the text file from which 'file' was parsed.
+  // Returns 0 on success, -1 on error.
+
+  ofstream ofs(path.c_str(), ios::binary | ios::trunc);
+  if( !ofs )
+    return -1;
+  ofs.write(kSnapMagic, sizeof(kSnapMagic));
+  Put(ofs, kSnapVersion);
+  Put(ofs, kSnapOrder);
+  Put(ofs, info.mtime);
+  Put(ofs, info.size);
+  Put(ofs, info.hash);
+  Put(ofs, static_cast<UInt_t>(file.lines.size()));
+  for( const auto& line : file.lines ) {
+    UChar_t flags = (line.has_eq ? kHasEq : 0) | (line.is_date ? kIsDate : 0) |
+      (line.is_raw ? kIsRaw : 0);
+    Put(ofs, flags);
+    Put(ofs, line.is_date ? line.date.Get() : 0U);
+    PutString(ofs, line.key);
+    PutString(ofs, line.value);
+  }
+  ofs.close();
+  return ofs ? 0 : -1;
+}
+
+namespace {
+// Bounds-checked reader for a memory-mapped snapshot
+class SnapReader {
+public:
+  SnapReader( const char* p, size_t n ) : fPos(p), fEnd(p + n) {}
+  template<typename T> bool Get( T& val ) {
+    if( static_cast<size_t>(fEnd - fPos) < sizeof(T) ) return false;
+    memcpy(&val, fPos, sizeof(T));
+    fPos += sizeof(T);
+    return true;
+  }
+  bool GetString( string& str ) {
+    UInt_t n = 0;
+    if( !Get(n) || static_cast<size_t>(fEnd - fPos) < n ) return false;
+    str.assign(fPos, n);
+    fPos += n;
+    return true;
+  }
+  bool Skip( size_t n ) {
+    if( static_cast<size_t>(fEnd - fPos) < n ) return false;
+    fPos += n;
+    return true;
+  }
+  const char* Pos() const { return fPos; }
+private:
+  const char* fPos;
+  const char* fEnd;
+};
+} // end anonymous namespace
+
+//_____________________________________________________________________________
+Int_t DatabaseCache::ReadSnapshot( const string& path, File_t& file,
+                                   SnapshotInfo_t& info )
+{
+  // Load the binary snapshot 'path' into 'file' and return the text file
+  // identification in 'info'. 'file' is only modified on success.
+  // Returns 0 on success, -1 if the file cannot be read, -2 if it is not
+  // a valid snapshot.
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if( fd < 0 )
+    return -1;
+  struct stat st{};
+  if( fstat(fd, &st) != 0 || st.st_size <= 0 ) {
+    close(fd);
+    return -1;
+  }
+  auto len = static_cast<size_t>(st.st_size);
+  void* addr = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if( addr == MAP_FAILED )
+    return -1;
+
+  SnapReader rd(static_cast<const char*>(addr), len);
+  File_t result;
+  UInt_t version = 0, order = 0, nlines = 0;
+  bool ok = rd.Skip(sizeof(kSnapMagic)) &&
+    memcmp(addr, kSnapMagic, sizeof(kSnapMagic)) == 0 &&
+    rd.Get(version) && version == kSnapVersion &&
+    rd.Get(order) && order == kSnapOrder &&
+    rd.Get(info.mtime) && rd.Get(info.size) && rd.Get(info.hash) &&
+    rd.Get(nlines);
+  if( ok ) {
+    result.lines.resize(nlines);
+    for( UInt_t i = 0; ok && i < nlines; ++i ) {
+      Line_t& line = result.lines[i];
+      UChar_t flags = 0;
+      UInt_t date = 0;
+      ok = rd.Get(flags) && rd.Get(date) &&
+        rd.GetString(line.key) && rd.GetString(line.value);
+      if( !ok )
+        break;
+      line.has_eq  = (flags & kHasEq) != 0;
+      line.is_date = (flags & kIsDate) != 0;
+      line.is_raw  = (flags & kIsRaw) != 0;
+      if( line.is_date )
+        line.date.Set(date);
+      if( !line.key.empty() )
+        result.keys[line.key].push_back(i);
+      if( line.is_date || line.is_raw )
+        result.special.push_back(i);
+    }
+  }
+  munmap(addr, len);
+  if( !ok )
+    return -2;
+  file = std::move(result);
+  return 0;
+}
+
+//_____________________________________________________________________________
+void DatabaseCache::Clear()
+{
+  // Forget all cached directories and files
+
+  fDirs.clear();
+  fFiles.clear();
+  fPaths.clear();
+  fTagIndex.clear();
+}
+
+//_____________________________________________________________________________
+void DatabaseCache::SetEnabled( Bool_t enable )
+{
+  // Enable/disable caching. Disabling also clears the cache.
+
+  fEnabled = enable;
+  if( !fEnabled )
+    Clear();
+}
+
+//_____________________________________________________________________________
+void DatabaseCache::Print() const
+{
+  // Print cache statistics
+
+  cout << "Database cache " << (fEnabled ? "enabled" : "disabled") << endl;
+  cout << "  Directories: " << fDirs.size() << " cached, "
+       << fNDirReads << " read, " << fNDirHits << " reused" << endl;
+  cout << "  Files:       " << fFiles.size() << " cached, "
+       << fNFileReads << " parsed, " << fNFileHits << " reused" << endl;
+}
+
+} // namespace Podd
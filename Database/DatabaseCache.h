@@ -0,0 +1,129 @@
+#ifndef Podd_DatabaseCache_h_
+#define Podd_DatabaseCache_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::DatabaseCache
+//
+// Process-wide cache of database directory listings and parsed files
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include "TDatime.h"
+#include <map>
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace Podd {
+
+class DatabaseCache {
+
+public:
+  // Subdirectories of a database directory
+  class Directory_t {
+  public:
+    Directory_t() : mtime(-1), ctime(-1), have_defaultdir(false) {}
+    Long64_t mtime, ctime;                // Directory status when read
+    std::vector<std::string> time_dirs;   // YYYYMMDD subdirectories, sorted
+    bool     have_defaultdir;             // Has a DEFAULT subdirectory
+  };
+
+  // Line of a database file, pre-parsed into key/value and time stamp
+  class Line_t {
+  public:
+    Line_t() : has_eq(false), is_date(false), is_raw(false) {}
+    bool         has_eq;  // Line contains '=' (i.e. is a key/value pair)
+    bool         is_date; // Line contains a valid time stamp 'date'
+    bool         is_raw;  // Line contains text variables; parse when used
+    std::string  key;     // Key (left of '='), if any
+    std::string  value;   // Value (right of '='), or the raw line
+    TDatime      date;    // Time stamp
+  };
+
+  // Contents of a database file
+  class File_t {
+  public:
+    File_t() : mtime(0), ctime(0), size(0) {}
+    Long64_t mtime, ctime, size;                     // File status when parsed
+    std::vector<Line_t> lines;                       // Non-empty lines
+    std::map<std::string, std::vector<UInt_t>> keys; // Key -> line indices
+    std::vector<UInt_t> special;  // Indices of time stamps and raw lines
+  };
+
+  // Lines of a database file that may contain tags ("[...]"), for
+  // SeekDBdate and SeekDBconfig. Lines are as read by fgets with a
+  // 256-byte buffer, so long lines are split like in a sequential scan.
+  class Tag_t {
+  public:
+    Tag_t() : start(0), end(0), is_date(false) {}
+    Long64_t    start;    // File position of the line
+    Long64_t    end;      // File position after the line
+    std::string text;     // Line contents without newline
+    bool        is_date;  // Line is a valid time stamp 'date'
+    TDatime     date;
+  };
+  class TagIndex_t {
+  public:
+    TagIndex_t() : mtime(0), ctime(0), size(0) {}
+    Long64_t mtime, ctime, size;     // File status when indexed
+    std::vector<Long64_t> starts;    // Positions of all lines, ascending
+    std::vector<Tag_t>    tags;      // Lines containing '[', ascending
+  };
+
+  // Source file identification stored in a binary snapshot
+  class SnapshotInfo_t {
+  public:
+    SnapshotInfo_t() : mtime(0), size(0), hash(0) {}
+    Long64_t  mtime;  // Modification time of the text file
+    Long64_t  size;   // Size of the text file
+    ULong64_t hash;   // Hash of the text file contents (see DBFileInfo)
+  };
+
+  static DatabaseCache& Instance();
+
+  // Listing of directory 'name', or nullptr if it cannot be opened
+  const Directory_t* GetDirectory( const std::string& name );
+  // Parsed file with the given device/inode numbers and status, if cached
+  const File_t* FindFile( Long64_t dev, Long64_t ino, Long64_t mtime,
+                          Long64_t ctime, Long64_t size );
+  const File_t* StoreFile( Long64_t dev, Long64_t ino, File_t file );
+  // Tag index of the given file, if cached and up to date
+  const TagIndex_t* FindTagIndex( Long64_t dev, Long64_t ino, Long64_t mtime,
+                                  Long64_t ctime, Long64_t size );
+  const TagIndex_t* StoreTagIndex( Long64_t dev, Long64_t ino,
+                                   TagIndex_t index );
+  // Path by which a file was opened via OpenDBFile
+  void     SetFilePath( Long64_t dev, Long64_t ino, const std::string& path );
+  const std::string& GetFilePath( Long64_t dev, Long64_t ino ) const;
+
+  // Binary snapshots of parsed files
+  static Int_t WriteSnapshot( const std::string& path, const File_t& file,
+                              const SnapshotInfo_t& info );
+  static Int_t ReadSnapshot( const std::string& path, File_t& file,
+                             SnapshotInfo_t& info );
+
+  void     Clear();
+  void     Print() const;
+  void     SetEnabled( Bool_t enable = true );
+  Bool_t   IsEnabled() const { return fEnabled; }
+
+private:
+  DatabaseCache();
+  DatabaseCache( const DatabaseCache& ) = delete;
+  DatabaseCache& operator=( const DatabaseCache& ) = delete;
+
+  typedef std::pair<Long64_t, Long64_t> FileID_t;  // Device and inode
+
+  std::map<std::string, Directory_t> fDirs;
+  std::map<FileID_t, File_t>         fFiles;
+  std::map<FileID_t, std::string>    fPaths;
+  std::map<FileID_t, TagIndex_t>     fTagIndex;
+  Bool_t   fEnabled;
+  ULong64_t fNDirHits, fNDirReads, fNFileHits, fNFileReads;
+};
+
+} // namespace Podd
+
+#endif
@@ -10,5 +10,8 @@
 
 #pragma link C++ global gHaTextvars;
 #pragma link C++ class  Podd::Textvars+;
+#pragma link C++ class  Podd::DBBackend;
+#pragma link C++ class  Podd::CommandDBBackend;
+#pragma link C++ function Podd::SetDBBackend;
 
 #endif
@@ -8,6 +8,8 @@ altname = 'Database'
 
 src = """
 Database.cxx
+DatabaseCache.cxx
+DBBackend.cxx
 Textvars.cxx
 VarType.cxx
 """
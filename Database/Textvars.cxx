@@ -14,7 +14,8 @@
 // The analyzer makes one instance of this class available via the      //
 // global gHaTextvars for easy access in scripts.                       //
 //                                                                      //
-// This code runs at initialization time and thus is not time-critical. //
+// This code runs at initialization time. Since database files are read //
+// repeatedly, the expansions of input lines are cached.                //
 //                                                                      //
 //////////////////////////////////////////////////////////////////////////
 
@@ -140,6 +141,7 @@ Int_t Textvars::Add( const string& name, const string& value )
   if( tokens.empty() )
     tokens.emplace_back("");
 
+  ClearCache();
   auto it = fVars.find(name);
 
   if( it != fVars.end() ) {  // already exists?
@@ -165,6 +167,7 @@ Int_t Textvars::AddVerbatim( const string& name, const string& value )
 
   vector<string> values( 1, value );
 
+  ClearCache();
   auto it = fVars.find(name);
 
   if( it != fVars.end() ) {  // already exists?
@@ -211,6 +214,8 @@ UInt_t Textvars::GetArray( const string& name, vector<string>& array )
   if( it == fVars.end() )
     return 0;
 
+  // This takes the values out of the variable
+  ClearCache();
   array.swap( (*it).second );
   return array.size();
 }
@@ -264,8 +269,10 @@ Int_t Textvars::Substitute( string& line ) const
   // Substitute text variables in a single string.
   // If any multi-valued variables are encountered, treat it as an error
 
+  if( line.find("${") == string::npos )
+    return 0;
   vector<string> lines( 1, line );
-  Int_t ret = Substitute( lines, false );
+  Int_t ret = SubstituteCached( lines, false );
   if( ret )
     return ret;
   assert( lines.size() == 1 );
@@ -273,6 +280,49 @@ Int_t Textvars::Substitute( string& line ) const
   return 0;
 }
 
+//_____________________________________________________________________________
+Int_t Textvars::SubstituteCached( vector<string>& lines, bool do_multi ) const
+{
+  // Substitute text variables in the given array of strings like
+  // Substitute(lines,do_multi), but remember the expansion of each line.
+  // Database files are re-read for every key requested, so the same lines
+  // tend to be expanded many times over. The cache is cleared whenever a
+  // variable is added, changed or removed. Failed expansions are not
+  // cached so that their errors are reported each time.
+
+  // Most lines contain no variables at all
+  auto li = lines.begin();
+  while( li != lines.end() && li->find("${") == string::npos )
+    ++li;
+  if( li == lines.end() )
+    return 0;
+
+  // Limit memory use if many distinct lines pass through here
+  static const Cache_t::size_type kMaxCache = 100000;
+
+  Cache_t& cache = fCache[do_multi];
+  vector<string> newlines( lines.begin(), li );
+  vector<string> expansion;
+  for( ; li != lines.end(); ++li ) {
+    if( li->find("${") == string::npos ) {
+      newlines.push_back(*li);
+      continue;
+    }
+    auto it = cache.find(*li);
+    if( it == cache.end() ) {
+      expansion.assign( 1, *li );
+      if( Substitute(expansion, do_multi) != 0 )
+        return 1;
+      if( cache.size() >= kMaxCache )
+        cache.clear();
+      it = cache.emplace(*li, std::move(expansion)).first;
+    }
+    newlines.insert( newlines.end(), it->second.begin(), it->second.end() );
+  }
+  lines.swap(newlines);
+  return 0;
+}
+
 //_____________________________________________________________________________
 Int_t Textvars::Substitute( vector<string>& lines, bool do_multi ) const
 {
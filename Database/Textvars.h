@@ -10,6 +10,7 @@
 #include "Rtypes.h"
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace Podd {
@@ -28,9 +29,9 @@ public:
 
   Int_t    Add( const std::string& name, const std::string& value );
   Int_t    AddVerbatim( const std::string& name, const std::string& value );
-  void     Clear() { fVars.clear(); }
+  void     Clear() { fVars.clear(); ClearCache(); }
   void     Print( Option_t* opt="" ) const;
-  void     Remove( const std::string& name ) { fVars.erase(name); }
+  void     Remove( const std::string& name ) { fVars.erase(name); ClearCache(); }
   UInt_t   Size() const { return fVars.size(); }
 
   const char*               Get( const std::string& name, Int_t idx=0 ) const;
@@ -44,15 +45,21 @@ public:
   }
   Int_t    Substitute( std::string& line ) const;
   Int_t    Substitute( std::vector<std::string>& lines ) const {
-    return Substitute( lines, true );
+    return SubstituteCached( lines, true );
   }
 
 private:
   typedef std::map< std::string, std::vector<std::string> > Textvars_t;
 
+  // Expansions of single lines, valid as long as fVars is unchanged
+  typedef std::unordered_map< std::string, std::vector<std::string> > Cache_t;
+
   Int_t Substitute( std::vector<std::string>& lines, bool do_multi ) const;
-  
+  Int_t SubstituteCached( std::vector<std::string>& lines, bool do_multi ) const;
+  void  ClearCache() { fCache[0].clear(); fCache[1].clear(); }
+
   Textvars_t fVars;
+  mutable Cache_t fCache[2];  //! Expansion cache, without/with multi-values
 
   ClassDef(Textvars, 0)
 };
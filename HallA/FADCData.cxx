@@ -104,23 +104,6 @@ Int_t FADCData::ReadConfig( FILE* file, const TDatime& date, const char* prefix
   return THaAnalysisObject::LoadDB(file, date, calib_request, prefix);
 }
 
-//_____________________________________________________________________________
-static inline
-OptUInt_t GetFADCValue( EModuleType type, const DigitizerHitInfo_t& hitinfo,
-                        Fadc250Module* fadc ) {
-  // Get item 'm.type' from FADC module pointed to by fFADC
-
-  assert(fadc);
-  OptUInt_t val;
-  if( fadc->HasCapability(type) &&
-      hitinfo.hit < fadc->GetNumEvents(type, hitinfo.chan) ) {
-    val = fadc->GetData(type, hitinfo.chan, hitinfo.hit);
-    if( val == kMaxUInt ) // error return code
-      val = nullopt;
-  }
-  return val;
-}
-
 //_____________________________________________________________________________
 OptUInt_t FADCData::LoadFADCData( const DigitizerHitInfo_t& hitinfo )
 {
@@ -131,7 +114,11 @@ OptUInt_t FADCData::LoadFADCData( const DigitizerHitInfo_t& hitinfo )
     throw logic_error("Bad module type (expected Fadc250Module). "
                       "Should never happen. Call expert.");
 
-  return GetFADCValue( kPulseIntegral, hitinfo, fadc );
+  Fadc250Module::PulseData_t pulse{};
+  if( !fadc->GetPulseData(hitinfo.chan, hitinfo.hit, pulse) ||
+      pulse.integral == kMaxUInt )
+    return nullopt;
+  return pulse.integral;
 }
 
 //_____________________________________________________________________________
@@ -149,52 +136,44 @@ Int_t FADCData::StoreHit( const DigitizerHitInfo_t& hitinfo, UInt_t data )
     throw
       std::invalid_argument(msg(hitinfo, "Logical channel number out of range"));
 
-  auto* fadc = dynamic_cast<Fadc250Module*>(hitinfo.module);
-  assert(fadc);  // should have been caught in LoadData
+  auto* fadc = static_cast<Fadc250Module*>(hitinfo.module);
+  assert(dynamic_cast<Fadc250Module*>(fadc));  // checked in LoadFADCData
 
-  auto& FDAT = fFADCData[k];
-  FDAT.fIntegral  = data;
-  FDAT.fOverflow  = fadc->GetOverflowBit(hitinfo.chan, hitinfo.hit);
-  FDAT.fUnderflow = fadc->GetUnderflowBit(hitinfo.chan, hitinfo.hit);
-  FDAT.fPedq      = fadc->GetPedestalQuality(hitinfo.chan, hitinfo.hit);
-
-  class TypeItem { public: EModuleType type; const string name; };
-  static const vector<TypeItem> items = {
-    { kPulsePeak,     "kPulsePeak" },
-    { kPulseTime,     "kPulseTime" },
-    { kPulsePedestal, "kPulsePedestal" }
-  };
+  // Get all data of this pulse at once
+  Fadc250Module::PulseData_t pulse{};
+  fadc->GetPulseData(hitinfo.chan, hitinfo.hit, pulse);
 
+  class TypeItem { public: UInt_t val; const char* name; };
+  const TypeItem items[] = {
+    { pulse.peak,     "kPulsePeak" },
+    { pulse.time,     "kPulseTime" },
+    { pulse.pedestal, "kPulsePedestal" }
+  };
   for( const auto& item : items ) {
-    OptUInt_t val = GetFADCValue(item.type, hitinfo, fadc);
-    if( !val ) {
+    if( item.val == kMaxUInt ) {
       string s("Error retrieving FADC item type ");
       s += item.name; s += ". Decoder bug. Call expert.";
       throw logic_error(msg(hitinfo,s.c_str())); // FADC's GetNumHits lied to us
     }
-    switch( item.type ) {
-      case kPulsePeak:
-        FDAT.fPeak = val.value();
-        break;
-      case kPulseTime:
-        FDAT.fT   = val.value();
-        FDAT.fT_c = FDAT.fT * fConfig.tdcscale;
-        break;
-      case kPulsePedestal:
-        // Retrieve pedestal, if available
-        if( FDAT.fPedq == 0 ) {
-          Data_t p = val.value();
-          if( fConfig.tflag ) {
-            p *= static_cast<Data_t>(fConfig.nsa + fConfig.nsb) / fConfig.nped;
-          } else {
-            p *= static_cast<Data_t>(fConfig.win) / fConfig.nped;
-          }
-          FDAT.fPedestal = p;
-        }
-        break;
-      default:
-        assert(false); // Not reached
+  }
+
+  auto& FDAT = fFADCData[k];
+  FDAT.fIntegral  = data;
+  FDAT.fOverflow  = pulse.overflow;
+  FDAT.fUnderflow = pulse.underflow;
+  FDAT.fPedq      = pulse.pedestal_quality;
+  FDAT.fPeak      = pulse.peak;
+  FDAT.fT         = pulse.time;
+  FDAT.fT_c       = FDAT.fT * fConfig.tdcscale;
+  // Retrieve pedestal, if available
+  if( FDAT.fPedq == 0 ) {
+    Data_t p = pulse.pedestal;
+    if( fConfig.tflag ) {
+      p *= static_cast<Data_t>(fConfig.nsa + fConfig.nsb) / fConfig.nped;
+    } else {
+      p *= static_cast<Data_t>(fConfig.win) / fConfig.nped;
     }
+    FDAT.fPedestal = p;
   }
   fHitDone = true;
   return 0;
@@ -22,6 +22,9 @@ public:
   FadcScintillator();
   ~FadcScintillator() override;
 
+  // FADC data cannot be injected directly (needs frontend module data)
+  Bool_t   SupportsDirectHits() const override { return false; }
+
 protected:
   Int_t    StoreHit( const DigitizerHitInfo_t& hitinfo, UInt_t data ) override;
   OptUInt_t LoadData( const THaEvData& evdata,
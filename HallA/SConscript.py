@@ -19,7 +19,7 @@ THaVDCAnalyticTTDConv.cxx  THaVDCChamber.cxx           THaVDCCluster.cxx
 THaVDC.cxx                 THaVDCHit.cxx               THaVDCPlane.cxx
 THaVDCPoint.cxx            THaVDCPointPair.cxx         THaVDCTimeToDistConv.cxx
 THaVDCTrackID.cxx          THaVDCWire.cxx              TrigBitLoc.cxx
-VDCeff.cxx                 TwoarmVDCTimeCorrection.cxx
+VDCeff.cxx                 TwoarmVDCTimeCorrection.cxx THaVDCLookupTTDConv.cxx
 """
 
 build_library(baseenv, libname, src, useenv = False, versioned = True)
@@ -176,10 +176,13 @@ Int_t THaDecData::ReadDatabase( const TDatime& date )
     return err;
 
   // Configure the trigger bits with a pointer to our evtypebits
+  fTrigBitLocs.clear();
   TIter next( &fBdataLoc );
   while( auto* dataloc = static_cast<BdataLoc*>( next() ) ) {
-    if( dataloc->IsA() == TrigBitLoc::Class() )
+    if( dataloc->IsA() == TrigBitLoc::Class() ) {
       dataloc->OptionPtr( &evtypebits );
+      fTrigBitLocs.push_back( dataloc );
+    }
   }
 
   fIsInit = true;
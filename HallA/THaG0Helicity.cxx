@@ -680,25 +680,14 @@ THaHelicityDet::EHelicity THaG0Helicity::RanBit( int which )
   // Return value:                                                
   //        helicity (-1 or +1).
 
-  const int MASK = BIT(0)+BIT(2)+BIT(3)+BIT(23);
-
-  if (which == 0) {
-     if( TESTBIT(fIseed_earlier,23) ) {    
-         fIseed_earlier = ((fIseed_earlier^MASK)<<1) | BIT(0);
-         return kPlus;
-     } else  { 
-         fIseed_earlier <<= 1;
-         return kMinus;
-     }
-  } else {
-     if( TESTBIT(fIseed,23) ) {    
-         fIseed = ((fIseed^MASK)<<1) | BIT(0);
-         return kPlus;
-     } else  { 
-         fIseed <<= 1;
-         return kMinus;
-     }
-  }
+  const UInt_t MASK = BIT(0)+BIT(2)+BIT(3)+BIT(23);
+
+  // If bit 23 is set, apply the feedback mask and shift in a one,
+  // otherwise just shift
+  UInt_t& seed = (which == 0) ? fIseed_earlier : fIseed;
+  UInt_t bit23 = (seed >> 23) & 1;
+  seed = ((seed ^ (MASK & (0u - bit23))) << 1) | bit23;
+  return bit23 ? kPlus : kMinus;
 }
 
 
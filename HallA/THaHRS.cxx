@@ -73,6 +73,24 @@ Bool_t THaHRS::GetTrSorting() const
   return TestBit(kSortTracks);
 }
  
+//_____________________________________________________________________________
+Bool_t THaHRS::SetGoldenByChi2( Bool_t set )
+{
+  // Select the track with the smallest chi2/ndof as the Golden Track
+  // without sorting the track array. Has no effect if track sorting
+  // is enabled, since the best track is then first anyway.
+
+  Bool_t oldset = TestBit(kGoldByChi2);
+  SetBit( kGoldByChi2, set );
+  return oldset;
+}
+
+//_____________________________________________________________________________
+Bool_t THaHRS::GetGoldenByChi2() const
+{
+  return TestBit(kGoldByChi2);
+}
+
 //_____________________________________________________________________________
 Bool_t THaHRS::AutoStandardDetectors( Bool_t set )
 {
@@ -206,7 +224,18 @@ Int_t THaHRS::FindVertices( TClonesArray& tracks )
     // in track reconstruction. Hence, chi2 sorting is preferable, albeit
     // obviously slower.
 
+    //
+    // Alternatively, with SetGoldenByChi2(true), the track with the smallest
+    // chi2/ndof is found in a single pass, leaving the track order unchanged.
+
     fGoldenTrack = static_cast<THaTrack*>( fTracks->At(0) );
+    if( !GetTrSorting() && GetGoldenByChi2() ) {
+      for( int i = 1; i < fTracks->GetLast()+1; i++ ) {
+        auto* theTrack = static_cast<THaTrack*>( fTracks->At(i) );
+        if( theTrack && theTrack->Compare(fGoldenTrack) < 0 )
+          fGoldenTrack = theTrack;
+      }
+    }
     fTrkIfo      = *fGoldenTrack;
     fTrk         = fGoldenTrack;
   } else
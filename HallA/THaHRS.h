@@ -28,6 +28,8 @@ public:
 
   Bool_t GetTrSorting() const;
   Bool_t SetTrSorting( Bool_t set = false );
+  Bool_t GetGoldenByChi2() const;
+  Bool_t SetGoldenByChi2( Bool_t set = false );
   Bool_t AutoStandardDetectors( Bool_t set = true );
   
   virtual EStatus Init( const TDatime& run_time );
@@ -38,7 +40,8 @@ protected:
   // Bit flags
   enum {
     kSortTracks   = BIT(14), // Tracks are to be sorted by chi2
-    kAutoStdDets  = BIT(15)  // Auto-create standard detectors if no "vdc"
+    kAutoStdDets  = BIT(15), // Auto-create standard detectors if no "vdc"
+    kGoldByChi2   = BIT(16)  // Golden track has best chi2, tracks unsorted
   };
 
   ClassDef(THaHRS,0) //A Hall A High Resolution Spectrometer
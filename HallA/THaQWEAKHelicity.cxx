@@ -162,6 +162,7 @@ Int_t THaQWEAKHelicity::ReadDatabase( const TDatime& date )
   // careful, the first value here should always +1
   fPatternSequence = {1,-1,-1,1};
   HWPIN=true;
+  MakeHelicityTable();
 
   return kOK;
 }
@@ -387,17 +388,10 @@ void THaQWEAKHelicity::LoadHelicity( UInt_t eventnumber )
 	  if (fRing_NSeed==fMAXBIT)
 	    {
 	      fRingSeed_actual=fRingSeed_reported;
-	      UInt_t advance=0;
 	      //take the delay into account
-	      for(UInt_t j=0;j<fQWEAKDelay;j++)
-		{	      
-		  advance+=1;
-		  if( advance == fQWEAKNPattern)
-		    {
-		      fRing_actual_polarity=RanBit30(fRingSeed_actual);
-		      advance=0;
-		    }
-		}
+	      UInt_t advance=0;
+	      AdvancePattern(fQWEAKDelay, advance, fRingSeed_actual,
+	                     fRing_actual_polarity);
 	    }
 	}
 
@@ -465,16 +459,8 @@ void THaQWEAKHelicity::LoadHelicity( UInt_t eventnumber )
 	  UInt_t localfPhase=fRingPhase_reported;
 	  UInt_t localfSeed=fRingSeed_actual;
 	  UInt_t localfPolarity=fRing_actual_polarity;
-	  
-	  for(UInt_t i=0; i<fOffsetTIRvsRing;i++)
-	    {
-	      localfPhase+=1;
-	      if( localfPhase == fQWEAKNPattern)
-		{
-		  localfPhase=0;
-		  localfPolarity=RanBit30(localfSeed);
-		}
-	    }
+	  AdvancePattern(fOffsetTIRvsRing, localfPhase, localfSeed,
+	                 localfPolarity);
 	  fHelicity=SetHelicity(localfPolarity,localfPhase);
 	  if(fPatternTir==1)
 	    fQrt=1;
@@ -495,9 +481,53 @@ void THaQWEAKHelicity::LoadHelicity( UInt_t eventnumber )
     }
 }
 
+//_____________________________________________________________________________
+void THaQWEAKHelicity::AdvancePattern( UInt_t nwin, UInt_t& phase,
+                                       UInt_t& seed, UInt_t& polarity )
+{
+  // Advance the pattern phase by 'nwin' helicity windows. Each time the
+  // phase wraps around, a new pattern starts, and the generator makes one
+  // step. A phase beyond the end of the pattern never wraps around.
+
+  if( phase >= fQWEAKNPattern ) {
+    phase += nwin;
+    return;
+  }
+  UInt_t end = phase + nwin;
+  for( UInt_t n = end / fQWEAKNPattern; n > 0; --n )
+    polarity = RanBit30(seed);
+  phase = end % fQWEAKNPattern;
+}
+
+//_____________________________________________________________________________
+void THaQWEAKHelicity::MakeHelicityTable()
+{
+  // Tabulate the helicity for all polarities and pattern phases.
+  // Must be called whenever fPatternSequence or HWPIN change.
+
+  UInt_t nphase = fPatternSequence.size();
+  fHelTable.resize(2*nphase);
+  for( UInt_t polarity = 0; polarity < 2; ++polarity )
+    for( UInt_t phase = 0; phase < nphase; ++phase )
+      fHelTable[polarity*nphase+phase] = CalcHelicity(polarity, phase);
+}
+
 //_____________________________________________________________________________
 THaHelicityDet::EHelicity
-THaQWEAKHelicity::SetHelicity( UInt_t polarity, UInt_t phase )
+THaQWEAKHelicity::SetHelicity( UInt_t polarity, UInt_t phase ) const
+{
+  // Helicity for the given polarity of the generator and phase within
+  // the pattern. Looked up in the table made by MakeHelicityTable.
+
+  UInt_t nphase = fPatternSequence.size();
+  if( polarity > 1 || phase >= nphase )
+    return kUnknown;
+  return fHelTable[polarity*nphase+phase];
+}
+
+//_____________________________________________________________________________
+THaHelicityDet::EHelicity
+THaQWEAKHelicity::CalcHelicity( UInt_t polarity, UInt_t phase ) const
 {
   // here predicted_reported_helicity can have a value of 0 or 1
   // fPatternSequence[fRingPhase_reported] can have a value of 1 or -1
@@ -531,12 +561,9 @@ THaQWEAKHelicity::SetHelicity( UInt_t polarity, UInt_t phase )
 UInt_t THaQWEAKHelicity::RanBit30( UInt_t& ranseed )
 {
 
-  bool bit7    = (ranseed & 0x00000040) != 0;
-  bool bit28   = (ranseed & 0x08000000) != 0;
-  bool bit29   = (ranseed & 0x10000000) != 0;
-  bool bit30   = (ranseed & 0x20000000) != 0;
-
-  UInt_t newbit = (bit30 ^ bit29 ^ bit28 ^ bit7) & 0x1;
+  // Feedback from bits 30, 29, 28 and 7 (counting from 1)
+  UInt_t newbit = ((ranseed >> 29) ^ (ranseed >> 28) ^ (ranseed >> 27) ^
+                   (ranseed >> 6)) & 0x1;
 
   if(ranseed<=0) {
     if(fQWEAKDebug>1)
@@ -38,7 +38,11 @@ protected:
   void  CheckTIRvsRing( UInt_t eventnumber );
   void  LoadHelicity( UInt_t eventnumber );
   UInt_t RanBit30( UInt_t& ranseed );
-  THaHelicityDet::EHelicity SetHelicity( UInt_t polarity, UInt_t phase);
+  void   AdvancePattern( UInt_t nwin, UInt_t& phase, UInt_t& seed,
+                         UInt_t& polarity );
+  THaHelicityDet::EHelicity SetHelicity( UInt_t polarity, UInt_t phase) const;
+  THaHelicityDet::EHelicity CalcHelicity( UInt_t polarity, UInt_t phase) const;
+  void   MakeHelicityTable();
 
   
   // variables that need to be read from the database
@@ -51,6 +55,8 @@ protected:
   std::vector<Int_t> fPatternSequence; // sequence of 0 and 1 in the pattern
   UInt_t fQWEAKNPattern; // maximum of event in the pattern
   Bool_t HWPIN;
+  // Helicity for each polarity (0, 1) and phase, index polarity*nphase+phase
+  std::vector<THaHelicityDet::EHelicity> fHelTable;
 
 
   Int_t fQrt;
@@ -35,6 +35,7 @@
 #include <sstream>
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 
 using namespace std;
 using namespace VDC;
@@ -60,12 +61,13 @@ THaVDC::THaVDC( const char* name, const char* description,
   fLower{new THaVDCChamber("uv1", "Lower VDC chamber", this)},
   fUpper{new THaVDCChamber("uv2", "Upper VDC chamber", this)},
   fLUpairs{new TClonesArray("THaVDCPointPair", 20)},
-  fNtracks(0), fEvNum(0),
+  fNtracks(0), fEvNum(0), fNpairs(0), fLimitFlags(0), fNlimited(0),
   // Default geometry parameters. Exact values are read in ReadDatabase.
   fVDCAngle(-TMath::PiOver4()), fSin_vdc(-0.5*TMath::Sqrt2()),
   fCos_vdc(0.5*TMath::Sqrt2()), fTan_vdc(-1.0),
   fSpacing(0.33), fCentralDist(0.),
   fNumIter(1), fErrorCutoff(1e9), fCoordType(kRotatingTransport),
+  fMaxClusters(0), fMaxPairs(0), fMaxTrackTime(0),
   fTimeCorrectionModule(nullptr)
 {
   // Constructor
@@ -357,6 +359,9 @@ Int_t THaVDC::ReadDatabase( const TDatime& date )
     { "max_matcherr",      &fErrorCutoff,      kDouble, 0, true },
     { "num_iter",          &fNumIter,          kInt,    0, true },
     { "coord_type",        &coord_type,        kString, 0, true },
+    { "max_clusters",      &fMaxClusters,      kInt,    0, true },
+    { "max_pairs",         &fMaxPairs,         kInt,    0, true },
+    { "max_tracktime",     &fMaxTrackTime,     kDouble, 0, true },
     { "disable_tracking",  &disable_tracking,  kInt,    0, true },
     { "disable_finetrack", &disable_finetrack, kInt,    0, true },
     { "only_fastest_hit",  &only_fastest_hit,  kInt,    0, true },
@@ -417,6 +422,15 @@ Int_t THaVDC::ReadDatabase( const TDatime& date )
            "Fix database.", fNumIter );
     return kInitError;
   }
+  if( fMaxClusters < 0 || fMaxPairs < 0 || fMaxTrackTime < 0.0 ) {
+    Error( Here(here), "Illegal tracking limits max_clusters/max_pairs/"
+           "max_tracktime = %d/%d/%lf. Must be >= 0. Fix database.",
+           fMaxClusters, fMaxPairs, fMaxTrackTime );
+    return kInitError;
+  }
+  fLower->SetMaxClusters(fMaxClusters);
+  fUpper->SetMaxClusters(fMaxClusters);
+  fNlimited = 0;
 
   if( fDebug > 0 ) {
 #ifdef MCDATA
@@ -445,6 +459,7 @@ Int_t THaVDC::ReadDatabase( const TDatime& date )
     fCentralDist = s1->GetOrigin().Z();
 
   CalcMatrix(1.,fLMatrixElems); // tensor without explicit polynomial in x_fp
+  CompileMatrices();
 
   fIsInit = true;
   return kOK;
@@ -463,6 +478,10 @@ Int_t THaVDC::DefineVariables( EMode mode )
 
   RVarDef vars[] = {
     { "time_cor", "Trigger time offset (s)", "GetTimeCorrectionUnchecked()" },
+    { "npairs",   "Number of point pairs considered",     "fNpairs" },
+    { "limits",   "Tracking limits exceeded (bits: 1=clusters, 2=pairs, 4=time)",
+                  "fLimitFlags" },
+    { "nlimited", "Events with tracking limits exceeded", "fNlimited" },
     { nullptr }
   };
   return DefineVarsFromList( vars, mode );
@@ -475,7 +494,6 @@ Int_t THaVDC::ConstructTracks( TClonesArray* tracks, Int_t mode )
   // them to 'tracks'
 
   // TODO:
-  //   Only make combos whose projections are close
   //   do a real 3D fit, not just compute 3D chi2?
 
 #ifdef WITH_DEBUG
@@ -494,6 +512,7 @@ Int_t THaVDC::ConstructTracks( TClonesArray* tracks, Int_t mode )
   UInt_t theStage = ( mode == 1 ) ? kCoarse : kFine;
 
   fLUpairs->Clear();
+  fTrackCands.clear();
 
   Int_t nUpper = fUpper->GetNPoints();
   Int_t nLower = fLower->GetNPoints();
@@ -517,11 +536,73 @@ Int_t THaVDC::ConstructTracks( TClonesArray* tracks, Int_t mode )
 
   Int_t nPairs  = 0;  // Number of point pairs to consider
 
+  // A pair's matching error is the sum of the squared distances between
+  // each point's projection and the other point, so any single coordinate
+  // difference must be within sqrt(fErrorCutoff). Sort the upper points by
+  // x position and only look at those close to the projected position of
+  // each lower point. The remaining coordinates are checked before doing
+  // the full calculation. These checks never reject a pair that passes
+  // the cut on the error.
+  struct UpperPoint_t {
+    Double_t x, y;    // Intercept
+    Double_t bx, by;  // Projection to the lower chamber
+    Int_t    index;
+    bool operator<( const UpperPoint_t& rhs ) const { return x < rhs.x; }
+  };
+  vector<UpperPoint_t> upper;
+  upper.reserve(nUpper);
+  for( int j = 0; j < nUpper; j++ ) {
+    THaVDCPoint* upperPoint = fUpper->GetPoint(j);
+    assert(upperPoint);
+    UpperPoint_t up;
+    up.x = upperPoint->GetX();
+    up.y = upperPoint->GetY();
+    up.bx = up.x + (-fSpacing) * upperPoint->GetTheta();
+    up.by = up.y + (-fSpacing) * upperPoint->GetPhi();
+    up.index = j;
+    upper.push_back(up);
+  }
+  sort( upper.begin(), upper.end() );
+  const Double_t maxdist = TMath::Sqrt(fErrorCutoff) * (1.0 + 1e-6);
+  vector<Int_t> candidates;
+  candidates.reserve(nUpper);
+
   for( int i = 0; i < nLower; i++ ) {
+    // Stop looking for more pairs if the event exceeds its budget.
+    // The pairs found so far are still used.
+    if( fMaxTrackTime > 0.0 && chrono::steady_clock::now() > fDeadline ) {
+      fLimitFlags |= kTrackTimeout;
+      break;
+    }
     THaVDCPoint* lowerPoint = fLower->GetPoint(i);
     assert(lowerPoint);
 
-    for( int j = 0; j < nUpper; j++ ) {
+    // Projection of the lower point to the upper chamber
+    Double_t lx = lowerPoint->GetX(), ly = lowerPoint->GetY();
+    Double_t px = lx + fSpacing * lowerPoint->GetTheta();
+    Double_t py = ly + fSpacing * lowerPoint->GetPhi();
+
+    UpperPoint_t lo, hi;
+    lo.x = px - maxdist;
+    hi.x = px + maxdist;
+    candidates.clear();
+    for( auto it = lower_bound(upper.begin(), upper.end(), lo),
+           end = upper_bound(it, upper.end(), hi); it != end; ++it ) {
+      if( (px-it->x)*(px-it->x) >= fErrorCutoff ||
+          (py-it->y)*(py-it->y) >= fErrorCutoff ||
+          (it->bx-lx)*(it->bx-lx) >= fErrorCutoff ||
+          (it->by-ly)*(it->by-ly) >= fErrorCutoff )
+        continue;
+      candidates.push_back(it->index);
+    }
+    // Create pairs in the same order as when trying all combinations
+    sort( candidates.begin(), candidates.end() );
+
+    for( auto j : candidates ) {
+      if( fMaxPairs > 0 && nPairs >= fMaxPairs ) {
+        fLimitFlags |= kTooManyPairs;
+        break;
+      }
       THaVDCPoint* upperPoint = fUpper->GetPoint(j);
       assert(upperPoint);
 
@@ -553,7 +634,10 @@ Int_t THaVDC::ConstructTracks( TClonesArray* tracks, Int_t mode )
       // - could do all of this before deciding to keep this pair
       thePair->Analyze();
     }
+    if( fLimitFlags & kTooManyPairs )
+      break;
   }
+  fNpairs = nPairs;
 
   // Initialize counters
   int n_exist = 0, n_mod = 0;
@@ -624,23 +708,29 @@ Int_t THaVDC::ConstructTracks( TClonesArray* tracks, Int_t mode )
     }
 #endif
 
-    // If the 'tracks' array was given, add THaTracks to it
-    // (or modify existing ones).
-    if (tracks) {
-
-      // Decide whether this is a new track or an old track
-      // that is being updated
-      auto* thisID = new THaVDCTrackID(lowerPoint,upperPoint);
-      THaTrack* theTrack = nullptr;
-      bool found = false;
-      int t = 0;
-      for( ; t < n_exist; t++ ) {
-        theTrack = static_cast<THaTrack*>( tracks->At(t) );
-        // This test is true if an existing track has exactly the same clusters
-        // as the current one (defined by lowerPoint/upperPoint)
+    // If the 'tracks' array was given, record a candidate track. THaTracks
+    // are created or updated only after all pairs have been decided.
+    if( tracks ) {
+      TrackCand_t cand;
+      cand.pair   = thePair;
+      cand.track  = nullptr;
+      cand.dx     = lowerPoint->GetX();
+      cand.dy     = lowerPoint->GetY();
+      cand.dtheta = lowerPoint->GetTheta();
+      cand.dphi   = lowerPoint->GetPhi();
+      cand.flag   = theStage;
+      if( nPairs > 1 )
+        cand.flag |= kMultiTrack;
+
+      // Is this an existing track that is being updated? This test is true
+      // if an existing track has exactly the same clusters as the current
+      // one (defined by lowerPoint/upperPoint)
+      THaVDCTrackID thisID(lowerPoint,upperPoint);
+      for( int t = 0; t < n_exist; t++ ) {
+        auto* theTrack = static_cast<THaTrack*>( tracks->At(t) );
         if( theTrack && theTrack->GetCreator() == this &&
-            *thisID == *theTrack->GetID() ) {
-          found = true;
+            thisID == *theTrack->GetID() ) {
+          cand.track = theTrack;
           break;
         }
 #ifdef WITH_DEBUG
@@ -649,57 +739,74 @@ Int_t THaVDC::ConstructTracks( TClonesArray* tracks, Int_t mode )
 #endif
       }
 
-      UInt_t flag = theStage;
-      if( nPairs > 1 )
-        flag |= kMultiTrack;
+      // An existing track whose detector coordinates did not change
+      // in this pass keeps its TRANSPORT coordinates
+      cand.changed = !cand.track ||
+        cand.track->GetDX()     != cand.dx ||
+        cand.track->GetDY()     != cand.dy ||
+        cand.track->GetDTheta() != cand.dtheta ||
+        cand.track->GetDPhi()   != cand.dphi;
+      if( cand.changed )
+        CalcFocalPlaneCoords( cand );
+
+      fTrackCands.push_back(cand);
+    }
+  }
 
-      if( found ) {
+  // Convert the candidates to THaTracks
+  for( auto& cand : fTrackCands ) {
+    THaVDCPointPair* thePair = cand.pair;
+    THaVDCPoint* lowerPoint = thePair->GetLower();
+    THaVDCPoint* upperPoint = thePair->GetUpper();
+    THaTrack* theTrack = cand.track;
+
+    if( theTrack ) {
 #ifdef WITH_DEBUG
-        if( fDebug>1 )
-          cout << "Track " << t << " modified.\n";
+      if( fDebug>1 )
+        cout << "Track " << tracks->IndexOf(theTrack) << " modified.\n";
 #endif
-        delete thisID;
-        ++n_mod;
-      } else {
+      ++n_mod;
+    } else {
 #ifdef WITH_DEBUG
-        if( fDebug>1 )
-          cout << "Track " << tracks->GetLast()+1 << " added.\n";
+      if( fDebug>1 )
+        cout << "Track " << tracks->GetLast()+1 << " added.\n";
 #endif
-        theTrack = AddTrack(*tracks, 0.0, 0.0, 0.0, 0.0, thisID );
-        //	theTrack->SetID( thisID );
-        //	theTrack->SetCreator( this );
-        theTrack->AddCluster( lowerPoint );
-        theTrack->AddCluster( upperPoint );
-        assert( tracks->IndexOf(theTrack) >= 0 );
-        theTrack->SetTrkNum( tracks->IndexOf(theTrack)+1 );
-        thePair->Associate( theTrack );
-        if( theStage == kFine )
-          flag |= kReassigned;
-      }
+      theTrack = AddTrack(*tracks, 0.0, 0.0, 0.0, 0.0,
+                          new THaVDCTrackID(lowerPoint,upperPoint) );
+      theTrack->AddCluster( lowerPoint );
+      theTrack->AddCluster( upperPoint );
+      assert( tracks->IndexOf(theTrack) >= 0 );
+      theTrack->SetTrkNum( tracks->IndexOf(theTrack)+1 );
+      thePair->Associate( theTrack );
+      if( theStage == kFine )
+        cand.flag |= kReassigned;
+      cand.track = theTrack;
+    }
 
-      theTrack->SetD(lowerPoint->GetX(), lowerPoint->GetY(),
-                     lowerPoint->GetTheta(), lowerPoint->GetPhi());
-      theTrack->SetFlag( flag );
+    theTrack->SetD(cand.dx, cand.dy, cand.dtheta, cand.dphi);
+    theTrack->SetFlag( cand.flag );
 
-      // Calculate the TRANSPORT coordinates
-      CalcFocalPlaneCoords(theTrack);
+    // TRANSPORT coordinates
+    if( cand.changed ) {
+      theTrack->Set(cand.x, cand.y, cand.theta, cand.phi);
+      theTrack->SetR(cand.r_x, cand.r_y, cand.r_theta, cand.r_phi);
+    }
 
-      // Calculate the chi2 of the track from the distances to the wires
-      // in the associated clusters
-      chi2_t chi2 = thePair->CalcChi2();
-      theTrack->SetChi2( chi2.first, chi2.second - 4 );
+    // Calculate the chi2 of the track from the distances to the wires
+    // in the associated clusters
+    chi2_t chi2 = thePair->CalcChi2();
+    theTrack->SetChi2( chi2.first, chi2.second - 4 );
 
 #ifdef WITH_DEBUG
-      if( fDebug>2 ) {
-        Double_t chisq = chi2.first;
-        Int_t nhits = chi2.second;
-        cout << " chi2/ndof = " << chisq << "/" << nhits-4;
-        if( nhits > 4 )
-          cout << " = " << chisq/(nhits-4);
-        cout << endl;
-      }
-#endif
+    if( fDebug>2 ) {
+      Double_t chisq = chi2.first;
+      Int_t nhits = chi2.second;
+      cout << " chi2/ndof = " << chisq << "/" << nhits-4;
+      if( nhits > 4 )
+        cout << " = " << chisq/(nhits-4);
+      cout << endl;
     }
+#endif
   }
 
 #ifdef WITH_DEBUG
@@ -764,6 +871,8 @@ void THaVDC::Clear( Option_t* opt )
   THaTrackingDetector::Clear(opt);
   fLower->Clear(opt);
   fUpper->Clear(opt);
+  fNpairs = 0;
+  fLimitFlags = 0;
 }
 
 //_____________________________________________________________________________
@@ -794,12 +903,23 @@ Int_t THaVDC::CoarseTrack( TClonesArray& tracks )
   if( TestBit(kDecodeOnly) )
     return 0;
 
-  fLower->CoarseTrack();
-  fUpper->CoarseTrack();
+  if( fMaxTrackTime > 0.0 )
+    fDeadline = chrono::steady_clock::now() +
+      chrono::duration_cast<chrono::steady_clock::duration>(
+        chrono::duration<Double_t, milli>(fMaxTrackTime));
+
+  // Chambers with too many clusters have no points, so no tracks are built
+  Int_t lower_ret = fLower->CoarseTrack();
+  Int_t upper_ret = fUpper->CoarseTrack();
+  if( lower_ret != 0 || upper_ret != 0 )
+    fLimitFlags |= kTooManyClusters;
 
   // Build tracks and mark them as level 1
   fNtracks = ConstructTracks( &tracks, 1 );
 
+  if( fLimitFlags )
+    ++fNlimited;
+
   return 0;
 }
 
@@ -815,7 +935,7 @@ Int_t THaVDC::FineTrack( TClonesArray& /* tracks */ )
   fLower->FineTrack();
   fUpper->FineTrack();
 
-  //FindBadTracks(tracks);
+  //FindBadTracks(fTrackCands);
   //CorrectTimeOfFlight(tracks);
 
 //   for (Int_t i = 0; i < fNumIter; i++) {
@@ -879,38 +999,50 @@ void THaVDC::DetToTrackTransportCoords( Double_t& x, Double_t& y,
 #endif
 
 //_____________________________________________________________________________
-void THaVDC::CalcFocalPlaneCoords( THaTrack* track )
+void THaVDC::CalcFocalPlaneCoords( TrackCand_t& cand )
 {
   // calculates focal plane coordinates from detector coordinates
 
   // first calculate the transport frame coordinates
   // (see DetToTrackTransportCoords above for the general algorithm)
-  Double_t theta = (track->GetDTheta()+fTan_vdc) /
-    (1.0-track->GetDTheta()*fTan_vdc);
-  Double_t x = track->GetDX() * (fCos_vdc + theta * fSin_vdc);
-  Double_t phi = track->GetDPhi() / (fCos_vdc - track->GetDTheta() * fSin_vdc);
-  Double_t y = track->GetDY() + fSin_vdc*phi*track->GetDX();
+  cand.theta = (cand.dtheta+fTan_vdc) / (1.0-cand.dtheta*fTan_vdc);
+  cand.x = cand.dx * (fCos_vdc + cand.theta * fSin_vdc);
+  cand.phi = cand.dphi / (fCos_vdc - cand.dtheta * fSin_vdc);
+  cand.y = cand.dy + fSin_vdc*cand.phi*cand.dx;
 
   // then calculate the rotating transport frame coordinates
-  Double_t r_x = x;
+  cand.r_x = cand.x;
 
   // calculate the focal-plane matrix elements
-  CalcMatrix( r_x, fFPMatrixElems );
+  CalcMatrix( cand.r_x, fFPMatrixElems );
 
-  Double_t r_y = y - fFPMatrixElems[Y000].v;  // Y000
+  cand.r_y = cand.y - fFPMatrixElems[Y000].v;  // Y000
 
   // Calculate now the tan(rho) and cos(rho) of the local rotation angle.
   Double_t tan_rho_loc = fFPMatrixElems[T000].v;   // T000
   Double_t cos_rho_loc = 1.0/sqrt(1.0+tan_rho_loc*tan_rho_loc);
 
-  Double_t r_phi = (track->GetDPhi() - fFPMatrixElems[P000].v /* P000 */ ) /
-    (1.0-track->GetDTheta()*tan_rho_loc) / cos_rho_loc;
-  Double_t r_theta = (track->GetDTheta()+tan_rho_loc) /
-    (1.0-track->GetDTheta()*tan_rho_loc);
+  cand.r_phi = (cand.dphi - fFPMatrixElems[P000].v /* P000 */ ) /
+    (1.0-cand.dtheta*tan_rho_loc) / cos_rho_loc;
+  cand.r_theta = (cand.dtheta+tan_rho_loc) / (1.0-cand.dtheta*tan_rho_loc);
+}
+
+//_____________________________________________________________________________
+void THaVDC::CalcFocalPlaneCoords( THaTrack* track )
+{
+  // calculates focal plane coordinates from the detector coordinates
+  // of the given track
+
+  TrackCand_t cand;
+  cand.dx     = track->GetDX();
+  cand.dy     = track->GetDY();
+  cand.dtheta = track->GetDTheta();
+  cand.dphi   = track->GetDPhi();
+  CalcFocalPlaneCoords( cand );
 
   // set the values we calculated
-  track->Set(x, y, theta, phi);
-  track->SetR(r_x, r_y, r_theta, r_phi);
+  track->Set(cand.x, cand.y, cand.theta, cand.phi);
+  track->SetR(cand.r_x, cand.r_y, cand.r_theta, cand.r_phi);
 }
 
 //_____________________________________________________________________________
@@ -936,36 +1068,26 @@ void THaVDC::CalcTargetCoords( THaTrack* track )
 
   // calculate the powers we need
   Double_t powers[kNUM_PRECOMP_POW][5];  // {(x), th, y, ph, abs(th) }
-  for(int i=0; i<kNUM_PRECOMP_POW; i++) {
-    powers[i][0] = pow(x_fp, i);
-    powers[i][1] = pow(th_fp, i);
-    powers[i][2] = pow(y_fp, i);
-    powers[i][3] = pow(ph_fp, i);
-    powers[i][4] = pow(TMath::Abs(th_fp),i);
+  Double_t base[5] = { x_fp, th_fp, y_fp, ph_fp, TMath::Abs(th_fp) };
+  for( int j=0; j<5; j++ ) {
+    powers[0][j] = 1.0;
+    for( int i=1; i<kNUM_PRECOMP_POW; i++ )
+      powers[i][j] = powers[i-1][j] * base[j];
   }
-
-  // calculate the matrices we need
-  CalcMatrix(x_fp, fDMatrixElems);
-  CalcMatrix(x_fp, fTMatrixElems);
-  CalcMatrix(x_fp, fYMatrixElems);
-  CalcMatrix(x_fp, fYTAMatrixElems);
-  CalcMatrix(x_fp, fPMatrixElems);
-  CalcMatrix(x_fp, fPTAMatrixElems);
+  const Double_t* pw = &powers[0][0];
 
   // calculate the coordinates at the target
-  Double_t theta = CalcTargetVar(fTMatrixElems, powers);
-  Double_t phi = CalcTargetVar(fPMatrixElems, powers) +
-                 CalcTargetVar(fPTAMatrixElems, powers);
-  Double_t y = CalcTargetVar(fYMatrixElems, powers) +
-               CalcTargetVar(fYTAMatrixElems, powers);
+  Double_t theta = fTMatrix.Eval(x_fp, pw);
+  Double_t phi = fPMatrix.Eval(x_fp, pw) + fPTAMatrix.Eval(x_fp, pw);
+  Double_t y = fYMatrix.Eval(x_fp, pw) + fYTAMatrix.Eval(x_fp, pw);
 
   auto* app = static_cast<THaSpectrometer*>(GetApparatus());
   // calculate momentum
-  Double_t dp = CalcTargetVar(fDMatrixElems, powers);
+  Double_t dp = fDMatrix.Eval(x_fp, pw);
   Double_t p  = app->GetPcentral() * (1.0+dp);
 
   // pathlength matrix is for the Transport coord plane
-  Double_t pathl = CalcTarget2FPLen(fLMatrixElems, powers);
+  Double_t pathl = fLMatrix.Eval(x_fp, pw);
 
   //FIXME: estimate x ??
   Double_t x = 0.0;
@@ -980,6 +1102,20 @@ void THaVDC::CalcTargetCoords( THaTrack* track )
 }
 
 
+//_____________________________________________________________________________
+static inline Double_t EvalPoly( Double_t x, const Double_t* coef, Int_t order )
+{
+  // Evaluate polynomial in x with 'order' coefficients (Horner scheme)
+
+  Double_t v = 0.0;
+  if( order > 0 ) {
+    for( Int_t i = order - 1; i >= 1; i-- )
+      v = x * (v + coef[i]);
+    v += coef[0];
+  }
+  return v;
+}
+
 //_____________________________________________________________________________
 void THaVDC::CalcMatrix( const Double_t x, vector<THaMatrixElement>& matrix )
 {
@@ -987,16 +1123,73 @@ void THaVDC::CalcMatrix( const Double_t x, vector<THaMatrixElement>& matrix )
   // by evaluating a polynomial in x of order it->order with
   // coefficients given by it->poly
 
-  for( auto& ME : matrix ) {
-    ME.v = 0.0;
-    if( ME.order > 0 ) {
-      for( int i = ME.order - 1; i >= 1; i-- )
-        ME.v = x * (ME.v + ME.poly[i]);
-      ME.v += ME.poly[0];
+  for( auto& ME : matrix )
+    ME.v = EvalPoly(x, ME.poly.data(), ME.order);
+}
+
+//_____________________________________________________________________________
+void THaVDC::CompiledMatrix::Add( const vector<THaMatrixElement>& matrix,
+                                  UInt_t col0, bool use_value )
+{
+  // Append the non-zero elements of 'matrix'. The exponents pw[i] of each
+  // element refer to column col0+i of the table of powers (see
+  // CalcTargetCoords). If 'use_value' is set, the current value of
+  // each element is taken as a constant instead of its polynomial in x.
+
+  const UInt_t ncol = 5;  // Columns in table of powers
+  for( const auto& ME : matrix ) {
+    if( use_value ? (ME.v == 0.0) : (ME.order <= 0) )
+      continue;
+    Term_t term;
+    term.icoef = fCoef.size();
+    if( use_value ) {
+      term.order = 1;
+      fCoef.push_back(ME.v);
+    } else {
+      term.order = ME.order;
+      fCoef.insert(fCoef.end(), ME.poly.begin(), ME.poly.begin() + ME.order);
     }
+    assert( ME.pw.size() <= 4 && col0 + ME.pw.size() <= ncol );
+    for( UInt_t i = 0; i < 4; ++i ) {
+      // Unused slots point to the zeroth power, i.e. 1
+      term.ipow[i] = (i < ME.pw.size()) ? ME.pw[i] * ncol + col0 + i : 0;
+    }
+    fTerms.push_back(term);
   }
 }
 
+//_____________________________________________________________________________
+Double_t THaVDC::CompiledMatrix::Eval( Double_t x, const Double_t* powers ) const
+{
+  // Evaluate the sum of all terms for focal-plane x and the given table
+  // of powers of the focal-plane coordinates
+
+  Double_t retval = 0.0;
+  for( const auto& term : fTerms ) {
+    Double_t v = EvalPoly(x, &fCoef[term.icoef], term.order);
+    retval += v * powers[term.ipow[0]] * powers[term.ipow[1]]
+      * powers[term.ipow[2]] * powers[term.ipow[3]];
+  }
+  return retval;
+}
+
+//_____________________________________________________________________________
+void THaVDC::CompileMatrices()
+{
+  // Set up the compiled target matrices from the matrix elements read
+  // from the database
+
+  fTMatrix.clear();   fTMatrix.Add(fTMatrixElems, 1);
+  fDMatrix.clear();   fDMatrix.Add(fDMatrixElems, 1);
+  fPMatrix.clear();   fPMatrix.Add(fPMatrixElems, 1);
+  fPTAMatrix.clear(); fPTAMatrix.Add(fPTAMatrixElems, 1);
+  fYMatrix.clear();   fYMatrix.Add(fYMatrixElems, 1);
+  fYTAMatrix.clear(); fYTAMatrix.Add(fYTAMatrixElems, 1);
+  // Path length matrix includes the power of x_fp and has constant
+  // coefficients (evaluated at x = 1 in Init)
+  fLMatrix.clear();   fLMatrix.Add(fLMatrixElems, 0, true);
+}
+
 //_____________________________________________________________________________
 Double_t THaVDC::CalcTargetVar(const vector<THaMatrixElement>& matrix,
                                const Double_t powers[][5])
@@ -1087,9 +1280,11 @@ void THaVDC::CorrectTimeOfFlight(TClonesArray& tracks)
 }
 
 //_____________________________________________________________________________
-void THaVDC::FindBadTracks(TClonesArray& tracks)
+void THaVDC::FindBadTracks( vector<TrackCand_t>& cands )
 {
-  // Flag tracks that don't intercept S2 scintillator as bad
+  // Flag candidate tracks that don't intercept S2 scintillator as bad.
+  // Uses the TRANSPORT coordinates of the candidates, so it can run before
+  // the candidates are converted to THaTracks.
 
   auto* s2 = static_cast<THaScintillator*>( GetApparatus()->GetDetector("s2") );
 
@@ -1098,29 +1293,28 @@ void THaVDC::FindBadTracks(TClonesArray& tracks)
     return;
   }
 
-  Int_t n_exist = tracks.GetLast()+1;
-  for( Int_t t = 0; t < n_exist; t++ ) {
-    auto* track = static_cast<THaTrack*>( tracks.At(t) );
+  for( auto& cand : cands ) {
+    Double_t x = cand.x, y = cand.y, theta = cand.theta, phi = cand.phi;
+    if( !cand.changed ) {
+      x = cand.track->GetX();
+      y = cand.track->GetY();
+      theta = cand.track->GetTheta();
+      phi = cand.track->GetPhi();
+    }
 
     // project the current x and y positions into the s2 plane
     // if the tracks go out of the bounds of the s2 plane,
     // toss the track out
-    Double_t x2, y2; // dummy variables
-    if( !s2->CalcInterceptCoords(track, x2, y2) ||
+    Double_t pathl, x2, y2; // dummy variables
+    if( !s2->CalcTrackIntercept(x, y, theta, phi, pathl, x2, y2) ||
         !s2->IsInActiveArea(x2, y2) ) {
 
       // for now, we just flag the tracks as bad
-      track->SetFlag( track->GetFlag() | kBadTrack );
-
-      //tracks.RemoveAt(t);
-#ifdef WITH_DEBUG
-      //cout << "Track " << t << " deleted.\n";
-#endif
+      cand.flag |= kBadTrack;
+      if( cand.track )
+        cand.track->SetFlag( cand.track->GetFlag() | kBadTrack );
     }
   }
-
-  // get rid of the slots for the deleted tracks
-  //tracks.Compress();
 }
 
 //_____________________________________________________________________________
@@ -10,6 +10,7 @@
 #include "THaTrackingDetector.h"
 #include "TimeCorrectionModule.h"
 #include <cassert>
+#include <chrono>
 #include <utility>
 #include <string>
 #include <vector>
@@ -18,6 +19,7 @@ class THaVDCChamber;
 class THaTrack;
 class TClonesArray;
 class THaVDCPoint;
+class THaVDCPointPair;
 namespace Podd {
   class TimeCorrectionModule;
 }
@@ -77,6 +79,14 @@ public:
     kCoarseOnly     = BIT(23)  // Do only coarse tracking
   };
 
+  // Tracking limits exceeded in the current event (GetLimitFlags())
+  enum ELimitFlags {
+    kTooManyClusters = BIT(0), // Too many clusters in a plane, no tracking
+    kTooManyPairs    = BIT(1), // Too many point pairs, rest not considered
+    kTrackTimeout    = BIT(2)  // Time budget exceeded, rest not considered
+  };
+  UInt_t GetLimitFlags() const { return fLimitFlags; }
+
   enum { kPORDER = 7 };
 
   // Class for storing matrix element data
@@ -97,6 +107,27 @@ public:
     std::vector<double> poly;// the associated polynomial
   };
 
+  // Matrix elements of one target variable, compiled into flat arrays
+  // for evaluation with a precomputed table of powers of the focal-plane
+  // coordinates (see CalcTargetCoords)
+  class CompiledMatrix {
+  public:
+    void     clear() { fTerms.clear(); fCoef.clear(); }
+    void     Add( const std::vector<THaMatrixElement>& matrix, UInt_t col0,
+                  bool use_value = false );
+    Double_t Eval( Double_t x, const Double_t* powers ) const;
+    UInt_t   GetSize() const { return fTerms.size(); }
+  private:
+    class Term_t {
+    public:
+      UInt_t order;    // Number of polynomial coefficients
+      UInt_t icoef;    // Index of first coefficient in fCoef
+      UInt_t ipow[4];  // Indices into the table of powers
+    };
+    std::vector<Term_t>   fTerms;
+    std::vector<Double_t> fCoef;
+  };
+
 protected:
 
   enum ECoordType { kTransport, kRotatingTransport };
@@ -108,8 +139,25 @@ protected:
 
   // Event data
   TClonesArray*  fLUpairs;  // Candidate pairs of lower/upper points
+
+  // Compact candidate track from an accepted point pair. Converted to a
+  // THaTrack at the end of ConstructTracks.
+  struct TrackCand_t {
+    THaVDCPointPair* pair;           // Point pair making this track
+    THaTrack*        track;          // Existing track with the same clusters
+    Double_t dx, dy, dtheta, dphi;   // Detector coordinates
+    Double_t x, y, theta, phi;       // TRANSPORT coordinates
+    Double_t r_x, r_y, r_theta, r_phi; // Rotating TRANSPORT coordinates
+    UInt_t   flag;                   // Track flags (kCoarse etc.)
+    bool     changed;                // TRANSPORT coordinates recalculated
+  };
+  std::vector<TrackCand_t> fTrackCands; //! Track candidates of this event
   Int_t    fNtracks;        // Number of tracks found in ConstructTracks
   UInt_t   fEvNum;          // Event number from decoder (for diagnostics)
+  Int_t    fNpairs;         // Number of point pairs considered
+  UInt_t   fLimitFlags;     // Tracking limits exceeded (ELimitFlags)
+  UInt_t   fNlimited;       // Number of events with limits exceeded (run)
+  std::chrono::steady_clock::time_point fDeadline; //! End of time budget
 
   // Geometry
   Double_t fVDCAngle;       // Angle from the VDC cs to TRANSPORT cs (rad)
@@ -126,6 +174,9 @@ protected:
   Int_t    fNumIter;        // Number of iterations for FineTrack()
   Double_t fErrorCutoff;    // Cut on track matching error
   ECoordType fCoordType;    // Coordinates to use as input for matrix calcs
+  Int_t    fMaxClusters;    // Max clusters per plane for tracking (0=no limit)
+  Int_t    fMaxPairs;       // Max point pairs per event (0=no limit)
+  Double_t fMaxTrackTime;   // Max tracking time per event (ms, 0=no limit)
 
   // Optics matrix elements (FIXME: move to HRS)
   std::vector<THaMatrixElement> fTMatrixElems;
@@ -140,11 +191,22 @@ protected:
 
   std::vector<THaMatrixElement> fLMatrixElems;   // Path-length corrections (meters)
 
+  // Target matrices compiled for evaluation
+  CompiledMatrix fTMatrix;  //!
+  CompiledMatrix fDMatrix;  //!
+  CompiledMatrix fPMatrix;  //!
+  CompiledMatrix fPTAMatrix;//!
+  CompiledMatrix fYMatrix;  //!
+  CompiledMatrix fYTAMatrix;//!
+  CompiledMatrix fLMatrix;  //!
+
   Podd::TimeCorrectionModule* fTimeCorrectionModule;
 
   void CalcFocalPlaneCoords( THaTrack* track );
+  void CalcFocalPlaneCoords( TrackCand_t& cand );
   void CalcTargetCoords( THaTrack* the_track );
   static void CalcMatrix( double x, std::vector<THaMatrixElement>& matrix );
+  void        CompileMatrices();
 //  Double_t DoPoly(const int n, const std::vector<double> &a, const double x);
 //  Double_t PolyInv(const double x1, const double x2, const double xacc,
 //		 const double y, const int norder,
@@ -159,7 +221,7 @@ protected:
   virtual Int_t ConstructTracks( TClonesArray* tracks = nullptr, Int_t flag = 0 );
 
   void CorrectTimeOfFlight(TClonesArray& tracks);
-  void FindBadTracks(TClonesArray &tracks);
+  void FindBadTracks( std::vector<TrackCand_t>& cands );
 
   virtual Int_t ReadDatabase( const TDatime& date );
   virtual Int_t ReadGeometry( FILE* file, const TDatime& date,
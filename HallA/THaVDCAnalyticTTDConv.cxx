@@ -5,6 +5,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "THaVDCAnalyticTTDConv.h"
+#include "THaVDCHit.h"
 #include "TError.h"
 
 ClassImp(VDC::AnalyticTTDConv)
@@ -38,11 +39,39 @@ Double_t AnalyticTTDConv::ConvertTimeToDist( Double_t time, Double_t tanTheta,
     return kBig;
   }
 
-//    printf("Converting Drift Time to Drift Distance!\n");
+  Double_t a1 = 0.0, a2 = 0.0;
+  CalcCorrections(tanTheta, a1, a2);
+  return CalcDist(time, a1, a2, ddist);
+}
+
+//_____________________________________________________________________________
+void AnalyticTTDConv::ConvertTimeToDist( THaVDCHit* const* hits, UInt_t n,
+                                         Double_t tanTheta ) const
+{
+  // Convert the drift times of all 'n' hits of a cluster with slope
+  // 'tanTheta'. The correction parameters are computed only once.
 
+  if( !fIsSet ) {
+    TimeToDistConv::ConvertTimeToDist(hits, n, tanTheta);
+    return;
+  }
+  Double_t a1 = 0.0, a2 = 0.0;
+  CalcCorrections(tanTheta, a1, a2);
+  for( UInt_t i = 0; i < n; ++i ) {
+    Double_t ddist = 0.0;
+    hits[i]->SetDist(CalcDist(hits[i]->GetTime(), a1, a2, &ddist));
+    hits[i]->SetdDist(ddist);
+  }
+}
+
+//_____________________________________________________________________________
+void AnalyticTTDConv::CalcCorrections( Double_t tanTheta, Double_t& a1,
+                                       Double_t& a2 ) const
+{
   // Find the values of a1 and a2 by evaluating the proper polynomials
   // a = A_3 * x^3 + A_2 * x^2 + A_1 * x + A_0
-  Double_t a1 = 0.0, a2 = 0.0;
+
+  a1 = 0.0; a2 = 0.0;
 
   tanTheta = 1.0 / tanTheta;
 
@@ -52,6 +81,13 @@ Double_t AnalyticTTDConv::ConvertTimeToDist( Double_t time, Double_t tanTheta,
   }
   a1 += fA1tdcCor[0];
   a2 += fA2tdcCor[0];
+}
+
+//_____________________________________________________________________________
+Double_t AnalyticTTDConv::CalcDist( Double_t time, Double_t a1, Double_t a2,
+                                    Double_t* ddist ) const
+{
+  // Drift distance for 'time' given the correction parameters a1 and a2
 
   Double_t dist = fDriftVel * time;
   Double_t unc  = fDriftVel * fdtime;  // watch uncertainty in the timing
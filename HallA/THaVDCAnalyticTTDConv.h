@@ -21,11 +21,18 @@ namespace VDC {
 
     virtual Double_t ConvertTimeToDist( Double_t time, Double_t tanTheta,
 				        Double_t* ddist=0 ) const;
+    virtual void     ConvertTimeToDist( THaVDCHit* const* hits, UInt_t n,
+                                        Double_t tanTheta ) const;
     virtual Double_t GetParameter( UInt_t i ) const;
     virtual Int_t    SetParameters( const std::vector<double>& param );
 
 protected:
 
+    void     CalcCorrections( Double_t tanTheta, Double_t& a1,
+                              Double_t& a2 ) const;
+    Double_t CalcDist( Double_t time, Double_t a1, Double_t a2,
+                       Double_t* ddist ) const;
+
     // Coefficients for a polynomial yielding correction parameters
     Double_t fA1tdcCor[4];
     Double_t fA2tdcCor[4];
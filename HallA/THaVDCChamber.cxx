@@ -16,6 +16,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "THaVDCChamber.h"
+#include "MethodAccessor.h"
 #include "THaVDCPlane.h"
 #include "THaVDCPoint.h"
 #include "THaVDCCluster.h"
@@ -30,7 +31,8 @@ THaVDCChamber::THaVDCChamber( const char* name, const char* description,
   fV{new THaVDCPlane( "v", "V plane", this )},
   // Create array for cluster pairs (points) representing hits
   fPoints{new TClonesArray("THaVDCPoint", 10)}, // 10 is arbitrary
-  fSpacing(0), fSin_u(0), fCos_u(1), fSin_v(1), fCos_v(0), fInv_sin_vu(0)
+  fSpacing(0), fSin_u(0), fCos_u(1), fSin_v(1), fCos_v(0), fInv_sin_vu(0),
+  fMaxClusters(0)
 {
   // Constructor
 
@@ -261,15 +263,22 @@ void THaVDCChamber::FitTracks()
 //_____________________________________________________________________________
 Int_t THaVDCChamber::CoarseTrack()
 {
-  // Coarse computation of tracks
+  // Coarse computation of tracks.
+  // Returns 1 if too many clusters were found to attempt matching them.
 
-  // Apply drift time offset correction obtained in prior Decode or
-  // InterStage(Decode) stage
-  ApplyTimeCorrection();
-
-  // Find clusters and estimate their position/slope
+  // Find clusters and estimate their position/slope. This also applies
+  // the drift time offset correction obtained in the prior Decode or
+  // InterStage(Decode) stage, in the same pass over the hits as the
+  // time cuts.
   FindClusters();
 
+  // Give up on events with excessive numbers of clusters, where the
+  // combinatorics of matching would take too long. The clusters are kept,
+  // but no points are made.
+  if( fMaxClusters > 0 && (fU->GetNClusters() > fMaxClusters ||
+                           fV->GetNClusters() > fMaxClusters) )
+    return 1;
+
   // Fit "local" tracks through the hit coordinates of each cluster
   FitTracks();
 
@@ -300,3 +309,6 @@ Int_t THaVDCChamber::FineTrack()
 
 //_____________________________________________________________________________
 ClassImp(THaVDCChamber)
+
+// Compiled accessors for functions used in global variable definitions
+PODD_REGISTER_METHOD(THaVDCChamber, GetNPoints)
@@ -52,6 +52,7 @@ public:
     { assert( i>=0 && i<GetNPoints() );
       return static_cast<THaVDCPoint*>( fPoints->UncheckedAt(i) ); }
   Double_t        GetZ()           const { return fU->GetZ(); }
+  void            SetMaxClusters( Int_t n ) { fMaxClusters = n; }
 
 protected:
 
@@ -71,6 +72,9 @@ protected:
   Double_t fInv_sin_vu;       // 1/Sine of the difference between the
                               // V axis angle and the U axis angle
 
+  // Configuration
+  Int_t    fMaxClusters;      // Max clusters per plane to match (0=no limit)
+
   void  ApplyTimeCorrection(); // Correct hit drift times by common offset
   void  FindClusters();       // Find clusters in U and V planes
   void  FitTracks();          // Fit local tracks for each cluster
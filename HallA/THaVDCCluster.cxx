@@ -8,8 +8,10 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "THaVDCCluster.h"
+#include "MethodAccessor.h"
 #include "THaVDCHit.h"
 #include "THaVDCPlane.h"
+#include "THaVDCTimeToDistConv.h"
 #include "THaTrack.h"
 #include "TMath.h"
 #include "TClass.h"
@@ -52,10 +54,13 @@ void THaVDCCluster::AddHit( THaVDCHit* hit )
 //_____________________________________________________________________________
 void THaVDCCluster::Clear( Option_t* )
 {
-  // Clear the contents of the cluster and reset status
+  // Clear the contents of the cluster and reset status.
+  // The memory of the hit and coordinate arrays is kept, so cleared
+  // clusters can be reused.
 
   ClearFit();
   fHits.clear();
+  fTimeCorrection = 0;
   fPivot   = nullptr;
   fPlane   = nullptr;
   fPointPair = nullptr;
@@ -145,6 +150,24 @@ void THaVDCCluster::ConvertTimeToDist()
 {
   // Convert TDC Times in wires to drift distances
 
+  if( fHits.empty() )
+    return;
+
+  // Normally, all wires of a plane share one converter, which can then
+  // convert all hits at once
+  THaVDCWire* wire = fHits[0]->GetWire();
+  VDC::TimeToDistConv* ttdConv = wire ? wire->GetTTDConv() : nullptr;
+  for( auto* hit : fHits ) {
+    if( !ttdConv || !hit->GetWire() || hit->GetWire()->GetTTDConv() != ttdConv ) {
+      ttdConv = nullptr;
+      break;
+    }
+  }
+  if( ttdConv ) {
+    ttdConv->ConvertTimeToDist(fHits.data(), fHits.size(), fSlope);
+    return;
+  }
+
   //Do conversion for each hit in cluster
   for (int i = 0; i < GetSize(); i++)
     fHits[i]->ConvertTimeToDist(fSlope);
@@ -284,42 +307,46 @@ void THaVDCCluster::FitSimpleTrack( Bool_t weighted )
     fCoord.push_back( FitCoord_t(x,y,w) );
   }
 
+  // The sums over wire positions and weights do not depend on the signs
+  // of the drift distances, so compute them only once. For the sums
+  // involving the distances, accumulate both sign combinations at once:
+  // combination 0 flips the signs of the hits after the pivot,
+  // combination 1 additionally flips the pivot. The sums are accumulated
+  // in the same order as before, so the results are unchanged.
+  Double_t W     = 0.0;
+  Double_t sumX  = 0.0;   //Positions
+  Double_t sumXX = 0.0;
+  Double_t sumYc[2]  = { 0.0, 0.0 };   //Drift distances
+  Double_t sumXYc[2] = { 0.0, 0.0 };
+  for (int j = 0; j < GetSize(); j++) {
+    Double_t x = fCoord[j].x;   // Position of wire
+    Double_t y = fCoord[j].y;   // Distance to wire
+    Double_t w = fCoord[j].w;
+
+    if (w <= 0) continue;
+    W     += w;
+    sumX  += x * w;
+    sumXX += x * x * w;
+    Double_t y0 = (j > pivotNum) ? -y : y;
+    Double_t y1 = (j >= pivotNum) ? -y : y;
+    sumYc[0]  += y0 * w;
+    sumXYc[0] += x * y0 * w;
+    sumYc[1]  += y1 * w;
+    sumXYc[1] += x * y1 * w;
+  }
+
   const Int_t nSignCombos = 2; //Number of different sign combinations
   for (int i = 0; i < nSignCombos; i++) {
-    Double_t sumX  = 0.0;   //Positions
-    Double_t sumXW = 0.0;
-    Double_t sumXX = 0.0;
-    Double_t sumY  = 0.0;   //Drift distances
-    Double_t sumXY = 0.0;
-    Double_t sumYY = 0.0;
-    Double_t sumXXW= 0.0;
-
-    Double_t W = 0.0;
-    Double_t WW= 0.0;
+    Double_t sumY  = sumYc[i];
+    Double_t sumXY = sumXYc[i];
 
+    // Signs of the coordinates for the chi2 calculation
     if (i == 0)
       for (int j = pivotNum+1; j < GetSize(); j++)
 	fCoord[j].y *= -1;
     else if (i == 1)
       fCoord[pivotNum].y *= -1;
 
-    for (int j = 0; j < GetSize(); j++) {
-      Double_t x = fCoord[j].x;   // Position of wire
-      Double_t y = fCoord[j].y;   // Distance to wire
-      Double_t w = fCoord[j].w;
-
-      if (w <= 0) continue;
-      W     += w;
-      WW    += w*w;
-      sumX  += x * w;
-      sumXW += x * w * w;
-      sumXX += x * x * w;
-      sumXXW+= x * x * w * w;
-      sumY  += y * w;
-      sumXY += x * y * w;
-      sumYY += y * y * w;
-    }
-
     // Standard formulae for linear regression (see Bevington)
     Double_t Delta = W * sumXX - sumX * sumX;
 
@@ -366,6 +393,21 @@ void THaVDCCluster::FitSimpleTrack( Bool_t weighted )
   fFitOK = true;
 }
 
+// Sums for the 3-parameter fit, see Linear3DFit
+namespace {
+struct Fit3DSums_t {
+  Fit3DSums_t() : x(0), xx(0), d(0), xd(0), s(0), sx(0), sd(0), sdx(0), w(0) {}
+  Double_t x, xx;      // Positions
+  Double_t d, xd;      // Drift distances
+  Double_t s, sx;      // Sign vector
+  Double_t sd, sdx;
+  Double_t w;          // Weights
+};
+}
+
+static void Solve3DFit( const Fit3DSums_t& sum, Double_t& m, Double_t& b,
+                        Double_t& d0 );
+
 //_____________________________________________________________________________
 Int_t THaVDCCluster::LinearClusterFitWithT0()
 {
@@ -440,13 +482,40 @@ Int_t THaVDCCluster::LinearClusterFitWithT0()
   for( Int_t i = 1; i < GetSize(); ++i )
     fCoord[i].s = 1;
 
+  // The fit sums for all sign vectors follow from the sums for the first
+  // one by flipping one term at a time. This avoids re-summing all hits
+  // for each pivot position.
+  Fit3DSums_t sum;
+  for( Int_t j = 0; j < GetSize(); ++j ) {
+    const FitCoord_t& c = fCoord[j];
+    if( c.w <= 0 ) continue;
+    sum.x   += c.x * c.w;
+    sum.xx  += c.x * c.x * c.w;
+    sum.d   += c.y * c.w;
+    sum.xd  += c.x * c.y * c.w;
+    sum.s   += c.s * c.w;
+    sum.sx  += c.s * c.x * c.w;
+    sum.sd  += c.s * c.y * c.w;
+    sum.sdx += c.s * c.y * c.x * c.w;
+    sum.w   += c.w;
+  }
+
   for( Int_t ipivot = 0; ipivot < ilast; ++ipivot ) {
-    if( ipivot != 0 )
-      fCoord[ipivot].s *= -1;
+    if( ipivot != 0 ) {
+      FitCoord_t& c = fCoord[ipivot];
+      c.s *= -1;
+      if( c.w > 0 ) {
+        // Term changes from +1 to -1 times its value
+        sum.s   -= 2 * c.w;
+        sum.sx  -= 2 * c.x * c.w;
+        sum.sd  -= 2 * c.y * c.w;
+        sum.sdx -= 2 * c.y * c.x * c.w;
+      }
+    }
 
     // Do the fit
     Double_t m = kBig, b = kBig, d0 = kBig;
-    Linear3DFit( m, b, d0 );
+    Solve3DFit( sum, m, b, d0 );
 
     // calculate chi2 for the track given this slope,
     // intercept, and distance offset
@@ -483,52 +552,15 @@ Int_t THaVDCCluster::LinearClusterFitWithT0()
 }
 
 //_____________________________________________________________________________
-void THaVDCCluster::Linear3DFit( Double_t& m, Double_t& b, Double_t& d0 ) const
+static void Solve3DFit( const Fit3DSums_t& sum, Double_t& m, Double_t& b,
+                        Double_t& d0 )
 {
-  // 3-parameter fit
-//     Double_t F, sigmaF2;  // intermediate slope and St. Dev.**2
-//     Double_t G, sigmaG2;  // intermediate intercept and St. Dev.**2
-//     Double_t sigmaFG;     // correlated uncertainty
-
-  Double_t sumX   = 0.0;   //Positions
-  Double_t sumXX  = 0.0;
-  Double_t sumD   = 0.0;   //Drift distances
-  Double_t sumXD  = 0.0;
-  Double_t sumS   = 0.0;   //sign vector
-  Double_t sumSX  = 0.0;
-  Double_t sumSD  = 0.0;
-  Double_t sumSDX = 0.0;
-
-  //     Double_t sumXW = 0.0;
-  //     Double_t sumXXW= 0.0;
-
-  Double_t sumW  = 0.0;
-  //     Double_t sumWW = 0.0;
-  //     Double_t sumDD = 0.0;
+  // Solve the 3-parameter fit for the given sums, see Linear3DFit
 
-
-  for (int j = 0; j < GetSize(); j++) {
-    Double_t x = fCoord[j].x;   // Position of wire
-    Double_t d = fCoord[j].y;   // Distance to wire
-    Double_t w = fCoord[j].w;   // Weight/error of distance measurement
-    Int_t    s = fCoord[j].s;   // Sign of distance
-
-    if (w <= 0) continue;
-
-    sumX   += x * w;
-    sumXX  += x * x * w;
-    sumD   += d * w;
-    sumXD  += x * d * w;
-    sumS   += s * w;
-    sumSX  += s * x * w;
-    sumSD  += s * d * w;
-    sumSDX += s * d * x * w;
-    sumW   += w;
-    //       sumWW  += w*w;
-    //       sumXW  += x * w * w;
-    //       sumXXW += x * x * w * w;
-    //       sumDD  += d * d * w;
-  }
+  const Double_t sumX   = sum.x,   sumXX = sum.xx;
+  const Double_t sumD   = sum.d,   sumS  = sum.s;
+  const Double_t sumSX  = sum.sx,  sumSD = sum.sd;
+  const Double_t sumSDX = sum.sdx, sumW  = sum.w;
 
   // Standard formulae for linear regression (see Bevington)
   Double_t Delta =
@@ -551,7 +583,6 @@ void THaVDCCluster::Linear3DFit( Double_t& m, Double_t& b, Double_t& d0 ) const
   b  /= Delta;
   d0 /= Delta;
 
-
   //     F  = (sumXX * sumD - sumX * sumXD) / Delta;
   //     G  = (sumW * sumXD - sumX * sumD) / Delta;
   //     sigmaF2 = ( sumXX / Delta );
@@ -564,7 +595,33 @@ void THaVDCCluster::Linear3DFit( Double_t& m, Double_t& b, Double_t& d0 ) const
 
   //     sigmaM = m * m * TMath::Sqrt( sigmaG2 );
   //     sigmaB = TMath::Sqrt( sigmaF2/(G*G) + F*F/(G*G*G*G)*sigmaG2 - 2*F/(G*G*G)*sigmaFG);
+}
+
+//_____________________________________________________________________________
+void THaVDCCluster::Linear3DFit( Double_t& m, Double_t& b, Double_t& d0 ) const
+{
+  // 3-parameter fit of the current coordinates and signs
 
+  Fit3DSums_t sum;
+  for (int j = 0; j < GetSize(); j++) {
+    Double_t x = fCoord[j].x;   // Position of wire
+    Double_t d = fCoord[j].y;   // Distance to wire
+    Double_t w = fCoord[j].w;   // Weight/error of distance measurement
+    Int_t    s = fCoord[j].s;   // Sign of distance
+
+    if (w <= 0) continue;
+
+    sum.x   += x * w;
+    sum.xx  += x * x * w;
+    sum.d   += d * w;
+    sum.xd  += x * d * w;
+    sum.s   += s * w;
+    sum.sx  += s * x * w;
+    sum.sd  += s * d * w;
+    sum.sdx += s * d * x * w;
+    sum.w   += w;
+  }
+  Solve3DFit( sum, m, b, d0 );
 }
 
 //_____________________________________________________________________________
@@ -762,3 +819,8 @@ void THaVDCCluster::Print( Option_t* ) const
 
 ///////////////////////////////////////////////////////////////////////////////
 ClassImp(THaVDCCluster)
+
+// Compiled accessors for functions used in global variable definitions
+PODD_REGISTER_METHOD(THaVDCCluster, GetSize)
+PODD_REGISTER_METHOD(THaVDCCluster, GetPivotWireNum)
+PODD_REGISTER_METHOD(THaVDCCluster, GetTrackIndex)
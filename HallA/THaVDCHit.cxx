@@ -7,6 +7,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "THaVDCHit.h"
+#include "MethodAccessor.h"
 #include "THaVDCTimeToDistConv.h"
 #include "TError.h"
 
@@ -65,3 +66,6 @@ Int_t THaVDCHit::Compare( const TObject* obj ) const
 
 //_____________________________________________________________________________
 ClassImp(THaVDCHit)
+
+// Compiled accessors for functions used in global variable definitions
+PODD_REGISTER_METHOD(THaVDCHit, GetWireNum)
@@ -0,0 +1,168 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// THaVDCLookupTTDConv                                                       //
+//                                                                           //
+// Same conversion as AnalyticTTDConv, but the track angle dependent         //
+// correction parameters a1 and a2 are taken from a table computed at        //
+// initialization, with linear interpolation in tan(theta). The drift time   //
+// dependence is piecewise linear and is evaluated exactly. Outside of the   //
+// table range, the polynomials are evaluated directly.                      //
+//                                                                           //
+// Select with "ttd.converter = LookupTTDConv" in the plane database.        //
+// Parameters 0-8 are as for AnalyticTTDConv. Optional parameters 9-11 are   //
+// the table range in tan(theta) (min, max) and the number of intervals.     //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include "THaVDCLookupTTDConv.h"
+#include "THaVDCHit.h"
+#include "TError.h"
+
+ClassImp(VDC::LookupTTDConv)
+
+using namespace std;
+
+// Default table range and size. Covers the range of track angles in the
+// Hall A VDCs with a step size of 0.001.
+static const Double_t kDefTanMin = 0.3;
+static const Double_t kDefTanMax = 3.0;
+static const UInt_t   kDefNbins  = 2700;
+static const UInt_t   kMaxNbins  = 1000000;
+
+namespace VDC {
+
+//_____________________________________________________________________________
+LookupTTDConv::LookupTTDConv()
+  : fTanMin(kDefTanMin), fTanMax(kDefTanMax), fNbins(kDefNbins), fInvStep(0)
+{
+  // Constructor
+}
+
+//_____________________________________________________________________________
+void LookupTTDConv::LookupCorrections( Double_t tanTheta, Double_t& a1,
+                                       Double_t& a2 ) const
+{
+  // Get correction parameters a1 and a2 for the given track slope
+
+  Double_t x = (tanTheta - fTanMin) * fInvStep;
+  if( !(x >= 0.0 && x < static_cast<Double_t>(fNbins)) ) { // also catches NaN
+    CalcCorrections(tanTheta, a1, a2);
+    return;
+  }
+  auto i = static_cast<UInt_t>(x);
+  Double_t f = x - i;
+  a1 = fA1Table[i] + f * (fA1Table[i+1] - fA1Table[i]);
+  a2 = fA2Table[i] + f * (fA2Table[i+1] - fA2Table[i]);
+}
+
+//_____________________________________________________________________________
+Double_t LookupTTDConv::ConvertTimeToDist( Double_t time, Double_t tanTheta,
+                                           Double_t* ddist ) const
+{
+  // Drift Velocity in m/s
+  // time in s
+  // Return m
+
+  if( !fIsSet ) {
+    Error( "VDC::LookupTTDConv::ConvertTimeToDist", "Parameters not set. "
+           "Fix database." );
+    return kBig;
+  }
+
+  Double_t a1 = 0.0, a2 = 0.0;
+  LookupCorrections(tanTheta, a1, a2);
+  return CalcDist(time, a1, a2, ddist);
+}
+
+//_____________________________________________________________________________
+void LookupTTDConv::ConvertTimeToDist( THaVDCHit* const* hits, UInt_t n,
+                                       Double_t tanTheta ) const
+{
+  // Convert the drift times of all 'n' hits of a cluster with slope
+  // 'tanTheta'
+
+  if( !fIsSet ) {
+    TimeToDistConv::ConvertTimeToDist(hits, n, tanTheta);
+    return;
+  }
+  Double_t a1 = 0.0, a2 = 0.0;
+  LookupCorrections(tanTheta, a1, a2);
+  for( UInt_t i = 0; i < n; ++i ) {
+    Double_t ddist = 0.0;
+    hits[i]->SetDist(CalcDist(hits[i]->GetTime(), a1, a2, &ddist));
+    hits[i]->SetdDist(ddist);
+  }
+}
+
+//_____________________________________________________________________________
+Double_t LookupTTDConv::GetParameter( UInt_t i ) const
+{
+  // Get i-th parameter
+
+  switch(i) {
+  case 9:
+    return fTanMin;
+  case 10:
+    return fTanMax;
+  case 11:
+    return fNbins;
+  default:
+    return AnalyticTTDConv::GetParameter(i);
+  }
+}
+
+//_____________________________________________________________________________
+Int_t LookupTTDConv::MakeTable()
+{
+  // Tabulate the correction parameters
+
+  if( !(fTanMax > fTanMin) || fTanMin <= 0.0 || fNbins == 0 ||
+      fNbins > kMaxNbins ) {
+    Error( "VDC::LookupTTDConv::SetParameters", "Invalid table parameters "
+           "min = %lf, max = %lf, nbins = %u. Fix database.",
+           fTanMin, fTanMax, fNbins );
+    return -2;
+  }
+  Double_t step = (fTanMax - fTanMin) / fNbins;
+  fInvStep = 1.0 / step;
+  fA1Table.resize(fNbins+1);
+  fA2Table.resize(fNbins+1);
+  for( UInt_t i = 0; i <= fNbins; ++i )
+    CalcCorrections(fTanMin + i * step, fA1Table[i], fA2Table[i]);
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t LookupTTDConv::SetParameters( const vector<double>& parameters )
+{
+  // Set parameters of AnalyticTTDConv (0-8) and, optionally, the table
+  // range (9: min tan(theta), 10: max tan(theta), 11: number of intervals)
+
+  Int_t ret = AnalyticTTDConv::SetParameters(parameters);
+  if( ret )
+    return ret;
+
+  fTanMin = kDefTanMin;
+  fTanMax = kDefTanMax;
+  fNbins  = kDefNbins;
+  if( parameters.size() > 9 ) {
+    if( parameters.size() < 12 ) {
+      Error( "VDC::LookupTTDConv::SetParameters", "Table parameters must "
+             "be given as min tan(theta), max tan(theta), number of "
+             "intervals. Fix database." );
+      fIsSet = false;
+      return -1;
+    }
+    fTanMin = parameters[9];
+    fTanMax = parameters[10];
+    fNbins  = (parameters[11] > 0 && parameters[11] <= kMaxNbins)
+      ? static_cast<UInt_t>(parameters[11]) : 0;
+  }
+  if( (ret = MakeTable()) != 0 )
+    fIsSet = false;
+  return ret;
+}
+
+} //namespace VDC
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,50 @@
+#ifndef Podd_VDC_LookupTTDConv_h_
+#define Podd_VDC_LookupTTDConv_h_
+
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// THaVDCLookupTTDConv                                                       //
+//                                                                           //
+// Analytic time-to-distance conversion with tabulated track angle           //
+// corrections                                                               //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include "THaVDCAnalyticTTDConv.h"
+
+namespace VDC {
+
+  class LookupTTDConv : public AnalyticTTDConv {
+
+  public:
+    LookupTTDConv();
+    virtual ~LookupTTDConv() = default;
+
+    virtual Double_t ConvertTimeToDist( Double_t time, Double_t tanTheta,
+                                        Double_t* ddist=0 ) const;
+    virtual void     ConvertTimeToDist( THaVDCHit* const* hits, UInt_t n,
+                                        Double_t tanTheta ) const;
+    virtual Double_t GetParameter( UInt_t i ) const;
+    virtual Int_t    SetParameters( const std::vector<double>& param );
+
+protected:
+
+    void  LookupCorrections( Double_t tanTheta, Double_t& a1,
+                             Double_t& a2 ) const;
+    Int_t MakeTable();
+
+    // Table of correction parameters a1, a2 vs. tan(theta)
+    Double_t fTanMin;     // Lower edge of table range
+    Double_t fTanMax;     // Upper edge of table range
+    UInt_t   fNbins;      // Number of intervals in table
+    Double_t fInvStep;    // Inverse of table step size
+    std::vector<Double_t> fA1Table;  // a1 at fTanMin + i/fInvStep
+    std::vector<Double_t> fA2Table;  // a2 at fTanMin + i/fInvStep
+
+    ClassDef(LookupTTDConv,0)   // VDC lookup table TTD Conv class
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
@@ -16,6 +16,7 @@
 
 #include "THaVDC.h"
 #include "THaVDCPlane.h"
+#include "MethodAccessor.h"
 #include "THaVDCWire.h"
 #include "THaVDCChamber.h"
 #include "THaVDCCluster.h"
@@ -28,6 +29,8 @@
 #include "TMath.h"
 #include "VarDef.h"
 #include "THaApparatus.h"
+#include "SimDecoder.h"
+#include "HitCacheWriter.h"
 
 #include <cstring>
 #include <vector>
@@ -36,6 +39,7 @@
 #include <stdexcept>
 #include <set>
 #include <iomanip>
+#include <algorithm>
 
 #ifdef CLUST_RAWDATA_HACK
 #include <fstream>
@@ -60,7 +64,8 @@ THaVDCPlane::THaVDCPlane( const char* name, const char* description,
   fWBeg(0), fWSpac(0), fWAngle(0), fSinWAngle(0),
   fCosWAngle(1), /*fTable(0),*/ fTTDConv(nullptr),
   fVDC{dynamic_cast<THaVDC*>( GetMainDetector() )},
-  fMaxData(kMaxUInt), fNextHit(0), fPrevWire(nullptr)
+  fMaxData(kMaxUInt), fNextHit(0), fPrevWire(nullptr), fTimeCorrDone(false),
+  fHitsInOrder(true)
 {
   // Constructor
 }
@@ -491,7 +496,9 @@ void THaVDCPlane::Clear( Option_t* opt )
   THaSubDetector::Clear(opt);
   fNHits = fNWiresHit = 0;
   fHits->Clear();
-  fClusters->Delete();
+  // Keep the cluster objects and their hit arrays for reuse in the next
+  // event (see FindClusters)
+  fClusters->Clear("C");
 }
 
 //_____________________________________________________________________________
@@ -550,8 +557,14 @@ Int_t THaVDCPlane::StoreHit( const DigitizerHitInfo_t& hitinfo, UInt_t data )
     }
   }
 
-  // Record hit on this wire
-  new((*fHits)[fNextHit++])  THaVDCHit(wire, data, time, hitinfo.nhit);
+  // Record hit on this wire. Note whether the hits are still in the order
+  // needed by FindClusters, which is usually the case if the detector map
+  // lists the channels in wire order
+  auto* hit = new((*fHits)[fNextHit++])  THaVDCHit(wire, data, time,
+                                                   hitinfo.nhit);
+  if( fHitsInOrder && fNextHit > 1 &&
+      THaVDCHit::ByWireThenTime()(hit, GetHit(fNextHit-2)) )
+    fHitsInOrder = false;
 
   return 0;
 }
@@ -571,6 +584,17 @@ Int_t THaVDCPlane::Decode( const THaEvData& evData )
   fNextHit = 0;
   fMaxData = -1;
   fPrevWire = nullptr;
+  fTimeCorrDone = false;
+  fHitsInOrder = true;
+
+  // Hits injected by a SimDecoder (e.g. replay of a hit cache)
+  if( DecodeDirectHits(evData) >= 0 )
+    return GetNHits();
+
+  // Record the hits if a hit cache is being written
+  Podd::HitCacheWriter::Columns_t* cache = nullptr;
+  if( auto* writer = Podd::HitCacheWriter::GetActive() )
+    cache = writer->GetColumns(GetPrefix());
 
   auto hitIter = fDetMap->MakeMultiHitIterator(evData);
   while( hitIter ) {
@@ -587,6 +611,8 @@ Int_t THaVDCPlane::Decode( const THaEvData& evData )
 
     // Store hit data in fHits
     StoreHit(hitinfo, data.value());
+    if( cache )
+      cache->Add(hitinfo.type, hitinfo.lchan, data.value());
 
     // Next active hit or channel
     ++hitIter;
@@ -594,7 +620,8 @@ Int_t THaVDCPlane::Decode( const THaEvData& evData )
 
   // Sort the hits in order of increasing wire number and (for the same wire
   // number) increasing time (NOT rawtime)
-  fHits->Sort();
+  if( !fHitsInOrder )
+    SortHits();
 
   if( has_warning )
     ++fNEventsWithWarnings;
@@ -607,6 +634,92 @@ Int_t THaVDCPlane::Decode( const THaEvData& evData )
   return GetNHits();
 }
 
+//_____________________________________________________________________________
+Int_t THaVDCPlane::DecodeDirectHits( const THaEvData& evData )
+{
+  // Store the hits that a Podd::SimDecoder injected for this plane.
+  // Consecutive hits on the same wire are treated as multiple hits of one
+  // TDC channel, in the order in which they were injected. Returns the
+  // number of hits, or -1 if 'evData' does not inject hits for this plane.
+
+  const auto* simdec = dynamic_cast<const Podd::SimDecoder*>(&evData);
+  if( !simdec || !simdec->IsDirectMode() )
+    return -1;
+  const auto* hits = simdec->GetDirectHits(GetPrefix());
+  if( !hits )
+    return -1;
+
+  DigitizerHitInfo_t hitinfo;
+  hitinfo.ev = evData.GetEvNum();
+  size_t n = hits->size();
+  for( size_t i = 0; i < n; ) {
+    size_t j = i + 1;
+    while( j < n && (*hits)[j].lchan == (*hits)[i].lchan )
+      ++j;
+    for( size_t k = i; k < j; ++k ) {
+      const auto& hit = (*hits)[k];
+      if( hit.lchan < 0 || hit.lchan >= GetNWires() )
+        continue;
+      hitinfo.type  = hit.type;
+      hitinfo.lchan = hitinfo.chan = hit.lchan;
+      hitinfo.nhit  = j - i;
+      hitinfo.hit   = k - i;
+      StoreHit(hitinfo, hit.data);
+    }
+    i = j;
+  }
+  if( !fHitsInOrder )
+    SortHits();
+
+  return static_cast<Int_t>(n);
+}
+
+//_____________________________________________________________________________
+void THaVDCPlane::SortHits()
+{
+  // Sort the hits by wire number and then by time. Since wire numbers are
+  // small integers, this is a counting sort by wire into a scratch array,
+  // followed by an insertion sort that only has to order the (few) hits
+  // on each wire by time. The sorted hits are copied back into fHits.
+
+  Int_t nhits = GetNHits();
+  UInt_t nwires = GetNWires();
+  fWireCount.assign(nwires + 1, 0);
+  for( Int_t i = 0; i < nhits; ++i ) {
+    UInt_t w = GetHit(i)->GetWireNum();
+    if( w >= nwires ) {
+      // Cannot happen with wires from GetWire(), but be safe
+      fHits->Sort();
+      return;
+    }
+    ++fWireCount[w + 1];
+  }
+  for( UInt_t w = 1; w <= nwires; ++w )
+    fWireCount[w] += fWireCount[w - 1];
+
+  fHitBuf.resize(nhits);
+  for( Int_t i = 0; i < nhits; ++i ) {
+    THaVDCHit* hit = GetHit(i);
+    fHitBuf[fWireCount[hit->GetWireNum()]++] = *hit;
+  }
+
+  THaVDCHit::ByWireThenTime isless;
+  for( Int_t i = 1; i < nhits; ++i ) {
+    if( !isless(&fHitBuf[i], &fHitBuf[i - 1]) )
+      continue;
+    THaVDCHit tmp = fHitBuf[i];
+    Int_t j = i;
+    do {
+      fHitBuf[j] = fHitBuf[j - 1];
+      --j;
+    } while( j > 0 && isless(&tmp, &fHitBuf[j - 1]) );
+    fHitBuf[j] = tmp;
+  }
+
+  for( Int_t i = 0; i < nhits; ++i )
+    *GetHit(i) = fHitBuf[i];
+}
+
 //_____________________________________________________________________________
 void THaVDCPlane::PrintDecodedData( const THaEvData& /*evdata*/ ) const
 {
@@ -647,9 +760,12 @@ void THaVDCPlane::PrintDecodedData( const THaEvData& /*evdata*/ ) const
 Int_t THaVDCPlane::ApplyTimeCorrection()
 {
   // Correct drift times of all hits by GetTimeCorrection() from the VDC
-  // parent detector
+  // parent detector. FindClusters() applies the correction itself in its
+  // first pass over the hits, so calling this is only needed if the
+  // corrected times are wanted without clustering. The correction is
+  // applied at most once per event.
 
-  if( fVDC ) {
+  if( fVDC && !fTimeCorrDone ) {
     auto r = fVDC->GetTimeCorrection();
     if( r.second ) {
       Double_t evtT0 = r.first;
@@ -660,6 +776,7 @@ Int_t THaVDCPlane::ApplyTimeCorrection()
       }
     }
   }
+  fTimeCorrDone = true;
   return 0;
 }
 
@@ -715,33 +832,59 @@ Int_t THaVDCPlane::FindClusters()
 
   TimeCut timecut(fVDC, this);
 
-  Int_t nHits = GetNHits();   // Number of hits in the plane
+  // Drift time correction obtained in the Decode stage (see
+  // ApplyTimeCorrection), applied in the same pass as the time cuts
+  Double_t evtT0 = 0.0;
+  if( fVDC && !fTimeCorrDone ) {
+    auto r = fVDC->GetTimeCorrection();
+    if( r.second )
+      evtT0 = r.first;
+  }
+  fTimeCorrDone = true;
+
+  // Apply the time cuts once. Hits failing them are never considered.
+  // The hits are already sorted by wire number and time (see Decode).
+  // A common time offset does not change this order.
+  // Storage for the hit lists is kept across events.
+  vector<THaVDCHit*>& candhits = fCandHits;
+  vector<THaVDCHit*>& clushits = fClusHits;
+  candhits.clear();
+  for( Int_t i = 0, n = GetNHits(); i < n; ++i ) {
+    THaVDCHit* hit = GetHit(i);
+    assert(hit);
+    if( evtT0 != 0.0 )
+      hit->SetTime(hit->GetTime() - evtT0);
+    if( timecut(hit) )
+      candhits.push_back(hit);
+  }
+
+  Int_t nHits = 0;            // Number of candidate hits
   Int_t nUsed = 0;                // Number of wires used in clustering
   Int_t nLastUsed = -1;
   Int_t nextClust = 0;            // Current cluster number
   assert(GetNClusters() == 0);
 
-  vector<THaVDCHit*> clushits;
-  clushits.reserve(nHits);
-
   fNpass = 0;
 
   //  Loop while we're making new clusters
   while( nLastUsed != nUsed ) {
     fNpass++;
     nLastUsed = nUsed;
-    //Loop through all TDC hits
+    // Drop hits assigned in the previous pass. They can neither start
+    // (ClsNum -1) nor extend (-1 or -3) a cluster.
+    candhits.erase( remove_if( candhits.begin(), candhits.end(),
+                               []( const THaVDCHit* h ) {
+                                 return h->GetClsNum() != -1 &&
+                                   h->GetClsNum() != -3;
+                               }), candhits.end() );
+    nHits = static_cast<Int_t>(candhits.size());
+    //Loop through all candidate TDC hits
     for( Int_t i = 0; i < nHits; ) {
       clushits.clear();
       Bool_t falling = true;
 
-      THaVDCHit* hit = GetHit(i);
-      assert(hit);
+      THaVDCHit* hit = candhits[i];
 
-      if( !timecut(hit) ) {
-        ++i;
-        continue;
-      }
       if( hit->GetClsNum() != -1 ) {
         ++i;
         continue;
@@ -759,10 +902,7 @@ Int_t THaVDCPlane::FindClusters()
       Int_t nwires = 1;
       while( ++i < nHits ) {
 
-        THaVDCHit* nextHit = GetHit(i);
-        assert(nextHit);    // should never happen, else bug in Decode
-        if( !timecut(nextHit))
-          continue;
+        THaVDCHit* nextHit = candhits[i];
         if( nextHit->GetClsNum() != -1  && // -1 is virgin
             nextHit->GetClsNum() != -3 )   // -3 was considered to start a cluster but is not in cluster
           continue;
@@ -834,7 +974,9 @@ Int_t THaVDCPlane::FindClusters()
       // Also, make sure that we did indeed see the time
       // spectrum turn around at some point
       if( nwires >= fMinClustSize && !falling ) {
-        auto* clust = new((*fClusters)[nextClust++]) THaVDCCluster(this);
+        auto* clust =
+          static_cast<THaVDCCluster*>( fClusters->ConstructedAt(nextClust++) );
+        clust->SetPlane(this);
         for( auto* clushit : clushits ) {
           clushit->SetClsNum(nextClust - 1);
           clust->AddHit(clushit);
@@ -913,3 +1055,7 @@ Bool_t THaVDCPlane::IsInActiveArea( Double_t x, Double_t y ) const
 
 ///////////////////////////////////////////////////////////////////////////////
 ClassImp(THaVDCPlane)
+
+// Compiled accessors for functions used in global variable definitions
+PODD_REGISTER_METHOD(THaVDCPlane, GetNHits)
+PODD_REGISTER_METHOD(THaVDCPlane, GetNClusters)
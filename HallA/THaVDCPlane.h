@@ -32,6 +32,7 @@ public:
 
   virtual void    Clear( Option_t* opt="" );
   virtual Int_t   Decode( const THaEvData& ); // Raw data -> hits
+  virtual Bool_t  SupportsDirectHits() const { return true; }
   virtual Int_t   ApplyTimeCorrection();      // Drift time correction
   virtual Int_t   FindClusters();             // Hits -> clusters
   virtual Int_t   FitTracks();                // Clusters -> tracks
@@ -130,7 +131,15 @@ protected:
   UInt_t fMaxData;
   Int_t  fNextHit;
   THaVDCWire* fPrevWire;
-
+  Bool_t fTimeCorrDone;   // Drift time correction applied to this event's hits
+  Bool_t fHitsInOrder;    // Hits were stored in wire-then-time order
+  std::vector<THaVDCHit> fHitBuf;     // Scratch copies of hits (SortHits)
+  std::vector<UInt_t>    fWireCount;  // Hit counts per wire (SortHits)
+  std::vector<THaVDCHit*> fCandHits;  // Hits passing time cuts (FindClusters)
+  std::vector<THaVDCHit*> fClusHits;  // Hits of current cluster (FindClusters)
+
+  void          SortHits();
+  Int_t         DecodeDirectHits( const THaEvData& evData );
   virtual void  MakePrefix();
   virtual Int_t ReadDatabase( const TDatime& date );
   virtual Int_t DefineVariables( EMode mode = kDefine );
@@ -5,6 +5,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "THaVDCTimeToDistConv.h"
+#include "THaVDCHit.h"
 
 using namespace std;
 
@@ -19,6 +20,20 @@ TimeToDistConv::TimeToDistConv( UInt_t npar )
   // Constructor
 }
 
+//_____________________________________________________________________________
+void TimeToDistConv::ConvertTimeToDist( THaVDCHit* const* hits, UInt_t n,
+                                        Double_t tanTheta ) const
+{
+  // Convert the drift times of all 'n' hits of a cluster. The default
+  // implementation converts each hit individually.
+
+  for( UInt_t i = 0; i < n; ++i ) {
+    Double_t ddist = hits[i]->GetdDist();
+    hits[i]->SetDist(ConvertTimeToDist(hits[i]->GetTime(), tanTheta, &ddist));
+    hits[i]->SetdDist(ddist);
+  }
+}
+
 //_____________________________________________________________________________
 void TimeToDistConv::SetDriftVel( Double_t v )
 {
@@ -13,6 +13,8 @@
 #include "DataType.h"
 #include <vector>
 
+class THaVDCHit;
+
 namespace VDC {
 
   class TimeToDistConv {
@@ -22,6 +24,10 @@ namespace VDC {
 
     virtual Double_t ConvertTimeToDist( Double_t time, Double_t tanTheta,
 					Double_t* ddist = 0 ) const = 0;
+    // Convert the drift times of 'n' hits of a cluster with slope 'tanTheta'
+    // and store the distances in the hits
+    virtual void     ConvertTimeToDist( THaVDCHit* const* hits, UInt_t n,
+                                        Double_t tanTheta ) const;
     Double_t         GetDriftVel() { return fDriftVel; }
     virtual Double_t GetParameter( UInt_t ) const { return kBig; }
     void             SetDriftVel( Double_t v );
@@ -91,7 +91,7 @@ TwoarmVDCTimeCorrection::Init( const TDatime& run_time )
       { detdef.fName + ".lt_c",   detdef.fLT }
     };
     for( const auto& vardef : vardefs ) {
-      vardef.pvar = gHaVars->Find(vardef.name); // sets the relevant THaVar
+      vardef.pvar = GetVarList()->Find(vardef.name); // sets the relevant THaVar
                                            // pointer in the current detdef
       if( !vardef.pvar ) {
         Error(Here(here), "Global variable %s not found. "
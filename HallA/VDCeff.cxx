@@ -13,13 +13,18 @@
 // cause errors in this calculation, assumed to be small.               //
 //                                                                      //
 // This module reads a list of global variable names for VDC hit        //
-// spectra (wire numbers) from the database. For each variable, it      //
-// sets up a hit efficiency histogram which is updated every 500        //
-// events (configurable, if desired).                                   //
+// spectra (wire numbers) from the database. If a variable is the       //
+// "wire" variable of a THaVDCPlane, the hits are taken directly from   //
+// the plane; otherwise the variable is read. For each variable, it     //
+// counts hits and efficiency triples per wire in a Podd::Accumulator.  //
+// The histograms are filled from the counters by UpdateHist(), which   //
+// is called at End() and may be called at any time for a snapshot.    //
 //                                                                      //
 //////////////////////////////////////////////////////////////////////////
 
 #include "VDCeff.h"
+#include "THaVDCPlane.h"
+#include "THaVDCHit.h"
 #include "THaVarList.h"
 #include "THaGlobals.h"
 #include "TObjArray.h"
@@ -67,17 +72,14 @@ void VDCeff::VDCvar_t::Reset( Option_t* )
 {
   // Reset histograms and counters of this VDCvar
 
-  if( nwire > 0 ) {
-    ncnt.assign( nwire, 0 );
-    nhit.assign( nwire, 0 );
-  }
+  acc.Clear();
   if( hist_nhit ) hist_nhit->Reset();
   if( hist_eff  ) hist_eff->Reset();
 }
 
 //_____________________________________________________________________________
 VDCeff::VDCeff( const char* name, const char* description )
-  : THaPhysicsModule(name,description), fNevt(0), fCycle(500), fMaxOcc(0.25)
+  : THaPhysicsModule(name,description), fNevt(0), fMaxOcc(0.25)
 {
   // VDCeff module constructor
 
@@ -111,8 +113,7 @@ Int_t VDCeff::Begin( THaRunBase* )
 
   for( auto& thePlane : fVDCvar ) {
     assert( thePlane.nwire > 0 );
-    thePlane.ncnt.assign( thePlane.nwire, 0 );
-    thePlane.nhit.assign( thePlane.nwire, 0 );
+    thePlane.acc.Clear();
     // Book histograms here, not in Init. The output file must be open for the
     // histogram to be saved. This is the case here, but not when Init runs.
     if( !thePlane.hist_nhit ) {
@@ -138,6 +139,7 @@ Int_t VDCeff::End( THaRunBase* )
 {
   // End of analysis
 
+  UpdateHist();
   WriteHist();
   return 0;
 }
@@ -155,11 +157,20 @@ THaAnalysisObject::EStatus VDCeff::Init( const TDatime& run_time )
     return fStatus;
 
   // Associate global variable pointers. This can and should be done
-  // at every reinitialization (pointers in VDC class may have changed)
+  // at every reinitialization (pointers in VDC class may have changed).
+  // For the "wire" variable of a VDC plane, use the plane's hits directly.
   for( auto& thePlane : fVDCvar ) {
     assert( !thePlane.name.IsNull() );
-    thePlane.pvar = gHaVars->Find( thePlane.name );
-    if( !thePlane.pvar ) {
+    thePlane.plane = nullptr;
+    if( thePlane.name.EndsWith(".wire") ) {
+      TString planename = thePlane.name(0, thePlane.name.Length()-5);
+      thePlane.plane = static_cast<const THaVDCPlane*>
+	( FindModule( planename.Data(), "THaVDCPlane", false ));
+      fStatus = kOK;  // FindModule sets kInitError if not found
+    }
+    thePlane.pvar = thePlane.plane ? nullptr
+      : GetVarList()->Find( thePlane.name );
+    if( !thePlane.plane && !thePlane.pvar ) {
       Warning( Here(here), "Cannot find global VDC variable %s. Ignoring.",
 	       thePlane.name.Data() );
     }
@@ -168,75 +179,86 @@ THaAnalysisObject::EStatus VDCeff::Init( const TDatime& run_time )
   return fStatus = kOK;
 }
 
+//_____________________________________________________________________________
+inline Int_t VDCeff::AddHit( Int_t wire, Int_t nwire )
+{
+  // Mark 'wire' as hit in the current plane. Multiple hits on the same
+  // wire count once. Returns 1 if the wire is valid.
+
+  if( wire < 0 || wire >= nwire )
+    return 0;
+  if( !fHitWire[wire] ) {
+    fHitWire[wire] = true;
+    fWire.push_back(static_cast<Short_t>(wire));
+  }
+  return 1;
+}
+
+//_____________________________________________________________________________
+void VDCeff::CountPlane( VDCvar_t& thePlane, Int_t nhit )
+{
+  // Update the counters of thePlane with the wires in fWire/fHitWire,
+  // then clear the bits that were set
+
+  Int_t nwire = thePlane.nwire;
+  Podd::Accumulator& acc = thePlane.acc;
+  acc.NewEvent();
+  acc.Incr( kNevhit, TMath::Min(nhit, nwire) );
+  for( Int_t wire : fWire ) {
+    Int_t ngh2 = wire+2;
+    if( ngh2 < nwire && fHitWire[ngh2] ) {
+      Int_t awire = wire+1;
+      acc.Incr( kNcnt, awire );
+      if( fHitWire[awire] )
+	acc.Incr( kNhit, awire );
+    }
+  }
+  for( Int_t wire : fWire )
+    fHitWire[wire] = false;
+  fWire.clear();
+}
+
 //_____________________________________________________________________________
 Int_t VDCeff::Process( const THaEvData& /*evdata*/ )
 {
-  // Update VDC efficiency histograms with current event data.
-  // The data come from the VDC detector and are accessed via global variables
-  
+  // Update VDC efficiency counters with current event data.
+  // The data come from the VDC planes, or from global variables for
+  // spectra not provided by a VDC plane.
+
   const char* const here = "Process";
 
   if( !IsOK() ) return -1;
 
   ++fNevt;
-  bool cycle_event = ( (fNevt%fCycle) == 0 );
 
   for( auto& thePlane : fVDCvar ) {
 
-    if( !thePlane.pvar ) continue;  // global variable wasn't found
-
     Int_t nwire = thePlane.nwire;
-    fWire.clear();
-    fHitWire.assign( nwire, false );
-
-    Int_t nhit = thePlane.pvar->GetLen();
-    thePlane.hist_nhit->Fill(nhit);
-    if( nhit < 0 ) {
-      Warning( Here(here), "nhit = %d < 0?", nhit );
-      nhit = 0;
-    } else if( nhit > nwire ) {
-      Warning( Here(here), "nhit = %d > nwire = %d?", nhit, nwire );
-      nhit = nwire;
+    Int_t nhit = 0;
+    if( thePlane.plane ) {
+      const THaVDCPlane* plane = thePlane.plane;
+      Int_t n = plane->GetNHits();
+      for( Int_t i = 0; i < n; ++i )
+	nhit += AddHit( plane->GetHit(i)->GetWireNum(), nwire );
     }
-
-    for( Int_t i = 0; i < nhit; ++i ) {
-      auto wire = static_cast<Short_t>(TMath::Nint(thePlane.pvar->GetValue(i)));
-      if( wire >= 0 && wire < nwire ) {
-	fWire.push_back(wire);
-	fHitWire[wire] = true;
-      }
-    }
-
-    for( Int_t wire : fWire ) {
-      Int_t ngh2 = wire+2;
-      if( ngh2 >= nwire ) continue;
-
-      if( fHitWire[ngh2] ) {
-	Int_t awire = wire+1;
-	thePlane.ncnt[awire]++;
-	if( fHitWire[awire] )
-	  thePlane.nhit[awire]++;
+    else if( thePlane.pvar ) {
+      Int_t n = thePlane.pvar->GetLen();
+      if( n < 0 ) {
+	Warning( Here(here), "nhit = %d < 0?", n );
+	n = 0;
+      } else if( n > nwire ) {
+	Warning( Here(here), "nhit = %d > nwire = %d?", n, nwire );
+	n = nwire;
       }
+      for( Int_t i = 0; i < n; ++i )
+	nhit += AddHit( TMath::Nint(thePlane.pvar->GetValue(i)), nwire );
     }
+    else
+      continue;  // global variable wasn't found
 
-    if( cycle_event ) {
-      thePlane.hist_eff->Reset();
-      for( Int_t i = 0; i < nwire; ++i ) {
-	if( thePlane.ncnt[i] != 0 ) {
-	  Double_t xeff = static_cast<Double_t>(thePlane.nhit[i]) /
-	    static_cast<Double_t>(thePlane.ncnt[i]);
-	  thePlane.hist_eff->Fill(i,xeff);
-	}
-      }
-    }
+    CountPlane( thePlane, nhit );
   }
 
-  // FIXME: repeated WriteHist seems to cause problems with split files
-  // (multiple cycles left in output)
-  if( (cycle_event && fNevt < 4*static_cast<Long64_t>(fCycle)) ||
-      (fNevt % (10*fCycle) == 0) )
-    WriteHist();
-
 #ifdef WITH_DEBUG
   if( fDebug>1 && (fNevt%10) == 0 )
     Print();
@@ -260,14 +282,12 @@ Int_t VDCeff::ReadDatabase( const TDatime& date )
 
   TString configstr;
   // Default values
-  fCycle = 500;
   fMaxOcc = 0.25;
 
   Int_t status = kOK;
   try {
       const DBRequest request[] = {
       { "vdcvars",    &configstr,   kTString },
-      { "cycle",      &fCycle,      kInt,     0, true },
       { "maxocc",     &fMaxOcc,     kDouble,  0, true },
       { nullptr }
     };
@@ -340,8 +360,9 @@ Int_t VDCeff::ReadDatabase( const TDatime& date )
 
     fVDCvar.emplace_back(name, histname, nwire );
     VDCvar_t& thePlane = fVDCvar.back();
-    thePlane.ncnt.reserve( thePlane.nwire );
-    thePlane.nhit.reserve( thePlane.nwire );
+    thePlane.acc.Define( "ncnt", nwire );
+    thePlane.acc.Define( "nhit", nwire );
+    thePlane.acc.Define( "nevhit", nwire+1 );
     max_nwire = TMath::Max(max_nwire,thePlane.nwire);
   }
 
@@ -352,6 +373,17 @@ Int_t VDCeff::ReadDatabase( const TDatime& date )
   return kOK;
 }
 
+//_____________________________________________________________________________
+void VDCeff::UpdateHist()
+{
+  // Fill the histograms from the counters accumulated so far
+
+  for( auto& thePlane : fVDCvar ) {
+    thePlane.acc.FillHist( thePlane.hist_nhit, kNevhit );
+    thePlane.acc.FillRatio( thePlane.hist_eff, kNhit, kNcnt );
+  }
+}
+
 //_____________________________________________________________________________
 void VDCeff::WriteHist()
 {
@@ -8,9 +8,11 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "THaPhysicsModule.h"
+#include "Accumulator.h"
 #include <vector>
 
 class THaVar;
+class THaVDCPlane;
 class TH1F;
 
 class VDCeff : public THaPhysicsModule {
@@ -24,43 +26,50 @@ public:
   virtual Int_t   Process( const THaEvData& );
 
   void            Reset( Option_t* opt="" );
+  void            UpdateHist();
 
 protected:
 
-  typedef std::vector<Long64_t> Vcnt_t;
   typedef const THaVar CVar_t;
 
+  // Counter sets of the accumulator of each plane
+  enum { kNcnt = 0, kNhit, kNevhit };
+
   // Data needed for efficiency calculation for one VDC plane/wire spectrum
   class VDCvar_t {
   public:
     VDCvar_t( const char* nm, const char* hn, Int_t nw )
-      : name(nm), histname(hn), pvar(nullptr), nwire(nw), hist_nhit(nullptr),
-        hist_eff(nullptr) {}
+      : name(nm), histname(hn), pvar(nullptr), plane(nullptr), nwire(nw),
+        hist_nhit(nullptr), hist_eff(nullptr) {}
     ~VDCvar_t();
     void     Reset( Option_t* opt ="" );
     TString  name;
     TString  histname;
     CVar_t*  pvar;
+    const THaVDCPlane* plane;  // Wire plane providing the hits, if found
     Int_t    nwire;
-    Vcnt_t   ncnt;
-    Vcnt_t   nhit;
+    // Per wire: events with hits on both neighbors (kNcnt), and with a
+    // hit on this wire as well (kNhit). Events by number of hits (kNevhit).
+    Podd::Accumulator acc;
     TH1F*    hist_nhit;
     TH1F*    hist_eff;
   };
 
   // Internal working storage
   std::vector<VDCvar_t>  fVDCvar;
-  std::vector<Short_t>   fWire;
-  std::vector<bool>      fHitWire;
+  std::vector<Short_t>   fWire;     // Wires hit in current plane, no duplicates
+  std::vector<bool>      fHitWire;  // Bit set of fWire
 
   Long64_t  fNevt;
 
   // Configuration parameters
-  Int_t     fCycle;
   Double_t  fMaxOcc;
 
   virtual Int_t ReadDatabase( const TDatime& date );
 
+  Int_t AddHit( Int_t wire, Int_t nwire );
+  void  CountPlane( VDCvar_t& thePlane, Int_t nhit );
+
   void WriteHist();
 
   ClassDef(VDCeff,0)   // VDC hit efficiency physics module
@@ -0,0 +1,148 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::Accumulator
+//
+// Per-channel event counters for analysis modules. Typical use:
+//
+//   Init:     fHitSet = fAcc.Define("hits", nchan);
+//   Begin:    fAcc.Clear();
+//   Process:  fAcc.NewEvent();  fAcc.Incr(fHitSet, chan);
+//   End:      fAcc.FillRate(hist, fHitSet);   // occupancy per channel
+//
+// Set and channel indices are not checked in the per-event methods.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Accumulator.h"
+#include "TH1.h"
+#include "TError.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+Int_t Accumulator::Define( const char* name, UInt_t nchan )
+{
+  // Add a set of 'nchan' counters called 'name'. Returns the index of the
+  // new set for use with Incr etc., or -1 if the name is already defined.
+
+  if( Find(name) >= 0 ) {
+    ::Error( "Accumulator::Define", "Counter set %s already defined", name );
+    return -1;
+  }
+  if( fOffset.empty() )
+    fOffset.push_back(0);
+  fNames.emplace_back(name ? name : "");
+  fOffset.push_back(fOffset.back() + nchan);
+  fData.resize(fOffset.back(), 0);
+  return static_cast<Int_t>(fNames.size()) - 1;
+}
+
+//_____________________________________________________________________________
+Int_t Accumulator::Find( const char* name ) const
+{
+  // Index of the counter set 'name', or -1 if not defined
+
+  auto it = find(fNames.begin(), fNames.end(), name ? name : "");
+  return (it != fNames.end()) ? static_cast<Int_t>(it - fNames.begin()) : -1;
+}
+
+//_____________________________________________________________________________
+void Accumulator::Clear()
+{
+  // Zero all counters and the event count
+
+  fill(fData.begin(), fData.end(), 0);
+  fNevents = 0;
+}
+
+//_____________________________________________________________________________
+Int_t Accumulator::Merge( const Accumulator& rhs )
+{
+  // Add the counters of 'rhs', which must have the same counter sets.
+  // Returns 0 if ok, -1 if the layouts differ.
+
+  if( rhs.fNames != fNames || rhs.fOffset != fOffset ) {
+    ::Error( "Accumulator::Merge", "Cannot merge accumulators with "
+             "different counter sets" );
+    return -1;
+  }
+  for( size_t i = 0; i < fData.size(); ++i )
+    fData[i] += rhs.fData[i];
+  fNevents += rhs.fNevents;
+  return 0;
+}
+
+//_____________________________________________________________________________
+Double_t Accumulator::GetRate( UInt_t set, UInt_t chan ) const
+{
+  // Counts of channel 'chan' of 'set' per event
+
+  return (fNevents > 0) ? static_cast<Double_t>(Get(set, chan)) / fNevents : 0;
+}
+
+//_____________________________________________________________________________
+Double_t Accumulator::GetRatio( UInt_t num, UInt_t den, UInt_t chan ) const
+{
+  // Ratio of the counts of channel 'chan' in sets 'num' and 'den', e.g. an
+  // efficiency. Zero if the denominator is zero.
+
+  Count_t d = Get(den, chan);
+  return (d != 0) ? static_cast<Double_t>(Get(num, chan)) / d : 0;
+}
+
+//_____________________________________________________________________________
+void Accumulator::FillHist( TH1* h, UInt_t set, Double_t x0 ) const
+{
+  // Replace the contents of 'h' with the counts of 'set', where channel i
+  // is at x = x0 + i. The number of entries is the sum of the counts.
+
+  if( !h )
+    return;
+  h->Reset();
+  Count_t nent = 0;
+  const Count_t* c = GetCounts(set);
+  for( UInt_t i = 0; i < GetNchan(set); ++i ) {
+    if( c[i] != 0 ) {
+      h->Fill(x0 + i, static_cast<Double_t>(c[i]));
+      nent += c[i];
+    }
+  }
+  h->SetEntries(static_cast<Double_t>(nent));
+}
+
+//_____________________________________________________________________________
+void Accumulator::FillRate( TH1* h, UInt_t set, Double_t x0 ) const
+{
+  // Replace the contents of 'h' with the counts per event of 'set', e.g.
+  // the occupancy of each channel, where channel i is at x = x0 + i
+
+  if( !h )
+    return;
+  h->Reset();
+  for( UInt_t i = 0; i < GetNchan(set); ++i ) {
+    if( Get(set, i) != 0 )
+      h->Fill(x0 + i, GetRate(set, i));
+  }
+}
+
+//_____________________________________________________________________________
+void Accumulator::FillRatio( TH1* h, UInt_t num, UInt_t den, Double_t x0 ) const
+{
+  // Replace the contents of 'h' with the ratio of the counts of sets 'num'
+  // and 'den', e.g. an efficiency per channel. Channels with zero
+  // denominator are left empty.
+
+  if( !h )
+    return;
+  h->Reset();
+  UInt_t n = min(GetNchan(num), GetNchan(den));
+  for( UInt_t i = 0; i < n; ++i ) {
+    if( Get(den, i) != 0 )
+      h->Fill(x0 + i, GetRatio(num, den, i));
+  }
+}
+
+} // namespace Podd
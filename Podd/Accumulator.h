@@ -0,0 +1,69 @@
+#ifndef Podd_Accumulator_h_
+#define Podd_Accumulator_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::Accumulator
+//
+// Integer per-channel counters for cheap per-event accumulation in
+// analysis modules, e.g. hit maps, occupancies and the numerators and
+// denominators of efficiencies. Counters are grouped in named sets of
+// channels, stored contiguously. Histograms are filled from the counters
+// only on request, typically at the end of the analysis, so no ROOT
+// histograms need to be updated in the event loop. Accumulators with the
+// same layout can be merged, e.g. the results of several jobs.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <string>
+#include <vector>
+
+class TH1;
+
+namespace Podd {
+
+class Accumulator {
+
+public:
+  typedef Long64_t Count_t;
+
+  Accumulator() : fNevents(0) {}
+
+  Int_t    Define( const char* name, UInt_t nchan );
+  Int_t    Find( const char* name ) const;
+  void     Clear();
+  Int_t    Merge( const Accumulator& rhs );
+
+  // Per-event updates
+  void     NewEvent() { ++fNevents; }
+  void     Incr( UInt_t set, UInt_t chan ) { ++fData[fOffset[set] + chan]; }
+  void     Add( UInt_t set, UInt_t chan, Count_t n )
+  { fData[fOffset[set] + chan] += n; }
+
+  Count_t  Get( UInt_t set, UInt_t chan ) const
+  { return fData[fOffset[set] + chan]; }
+  const Count_t* GetCounts( UInt_t set ) const
+  { return fData.data() + fOffset[set]; }
+  UInt_t   GetNchan( UInt_t set ) const
+  { return fOffset[set+1] - fOffset[set]; }
+  UInt_t   GetNsets()   const { return fNames.size(); }
+  Long64_t GetNevents() const { return fNevents; }
+  Double_t GetRate( UInt_t set, UInt_t chan ) const;
+  Double_t GetRatio( UInt_t num, UInt_t den, UInt_t chan ) const;
+
+  // Histograms from the counters (contents are replaced)
+  void     FillHist( TH1* h, UInt_t set, Double_t x0 = 0 ) const;
+  void     FillRate( TH1* h, UInt_t set, Double_t x0 = 0 ) const;
+  void     FillRatio( TH1* h, UInt_t num, UInt_t den, Double_t x0 = 0 ) const;
+
+private:
+  std::vector<std::string> fNames;   // Names of counter sets
+  std::vector<UInt_t>      fOffset;  // Start of each set in fData, plus end
+  std::vector<Count_t>     fData;    // Counters of all sets
+  Long64_t                 fNevents; // Number of events (NewEvent calls)
+};
+
+} // namespace Podd
+
+#endif
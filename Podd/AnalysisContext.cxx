@@ -0,0 +1,99 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::AnalysisContext
+//
+// Bundles the lists of global variables and cuts and the current run
+// used by analysis objects during initialization and event processing.
+//
+// The default context, returned by GetDefault(), refers to the traditional
+// globals gHaVars, gHaCuts and gHaRun. Analysis objects that have not been
+// given a context use it, so existing code and scripts keep working
+// unchanged.
+//
+// A context constructed with kOwnLists creates its own THaVarList and
+// THaCutList. Modules initialized with such a context (see
+// THaAnalyzer::SetContext and THaAnalysisObject::SetContext) register their
+// variables there instead of in gHaVars, which allows several independent
+// analyzer setups to coexist, for example one per thread. The context must
+// outlive all analysis objects that use it since their destructors remove
+// their variables from the context's list.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "AnalysisContext.h"
+#include "THaGlobals.h"
+#include "THaVarList.h"
+#include "THaCutList.h"
+#include "THaRunBase.h"
+
+namespace Podd {
+
+//_____________________________________________________________________________
+AnalysisContext::AnalysisContext()
+  : fVars(nullptr), fCuts(nullptr), fRun(nullptr), fOwnLists(false)
+{
+  // Construct context referring to the global variable and cut lists
+}
+
+//_____________________________________________________________________________
+AnalysisContext::AnalysisContext( EOwnLists )
+  : fVars(new THaVarList), fCuts(nullptr), fRun(nullptr), fOwnLists(true)
+{
+  // Construct context with its own variable and cut lists
+
+  fCuts = new THaCutList(fVars);
+}
+
+//_____________________________________________________________________________
+AnalysisContext::~AnalysisContext()
+{
+  // Destructor. Deletes the lists owned by this context.
+
+  if( fOwnLists ) {
+    delete fCuts;
+    delete fVars;
+  }
+}
+
+//_____________________________________________________________________________
+THaVarList* AnalysisContext::GetVars() const
+{
+  return fOwnLists ? fVars : gHaVars;
+}
+
+//_____________________________________________________________________________
+THaCutList* AnalysisContext::GetCuts() const
+{
+  return fOwnLists ? fCuts : gHaCuts;
+}
+
+//_____________________________________________________________________________
+THaRunBase* AnalysisContext::GetRun() const
+{
+  return fOwnLists ? fRun : gHaRun;
+}
+
+//_____________________________________________________________________________
+void AnalysisContext::SetRun( THaRunBase* run )
+{
+  // Set the current run. For the global context, this sets gHaRun.
+
+  if( fOwnLists )
+    fRun = run;
+  else
+    gHaRun = run;
+}
+
+//_____________________________________________________________________________
+AnalysisContext& AnalysisContext::GetDefault()
+{
+  // Return the context referring to gHaVars, gHaCuts and gHaRun
+
+  static AnalysisContext gDefault;
+  return gDefault;
+}
+
+} // namespace Podd
+
+//_____________________________________________________________________________
+ClassImp(Podd::AnalysisContext)
@@ -0,0 +1,51 @@
+#ifndef Podd_AnalysisContext_h_
+#define Podd_AnalysisContext_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::AnalysisContext
+//
+// Variable list, cut list and current run seen by a set of analysis
+// objects. Replacement for direct use of gHaVars, gHaCuts and gHaRun.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+
+class THaVarList;
+class THaCutList;
+class THaRunBase;
+
+namespace Podd {
+
+class AnalysisContext {
+
+public:
+  enum EOwnLists { kOwnLists };
+
+  AnalysisContext();
+  explicit AnalysisContext( EOwnLists );
+  AnalysisContext( const AnalysisContext& ) = delete;
+  AnalysisContext& operator=( const AnalysisContext& ) = delete;
+  virtual ~AnalysisContext();
+
+  THaVarList*  GetVars() const;
+  THaCutList*  GetCuts() const;
+  THaRunBase*  GetRun()  const;
+  Bool_t       IsGlobal() const { return !fOwnLists; }
+  void         SetRun( THaRunBase* run );
+
+  static AnalysisContext& GetDefault();
+
+protected:
+  THaVarList*  fVars;      // Private variable list (nullptr: use gHaVars)
+  THaCutList*  fCuts;      // Private cut list (nullptr: use gHaCuts)
+  THaRunBase*  fRun;       // Current run (not owned)
+  Bool_t       fOwnLists;  // This context owns fVars and fCuts
+
+  ClassDef(AnalysisContext,0) // Variables, cuts and run for analysis objects
+};
+
+} // namespace Podd
+
+#endif
@@ -18,6 +18,7 @@
 #include "Helper.h"
 #include <sstream>
 #include <iterator>
+#include <algorithm>
 
 using namespace std;
 using namespace THaString;
@@ -35,7 +36,8 @@ public:
 
 //_____________________________________________________________________________
 BankData::BankData( const char* name, const char* description) :
-  THaPhysicsModule(name,description), Nvars(0), dvars(nullptr), vardata(nullptr)
+  THaPhysicsModule(name,description), Nvars(0), dvars(nullptr),
+  fEvdata(nullptr), fCodaEvdata(nullptr)
 {
   // Normal constructor.
 }
@@ -46,7 +48,6 @@ BankData::~BankData()
   // Destructor
   RemoveVariables();
   delete[] dvars;
-  delete[] vardata;
 }
 
 //_____________________________________________________________________________
@@ -55,19 +56,26 @@ Int_t BankData::Process( const THaEvData& evdata )
 
   if( !IsOK() ) return -1;
 
-  const auto* codaevdata = dynamic_cast<const CodaDecoder*>(&evdata);
-  if( !codaevdata )
+  // The decoder object normally stays the same for the whole run
+  if( &evdata != fEvdata ) {
+    fEvdata = &evdata;
+    fCodaEvdata = dynamic_cast<const CodaDecoder*>(&evdata);
+  }
+  if( !fCodaEvdata )
     return -1;
 
+  // Convert the bank words in place in the event buffer, without an
+  // intermediate copy
   Int_t k=0;
   for( const auto& bankloc : banklocs ) {
-    Int_t ret = codaevdata->FillBankData(vardata, bankloc->roc, bankloc->bank,
-                                         bankloc->offset, bankloc->numwords);
-    if( ret == THaEvData::HED_OK ) {
-      for( Int_t j = 0; j < bankloc->numwords; j++, k++ ) {
-        dvars[k] = vardata[j];
-      }
-    }
+    const UInt_t* data = nullptr;
+    UInt_t ndata = 0;
+    Int_t ret = fCodaEvdata->GetBankData(bankloc->roc, bankloc->bank,
+                                         bankloc->offset, bankloc->numwords,
+                                         data, ndata);
+    if( ret == THaEvData::HED_OK )
+      std::copy(data, data+ndata, dvars+k);
+    k += bankloc->numwords;
   }
 
   fDataValid = true;
@@ -140,9 +148,8 @@ Int_t BankData::ReadDatabase( const TDatime& date )
     return kInitError;
   }
 
-  delete [] vardata;
   delete [] dvars; dvars = nullptr;
-  vardata = new UInt_t[maxwords];
+  fEvdata = nullptr; fCodaEvdata = nullptr;
   if( Nvars > 0 ) {
     dvars = new Double_t[Nvars];
     //DEBUG?
@@ -13,6 +13,7 @@
 #include <memory>
 
 class BankLoc;
+namespace Decoder { class CodaDecoder; }
 
 // FIXME: why is this a PhysicsModule?
 class BankData : public THaPhysicsModule {
@@ -33,7 +34,10 @@ private:
 
   Int_t Nvars;
   Double_t *dvars;  // FIXME: make UInt_t once THaOutput supports integer branches
-  UInt_t *vardata;
+
+  // Decoder of the last event, cast to CodaDecoder
+  const THaEvData*             fEvdata;  //!
+  const Decoder::CodaDecoder*  fCodaEvdata; //!
 
   std::vector<std::unique_ptr<BankLoc>> banklocs;
 
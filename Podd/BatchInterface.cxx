@@ -0,0 +1,184 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::BatchInterface
+//
+// Sets up the analyzer environment (global variable, cut, apparatus and
+// physics module lists, decoder class, time zone) for programs that do
+// not need the interactive ROOT prompt. Unlike THaInterface, it does
+// not create a TRint application, so no rootlogon/rootrc processing,
+// history file or interpreter prompt setup is done, which makes startup
+// of short batch jobs considerably faster. Dictionaries are still
+// loaded by ROOT on demand.
+//
+// Usage in a compiled program:
+//
+//   int main() {
+//     Podd::BatchInterface env;
+//     gHaApps->Add( new THaHRS("R", "Right arm HRS") );
+//     THaAnalyzer analyzer;
+//     ...
+//   }
+//
+// With 'macros' = true, the Podd header directories are made available
+// to the interpreter, as in THaInterface, for running analysis macros
+// with gROOT->Macro().
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "BatchInterface.h"
+#include "THaGlobals.h"
+#include "THaVarList.h"
+#include "THaCutList.h"
+#include "THaAnalyzer.h"
+#include "CodaRawDecoder.h"
+#include "Textvars.h"
+#include "ha_compiledata.h"
+#include "TROOT.h"
+#include "TSystem.h"
+#include "TString.h"
+#include "TRegexp.h"
+#include "TTree.h"
+#include "TInterpreter.h"
+#include "TList.h"
+#include "TError.h"
+
+namespace Podd {
+
+static TString fgTZ;        // User's original time zone
+static Bool_t  fgTZSet = false;
+
+//_____________________________________________________________________________
+BatchInterface::BatchInterface( Bool_t macros ) : fOwner(false)
+{
+  // Set up the analyzer environment. Only one such environment can exist
+  // at a time, either a BatchInterface or a THaInterface.
+
+  if( gHaVars ) {
+    ::Error("BatchInterface", "Analyzer environment already set up");
+    return;
+  }
+  gROOT->SetBatch(true);
+  CreateGlobals();
+  if( macros )
+    AddIncludePaths();
+  SetTimeZone();
+  fOwner = true;
+}
+
+//_____________________________________________________________________________
+BatchInterface::~BatchInterface()
+{
+  // Destructor. Deletes the analyzer and the global lists.
+
+  if( fOwner ) {
+    RestoreTimeZone();
+    DeleteGlobals();
+  }
+}
+
+//_____________________________________________________________________________
+void BatchInterface::CreateGlobals()
+{
+  // Create the analyzer's global lists and set the default decoder
+
+  gHaVars    = new THaVarList;
+  gHaCuts    = new THaCutList( gHaVars );
+  gHaApps    = new TList;
+  gHaPhysics = new TList;
+  gHaEvtHandlers = new TList;
+  // Use the standard CODA file decoder by default
+  gHaDecoder = Podd::CodaRawDecoder::Class();
+  gHaTextvars = new Podd::Textvars;
+
+  // Set the maximum size for a file written by Podd contained by the TTree
+  //  putting it to 1.5 GB, down from the default 1.9 GB since something odd
+  //  happens for larger files
+  //FIXME: investigate
+  TTree::SetMaxTreeSize(1500000000);
+}
+
+//_____________________________________________________________________________
+void BatchInterface::DeleteGlobals()
+{
+  // Delete the analyzer object, if any, and all global lists and the
+  // objects contained in them
+
+  delete THaAnalyzer::GetInstance();
+  delete gHaTextvars; gHaTextvars=nullptr;
+  delete gHaPhysics;   gHaPhysics=nullptr;
+  delete gHaEvtHandlers;  gHaEvtHandlers=nullptr;
+  delete gHaApps;         gHaApps=nullptr;
+  delete gHaVars;         gHaVars=nullptr;
+  delete gHaCuts;         gHaCuts=nullptr;
+}
+
+//_____________________________________________________________________________
+void BatchInterface::AddIncludePaths()
+{
+  // Make the Podd header directory(s) available so scripts don't have to
+  // specify an explicit path.
+  // If $ANALYZER defined, we take our includes from there, otherwise we fall
+  // back to the compile-time directories (which may have moved!)
+
+  TString s = gSystem->Getenv("ANALYZER");
+  if( s.IsNull() ) {
+    s = HA_INCLUDEPATH;
+  } else {
+    // Give preference to $ANALYZER/include
+    TString p = s+"/include";
+    void* dp = gSystem->OpenDirectory(p);
+    if( dp ) {
+      gSystem->FreeDirectory(dp);
+      s = p;
+    } else
+      s = s+"/src " + s+"/hana_decode ";
+  }
+  // Directories names separated by blanks.
+  // FIXME: allow blanks
+  TRegexp re("[^ ]+");
+  TString ss = s(re);
+  while( !ss.IsNull() ) {
+    // Only add dirs that exist
+    void* dp = gSystem->OpenDirectory(ss);
+    if( dp ) {
+      gInterpreter->AddIncludePath(ss);
+      gSystem->FreeDirectory(dp);
+    }
+    s.Remove(0,s.Index(re)+ss.Length());
+    ss = s(re);
+  }
+}
+
+//_____________________________________________________________________________
+void BatchInterface::SetTimeZone()
+{
+  // Because of lack of foresight, the analyzer uses TDatime objects,
+  // which are kept in localtime() and hence are not portable, and also
+  // uses localtime() directly in several places. As a result, database
+  // lookups depend on the timezone of the machine that the replay is done on!
+  // If this timezone is different from the one in which the data were taken,
+  // mismatches may occur. This is bad.
+  // FIXME: Use TTimeStamp to keep time in UTC internally.
+  // To be done in version 1.6
+  //
+  // As a temporary workaround, we assume that all data were taken in
+  // US/Eastern time, and that the database has US/Eastern timestamps.
+  // This is certainly true for all JLab production data..
+
+  fgTZ = gSystem->Getenv("TZ");
+  gSystem->Setenv("TZ","US/Eastern");
+  fgTZSet = true;
+}
+
+//_____________________________________________________________________________
+void BatchInterface::RestoreTimeZone()
+{
+  // Restore the user's original TZ
+
+  if( fgTZSet ) {
+    gSystem->Setenv("TZ",fgTZ.Data());
+    fgTZSet = false;
+  }
+}
+
+} // namespace Podd
@@ -0,0 +1,41 @@
+#ifndef Podd_BatchInterface_h_
+#define Podd_BatchInterface_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::BatchInterface
+//
+// Non-interactive analyzer environment for compiled programs and batch
+// jobs: sets up the analyzer's global lists like THaInterface, but
+// without the TRint interactive session.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+
+namespace Podd {
+
+class BatchInterface {
+
+public:
+  explicit BatchInterface( Bool_t macros = false );
+  BatchInterface( const BatchInterface& ) = delete;
+  BatchInterface& operator=( const BatchInterface& ) = delete;
+  ~BatchInterface();
+
+  Bool_t IsZombie() const { return !fOwner; }
+
+  // Environment setup, shared with THaInterface
+  static void CreateGlobals();
+  static void DeleteGlobals();
+  static void AddIncludePaths();
+  static void SetTimeZone();
+  static void RestoreTimeZone();
+
+private:
+  Bool_t fOwner;   // This object created the global lists
+};
+
+} // namespace Podd
+
+#endif
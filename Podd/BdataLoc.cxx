@@ -2,7 +2,7 @@
 
 //////////////////////////////////////////////////////////////////////////
 //
-// BdataLoc, CrateLoc, WordLoc
+// BdataLoc, CrateLoc, WordLoc, MultiWordLoc
 //
 // Utility classes for THaDecData generic raw data decoder
 //
@@ -23,6 +23,7 @@
 #include <utility>
 #include <iostream>
 #include <cassert>
+#include <algorithm>
 
 using namespace std;
 
@@ -361,6 +362,54 @@ void WordLoc::Print( Option_t* opt ) const
   cout << "\t data = " << data << endl;
 }
 
+//_____________________________________________________________________________
+void MultiWordLoc::Add( WordLoc* loc )
+{
+  // Add 'loc' to the WordLocs searched for. 'loc' must be in our crate.
+
+  assert(loc && loc->crate == crate);
+  auto pos = upper_bound(headers.begin(), headers.end(), loc->header);
+  auto idx = pos - headers.begin();
+  headers.insert(pos, loc->header);
+  locs.insert(locs.begin() + idx, loc);
+  found.push_back(0);
+  filter.set(Hash(loc->header));
+}
+
+//_____________________________________________________________________________
+void MultiWordLoc::Load( const THaEvData& evdata )
+{
+  // Load the data of all our WordLocs in one pass over the crate buffer.
+  // Gives the same results as WordLoc::Load for each of them: the data
+  // word 'ntoskip' words after the first occurrence of each header.
+
+  UInt_t roclen = evdata.GetRocLength(crate);
+  if( roclen < 3 || locs.empty() ) return;
+
+  const UInt_t* cratebuf = evdata.GetRawDataBuffer(crate);
+  assert(cratebuf);  // Must exist if roclen > 0
+
+  // Most data words are rejected by the hash filter. Candidates are
+  // looked up among the sorted headers. Several WordLocs may share a
+  // header with different offsets.
+  std::fill(found.begin(), found.end(), 0);
+  size_t nleft = locs.size();
+  for( UInt_t i = 2; i <= roclen && nleft > 0; ++i ) {
+    UInt_t w = cratebuf[i];
+    if( !filter.test(Hash(w)) )
+      continue;
+    size_t k = lower_bound(headers.begin(), headers.end(), w) - headers.begin();
+    for( ; k < headers.size() && headers[k] == w; ++k ) {
+      WordLoc* loc = locs[k];
+      if( !found[k] && i + loc->ntoskip <= roclen ) {
+        loc->data = cratebuf[i + loc->ntoskip];
+        found[k] = 1;
+        --nleft;
+      }
+    }
+  }
+}
+
 //_____________________________________________________________________________
 void RoclenLoc::Load( const THaEvData& evdata )
 {
@@ -12,9 +12,11 @@
 #include <vector>
 #include <cassert>
 #include <set>
+#include <bitset>
 
 class THaEvData;
 class TObjArray;
+class MultiWordLoc;
 
 //___________________________________________________________________________
 class BdataLoc : public TNamed {
@@ -59,6 +61,7 @@ public:
   virtual Bool_t  DidLoad() const               { return (data != kMaxUInt); }
   virtual UInt_t  NumHits() const               { return DidLoad() ? 1 : 0; }
   virtual UInt_t  Get( UInt_t i = 0 ) const     { assert(DidLoad() && i == 0); return data; }
+  UInt_t          GetCrate() const              { return crate; }
   virtual void    Print( Option_t* opt="" ) const;
   //TODO: Needed?
   Bool_t operator==( const char* aname ) const  { return fName == aname; }
@@ -179,9 +182,36 @@ protected:
 private:
   static TypeIter_t fgThisType;
 
+  friend class MultiWordLoc;
+
   ClassDef(WordLoc,0)  
 };
 
+//___________________________________________________________________________
+class MultiWordLoc {
+  // Header search for several WordLocs in the same crate in a single pass
+  // over the crate buffer. Used by DecData in place of the individual
+  // WordLoc::Load calls. Does not own the WordLocs.
+public:
+  explicit MultiWordLoc( UInt_t cra ) : crate(cra) {}
+
+  void    Add( WordLoc* loc );
+  void    Load( const THaEvData& evt );
+  UInt_t  GetCrate() const { return crate; }
+  UInt_t  GetSize()  const { return locs.size(); }
+
+private:
+  enum { kFilterBits = 12 };
+  static UInt_t Hash( UInt_t w )
+  { return (w ^ (w >> kFilterBits) ^ (w >> 2*kFilterBits)) & ((1U<<kFilterBits)-1); }
+
+  UInt_t                 crate;    // Crate number of all locs
+  std::vector<WordLoc*>  locs;     // WordLocs, sorted by header
+  std::vector<UInt_t>    headers;  // Header words of locs, same order
+  std::vector<char>      found;    // Header of locs[i] found in this event
+  std::bitset<(1U<<kFilterBits)> filter;  // Hashes of all headers
+};
+
 //___________________________________________________________________________
 class RoclenLoc : public BdataLoc {
 public:
@@ -0,0 +1,164 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::CodaWriter
+//
+// Writes CODA events to a file in a background thread. Write() only
+// copies the event into a large memory buffer. When the buffer is full,
+// it is handed to the writer thread, and filling continues in a second
+// buffer. The analysis waits only if the writer falls a whole buffer
+// behind. The output file is written with EVIO blocks of the buffer
+// size, so the number of write calls is small.
+//
+// Write errors are reported by the next Write() or by Close(), which
+// writes any remaining events and closes the file.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "CodaWriter.h"
+#include "THaCodaFile.h"
+#include "TError.h"
+#include <algorithm>
+
+using namespace std;
+using namespace Decoder;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+CodaWriter::CodaWriter( UInt_t bufsize )
+  : fFile(nullptr), fBufSize(std::max(bufsize/4, 1024u)), fFill(0),
+    fPending(false), fStatus(CODA_OK), fStop(false), fNwritten(0)
+{
+  // Constructor. 'bufsize' is the size of each of the two buffers in bytes.
+}
+
+//_____________________________________________________________________________
+CodaWriter::~CodaWriter()
+{
+  // Destructor. Writes any buffered events and closes the file.
+
+  Close();
+}
+
+//_____________________________________________________________________________
+Int_t CodaWriter::Open( const char* filename )
+{
+  // Open CODA file 'filename' for writing and start the writer thread.
+  // Returns a CODA_xxx status code.
+
+  Close();
+  fFileName = filename;
+  fFile = new THaCodaFile;
+  Int_t status = fFile->codaOpen(filename, "w", 1);
+  if( status != CODA_OK ) {
+    delete fFile; fFile = nullptr;
+    return status;
+  }
+  // Not an error if the EVIO library does not support this
+  fFile->SetWriteBlockSize(fBufSize);
+  for( auto& buf : fBuf ) {
+    buf.clear();
+    buf.reserve(fBufSize);
+  }
+  fFill = 0;
+  fPending = fStop = false;
+  fStatus = CODA_OK;
+  fNwritten = 0;
+  fThread = thread(&CodaWriter::WriteLoop, this);
+  return CODA_OK;
+}
+
+//_____________________________________________________________________________
+Int_t CodaWriter::Write( const UInt_t* evbuffer )
+{
+  // Queue the event in 'evbuffer' for writing. Returns the status of
+  // earlier writes when a buffer is handed to the writer thread.
+
+  if( !fFile )
+    return CODA_ERROR;
+  UInt_t len = evbuffer[0]+1;
+  auto& buf = fBuf[fFill];
+  if( !buf.empty() && buf.size() + len > fBufSize ) {
+    Int_t status = Flush();
+    if( status != CODA_OK )
+      return status;
+  }
+  auto& cur = fBuf[fFill];
+  cur.insert(cur.end(), evbuffer, evbuffer + len);
+  ++fNwritten;
+  return CODA_OK;
+}
+
+//_____________________________________________________________________________
+Int_t CodaWriter::Flush()
+{
+  // Hand the current buffer to the writer thread. Waits until the
+  // previous buffer has been written.
+
+  unique_lock<mutex> lock(fMutex);
+  fDone.wait(lock, [this]{ return !fPending; });
+  if( fStatus != CODA_OK )
+    return fStatus;
+  fPending = true;
+  fFill = 1-fFill;
+  fBuf[fFill].clear();
+  lock.unlock();
+  fWork.notify_one();
+  return CODA_OK;
+}
+
+//_____________________________________________________________________________
+Int_t CodaWriter::Close()
+{
+  // Write all remaining events, stop the writer thread and close the file.
+  // Returns the first error encountered, if any.
+
+  if( !fFile )
+    return CODA_OK;
+  if( !fBuf[fFill].empty() )
+    Flush();
+  {
+    unique_lock<mutex> lock(fMutex);
+    fDone.wait(lock, [this]{ return !fPending; });
+    fStop = true;
+  }
+  fWork.notify_one();
+  fThread.join();
+  Int_t status = fFile->codaClose();
+  if( fStatus != CODA_OK )
+    status = fStatus;
+  delete fFile; fFile = nullptr;
+  for( auto& buf : fBuf )
+    vector<UInt_t>().swap(buf);
+  return status;
+}
+
+//_____________________________________________________________________________
+void CodaWriter::WriteLoop()
+{
+  // Main loop of the writer thread
+
+  unique_lock<mutex> lock(fMutex);
+  while( true ) {
+    fWork.wait(lock, [this]{ return fStop || fPending; });
+    if( !fPending )
+      return;
+    const auto& buf = fBuf[1-fFill];
+    lock.unlock();
+    Int_t status = CODA_OK;
+    for( size_t pos = 0; pos < buf.size(); pos += buf[pos]+1 ) {
+      if( (status = fFile->codaWrite(&buf[pos])) != CODA_OK )
+        break;
+    }
+    lock.lock();
+    if( status != CODA_OK && fStatus == CODA_OK ) {
+      fStatus = status;
+      ::Error( "Podd::CodaWriter", "Error writing to CODA file %s",
+               fFileName.Data() );
+    }
+    fPending = false;
+    fDone.notify_all();
+  }
+}
+
+} // namespace Podd
@@ -0,0 +1,61 @@
+#ifndef Podd_CodaWriter_h_
+#define Podd_CodaWriter_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::CodaWriter
+//
+// Buffered CODA file output with writing in a background thread
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include "TString.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace Decoder { class THaCodaFile; }
+
+namespace Podd {
+
+class CodaWriter {
+
+public:
+  explicit CodaWriter( UInt_t bufsize = kDefaultBufSize );
+  CodaWriter( const CodaWriter& ) = delete;
+  CodaWriter& operator=( const CodaWriter& ) = delete;
+  ~CodaWriter();
+
+  Int_t     Open( const char* filename );
+  Int_t     Write( const UInt_t* evbuffer );
+  Int_t     Close();
+  Bool_t    IsOpen()      const { return fFile != nullptr; }
+  ULong64_t GetNwritten() const { return fNwritten; }
+
+  static const UInt_t kDefaultBufSize = 16u<<20;  // Buffer size (bytes)
+
+private:
+  TString                fFileName; // Output file name
+  Decoder::THaCodaFile*  fFile;     // Output file
+  UInt_t                 fBufSize;  // Capacity of each buffer (words)
+  std::vector<UInt_t>    fBuf[2];   // Event buffers: one filled, one written
+  UInt_t                 fFill;     // Index of buffer being filled
+  Bool_t                 fPending;  // Other buffer is waiting to be written
+  Int_t                  fStatus;   // First write error (CODA_xxx code)
+  Bool_t                 fStop;     // Request to stop writer thread
+  ULong64_t              fNwritten; // Events handed to the writer
+
+  std::thread              fThread;
+  std::mutex               fMutex;
+  std::condition_variable  fWork;
+  std::condition_variable  fDone;
+
+  Int_t Flush();
+  void  WriteLoop();
+};
+
+} // namespace Podd
+
+#endif
@@ -0,0 +1,194 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::CounterShards
+//
+// Statistics counters that may be incremented from several threads.
+// The owner keeps the totals in its own plain counters, which the main
+// thread increments directly, as in a serial analysis. Other threads
+// increment a private shard of counters instead. The shards are added to
+// the totals, and cleared, by Collect(), which must only be called while
+// no other thread is counting, typically before printing a summary.
+// Thus, the hot path needs neither locks nor atomic operations. Typical
+// use:
+//
+//   if( CounterShards::IsMainThread() ) ++fCount[i];
+//   else                                fShards.Incr(i);
+//   ...
+//   fShards.Collect(fCount);
+//
+// Each thread gets a slot number (0 for the main thread) when it first
+// counts. Slots are recycled when threads exit; counts left in a shard are
+// kept and collected later. More than kMaxShards-1 concurrent counting
+// threads share the last slot, so their counts may be inexact.
+//
+// A shard is allocated only when a thread first counts with this object,
+// so objects used only by the main thread take no memory for shards.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "CounterShards.h"
+#include "TError.h"
+#include <thread>
+#include <mutex>
+#include <cstring>
+
+using namespace std;
+
+namespace Podd {
+
+const UInt_t CounterShards::kMaxShards;
+
+// Padding around each shard to keep shards on separate cache lines
+static const UInt_t kPad = 64/sizeof(UInt_t);
+
+// Thread that loaded the library. This is the thread that runs the
+// analyzer's event loop.
+static const thread::id gMainThread = this_thread::get_id();
+
+static mutex        gSlotMutex;
+static vector<bool> gSlotUsed(CounterShards::kMaxShards, false);
+
+namespace {
+// Slot number of the current thread, released when the thread exits
+class ThreadSlot_t {
+public:
+  ThreadSlot_t() : slot(0) {
+    if( this_thread::get_id() == gMainThread )
+      return;
+    lock_guard<mutex> lock(gSlotMutex);
+    for( slot = 1; slot < CounterShards::kMaxShards; ++slot ) {
+      if( !gSlotUsed[slot] ) {
+        gSlotUsed[slot] = true;
+        return;
+      }
+    }
+    slot = CounterShards::kMaxShards-1;
+    ::Warning( "CounterShards", "More than %u counting threads. "
+               "Statistics counters may be inexact.",
+               CounterShards::kMaxShards-1 );
+  }
+  ~ThreadSlot_t() {
+    if( slot == 0 )
+      return;
+    lock_guard<mutex> lock(gSlotMutex);
+    gSlotUsed[slot] = false;
+  }
+  UInt_t slot;
+};
+} // namespace
+
+//_____________________________________________________________________________
+CounterShards::CounterShards( UInt_t ncounters )
+  : fNcounters(ncounters), fShards(kMaxShards, nullptr)
+{
+  // Constructor
+}
+
+//_____________________________________________________________________________
+CounterShards::CounterShards( const CounterShards& rhs )
+  : fNcounters(rhs.fNcounters), fShards(kMaxShards, nullptr)
+{
+  // Copy constructor. Copies only the number of counters.
+}
+
+//_____________________________________________________________________________
+CounterShards& CounterShards::operator=( const CounterShards& rhs )
+{
+  // Assignment. Copies only the number of counters.
+
+  if( this != &rhs )
+    Resize(rhs.fNcounters);
+  return *this;
+}
+
+//_____________________________________________________________________________
+CounterShards::~CounterShards()
+{
+  // Destructor
+
+  DeleteShards();
+}
+
+//_____________________________________________________________________________
+void CounterShards::DeleteShards()
+{
+  // Delete all shards
+
+  for( auto& shard : fShards ) {
+    delete [] shard;
+    shard = nullptr;
+  }
+}
+
+//_____________________________________________________________________________
+void CounterShards::Clear()
+{
+  // Zero the counters of all shards
+
+  for( auto* shard : fShards ) {
+    if( shard )
+      memset(shard+kPad, 0, fNcounters*sizeof(UInt_t));
+  }
+}
+
+//_____________________________________________________________________________
+void CounterShards::Collect( UInt_t* totals )
+{
+  // Add the counters of all shards to the array 'totals' of GetSize()
+  // counters, then zero the shards. Must not be called while other
+  // threads may count.
+
+  for( auto* shard : fShards ) {
+    if( !shard )
+      continue;
+    UInt_t* c = shard+kPad;
+    for( UInt_t i = 0; i < fNcounters; ++i ) {
+      totals[i] += c[i];
+      c[i] = 0;
+    }
+  }
+}
+
+//_____________________________________________________________________________
+void CounterShards::Resize( UInt_t ncounters )
+{
+  // Set the number of counters. Any uncollected counts are lost.
+  // Must not be called while other threads may count.
+
+  DeleteShards();
+  fNcounters = ncounters;
+}
+
+//_____________________________________________________________________________
+UInt_t* CounterShards::Local()
+{
+  // Return the counters of the current thread's shard. Allocates the
+  // shard on first use. Only the owning thread writes its slot.
+
+  UInt_t slot = ThreadSlot();
+  UInt_t*& shard = fShards[slot];
+  if( !shard ) {
+    shard = new UInt_t[fNcounters + 2*kPad];
+    memset(shard, 0, (fNcounters + 2*kPad)*sizeof(UInt_t));
+  }
+  return shard+kPad;
+}
+
+//_____________________________________________________________________________
+Bool_t CounterShards::IsMainThread()
+{
+  // True if called from the main (event loop) thread
+
+  return this_thread::get_id() == gMainThread;
+}
+
+//_____________________________________________________________________________
+UInt_t CounterShards::ThreadSlot()
+{
+  // Slot number of the current thread. 0 for the main thread.
+
+  static thread_local ThreadSlot_t tSlot;
+  return tSlot.slot;
+}
+
+} // namespace Podd
@@ -0,0 +1,48 @@
+#ifndef Podd_CounterShards_h_
+#define Podd_CounterShards_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::CounterShards
+//
+// Per-thread copies of a set of statistics counters, so that worker
+// threads can count without locks or atomic operations
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <vector>
+
+namespace Podd {
+
+class CounterShards {
+
+public:
+  explicit CounterShards( UInt_t ncounters = 0 );
+  // Copies start with empty shards
+  CounterShards( const CounterShards& rhs );
+  CounterShards& operator=( const CounterShards& rhs );
+  ~CounterShards();
+
+  void    Clear();
+  void    Collect( UInt_t* totals );
+  void    Incr( UInt_t which ) { ++Local()[which]; }
+  UInt_t  GetSize() const { return fNcounters; }
+  void    Resize( UInt_t ncounters );
+
+  static Bool_t IsMainThread();
+  static UInt_t ThreadSlot();
+
+  static const UInt_t kMaxShards = 64;
+
+private:
+  UInt_t               fNcounters; // Number of counters per shard
+  std::vector<UInt_t*> fShards;    // Counters of each thread slot (lazy)
+
+  UInt_t* Local();
+  void    DeleteShards();
+};
+
+} // namespace Podd
+
+#endif
@@ -26,7 +26,9 @@
 //    with an arbitrary number of hits.
 // 3. "word" variables define single data words found in a given crate's
 //    event buffer by a 32-bit header word and an offset. Offset = 1
-//    means the data word following the header, etc.
+//    means the data word following the header, etc. All "word" variables
+//    of a crate are searched for together in a single pass over the
+//    crate's data (see MultiWordLoc).
 // 4. "roclen" variables contain the event length of a given crate.
 //
 // In the key/value database format, define one database key for ALL
@@ -82,6 +84,7 @@
 #include <cstdio>
 #include <cassert>
 #include <memory>
+#include <map>
 
 using namespace std;
 
@@ -130,6 +133,9 @@ void DecData::Reset( Option_t* opt )
   // Reset the class. Removes all data channel definitions
 
   Clear(opt);
+  fDirectLocs.clear();
+  fWordLocs.clear();
+  fTrigBitLocs.clear();
   fBdataLoc.Clear();
 }
 
@@ -318,6 +324,9 @@ Int_t DecData::ReadDatabase( const TDatime& date )
   Bool_t re_init = fIsInit;
   fIsInit = false;
   if( !re_init ) {
+    fDirectLocs.clear();
+    fWordLocs.clear();
+    fTrigBitLocs.clear();
     fBdataLoc.Clear();
   }
 
@@ -372,7 +381,46 @@ THaAnalysisObject::EStatus DecData::Init( const TDatime& run_time )
 
   // Standard analysis object init, calls MakePrefix(), ReadDatabase()
   // and DefineVariables(), and Clear("I")
-  return THaAnalysisObject::Init( run_time );
+  EStatus status = THaAnalysisObject::Init( run_time );
+  if( !status )
+    GroupDataLocs();
+  return status;
+}
+
+//_____________________________________________________________________________
+void DecData::GroupDataLocs()
+{
+  // Sort the data locations in fBdataLoc for Decode. WordLocs of crates
+  // with more than one of them are handed to a MultiWordLoc for that crate,
+  // which finds all their headers in one pass over the crate buffer.
+  // All other locations are loaded individually.
+
+  fDirectLocs.clear();
+  fWordLocs.clear();
+
+  // Count WordLocs per crate. Derived classes are left alone since they
+  // may define their own Load().
+  std::map<UInt_t, std::vector<WordLoc*>> wordlocs;
+  TIter next( &fBdataLoc );
+  while( auto* dataloc = static_cast<BdataLoc*>(next()) ) {
+    if( dataloc->IsA() == WordLoc::Class() ) {
+      auto* wl = static_cast<WordLoc*>(dataloc);
+      wordlocs[wl->GetCrate()].push_back(wl);
+    }
+  }
+  next.Reset();
+  while( auto* dataloc = static_cast<BdataLoc*>(next()) ) {
+    if( dataloc->IsA() != WordLoc::Class() ||
+        wordlocs[dataloc->GetCrate()].size() < 2 )
+      fDirectLocs.push_back(dataloc);
+  }
+  for( const auto& c : wordlocs ) {
+    if( c.second.size() < 2 )
+      continue;
+    fWordLocs.emplace_back(c.first);
+    for( auto* wl : c.second )
+      fWordLocs.back().Add(wl);
+  }
 }
 
 //_____________________________________________________________________________
@@ -389,15 +437,12 @@ Int_t DecData::Decode(const THaEvData& evdata)
 
   // For each raw data source registered in fBdataLoc, get the data
 
-  //TODO: accelerate search for multiple header words in same crate
-  //- group WordLoc objects by crate
-  //- for each crate with >1 WordLoc defs, make a MultiWordLoc
-  //- MultiWordLoc uses faster search algo to scan crate buffer
-
-  TIter next( &fBdataLoc );
-  while( auto* dataloc = static_cast<BdataLoc*>(next()) ) {
+  // Header words of several WordLocs in the same crate are searched for
+  // in a single pass (see GroupDataLocs)
+  for( auto* dataloc : fDirectLocs )
     dataloc->Load( evdata );
-  }
+  for( auto& multi : fWordLocs )
+    multi.Load( evdata );
 
   if( fDebug>1 )
     Print();
@@ -405,6 +450,45 @@ Int_t DecData::Decode(const THaEvData& evdata)
   return 0;
 }
 
+//_____________________________________________________________________________
+UInt_t DecData::DecodeTriggerBits( const THaEvData& evdata )
+{
+  // Load only the trigger bit channels and return the resulting trigger
+  // bit pattern. This needs only the crates of these channels to be
+  // decoded (see GetTriggerCrates). Decode() loads them again.
+
+  evtypebits = 0;
+  for( auto* dataloc : fTrigBitLocs ) {
+    dataloc->Clear();
+    dataloc->Load( evdata );
+  }
+  return evtypebits;
+}
+
+//_____________________________________________________________________________
+Int_t DecData::GetTriggerCrates( vector<UInt_t>& crates ) const
+{
+  // Append the crates of the trigger bit channels to 'crates'
+
+  for( const auto* dataloc : fTrigBitLocs )
+    crates.push_back( dataloc->GetCrate() );
+  return fTrigBitLocs.size();
+}
+
+//_____________________________________________________________________________
+Int_t DecData::GetCrates( vector<UInt_t>& crates ) const
+{
+  // Append the crates of all defined data channels to 'crates'
+
+  Int_t n = 0;
+  TIter next( &fBdataLoc );
+  while( auto* dataloc = static_cast<BdataLoc*>( next() ) ) {
+    crates.push_back( dataloc->GetCrate() );
+    ++n;
+  }
+  return n;
+}
+
 //_____________________________________________________________________________
 void DecData::Print( Option_t* opt ) const
 {
@@ -10,6 +10,7 @@
 #include "THaApparatus.h"
 #include "THashList.h"
 #include "BdataLoc.h"
+#include <vector>
 
 class TString;
 
@@ -27,6 +28,14 @@ public:
   virtual Int_t   Decode( const THaEvData& );
   virtual void    Print( Option_t* opt="" ) const;
   virtual void    Reset( Option_t* opt="" );
+  virtual Int_t   GetCrates( std::vector<UInt_t>& crates ) const;
+
+  // Trigger bits only, for early event selection (see
+  // THaAnalyzer::SetTriggerSelection)
+  UInt_t          DecodeTriggerBits( const THaEvData& evdata );
+  UInt_t          GetEvTypeBits() const { return evtypebits; }
+  Int_t           GetTriggerCrates( std::vector<UInt_t>& crates ) const;
+  Bool_t          HasTriggerBits() const { return !fTrigBitLocs.empty(); }
 
   // Disabled functions from THaApparatus
   virtual Int_t   AddDetector( THaDetector*, Bool_t, Bool_t ) { return 0; }
@@ -36,12 +45,16 @@ protected:
   UInt_t          evtype;      // CODA event type
   UInt_t          evtypebits;  // Bitpattern of active trigger numbers
   THashList       fBdataLoc;   // Raw data channels
+  std::vector<BdataLoc*>     fDirectLocs; //! Channels loaded one by one
+  std::vector<MultiWordLoc>  fWordLocs;   //! WordLocs grouped by crate
+  std::vector<BdataLoc*>     fTrigBitLocs; //! Channels that set evtypebits
 
   virtual Int_t   DefineVariables( EMode mode = kDefine );
   virtual Int_t   ReadDatabase( const TDatime& date );
 
   Int_t           DefineLocType( const BdataLoc::BdataLocType& loctype,
 				 const TString& configstr, bool re_init );
+  void            GroupDataLocs();
 
   // Expansion hooks for ReadDatabase
   virtual Int_t   SetupDBVersion( FILE* file, Int_t db_version );
@@ -0,0 +1,165 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::DefFileCache
+//
+// Process-wide cache of the cut definition files read by
+// THaCutList::Load and the output definition files read by
+// THaOutput::LoadFile. These files are read again for every run
+// analyzed in a session. Each file is read in one piece and split into
+// lines and fields in a single pass, dropping blank lines and comments.
+// The result is cached, keyed by a hash of the file contents, so an
+// unchanged file is parsed only once, whatever its name.
+//
+// Lines containing text variables ("${...}") are kept unsplit, since
+// their expansion may change between runs. The callers substitute them
+// and split them with Tokenize(). #include directives are returned as
+// lines, too; the included files are read via separate calls to Read().
+//
+// Caching can be turned off with SetEnabled(false), in which case each
+// file is parsed every time it is read.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "DefFileCache.h"
+#include "FileInclude.h"   // for kIncTag
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+DefFileCache& DefFileCache::Instance()
+{
+  static DefFileCache instance;
+  return instance;
+}
+
+//_____________________________________________________________________________
+static inline bool IsSpace( char c )
+{
+  return c == ' ' || c == '\t';
+}
+
+//_____________________________________________________________________________
+void DefFileCache::Tokenize( const string& text, ESyntax syntax,
+                             vector<string>& tokens )
+{
+  // Split 'text' into fields. For kOutputDef, the fields are separated by
+  // whitespace. For kCutDef, there are at most two fields, the cut name
+  // and the rest of the line (the expression).
+
+  tokens.clear();
+  const char* p = text.c_str();
+  const char* end = p + text.length();
+  while( p != end ) {
+    while( p != end && IsSpace(*p) )
+      ++p;
+    if( p == end )
+      break;
+    const char* q = p;
+    if( syntax == kCutDef && tokens.size() == 1 )
+      q = end;
+    else
+      while( q != end && !IsSpace(*q) )
+        ++q;
+    tokens.emplace_back(p, q);
+    p = q;
+  }
+}
+
+//_____________________________________________________________________________
+void DefFileCache::Parse( const string& contents, ESyntax syntax,
+                          Lines_t& lines )
+{
+  // Split file 'contents' into lines and fields (see Read)
+
+  lines.clear();
+  string::size_type pos = 0, len = contents.length();
+  while( pos < len ) {
+    auto eol = contents.find('\n', pos);
+    if( eol == string::npos )
+      eol = len;
+    auto start = contents.find_first_not_of(kWhiteSpace, pos);
+    auto line_pos = pos;
+    pos = eol + 1;
+
+    // #include
+    if( contents.compare(line_pos, kIncTag.length(), kIncTag) == 0 &&
+        eol - line_pos > kIncTag.length() ) {
+      lines.emplace_back();
+      lines.back().is_include = true;
+      lines.back().text.assign(contents, line_pos, eol-line_pos);
+      continue;
+    }
+    // Blank line or comment?
+    if( start >= eol || contents[start] == '#' ||
+        (syntax == kCutDef && contents.compare(start, 2, "//") == 0) )
+      continue;
+
+    // Get rid of trailing comments, and for cuts, whitespace
+    auto stop = start;
+    while( stop < eol && contents[stop] != '#' &&
+           !(syntax == kCutDef && contents[stop] == '/' &&
+             stop+1 < eol && contents[stop+1] == '/') )
+      ++stop;
+    lines.emplace_back();
+    Line_t& line = lines.back();
+    if( syntax == kCutDef ) {
+      while( IsSpace(contents[stop-1]) )
+        --stop;
+      line.text.assign(contents, start, stop-start);
+    } else
+      line.text.assign(contents, line_pos, stop-line_pos);
+    line.is_raw = (line.text.find("${") != string::npos);
+    if( !line.is_raw )
+      Tokenize(line.text, syntax, line.tokens);
+  }
+}
+
+//_____________________________________________________________________________
+DefFileCache::LinesPtr_t DefFileCache::Read( const char* filename,
+                                             ESyntax syntax )
+{
+  // Read the definition file 'filename' and return its non-empty,
+  // non-comment lines, split into fields. Returns nullptr if the file
+  // cannot be opened.
+
+  ifstream ifs(filename, ios::binary);
+  if( !ifs )
+    return nullptr;
+  ostringstream ostr;
+  ostr << ifs.rdbuf();
+  const string contents = ostr.str();
+
+  ULong64_t h = 14695981039346656037ULL;  // FNV-1a
+  for( char c : contents ) {
+    h ^= static_cast<unsigned char>(c);
+    h *= 1099511628211ULL;
+  }
+  Key_t key(make_pair(h, contents.length()), syntax);
+  if( fEnabled ) {
+    auto it = fFiles.find(key);
+    if( it != fFiles.end() )
+      return it->second;
+  }
+  auto lines = make_shared<Lines_t>();
+  Parse(contents, syntax, *lines);
+  if( fEnabled )
+    fFiles[key] = lines;
+  return lines;
+}
+
+//_____________________________________________________________________________
+void DefFileCache::SetEnabled( Bool_t enable )
+{
+  // Enable/disable caching. Disabling also clears the cache.
+
+  fEnabled = enable;
+  if( !fEnabled )
+    Clear();
+}
+
+} // namespace Podd
@@ -0,0 +1,72 @@
+#ifndef Podd_DefFileCache_h_
+#define Podd_DefFileCache_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::DefFileCache
+//
+// Process-wide cache of pre-parsed cut and output definition files
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Podd {
+
+class DefFileCache {
+
+public:
+  // Comment and field conventions of the supported file types
+  enum ESyntax {
+    kCutDef,     // THaCutList: "name expression", comments "#" and "//"
+    kOutputDef   // THaOutput: whitespace-separated fields, comments "#"
+  };
+
+  // Non-empty, non-comment line of a definition file
+  class Line_t {
+  public:
+    Line_t() : is_include(false), is_raw(false) {}
+    bool         is_include;  // #include directive; 'text' is the full line
+    bool         is_raw;      // Contains text variables; tokenize when used
+    std::string  text;        // Line with trailing comments removed
+    std::vector<std::string> tokens;  // Fields of 'text', unless is_raw
+  };
+  typedef std::vector<Line_t> Lines_t;
+  typedef std::shared_ptr<const Lines_t> LinesPtr_t;
+
+  static DefFileCache& Instance();
+
+  // Pre-parsed contents of 'filename', or nullptr if it cannot be read
+  LinesPtr_t   Read( const char* filename, ESyntax syntax );
+  // Split a (substituted) line into fields
+  static void  Tokenize( const std::string& text, ESyntax syntax,
+                         std::vector<std::string>& tokens );
+
+  void         Clear() { fFiles.clear(); }
+  UInt_t       GetSize() const { return fFiles.size(); }
+  void         SetEnabled( Bool_t enable = true );
+  Bool_t       IsEnabled() const { return fEnabled; }
+
+private:
+  DefFileCache() : fEnabled(true) {}
+  DefFileCache( const DefFileCache& ) = delete;
+  DefFileCache& operator=( const DefFileCache& ) = delete;
+
+  static void  Parse( const std::string& contents, ESyntax syntax,
+                      Lines_t& lines );
+
+  // Content hash, size and syntax
+  typedef std::pair<std::pair<ULong64_t, size_t>, Int_t> Key_t;
+
+  std::map<Key_t, LinesPtr_t> fFiles;
+  Bool_t fEnabled;
+};
+
+} // namespace Podd
+
+#endif
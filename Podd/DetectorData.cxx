@@ -7,6 +7,7 @@
 #include "DetectorData.h"
 #include "Decoder.h"
 #include "THaAnalysisObject.h" // For DefineVarsFromList
+#include "TClass.h"
 
 #include <stdexcept>
 #include <sstream>
@@ -18,17 +19,39 @@ namespace Podd {
 
 //_____________________________________________________________________________
 DetectorData::DetectorData( const char* name, const char* desc )
-  : TNamed(name,desc), fVarOK(false), fHitDone(false)
+  : TNamed(name,desc), fVarOK(false), fHitDone(false), fClearAll(true)
 {
   // Base class constructor
 }
 
+//_____________________________________________________________________________
+void DetectorData::InitHitList( UInt_t nelem )
+{
+  // Set up the hit list for 'nelem' channels. The first Clear() afterwards
+  // clears all channels.
+
+  fHitList.clear();
+  fHitList.reserve(nelem);
+  fInHitList.assign(nelem, false);
+  fClearAll = true;
+}
+
 //_____________________________________________________________________________
 void DetectorData::Clear( Option_t* )
 {
   ClearHitDone();
 }
 
+//_____________________________________________________________________________
+size_t DetectorData::GetMemoryUsage() const
+{
+  // Approximate memory held by this object (bytes): the object itself and
+  // the hit list. Derived classes add their data and calibration arrays.
+
+  return IsA()->Size() + fHitList.capacity() * sizeof(UInt_t)
+         + fInHitList.capacity() * sizeof(Bool_t);
+}
+
 //_____________________________________________________________________________
 Int_t DetectorData::GetLogicalChannel( const DigitizerHitInfo_t& hitinfo ) const
 {
@@ -120,6 +143,8 @@ ADCData::ADCData( const char* name, const char* desc, UInt_t nelem )
   // each channel is assumed to have one ADC reading plus pedestal-corrected
   // and calibrated values and associated calibration constants.
   // See the ADCCalib_t and ADCData_t structures for details.
+
+  InitHitList(nelem);
 }
 
 //_____________________________________________________________________________
@@ -128,9 +153,8 @@ void ADCData::Clear( Option_t* opt )
   // Clear event-by-event data
   DetectorData::Clear(opt);
 
-  for( auto& adc : fADCs ) {
-    adc.adc_clear();
-  }
+  // Only channels that were hit need clearing
+  ClearHitData(fADCs, []( ADCData_t& adc ) { adc.adc_clear(); });
   fNHits = 0;
 }
 
@@ -138,13 +162,38 @@ void ADCData::Clear( Option_t* opt )
 void ADCData::Reset( Option_t* opt )
 {
   // Clear event-by-event data and reset calibration values to defaults.
+  fClearAll = true;
   Clear(opt);
 
-  for( auto& calib : fCalib ) {
+  for( auto& calib : fCalib.Modify() ) {
     calib.adc_calib_reset();
   }
 }
 
+//_____________________________________________________________________________
+Int_t ADCData::ShareCalib( const ADCData& rhs )
+{
+  // Use the calibration constants of 'rhs', which must have the same
+  // number of channels. The constants are copied only if either object
+  // modifies them later. Returns 0 on success, -1 on size mismatch.
+
+  if( rhs.GetSize() != GetSize() )
+    return -1;
+  fCalib.Share(rhs.fCalib);
+  return 0;
+}
+
+//_____________________________________________________________________________
+size_t ADCData::GetMemoryUsage() const
+{
+  // Memory of per-event data and calibration (bytes). Calibrations shared
+  // with other instances (see ShareCalib) are counted by each of them.
+
+  return DetectorData::GetMemoryUsage()
+         + fADCs.capacity() * sizeof(ADCData_t)
+         + fCalib.size() * sizeof(ADCCalib_t);
+}
+
 //_____________________________________________________________________________
 static void StoreADC( ADCData_t& ADC, const ADCCalib_t& CALIB,
                       const DigitizerHitInfo_t& hitinfo, UInt_t data )
@@ -185,6 +234,7 @@ Int_t ADCData::StoreHit( const DigitizerHitInfo_t& hitinfo, UInt_t data )
     case ChannelType::kADC:
     case ChannelType::kMultiFunctionADC:
       StoreADC(fADCs[k], fCalib[k], hitinfo, data);
+      AddToHitList(k);
       fNHits++;
       fHitDone = true;
       break;
@@ -229,6 +279,8 @@ PMTData::PMTData( const char* name, const char* desc, UInt_t nelem )
   // each channel is assumed to have one ADC and one TDC reading plus pedestal-
   // corrected and calibrated values and associated calibration constants.
   // See the ADC/TDCCalib_t and ADC/TDCData_t structures for details.
+
+  InitHitList(nelem);
 }
 
 //_____________________________________________________________________________
@@ -237,9 +289,8 @@ void PMTData::Clear( Option_t* opt )
   // Clear event-by-event data
   DetectorData::Clear(opt);
 
-  for( auto& pmt : fPMTs ) {
-    pmt.clear();
-  }
+  // Only channels that were hit need clearing
+  ClearHitData(fPMTs, []( PMTData_t& pmt ) { pmt.clear(); });
   fNHits.clear();
 }
 
@@ -247,13 +298,38 @@ void PMTData::Clear( Option_t* opt )
 void PMTData::Reset( Option_t* opt )
 {
   // Clear event-by-event data and reset calibration values to defaults.
+  fClearAll = true;
   Clear(opt);
 
-  for( auto& calib : fCalib ) {
+  for( auto& calib : fCalib.Modify() ) {
     calib.reset();
   }
 }
 
+//_____________________________________________________________________________
+Int_t PMTData::ShareCalib( const PMTData& rhs )
+{
+  // Use the calibration constants of 'rhs', which must have the same
+  // number of channels. The constants are copied only if either object
+  // modifies them later. Returns 0 on success, -1 on size mismatch.
+
+  if( rhs.GetSize() != GetSize() )
+    return -1;
+  fCalib.Share(rhs.fCalib);
+  return 0;
+}
+
+//_____________________________________________________________________________
+size_t PMTData::GetMemoryUsage() const
+{
+  // Memory of per-event data and calibration (bytes). Calibrations shared
+  // with other instances (see ShareCalib) are counted by each of them.
+
+  return DetectorData::GetMemoryUsage()
+         + fPMTs.capacity() * sizeof(PMTData_t)
+         + fCalib.size() * sizeof(PMTCalib_t);
+}
+
 //_____________________________________________________________________________
 Int_t PMTData::StoreHit( const DigitizerHitInfo_t& hitinfo, UInt_t data )
 {
@@ -269,6 +345,7 @@ Int_t PMTData::StoreHit( const DigitizerHitInfo_t& hitinfo, UInt_t data )
     case ChannelType::kADC:
     case ChannelType::kMultiFunctionADC:
       StoreADC(fPMTs[k], fCalib[k], hitinfo, data);
+      AddToHitList(k);
       fNHits.adc++;
       fHitDone = true;
       break;
@@ -277,6 +354,7 @@ Int_t PMTData::StoreHit( const DigitizerHitInfo_t& hitinfo, UInt_t data )
     case ChannelType::kCommonStartTDC:
     case ChannelType::kMultiFunctionTDC:
       StoreTDC(fPMTs[k], fCalib[k], hitinfo, data);
+      AddToHitList(k);
       fNHits.tdc++;
       fHitDone = true;
       break;
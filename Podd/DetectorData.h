@@ -15,6 +15,8 @@
 #include "VarDef.h"    // for RVarDef
 #include "THaDetMap.h"
 #include <string>
+#include <vector>
+#include <memory>
 
 // Silence rootcling warnings from ClassDef macros
 #ifdef __clang__
@@ -31,6 +33,8 @@ public:
   virtual Int_t  StoreHit( const DigitizerHitInfo_t& hitinfo, UInt_t data ) = 0;
   virtual Int_t  GetLogicalChannel( const DigitizerHitInfo_t& hitinfo ) const;
   virtual UInt_t GetSize() const = 0;
+  // Memory held by this object, including calibration (bytes)
+  virtual size_t GetMemoryUsage() const;
 
   void          Clear( Option_t* ="" ) override;
   virtual void  Reset( Option_t* ="" ) {};
@@ -43,6 +47,10 @@ public:
   Bool_t        IsSetup() const { return fVarOK; }
   void          ClearHitDone()  { fHitDone = false; }
 
+  // Logical channels with data in the current event, in the order in
+  // which they were stored
+  const std::vector<UInt_t>& GetHitList() const { return fHitList; }
+
 protected:
   // Only derived classes may construct
   DetectorData( const char* name, const char* desc );
@@ -58,10 +66,76 @@ protected:
                             const char* key_prefix, const char* here,
                             const char* comment_subst );
 
+  // Hit list support for derived classes. Per-event data of channels not
+  // in the hit list must not be modified.
+  void    InitHitList( UInt_t nelem );
+  void    AddToHitList( UInt_t k ) {
+    if( !fInHitList[k] ) {
+      fInHitList[k] = true;
+      fHitList.push_back(k);
+    }
+  }
+  template< typename T, typename Func >
+  void    ClearHitData( std::vector<T>& data, Func clear );
+
   Bool_t  fVarOK;   // Global variables are set up
   Bool_t  fHitDone; // StoreHit called for current hit
 
-  ClassDef(DetectorData, 1)  // Base class for detector raw data
+  std::vector<UInt_t> fHitList;   //! Channels with data in current event
+  std::vector<Bool_t> fInHitList; //! Channel is in fHitList
+  Bool_t  fClearAll;              //! Clear all channels at next Clear()
+
+  ClassDef(DetectorData, 2)  // Base class for detector raw data
+};
+
+//_____________________________________________________________________________
+template< typename T, typename Func >
+void DetectorData::ClearHitData( std::vector<T>& data, Func clear )
+{
+  // Apply 'clear' to the elements of 'data' in the hit list, or to all
+  // elements if requested, and empty the hit list
+
+  if( fClearAll ) {
+    for( auto& d : data )
+      clear(d);
+    fInHitList.assign(fInHitList.size(), false);
+    fClearAll = false;
+  } else {
+    for( auto k : fHitList ) {
+      clear(data[k]);
+      fInHitList[k] = false;
+    }
+  }
+  fHitList.clear();
+}
+
+//_____________________________________________________________________________
+// Calibration constants of a set of channels. Copies share the same data
+// until one of them is modified (copy-on-write), so several instances of a
+// detector, e.g. one per thread, need only one copy of the calibration.
+// Sharing must be set up before the instances are used concurrently.
+template< typename T >
+class SharedCalib {
+public:
+  typedef std::vector<T> Set_t;
+
+  explicit SharedCalib( UInt_t n ) : fSet(std::make_shared<Set_t>(n)) {}
+
+  size_t   size() const                 { return fSet->size(); }
+  const T& operator[]( size_t i ) const { return (*fSet)[i]; }
+  const T& at( size_t i ) const         { return fSet->at(i); }
+  // Modifiable calibration set. Makes a private copy first if shared.
+  Set_t&   Modify() {
+    if( fSet.use_count() > 1 )
+      fSet = std::make_shared<Set_t>(*fSet);
+    return *fSet;
+  }
+  // Current calibration set. Never changes once obtained.
+  std::shared_ptr<const Set_t> Snapshot() const { return fSet; }
+  void     Share( const SharedCalib& rhs ) { fSet = rhs.fSet; }
+
+private:
+  std::shared_ptr<Set_t> fSet;
 };
 
 //_____________________________________________________________________________
@@ -133,13 +207,17 @@ public:
   void        Clear( Option_t* ="" ) override;
   void        Reset( Option_t* ="" ) override;
 
+  typedef SharedCalib<ADCCalib_t>::Set_t CalibSet_t;
+
   UInt_t      GetHitCount() const      { return fNHits; }
   UInt_t      GetSize() const override { return fCalib.size(); }
 #ifdef NDEBUG
-  ADCCalib_t& GetCalib( size_t i )     { return fCalib[i]; }
+  ADCCalib_t& GetCalib( size_t i )     { return fCalib.Modify()[i]; }
+  const ADCCalib_t& GetCalib( size_t i ) const { return fCalib[i]; }
   ADCData_t&  GetADC( size_t i )       { return fADCs[i]; }
 #else
-  ADCCalib_t& GetCalib( size_t i )     { return fCalib.at(i); }
+  ADCCalib_t& GetCalib( size_t i )     { return fCalib.Modify().at(i); }
+  const ADCCalib_t& GetCalib( size_t i ) const { return fCalib.at(i); }
   ADCData_t&  GetADC( size_t i )       { return fADCs.at(i); }
 #endif
   ADCCalib_t& GetCalib( const DigitizerHitInfo_t& hitinfo )
@@ -147,9 +225,14 @@ public:
   ADCData_t&  GetADC( const DigitizerHitInfo_t& hitinfo )
   { return GetADC(GetLogicalChannel(hitinfo)); }
 
+  std::shared_ptr<const CalibSet_t> GetCalibSnapshot() const
+  { return fCalib.Snapshot(); }
+  Int_t       ShareCalib( const ADCData& rhs );
+  size_t      GetMemoryUsage() const override;
+
 protected:
   // Calibration
-  std::vector<ADCCalib_t> fCalib;   // Calibration constants
+  SharedCalib<ADCCalib_t> fCalib;   //! Calibration constants
 
   // Per-event data
   std::vector<ADCData_t>  fADCs;    // ADC data
@@ -160,7 +243,7 @@ protected:
     const char* key_prefix = "",
     const char* comment_subst = "" ) override;
 
-  ClassDef(ADCData, 1)  // ADC raw data
+  ClassDef(ADCData, 2)  // ADC raw data
 };
 
 //_____________________________________________________________________________
@@ -174,13 +257,17 @@ public:
   void        Clear( Option_t* ="" ) override;
   void        Reset( Option_t* ="" ) override;
 
+  typedef SharedCalib<PMTCalib_t>::Set_t CalibSet_t;
+
   HitCount_t& GetHitCount()            { return fNHits; }
   UInt_t      GetSize() const override { return fCalib.size(); }
 #ifdef NDEBUG
-  PMTCalib_t& GetCalib( size_t i ) { return fCalib[i]; }
+  PMTCalib_t& GetCalib( size_t i ) { return fCalib.Modify()[i]; }
+  const PMTCalib_t& GetCalib( size_t i ) const { return fCalib[i]; }
   PMTData_t&  GetPMT( size_t i )   { return fPMTs[i]; }
 #else
-  PMTCalib_t& GetCalib( size_t i ) { return fCalib.at(i); }
+  PMTCalib_t& GetCalib( size_t i ) { return fCalib.Modify().at(i); }
+  const PMTCalib_t& GetCalib( size_t i ) const { return fCalib.at(i); }
   PMTData_t&  GetPMT( size_t i )   { return fPMTs.at(i); }
 #endif
   PMTCalib_t& GetCalib( const DigitizerHitInfo_t& hitinfo )
@@ -188,9 +275,14 @@ public:
   PMTData_t&  GetPMT( const DigitizerHitInfo_t& hitinfo )
   { return GetPMT(GetLogicalChannel(hitinfo)); }
 
+  std::shared_ptr<const CalibSet_t> GetCalibSnapshot() const
+  { return fCalib.Snapshot(); }
+  Int_t       ShareCalib( const PMTData& rhs );
+  size_t      GetMemoryUsage() const override;
+
 protected:
   // Calibration
-  std::vector<PMTCalib_t> fCalib;   // Calibration constants
+  SharedCalib<PMTCalib_t> fCalib;   //! Calibration constants
 
   // Per-event data
   std::vector<PMTData_t>  fPMTs;    // PMT data (ADCs & TDCs)
@@ -201,7 +293,7 @@ protected:
     const char* key_prefix = "",
     const char* comment_subst = "" ) override;
 
-  ClassDef(PMTData, 1)  // Photomultiplier tube raw data (ADC & TDC)
+  ClassDef(PMTData, 2)  // Photomultiplier tube raw data (ADC & TDC)
 };
 
 } // namespace Podd
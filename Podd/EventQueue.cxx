@@ -0,0 +1,237 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::EventQueue
+//
+// Read-ahead queue for raw event data. A background thread reads events
+// from a THaRunBase, or any other source given as a Reader_t function,
+// and copies them into a fixed ring of buffers, so that
+// file I/O overlaps with the decoding and analysis of earlier events.
+// The consumer (usually THaAnalyzer) calls Next() to advance to the next
+// event and then GetEvBuffer() to retrieve it. The buffer returned by
+// GetEvBuffer() remains valid until the following call to Next().
+//
+// With a batch size K > 1 (see SetBatchSize), the reader thread fills up
+// to K slots before publishing them, and the consumer claims up to K
+// queued events at once and releases them together when it has processed
+// them, so that the lock is taken and the other thread woken up only
+// about once per K events instead of once per event. This matters at
+// high event rates with small events. Note that the reader then waits for
+// K events (or the end of the run) before the first of them becomes
+// available, which adds latency in online replays.
+//
+// Only one consumer thread is supported. While the queue is running, the
+// run object must not be accessed for reading by anyone else.
+//
+// The buffers are copies of CODA event data. The length of each event is
+// taken from the first word of the event buffer, so this class can only
+// be used with run types that deliver CODA-formatted event buffers.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "EventQueue.h"
+#include "THaRunBase.h"
+#include "ThreadAffinity.h"
+#include <cassert>
+#include <utility>
+#include <algorithm>
+
+using namespace std;
+
+namespace Podd {
+
+const UInt_t EventQueue::kDefaultDepth;
+
+//_____________________________________________________________________________
+EventQueue::EventQueue( UInt_t depth, UInt_t batch )
+  : fSlots(depth > 1 ? depth : 2), fHead(0), fTail(0),
+    fCount(0), fBatch(1), fClaimed(0), fConsumed(0), fHaveCurrent(false),
+    fStop(false), fDone(false)
+{
+  // Constructor. 'depth' is the number of event buffers to keep in flight,
+  // 'batch' the number of events to hand over at once (see SetBatchSize).
+
+  SetBatchSize(batch);
+}
+
+//_____________________________________________________________________________
+void EventQueue::SetBatchSize( UInt_t batch )
+{
+  // Set the maximum number of events transferred between the reader and
+  // the consumer per lock. Limited to half the queue depth so that the
+  // reader can fill one batch while the consumer works on the previous
+  // one. Must be called while the queue is stopped.
+
+  if( IsRunning() )
+    return;
+  UInt_t maxbatch = std::max<UInt_t>(GetDepth()/2, 1);
+  fBatch = std::min(std::max(batch, 1U), maxbatch);
+}
+
+//_____________________________________________________________________________
+EventQueue::~EventQueue()
+{
+  Stop();
+}
+
+//_____________________________________________________________________________
+Int_t EventQueue::Start( THaRunBase* run )
+{
+  // Start reading events from 'run' in a background thread.
+  // The run must already be open.
+
+  if( !run )
+    return -1;
+
+  return Start( [run]( const UInt_t*& evbuf ) -> Int_t {
+    Int_t status = run->ReadEvent();
+    if( status == THaRunBase::READ_OK )
+      evbuf = run->GetEvBuffer();
+    return status;
+  });
+}
+
+//_____________________________________________________________________________
+Int_t EventQueue::Start( Reader_t reader )
+{
+  // Start reading events via 'reader' in a background thread. The reader
+  // is only ever called from that thread.
+
+  if( !reader || IsRunning() )
+    return -1;
+
+  fReader = std::move(reader);
+  fHead = fTail = fCount = fClaimed = fConsumed = 0;
+  fHaveCurrent = fStop = fDone = false;
+  fThread = thread(&EventQueue::ReadLoop, this);
+  return 0;
+}
+
+//_____________________________________________________________________________
+void EventQueue::Stop()
+{
+  // Stop the reader thread and wait for it to finish. Any events still in
+  // the queue are discarded.
+
+  if( !IsRunning() )
+    return;
+  {
+    lock_guard<mutex> lock(fMutex);
+    fStop = true;
+  }
+  fNotFull.notify_all();
+  fThread.join();
+  fHead = fTail = fCount = fClaimed = fConsumed = 0;
+  fHaveCurrent = false;
+}
+
+//_____________________________________________________________________________
+Int_t EventQueue::SetCpuAffinity( const vector<UInt_t>& cpus )
+{
+  // Restrict the reader thread to the given CPUs (see ThreadAffinity.h).
+  // The queue must be running.
+
+  return SetThreadAffinity(fThread, cpus);
+}
+
+//_____________________________________________________________________________
+Int_t EventQueue::Next()
+{
+  // Release the current event, if any, and wait for the next one.
+  // Returns the THaRunBase::ReadEvent status code for that event.
+
+  // Next event already claimed: advance without locking. The slots
+  // passed over are released with the rest of the batch.
+  if( fHaveCurrent && fClaimed > 1 ) {
+    fHead = (fHead + 1) % fSlots.size();
+    --fClaimed;
+    ++fConsumed;
+    return fSlots[fHead].status;
+  }
+  unique_lock<mutex> lock(fMutex);
+  if( fHaveCurrent ) {
+    fHead = (fHead + 1) % fSlots.size();
+    fCount -= fConsumed + 1;
+    fClaimed = fConsumed = 0;
+    fHaveCurrent = false;
+    fNotFull.notify_one();
+  }
+  fNotEmpty.wait(lock, [this]{ return fCount > 0 || fDone || fStop; });
+  if( fCount == 0 )
+    return THaRunBase::READ_EOF;
+  fHaveCurrent = true;
+  fClaimed = std::min(fCount, fBatch);
+  return fSlots[fHead].status;
+}
+
+//_____________________________________________________________________________
+const UInt_t* EventQueue::GetEvBuffer() const
+{
+  // Return the buffer of the current event
+
+  assert(fHaveCurrent);
+  return fSlots[fHead].buffer.data();
+}
+
+//_____________________________________________________________________________
+UInt_t EventQueue::GetNQueued() const
+{
+  // Number of events read ahead and waiting to be processed, not counting
+  // the current one. Equal to GetDepth()-1 if the reader is waiting for
+  // the consumer.
+
+  lock_guard<mutex> lock(fMutex);
+  return fHaveCurrent ? fCount-fConsumed-1 : fCount;
+}
+
+//_____________________________________________________________________________
+void EventQueue::ReadLoop()
+{
+  // Reader thread main loop. Fills slots until end of file, a fatal read
+  // error, or a stop request.
+
+  const UInt_t depth = GetDepth();
+  while( true ) {
+    UInt_t itail = 0, nfree = 0;
+    {
+      unique_lock<mutex> lock(fMutex);
+      // With batching, wait for room for a whole batch
+      UInt_t need = std::min(fBatch, depth);
+      fNotFull.wait(lock, [this,need,depth]{
+        return fCount + need <= depth || fStop; });
+      if( fStop )
+        break;
+      itail = fTail;
+      nfree = std::min(depth - fCount, fBatch);
+    }
+    // Slots from 'itail' on are not visible to the consumer until fCount
+    // is incremented below, so they can be filled without holding the lock
+    UInt_t nfilled = 0;
+    bool last = false;
+    while( nfilled < nfree && !last ) {
+      Slot& slot = fSlots[(itail + nfilled) % depth];
+      const UInt_t* evbuf = nullptr;
+      slot.status = fReader(evbuf);
+      if( slot.status == THaRunBase::READ_OK ) {
+        slot.buffer.assign(evbuf, evbuf + evbuf[0] + 1);
+      }
+      last = ( slot.status == THaRunBase::READ_EOF ||
+               slot.status == THaRunBase::READ_FATAL );
+      ++nfilled;
+    }
+    {
+      lock_guard<mutex> lock(fMutex);
+      fTail = (fTail + nfilled) % depth;
+      fCount += nfilled;
+      if( last )
+        fDone = true;
+    }
+    fNotEmpty.notify_one();
+    if( last )
+      break;
+  }
+  lock_guard<mutex> lock(fMutex);
+  fDone = true;
+  fNotEmpty.notify_all();
+}
+
+} // namespace Podd
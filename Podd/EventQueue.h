@@ -0,0 +1,80 @@
+#ifndef Podd_EventQueue_h_
+#define Podd_EventQueue_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::EventQueue
+//
+// Bounded queue of raw event buffers filled by a background reader thread.
+// Events can be handed over in batches (see SetBatchSize).
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+class THaRunBase;
+
+namespace Podd {
+
+class EventQueue {
+
+public:
+  explicit EventQueue( UInt_t depth = kDefaultDepth, UInt_t batch = 1 );
+  EventQueue( const EventQueue& ) = delete;
+  EventQueue& operator=( const EventQueue& ) = delete;
+  ~EventQueue();
+
+  // Function that reads the next event, sets its argument to the event
+  // buffer, and returns a THaRunBase::ReadEvent status code
+  typedef std::function<Int_t(const UInt_t*&)> Reader_t;
+
+  Int_t         Start( THaRunBase* run );
+  Int_t         Start( Reader_t reader );
+  void          Stop();
+  Int_t         Next();
+  const UInt_t* GetEvBuffer() const;
+  UInt_t        GetBatchSize() const { return fBatch; }
+  UInt_t        GetDepth()    const { return static_cast<UInt_t>(fSlots.size()); }
+  UInt_t        GetNQueued()  const;
+  Bool_t        IsRunning()   const { return fThread.joinable(); }
+  void          SetBatchSize( UInt_t batch );
+  Int_t         SetCpuAffinity( const std::vector<UInt_t>& cpus );
+
+  static const UInt_t kDefaultDepth = 16;
+
+private:
+  class Slot {
+  public:
+    Slot() : status(0) {}
+    std::vector<UInt_t> buffer;   // Copy of raw event data
+    Int_t               status;   // Return code of THaRunBase::ReadEvent
+  };
+
+  Reader_t           fReader;   // Event source
+  std::vector<Slot>  fSlots;    // Ring of event buffers
+  UInt_t             fHead;     // Next slot to deliver to consumer
+  UInt_t             fTail;     // Next slot to fill by reader thread
+  UInt_t             fCount;    // Number of filled slots (incl. current)
+  UInt_t             fBatch;    // Max. events to transfer per lock
+  UInt_t             fClaimed;  // Consumer: slots claimed from fHead (incl. current)
+  UInt_t             fConsumed; // Consumer: claimed slots done, not yet released
+  Bool_t             fHaveCurrent; // Consumer holds slot fHead
+  Bool_t             fStop;     // Request to stop reader thread
+  Bool_t             fDone;     // Reader thread reached EOF or fatal error
+
+  std::thread             fThread;
+  mutable std::mutex      fMutex;
+  std::condition_variable fNotEmpty;
+  std::condition_variable fNotFull;
+
+  void ReadLoop();
+};
+
+} // namespace Podd
+
+#endif
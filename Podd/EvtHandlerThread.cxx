@@ -0,0 +1,148 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::EvtHandlerThread
+//
+// Runs event type handlers asynchronously (see THaEvtTypeHandler::SetAsync).
+// The event loop calls Push() with the raw buffer of each event that has
+// asynchronous handlers. The event is copied into a fixed ring of buffers
+// and later decoded in the background thread with the thread's own
+// decoder, after which the handlers' Analyze() functions are called.
+// Events are processed in the order in which they were pushed. Push()
+// blocks while the ring is full.
+//
+// The decoder only sees the events pushed to this thread.
+//
+// If a handler throws, the thread discards all further events, and the
+// exception is rethrown by the next call to Push() or Drain().
+//
+// Only one thread may call Push() and Drain().
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "EvtHandlerThread.h"
+#include "THaEvData.h"
+#include "THaEvtTypeHandler.h"
+#include "ThreadAffinity.h"
+#include <cassert>
+
+using namespace std;
+
+namespace Podd {
+
+const UInt_t EvtHandlerThread::kDefaultDepth;
+
+//_____________________________________________________________________________
+EvtHandlerThread::EvtHandlerThread( THaEvData* decoder, UInt_t depth )
+  : fDecoder(decoder), fSlots(depth > 1 ? depth : 2), fHead(0), fCount(0),
+    fStop(false)
+{
+  // Constructor. Takes ownership of 'decoder', which must be fully set up
+  // for the current run. 'depth' is the maximum number of queued events.
+
+  assert(fDecoder);
+  fThread = thread(&EvtHandlerThread::WorkLoop, this);
+}
+
+//_____________________________________________________________________________
+EvtHandlerThread::~EvtHandlerThread()
+{
+  // Destructor. Finishes processing of queued events, then stops the
+  // worker thread. Exceptions from the handlers are discarded.
+
+  {
+    unique_lock<mutex> lock(fMutex);
+    fNotFull.wait(lock, [this]{ return fCount == 0; });
+    fStop = true;
+  }
+  fNotEmpty.notify_all();
+  fThread.join();
+}
+
+//_____________________________________________________________________________
+void EvtHandlerThread::Push( const UInt_t* evbuffer,
+                             const HandlerList_t* handlers )
+{
+  // Queue a copy of the CODA event in 'evbuffer' for processing by
+  // 'handlers'. The list must remain valid until the event has been
+  // processed, i.e. until Drain() returns.
+
+  assert(evbuffer && handlers);
+  unique_lock<mutex> lock(fMutex);
+  fNotFull.wait(lock, [this]{ return fCount < fSlots.size(); });
+  if( fError ) {
+    exception_ptr err = fError;
+    fError = nullptr;
+    rethrow_exception(err);
+  }
+  // The new slot is not accessed by the worker until fCount is
+  // incremented, so it can be filled without holding the lock
+  Slot& slot = fSlots[(fHead + fCount) % fSlots.size()];
+  lock.unlock();
+  slot.buffer.assign(evbuffer, evbuffer + evbuffer[0] + 1);
+  slot.handlers = handlers;
+  lock.lock();
+  ++fCount;
+  lock.unlock();
+  fNotEmpty.notify_one();
+}
+
+//_____________________________________________________________________________
+Int_t EvtHandlerThread::SetCpuAffinity( const vector<UInt_t>& cpus )
+{
+  // Restrict the handler thread to the given CPUs (see ThreadAffinity.h)
+
+  return SetThreadAffinity(fThread, cpus);
+}
+
+//_____________________________________________________________________________
+void EvtHandlerThread::Drain()
+{
+  // Wait until all queued events have been processed. Rethrows the first
+  // exception thrown by a handler, if any.
+
+  unique_lock<mutex> lock(fMutex);
+  fNotFull.wait(lock, [this]{ return fCount == 0; });
+  if( fError ) {
+    exception_ptr err = fError;
+    fError = nullptr;
+    rethrow_exception(err);
+  }
+}
+
+//_____________________________________________________________________________
+void EvtHandlerThread::WorkLoop()
+{
+  // Worker thread main loop
+
+  unique_lock<mutex> lock(fMutex);
+  while( true ) {
+    fNotEmpty.wait(lock, [this]{ return fStop || fCount > 0; });
+    if( fCount == 0 )
+      return;
+    // The head slot is not modified by Push() while fCount > 0
+    Slot& slot = fSlots[fHead];
+    bool skip = static_cast<bool>(fError);
+    lock.unlock();
+    exception_ptr err;
+    if( !skip ) {
+      try {
+        Int_t status = fDecoder->LoadEvent(slot.buffer.data());
+        if( status == THaEvData::HED_OK || status == THaEvData::HED_WARN ) {
+          for( auto* handler : *slot.handlers )
+            handler->Analyze(fDecoder.get());
+        }
+      }
+      catch( ... ) {
+        err = current_exception();
+      }
+    }
+    lock.lock();
+    if( err && !fError )
+      fError = err;
+    fHead = (fHead + 1) % fSlots.size();
+    --fCount;
+    fNotFull.notify_all();
+  }
+}
+
+} // namespace Podd
@@ -0,0 +1,68 @@
+#ifndef Podd_EvtHandlerThread_h_
+#define Podd_EvtHandlerThread_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::EvtHandlerThread
+//
+// Background thread running event type handlers on copies of raw events
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+class THaEvData;
+class THaEvtTypeHandler;
+
+namespace Podd {
+
+class EvtHandlerThread {
+
+public:
+  typedef std::vector<THaEvtTypeHandler*> HandlerList_t;
+
+  explicit EvtHandlerThread( THaEvData* decoder, UInt_t depth = kDefaultDepth );
+  EvtHandlerThread( const EvtHandlerThread& ) = delete;
+  EvtHandlerThread& operator=( const EvtHandlerThread& ) = delete;
+  ~EvtHandlerThread();
+
+  void       Push( const UInt_t* evbuffer, const HandlerList_t* handlers );
+  void       Drain();
+  THaEvData* GetDecoder() const { return fDecoder.get(); }
+  UInt_t     GetDepth()   const { return static_cast<UInt_t>(fSlots.size()); }
+  Int_t      SetCpuAffinity( const std::vector<UInt_t>& cpus );
+
+  static const UInt_t kDefaultDepth = 64;
+
+private:
+  class Slot {
+  public:
+    Slot() : handlers(nullptr) {}
+    std::vector<UInt_t>  buffer;    // Copy of raw event data
+    const HandlerList_t* handlers;  // Handlers to run for this event
+  };
+
+  std::unique_ptr<THaEvData> fDecoder; // Decoder used by this thread
+  std::vector<Slot>  fSlots;    // Ring of event buffers
+  UInt_t             fHead;     // Next slot to process
+  UInt_t             fCount;    // Number of queued events (incl. current)
+  std::exception_ptr fError;    // First exception thrown by a handler
+  Bool_t             fStop;     // Request to stop worker thread
+
+  std::thread             fThread;
+  std::mutex              fMutex;
+  std::condition_variable fNotEmpty;
+  std::condition_variable fNotFull;
+
+  void WorkLoop();
+};
+
+} // namespace Podd
+
+#endif
@@ -0,0 +1,946 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::FormulaProgram
+//
+// A THaFormula expression translated into a short program for a small
+// stack machine. This avoids TFormula's general-purpose interpreter and
+// the virtual DefinedValue() call per variable per evaluation: global
+// variables with a fixed memory location are read directly through
+// pointers resolved once at compile time.
+//
+// Only a subset of the TFormula syntax is supported: numeric constants,
+// variables and cuts, the arithmetic, comparison, logical and bit
+// operators, and the functions sqrt, sq, abs, fabs, sin, cos, tan, asin,
+// acos, atan, atan2, sinh, cosh, tanh, exp, log, log10, pow, min, max
+// and fmod. The results are the same as with TFormula, including its
+// conventions for division by zero (result 0) and for arguments outside
+// the domain of sqrt, log, asin etc.
+//
+// Compile() returns false for anything else, e.g. strings, special
+// functions like Sum$(), or TMath:: calls. THaFormula then keeps using
+// the interpreter.
+//
+// EvalAll() evaluates many instances of an array expression at once.
+// Each instruction is applied to a block of instances before going on
+// to the next one, so the interpretation overhead is paid once per block
+// and the loops over the instances can be vectorized. Programs with
+// short-circuit operators (&&, ||) must be evaluated instance by
+// instance since the right-hand operand may not be evaluated at all.
+//
+// Compile() folds constant subexpressions, e.g. "x*(2*3.14159)" is
+// evaluated as "x*6.28318". Subexpressions that depend only on scalar
+// variables with fixed locations, like "abs(L.gold.th)<0.05", are moved
+// into a global pool, so that all programs containing the same
+// subexpression share one copy. With SetCaching(true), each shared
+// subexpression is evaluated at most once per event generation (see
+// NewEvent), and the result is reused by all programs. THaAnalyzer
+// enables this during the event loop. Only the largest such
+// subexpressions are shared, i.e. the operands of && and || and the
+// whole expression.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "FormulaProgram.h"
+#include "TMath.h"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+using namespace std;
+
+namespace Podd {
+
+UInt_t FormulaProgram::fgGeneration = 1;
+Bool_t FormulaProgram::fgCaching    = false;
+
+//_____________________________________________________________________________
+static inline Double_t ReadData( VarType type, const void* p, Int_t i )
+{
+  // Value of the i-th element of basic type 'type' at address 'p'
+
+  switch( type ) {
+  case kDouble: return static_cast<const Double_t*>(p)[i];
+  case kFloat:  return static_cast<const Float_t*>(p)[i];
+  case kLong:   return static_cast<Double_t>(static_cast<const Long_t*>(p)[i]);
+  case kULong:  return static_cast<Double_t>(static_cast<const ULong_t*>(p)[i]);
+  case kInt:    return static_cast<const Int_t*>(p)[i];
+  case kUInt:   return static_cast<const UInt_t*>(p)[i];
+  case kShort:  return static_cast<const Short_t*>(p)[i];
+  case kUShort: return static_cast<const UShort_t*>(p)[i];
+  case kChar:   return static_cast<const Char_t*>(p)[i];
+  case kUChar:  return static_cast<const UChar_t*>(p)[i];
+  default:      break;
+  }
+  assert(false); // Compile() guarantees basic types
+  return 0;
+}
+
+//_____________________________________________________________________________
+template< typename T >
+static inline void ReadColumn( Double_t* x, const void* p, Int_t first,
+                               Int_t n )
+{
+  const T* src = static_cast<const T*>(p) + first;
+  for( Int_t j = 0; j < n; ++j )
+    x[j] = static_cast<Double_t>(src[j]);
+}
+
+//_____________________________________________________________________________
+static inline void ReadData( VarType type, const void* p, Int_t first,
+                             Int_t n, Double_t* x )
+{
+  // Convert elements first ... first+n-1 of basic type 'type' at address
+  // 'p' to Double_t
+
+  switch( type ) {
+  case kDouble: ReadColumn<Double_t>(x, p, first, n); break;
+  case kFloat:  ReadColumn<Float_t>(x, p, first, n); break;
+  case kLong:   ReadColumn<Long_t>(x, p, first, n); break;
+  case kULong:  ReadColumn<ULong_t>(x, p, first, n); break;
+  case kInt:    ReadColumn<Int_t>(x, p, first, n); break;
+  case kUInt:   ReadColumn<UInt_t>(x, p, first, n); break;
+  case kShort:  ReadColumn<Short_t>(x, p, first, n); break;
+  case kUShort: ReadColumn<UShort_t>(x, p, first, n); break;
+  case kChar:   ReadColumn<Char_t>(x, p, first, n); break;
+  case kUChar:  ReadColumn<UChar_t>(x, p, first, n); break;
+  default:      assert(false); break; // Compile() guarantees basic types
+  }
+}
+
+//_____________________________________________________________________________
+// Operations with TFormula's conventions for special cases. Shared by
+// Eval() and EvalAll().
+static inline Double_t OpDiv( Double_t a, Double_t b )
+{ return (b == 0) ? 0 : a / b; }
+static inline Double_t OpMod( Double_t a, Double_t b )
+{
+  Long64_t ia = static_cast<Long64_t>(a), ib = static_cast<Long64_t>(b);
+  return (ib == 0) ? 0 : static_cast<Double_t>(ia % ib);
+}
+static inline Double_t OpBitAnd( Double_t a, Double_t b )
+{ return static_cast<Double_t>(static_cast<Long64_t>(a) &
+                               static_cast<Long64_t>(b)); }
+static inline Double_t OpBitOr( Double_t a, Double_t b )
+{ return static_cast<Double_t>(static_cast<Long64_t>(a) |
+                               static_cast<Long64_t>(b)); }
+static inline Double_t OpShl( Double_t a, Double_t b )
+{ return static_cast<Double_t>(static_cast<Long64_t>(a) <<
+                               static_cast<Long64_t>(b)); }
+static inline Double_t OpShr( Double_t a, Double_t b )
+{ return static_cast<Double_t>(static_cast<Long64_t>(a) >>
+                               static_cast<Long64_t>(b)); }
+static inline Double_t OpSqrt( Double_t x )
+{ return TMath::Sqrt(TMath::Abs(x)); }
+static inline Double_t OpASin( Double_t x )
+{ return (TMath::Abs(x) > 1) ? 0 : TMath::ASin(x); }
+static inline Double_t OpACos( Double_t x )
+{ return (TMath::Abs(x) > 1) ? 0 : TMath::ACos(x); }
+static inline Double_t OpExp( Double_t x )
+{ return (x < -700) ? 0 : TMath::Exp(TMath::Min(x, 700.)); }
+static inline Double_t OpLog( Double_t x )
+{ return (x > 0) ? TMath::Log(x) : 0; }
+static inline Double_t OpLog10( Double_t x )
+{ return (x > 0) ? TMath::Log10(x) : 0; }
+
+// Trivial operations, for use with Apply() in EvalAll()
+static inline Double_t OpAdd( Double_t a, Double_t b ) { return a + b; }
+static inline Double_t OpSub( Double_t a, Double_t b ) { return a - b; }
+static inline Double_t OpMul( Double_t a, Double_t b ) { return a * b; }
+static inline Double_t OpPow( Double_t a, Double_t b )
+{ return TMath::Power(a, b); }
+static inline Double_t OpEq ( Double_t a, Double_t b ) { return a == b; }
+static inline Double_t OpNe ( Double_t a, Double_t b ) { return a != b; }
+static inline Double_t OpLt ( Double_t a, Double_t b ) { return a <  b; }
+static inline Double_t OpLe ( Double_t a, Double_t b ) { return a <= b; }
+static inline Double_t OpGt ( Double_t a, Double_t b ) { return a >  b; }
+static inline Double_t OpGe ( Double_t a, Double_t b ) { return a >= b; }
+static inline Double_t OpATan2( Double_t a, Double_t b )
+{ return TMath::ATan2(a, b); }
+static inline Double_t OpMin( Double_t a, Double_t b )
+{ return TMath::Min(a, b); }
+static inline Double_t OpMax( Double_t a, Double_t b )
+{ return TMath::Max(a, b); }
+static inline Double_t OpFmod( Double_t a, Double_t b )
+{ return fmod(a, b); }
+static inline Double_t OpNeg ( Double_t x ) { return -x; }
+static inline Double_t OpNot ( Double_t x ) { return x == 0; }
+static inline Double_t OpBool( Double_t x ) { return x != 0; }
+static inline Double_t OpSq  ( Double_t x ) { return x * x; }
+static inline Double_t OpAbs ( Double_t x ) { return TMath::Abs(x); }
+static inline Double_t OpSin ( Double_t x ) { return TMath::Sin(x); }
+static inline Double_t OpCos ( Double_t x ) { return TMath::Cos(x); }
+static inline Double_t OpTan ( Double_t x ) { return TMath::Tan(x); }
+static inline Double_t OpATan( Double_t x ) { return TMath::ATan(x); }
+static inline Double_t OpSinh( Double_t x ) { return TMath::SinH(x); }
+static inline Double_t OpCosh( Double_t x ) { return TMath::CosH(x); }
+static inline Double_t OpTanh( Double_t x ) { return TMath::TanH(x); }
+
+//_____________________________________________________________________________
+template< typename Op >
+static inline void Apply( Double_t* x, Int_t n, Op op )
+{
+  for( Int_t j = 0; j < n; ++j )
+    x[j] = op(x[j]);
+}
+
+//_____________________________________________________________________________
+template< typename Op >
+static inline void Apply( Double_t* x, const Double_t* y, Int_t n, Op op )
+{
+  for( Int_t j = 0; j < n; ++j )
+    x[j] = op(x[j], y[j]);
+}
+
+//_____________________________________________________________________________
+class FormulaProgram::Shared_t {
+public:
+  explicit Shared_t( const FormulaProgram& prog )
+    : fProg(prog), fValue(0), fGen(0) {}
+  Double_t Value() const {
+    if( fgCaching && fGen == fgGeneration )
+      return fValue;
+    Bool_t invalid = false;  // cannot happen for scalar data
+    fValue = fProg.Eval(nullptr, nullptr, 0, invalid);
+    fGen = fgCaching ? fgGeneration : 0;
+    return fValue;
+  }
+private:
+  FormulaProgram   fProg;   // Code of the subexpression
+  mutable Double_t fValue;  // Cached result
+  mutable UInt_t   fGen;    // Generation of fValue (0 = none)
+};
+
+//_____________________________________________________________________________
+class FormulaProgram::SharedPool {
+public:
+  SharedPool() : fSweepAt(64) {}
+  // Get the shared subexpression with code [begin,end), creating it if
+  // necessary
+  SharedPtr_t Get( const Instr_t* begin, const Instr_t* end ) {
+    string key;
+    for( const Instr_t* ins = begin; ins != end; ++ins ) {
+      key.append(reinterpret_cast<const char*>(&ins->op), sizeof(ins->op));
+      key.append(reinterpret_cast<const char*>(&ins->arg), sizeof(ins->arg));
+      key.append(reinterpret_cast<const char*>(&ins->len), sizeof(ins->len));
+      key.append(reinterpret_cast<const char*>(&ins->val), sizeof(ins->val));
+      key.append(reinterpret_cast<const char*>(&ins->ptr), sizeof(ins->ptr));
+    }
+    lock_guard<mutex> lock(fMutex);
+    auto& entry = fEntries[key];
+    SharedPtr_t shared = entry.lock();
+    if( !shared ) {
+      FormulaProgram prog;
+      prog.fCode.assign(begin, end);
+      prog.fMaxStack = kMaxStack;
+      shared = std::make_shared<const Shared_t>(prog);
+      entry = shared;
+      if( fEntries.size() >= fSweepAt )
+        Sweep();
+    }
+    return shared;
+  }
+  UInt_t Size() {
+    lock_guard<mutex> lock(fMutex);
+    Sweep();
+    return fEntries.size();
+  }
+private:
+  // Remove subexpressions no longer used by any program
+  void Sweep() {
+    for( auto it = fEntries.begin(); it != fEntries.end(); ) {
+      if( it->second.expired() )
+        it = fEntries.erase(it);
+      else
+        ++it;
+    }
+    fSweepAt = 2*fEntries.size() + 64;
+  }
+  map<string, std::weak_ptr<const Shared_t>> fEntries;
+  size_t fSweepAt;
+  mutex  fMutex;
+};
+
+//_____________________________________________________________________________
+// Recursive-descent parser generating the program. Operator precedence,
+// from lowest to highest:
+//   ||  &&  |  &  == !=  < <= > >=  << >>  + -  * / %  unary - + !  ^
+class FormulaProgram::Parser {
+public:
+  Parser( FormulaProgram& prog, const char* expr, const Resolver_t& resolve )
+    : fProg(prog), fCode(prog.fCode), fPos(expr), fResolve(resolve),
+      fDepth(0), fOK(true) {}
+
+  Bool_t Run() {
+    ParseOr();
+    if( *fPos != '\0' )
+      fOK = false;
+    return fOK && fDepth == 1 && fProg.fMaxStack <= kMaxStack;
+  }
+
+private:
+  FormulaProgram&       fProg;
+  vector<Instr_t>&      fCode;
+  const char*           fPos;
+  const Resolver_t&     fResolve;
+  Int_t                 fDepth;   // Current stack depth
+  Bool_t                fOK;
+
+  Bool_t Accept( const char* tok ) {
+    size_t n = strlen(tok);
+    if( strncmp(fPos, tok, n) != 0 )
+      return false;
+    fPos += n;
+    return true;
+  }
+  // Accept single-character operator 'c' unless it is followed by one
+  // of the characters in 'notnext' (to distinguish e.g. '|' from '||')
+  Bool_t AcceptChar( char c, const char* notnext ) {
+    if( *fPos != c || (fPos[1] && strchr(notnext, fPos[1])) )
+      return false;
+    ++fPos;
+    return true;
+  }
+  void Emit( const Instr_t& ins, Int_t ddepth ) {
+    fCode.push_back(ins);
+    fDepth += ddepth;
+    if( fDepth > static_cast<Int_t>(fProg.fMaxStack) )
+      fProg.fMaxStack = fDepth;
+  }
+  void Binary( EOp op )  { Emit(Instr_t(op), -1); }
+
+  void ParseOr() {
+    ParseAnd();
+    while( fOK && Accept("||") ) {
+      size_t jmp = fCode.size();
+      Emit(Instr_t(kJumpIfTrue), -1);
+      ParseAnd();
+      Emit(Instr_t(kBool), 0);
+      fCode[jmp].arg = static_cast<Int_t>(fCode.size());
+    }
+  }
+  void ParseAnd() {
+    ParseBitOr();
+    while( fOK && Accept("&&") ) {
+      size_t jmp = fCode.size();
+      Emit(Instr_t(kJumpIfFalse), -1);
+      ParseBitOr();
+      Emit(Instr_t(kBool), 0);
+      fCode[jmp].arg = static_cast<Int_t>(fCode.size());
+    }
+  }
+  void ParseBitOr() {
+    ParseBitAnd();
+    while( fOK && AcceptChar('|', "|") ) {
+      ParseBitAnd();
+      Binary(kBitOr);
+    }
+  }
+  void ParseBitAnd() {
+    ParseEquality();
+    while( fOK && AcceptChar('&', "&") ) {
+      ParseEquality();
+      Binary(kBitAnd);
+    }
+  }
+  void ParseEquality() {
+    ParseRelational();
+    while( fOK ) {
+      EOp op;
+      if( Accept("==") )      op = kEq;
+      else if( Accept("!=") ) op = kNe;
+      else break;
+      ParseRelational();
+      Binary(op);
+    }
+  }
+  void ParseRelational() {
+    ParseShift();
+    while( fOK ) {
+      EOp op;
+      if( Accept("<=") )                 op = kLe;
+      else if( Accept(">=") )            op = kGe;
+      else if( AcceptChar('<', "<") )    op = kLt;
+      else if( AcceptChar('>', ">") )    op = kGt;
+      else break;
+      ParseShift();
+      Binary(op);
+    }
+  }
+  void ParseShift() {
+    ParseAdditive();
+    while( fOK ) {
+      EOp op;
+      if( Accept("<<") )      op = kShl;
+      else if( Accept(">>") ) op = kShr;
+      else break;
+      ParseAdditive();
+      Binary(op);
+    }
+  }
+  void ParseAdditive() {
+    ParseMultiplicative();
+    while( fOK ) {
+      EOp op;
+      if( Accept("+") )      op = kAdd;
+      else if( Accept("-") ) op = kSub;
+      else break;
+      ParseMultiplicative();
+      Binary(op);
+    }
+  }
+  void ParseMultiplicative() {
+    ParseUnary();
+    while( fOK ) {
+      EOp op;
+      if( Accept("*") )      op = kMul;
+      else if( Accept("/") ) op = kDiv;
+      else if( Accept("%") ) op = kMod;
+      else break;
+      ParseUnary();
+      Binary(op);
+    }
+  }
+  void ParseUnary() {
+    if( Accept("-") ) {
+      ParseUnary();
+      Emit(Instr_t(kNeg), 0);
+    } else if( Accept("+") ) {
+      ParseUnary();
+    } else if( AcceptChar('!', "=") ) {
+      ParseUnary();
+      Emit(Instr_t(kNot), 0);
+    } else
+      ParsePower();
+  }
+  void ParsePower() {
+    ParsePrimary();
+    if( fOK && Accept("^") ) {
+      Bool_t neg = Accept("-");
+      ParsePrimary();
+      if( neg )
+        Emit(Instr_t(kNeg), 0);
+      Binary(kPow);
+      // Chained powers (a^b^c) are ambiguous; leave them to TFormula
+      if( *fPos == '^' )
+        fOK = false;
+    }
+  }
+  void ParsePrimary() {
+    if( !fOK )
+      return;
+    char c = *fPos;
+    if( c == '(' ) {
+      ++fPos;
+      ParseOr();
+      if( !Accept(")") )
+        fOK = false;
+    } else if( isdigit(c) || (c == '.' && isdigit(fPos[1])) ) {
+      ParseNumber();
+    } else if( isalpha(c) || c == '_' ) {
+      ParseName();
+    } else
+      fOK = false;
+  }
+  void ParseNumber() {
+    // Decimal numbers only; hex and the like are left to TFormula
+    if( fPos[0] == '0' && (fPos[1] == 'x' || fPos[1] == 'X') ) {
+      fOK = false;
+      return;
+    }
+    char* end = nullptr;
+    Double_t val = strtod(fPos, &end);
+    if( end == fPos || isalpha(*end) || *end == '_' ) {
+      fOK = false;
+      return;
+    }
+    fPos = end;
+    Emit(Instr_t(kConst, val), 1);
+  }
+  void ParseName() {
+    const char* start = fPos;
+    while( isalnum(*fPos) || *fPos == '_' || *fPos == '.' )
+      ++fPos;
+    string name(start, fPos);
+    if( *fPos == '(' ) {
+      ParseFunction(name);
+      return;
+    }
+    // Array subscripts are part of the variable name
+    while( *fPos == '[' ) {
+      const char* close = strchr(fPos, ']');
+      if( !close ) {
+        fOK = false;
+        return;
+      }
+      name.append(fPos, close+1);
+      fPos = close+1;
+    }
+    Operand_t opd;
+    if( !fResolve(name, opd) ) {
+      fOK = false;
+      return;
+    }
+    switch( opd.kind ) {
+    case Operand_t::kGeneric:
+      Emit(Instr_t(kGeneric, 0, opd.index), 1);
+      break;
+    case Operand_t::kData:
+      Emit(Instr_t(kData, 0, opd.type, opd.ptr), 1);
+      break;
+    case Operand_t::kArrayData:
+      Emit(Instr_t(kArrayData, 0, opd.type, opd.ptr, opd.len), 1);
+      break;
+    }
+  }
+  void ParseFunction( const string& name ) {
+    struct FuncDef_t { const char* name; EOp op; Int_t nargs; };
+    static const FuncDef_t funcs[] = {
+      { "sqrt", kSqrt, 1 }, { "sq", kSq, 1 }, { "abs", kAbs, 1 },
+      { "fabs", kAbs, 1 }, { "sin", kSin, 1 }, { "cos", kCos, 1 },
+      { "tan", kTan, 1 }, { "asin", kASin, 1 }, { "acos", kACos, 1 },
+      { "atan", kATan, 1 }, { "atan2", kATan2, 2 }, { "sinh", kSinh, 1 },
+      { "cosh", kCosh, 1 }, { "tanh", kTanh, 1 }, { "exp", kExp, 1 },
+      { "log", kLog, 1 }, { "log10", kLog10, 1 }, { "pow", kPow, 2 },
+      { "min", kMin, 2 }, { "max", kMax, 2 }, { "fmod", kFmod, 2 }
+    };
+    const FuncDef_t* def = nullptr;
+    for( const auto& f : funcs ) {
+      if( name == f.name ) {
+        def = &f;
+        break;
+      }
+    }
+    if( !def ) {
+      fOK = false;
+      return;
+    }
+    ++fPos;  // '('
+    for( Int_t i = 0; i < def->nargs && fOK; ++i ) {
+      if( i > 0 && !Accept(",") ) {
+        fOK = false;
+        return;
+      }
+      ParseOr();
+    }
+    if( !Accept(")") ) {
+      fOK = false;
+      return;
+    }
+    Emit(Instr_t(def->op), 1-def->nargs);
+  }
+};
+
+//_____________________________________________________________________________
+Bool_t FormulaProgram::Compile( const char* expression,
+                                const Resolver_t& resolve )
+{
+  // Translate 'expression' into a program. 'resolve' is called for each
+  // variable or cut name. Returns false, leaving the program empty, if
+  // the expression cannot be compiled.
+
+  Clear();
+  if( !expression || !*expression )
+    return false;
+  Parser parser(*this, expression, resolve);
+  if( !parser.Run() ) {
+    Clear();
+    return false;
+  }
+  Optimize();
+  fColumnar = true;
+  for( const auto& ins : fCode ) {
+    if( ins.op == kJumpIfFalse || ins.op == kJumpIfTrue ) {
+      fColumnar = false;
+      break;
+    }
+  }
+  return true;
+}
+
+//_____________________________________________________________________________
+void FormulaProgram::Clear()
+{
+  fCode.clear();
+  fMaxStack = 0;
+  fColumnar = false;
+  fShared.clear();
+}
+
+//_____________________________________________________________________________
+void FormulaProgram::FindRanges( ERange what, Ranges_t& ranges ) const
+{
+  // Find the largest subexpressions of the program that are constant
+  // (what = kFoldable) or depend only on constants and scalar data
+  // (what = kShareable). 'ranges' is set to the [begin,end) index ranges
+  // of their code, in program order. Single instructions are not
+  // reported, nor trivial shareable ones like "x+1".
+
+  static const UInt_t kMinShared = 4;
+
+  // Subexpression on the evaluation stack
+  struct Node_t {
+    UInt_t begin, end;
+    Bool_t match;  // Subexpression meets the criterion
+  };
+  vector<Node_t> st;
+  vector<pair<Node_t,UInt_t>> left; // Left operands of pending && and ||,
+                                    // and jump targets
+  ranges.clear();
+  auto report = [&]( const Node_t& nd ) {
+    UInt_t minlen = (what == kFoldable) ? 2 : kMinShared;
+    if( nd.match && nd.end - nd.begin >= minlen )
+      ranges.emplace_back(nd.begin, nd.end);
+  };
+  // Replace the 'nargs' topmost nodes with the result of instruction 'i'
+  auto combine = [&]( UInt_t i, UInt_t nargs, Bool_t match ) {
+    assert( st.size() >= nargs );
+    auto first = st.end() - nargs;
+    for( auto it = first; it != st.end(); ++it )
+      match = match && it->match;
+    if( !match )
+      for( auto it = first; it != st.end(); ++it )
+        report(*it);
+    Node_t nd{ first->begin, i+1, match };
+    st.erase(first, st.end());
+    st.push_back(nd);
+  };
+
+  for( UInt_t i = 0; i < fCode.size(); ++i ) {
+    switch( fCode[i].op ) {
+    case kConst:
+      st.push_back({ i, i+1, true });
+      break;
+    case kData:
+      st.push_back({ i, i+1, what == kShareable });
+      break;
+    case kGeneric:
+    case kArrayData:
+    case kShared:
+      st.push_back({ i, i+1, false });
+      break;
+    case kJumpIfFalse:
+    case kJumpIfTrue:
+      left.emplace_back(st.back(), fCode[i].arg);
+      st.pop_back();
+      break;
+    case kBool:
+      if( !left.empty() && left.back().second == i+1 ) {
+        // End of the right operand of the innermost && or ||. Never
+        // combine across the jump.
+        st.insert(st.end()-1, left.back().first);
+        left.pop_back();
+        combine(i, 2, false);
+      } else
+        combine(i, 1, true);
+      break;
+    case kNeg: case kNot:
+    case kSqrt: case kSq: case kAbs: case kSin: case kCos: case kTan:
+    case kASin: case kACos: case kATan: case kSinh: case kCosh: case kTanh:
+    case kExp: case kLog: case kLog10:
+      combine(i, 1, true);
+      break;
+    default:  // binary operators and functions of two arguments
+      combine(i, 2, true);
+      break;
+    }
+  }
+  assert( st.size() == 1 && left.empty() );
+  if( !st.empty() )
+    report(st.back());
+  std::sort(ranges.begin(), ranges.end());
+}
+
+//_____________________________________________________________________________
+void FormulaProgram::Replace( const Ranges_t& ranges,
+                              const vector<Instr_t>& replacements )
+{
+  // Replace the code in each of the (sorted, disjoint) 'ranges' with the
+  // corresponding single instruction in 'replacements' and fix up the
+  // jump targets
+
+  assert( ranges.size() == replacements.size() );
+  vector<Instr_t> code;
+  code.reserve(fCode.size());
+  vector<UInt_t> newpos(fCode.size()+1);
+  UInt_t i = 0;
+  for( UInt_t r = 0; r <= ranges.size(); ++r ) {
+    UInt_t end = (r < ranges.size()) ? ranges[r].first : fCode.size();
+    for( ; i < end; ++i ) {
+      newpos[i] = code.size();
+      code.push_back(fCode[i]);
+    }
+    if( r < ranges.size() ) {
+      for( ; i < ranges[r].second; ++i )
+        newpos[i] = code.size();  // jumps never point into a range
+      code.push_back(replacements[r]);
+    }
+  }
+  newpos[fCode.size()] = code.size();
+  for( auto& ins : code ) {
+    if( ins.op == kJumpIfFalse || ins.op == kJumpIfTrue )
+      ins.arg = newpos[ins.arg];
+  }
+  fCode.swap(code);
+}
+
+//_____________________________________________________________________________
+void FormulaProgram::Optimize()
+{
+  // Fold constant subexpressions and replace the largest subexpressions
+  // of scalar data with references to shared copies
+
+  Ranges_t ranges;
+  vector<Instr_t> repl;
+  FindRanges(kFoldable, ranges);
+  if( !ranges.empty() ) {
+    for( const auto& r : ranges ) {
+      FormulaProgram sub;
+      sub.fCode.assign(fCode.begin()+r.first, fCode.begin()+r.second);
+      Bool_t invalid = false;
+      repl.emplace_back(kConst, sub.Eval(nullptr, nullptr, 0, invalid));
+    }
+    Replace(ranges, repl);
+  }
+  FindRanges(kShareable, ranges);
+  if( !ranges.empty() ) {
+    repl.clear();
+    for( const auto& r : ranges ) {
+      const Instr_t* code = fCode.data();
+      fShared.push_back(GetPool().Get(code+r.first, code+r.second));
+      repl.emplace_back(kShared, 0, 0, fShared.back().get());
+    }
+    Replace(ranges, repl);
+  }
+}
+
+//_____________________________________________________________________________
+FormulaProgram::SharedPool& FormulaProgram::GetPool()
+{
+  static SharedPool pool;
+  return pool;
+}
+
+//_____________________________________________________________________________
+UInt_t FormulaProgram::GetPoolSize()
+{
+  // Number of distinct shared subexpressions currently in use
+
+  return GetPool().Size();
+}
+
+//_____________________________________________________________________________
+void FormulaProgram::SetCaching( Bool_t enable )
+{
+  // Enable/disable caching of the results of shared subexpressions.
+  // Also starts a new event generation, so no stale results are used.
+
+  fgCaching = enable;
+  NewEvent();
+}
+
+//_____________________________________________________________________________
+Double_t FormulaProgram::Eval( Generic_t generic, void* obj, Int_t instance,
+                               Bool_t& invalid ) const
+{
+  // Run the program. kGeneric operands are evaluated via generic(obj,index).
+  // 'instance' selects the element of array operands. If an array element
+  // is out of range, 'invalid' is set to true. The return value is then
+  // meaningless.
+
+  assert( IsValid() );
+  Double_t st[kMaxStack];
+  Int_t sp = -1;
+  const UInt_t n = fCode.size();
+  for( UInt_t pc = 0; pc < n; ++pc ) {
+    const Instr_t& ins = fCode[pc];
+    switch( ins.op ) {
+    case kConst:
+      st[++sp] = ins.val;
+      break;
+    case kGeneric:
+      st[++sp] = generic(obj, ins.arg);
+      break;
+    case kData:
+      st[++sp] = ReadData(static_cast<VarType>(ins.arg), ins.ptr, 0);
+      break;
+    case kArrayData:
+      if( instance < ins.len )
+        st[++sp] = ReadData(static_cast<VarType>(ins.arg), ins.ptr, instance);
+      else {
+        invalid = true;
+        st[++sp] = 1.0;
+      }
+      break;
+    case kAdd: --sp; st[sp] += st[sp+1]; break;
+    case kSub: --sp; st[sp] -= st[sp+1]; break;
+    case kMul: --sp; st[sp] *= st[sp+1]; break;
+    case kDiv: --sp; st[sp] = OpDiv(st[sp], st[sp+1]); break;
+    case kMod: --sp; st[sp] = OpMod(st[sp], st[sp+1]); break;
+    case kPow: --sp; st[sp] = TMath::Power(st[sp], st[sp+1]); break;
+    case kEq:  --sp; st[sp] = (st[sp] == st[sp+1]); break;
+    case kNe:  --sp; st[sp] = (st[sp] != st[sp+1]); break;
+    case kLt:  --sp; st[sp] = (st[sp] <  st[sp+1]); break;
+    case kLe:  --sp; st[sp] = (st[sp] <= st[sp+1]); break;
+    case kGt:  --sp; st[sp] = (st[sp] >  st[sp+1]); break;
+    case kGe:  --sp; st[sp] = (st[sp] >= st[sp+1]); break;
+    case kBitAnd: --sp; st[sp] = OpBitAnd(st[sp], st[sp+1]); break;
+    case kBitOr:  --sp; st[sp] = OpBitOr(st[sp], st[sp+1]); break;
+    case kShl:    --sp; st[sp] = OpShl(st[sp], st[sp+1]); break;
+    case kShr:    --sp; st[sp] = OpShr(st[sp], st[sp+1]); break;
+    case kNeg:  st[sp] = -st[sp]; break;
+    case kNot:  st[sp] = (st[sp] == 0); break;
+    case kBool: st[sp] = (st[sp] != 0); break;
+    case kJumpIfFalse:
+      // Short-circuit &&: result is 0 if left operand is false
+      if( st[sp] == 0 ) {
+        st[sp] = 0;
+        pc = ins.arg - 1;
+      } else
+        --sp;
+      break;
+    case kJumpIfTrue:
+      // Short-circuit ||: result is 1 if left operand is true
+      if( st[sp] != 0 ) {
+        st[sp] = 1;
+        pc = ins.arg - 1;
+      } else
+        --sp;
+      break;
+    case kSqrt: st[sp] = OpSqrt(st[sp]); break;
+    case kSq:   st[sp] *= st[sp]; break;
+    case kAbs:  st[sp] = TMath::Abs(st[sp]); break;
+    case kSin:  st[sp] = TMath::Sin(st[sp]); break;
+    case kCos:  st[sp] = TMath::Cos(st[sp]); break;
+    case kTan:  st[sp] = TMath::Tan(st[sp]); break;
+    case kASin: st[sp] = OpASin(st[sp]); break;
+    case kACos: st[sp] = OpACos(st[sp]); break;
+    case kATan: st[sp] = TMath::ATan(st[sp]); break;
+    case kATan2: --sp; st[sp] = TMath::ATan2(st[sp], st[sp+1]); break;
+    case kSinh: st[sp] = TMath::SinH(st[sp]); break;
+    case kCosh: st[sp] = TMath::CosH(st[sp]); break;
+    case kTanh: st[sp] = TMath::TanH(st[sp]); break;
+    case kExp:   st[sp] = OpExp(st[sp]); break;
+    case kLog:   st[sp] = OpLog(st[sp]); break;
+    case kLog10: st[sp] = OpLog10(st[sp]); break;
+    case kMin: --sp; st[sp] = TMath::Min(st[sp], st[sp+1]); break;
+    case kMax: --sp; st[sp] = TMath::Max(st[sp], st[sp+1]); break;
+    case kFmod: --sp; st[sp] = fmod(st[sp], st[sp+1]); break;
+    case kShared:
+      st[++sp] = static_cast<const Shared_t*>(ins.ptr)->Value();
+      break;
+    }
+  }
+  assert( sp == 0 );
+  return st[0];
+}
+
+//_____________________________________________________________________________
+Bool_t FormulaProgram::EvalAll( GenericColumn_t generic, void* obj,
+                                Double_t* out, Int_t n,
+                                Bool_t& invalid ) const
+{
+  // Run the program for instances 0 ... n-1, storing the results in 'out'.
+  // kGeneric operands are evaluated via generic(obj,index,first,n,values).
+  // If an array element is out of range, 'invalid' is set to true. The
+  // results are then meaningless. Returns false, without doing anything,
+  // if the program cannot be evaluated this way (see IsColumnar).
+
+  assert( IsValid() );
+  if( !fColumnar )
+    return false;
+
+  typedef Double_t Column_t[kBlockSize];
+  Column_t st[kMaxStack];
+  for( Int_t first = 0; first < n; first += kBlockSize ) {
+    const Int_t m = TMath::Min(n - first, kBlockSize);
+    Int_t sp = -1;
+    for( const auto& ins : fCode ) {
+      switch( ins.op ) {
+      case kConst:
+        ++sp;
+        std::fill(st[sp], st[sp]+m, ins.val);
+        break;
+      case kGeneric:
+        ++sp;
+        generic(obj, ins.arg, first, m, st[sp]);
+        break;
+      case kData:
+        {
+          ++sp;
+          Double_t y = ReadData(static_cast<VarType>(ins.arg), ins.ptr, 0);
+          std::fill(st[sp], st[sp]+m, y);
+        }
+        break;
+      case kArrayData:
+        {
+          ++sp;
+          Int_t k = TMath::Max(0, TMath::Min(m, ins.len - first));
+          ReadData(static_cast<VarType>(ins.arg), ins.ptr, first, k, st[sp]);
+          if( k < m ) {
+            invalid = true;
+            for( Int_t j = k; j < m; ++j )
+              st[sp][j] = 1.0;
+          }
+        }
+        break;
+      case kAdd:    --sp; Apply(st[sp], st[sp+1], m, OpAdd); break;
+      case kSub:    --sp; Apply(st[sp], st[sp+1], m, OpSub); break;
+      case kMul:    --sp; Apply(st[sp], st[sp+1], m, OpMul); break;
+      case kDiv:    --sp; Apply(st[sp], st[sp+1], m, OpDiv); break;
+      case kMod:    --sp; Apply(st[sp], st[sp+1], m, OpMod); break;
+      case kPow:    --sp; Apply(st[sp], st[sp+1], m, OpPow); break;
+      case kEq:     --sp; Apply(st[sp], st[sp+1], m, OpEq); break;
+      case kNe:     --sp; Apply(st[sp], st[sp+1], m, OpNe); break;
+      case kLt:     --sp; Apply(st[sp], st[sp+1], m, OpLt); break;
+      case kLe:     --sp; Apply(st[sp], st[sp+1], m, OpLe); break;
+      case kGt:     --sp; Apply(st[sp], st[sp+1], m, OpGt); break;
+      case kGe:     --sp; Apply(st[sp], st[sp+1], m, OpGe); break;
+      case kBitAnd: --sp; Apply(st[sp], st[sp+1], m, OpBitAnd); break;
+      case kBitOr:  --sp; Apply(st[sp], st[sp+1], m, OpBitOr); break;
+      case kShl:    --sp; Apply(st[sp], st[sp+1], m, OpShl); break;
+      case kShr:    --sp; Apply(st[sp], st[sp+1], m, OpShr); break;
+      case kATan2:  --sp; Apply(st[sp], st[sp+1], m, OpATan2); break;
+      case kMin:    --sp; Apply(st[sp], st[sp+1], m, OpMin); break;
+      case kMax:    --sp; Apply(st[sp], st[sp+1], m, OpMax); break;
+      case kFmod:   --sp; Apply(st[sp], st[sp+1], m, OpFmod); break;
+      case kNeg:    Apply(st[sp], m, OpNeg); break;
+      case kNot:    Apply(st[sp], m, OpNot); break;
+      case kBool:   Apply(st[sp], m, OpBool); break;
+      case kSqrt:   Apply(st[sp], m, OpSqrt); break;
+      case kSq:     Apply(st[sp], m, OpSq); break;
+      case kAbs:    Apply(st[sp], m, OpAbs); break;
+      case kSin:    Apply(st[sp], m, OpSin); break;
+      case kCos:    Apply(st[sp], m, OpCos); break;
+      case kTan:    Apply(st[sp], m, OpTan); break;
+      case kASin:   Apply(st[sp], m, OpASin); break;
+      case kACos:   Apply(st[sp], m, OpACos); break;
+      case kATan:   Apply(st[sp], m, OpATan); break;
+      case kSinh:   Apply(st[sp], m, OpSinh); break;
+      case kCosh:   Apply(st[sp], m, OpCosh); break;
+      case kTanh:   Apply(st[sp], m, OpTanh); break;
+      case kExp:    Apply(st[sp], m, OpExp); break;
+      case kLog:    Apply(st[sp], m, OpLog); break;
+      case kLog10:  Apply(st[sp], m, OpLog10); break;
+      case kShared:
+        ++sp;
+        std::fill(st[sp], st[sp]+m,
+                  static_cast<const Shared_t*>(ins.ptr)->Value());
+        break;
+      case kJumpIfFalse:
+      case kJumpIfTrue:
+        assert(false); // excluded by fColumnar
+        break;
+      }
+    }
+    assert( sp == 0 );
+    for( Int_t j = 0; j < m; ++j )
+      out[first+j] = st[0][j];
+  }
+  return true;
+}
+
+} // namespace Podd
@@ -0,0 +1,123 @@
+#ifndef Podd_FormulaProgram_h_
+#define Podd_FormulaProgram_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::FormulaProgram
+//
+// Compiled (bytecode) form of a THaFormula expression
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include "VarType.h"
+#include <string>
+#include <vector>
+#include <functional>
+#include <memory>
+
+namespace Podd {
+
+class FormulaProgram {
+
+public:
+  // How a name in the expression is to be evaluated
+  class Operand_t {
+  public:
+    enum EKind { kGeneric, kData, kArrayData };
+    Operand_t() : kind(kGeneric), index(0), type(kDouble), ptr(nullptr), len(0) {}
+    EKind       kind;   // Evaluation method
+    Int_t       index;  // kGeneric: index passed to callback
+    VarType     type;   // kData/kArrayData: basic type of the data
+    const void* ptr;    // kData/kArrayData: address of (first element of) data
+    Int_t       len;    // kArrayData: number of elements
+  };
+  // Resolve a variable/cut name. Return false if not supported.
+  typedef std::function<Bool_t(const std::string&, Operand_t&)> Resolver_t;
+  // Callback for kGeneric operands
+  typedef Double_t (*Generic_t)( void* obj, Int_t index );
+  // Callback for kGeneric operands in EvalAll: store the values for
+  // instances first ... first+n-1 in 'out'
+  typedef void (*GenericColumn_t)( void* obj, Int_t index, Int_t first,
+                                   Int_t n, Double_t* out );
+
+  FormulaProgram() : fMaxStack(0), fColumnar(false) {}
+
+  Bool_t   Compile( const char* expression, const Resolver_t& resolve );
+  void     Clear();
+  Double_t Eval( Generic_t generic, void* obj, Int_t instance,
+                 Bool_t& invalid ) const;
+  Bool_t   EvalAll( GenericColumn_t generic, void* obj, Double_t* out,
+                    Int_t n, Bool_t& invalid ) const;
+  Bool_t   IsValid() const { return !fCode.empty(); }
+  Bool_t   IsColumnar() const { return fColumnar; }
+  UInt_t   GetSize() const { return fCode.size(); }
+  UInt_t   GetNShared() const { return fShared.size(); }
+
+  // Caching of shared subexpression results (see FormulaProgram.cxx).
+  // With caching enabled, NewEvent() must be called whenever the data
+  // may have changed.
+  static void   NewEvent() { if( ++fgGeneration == 0 ) ++fgGeneration; }
+  static void   SetCaching( Bool_t enable = true );
+  static Bool_t IsCaching() { return fgCaching; }
+  static UInt_t GetPoolSize();
+
+  static const UInt_t kMaxStack = 64;
+  static const Int_t  kBlockSize = 16;  // Instances per block in EvalAll
+
+private:
+  enum EOp {
+    kConst, kGeneric, kData, kArrayData,
+    kAdd, kSub, kMul, kDiv, kMod, kPow,
+    kEq, kNe, kLt, kLe, kGt, kGe,
+    kBitAnd, kBitOr, kShl, kShr,
+    kNeg, kNot, kBool, kJumpIfFalse, kJumpIfTrue,
+    kSqrt, kSq, kAbs, kSin, kCos, kTan, kASin, kACos, kATan, kATan2,
+    kSinh, kCosh, kTanh, kExp, kLog, kLog10, kMin, kMax, kFmod,
+    kShared
+  };
+
+  class Instr_t {
+  public:
+    Instr_t( EOp o, Double_t v = 0, Int_t a = 0, const void* p = nullptr,
+             Int_t n = 0 )
+      : op(o), arg(a), len(n), val(v), ptr(p) {}
+    EOp         op;
+    Int_t       arg;   // Jump target, callback index, or VarType
+    Int_t       len;   // Array length (kArrayData)
+    Double_t    val;   // Constant value
+    const void* ptr;   // Data address, or shared subexpression (kShared)
+  };
+
+  // Subexpression shared between programs
+  class Shared_t;
+  friend class Shared_t;
+  typedef std::shared_ptr<const Shared_t> SharedPtr_t;
+
+  std::vector<Instr_t> fCode;
+  UInt_t               fMaxStack;
+  Bool_t               fColumnar;  // Program can be run with EvalAll
+  std::vector<SharedPtr_t> fShared; // Shared subexpressions used
+
+  static UInt_t        fgGeneration; // Current event generation
+  static Bool_t        fgCaching;    // Cache shared subexpression results
+
+  typedef std::vector<std::pair<UInt_t,UInt_t>> Ranges_t;
+  enum ERange { kFoldable, kShareable };
+  void     FindRanges( ERange what, Ranges_t& ranges ) const;
+  void     Replace( const Ranges_t& ranges,
+                    const std::vector<Instr_t>& replacements );
+  void     Optimize();
+
+  // Registry of shared subexpressions
+  class SharedPool;
+  friend class SharedPool;
+  static SharedPool& GetPool();
+
+  class Parser;
+  friend class Parser;
+};
+
+} // namespace Podd
+
+#endif
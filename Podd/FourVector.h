@@ -0,0 +1,149 @@
+#ifndef Podd_FourVector_h_
+#define Podd_FourVector_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::ThreeVector, Podd::FourVector, Podd::AxisFrame
+//
+// Lightweight 3- and 4-vectors for the per-event kinematics calculations.
+// Plain value types with inline operations, without the TObject overhead
+// of TVector3/TLorentzVector. Conversions to and from the ROOT classes
+// are provided for interfacing with tracks and global variables.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include "TVector3.h"
+#include "TLorentzVector.h"
+#include <cmath>
+
+namespace Podd {
+
+//_____________________________________________________________________________
+class ThreeVector {
+public:
+  ThreeVector() : x(0), y(0), z(0) {}
+  ThreeVector( Double_t _x, Double_t _y, Double_t _z ) : x(_x), y(_y), z(_z) {}
+  explicit ThreeVector( const TVector3& v ) : x(v.X()), y(v.Y()), z(v.Z()) {}
+
+  Double_t    Dot( const ThreeVector& v ) const { return x*v.x+y*v.y+z*v.z; }
+  ThreeVector Cross( const ThreeVector& v ) const {
+    return { y*v.z-z*v.y, z*v.x-x*v.z, x*v.y-y*v.x };
+  }
+  Double_t    Mag2()  const { return x*x+y*y+z*z; }
+  Double_t    Mag()   const { return std::sqrt(Mag2()); }
+  Double_t    Perp()  const { return std::sqrt(x*x+y*y); }
+  Double_t    Theta() const { return (x == 0 && y == 0 && z == 0)
+                                ? 0.0 : std::atan2(Perp(),z); }
+  Double_t    Phi()   const { return (x == 0 && y == 0)
+                                ? 0.0 : std::atan2(y,x); }
+  Double_t    Angle( const ThreeVector& v ) const;
+  ThreeVector Unit()  const;
+  void        Get( TVector3& v ) const { v.SetXYZ(x,y,z); }
+
+  ThreeVector operator-() const { return { -x, -y, -z }; }
+  ThreeVector operator+( const ThreeVector& v ) const {
+    return { x+v.x, y+v.y, z+v.z };
+  }
+  ThreeVector operator-( const ThreeVector& v ) const {
+    return { x-v.x, y-v.y, z-v.z };
+  }
+  ThreeVector operator*( Double_t a ) const { return { a*x, a*y, a*z }; }
+
+  Double_t x, y, z;
+};
+
+//_____________________________________________________________________________
+inline Double_t ThreeVector::Angle( const ThreeVector& v ) const
+{
+  // Angle between this vector and v (rad), same convention as TVector3
+
+  Double_t ptot2 = Mag2()*v.Mag2();
+  if( ptot2 <= 0 )
+    return 0.0;
+  Double_t arg = Dot(v)/std::sqrt(ptot2);
+  if( arg >  1.0 ) arg =  1.0;
+  if( arg < -1.0 ) arg = -1.0;
+  return std::acos(arg);
+}
+
+//_____________________________________________________________________________
+inline ThreeVector ThreeVector::Unit() const
+{
+  Double_t tot2 = Mag2();
+  return (tot2 > 0) ? *this * (1.0/std::sqrt(tot2)) : *this;
+}
+
+//_____________________________________________________________________________
+class FourVector {
+public:
+  FourVector() : e(0) {}
+  FourVector( const ThreeVector& _p, Double_t _e ) : p(_p), e(_e) {}
+  explicit FourVector( const TLorentzVector& v )
+    : p(v.X(), v.Y(), v.Z()), e(v.E()) {}
+
+  static FourVector FromMass( const ThreeVector& _p, Double_t m ) {
+    return { _p, std::sqrt(_p.Mag2()+m*m) };
+  }
+
+  Double_t    M2()    const { return e*e-p.Mag2(); }
+  Double_t    M()     const;
+  Double_t    P()     const { return p.Mag(); }
+  Double_t    E()     const { return e; }
+  Double_t    Theta() const { return p.Theta(); }
+  Double_t    Phi()   const { return p.Phi(); }
+  FourVector  BoostZ( Double_t beta ) const;
+  void        Get( TLorentzVector& v ) const { v.SetXYZT(p.x,p.y,p.z,e); }
+
+  FourVector  operator+( const FourVector& v ) const {
+    return { p+v.p, e+v.e };
+  }
+  FourVector  operator-( const FourVector& v ) const {
+    return { p-v.p, e-v.e };
+  }
+
+  ThreeVector p;
+  Double_t    e;
+};
+
+//_____________________________________________________________________________
+inline Double_t FourVector::M() const
+{
+  // Invariant mass. Negative if the vector is spacelike, like
+  // TLorentzVector::M()
+
+  Double_t mm = M2();
+  return (mm < 0.0) ? -std::sqrt(-mm) : std::sqrt(mm);
+}
+
+//_____________________________________________________________________________
+inline FourVector FourVector::BoostZ( Double_t beta ) const
+{
+  // Lorentz boost with velocity beta along z. Equivalent to
+  // TLorentzVector::Boost(0,0,beta).
+
+  Double_t gamma = 1.0/std::sqrt(1.0-beta*beta);
+  return { ThreeVector(p.x, p.y, gamma*(p.z+beta*e)), gamma*(e+beta*p.z) };
+}
+
+//_____________________________________________________________________________
+class AxisFrame {
+public:
+  // Coordinate system whose z-axis points along 'zaxis' and whose x-axis
+  // lies in the plane of 'zaxis' and 'xzplane', on the side of 'xzplane'.
+  // ToFrame(v) gives the same result as v *= TRotation().SetZAxis(zaxis,
+  // xzplane).Invert().
+  AxisFrame( const ThreeVector& zaxis, const ThreeVector& xzplane )
+    : uz(zaxis.Unit()), uy(uz.Cross(xzplane).Unit()), ux(uy.Cross(uz).Unit()) {}
+
+  ThreeVector ToFrame( const ThreeVector& v ) const {
+    return { ux.Dot(v), uy.Dot(v), uz.Dot(v) };
+  }
+
+private:
+  ThreeVector uz, uy, ux;  // Unit vectors of the frame, in lab coordinates
+};
+
+} // namespace Podd
+
+#endif
@@ -0,0 +1,194 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::HistoServer
+//
+// Publishes snapshots of histograms in a ROOT TMapFile (shared memory),
+// from which monitoring clients, e.g. a TBrowser or an online GUI
+// opening the map file with TMapFile::Create(name), read the histograms
+// while the replay is running, without file output or flushing.
+//
+// Publish() copies the contents of the live histograms into a snapshot
+// buffer and hands it to a separate server thread, which streams it into
+// the map file. The buffers are rotated lock-free (triple buffering), so
+// Publish() never waits for the server thread or for clients: if the
+// server is still busy when a new snapshot arrives, the older pending
+// snapshot is simply superseded.
+//
+// Start() and Publish() must be called from the same thread.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "HistoServer.h"
+#include "TH1.h"
+#include "TMapFile.h"
+#include "TDirectory.h"
+#include "TError.h"
+#include <chrono>
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+HistoServer::HistoServer( const char* mapfile, UInt_t size )
+  : fMapFileName(mapfile), fSize(size), fMapFile(nullptr), fWrite(0),
+    fRead(1), fMiddle(2), fNPublished(0), fStop(false)
+{
+  // Constructor. 'mapfile' is the name of the shared memory map file,
+  // 'size' its maximum size in bytes. It must be large enough to hold
+  // all histograms.
+}
+
+//_____________________________________________________________________________
+HistoServer::~HistoServer()
+{
+  // Destructor. Stops the server thread and closes the map file.
+
+  Stop();
+}
+
+//_____________________________________________________________________________
+void HistoServer::Clear()
+{
+  // Delete all snapshot buffers and close the map file
+
+  delete fMapFile; fMapFile = nullptr;
+  for( auto& set : fSets ) {
+    for( auto* h : set )
+      delete h;
+    set.clear();
+  }
+  for( auto* h : fShared )
+    delete h;
+  fShared.clear();
+}
+
+//_____________________________________________________________________________
+static void CopyContents( const TH1& src, TH1& dst )
+{
+  // Copy bin contents, errors and statistics of 'src' to 'dst', which must
+  // have the same binning. TH1::Copy is not used since it registers the
+  // copy with the current directory.
+
+  for( Int_t i = 0; i < src.GetNcells(); ++i )
+    dst.SetBinContent(i, src.GetBinContent(i));
+  if( src.GetSumw2N() > 0 ) {
+    for( Int_t i = 0; i < src.GetNcells(); ++i )
+      dst.SetBinError(i, src.GetBinError(i));
+  }
+  Double_t stats[TH1::kNstat];
+  src.GetStats(stats);
+  dst.PutStats(stats);
+  dst.SetEntries(src.GetEntries());
+}
+
+//_____________________________________________________________________________
+Int_t HistoServer::Start( const vector<TH1*>& histos )
+{
+  // Create the map file for the given histograms and start the server
+  // thread. Publishes the current contents of the histograms.
+
+  const char* const here = "Podd::HistoServer::Start";
+
+  Stop();
+  if( fMapFileName.IsNull() ) {
+    ::Error( here, "No map file name given" );
+    return -1;
+  }
+  TDirectory* olddir = gDirectory;
+  fMapFile = TMapFile::Create(fMapFileName, "RECREATE", fSize,
+                              "Podd live histograms");
+  if( olddir )
+    olddir->cd();
+  if( !fMapFile || fMapFile->IsZombie() ) {
+    ::Error( here, "Cannot create map file %s", fMapFileName.Data() );
+    fMapFile = nullptr;
+    return -2;
+  }
+  // Detached copies, so neither ROOT directories nor the caller's
+  // histograms are affected by the buffers
+  Bool_t adddir = TH1::AddDirectoryStatus();
+  TH1::AddDirectory(false);
+  for( auto* h : histos ) {
+    if( !h )
+      continue;
+    for( auto& set : fSets )
+      set.push_back(static_cast<TH1*>(h->Clone()));
+    fShared.push_back(static_cast<TH1*>(h->Clone()));
+    fMapFile->Add(fShared.back(), fShared.back()->GetName());
+  }
+  TH1::AddDirectory(adddir);
+  fWrite = 0; fRead = 1; fMiddle = 2;
+  fNPublished = 0;
+  fStop = false;
+  fThread = thread(&HistoServer::ServeLoop, this);
+  return Publish(histos);
+}
+
+//_____________________________________________________________________________
+void HistoServer::Stop()
+{
+  // Stop the server thread and close the map file
+
+  if( fThread.joinable() ) {
+    {
+      lock_guard<mutex> lock(fMutex);
+      fStop = true;
+    }
+    fWake.notify_one();
+    fThread.join();
+  }
+  Clear();
+}
+
+//_____________________________________________________________________________
+Int_t HistoServer::Publish( const vector<TH1*>& histos )
+{
+  // Make a snapshot of the current contents of 'histos' available to
+  // clients. 'histos' must be the list given to Start(). If histograms
+  // have been added since (e.g. variable-size THaVhist), the server is
+  // restarted.
+
+  if( !fMapFile )
+    return -1;
+  Set_t& set = fSets[fWrite];
+  UInt_t n = 0;
+  for( auto* h : histos ) {
+    if( !h )
+      continue;
+    if( n == set.size() )
+      return Start(histos);
+    CopyContents(*h, *set[n++]);
+  }
+  fWrite = fMiddle.exchange(fWrite | kNewData) & ~kNewData;
+  fWake.notify_one();
+  return 0;
+}
+
+//_____________________________________________________________________________
+void HistoServer::ServeLoop()
+{
+  // Main loop of the server thread. Streams each new snapshot into the
+  // map file.
+
+  unique_lock<mutex> lock(fMutex);
+  while( true ) {
+    // Publish() notifies without taking the lock, so poll as well
+    fWake.wait_for(lock, chrono::milliseconds(100), [this]{
+      return fStop || (fMiddle.load() & kNewData); });
+    if( fStop )
+      return;
+    if( !(fMiddle.load() & kNewData) )
+      continue;
+    fRead = fMiddle.exchange(fRead) & ~kNewData;
+    lock.unlock();
+    const Set_t& set = fSets[fRead];
+    for( size_t i = 0; i < set.size(); ++i )
+      CopyContents(*set[i], *fShared[i]);
+    fMapFile->Update();
+    ++fNPublished;
+    lock.lock();
+  }
+}
+
+} // namespace Podd
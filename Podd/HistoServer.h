@@ -0,0 +1,71 @@
+#ifndef Podd_HistoServer_h_
+#define Podd_HistoServer_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::HistoServer
+//
+// Publishes snapshots of histograms in shared memory for live monitoring
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include "TString.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+class TH1;
+class TMapFile;
+
+namespace Podd {
+
+class HistoServer {
+
+public:
+  explicit HistoServer( const char* mapfile, UInt_t size = kDefaultSize );
+  HistoServer( const HistoServer& ) = delete;
+  HistoServer& operator=( const HistoServer& ) = delete;
+  ~HistoServer();
+
+  Int_t         Start( const std::vector<TH1*>& histos );
+  void          Stop();
+  Int_t         Publish( const std::vector<TH1*>& histos );
+  Bool_t        IsRunning()      const { return fThread.joinable(); }
+  const char*   GetMapFileName() const { return fMapFileName.Data(); }
+  UInt_t        GetNPublished()  const { return fNPublished; }
+
+  static const UInt_t kDefaultSize = 16u<<20;  // Map file size (bytes)
+
+private:
+  // One copy of all histograms. Three sets are rotated between the
+  // analysis (writer) thread, the server (reader) thread, and the most
+  // recent snapshot waiting to be picked up.
+  typedef std::vector<TH1*> Set_t;
+
+  static const UInt_t kNewData = 4; // Flag in fMiddle: snapshot not yet read
+
+  TString            fMapFileName;  // Shared memory map file name
+  UInt_t             fSize;         // Map file size (bytes)
+  TMapFile*          fMapFile;      // Shared memory region
+  Set_t              fSets[3];      // Snapshot buffers
+  Set_t              fShared;       // Copies registered with fMapFile
+  UInt_t             fWrite;        // Set owned by writer
+  UInt_t             fRead;         // Set owned by reader
+  std::atomic<UInt_t> fMiddle;      // Set waiting (| kNewData if unread)
+  std::atomic<UInt_t> fNPublished;  // Snapshots written to shared memory
+  Bool_t             fStop;         // Request to stop server thread
+
+  std::thread             fThread;
+  std::mutex              fMutex;
+  std::condition_variable fWake;
+
+  void Clear();
+  void ServeLoop();
+};
+
+} // namespace Podd
+
+#endif
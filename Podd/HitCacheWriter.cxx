@@ -0,0 +1,241 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::HitCacheWriter
+//
+// Writes the raw hits that the detectors decode in each physics event
+// to a ROOT tree in the format read by Podd::SimTreeRun, i.e. one pair
+// of std::vector<UInt_t> branches per detector and hit type:
+//
+//   <prefix>adc.chan, <prefix>adc.data             ADC hits
+//   <prefix>tdc.chan, <prefix>tdc.data             common-stop TDC hits
+//   <prefix>tdcstart.chan, <prefix>tdcstart.data   common-start TDC hits
+//
+// plus the event number ("evnum"). The run number and date are stored
+// as "run_number" and "run_date" parameters in the tree's user info.
+//
+// Replaying this file with SimTreeRun and SimTreeDecoder gives the
+// detectors the same raw data, but skips reading and decoding the CODA
+// data. This speeds up calibration passes that only change constants
+// applied after decoding (TDC offsets, pedestals, gains, VDC t0s, optics
+// etc.). The channels are logical channels of the detector maps, so the
+// detector maps must be the same in both replays.
+//
+// Only detectors that support direct hit injection
+// (THaDetectorBase::SupportsDirectHits) are written. Other detectors,
+// for example those reading FADC pulse data, and all other decoded data
+// (scalers, EPICS, THaDecData variables etc.) are not available in the
+// replay.
+//
+// Usage:
+//   analyzer->AddPostProcess( new Podd::HitCacheWriter("hits_1234.root") );
+//   ...
+//   // later
+//   gHaDecoder = Podd::SimTreeDecoder::Class();
+//   Podd::SimTreeRun run("hits_1234.root");
+//   analyzer->Process(run);
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "HitCacheWriter.h"
+#include "THaDetectorBase.h"
+#include "THaDetMap.h"
+#include "THaEvData.h"
+#include "THaRunBase.h"
+#include "TFile.h"
+#include "TDirectory.h"
+#include "TTree.h"
+#include "TList.h"
+#include "TParameter.h"
+#include "TDatime.h"
+#include "TError.h"
+#include <utility>
+
+using namespace std;
+
+namespace Podd {
+
+HitCacheWriter* HitCacheWriter::fgActive = nullptr;
+
+//_____________________________________________________________________________
+HitCacheWriter::Columns_t::Columns_t( string _prefix )
+  : prefix(std::move(_prefix))
+{
+  // Constructor
+
+  for( Int_t k = 0; k < kNTypes; ++k ) {
+    pchan[k] = &chan[k];
+    pdata[k] = &data[k];
+  }
+}
+
+//_____________________________________________________________________________
+Int_t HitCacheWriter::Columns_t::TypeIndex( Decoder::ChannelType type )
+{
+  // Column index for hits of the given type, or -1 if not supported
+
+  switch( type ) {
+  case Decoder::ChannelType::kADC:
+    return kADC;
+  case Decoder::ChannelType::kCommonStopTDC:
+    return kTDC;
+  case Decoder::ChannelType::kCommonStartTDC:
+    return kTDCStart;
+  default:
+    return -1;
+  }
+}
+
+//_____________________________________________________________________________
+HitCacheWriter::HitCacheWriter( const char* filename, const char* treename )
+  : fFileName(filename), fTreeName(treename), fFile(nullptr), fTree(nullptr),
+    fEvNum(0), fRunSet(false)
+{
+  // Constructor
+}
+
+//_____________________________________________________________________________
+HitCacheWriter::~HitCacheWriter()
+{
+  // Destructor
+
+  Close();
+}
+
+//_____________________________________________________________________________
+HitCacheWriter::Columns_t* HitCacheWriter::GetColumns( const char* prefix ) const
+{
+  // Return the columns for the detector with the given prefix, or nullptr
+  // if its hits are not written
+
+  if( !fIsInit || !prefix )
+    return nullptr;
+  auto it = fIndex.find(prefix);
+  return (it != fIndex.end()) ? it->second : nullptr;
+}
+
+//_____________________________________________________________________________
+Int_t HitCacheWriter::Init( const TDatime& run_time )
+{
+  // Open the output file and define one pair of branches per hit type for
+  // each initialized detector that supports direct hit injection.
+  // Subsequent runs are appended to the same file.
+
+  const char* const here = "HitCacheWriter::Init";
+
+  if( fIsInit )
+    return 0;
+
+  TDirectory* olddir = gDirectory;
+  fFile = TFile::Open(fFileName, "RECREATE");
+  if( !fFile || fFile->IsZombie() ) {
+    Error( here, "Cannot open hit cache file %s for writing.",
+           fFileName.Data() );
+    delete fFile; fFile = nullptr;
+    olddir->cd();
+    return -3;
+  }
+  fTree = new TTree(fTreeName, "Decoded detector hits");
+  fTree->Branch("evnum", &fEvNum, "evnum/i");
+
+  static const char* const suffix[Columns_t::kNTypes] =
+    { "adc.", "tdc.", "tdcstart." };
+  fColumns.clear();
+  fIndex.clear();
+  TIter next(THaAnalysisObject::GetModules());
+  while( TObject* obj = next() ) {
+    auto* det = dynamic_cast<THaDetectorBase*>(obj);
+    if( !det || !det->IsOK() || !det->SupportsDirectHits() ||
+        !det->GetDetMap() || det->GetDetMap()->GetSize() == 0 )
+      continue;
+    bool has_type[Columns_t::kNTypes] = { false, false, false };
+    THaDetMap* detmap = det->GetDetMap();
+    for( UInt_t i = 0; i < detmap->GetSize(); ++i ) {
+      THaDetMap::Module* d = detmap->GetModule(i);
+      if( d->IsADC() )
+        has_type[Columns_t::kADC] = true;
+      else if( d->IsTDC() )
+        has_type[d->IsCommonStart() ? Columns_t::kTDCStart
+                                    : Columns_t::kTDC] = true;
+    }
+    string prefix = det->GetPrefix();
+    if( fIndex.find(prefix) != fIndex.end() )
+      continue;
+    fColumns.emplace_back(new Columns_t(prefix));
+    Columns_t* col = fColumns.back().get();
+    fIndex.emplace(prefix, col);
+    for( Int_t k = 0; k < Columns_t::kNTypes; ++k ) {
+      if( !has_type[k] )
+        continue;
+      string name = prefix + suffix[k];
+      fTree->Branch((name + "chan").c_str(), &col->pchan[k]);
+      fTree->Branch((name + "data").c_str(), &col->pdata[k]);
+    }
+  }
+  if( fColumns.empty() )
+    Warning( here, "No detectors with hit data found. The hit cache %s "
+             "will be empty.", fFileName.Data() );
+
+  fTree->GetUserInfo()->Add(
+    new TParameter<Long64_t>("run_date", run_time.Convert()));
+  fRunSet = false;
+  olddir->cd();
+
+  if( fgActive && fgActive != this )
+    Warning( here, "Another hit cache is already active. Only %s will be "
+             "written.", fFileName.Data() );
+  fgActive = this;
+  fIsInit = 1;
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t HitCacheWriter::Process( const THaEvData* evdata, const THaRunBase* run,
+                               Int_t /* code */ )
+{
+  // Write the hits recorded by the detectors in this event, if it is a
+  // physics event, and clear them for the next event
+
+  if( !fIsInit )
+    return 0;
+
+  if( evdata && evdata->IsPhysicsTrigger() ) {
+    if( !fRunSet && run ) {
+      fTree->GetUserInfo()->Add(
+        new TParameter<Long64_t>("run_number", run->GetNumber()));
+      fRunSet = true;
+    }
+    fEvNum = evdata->GetEvNum();
+    fTree->Fill();
+  }
+  for( auto& col : fColumns )
+    col->Clear();
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t HitCacheWriter::Close()
+{
+  // Write the tree and close the output file
+
+  if( fgActive == this )
+    fgActive = nullptr;
+  Int_t ret = 0;
+  if( fFile ) {
+    TDirectory* olddir = gDirectory;
+    fFile->cd();
+    if( fTree && fTree->Write() <= 0 )
+      ret = -1;
+    delete fFile;  // Deletes fTree
+    olddir->cd();
+  }
+  fFile = nullptr;
+  fTree = nullptr;
+  fColumns.clear();
+  fIndex.clear();
+  fIsInit = 0;
+  return ret;
+}
+
+} // namespace Podd
+
+ClassImp(Podd::HitCacheWriter)
@@ -0,0 +1,87 @@
+#ifndef Podd_HitCacheWriter_h_
+#define Podd_HitCacheWriter_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::HitCacheWriter
+//
+// Post-processing module that writes the decoded hits of all detectors
+// to a columnar ROOT file that can be replayed with Podd::SimTreeRun and
+// Podd::SimTreeDecoder, without reading and decoding the CODA data again.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "THaPostProcess.h"
+#include "Decoder.h"   // for ChannelType
+#include "TString.h"
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+
+class TFile;
+class TTree;
+
+namespace Podd {
+
+class HitCacheWriter : public THaPostProcess {
+public:
+  explicit HitCacheWriter( const char* filename, const char* treename = "T" );
+  virtual ~HitCacheWriter();
+
+  virtual Int_t Init( const TDatime& run_time );
+  virtual Int_t Process( const THaEvData*, const THaRunBase*, Int_t code );
+  virtual Int_t Close();
+
+  // Hit columns of one detector. Filled by the detector's Decode().
+  class Columns_t {
+  public:
+    enum { kADC, kTDC, kTDCStart, kNTypes };
+    explicit Columns_t( std::string _prefix );
+    void Add( Decoder::ChannelType type, Int_t lchan, UInt_t val ) {
+      Int_t k = TypeIndex(type);
+      if( k >= 0 && lchan >= 0 ) {
+        chan[k].push_back(lchan);
+        data[k].push_back(val);
+      }
+    }
+    void Clear() {
+      for( Int_t k = 0; k < kNTypes; ++k ) {
+        chan[k].clear();
+        data[k].clear();
+      }
+    }
+    static Int_t TypeIndex( Decoder::ChannelType type );
+
+    std::string          prefix;           // Detector prefix, e.g. "R.s1."
+    std::vector<UInt_t>  chan[kNTypes];    // Logical channels per type
+    std::vector<UInt_t>  data[kNTypes];    // Raw data per type
+    std::vector<UInt_t>* pchan[kNTypes];   // Branch addresses
+    std::vector<UInt_t>* pdata[kNTypes];
+  };
+
+  Columns_t*  GetColumns( const char* prefix ) const;
+
+  const char* GetFileName() const { return fFileName.Data(); }
+
+  // The writer, if any, that currently records hits
+  static HitCacheWriter* GetActive() { return fgActive; }
+
+protected:
+  TString   fFileName;   // Name of output file
+  TString   fTreeName;   // Name of output tree
+  TFile*    fFile;       //! Output file
+  TTree*    fTree;       //! Output tree
+  UInt_t    fEvNum;      //! Event number of current entry
+  Bool_t    fRunSet;     //! Run number written to tree
+  std::vector<std::unique_ptr<Columns_t>> fColumns;  //! Columns per detector
+  std::map<std::string,Columns_t*>        fIndex;    //! Prefix -> columns
+
+  static HitCacheWriter* fgActive;  // Writer recording hits, if any
+
+  ClassDef(HitCacheWriter,0)  // Writes decoded detector hits for fast replays
+};
+
+} // namespace Podd
+
+#endif
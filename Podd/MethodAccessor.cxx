@@ -0,0 +1,92 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::MethodAccessor
+//
+// Compiled replacement for TMethodCall in method-based global variables.
+//
+// Classes register accessors for the member functions that are commonly
+// used in global variable definitions ("fTracks.THaTrack.GetLabPx()") with
+// PODD_REGISTER_METHOD. THaVarList::DefineByRTTI then uses a direct,
+// type-checked function call instead of going through the interpreter
+// for every access. Functions without a registered accessor still work
+// via TMethodCall.
+//
+// An accessor registered for a base class is used for a derived class
+// if the derived class does not declare a function of the same name
+// itself and the base class is at offset zero in the derived class.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "MethodAccessor.h"
+#include "TClass.h"
+#include "TList.h"
+#include "TBaseClass.h"
+#include <string>
+#include <map>
+
+using namespace std;
+
+namespace Podd {
+
+typedef map<string, MethodAccessor> AccessorMap_t;
+
+//_____________________________________________________________________________
+static AccessorMap_t& GetRegistry()
+{
+  // The registry. Constructed on first use since registration happens
+  // during static initialization.
+
+  static AccessorMap_t registry;
+  return registry;
+}
+
+//_____________________________________________________________________________
+Bool_t MethodAccessor::Register( const char* classname, const char* method,
+                                 const MethodAccessor& acc )
+{
+  // Register accessor 'acc' for member function 'method' of class
+  // 'classname'. Returns true if successful.
+
+  if( !classname || !method || !acc.IsValid() || acc.GetType() == kVarTypeEnd )
+    return false;
+  string key = string(classname) + "::" + method;
+  GetRegistry()[key] = acc;
+  return true;
+}
+
+//_____________________________________________________________________________
+const MethodAccessor* MethodAccessor::Find( TClass* cl, const char* method )
+{
+  // Find the accessor for member function 'method' of class 'cl' or one
+  // of its base classes. Returns nullptr if none is registered.
+
+  if( !cl || !method )
+    return nullptr;
+  const AccessorMap_t& registry = GetRegistry();
+  if( registry.empty() )
+    return nullptr;
+
+  auto it = registry.find(string(cl->GetName()) + "::" + method);
+  if( it != registry.end() )
+    return &it->second;
+
+  // A function of the same name in this class hides or overrides the
+  // registered one of a base class
+  TList* methods = cl->GetListOfMethods();
+  if( methods && methods->FindObject(method) )
+    return nullptr;
+
+  TList* bases = cl->GetListOfBases();
+  if( !bases )
+    return nullptr;
+  TIter next(bases);
+  while( auto* base = static_cast<TBaseClass*>(next()) ) {
+    if( base->GetDelta() != 0 )
+      continue;
+    if( const MethodAccessor* acc = Find(base->GetClassPointer(), method) )
+      return acc;
+  }
+  return nullptr;
+}
+
+} // namespace Podd
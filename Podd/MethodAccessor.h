@@ -0,0 +1,100 @@
+#ifndef Podd_MethodAccessor_h_
+#define Podd_MethodAccessor_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::MethodAccessor
+//
+// Compiled replacement for TMethodCall in method-based global variables
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include "VarType.h"
+#include <cstring>   // for memcpy
+
+class TClass;
+
+namespace Podd {
+
+// Return type traits: VarType of the result and type in which it is stored
+template< typename R > struct AccessorResult;
+#define PODD_ACCESSOR_RESULT(R,S,t)                         \
+  template<> struct AccessorResult<R> {                     \
+    typedef S Store_t;                                      \
+    static constexpr VarType kType = t;                     \
+  };
+PODD_ACCESSOR_RESULT(Double_t,  Double_t,  kDouble)
+PODD_ACCESSOR_RESULT(Float_t,   Float_t,   kFloat)
+PODD_ACCESSOR_RESULT(Long64_t,  Long64_t,  kLong)
+PODD_ACCESSOR_RESULT(ULong64_t, ULong64_t, kULong)
+PODD_ACCESSOR_RESULT(Long_t,    Long64_t,  kLong)
+PODD_ACCESSOR_RESULT(ULong_t,   ULong64_t, kULong)
+PODD_ACCESSOR_RESULT(Int_t,     Int_t,     kInt)
+PODD_ACCESSOR_RESULT(UInt_t,    UInt_t,    kUInt)
+PODD_ACCESSOR_RESULT(Short_t,   Short_t,   kShort)
+PODD_ACCESSOR_RESULT(UShort_t,  UShort_t,  kUShort)
+PODD_ACCESSOR_RESULT(Char_t,    Char_t,    kChar)
+PODD_ACCESSOR_RESULT(UChar_t,   UChar_t,   kUChar)
+PODD_ACCESSOR_RESULT(bool,      Char_t,    kChar)
+#undef PODD_ACCESSOR_RESULT
+template< typename R > struct AccessorResult<const R> : AccessorResult<R> {};
+
+// Class and return type of a const member function without arguments
+template< typename P > struct AccessorMemFn;
+template< typename T, typename R > struct AccessorMemFn<R (T::*)() const> {
+  typedef T Class_t;
+  typedef R Result_t;
+};
+
+class MethodAccessor {
+
+public:
+  // Call the function on 'obj' and store the result in 'result', which
+  // must have room for at least 8 bytes
+  typedef void (*Func_t)( const void* obj, void* result );
+
+  MethodAccessor() : fFunc(nullptr), fType(kVarTypeEnd) {}
+  MethodAccessor( Func_t func, VarType type ) : fFunc(func), fType(type) {}
+
+  void     Call( const void* obj, void* result ) const { fFunc(obj, result); }
+  VarType  GetType() const { return fType; }
+  Bool_t   IsValid() const { return fFunc != nullptr; }
+
+  // Accessor for member function 'pmf' of type 'P'
+  template< typename P, P pmf > static MethodAccessor Make() {
+    typedef typename AccessorMemFn<P>::Result_t R;
+    return { &Invoke<P,pmf>, AccessorResult<R>::kType };
+  }
+
+  // Registry of accessors, looked up by THaVarList::DefineByRTTI
+  static Bool_t  Register( const char* classname, const char* method,
+                           const MethodAccessor& acc );
+  static const MethodAccessor* Find( TClass* cl, const char* method );
+
+private:
+  Func_t   fFunc;   // Compiled call of the member function
+  VarType  fType;   // Type of the stored result
+
+  template< typename P, P pmf >
+  static void Invoke( const void* obj, void* result ) {
+    typedef typename AccessorMemFn<P>::Class_t T;
+    typedef typename AccessorMemFn<P>::Result_t R;
+    typename AccessorResult<R>::Store_t val =
+      (static_cast<const T*>(obj)->*pmf)();
+    memcpy(result, &val, sizeof(val));
+  }
+};
+
+} // namespace Podd
+
+// Register a compiled accessor for the const, argument-less member function
+// 'meth' of class 'cl'. Use at file scope in the class's implementation
+// file, e.g.
+//   PODD_REGISTER_METHOD(THaTrack, GetLabPx)
+#define PODD_REGISTER_METHOD(cl,meth)                                    \
+  static const Bool_t podd_acc_##cl##_##meth =                          \
+    Podd::MethodAccessor::Register( #cl, #meth,                         \
+      Podd::MethodAccessor::Make<decltype(&cl::meth), &cl::meth>() );
+
+#endif
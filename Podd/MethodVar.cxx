@@ -12,6 +12,7 @@
 #include "THaVar.h"
 #include "TError.h"
 #include "TMethodCall.h"
+#include "MethodAccessor.h"
 #include <cstring> // for memcpy
 #include <cassert>
 #include <cmath>
@@ -23,11 +24,14 @@ namespace Podd {
 
 //_____________________________________________________________________________
 MethodVar::MethodVar( THaVar* pvar, const void* addr,
-		      VarType type, TMethodCall* method )
-  : Variable(pvar,addr,type), fMethod(method), fData(0)
+		      VarType type, TMethodCall* method,
+		      const MethodAccessor* acc )
+  : Variable(pvar,addr,type), fMethod(method), fAccessor(acc), fData(0)
 {
-  // Constructor
-  assert( fMethod );
+  // Constructor. If 'acc' is given, the function is called through it,
+  // and 'method' may be null.
+  assert( fMethod || fAccessor );
+  assert( !fAccessor || fAccessor->GetType() == type );
 
   if( !VerifyNonArrayName(GetName()) ) {
     fValueP = nullptr;
@@ -52,7 +56,6 @@ const void* MethodVar::GetDataPointer( Int_t i ) const
   const char* const here = "GetDataPointer()";
 
   assert( fValueP );
-  assert( fMethod );
 
   if( i != 0 ) {
     fSelf->Error( here, "Index out of range, variable %s, index %d", GetName(), i );
@@ -67,6 +70,13 @@ const void* MethodVar::GetDataPointer( const void* obj ) const
 {
   // Make the method call on the object pointed to by 'obj'
 
+  if( fAccessor ) {
+    // Compiled call. The result is stored with the correct type.
+    fAccessor->Call( obj, &fData );
+    return &fData;
+  }
+
+  assert( fMethod );
   void* pobj = const_cast<void*>(obj);  // TMethodCall wants a non-const object...
 
   if( IsFloat() ) {
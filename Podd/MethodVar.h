@@ -15,11 +15,13 @@ class TMethodCall;
 
 namespace Podd {
 
+  class MethodAccessor;
+
   class MethodVar : virtual public Variable {
 
   public:
     MethodVar( THaVar* pvar, const void* addr, VarType type,
-	       TMethodCall* method );
+	       TMethodCall* method, const MethodAccessor* acc = nullptr );
     virtual ~MethodVar();
 
     virtual const void*  GetDataPointer( Int_t i = 0 ) const;
@@ -27,6 +29,7 @@ namespace Podd {
 
   protected:
     TMethodCall*         fMethod;   //Member function to access data in object
+    const MethodAccessor* fAccessor; //Compiled call of the function, if available
     // Data cache, filled in GetDataPointer()
     mutable Double_t     fData;     //Function call result (interpretation depends on fType!)
 
@@ -0,0 +1,204 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::NTupleOutput
+//
+// Writer for ROOT's columnar RNTuple format, used by THaOutput as an
+// optional second output alongside the regular tree. Each scalar
+// quantity becomes a Double_t field and each array a std::vector<Double_t>
+// collection field, so variable-length arrays need no separate "Ndata"
+// counter.
+//
+// The field names are the global variable names with all characters
+// that RNTuple does not allow in field names ('.' in particular)
+// replaced by '_', e.g. "L.tr.px" becomes "L_tr_px".
+//
+// RNTuple support requires ROOT 6.30 or later built with the ROOTNTuple
+// library. Without it, Init() fails with an error message and nothing
+// is written.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "NTupleOutput.h"
+#include "TError.h"
+#include <utility>
+#include <cctype>
+#include <cassert>
+
+#ifdef PODD_HAS_RNTUPLE
+#include "RVersion.h"
+#include <ROOT/RNTupleModel.hxx>
+#include <ROOT/RNTupleWriter.hxx>
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,34,0)
+namespace RNT = ROOT;
+#else
+namespace RNT = ROOT::Experimental;
+#endif
+#endif
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+class NTupleOutput::Impl {
+public:
+#ifdef PODD_HAS_RNTUPLE
+  unique_ptr<RNT::RNTupleWriter>           writer;
+  vector<shared_ptr<Double_t>>             scalars;
+  vector<shared_ptr<vector<Double_t>>>     arrays;
+#endif
+};
+
+//_____________________________________________________________________________
+NTupleOutput::NTupleOutput( string filename, string name )
+  : fFileName(std::move(filename)), fName(std::move(name))
+{
+  // Constructor. 'filename' is the name of the output file to create,
+  // 'name' the name of the ntuple in the file.
+}
+
+//_____________________________________________________________________________
+NTupleOutput::~NTupleOutput()
+{
+  Close();
+}
+
+//_____________________________________________________________________________
+Int_t NTupleOutput::AddScalar( const string& name )
+{
+  // Define a scalar Double_t field for variable 'name'
+
+  assert( !IsInit() );
+  fScalarNames.push_back(FieldName(name));
+  return static_cast<Int_t>(fScalarNames.size()) - 1;
+}
+
+//_____________________________________________________________________________
+Int_t NTupleOutput::AddArray( const string& name )
+{
+  // Define a variable-length array field for variable 'name'
+
+  assert( !IsInit() );
+  fArrayNames.push_back(FieldName(name));
+  return static_cast<Int_t>(fArrayNames.size()) - 1;
+}
+
+//_____________________________________________________________________________
+Int_t NTupleOutput::Init()
+{
+  // Create the output file with the fields defined so far.
+  // Returns 0 on success, <0 on error.
+
+  const char* const here = "NTupleOutput::Init";
+
+  if( IsInit() )
+    return 0;
+#ifdef PODD_HAS_RNTUPLE
+  unique_ptr<Impl> impl{new Impl};
+  try {
+    auto model = RNT::RNTupleModel::Create();
+    for( const auto& name : fScalarNames )
+      impl->scalars.push_back(model->MakeField<Double_t>(name));
+    for( const auto& name : fArrayNames )
+      impl->arrays.push_back(model->MakeField<vector<Double_t>>(name));
+    impl->writer = RNT::RNTupleWriter::Recreate(std::move(model), fName,
+                                                fFileName);
+  }
+  catch( const exception& e ) {
+    ::Error( here, "Cannot create RNTuple output file %s: %s",
+             fFileName.c_str(), e.what() );
+    return -2;
+  }
+  fImpl = std::move(impl);
+  return 0;
+#else
+  ::Error( here, "Cannot write %s: this analyzer was built without "
+           "RNTuple support (requires ROOT 6.30 or later).",
+           fFileName.c_str() );
+  return -1;
+#endif
+}
+
+//_____________________________________________________________________________
+Bool_t NTupleOutput::IsInit() const
+{
+  return fImpl != nullptr;
+}
+
+//_____________________________________________________________________________
+void NTupleOutput::SetScalar( UInt_t i, Double_t val )
+{
+  // Set value of the i-th scalar field for the current entry
+
+#ifdef PODD_HAS_RNTUPLE
+  assert( fImpl && i < fImpl->scalars.size() );
+  *fImpl->scalars[i] = val;
+#else
+  (void)i; (void)val;
+#endif
+}
+
+//_____________________________________________________________________________
+vector<Double_t>* NTupleOutput::GetArray( UInt_t i )
+{
+  // Get the i-th array field of the current entry for filling.
+  // The caller fills it completely each event.
+
+#ifdef PODD_HAS_RNTUPLE
+  assert( fImpl && i < fImpl->arrays.size() );
+  return fImpl->arrays[i].get();
+#else
+  (void)i;
+  return nullptr;
+#endif
+}
+
+//_____________________________________________________________________________
+Int_t NTupleOutput::Fill()
+{
+  // Write the current entry. Returns 0 on success.
+
+#ifdef PODD_HAS_RNTUPLE
+  if( !fImpl )
+    return -1;
+  fImpl->writer->Fill();
+  return 0;
+#else
+  return -1;
+#endif
+}
+
+//_____________________________________________________________________________
+void NTupleOutput::Close()
+{
+  // Flush any pending data and close the output file
+
+  fImpl.reset();
+}
+
+//_____________________________________________________________________________
+Bool_t NTupleOutput::IsAvailable()
+{
+  // True if RNTuple output is supported by this build
+
+#ifdef PODD_HAS_RNTUPLE
+  return true;
+#else
+  return false;
+#endif
+}
+
+//_____________________________________________________________________________
+string NTupleOutput::FieldName( const string& varname )
+{
+  // Convert global variable name to a valid RNTuple field name
+
+  string name(varname);
+  for( auto& c : name ) {
+    if( !isalnum(static_cast<unsigned char>(c)) && c != '_' )
+      c = '_';
+  }
+  return name;
+}
+
+} // namespace Podd
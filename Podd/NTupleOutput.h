@@ -0,0 +1,54 @@
+#ifndef Podd_NTupleOutput_h_
+#define Podd_NTupleOutput_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::NTupleOutput
+//
+// Columnar (RNTuple) output of scalar and array quantities
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace Podd {
+
+class NTupleOutput {
+
+public:
+  explicit NTupleOutput( std::string filename, std::string name = "T" );
+  NTupleOutput( const NTupleOutput& ) = delete;
+  NTupleOutput& operator=( const NTupleOutput& ) = delete;
+  ~NTupleOutput();
+
+  // Field definition, before Init(). Return the index of the new field.
+  Int_t  AddScalar( const std::string& name );
+  Int_t  AddArray( const std::string& name );
+
+  Int_t  Init();
+  void   SetScalar( UInt_t i, Double_t val );
+  std::vector<Double_t>* GetArray( UInt_t i );
+  Int_t  Fill();
+  void   Close();
+
+  Bool_t IsInit() const;
+  const std::string& GetFileName() const { return fFileName; }
+
+  static Bool_t      IsAvailable();
+  static std::string FieldName( const std::string& varname );
+
+private:
+  class Impl;
+
+  std::string fFileName;   // Output file name
+  std::string fName;       // Name of the ntuple
+  std::vector<std::string> fScalarNames, fArrayNames; // Field names
+  std::unique_ptr<Impl> fImpl;
+};
+
+} // namespace Podd
+
+#endif
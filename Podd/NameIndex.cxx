@@ -0,0 +1,261 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::NameIndex
+//
+// Hash index of TObjects keyed by their names, used by THaVarList to
+// speed up name lookups. The table uses open addressing with linear
+// probing; lookups by name don't require constructing a string, so
+// names with array subscripts can be looked up directly by passing the
+// length of the base name.
+//
+// For pattern matching, a name-sorted copy of the entries is built on
+// demand. FindPrefix() returns all objects whose names start with a
+// given prefix in the order in which they were added to the index.
+//
+// The index does not own the objects.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "NameIndex.h"
+#include "TObject.h"
+#include "TCollection.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <cassert>
+
+using namespace std;
+
+namespace Podd {
+
+static const size_t kInitSlots = 256;  // Initial table size (power of 2)
+
+//_____________________________________________________________________________
+NameIndex::Sorted_t::Sorted_t( string n, Long64_t s, TObject* o )
+  : name(std::move(n)), serial(s), obj(o)
+{
+}
+
+//_____________________________________________________________________________
+NameIndex::NameIndex()
+  : fNused(0), fNextSerial(0), fPrevSerial(0), fSortedOK(false)
+{
+}
+
+//_____________________________________________________________________________
+UInt_t NameIndex::Hash( const char* name, size_t len )
+{
+  // FNV-1a hash of the first 'len' characters of 'name'
+
+  UInt_t h = 2166136261U;
+  for( size_t i = 0; i < len; ++i ) {
+    h ^= static_cast<unsigned char>(name[i]);
+    h *= 16777619U;
+  }
+  return h;
+}
+
+//_____________________________________________________________________________
+void NameIndex::Insert( const Slot_t& slot )
+{
+  // Put 'slot' into the first free position of its probe sequence
+
+  const size_t mask = fSlots.size() - 1;
+  size_t i = slot.hash & mask;
+  while( fSlots[i].obj )
+    i = (i + 1) & mask;
+  fSlots[i] = slot;
+  ++fNused;
+}
+
+//_____________________________________________________________________________
+void NameIndex::Grow()
+{
+  // Double the table size (or allocate the initial table) and rehash
+
+  Resize(fSlots.empty() ? kInitSlots : 2 * fSlots.size());
+}
+
+//_____________________________________________________________________________
+void NameIndex::Resize( size_t nslots )
+{
+  // Rehash all objects into a table of 'nslots' slots (a power of 2)
+
+  vector<Slot_t> old;
+  old.swap(fSlots);
+  fSlots.resize(nslots);
+  fNused = 0;
+  for( const auto& slot : old ) {
+    if( slot.obj )
+      Insert(slot);
+  }
+}
+
+//_____________________________________________________________________________
+void NameIndex::Add( TObject* obj, Bool_t front )
+{
+  // Add 'obj' to the index. If 'front' is true, the object goes before
+  // all existing ones in the ordering used by FindPrefix.
+
+  if( !obj )
+    return;
+  // Keep the load factor below 1/2
+  if( 2 * (fNused + 1) > fSlots.size() )
+    Grow();
+  const char* name = obj->GetName();
+  Slot_t slot;
+  slot.hash = Hash(name, strlen(name));
+  slot.serial = front ? --fPrevSerial : fNextSerial++;
+  slot.obj = obj;
+  Insert(slot);
+  fSortedOK = false;
+}
+
+//_____________________________________________________________________________
+size_t NameIndex::SlotOf( const TObject* obj ) const
+{
+  // Return position of 'obj' in the table, or the table size if not found
+
+  if( !obj || fSlots.empty() )
+    return fSlots.size();
+  const char* name = obj->GetName();
+  const size_t mask = fSlots.size() - 1;
+  size_t i = Hash(name, strlen(name)) & mask;
+  while( fSlots[i].obj ) {
+    if( fSlots[i].obj == obj )
+      return i;
+    i = (i + 1) & mask;
+  }
+  return fSlots.size();
+}
+
+//_____________________________________________________________________________
+Bool_t NameIndex::Remove( const TObject* obj )
+{
+  // Remove 'obj' from the index. Returns true if it was found.
+
+  size_t i = SlotOf(obj);
+  if( i == fSlots.size() )
+    return false;
+
+  // Backward-shift deletion: move subsequent entries of the probe chain
+  // into the hole so that lookups never need tombstones
+  const size_t mask = fSlots.size() - 1;
+  size_t j = i;
+  while( true ) {
+    j = (j + 1) & mask;
+    if( !fSlots[j].obj )
+      break;
+    size_t home = fSlots[j].hash & mask;
+    // Entry j may fill hole i unless its home lies cyclically in (i,j]
+    bool movable = (i <= j) ? (home <= i || home > j) : (home <= i && home > j);
+    if( movable ) {
+      fSlots[i] = fSlots[j];
+      i = j;
+    }
+  }
+  fSlots[i] = Slot_t();
+  --fNused;
+  fSortedOK = false;
+  return true;
+}
+
+//_____________________________________________________________________________
+void NameIndex::Clear()
+{
+  fSlots.clear();
+  fNused = 0;
+  fNextSerial = fPrevSerial = 0;
+  fSorted.clear();
+  fSortedOK = false;
+}
+
+//_____________________________________________________________________________
+void NameIndex::Reserve( size_t n )
+{
+  // Make room for 'n' objects in total, so that adding them rehashes at
+  // most once
+
+  size_t nslots = fSlots.empty() ? kInitSlots : fSlots.size();
+  while( nslots < 2 * n )
+    nslots *= 2;
+  if( nslots != fSlots.size() )
+    Resize(nslots);
+}
+
+//_____________________________________________________________________________
+void NameIndex::Rebuild( const TCollection* coll )
+{
+  // Rebuild the index from the objects in 'coll'
+
+  Clear();
+  if( !coll )
+    return;
+  size_t nslots = kInitSlots;
+  while( nslots < 2 * static_cast<size_t>(coll->GetSize()) )
+    nslots *= 2;
+  fSlots.resize(nslots);
+  TIter next(coll);
+  while( TObject* obj = next() )
+    Add(obj);
+}
+
+//_____________________________________________________________________________
+TObject* NameIndex::Find( const char* name, size_t len ) const
+{
+  // Find object whose name equals the first 'len' characters of 'name'
+
+  if( !name || fSlots.empty() )
+    return nullptr;
+  const UInt_t h = Hash(name, len);
+  const size_t mask = fSlots.size() - 1;
+  size_t i = h & mask;
+  while( TObject* obj = fSlots[i].obj ) {
+    if( fSlots[i].hash == h ) {
+      const char* s = obj->GetName();
+      if( strncmp(s, name, len) == 0 && s[len] == '\0' )
+        return obj;
+    }
+    i = (i + 1) & mask;
+  }
+  return nullptr;
+}
+
+//_____________________________________________________________________________
+TObject* NameIndex::Find( const char* name ) const
+{
+  return name ? Find(name, strlen(name)) : nullptr;
+}
+
+//_____________________________________________________________________________
+Int_t NameIndex::FindPrefix( const string& prefix,
+                             vector<TObject*>& result ) const
+{
+  // Append to 'result' all objects whose names begin with 'prefix', in the
+  // order in which they were added. Returns the number of objects found.
+
+  if( !fSortedOK ) {
+    fSorted.clear();
+    fSorted.reserve(fNused);
+    for( const auto& slot : fSlots ) {
+      if( slot.obj )
+        fSorted.emplace_back(slot.obj->GetName(), slot.serial, slot.obj);
+    }
+    sort(fSorted.begin(), fSorted.end());
+    fSortedOK = true;
+  }
+  auto it = lower_bound(fSorted.begin(), fSorted.end(),
+                        Sorted_t(prefix, 0, nullptr));
+  vector<const Sorted_t*> found;
+  for( ; it != fSorted.end() &&
+         it->name.compare(0, prefix.size(), prefix) == 0; ++it )
+    found.push_back(&*it);
+  sort(found.begin(), found.end(), []( const Sorted_t* a, const Sorted_t* b ) {
+    return a->serial < b->serial;
+  });
+  for( const auto* entry : found )
+    result.push_back(entry->obj);
+  return static_cast<Int_t>(found.size());
+}
+
+} // namespace Podd
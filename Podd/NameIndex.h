@@ -0,0 +1,76 @@
+#ifndef Podd_NameIndex_h_
+#define Podd_NameIndex_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::NameIndex
+//
+// Flat hash index of named objects with prefix search
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+class TObject;
+class TCollection;
+
+namespace Podd {
+
+class NameIndex {
+
+public:
+  NameIndex();
+
+  void     Add( TObject* obj, Bool_t front = false );
+  Bool_t   Remove( const TObject* obj );
+  void     Clear();
+  void     Rebuild( const TCollection* coll );
+  void     Reserve( size_t n );
+
+  // Find object with the given name (first 'len' characters of 'name')
+  TObject* Find( const char* name, size_t len ) const;
+  TObject* Find( const char* name ) const;
+  // Objects whose names start with 'prefix', in insertion order
+  Int_t    FindPrefix( const std::string& prefix,
+                       std::vector<TObject*>& result ) const;
+
+  size_t   Size() const { return fNused; }
+
+private:
+  class Slot_t {
+  public:
+    Slot_t() : hash(0), serial(0), obj(nullptr) {}
+    UInt_t    hash;     // Hash of the object's name
+    Long64_t  serial;   // Insertion sequence number
+    TObject*  obj;      // Object (nullptr = empty slot)
+  };
+  class Sorted_t {
+  public:
+    Sorted_t( std::string n, Long64_t s, TObject* o );
+    std::string name;
+    Long64_t    serial;
+    TObject*    obj;
+    bool operator<( const Sorted_t& rhs ) const { return name < rhs.name; }
+  };
+
+  std::vector<Slot_t>  fSlots;      // Open-addressing table (size 2^n)
+  size_t               fNused;      // Number of occupied slots
+  Long64_t             fNextSerial; // Serial number for Add() at the back
+  Long64_t             fPrevSerial; // Serial number for Add() at the front
+  mutable std::vector<Sorted_t> fSorted;  // Name-ordered entries for prefix search
+  mutable Bool_t       fSortedOK;   // fSorted is up to date
+
+  void     Grow();
+  void     Resize( size_t nslots );
+  void     Insert( const Slot_t& slot );
+  size_t   SlotOf( const TObject* obj ) const;
+
+  static UInt_t Hash( const char* name, size_t len );
+};
+
+} // namespace Podd
+
+#endif
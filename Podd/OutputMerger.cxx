@@ -0,0 +1,229 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::OutputMerger
+//
+// Reorder buffer for the output of events analyzed out of order, e.g. by
+// several worker threads. Producers hand over each event's output as a
+// record (a function that writes it) together with the event's sequence
+// number, in any order. A writer thread runs the records strictly in
+// sequence order, so the output is identical to that of a serial replay.
+//
+// The buffer holds the records of a window of 'depth' consecutive
+// sequence numbers, starting at the next one to be written. A producer
+// submitting a record beyond the window waits until the writer has
+// caught up (backpressure), which bounds the memory held by finished but
+// unwritten events. The depth should be at least a few times the number
+// of producers, or they will often wait for the slowest event.
+//
+// Every sequence number must be submitted exactly once; events without
+// output (e.g. rejected by a filter) are submitted with an empty record.
+// A sequence number that is never submitted stalls the writer.
+//
+// Exceptions thrown by records are caught on the writer thread and
+// rethrown by the next Submit() or by Stop(). Records after the failed
+// one are still written, so that producers never deadlock.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "OutputMerger.h"
+#include <cassert>
+#include <utility>
+#include <algorithm>
+
+using namespace std;
+
+namespace Podd {
+
+const UInt_t OutputMerger::kDefaultDepth;
+
+//_____________________________________________________________________________
+OutputMerger::OutputMerger( UInt_t depth )
+  : fSlots(std::max(depth, 1U)), fNext(0), fNWritten(0), fNWaits(0),
+    fNQueued(0), fStop(false)
+{
+  // Constructor. 'depth' is the number of sequence numbers ahead of the
+  // next record to be written that producers may submit.
+}
+
+//_____________________________________________________________________________
+OutputMerger::~OutputMerger()
+{
+  try {
+    Stop();
+  }
+  catch( ... ) {}
+}
+
+//_____________________________________________________________________________
+Int_t OutputMerger::Start( ULong64_t first )
+{
+  // Start the writer thread. 'first' is the sequence number of the first
+  // record to be written. Returns 0 on success, -1 if already running.
+
+  if( IsRunning() )
+    return -1;
+  for( auto& slot : fSlots ) {
+    slot.record = nullptr;
+    slot.filled = false;
+  }
+  fNext = first;
+  fNWritten = fNWaits = 0;
+  fNQueued = 0;
+  fStop = false;
+  fError = nullptr;
+  fThread = thread(&OutputMerger::WriteLoop, this);
+  return 0;
+}
+
+//_____________________________________________________________________________
+ULong64_t OutputMerger::Stop()
+{
+  // Write all records that are next in sequence, then stop the writer
+  // thread. Returns the number of records discarded because an earlier
+  // sequence number was never submitted. Rethrows the first exception
+  // thrown by a record, if any.
+
+  if( !IsRunning() )
+    return 0;
+  {
+    lock_guard<mutex> lock(fMutex);
+    fStop = true;
+  }
+  fReady.notify_one();
+  fNotFull.notify_all();
+  fDrained.notify_all();
+  fThread.join();
+
+  ULong64_t ndiscard = 0;
+  for( auto& slot : fSlots ) {
+    if( slot.filled ) {
+      slot.record = nullptr;
+      slot.filled = false;
+      ++ndiscard;
+    }
+  }
+  fNQueued = 0;
+  if( fError ) {
+    exception_ptr err = fError;
+    fError = nullptr;
+    rethrow_exception(err);
+  }
+  return ndiscard;
+}
+
+//_____________________________________________________________________________
+Int_t OutputMerger::Submit( ULong64_t seq, Record_t record )
+{
+  // Hand over the output 'record' of the event with sequence number 'seq'.
+  // Blocks while 'seq' lies beyond the window of the buffer.
+  // Returns 0 on success, -1 if the merger is stopped, -2 if 'seq' was
+  // already submitted or written.
+
+  unique_lock<mutex> lock(fMutex);
+  if( fError ) {
+    exception_ptr err = fError;
+    fError = nullptr;
+    rethrow_exception(err);
+  }
+  if( !IsRunning() || fStop )
+    return -1;
+  if( seq < fNext )
+    return -2;
+  if( seq >= fNext + fSlots.size() ) {
+    ++fNWaits;
+    fNotFull.wait(lock, [this,seq]{
+      return fStop || seq < fNext + fSlots.size();
+    });
+    if( fStop )
+      return -1;
+  }
+  Slot& slot = fSlots[seq % fSlots.size()];
+  if( slot.filled )
+    return -2;
+  slot.record = std::move(record);
+  slot.filled = true;
+  ++fNQueued;
+  bool is_next = (seq == fNext);
+  lock.unlock();
+  if( is_next )
+    fReady.notify_one();
+  return 0;
+}
+
+//_____________________________________________________________________________
+void OutputMerger::Drain()
+{
+  // Wait until all submitted records have been written. All sequence
+  // numbers below the highest one submitted must have been submitted.
+
+  unique_lock<mutex> lock(fMutex);
+  fDrained.wait(lock, [this]{ return fStop || fNQueued == 0; });
+}
+
+//_____________________________________________________________________________
+ULong64_t OutputMerger::GetNext() const
+{
+  // Sequence number of the next record to be written
+
+  lock_guard<mutex> lock(fMutex);
+  return fNext;
+}
+
+//_____________________________________________________________________________
+ULong64_t OutputMerger::GetNWritten() const
+{
+  // Number of records written since Start()
+
+  lock_guard<mutex> lock(fMutex);
+  return fNWritten;
+}
+
+//_____________________________________________________________________________
+ULong64_t OutputMerger::GetNWaits() const
+{
+  // Number of Submit() calls that had to wait for the writer. Should be
+  // small compared to GetNWritten(); if not, increase the depth.
+
+  lock_guard<mutex> lock(fMutex);
+  return fNWaits;
+}
+
+//_____________________________________________________________________________
+void OutputMerger::WriteLoop()
+{
+  // Writer thread. Runs the records in sequence order.
+
+  unique_lock<mutex> lock(fMutex);
+  while( true ) {
+    Slot* slot = &fSlots[fNext % fSlots.size()];
+    fReady.wait(lock, [this,&slot]{ return fStop || slot->filled; });
+    if( !slot->filled )
+      break;  // Stopped and next record not available
+
+    Record_t record = std::move(slot->record);
+    lock.unlock();
+    if( record ) {
+      try {
+        record();
+      }
+      catch( ... ) {
+        lock.lock();
+        if( !fError )
+          fError = current_exception();
+        lock.unlock();
+      }
+    }
+    lock.lock();
+    slot->record = nullptr;
+    slot->filled = false;
+    ++fNext;
+    ++fNWritten;
+    assert( fNQueued > 0 );
+    --fNQueued;
+    fNotFull.notify_all();
+    if( fNQueued == 0 )
+      fDrained.notify_all();
+  }
+}
+
+} // namespace Podd
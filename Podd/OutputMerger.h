@@ -0,0 +1,76 @@
+#ifndef Podd_OutputMerger_h_
+#define Podd_OutputMerger_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::OutputMerger
+//
+// Bounded reorder buffer that writes per-event output records, submitted
+// by several producer threads in any order, in event sequence order.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+namespace Podd {
+
+class OutputMerger {
+
+public:
+  // Writes one event's output, e.g. copies its values into the output
+  // buffers and fills the tree. An empty record stands for an event
+  // without output.
+  typedef std::function<void()> Record_t;
+
+  explicit OutputMerger( UInt_t depth = kDefaultDepth );
+  OutputMerger( const OutputMerger& ) = delete;
+  OutputMerger& operator=( const OutputMerger& ) = delete;
+  ~OutputMerger();
+
+  Int_t      Start( ULong64_t first = 0 );
+  ULong64_t  Stop();
+  Int_t      Submit( ULong64_t seq, Record_t record );
+  void       Drain();
+
+  UInt_t     GetDepth()    const { return static_cast<UInt_t>(fSlots.size()); }
+  ULong64_t  GetNext()     const;
+  ULong64_t  GetNWritten() const;
+  ULong64_t  GetNWaits()   const;
+  Bool_t     IsRunning()   const { return fThread.joinable(); }
+
+  static const UInt_t kDefaultDepth = 64;
+
+private:
+  class Slot {
+  public:
+    Slot() : filled(false) {}
+    Record_t record;   // Output of the event
+    Bool_t   filled;   // Record submitted, not yet written
+  };
+
+  std::vector<Slot>  fSlots;    // Ring of records, indexed by seq % depth
+  ULong64_t          fNext;     // Sequence number to write next
+  ULong64_t          fNWritten; // Records written (incl. empty ones)
+  ULong64_t          fNWaits;   // Submits that had to wait for space
+  UInt_t             fNQueued;  // Records submitted, not yet written
+  Bool_t             fStop;     // Request to stop writer thread
+  std::exception_ptr fError;    // First exception thrown by a record
+
+  std::thread             fThread;
+  mutable std::mutex      fMutex;
+  std::condition_variable fReady;    // Record fNext has been submitted
+  std::condition_variable fNotFull;  // Window has advanced
+  std::condition_variable fDrained;  // Window is empty
+
+  void   WriteLoop();
+};
+
+} // namespace Podd
+
+#endif
@@ -0,0 +1,51 @@
+/////////////////////////////////////////////////////////////////////
+//
+//   Podd::OutputTreeDecoder
+//
+//   Decoder for events read by Podd::OutputTreeRun. There is no raw
+//   data. The event header is set from the input tree, and modules
+//   that replay results of the previous analysis (TreeSpectrometer,
+//   TreeBeam, TreeVariables) get their input with GetColumn().
+//
+//   Usage:
+//     gHaDecoder = Podd::OutputTreeDecoder::Class();
+//     Podd::OutputTreeRun run("replay_1234.root");
+//     analyzer->Process(run);
+//
+/////////////////////////////////////////////////////////////////////
+
+#include "OutputTreeDecoder.h"
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+OutputTreeDecoder::OutputTreeDecoder() : fEvent(nullptr)
+{
+  // Constructor
+}
+
+//_____________________________________________________________________________
+Int_t OutputTreeDecoder::LoadEvent( const UInt_t* evbuffer )
+{
+  // Set the event header from the OutputTreeEvent in 'evbuffer'
+
+  Clear();
+  fEvent = nullptr;
+  if( !evbuffer )
+    return HED_ERR;
+
+  buffer = evbuffer;
+  fEvent = reinterpret_cast<const OutputTreeEvent*>(evbuffer);
+
+  event_num = fEvent->evnum;
+  event_type = fEvent->evtype;
+  run_num = fEvent->run;
+  event_length = static_cast<UInt_t>(fEvent->columns.size());
+  return HED_OK;
+}
+
+} // namespace Podd
+
+ClassImp(Podd::OutputTreeDecoder)
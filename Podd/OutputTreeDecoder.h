@@ -0,0 +1,40 @@
+#ifndef Podd_OutputTreeDecoder_h_
+#define Podd_OutputTreeDecoder_h_
+
+/////////////////////////////////////////////////////////////////////
+//
+//   Podd::OutputTreeDecoder
+//
+//   Decoder for events of analysis output trees read by
+//   Podd::OutputTreeRun.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include "THaEvData.h"
+#include "OutputTreeRun.h"
+
+namespace Podd {
+
+class OutputTreeDecoder : public THaEvData {
+public:
+  OutputTreeDecoder();
+  virtual ~OutputTreeDecoder() = default;
+
+  virtual Int_t LoadEvent( const UInt_t* evbuffer );
+
+  // Values of the branch 'name' in the current event, or nullptr if the
+  // input tree has no such branch
+  const OutputTreeEvent::Column_t* GetColumn( const std::string& name ) const {
+    return fEvent ? fEvent->Find(name) : nullptr;
+  }
+  const OutputTreeEvent* GetEvent() const { return fEvent; }
+
+protected:
+  const OutputTreeEvent* fEvent;  // Current event
+
+  ClassDef(OutputTreeDecoder,0)  // Decoder for analysis output trees
+};
+
+} // namespace Podd
+
+#endif
@@ -0,0 +1,325 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::OutputTreeRun
+//
+// Reads the output tree written by THaOutput in a previous replay
+// (default name "T"), so that physics modules, cuts and output can be
+// re-run at ROOT read speed, without decoding and reconstruction.
+//
+// Every branch holding a global variable of basic type (a single leaf,
+// e.g. "R.tr.x" with count "Ndata.R.tr.x") becomes a column of
+// Podd::OutputTreeEvent, converted to Double_t. Optionally, only branches
+// matching one of the wildcards given with AddBranchPattern() are read.
+// The event header (number, type and run number) is taken from the
+// event branch ("fEvtHdr.*") if present.
+//
+// The events are decoded with Podd::OutputTreeDecoder. The columns are
+// used as input by Podd::TreeSpectrometer and Podd::TreeBeam, which
+// restore the tracks and beam of the previous replay for the physics
+// modules, and they can be exported as global variables by
+// Podd::TreeVariables.
+//
+// The run number and date are those of the run object stored in the
+// input file ("Run_Data"), if any, else the date is the creation time of
+// the input file.
+//
+// Usage:
+//   gHaDecoder = Podd::OutputTreeDecoder::Class();
+//   gHaApps->Add( new Podd::TreeSpectrometer("R", "Right HRS (from tree)") );
+//   ...
+//   Podd::OutputTreeRun run("replay_1234.root");
+//   analyzer->Process(run);
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "OutputTreeRun.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TLeaf.h"
+#include "TLeafElement.h"
+#include "TBranch.h"
+#include "TObjArray.h"
+#include "TRegexp.h"
+#include "TError.h"
+#include "RVersion.h"
+#include <cstring>
+
+using namespace std;
+
+namespace Podd {
+
+// Leaves of the event header in the event branch
+static const char* const kHdrLeaf[3] =
+  { "fEvtHdr.fEvtNum", "fEvtHdr.fEvtType", "fEvtHdr.fRun" };
+
+//_____________________________________________________________________________
+OutputTreeRun::OutputTreeRun( const char* filename, const char* treename,
+                              const char* description )
+  : THaRunBase(description), fFileName(filename), fTreeName(treename),
+    fCacheSize(32*1024*1024), fFile(nullptr), fTree(nullptr), fNentries(0),
+    fEntry(0), fHdrLeaf{nullptr, nullptr, nullptr}
+{
+  // Constructor
+}
+
+//_____________________________________________________________________________
+OutputTreeRun::OutputTreeRun( const OutputTreeRun& rhs )
+  : THaRunBase(rhs), fFileName(rhs.fFileName), fTreeName(rhs.fTreeName),
+    fPatterns(rhs.fPatterns), fCacheSize(rhs.fCacheSize), fFile(nullptr),
+    fTree(nullptr), fNentries(0), fEntry(0), fHdrLeaf{nullptr, nullptr, nullptr}
+{
+  // Copy constructor. The copy is not open.
+}
+
+//_____________________________________________________________________________
+OutputTreeRun& OutputTreeRun::operator=( const THaRunBase& rhs )
+{
+  // Assignment operator. The input file stays open if it is the same.
+
+  if( this != &rhs ) {
+    THaRunBase::operator=(rhs);
+    if( rhs.InheritsFrom(OutputTreeRun::Class()) ) {
+      const auto& run = static_cast<const OutputTreeRun&>(rhs);
+      fFileName  = run.fFileName;
+      fTreeName  = run.fTreeName;
+      fPatterns  = run.fPatterns;
+      fCacheSize = run.fCacheSize;
+    }
+  }
+  return *this;
+}
+
+//_____________________________________________________________________________
+OutputTreeRun::~OutputTreeRun()
+{
+  // Destructor
+
+  if( IsOpen() )
+    Close();
+}
+
+//_____________________________________________________________________________
+void OutputTreeRun::AddBranchPattern( const char* pattern )
+{
+  // Read only branches matching 'pattern' (wildcards allowed, e.g. "R.tr.*")
+  // or any other pattern added. By default, all branches are read.
+
+  if( pattern && *pattern )
+    fPatterns.emplace_back(pattern);
+}
+
+//_____________________________________________________________________________
+Bool_t OutputTreeRun::IsSelected( const char* name ) const
+{
+  // True if the branch 'name' is to be read
+
+  if( fPatterns.empty() )
+    return true;
+  TString s(name);
+  for( const auto& pattern : fPatterns ) {
+    TRegexp re(pattern.c_str(), true);
+    Ssiz_t len = 0;
+    if( s.Index(re, &len) == 0 && len == s.Length() )
+      return true;
+  }
+  return false;
+}
+
+//_____________________________________________________________________________
+Int_t OutputTreeRun::Open()
+{
+  // Open the input file and set up the branches to be read. Columns for
+  // branches seen in earlier files are kept, at the same addresses.
+
+  const char* const here = "OutputTreeRun::Open";
+
+  if( IsOpen() )
+    return READ_OK;
+
+  fFile = TFile::Open(fFileName, "READ");
+  if( !fFile || fFile->IsZombie() ) {
+    Error( here, "Cannot open input file %s", fFileName.Data() );
+    Close();
+    return READ_FATAL;
+  }
+  fTree = dynamic_cast<TTree*>(fFile->Get(fTreeName));
+  if( !fTree ) {
+    Error( here, "Tree \"%s\" not found in input file %s",
+           fTreeName.Data(), fFileName.Data() );
+    Close();
+    return READ_FATAL;
+  }
+
+  fTree->SetBranchStatus("*", false);
+  for( auto& col : fEvent.columns )
+    col->leaf = nullptr;
+  Int_t ncol = 0;
+  TIter next(fTree->GetListOfLeaves());
+  while( auto* leaf = static_cast<TLeaf*>(next()) ) {
+    // Global variables are single-leaf branches of basic type.
+    // Skip the array counters.
+    TBranch* br = leaf->GetBranch();
+    if( leaf->InheritsFrom(TLeafElement::Class()) ||
+        br->GetListOfLeaves()->GetEntries() != 1 )
+      continue;
+    const char* name = br->GetName();
+    if( strncmp(name, "Ndata.", 6) == 0 || !IsSelected(name) )
+      continue;
+    Bool_t scalar = !leaf->GetLeafCount() && leaf->GetLenStatic() == 1;
+    auto it = fEvent.index.find(name);
+    OutputTreeEvent::Column_t* col = nullptr;
+    if( it == fEvent.index.end() ) {
+      fEvent.columns.emplace_back(new OutputTreeEvent::Column_t(name, scalar));
+      col = fEvent.columns.back().get();
+      fEvent.index.emplace(name, col);
+    } else {
+      col = it->second;
+      if( col->scalar != scalar ) {
+        Warning( here, "Branch %s changed between scalar and array. "
+                 "Ignored.", name );
+        continue;
+      }
+    }
+    col->leaf = leaf;
+    fTree->SetBranchStatus(name, true);
+    ++ncol;
+  }
+  for( Int_t k = 0; k < 3; ++k ) {
+    fHdrLeaf[k] = fTree->GetLeaf(kHdrLeaf[k]);
+    if( fHdrLeaf[k] )
+      fTree->SetBranchStatus(kHdrLeaf[k], true);
+  }
+  if( ncol == 0 ) {
+    Error( here, "No global variable branches to read in tree %s",
+           fTreeName.Data() );
+    Close();
+    return READ_FATAL;
+  }
+
+  // Read the enabled branches in bulk, one cluster of entries at a time
+  if( fCacheSize > 0 ) {
+    fTree->SetCacheSize(fCacheSize);
+    fTree->AddBranchToCache("*", true);
+    fTree->StopCacheLearningPhase();
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,10,0)
+    fTree->SetClusterPrefetch(true);
+#endif
+  }
+
+  fNentries = fTree->GetEntries();
+  fEntry = 0;
+  fOpened = true;
+  return READ_OK;
+}
+
+//_____________________________________________________________________________
+Int_t OutputTreeRun::Close()
+{
+  // Close the input file. The columns are kept for the next Open().
+
+  delete fFile;  // Deletes fTree
+  fFile = nullptr;
+  fTree = nullptr;
+  for( auto& col : fEvent.columns )
+    col->leaf = nullptr;
+  for( auto& leaf : fHdrLeaf )
+    leaf = nullptr;
+  fOpened = false;
+  return READ_OK;
+}
+
+//_____________________________________________________________________________
+Int_t OutputTreeRun::SetupColumns()
+{
+  // Find the columns of the input file without reading any events, so
+  // that modules can refer to them during initialization (see
+  // TreeVariables). Returns the number of columns, or a negative value
+  // on error.
+
+  if( !IsOpen() ) {
+    Int_t ret = Open();
+    if( ret )
+      return -1;
+    Close();
+  }
+  return static_cast<Int_t>(fEvent.columns.size());
+}
+
+//_____________________________________________________________________________
+Int_t OutputTreeRun::ReadEvent()
+{
+  // Read the next entry of the input tree
+
+  if( !IsOpen() ) {
+    Int_t ret = Open();
+    if( ret )
+      return ret;
+  }
+  if( fEntry >= fNentries )
+    return READ_EOF;
+
+  Int_t ret = fTree->GetEntry(fEntry++);
+  if( ret <= 0 )
+    return (ret == 0) ? READ_EOF : READ_ERROR;
+
+  fEvent.evnum  = fHdrLeaf[0] ? static_cast<UInt_t>(fHdrLeaf[0]->GetValue())
+                              : static_cast<UInt_t>(fEntry);
+  fEvent.evtype = fHdrLeaf[1] ? static_cast<UInt_t>(fHdrLeaf[1]->GetValue())
+                              : 1;
+  fEvent.run    = fHdrLeaf[2] ? static_cast<UInt_t>(fHdrLeaf[2]->GetValue())
+                              : fNumber;
+  for( auto& col : fEvent.columns ) {
+    TLeaf* leaf = col->leaf;
+    if( col->scalar ) {
+      col->val[0] = leaf ? leaf->GetValue() : kBig;
+      continue;
+    }
+    Int_t n = leaf ? leaf->GetLen() : 0;
+    col->val.resize(n);
+    for( Int_t i = 0; i < n; ++i )
+      col->val[i] = leaf->GetValue(i);
+  }
+  return READ_OK;
+}
+
+//_____________________________________________________________________________
+const UInt_t* OutputTreeRun::GetEvBuffer() const
+{
+  // Return the current event. This is not a CODA buffer. It can only be
+  // decoded by OutputTreeDecoder.
+
+  if( !IsOpen() )
+    return nullptr;
+  return reinterpret_cast<const UInt_t*>(&fEvent);
+}
+
+//_____________________________________________________________________________
+Int_t OutputTreeRun::ReadInitInfo()
+{
+  // Take run number and date from the run object of the previous replay,
+  // or else use the file creation time as the run date, unless set
+  // explicitly
+
+  if( !fFile )
+    return READ_OK;
+  auto* prev = dynamic_cast<THaRunBase*>(fFile->Get("Run_Data"));
+  if( prev ) {
+    if( !(fDataSet & kRunNumber) ) {
+      fNumber = prev->GetNumber();
+      fDataSet |= kRunNumber;
+    }
+    if( !fAssumeDate ) {
+      fDate = prev->GetDate();
+      fDataSet |= kDate;
+    }
+    delete prev;
+  } else if( !fAssumeDate ) {
+    fDate = fFile->GetCreationDate();
+    fDataSet |= kDate;
+  }
+  return READ_OK;
+}
+
+} // namespace Podd
+
+ClassImp(Podd::OutputTreeRun)
@@ -0,0 +1,106 @@
+#ifndef Podd_OutputTreeRun_h_
+#define Podd_OutputTreeRun_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::OutputTreeRun
+//
+// Run class for second-pass replays of the output tree of a previous
+// replay, to be analyzed with Podd::OutputTreeDecoder.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "THaRunBase.h"
+#include "TString.h"
+#include "DataType.h"   // for kBig
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+#include <utility>
+
+class TFile;
+class TTree;
+class TLeaf;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+// One event of an OutputTreeRun, as passed to OutputTreeDecoder via
+// GetEvBuffer()
+class OutputTreeEvent {
+public:
+  OutputTreeEvent() : evnum(0), evtype(1), run(0) {}
+
+  // Values of one branch (global variable) of the input tree
+  class Column_t {
+  public:
+    Column_t( std::string _name, Bool_t _scalar )
+      : name(std::move(_name)), leaf(nullptr), scalar(_scalar), val(1,kBig) {}
+    Double_t At( size_t i, Double_t def = kBig ) const {
+      return i < val.size() ? val[i] : def;
+    }
+    std::string           name;   // Branch name, e.g. "R.tr.x"
+    TLeaf*                leaf;   // Data leaf in current input tree
+    Bool_t                scalar; // Single value (else array)
+    std::vector<Double_t> val;    // Values in current event. Size is
+                                  // always 1 for scalars.
+  };
+
+  const Column_t* Find( const std::string& name ) const {
+    auto it = index.find(name);
+    return (it != index.end()) ? it->second : nullptr;
+  }
+
+  UInt_t  evnum;   // Event number
+  UInt_t  evtype;  // Event type
+  UInt_t  run;     // Run number
+  std::vector<std::unique_ptr<Column_t>> columns;  // All columns read
+  std::map<std::string,Column_t*>        index;    // Name -> column
+};
+
+//_____________________________________________________________________________
+class OutputTreeRun : public THaRunBase {
+public:
+  explicit OutputTreeRun( const char* filename = "", const char* treename = "T",
+                          const char* description = "" );
+  OutputTreeRun( const OutputTreeRun& run );
+  OutputTreeRun& operator=( const THaRunBase& rhs );
+  virtual ~OutputTreeRun();
+
+  virtual Int_t         Close();
+  virtual Int_t         Open();
+  virtual Int_t         ReadEvent();
+  virtual const UInt_t* GetEvBuffer() const;
+
+  void        AddBranchPattern( const char* pattern );
+  const OutputTreeEvent& GetEvent() const { return fEvent; }
+  const char* GetFileName() const { return fFileName.Data(); }
+  const char* GetTreeName() const { return fTreeName.Data(); }
+  Int_t       SetupColumns();
+  void        SetFileName( const char* name ) { fFileName = name; }
+  void        SetTreeName( const char* name ) { fTreeName = name; }
+  void        SetCacheSize( Long64_t bytes ) { fCacheSize = bytes; }
+
+protected:
+  virtual Int_t ReadInitInfo();
+
+  Bool_t        IsSelected( const char* name ) const;
+
+  TString       fFileName;  // Name of input file
+  TString       fTreeName;  // Name of input tree
+  std::vector<std::string> fPatterns; // Wildcards of branches to read
+  Long64_t      fCacheSize; // Size of read-ahead cache (bytes)
+  TFile*        fFile;      //! Input ROOT file
+  TTree*        fTree;      //! Input tree
+  Long64_t      fNentries;  //! Number of entries in tree
+  Long64_t      fEntry;     //! Next entry to read
+  TLeaf*        fHdrLeaf[3];//! Event header leaves (evnum, evtype, run)
+  OutputTreeEvent fEvent;   //! Current event
+
+  ClassDef(OutputTreeRun,1)  // Run class for replays of analysis output trees
+};
+
+} // namespace Podd
+
+#endif
@@ -84,6 +84,7 @@
 #pragma link C++ class THaTrackInfo+;
 #pragma link C++ class THaDebugModule+;
 #pragma link C++ class THaGoldenTrack+;
+#pragma link C++ class THaTrackCompare+;
 #pragma link C++ class THaPrimaryKine+;
 #pragma link C++ class THaSecondaryKine+;
 #pragma link C++ class THaCoincTime+;
@@ -99,6 +100,7 @@
 #pragma link C++ class THaTriggerTime+;
 #pragma link C++ class THaTrackOut+;
 #pragma link C++ class THaHelicityDet+;
+#pragma link C++ class THaHelicityAsym+;
 #pragma link C++ class THaPhotoReaction+;
 #pragma link C++ class THaSAProtonEP+;
 #pragma link C++ class THaEvtTypeHandler+;
@@ -109,12 +111,22 @@
 #pragma link C++ class Podd::MCTrack+;
 #pragma link C++ class Podd::MCTrackPoint+;
 #pragma link C++ class Podd::SimDecoder+;
+#pragma link C++ class Podd::SimTreeDecoder+;
+#pragma link C++ class Podd::SimTreeRun+;
+#pragma link C++ class Podd::HitCacheWriter+;
+#pragma link C++ class Podd::OutputTreeRun+;
+#pragma link C++ class Podd::OutputTreeDecoder+;
+#pragma link C++ class Podd::TreeSpectrometer+;
+#pragma link C++ class Podd::TreeBeam+;
+#pragma link C++ class Podd::TreeVariables+;
 #pragma link C++ class Podd::CodaRawDecoder+;
 #pragma link C++ class Podd::InterStageModule+;
 #pragma link C++ class Podd::TimeCorrectionModule+;
 #pragma link C++ class Podd::DetectorData+;
 #pragma link C++ class Podd::ADCData+;
 #pragma link C++ class Podd::PMTData+;
+#pragma link C++ class Podd::AnalysisContext+;
+#pragma link C++ class Podd::ReplayConfig+;
 
 #ifdef ONLINE_ET
 #pragma link C++ class THaOnlRun+;
@@ -0,0 +1,464 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::ReplayConfig
+//
+// Replay setup from a declarative configuration file. Each line of the
+// file creates one analysis object:
+//
+//   <kind>  <class>  <name>  ["<title>"]  [<more constructor arguments>]
+//
+// where <kind> is one of
+//
+//   apparatus   added to gHaApps
+//   detector    added to the apparatus given by the name prefix, i.e.
+//               "R.cer" is detector "cer" of apparatus "R"
+//   physics     added to gHaPhysics
+//   handler     added to gHaEvtHandlers
+//   decoder     sets gHaDecoder (takes only the class name)
+//
+// The objects are constructed as new <class>("<name>","<title>",<more>),
+// where <more> is copied verbatim, so it may contain any C++ constants,
+// e.g.
+//
+//   apparatus  THaHRS           R       "Right arm HRS"
+//   detector   THaCherenkov     R.cer   "Gas Cherenkov counter"
+//   physics    THaElectronKine  EK_R    "Electron kinematics"  "R", 0.938
+//
+// '#' starts a comment. Objects are created in file order, so an
+// apparatus must precede its detectors and physics modules must follow
+// the modules they depend on, as in a setup macro.
+//
+// All classes are looked up in the ROOT class registry when the file is
+// loaded, so that typos and classes of the wrong kind are found before
+// anything is created. Instantiate() creates the objects right away.
+// InstantiateCompiled() generates the equivalent C++ setup function,
+// compiles it with ACLiC and calls it. The generated source is rewritten
+// only when the configuration changes, so repeated replays with the same
+// setup reuse the compiled library.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "ReplayConfig.h"
+#include "THaGlobals.h"
+#include "THaApparatus.h"
+#include "THaDetector.h"
+#include "TClass.h"
+#include "TList.h"
+#include "TError.h"
+#include "TSystem.h"
+#include "TInterpreter.h"
+#include <fstream>
+#include <sstream>
+#include <set>
+#include <cctype>
+#include <cstring>
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+// Keywords of the configuration file and the corresponding base classes
+struct KindDef_t {
+  const char*          key;
+  ReplayConfig::EKind  kind;
+  const char*          base;
+  const char*          list;
+};
+static const KindDef_t kKinds[] = {
+  { "apparatus", ReplayConfig::kApparatus, "THaApparatus",      "gHaApps" },
+  { "detector",  ReplayConfig::kDetector,  "THaDetector",       nullptr },
+  { "physics",   ReplayConfig::kPhysics,   "THaPhysicsModule",  "gHaPhysics" },
+  { "handler",   ReplayConfig::kHandler,   "THaEvtTypeHandler", "gHaEvtHandlers" },
+  { "decoder",   ReplayConfig::kDecoder,   "THaEvData",         nullptr },
+};
+
+//_____________________________________________________________________________
+static string Quote( const string& s )
+{
+  // Return 's' as a C++ string literal
+
+  string q = "\"";
+  for( char c : s ) {
+    if( c == '"' || c == '\\' )
+      q += '\\';
+    q += c;
+  }
+  return q + '"';
+}
+
+//_____________________________________________________________________________
+static string CtorArgs( const ReplayConfig::Entry_t& e )
+{
+  // Constructor argument list for entry 'e'
+
+  string name = e.name;
+  if( e.kind == ReplayConfig::kDetector )
+    name.erase(0, name.find('.') + 1);
+  string args = Quote(name) + "," + Quote(e.title);
+  if( !e.args.empty() )
+    args += "," + e.args;
+  return args;
+}
+
+//_____________________________________________________________________________
+ReplayConfig::ReplayConfig( const char* filename )
+  : fValid(false)
+{
+  // Constructor. Loads 'filename', if given.
+
+  if( filename && *filename )
+    Load(filename);
+}
+
+//_____________________________________________________________________________
+Int_t ReplayConfig::Load( const char* filename )
+{
+  // Read the configuration file 'filename'. Returns 0 on success, -1 if
+  // the file cannot be read or contains errors.
+
+  const char* const here = "ReplayConfig::Load";
+
+  fFileName = filename;
+  fEntries.clear();
+  fValid = false;
+  ifstream ifs(filename);
+  if( !ifs ) {
+    ::Error( here, "Cannot open configuration file %s", filename );
+    return -1;
+  }
+  Int_t nerr = 0, lineno = 0;
+  string line;
+  while( getline(ifs, line) ) {
+    if( ParseLine(line, ++lineno) != 0 )
+      ++nerr;
+  }
+  if( nerr > 0 ) {
+    ::Error( here, "%d error(s) in configuration file %s", nerr, filename );
+    fEntries.clear();
+    return -1;
+  }
+  fValid = true;
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t ReplayConfig::ParseLine( const string& line, Int_t lineno )
+{
+  // Parse one line of the configuration file and append the resulting
+  // entry. Returns 0 if the line is valid (or empty), -1 otherwise.
+
+  const char* const here = "ReplayConfig::Load";
+
+  // Strip comments outside of quotes
+  string s;
+  bool inquote = false;
+  for( char c : line ) {
+    if( c == '"' )
+      inquote = !inquote;
+    else if( c == '#' && !inquote )
+      break;
+    s += c;
+  }
+  istringstream is(s);
+  string key;
+  if( !(is >> key) )
+    return 0;
+
+  const KindDef_t* def = nullptr;
+  for( const auto& k : kKinds ) {
+    if( key == k.key ) {
+      def = &k;
+      break;
+    }
+  }
+  if( !def ) {
+    ::Error( here, "%s, line %d: unknown keyword \"%s\"",
+             fFileName.Data(), lineno, key.c_str() );
+    return -1;
+  }
+  Entry_t e;
+  e.kind = def->kind;
+  e.line = lineno;
+  if( !(is >> e.classname) ) {
+    ::Error( here, "%s, line %d: missing class name",
+             fFileName.Data(), lineno );
+    return -1;
+  }
+  TClass* cl = TClass::GetClass(e.classname.c_str());
+  if( !cl ) {
+    ::Error( here, "%s, line %d: unknown class %s",
+             fFileName.Data(), lineno, e.classname.c_str() );
+    return -1;
+  }
+  if( !cl->InheritsFrom(def->base) ) {
+    ::Error( here, "%s, line %d: class %s is not a %s",
+             fFileName.Data(), lineno, e.classname.c_str(), def->base );
+    return -1;
+  }
+  if( e.kind != kDecoder ) {
+    if( !(is >> e.name) ) {
+      ::Error( here, "%s, line %d: missing object name",
+               fFileName.Data(), lineno );
+      return -1;
+    }
+    if( e.kind == kDetector ) {
+      auto pos = e.name.find('.');
+      if( pos == 0 || pos == string::npos || pos+1 == e.name.length() ) {
+        ::Error( here, "%s, line %d: detector name must be of the form "
+                       "<apparatus>.<detector>", fFileName.Data(), lineno );
+        return -1;
+      }
+    }
+    // Optional quoted title, then the remaining constructor arguments
+    string rest;
+    getline(is, rest);
+    auto pos = rest.find_first_not_of(" \t");
+    if( pos != string::npos && rest[pos] == '"' ) {
+      auto end = rest.find('"', pos+1);
+      if( end == string::npos ) {
+        ::Error( here, "%s, line %d: unterminated title",
+                 fFileName.Data(), lineno );
+        return -1;
+      }
+      e.title = rest.substr(pos+1, end-pos-1);
+      pos = rest.find_first_not_of(" \t", end+1);
+    }
+    if( pos != string::npos ) {
+      if( rest[pos] == ',' )
+        ++pos;
+      e.args = rest.substr(pos);
+      while( !e.args.empty() && isspace(e.args.back()) )
+        e.args.pop_back();
+    }
+  } else {
+    string extra;
+    if( is >> extra ) {
+      ::Error( here, "%s, line %d: decoder takes only a class name",
+               fFileName.Data(), lineno );
+      return -1;
+    }
+  }
+  fEntries.push_back(e);
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t ReplayConfig::Instantiate() const
+{
+  // Create the configured objects and add them to the global lists.
+  // The constructor calls are evaluated one by one by the interpreter.
+  // Returns 0 on success, otherwise the line number of the first object
+  // that could not be created.
+
+  const char* const here = "ReplayConfig::Instantiate";
+
+  if( !fValid ) {
+    ::Error( here, "No valid configuration loaded" );
+    return -1;
+  }
+  for( const auto& e : fEntries ) {
+    TClass* cl = TClass::GetClass(e.classname.c_str());
+    if( e.kind == kDecoder ) {
+      gHaDecoder = cl;
+      continue;
+    }
+    string expr = "(long)new " + e.classname + "(" + CtorArgs(e) + ")";
+    TInterpreter::EErrorCode err = TInterpreter::kNoError;
+    Long_t p = gInterpreter->Calc(expr.c_str(), &err);
+    if( err != TInterpreter::kNoError || p == 0 ) {
+      ::Error( here, "%s, line %d: cannot create %s %s",
+               fFileName.Data(), e.line, e.classname.c_str(), e.name.c_str() );
+      return e.line;
+    }
+    auto* obj = static_cast<TObject*>(
+      cl->DynamicCast(TObject::Class(), reinterpret_cast<void*>(p)) );
+    TList* list = nullptr;
+    switch( e.kind ) {
+    case kApparatus:
+      list = gHaApps;
+      break;
+    case kPhysics:
+      list = gHaPhysics;
+      break;
+    case kHandler:
+      list = gHaEvtHandlers;
+      break;
+    case kDetector: {
+      string appname = e.name.substr(0, e.name.find('.'));
+      auto* app = dynamic_cast<THaApparatus*>(
+        gHaApps->FindObject(appname.c_str()) );
+      if( !app ) {
+        ::Error( here, "%s, line %d: no apparatus \"%s\" for detector %s",
+                 fFileName.Data(), e.line, appname.c_str(), e.name.c_str() );
+        delete obj;
+        return e.line;
+      }
+      if( app->AddDetector(static_cast<THaDetector*>(obj)) != 0 )
+        return e.line;
+      break;
+    }
+    case kDecoder:
+      break;
+    }
+    if( list ) {
+      if( list->FindObject(obj->GetName()) ) {
+        ::Error( here, "%s, line %d: duplicate name %s",
+                 fFileName.Data(), e.line, obj->GetName() );
+        delete obj;
+        return e.line;
+      }
+      list->Add(obj);
+    }
+  }
+  return 0;
+}
+
+//_____________________________________________________________________________
+string ReplayConfig::GetFunctionName() const
+{
+  // Name of the generated setup function (and of its source file)
+
+  string base = gSystem->BaseName(fFileName.Data());
+  base = base.substr(0, base.find('.'));
+  for( auto& c : base ) {
+    if( !isalnum(c) )
+      c = '_';
+  }
+  return "podd_config_" + base;
+}
+
+//_____________________________________________________________________________
+string ReplayConfig::GetSource() const
+{
+  // Return C++ source of a function that creates the configured objects,
+  // equivalent to Instantiate(). The function returns 0 on success,
+  // otherwise the configuration line number of the failed object.
+
+  ostringstream os;
+  os << "// Generated by Podd::ReplayConfig from " << fFileName
+     << ". Do not edit." << endl
+     << "#include \"THaGlobals.h\"" << endl
+     << "#include \"THaApparatus.h\"" << endl
+     << "#include \"TList.h\"" << endl;
+  set<string> headers;
+  for( const auto& e : fEntries ) {
+    TClass* cl = TClass::GetClass(e.classname.c_str());
+    const char* decl = cl ? cl->GetDeclFileName() : nullptr;
+    if( decl && *decl && headers.insert(gSystem->BaseName(decl)).second )
+      os << "#include \"" << gSystem->BaseName(decl) << "\"" << endl;
+  }
+  os << endl
+     << "extern \"C\" Int_t " << GetFunctionName() << "()" << endl
+     << "{" << endl
+     << "  THaApparatus* app = nullptr;" << endl;
+  for( const auto& e : fEntries ) {
+    string obj = "new " + e.classname + "(" + CtorArgs(e) + ")";
+    switch( e.kind ) {
+    case kDetector:
+      os << "  app = dynamic_cast<THaApparatus*>(gHaApps->FindObject("
+         << Quote(e.name.substr(0, e.name.find('.'))) << "));" << endl
+         << "  if( !app || app->AddDetector( " << obj << " ) != 0 )" << endl
+         << "    return " << e.line << ";" << endl;
+      break;
+    case kDecoder:
+      os << "  gHaDecoder = " << e.classname << "::Class();" << endl;
+      break;
+    default:
+      for( const auto& k : kKinds ) {
+        if( k.kind == e.kind ) {
+          os << "  if( " << k.list << "->FindObject(" << Quote(e.name)
+             << ") )" << endl
+             << "    return " << e.line << ";" << endl
+             << "  " << k.list << "->Add( " << obj << " );" << endl;
+          break;
+        }
+      }
+      break;
+    }
+  }
+  os << "  return 0;" << endl
+     << "}" << endl;
+  return os.str();
+}
+
+//_____________________________________________________________________________
+Int_t ReplayConfig::WriteSource( const char* filename ) const
+{
+  // Write the generated setup function to 'filename', unless the file
+  // already has the same contents. Leaving an unchanged file alone keeps
+  // its timestamp, so ACLiC does not recompile it.
+  // Returns 0 on success, -1 on error.
+
+  string src = GetSource();
+  {
+    ifstream ifs(filename);
+    if( ifs ) {
+      ostringstream old;
+      old << ifs.rdbuf();
+      if( old.str() == src )
+        return 0;
+    }
+  }
+  ofstream ofs(filename);
+  if( !(ofs << src) ) {
+    ::Error( "ReplayConfig::WriteSource", "Cannot write %s", filename );
+    return -1;
+  }
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t ReplayConfig::InstantiateCompiled( const char* cachedir ) const
+{
+  // Create the configured objects by a compiled setup function. The
+  // function source and library are kept in 'cachedir' (default: the
+  // directory of the configuration file) and rebuilt only when the
+  // configuration changes. Returns 0 on success, otherwise the line number
+  // of the first object that could not be created, or -1 if compilation
+  // failed.
+
+  const char* const here = "ReplayConfig::InstantiateCompiled";
+
+  if( !fValid ) {
+    ::Error( here, "No valid configuration loaded" );
+    return -1;
+  }
+  TString dir = (cachedir && *cachedir) ? cachedir
+                                        : gSystem->DirName(fFileName.Data());
+  string func = GetFunctionName();
+  TString src = dir + "/" + func.c_str() + ".C";
+  if( WriteSource(src) != 0 )
+    return -1;
+  if( !gSystem->CompileMacro(src, "kO") ) {
+    ::Error( here, "Cannot compile generated setup %s", src.Data() );
+    return -1;
+  }
+  using Setup_t = Int_t (*)();
+  auto setup = reinterpret_cast<Setup_t>(
+    gSystem->DynFindSymbol("*", func.c_str()) );
+  if( !setup ) {
+    ::Error( here, "Setup function %s not found", func.c_str() );
+    return -1;
+  }
+  Int_t ret = setup();
+  if( ret != 0 )
+    ::Error( here, "%s, line %d: cannot create object",
+             fFileName.Data(), ret );
+  return ret;
+}
+
+//_____________________________________________________________________________
+Bool_t ReplayConfig::IsConfigFile( const char* filename )
+{
+  // True if 'filename' looks like a replay configuration file (*.cfg)
+  // rather than a setup macro
+
+  size_t len = filename ? strlen(filename) : 0;
+  return len > 4 && strcmp(filename + len - 4, ".cfg") == 0;
+}
+
+} // namespace Podd
+
+//_____________________________________________________________________________
+ClassImp(Podd::ReplayConfig)
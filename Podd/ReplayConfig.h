@@ -0,0 +1,66 @@
+#ifndef Podd_ReplayConfig_h_
+#define Podd_ReplayConfig_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::ReplayConfig
+//
+// Declarative replay setup: creates the apparatuses, detectors, physics
+// modules and event handlers listed in a configuration file, instead of
+// an interpreted setup macro.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include "TString.h"
+#include <string>
+#include <vector>
+
+namespace Podd {
+
+class ReplayConfig {
+
+public:
+  enum EKind { kApparatus, kDetector, kPhysics, kHandler, kDecoder };
+
+  // One object to create
+  class Entry_t {
+  public:
+    Entry_t() : kind(kApparatus), line(0) {}
+    EKind       kind;
+    std::string classname;
+    std::string name;      // Full name, "<apparatus>.<name>" for detectors
+    std::string title;
+    std::string args;      // Additional constructor arguments, as C++ code
+    Int_t       line;      // Line number in the configuration file
+  };
+
+  explicit ReplayConfig( const char* filename = nullptr );
+  virtual ~ReplayConfig() = default;
+
+  Int_t          Load( const char* filename );
+  Int_t          Instantiate() const;
+  Int_t          InstantiateCompiled( const char* cachedir = nullptr ) const;
+
+  const std::vector<Entry_t>& GetEntries() const { return fEntries; }
+  const char*    GetFileName() const { return fFileName.Data(); }
+  std::string    GetFunctionName() const;
+  std::string    GetSource() const;
+  Bool_t         IsValid() const { return fValid; }
+  Int_t          WriteSource( const char* filename ) const;
+
+  static Bool_t  IsConfigFile( const char* filename );
+
+protected:
+  TString               fFileName;  // Configuration file
+  std::vector<Entry_t>  fEntries;   // Objects to create, in file order
+  Bool_t                fValid;     // Configuration loaded without errors
+
+  Int_t          ParseLine( const std::string& line, Int_t lineno );
+
+  ClassDef(ReplayConfig,0) // Replay setup from a configuration file
+};
+
+} // namespace Podd
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef Podd_RunningAverage_h_
+#define Podd_RunningAverage_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::RunningAverage
+//
+// Average of a 3-vector over the last N events, updated in constant time
+// per event. Used by the beam apparatuses to smooth beam positions and
+// directions. Until N values have been added, the average is taken over
+// the values seen so far.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include "TVector3.h"
+#include <array>
+#include <vector>
+
+namespace Podd {
+
+class RunningAverage {
+
+public:
+  typedef std::array<Double_t,3> Vec_t;
+
+  explicit RunningAverage( UInt_t depth = 0 ) { SetDepth(depth); }
+
+  void    Add( const TVector3& v ) { Add( Vec_t{{ v.X(), v.Y(), v.Z() }} ); }
+  void    Add( const Vec_t& v );
+  void    Clear();
+  void    Get( TVector3& avg ) const;
+  UInt_t  GetCount() const { return fCount; }
+  UInt_t  GetDepth() const { return fBuf.size(); }
+  void    SetDepth( UInt_t depth ) { fBuf.assign(depth, Vec_t{}); Clear(); }
+
+private:
+  std::vector<Vec_t> fBuf;    // Last N values (ring buffer)
+  Vec_t              fSum;    // Sum of the values in fBuf
+  UInt_t             fNext;   // Index of the slot to fill next
+  UInt_t             fCount;  // Number of valid values in fBuf
+};
+
+//_____________________________________________________________________________
+inline void RunningAverage::Clear()
+{
+  fSum.fill(0);
+  fNext = fCount = 0;
+}
+
+//_____________________________________________________________________________
+inline void RunningAverage::Add( const Vec_t& v )
+{
+  if( fBuf.empty() )
+    return;
+  Vec_t& old = fBuf[fNext];
+  if( fCount == fBuf.size() ) {
+    for( int k = 0; k < 3; ++k )
+      fSum[k] -= old[k];
+  } else
+    ++fCount;
+  old = v;
+  for( int k = 0; k < 3; ++k )
+    fSum[k] += v[k];
+  if( ++fNext == fBuf.size() ) {
+    fNext = 0;
+    // Recompute the sum once per cycle so that rounding errors from the
+    // running updates do not accumulate
+    fSum.fill(0);
+    for( const auto& b : fBuf )
+      for( int k = 0; k < 3; ++k )
+        fSum[k] += b[k];
+  }
+}
+
+//_____________________________________________________________________________
+inline void RunningAverage::Get( TVector3& avg ) const
+{
+  if( fCount == 0 )
+    return;
+  Double_t f = 1.0/fCount;
+  avg.SetXYZ( f*fSum[0], f*fSum[1], f*fSum[2] );
+}
+
+} // namespace Podd
+
+#endif
@@ -9,21 +9,28 @@ libname = 'Podd'
 
 # Sources and headers
 src = """
-BankData.cxx                 BdataLoc.cxx                 CodaRawDecoder.cxx
-DecData.cxx                  DetectorData.cxx             FileInclude.cxx
-FixedArrayVar.cxx            InterStageModule.cxx         MethodVar.cxx
+Accumulator.cxx              AnalysisContext.cxx          BankData.cxx
+BatchInterface.cxx           BdataLoc.cxx                 CodaRawDecoder.cxx
+CodaWriter.cxx               CounterShards.cxx            DecData.cxx
+DefFileCache.cxx             DetectorData.cxx             EventQueue.cxx
+EvtHandlerThread.cxx         FileInclude.cxx              FixedArrayVar.cxx
+FormulaProgram.cxx           HistoServer.cxx              HitCacheWriter.cxx
+InterStageModule.cxx         MethodAccessor.cxx           MethodVar.cxx
+NTupleOutput.cxx             NameIndex.cxx                OutputMerger.cxx
+OutputTreeDecoder.cxx        OutputTreeRun.cxx            ReplayConfig.cxx
 SeqCollectionMethodVar.cxx   SeqCollectionVar.cxx         SimDecoder.cxx
-THaAnalysisObject.cxx        THaAnalyzer.cxx              THaApparatus.cxx
-THaArrayString.cxx           THaAvgVertex.cxx             THaBPM.cxx
-THaBeam.cxx                  THaBeamDet.cxx               THaBeamEloss.cxx
-THaBeamInfo.cxx              THaBeamModule.cxx            THaCherenkov.cxx
-THaCluster.cxx               THaCodaRun.cxx               THaCoincTime.cxx
-THaCut.cxx                   THaCutList.cxx               THaDebugModule.cxx
-THaDetMap.cxx                THaDetector.cxx              THaDetectorBase.cxx
-THaElectronKine.cxx          THaElossCorrection.cxx       THaEpicsEbeam.cxx
-THaEpicsEvtHandler.cxx       THaEvent.cxx                 THaEvt125Handler.cxx
-THaEvtTypeHandler.cxx        THaExtTarCor.cxx             THaFilter.cxx
-THaFormula.cxx               THaGoldenTrack.cxx           THaHelicityDet.cxx
+SimTreeDecoder.cxx           SimTreeRun.cxx               THaAnalysisObject.cxx
+THaAnalyzer.cxx              THaApparatus.cxx             THaArrayString.cxx
+THaAvgVertex.cxx             THaBPM.cxx                   THaBeam.cxx
+THaBeamDet.cxx               THaBeamEloss.cxx             THaBeamInfo.cxx
+THaBeamModule.cxx            THaCherenkov.cxx             THaCluster.cxx
+THaCodaRun.cxx               THaCoincTime.cxx             THaCut.cxx
+THaCutList.cxx               THaDebugModule.cxx           THaDetMap.cxx
+THaDetector.cxx              THaDetectorBase.cxx          THaElectronKine.cxx
+THaElossCorrection.cxx       THaEpicsEbeam.cxx            THaEpicsEvtHandler.cxx
+THaEvent.cxx                 THaEvt125Handler.cxx         THaEvtTypeHandler.cxx
+THaExtTarCor.cxx             THaFilter.cxx                THaFormula.cxx
+THaGoldenTrack.cxx           THaHelicityAsym.cxx          THaHelicityDet.cxx
 THaIdealBeam.cxx             THaInterface.cxx             THaNamedList.cxx
 THaNonTrackingDetector.cxx   THaOutput.cxx                THaPIDinfo.cxx
 THaParticleInfo.cxx          THaPhotoReaction.cxx         THaPhysicsModule.cxx
@@ -34,12 +41,14 @@ THaRun.cxx                   THaRunBase.cxx               THaRunParameters.cxx
 THaSAProtonEP.cxx            THaScalerEvtHandler.cxx      THaScintillator.cxx
 THaSecondaryKine.cxx         THaShower.cxx                THaSpectrometer.cxx
 THaSpectrometerDetector.cxx  THaString.cxx                THaSubDetector.cxx
-THaTotalShower.cxx           THaTrack.cxx                 THaTrackEloss.cxx
-THaTrackID.cxx               THaTrackInfo.cxx             THaTrackOut.cxx
-THaTrackProj.cxx             THaTrackingDetector.cxx      THaTrackingModule.cxx
-THaTriggerTime.cxx           THaTwoarmVertex.cxx          THaUnRasteredBeam.cxx
-THaVar.cxx                   THaVarList.cxx               THaVertexModule.cxx
-THaVform.cxx                 THaVhist.cxx                 TimeCorrectionModule.cxx
+THaTotalShower.cxx           THaTrack.cxx                 THaTrackCompare.cxx
+THaTrackEloss.cxx            THaTrackID.cxx               THaTrackInfo.cxx
+THaTrackOut.cxx              THaTrackProj.cxx             THaTrackingDetector.cxx
+THaTrackingModule.cxx        THaTriggerTime.cxx           THaTwoarmVertex.cxx
+THaUnRasteredBeam.cxx        THaVar.cxx                   THaVarList.cxx
+THaVertexModule.cxx          THaVform.cxx                 THaVhist.cxx
+TaskPool.cxx                 ThreadAffinity.cxx           TimeCorrectionModule.cxx
+TreeBeam.cxx                 TreeSpectrometer.cxx         TreeVariables.cxx
 Variable.cxx                 VariableArrayVar.cxx         VectorObjMethodVar.cxx
 VectorObjVar.cxx             VectorVar.cxx
 """
@@ -48,7 +57,9 @@ VectorObjVar.cxx             VectorVar.cxx
 compiledata = 'ha_compiledata.h'
 write_compiledata(baseenv,compiledata)
 
-extrahdrs = ['Helper.h','DataType.h','OptionalType.h','optional.hpp',compiledata]
+extrahdrs = ['Helper.h','DataType.h','OptionalType.h','VarView.h','RunningAverage.h',
+             'FourVector.h',
+             'optional.hpp',compiledata]
 
 poddlib = build_library(baseenv, libname, src, extrahdrs,
                         extradicthdrs = ['THaGlobals.h'], useenv = False,
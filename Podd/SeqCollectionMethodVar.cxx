@@ -17,8 +17,8 @@ namespace Podd {
 
 //_____________________________________________________________________________
 SeqCollectionMethodVar::SeqCollectionMethodVar( THaVar* pvar, const void* addr,
-	VarType type, TMethodCall* method )
-  : Variable(pvar,addr,type), MethodVar(pvar,addr,type,method),
+	VarType type, TMethodCall* method, const MethodAccessor* acc )
+  : Variable(pvar,addr,type), MethodVar(pvar,addr,type,method,acc),
     SeqCollectionVar(pvar,addr,type,0)
 {
   // Constructor
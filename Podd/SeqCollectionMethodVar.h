@@ -19,7 +19,8 @@ namespace Podd {
 
   public:
     SeqCollectionMethodVar( THaVar* pvar, const void* addr, VarType type,
-			    TMethodCall* method );
+			    TMethodCall* method,
+			    const MethodAccessor* acc = nullptr );
 
     virtual const void*  GetDataPointer( Int_t i = 0 ) const;
     virtual Bool_t       IsBasic() const;
@@ -50,6 +50,14 @@ Int_t SeqCollectionVar::GetLen() const
 {
   // Get number of elements of the variable
 
+  return CachedLen();
+}
+
+//_____________________________________________________________________________
+Int_t SeqCollectionVar::ComputeLen() const
+{
+  // Get current number of objects in the collection
+
   assert( fValueP );
 
   const auto *const obj = static_cast<const TObject*>( fValueP );
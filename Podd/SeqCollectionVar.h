@@ -33,6 +33,8 @@ namespace Podd {
   protected:
     Int_t                fOffset;   //Offset of data w.r.t. object pointer
     mutable Int_t        fDim;      //Current array dimension
+
+    virtual Int_t        ComputeLen() const;
   };
 
 }// namespace Podd
@@ -93,6 +93,33 @@ void SimDecoder::Clear( Option_t* opt )
   if( fMCTracks )
     fMCTracks->Clear(opt);
   fMCPoints->Clear();
+  for( auto& hits : fDirectHits )
+    hits.clear();
+}
+
+//_____________________________________________________________________________
+UInt_t SimDecoder::AddDirectDetector( const char* prefix )
+{
+  // Register the detector with the given prefix for direct hit injection
+  // and return its index for AddDirectHit(). Once registered, the detector
+  // gets its data only via AddDirectHit, not from the crate/slot data.
+
+  auto ins = fDirectIndex.emplace(prefix, fDirectHits.size());
+  if( ins.second )
+    fDirectHits.emplace_back();
+  return ins.first->second;
+}
+
+//_____________________________________________________________________________
+const SimDecoder::DirectHits_t*
+SimDecoder::GetDirectHits( const char* prefix ) const
+{
+  // Return the hits injected into the detector with the given prefix
+  // in the current event, or nullptr if the detector is not registered
+  // for direct injection.
+
+  auto it = fDirectIndex.find(prefix);
+  return (it != fDirectIndex.end()) ? &fDirectHits[it->second] : nullptr;
 }
 
 //_____________________________________________________________________________
@@ -16,6 +16,10 @@
 #include "DataType.h"  // for kBig
 #include "TClonesArray.h"
 #include "TVector3.h"
+#include "Decoder.h"   // for ChannelType
+#include <vector>
+#include <map>
+#include <string>
 
 namespace Podd {
 
@@ -173,6 +177,28 @@ class SimDecoder : public THaEvData {
 
   Double_t GetWeight() const { return fWeight; }
 
+  // Direct injection of digitized hits into detectors, bypassing the
+  // crate/slot data (see THaDetectorBase::Decode). Detectors are
+  // identified by their prefix, e.g. "R.s1.", and channels by their
+  // logical channel number in the detector map, starting at 0.
+  class DirectHit_t {
+  public:
+    DirectHit_t( Int_t _lchan, Decoder::ChannelType _type, UInt_t _data )
+      : lchan(_lchan), type(_type), data(_data) {}
+    Int_t                lchan;  // Logical channel
+    Decoder::ChannelType type;   // kADC, kCommonStopTDC or kCommonStartTDC
+    UInt_t               data;   // Raw ADC or TDC value
+  };
+  typedef std::vector<DirectHit_t> DirectHits_t;
+
+  UInt_t   AddDirectDetector( const char* prefix );
+  void     AddDirectHit( UInt_t idet, Int_t lchan, Decoder::ChannelType type,
+                         UInt_t data ) {
+    fDirectHits[idet].emplace_back(lchan, type, data);
+  }
+  const DirectHits_t* GetDirectHits( const char* prefix ) const;
+  Bool_t   IsDirectMode() const { return !fDirectHits.empty(); }
+
   TObject* GetMCHit( Int_t i )   const {
     return (fMCHits) ? fMCHits->UncheckedAt(i) : nullptr;
   }
@@ -202,6 +228,9 @@ protected:
   TClonesArray*  fMCPoints;   //-> MC physics track points
   Bool_t         fIsSetup;    // DefineVariables has run
 
+  std::vector<DirectHits_t>     fDirectHits;  //! Injected hits per detector
+  std::map<std::string,UInt_t>  fDirectIndex; //! Detector prefix -> index
+
   ClassDef(SimDecoder,0) // Generic decoder for simulation data
 };
 
@@ -0,0 +1,63 @@
+/////////////////////////////////////////////////////////////////////
+//
+//   Podd::SimTreeDecoder
+//
+//   Decoder for events read by Podd::SimTreeRun. The hits of each
+//   detector are not placed into crate/slot structures. Instead, they
+//   are injected directly into the detector (see
+//   SimDecoder::AddDirectHit), whose Decode() method passes them to
+//   its DetectorData objects (ADCData, PMTData). Detectors whose
+//   decoding depends on frontend module data, e.g. FADC pulse data,
+//   are not supported.
+//
+//   Usage:
+//     gHaDecoder = Podd::SimTreeDecoder::Class();
+//     Podd::SimTreeRun run("digitized.root");
+//     analyzer->Process(run);
+//
+/////////////////////////////////////////////////////////////////////
+
+#include "SimTreeDecoder.h"
+#include "SimTreeRun.h"
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+SimTreeDecoder::SimTreeDecoder()
+{
+  // Constructor
+}
+
+//_____________________________________________________________________________
+Int_t SimTreeDecoder::LoadEvent( const UInt_t* evbuffer )
+{
+  // Inject the hits of the SimTreeEvent in 'evbuffer' into the detectors
+
+  Clear();
+  if( !evbuffer )
+    return HED_ERR;
+
+  buffer = evbuffer;
+  const auto* event = reinterpret_cast<const SimTreeEvent*>(evbuffer);
+
+  event_num = event->evnum;
+  event_type = 1;
+  fWeight = event->weight;
+  UInt_t nhits = 0;
+  for( const auto& col : event->columns ) {
+    UInt_t idet = AddDirectDetector(col.prefix.c_str());
+    size_t n = min(col.chan->size(), col.data->size());
+    for( size_t k = 0; k < n; ++k )
+      AddDirectHit(idet, static_cast<Int_t>((*col.chan)[k]), col.type,
+                   (*col.data)[k]);
+    nhits += n;
+  }
+  event_length = nhits;
+  return HED_OK;
+}
+
+} // namespace Podd
+
+ClassImp(Podd::SimTreeDecoder)
@@ -0,0 +1,29 @@
+#ifndef Podd_SimTreeDecoder_h_
+#define Podd_SimTreeDecoder_h_
+
+/////////////////////////////////////////////////////////////////////
+//
+//   Podd::SimTreeDecoder
+//
+//   Decoder for digitized simulation data read by Podd::SimTreeRun.
+//   Injects the hits directly into the detectors.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include "SimDecoder.h"
+
+namespace Podd {
+
+class SimTreeDecoder : public SimDecoder {
+public:
+  SimTreeDecoder();
+  virtual ~SimTreeDecoder() = default;
+
+  virtual Int_t LoadEvent( const UInt_t* evbuffer );
+
+  ClassDef(SimTreeDecoder,0)  // Decoder for columnar digitized simulation data
+};
+
+} // namespace Podd
+
+#endif
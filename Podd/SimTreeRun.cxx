@@ -0,0 +1,257 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::SimTreeRun
+//
+// Reads digitized simulation data from a ROOT tree (default name "T")
+// with one std::vector<UInt_t> branch per detector, hit type and column:
+//
+//   <prefix>adc.chan   logical channels with ADC data, e.g. "R.s1.adc.chan"
+//   <prefix>adc.data   corresponding raw ADC values
+//   <prefix>tdc.chan   logical channels with TDC data
+//   <prefix>tdc.data   corresponding raw TDC values (common stop)
+//   <prefix>tdcstart.chan, <prefix>tdcstart.data   same for common-start TDCs
+//
+// and optionally scalar branches "evnum" (UInt_t) and "weight" (Double_t).
+// The logical channels are those of the detector map, starting at 0 and
+// counting the views in the order in which they appear in the map.
+//
+// Only these branches are read, through a TTreeCache, so that whole
+// clusters of entries are read at once. The events are meant to be
+// decoded with Podd::SimTreeDecoder, which passes the hits directly to
+// the detectors' DetectorData objects, bypassing the crate/slot data.
+//
+// The run date defaults to the creation time of the input file. Files
+// written by Podd::HitCacheWriter carry the original run number and date
+// in the tree's user info ("run_number", "run_date"), which are used
+// if present.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "SimTreeRun.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TObjArray.h"
+#include "TList.h"
+#include "TParameter.h"
+#include "TError.h"
+#include "RVersion.h"
+#include <cstring>
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+SimTreeRun::SimTreeRun( const char* filename, const char* treename,
+                        const char* description )
+  : THaRunBase(description), fFileName(filename), fTreeName(treename),
+    fCacheSize(32*1024*1024), fFile(nullptr), fTree(nullptr), fNentries(0),
+    fEntry(0)
+{
+  // Constructor
+}
+
+//_____________________________________________________________________________
+SimTreeRun::SimTreeRun( const SimTreeRun& rhs )
+  : THaRunBase(rhs), fFileName(rhs.fFileName), fTreeName(rhs.fTreeName),
+    fCacheSize(rhs.fCacheSize), fFile(nullptr), fTree(nullptr), fNentries(0),
+    fEntry(0)
+{
+  // Copy constructor. The copy is not open.
+}
+
+//_____________________________________________________________________________
+SimTreeRun& SimTreeRun::operator=( const THaRunBase& rhs )
+{
+  // Assignment operator. The input file stays open if it is the same.
+
+  if( this != &rhs ) {
+    THaRunBase::operator=(rhs);
+    if( rhs.InheritsFrom(SimTreeRun::Class()) ) {
+      const auto& run = static_cast<const SimTreeRun&>(rhs);
+      fFileName  = run.fFileName;
+      fTreeName  = run.fTreeName;
+      fCacheSize = run.fCacheSize;
+    }
+  }
+  return *this;
+}
+
+//_____________________________________________________________________________
+SimTreeRun::~SimTreeRun()
+{
+  // Destructor
+
+  if( IsOpen() )
+    Close();
+}
+
+//_____________________________________________________________________________
+Int_t SimTreeRun::Open()
+{
+  // Open the input file and set up the branches to be read
+
+  const char* const here = "SimTreeRun::Open";
+
+  if( IsOpen() )
+    return READ_OK;
+
+  fFile = TFile::Open(fFileName, "READ");
+  if( !fFile || fFile->IsZombie() ) {
+    Error( here, "Cannot open input file %s", fFileName.Data() );
+    Close();
+    return READ_FATAL;
+  }
+  fTree = dynamic_cast<TTree*>(fFile->Get(fTreeName));
+  if( !fTree ) {
+    Error( here, "Tree \"%s\" not found in input file %s",
+           fTreeName.Data(), fFileName.Data() );
+    Close();
+    return READ_FATAL;
+  }
+
+  // Find the hit columns, <prefix>{adc,tdc}.chan with matching .data
+  for( auto& col : fEvent.columns ) {
+    delete col.chan;
+    delete col.data;
+  }
+  fEvent.columns.clear();
+  fTree->SetBranchStatus("*", false);
+  TIter next(fTree->GetListOfBranches());
+  while( auto* br = static_cast<TBranch*>(next()) ) {
+    string name = br->GetName(), prefix;
+    Decoder::ChannelType type = Decoder::ChannelType::kUndefined;
+    for( const char* suffix : { "adc.chan", "tdc.chan", "tdcstart.chan" } ) {
+      size_t len = strlen(suffix);
+      if( name.size() > len && name.compare(name.size()-len, len, suffix) == 0 ) {
+        prefix = name.substr(0, name.size()-len);
+        type = (suffix[0] == 'a') ? Decoder::ChannelType::kADC
+          : (suffix[3] == 's') ? Decoder::ChannelType::kCommonStartTDC
+                               : Decoder::ChannelType::kCommonStopTDC;
+      }
+    }
+    if( prefix.empty() )
+      continue;
+    string dataname = name.substr(0, name.size()-4) + "data";
+    if( !fTree->GetBranch(dataname.c_str()) ) {
+      Warning( here, "Branch %s without %s, ignored", name.c_str(),
+               dataname.c_str() );
+      continue;
+    }
+    fEvent.columns.emplace_back(prefix, type);
+    auto& col = fEvent.columns.back();
+    col.chan = new vector<UInt_t>;
+    col.data = new vector<UInt_t>;
+    fTree->SetBranchStatus(name.c_str(), true);
+    fTree->SetBranchStatus(dataname.c_str(), true);
+    fTree->SetBranchAddress(name.c_str(), &col.chan);
+    fTree->SetBranchAddress(dataname.c_str(), &col.data);
+  }
+  if( fEvent.columns.empty() ) {
+    Error( here, "No hit data branches (<prefix>adc.chan etc.) in tree %s",
+           fTreeName.Data() );
+    Close();
+    return READ_FATAL;
+  }
+  for( const char* name : { "evnum", "weight" } ) {
+    if( fTree->GetBranch(name) )
+      fTree->SetBranchStatus(name, true);
+  }
+  if( fTree->GetBranch("evnum") )
+    fTree->SetBranchAddress("evnum", &fEvent.evnum);
+  if( fTree->GetBranch("weight") )
+    fTree->SetBranchAddress("weight", &fEvent.weight);
+
+  // Read the enabled branches in bulk, one cluster of entries at a time
+  if( fCacheSize > 0 ) {
+    fTree->SetCacheSize(fCacheSize);
+    fTree->AddBranchToCache("*", true);
+    fTree->StopCacheLearningPhase();
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,10,0)
+    fTree->SetClusterPrefetch(true);
+#endif
+  }
+
+  fNentries = fTree->GetEntries();
+  fEntry = 0;
+  fOpened = true;
+  return READ_OK;
+}
+
+//_____________________________________________________________________________
+Int_t SimTreeRun::Close()
+{
+  // Close the input file
+
+  delete fFile;  // Deletes fTree
+  fFile = nullptr;
+  fTree = nullptr;
+  for( auto& col : fEvent.columns ) {
+    delete col.chan;
+    delete col.data;
+  }
+  fEvent.columns.clear();
+  fOpened = false;
+  return READ_OK;
+}
+
+//_____________________________________________________________________________
+Int_t SimTreeRun::ReadEvent()
+{
+  // Read the next entry of the input tree
+
+  if( !IsOpen() ) {
+    Int_t ret = Open();
+    if( ret )
+      return ret;
+  }
+  if( fEntry >= fNentries )
+    return READ_EOF;
+
+  fEvent.evnum = static_cast<UInt_t>(fEntry+1);
+  Int_t ret = fTree->GetEntry(fEntry++);
+  if( ret > 0 )
+    return READ_OK;
+  return (ret == 0) ? READ_EOF : READ_ERROR;
+}
+
+//_____________________________________________________________________________
+const UInt_t* SimTreeRun::GetEvBuffer() const
+{
+  // Return the current event. This is not a CODA buffer. It can only be
+  // decoded by SimTreeDecoder.
+
+  if( !IsOpen() )
+    return nullptr;
+  return reinterpret_cast<const UInt_t*>(&fEvent);
+}
+
+//_____________________________________________________________________________
+Int_t SimTreeRun::ReadInitInfo()
+{
+  // Use the run date (as time_t) and number stored by HitCacheWriter, if
+  // any, else the file creation time as the run date, unless set explicitly
+
+  TList* info = fTree ? fTree->GetUserInfo() : nullptr;
+  auto* date = info ? dynamic_cast<TParameter<Long64_t>*>(
+    info->FindObject("run_date")) : nullptr;
+  auto* number = info ? dynamic_cast<TParameter<Long64_t>*>(
+    info->FindObject("run_number")) : nullptr;
+  if( !fAssumeDate && (date || fFile) ) {
+    if( date )
+      fDate.Set(static_cast<UInt_t>(date->GetVal()));
+    else
+      fDate = fFile->GetCreationDate();
+    fDataSet |= kDate;
+  }
+  if( number && !(fDataSet & kRunNumber) ) {
+    fNumber = static_cast<UInt_t>(number->GetVal());
+    fDataSet |= kRunNumber;
+  }
+  return READ_OK;
+}
+
+} // namespace Podd
+
+ClassImp(Podd::SimTreeRun)
@@ -0,0 +1,84 @@
+#ifndef Podd_SimTreeRun_h_
+#define Podd_SimTreeRun_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::SimTreeRun
+//
+// Run class for digitized simulation data in columnar ROOT trees,
+// to be analyzed with Podd::SimTreeDecoder.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "THaRunBase.h"
+#include "Decoder.h"   // for ChannelType
+#include "TString.h"
+#include <vector>
+#include <string>
+
+class TFile;
+class TTree;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+// One event of a SimTreeRun, as passed to SimTreeDecoder via GetEvBuffer()
+class SimTreeEvent {
+public:
+  SimTreeEvent() : evnum(0), weight(1.0) {}
+
+  // Digitized hits of one type of one detector
+  class Column_t {
+  public:
+    Column_t( const std::string& _prefix, Decoder::ChannelType _type )
+      : prefix(_prefix), type(_type), chan(nullptr), data(nullptr) {}
+    std::string          prefix; // Detector prefix, e.g. "R.s1."
+    Decoder::ChannelType type;   // ADC or TDC
+    std::vector<UInt_t>* chan;   // Logical channels with data
+    std::vector<UInt_t>* data;   // Raw data of these channels
+  };
+
+  UInt_t                evnum;   // Event number
+  Double_t              weight;  // Event weight
+  std::vector<Column_t> columns; // Hit data, layout fixed by the input tree
+};
+
+//_____________________________________________________________________________
+class SimTreeRun : public THaRunBase {
+public:
+  explicit SimTreeRun( const char* filename = "", const char* treename = "T",
+                       const char* description = "" );
+  SimTreeRun( const SimTreeRun& run );
+  SimTreeRun& operator=( const THaRunBase& rhs );
+  virtual ~SimTreeRun();
+
+  virtual Int_t         Close();
+  virtual Int_t         Open();
+  virtual Int_t         ReadEvent();
+  virtual const UInt_t* GetEvBuffer() const;
+
+  const char* GetFileName() const { return fFileName.Data(); }
+  const char* GetTreeName() const { return fTreeName.Data(); }
+  void        SetFileName( const char* name ) { fFileName = name; }
+  void        SetTreeName( const char* name ) { fTreeName = name; }
+  void        SetCacheSize( Long64_t bytes ) { fCacheSize = bytes; }
+
+protected:
+  virtual Int_t ReadDatabase() { return 0; }
+  virtual Int_t ReadInitInfo();
+
+  TString       fFileName;  // Name of input file
+  TString       fTreeName;  // Name of input tree
+  Long64_t      fCacheSize; // Size of read-ahead cache (bytes)
+  TFile*        fFile;      //! Input ROOT file
+  TTree*        fTree;      //! Input tree
+  Long64_t      fNentries;  //! Number of entries in tree
+  Long64_t      fEntry;     //! Next entry to read
+  SimTreeEvent  fEvent;     //! Current event
+
+  ClassDef(SimTreeRun,1)  // Run class for columnar digitized simulation data
+};
+
+} // namespace Podd
+
+#endif
@@ -14,6 +14,7 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "THaAnalysisObject.h"
+#include "AnalysisContext.h"
 #include "THaVarList.h"
 #include "THaGlobals.h"
 #include "TClass.h"
@@ -34,6 +35,9 @@
 #include <cassert>
 #include <iomanip>
 #include <type_traits>
+#include <algorithm>
+
+#define ALL(c) (c).begin(), (c).end()
 
 using namespace std;
 using namespace Podd;
@@ -46,7 +50,7 @@ THaAnalysisObject::THaAnalysisObject( const char* name,
   TNamed(name,description), fPrefix(nullptr), fStatus(kNotinit),
   fDebug(0), fIsInit(false), fIsSetup(false), fProperties(0),
   fOKOut(false), fInitDate(19950101,0), fNEventsWithWarnings(0),
-  fExtra(nullptr)
+  fExtra(nullptr), fContext(nullptr), fClearGen(0)
 {
   // Constructor
 
@@ -58,7 +62,7 @@ THaAnalysisObject::THaAnalysisObject( const char* name,
 THaAnalysisObject::THaAnalysisObject()
   : fPrefix(nullptr), fStatus(kNotinit), fDebug(0), fIsInit(false),
     fIsSetup(false), fProperties(), fOKOut(false), fNEventsWithWarnings(0),
-    fExtra(nullptr)
+    fExtra(nullptr), fContext(nullptr), fClearGen(0)
 {
   // only for ROOT I/O
 }
@@ -194,7 +198,7 @@ Int_t THaAnalysisObject::DefineVarsFromList( const void* list, EType type,
 
   TString here(GetClassName());
   here.Append("::DefineVarsFromList");
-  return DefineVarsFromList(list, type, mode, def_prefix, this,
+  return DefineVarsFromList(GetVarList(), list, type, mode, def_prefix, this,
                             fPrefix, here.Data(), comment_subst);
 }
 
@@ -206,11 +210,28 @@ Int_t THaAnalysisObject::DefineVarsFromList( const void* list,
                                              const char* prefix,
                                              const char* here,
                                              const char* comment_subst )
+{
+  // Static function that can be used by classes other than THaAnalysisObjects.
+  // Adds/deletes variables to/from the global list gHaVars.
+
+  return DefineVarsFromList(gHaVars, list, type, mode, def_prefix, obj,
+                            prefix, here, comment_subst);
+}
+
+//_____________________________________________________________________________
+Int_t THaAnalysisObject::DefineVarsFromList( THaVarList* varlist,
+                                             const void* list,
+                                             EType type, EMode mode,
+                                             const char* def_prefix,
+                                             const TObject* obj,
+                                             const char* prefix,
+                                             const char* here,
+                                             const char* comment_subst )
 {
   // Actual implementation of the variable definition utility function.
-  // Static function that can be used by classes other than THaAnalysisObjects
+  // Adds/deletes variables to/from 'varlist'.
 
-  if( !gHaVars ) {
+  if( !varlist ) {
     TString action;
     if( mode == kDefine )
       action = "defined";
@@ -223,10 +244,10 @@ Int_t THaAnalysisObject::DefineVarsFromList( const void* list,
 
   if( mode == kDefine ) {
     if( type == kVarDef )
-      gHaVars->DefineVariables( static_cast<const VarDef*>(list),
+      varlist->DefineVariables( static_cast<const VarDef*>(list),
 				prefix, ::Here(here,prefix) );
     else if( type == kRVarDef )
-      gHaVars->DefineVariables(static_cast<const RVarDef*>(list), obj,
+      varlist->DefineVariables(static_cast<const RVarDef*>(list), obj,
                                prefix, ::Here(here, prefix), def_prefix,
                                comment_subst);
   }
@@ -236,7 +257,7 @@ Int_t THaAnalysisObject::DefineVarsFromList( const void* list,
       while( item && item->name ) {
 	TString name(prefix);
 	name.Append( item->name );
-	gHaVars->RemoveName( name );
+	varlist->RemoveName( name );
 	++item;
       }
     } else if( type == kRVarDef ) {
@@ -244,7 +265,7 @@ Int_t THaAnalysisObject::DefineVarsFromList( const void* list,
       while( item && item->name ) {
 	TString name(prefix);
 	name.Append( item->name );
-	gHaVars->RemoveName( name );
+	varlist->RemoveName( name );
 	++item;
       }
     }
@@ -333,9 +354,23 @@ THaAnalysisObject* THaAnalysisObject::FindModule( const char* name,
       return nullptr;
     }
   }
+  AddDependency(aobj);
   return aobj;
 }
 
+//_____________________________________________________________________________
+void THaAnalysisObject::AddDependency( THaAnalysisObject* module )
+{
+  // Declare that this object uses the event data of 'module', so 'module'
+  // must be processed first. FindModule() does this automatically. The
+  // analyzer uses this to order the physics modules (see
+  // THaAnalyzer::PrepareModuleList).
+
+  if( module && module != this &&
+      find(ALL(fDependencies), module) == fDependencies.end() )
+    fDependencies.push_back(module);
+}
+
 //_____________________________________________________________________________
 const char* THaAnalysisObject::GetDBFileName() const
 {
@@ -400,6 +435,22 @@ THaAnalysisObject::EStatus THaAnalysisObject::Init()
   return Init( TDatime() );
 }
 
+//_____________________________________________________________________________
+THaAnalysisObject::EStatus THaAnalysisObject::Init( const TDatime& date,
+                                                    AnalysisContext* context )
+{
+  // Set the context for this object, then initialize it for the given date.
+  //
+  // Since this function is not virtual, derived classes that override
+  // Init(const TDatime&) hide it. Call it via a THaAnalysisObject pointer
+  // or reference.
+  // The list of dependencies is rebuilt during initialization.
+
+  SetContext(context);
+  fDependencies.clear();
+  return Init(date);
+}
+
 //_____________________________________________________________________________
 THaAnalysisObject::EStatus THaAnalysisObject::Init( const TDatime& date )
 {
@@ -417,7 +468,11 @@ THaAnalysisObject::EStatus THaAnalysisObject::Init( const TDatime& date )
     return fStatus = kNotinit;
 
   fInitDate = date;
-  
+
+  // Fix the context now. Derived classes may inherit it from a parent
+  // object, which might no longer exist when our variables are removed.
+  fContext = GetContext();
+
   const char* fnam = "run.";
 
   // Generate the name prefix for global variables. Do this here, not in
@@ -495,6 +550,26 @@ Int_t THaAnalysisObject::InitOutput( THaOutput* /* output */ )
   return kOK;
 }
 
+//_____________________________________________________________________________
+Bool_t THaAnalysisObject::IsVariableUsed( const char* name ) const
+{
+  // Check if this object's global variable 'name' (without prefix) is read
+  // by the output, cuts or tests. Always true unless the analyzer has
+  // determined variable usage (see THaAnalyzer::EnableSkipUnusedVariables)
+  // or if there is no such variable.
+  //
+  // Modules may override UpdateVariableUsage() to query this after
+  // initialization and skip calculating results nobody reads.
+
+  const THaVarList* vars = GetVarList();
+  if( !vars || !vars->IsUsageKnown() )
+    return true;
+  TString fullname = fPrefix ? fPrefix : "";
+  fullname += name;
+  const THaVar* var = vars->Find(fullname.Data());
+  return !var || var->IsUsed();
+}
+
 //_____________________________________________________________________________
 void THaAnalysisObject::MakePrefix( const char* basename )
 {
@@ -594,6 +669,76 @@ void THaAnalysisObject::SetNameTitle( const char* name, const char* title )
   SetTitle( title );
 }
 
+//_____________________________________________________________________________
+AnalysisContext* THaAnalysisObject::GetContext() const
+{
+  // Return the context (variable list, cut list, run) of this object.
+  // If none has been set, return the default context, which refers to
+  // gHaVars, gHaCuts and gHaRun.
+
+  return fContext ? fContext : &AnalysisContext::GetDefault();
+}
+
+//_____________________________________________________________________________
+void THaAnalysisObject::SetContext( AnalysisContext* context )
+{
+  // Set the context to be used by this object. If 'context' is nullptr,
+  // use the default context.
+  //
+  // Must be called before Init(). Changing the context of an
+  // initialized object would leave its variables in the old list.
+
+  if( fIsSetup && context != fContext ) {
+    Warning( Here("SetContext"), "Cannot change context of initialized "
+             "object. Call before Init()." );
+    return;
+  }
+  fContext = context;
+}
+
+//_____________________________________________________________________________
+THaVarList* THaAnalysisObject::GetVarList() const
+{
+  // Variable list of this object's context
+
+  return GetContext()->GetVars();
+}
+
+//_____________________________________________________________________________
+THaCutList* THaAnalysisObject::GetCutList() const
+{
+  // Cut list of this object's context
+
+  return GetContext()->GetCuts();
+}
+
+//_____________________________________________________________________________
+THaRunBase* THaAnalysisObject::GetCurrentRun() const
+{
+  // Current run of this object's context
+
+  return GetContext()->GetRun();
+}
+
+//_____________________________________________________________________________
+void THaAnalysisObject::SetLazyClear( Bool_t b )
+{
+  // Allow the analyzer to defer clearing this object's event data until
+  // the object is first called in an event, instead of clearing all
+  // modules up front (see THaAnalyzer::EnableLazyClear). With parallel
+  // decoding, the clearing then runs on the thread that fills the data.
+  //
+  // Only set this if no test or module reads this object's variables in
+  // an analysis stage before the object's own first stage: until then,
+  // they still hold the previous event's values. Such readers can check
+  // IsCurrent().
+
+  if( b )
+    fProperties |= kLazyClear;
+  else
+    fProperties &= ~kLazyClear;
+}
+
 //_____________________________________________________________________________
 void THaAnalysisObject::SetConfig( const char* label )
 {
@@ -851,6 +996,17 @@ void THaAnalysisObject::Print( Option_t* opt ) const
   }
 }
 
+//_____________________________________________________________________________
+size_t THaAnalysisObject::GetMemoryUsage() const
+{
+  // Approximate memory held by this object (bytes). The default is the
+  // size of the object itself. Classes holding large arrays add the memory
+  // of those (see e.g. THaDetectorBase, THaSpectrometer).
+  // Used for the memory report of THaAnalyzer::Print.
+
+  return IsA()->Size();
+}
+
 //_____________________________________________________________________________
 void THaAnalysisObject::PrintObjects( Option_t* opt )
 {
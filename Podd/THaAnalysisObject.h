@@ -26,7 +26,12 @@ class TList;
 class TVector3;
 class THaRunBase;
 class THaOutput;
+class THaVarList;
+class THaCutList;
 class TObjArray;
+namespace Podd {
+  class AnalysisContext;
+}
 
 class THaAnalysisObject : public TNamed {
   
@@ -45,27 +50,47 @@ public:
   virtual const char*  GetDBFileName() const;
           const char*  GetClassName() const;
           const char*  GetConfig() const         { return fConfig.Data(); }
+  const std::vector<THaAnalysisObject*>&
+                       GetDependencies() const   { return fDependencies; }
+  virtual Podd::AnalysisContext* GetContext() const;
           Int_t        GetDebug() const          { return fDebug; }
           const char*  GetPrefix() const         { return fPrefix; }
           TString      GetPrefixName() const;
           EStatus      Init();
   virtual EStatus      Init( const TDatime& run_time );
+          EStatus      Init( const TDatime& run_time,
+                             Podd::AnalysisContext* context );
           Bool_t       IsInit() const            { return IsOK(); }
           Bool_t       IsOK() const              { return (fStatus == kOK); }
+          Bool_t       IsLazyClear() const { return (fProperties & kLazyClear) != 0; }
 
 	  TDatime      GetInitDate() const       { return fInitDate; }
 
           void         SetConfig( const char* label );
+          void         SetContext( Podd::AnalysisContext* context );
   virtual void         SetDebug( Int_t level );
+          void         SetLazyClear( Bool_t b = true );
   virtual void         SetName( const char* name );
   virtual void         SetNameTitle( const char* name, const char* title );
           EStatus      Status() const            { return fStatus; }
 
   virtual Int_t        InitOutput( THaOutput * );
           Bool_t       IsOKOut() const           { return fOKOut; }
+  virtual void         UpdateVariableUsage() {}
+          Bool_t       IsVariableUsed( const char* name ) const;
   virtual FILE*        OpenFile( const TDatime& date );
   virtual FILE*        OpenRunDBFile( const TDatime& date );
   virtual void         Print( Option_t* opt="" ) const;
+  // Memory held by this object, including its per-event arrays (bytes)
+  virtual size_t       GetMemoryUsage() const;
+
+  // Clear on first use in an event (see THaAnalyzer::EnableLazyClear).
+  // 'gen' identifies the event; the event data are current if the object
+  // was cleared for the same generation.
+          void         ClearForEvent( ULong64_t gen ) {
+    if( gen != fClearGen ) { fClearGen = gen; Clear(); }
+  }
+          Bool_t       IsCurrent( ULong64_t gen ) const { return gen == fClearGen; }
 
   // For backwards compatibility
   static Int_t    LoadDB( FILE* file, const TDatime& date,
@@ -97,12 +122,22 @@ public:
                                       const char* prefix,
                                       const char* here,
                                       const char* comment_subst = "" );
+  static Int_t    DefineVarsFromList( THaVarList* varlist,
+                                      const void* list,
+                                      EType type, EMode mode,
+                                      const char* def_prefix,
+                                      const TObject* obj,
+                                      const char* prefix,
+                                      const char* here,
+                                      const char* comment_subst = "" );
 
   static void     PrintObjects( Option_t* opt="" );
+  static const TList* GetModules() { return fgModules; }
 
 protected:
 
-  enum EProperties { kNeedsRunDB = BIT(0), kConfigOverride = BIT(1) };
+  enum EProperties { kNeedsRunDB = BIT(0), kConfigOverride = BIT(1),
+                     kLazyClear = BIT(2) };
 
   // General status variables
   char*           fPrefix;    // Name prefix for global variables
@@ -120,6 +155,14 @@ protected:
 
   TObject*        fExtra;     // Additional member data (for binary compat.)
 
+  Podd::AnalysisContext* fContext; //! Variables/cuts/run context (nullptr: default)
+  ULong64_t       fClearGen;  //! Event generation of last ClearForEvent
+
+  // Modules whose event data this object uses, found with FindModule
+  // or added with AddDependency during initialization
+  std::vector<THaAnalysisObject*> fDependencies; //!
+
+          void         AddDependency( THaAnalysisObject* module );
   virtual Int_t        DefineVariables( EMode mode = kDefine );
           Int_t        DefineVarsFromList( const VarDef* list,
                                            EMode mode = kDefine,
@@ -148,6 +191,11 @@ protected:
   virtual Int_t        ReadRunDatabase( const TDatime& date );
           Int_t        RemoveVariables();
 
+  // Shorthands for the lists and run of this object's context
+          THaVarList*  GetVarList() const;
+          THaCutList*  GetCutList() const;
+          THaRunBase*  GetCurrentRun() const;
+
 #ifdef WITH_DEBUG
   void DebugPrint( const DBRequest* list ) const;
 
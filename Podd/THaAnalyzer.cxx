@@ -20,18 +20,37 @@
 
 #include "THaAnalyzer.h"
 #include "THaRunBase.h"
+#include "THaCodaRun.h"
+#include "THaRun.h"
 #include "THaEvent.h"
 #include "THaOutput.h"
 #include "THaEvData.h"
 #include "THaGlobals.h"
 #include "THaSpectrometer.h"
+#include "DecData.h"
+#include "THaDetector.h"
+#include "THaVarList.h"
 #include "THaCutList.h"
+#include "THaCut.h"
 #include "THaPhysicsModule.h"
+#include "THaDebugModule.h"
 #include "InterStageModule.h"
+#include "EventQueue.h"
+#include "EvtHandlerThread.h"
+#include "TaskPool.h"
+#include "ThreadAffinity.h"
+#include "HistoServer.h"
+#include "AnalysisContext.h"
 #include "THaPostProcess.h"
-#include "THaBenchmark.h"
+#include "Profiler.h"
+#include "LatencyHistogram.h"
+#include "AllocCounter.h"
+#include "ProfMarkers.h"
 #include "THaEvtTypeHandler.h"
 #include "THaEpicsEvtHandler.h"
+#include "THaHelicityDet.h"
+#include "Variable.h"
+#include "FormulaProgram.h"
 #include "TList.h"
 #include "TTree.h"
 #include "TFile.h"
@@ -41,15 +60,27 @@
 #include "TSystem.h"
 #include "TROOT.h"
 #include "TDirectory.h"
+#include "RConfigure.h"  // for R__USE_IMT
+#include "RVersion.h"
 #include "THaCrateMap.h"
 #include "Helper.h"
 
 #include <iostream>
 #include <iomanip>
+#include <fstream>
+#include <sstream>
 #include <exception>
 #include <stdexcept>
 #include <algorithm>
+#include <cstring>
+#include <cstdio>
 #include <vector>
+#include <functional>
+#include <utility>
+#include <cassert>
+#include <initializer_list>
+#include <chrono>
+#include <cmath>
 
 using namespace std;
 using namespace Decoder;
@@ -90,17 +121,43 @@ inline size_t ListToVector( TList* lst, vector<T*>& vec )
   return vec.size();
 }
 
+//_____________________________________________________________________________
+static inline Double_t WallTime()
+{
+  // Monotonic wall-clock time in seconds, for online mode bookkeeping
+
+  return chrono::duration<Double_t>(
+    chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 //_____________________________________________________________________________
 THaAnalyzer::THaAnalyzer() :
   fFile(nullptr), fOutput(nullptr), fEpicsHandler(nullptr),
   fOdefFileName(kDefaultOdefFile), fEvent(nullptr), fWantCodaVers(-1),
-  fNev(0), fMarkInterval(1000), fCompress(1),
-  fVerbose(2), fCountMode(kCountRaw), fBench(nullptr), fPrevEvent(nullptr),
-  fRun(nullptr), fEvData(nullptr),
+  fNev(0), fMarkInterval(1000), fCompress(1), fCompressAlgo(0),
+  fVerbose(2), fCountMode(kCountRaw), fEvDeadline(0), fSampleInterval(0),
+  fOnlineInterval(10), fFlushInterval(10), fLastFlush(0),
+  fNevFlushed(0), fReloadInterval(2), fLastReload(0),
+  fPublishInterval(1), fHistoMapSize(0),
+  fSampling(0), fSampleRng(0), fSampleCount(0), fTrigMask(0),
+  fTrigData(nullptr), fNThreads(1), fOutThreads(0),
+  fBatchSize(1), fMemBudget(0), fCheckpointInterval(10000), fResumeNev(0), fBench(nullptr),
+  fPrevEvent(nullptr),
+  fRun(nullptr), fEvData(nullptr), fEvQueue(nullptr), fTaskPool(nullptr),
+  fEvtThread(nullptr), fHistoServer(nullptr),
+  fContext(&Podd::AnalysisContext::GetDefault()),
+  fNReInit(0),
   fIsInit(false), fAnalysisStarted(false), fLocalEvent(false),
-  fUpdateRun(true), fOverwrite(true), fDoBench(false),
-  fDoHelicity(false), fDoPhysics(true), fDoOtherEvents(true),
-  fDoSlowControl(true), fFirstPhysics(true), fExtra(nullptr)
+  fUpdateRun(true), fOverwrite(true), fDoBench(false), fDoAllocStats(false),
+  fDoLatency(false), fDoPerfSummary(false), fDoHelicity(false), fDoPhysics(true), fDoOtherEvents(true),
+  fDoSlowControl(true), fDoPipeline(false), fDoParallelApps(false),
+  fDoShard(false), fSkipUnused(false), fSkipUnusedVars(false),
+  fFastReInit(false), fReuseInit(false), fHotReload(false), fOnlineMode(false),
+  fDoPrefilter(false), fLazyClear(false), fClearGen(0), fDemandDecode(false),
+  fDoResume(false),
+  fFirstPhysics(true), fEvSkipped(false),
+  fSampleKeep(false), fTrigKeep(false), fNslow(0), fDoEvTiming(false), fEvStart(0),
+  fEvLatency(nullptr), fPerfVarsDefined(false), fExtra(nullptr)
 
 {
   // Default constructor.
@@ -119,8 +176,17 @@ THaAnalyzer::THaAnalyzer() :
   //  fEpicsHandler->SetDebugFile("epicsdat.txt");
   fEvtHandlers.push_back(fEpicsHandler);
 
-  // Timers
-  fBench = new THaBenchmark;
+  // Timers. Register in the order of EBench so that handles equal enum
+  // values. The analysis stage timers are children of "Total"
+  // (see InitStages).
+  fBench = new Podd::Profiler("Analyzer");
+  fBench->Register("Total", Podd::Profiler::kNoParent, true);
+  for( const char* name : { "Init", "RawDecode", "Decode", "CoarseTracking",
+                            "CoarseReconstruct", "Tracking", "Reconstruct",
+                            "Physics", "Output", "Cuts", "PostProcess" } )
+    fBench->Register(name, kBenchTotal);
+  assert( fBench->GetSize() == kBenchPostProcess+1 );
+  fEvLatency = new Podd::LatencyHistogram;
 }
 
 //_____________________________________________________________________________
@@ -129,11 +195,13 @@ THaAnalyzer::~THaAnalyzer()
   // Destructor.
 
   Close();
+  DefinePerfVariables(true);
   DeleteContainer(fPostProcess);
   DeleteContainer(fEvtHandlers);
   DeleteContainer(fInterStage);
   delete fExtra; fExtra = nullptr;
   delete fBench;
+  delete fEvLatency;
   if( fgAnalyzer == this )
     fgAnalyzer = nullptr;
 }
@@ -167,7 +235,8 @@ Int_t THaAnalyzer::AddInterStage( Podd::InterStageModule* module )
       return 236;
     }
     TDatime run_time = fRun->GetDate();
-    Int_t retval = module->Init(run_time);
+    Int_t retval = static_cast<THaAnalysisObject*>(module)->Init(run_time,
+                                                                 fContext);
     if( retval )
       return retval;
   }
@@ -220,6 +289,24 @@ void THaAnalyzer::ClearCounters()
   for( auto& theCounter : fCounters ) {
     theCounter.count = 0;
   }
+  fCounterShards.Clear();
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::CollectCounters()
+{
+  // Add the counts of threads other than the main thread to the statistics
+  // counters and cuts. Call only while no analysis threads are running,
+  // i.e. between events. Counts from the main thread go directly into
+  // fCounters and the cuts' own counters, so the event loop needs no
+  // atomic operations or locks.
+
+  vector<UInt_t> counts(fCounters.size(), 0);
+  fCounterShards.Collect(counts.data());
+  for( size_t i = 0; i < counts.size(); ++i )
+    fCounters[i].count += counts[i];
+  if( fContext->GetCuts() )
+    fContext->GetCuts()->CollectCounts();
 }
 
 //_____________________________________________________________________________
@@ -238,9 +325,17 @@ void THaAnalyzer::Close()
   fSpectrometers.clear();
   fPhysics.clear();
   fEvtHandlers.clear();
+  fModuleInit.clear();
+  fCrateMapFiles.clear();
 
-  if( gHaRun && *gHaRun == *fRun )
-    gHaRun = nullptr;
+  StopPipeline();
+  StopHistoServer();
+  delete fEvtThread; fEvtThread = nullptr;
+  delete fTaskPool; fTaskPool = nullptr;
+
+  THaRunBase* currentRun = fContext->GetRun();
+  if( currentRun && fRun && *currentRun == *fRun )
+    fContext->SetRun(nullptr);
 
   delete fEvData; fEvData = nullptr;
   delete fOutput; fOutput = nullptr;
@@ -255,10 +350,109 @@ void THaAnalyzer::Close()
 }
 
 
+//_____________________________________________________________________________
+void THaAnalyzer::EnableAllocTracking( Bool_t b )
+{
+  // Enable/disable counting of heap allocations during the event loop.
+  // The counts are recorded by the benchmark timers, so this also enables
+  // benchmarks. They show up in the timing summary, for each analysis
+  // stage and module, and per call of each stage in PrintCounters().
+  //
+  // Allocations are attributed to the thread making them. With parallel
+  // apparatuses or output threads, the stage totals include only the
+  // main thread, while the per-module counts are complete.
+  //
+  // Requires a build with PODD_ALLOC_TRACKING.
+
+  if( b && !Podd::AllocCounter::IsAvailable() ) {
+    Warning( "THaAnalyzer::EnableAllocTracking", "Allocation counting "
+             "not available. Rebuild with -DPODD_ALLOC_TRACKING=ON." );
+    b = false;
+  }
+  fDoAllocStats = b;
+  if( b )
+    fDoBench = true;
+}
+
 //_____________________________________________________________________________
 void THaAnalyzer::EnableBenchmarks( Bool_t b )
 {
+  // Enable/disable timing of the analysis stages and modules. In builds
+  // with an external profiler (see Podd::ProfMarkers), the timed sections
+  // are also marked for that profiler.
+
   fDoBench = b;
+  if( !b )
+    fDoAllocStats = fDoLatency = false;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EnableLatencyStats( Bool_t b )
+{
+  // Enable/disable histogramming the time each event spends in each
+  // analysis stage (RawDecode through Physics) and in Output. Percentiles
+  // are shown in the timing summary and are available via
+  // GetProfiler()->GetLatency(). Also enables benchmarks.
+
+  fDoLatency = b;
+  if( b )
+    fDoBench = true;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EnableDemandDecoding( Bool_t b )
+{
+  // Enable/disable decoding of only those crates (ROCs) that the analysis
+  // modules read from. The crates are collected from the detector maps of
+  // all detectors, the data channels of the decoder data apparatuses and
+  // the event type handlers (see GetCrates() of these classes) at the
+  // start of each Process(). The data of other crates are skipped without
+  // being decoded. Useful e.g. for calibrating a single detector.
+  // Modules that read crates not listed in their GetCrates() would see
+  // no data, so this is off by default.
+
+  fDemandDecode = b;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EnableFastReInit( Bool_t b )
+{
+  // Enable/disable fast re-initialization when analyzing several runs in
+  // a row. When enabled, Init() for a new run skips modules whose
+  // database files would give the same data for the new run: the same
+  // files would be opened, their contents are unchanged, and no time stamp
+  // in them lies between the old and the new run date. If no module needs
+  // to be re-initialized, cuts and output definitions are kept as well.
+  //
+  // Only database files opened via Podd::OpenDBFile are tracked. Modules
+  // that take run-dependent information from other sources (e.g. the run
+  // parameters in the CODA file) should not be used with this option.
+
+  fFastReInit = b;
+  if( !b && !fHotReload )
+    fModuleInit.clear();
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EnableHotReload( Bool_t b )
+{
+  // Enable/disable reloading of changed database files during a replay,
+  // e.g. while tuning calibrations during an online replay (THaOnlRun).
+  // Between events, at most every fReloadInterval seconds (see
+  // SetReloadInterval), the analyzer checks whether any of the database
+  // files read by the crate map or by an apparatus, physics module or
+  // inter-stage module have been modified. If so, the crate map is re-read
+  // and only the affected modules are re-initialized (see HotReload).
+  // The output tree and histograms are not re-created, so all data
+  // accumulated so far are kept.
+  //
+  // As with fast re-init (EnableFastReInit), only database files opened
+  // via Podd::OpenDBFile are tracked. Event type handlers are not reloaded.
+  // Takes effect at the next Init().
+
+  fHotReload = b;
+  if( !b && !fFastReInit )
+    fModuleInit.clear();
 }
 
 //_____________________________________________________________________________
@@ -267,6 +461,18 @@ void THaAnalyzer::EnableHelicity( Bool_t b )
   fDoHelicity = b;
 }
 
+//_____________________________________________________________________________
+void THaAnalyzer::EnableResume( Bool_t b )
+{
+  // Enable/disable resuming an interrupted analysis from its last
+  // checkpoint (see SetCheckpointFile). If enabled and the checkpoint file
+  // exists, Process() continues the analysis of the run after the
+  // checkpoint. Otherwise, the run is analyzed from the beginning, so the
+  // same job can simply be resubmitted until it completes.
+
+  fDoResume = b;
+}
+
 //_____________________________________________________________________________
 void THaAnalyzer::EnableRunUpdate( Bool_t b )
 {
@@ -297,6 +503,243 @@ void THaAnalyzer::EnableScalers( Bool_t )
   cout << "Warning:: Scalers are handled by event handlers now"<<endl;
 }
 
+//_____________________________________________________________________________
+void THaAnalyzer::EnableParallelApps( Bool_t b )
+{
+  // Enable/disable concurrent processing of apparatuses. When enabled and
+  // more than one thread is set with SetNumThreads(), the apparatuses
+  // (e.g. the left and right HRS) are processed in parallel within each
+  // event, one decoding/tracking/reconstruction stage at a time.
+  // Inter-stage modules, physics modules, tests and output still run
+  // serially after all apparatuses have finished the stage.
+  //
+  // Only use this if no apparatus reads another apparatus's data during
+  // the event, which is the case for the standard Hall A spectrometers.
+  // Must be called before initialization.
+
+  if( fIsInit ) {
+    Warning( "EnableParallelApps", "Analyzer already initialized. "
+             "Close() first, then Init() again for this to take effect." );
+  }
+  fDoParallelApps = b;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EnablePerfSummary( Bool_t b )
+{
+  // Enable/disable writing of a performance summary to the output file at
+  // the end of each Process(), for monitoring throughput across runs.
+  // Two trees are written (see WritePerfSummary):
+  //  "PerfCounters": one entry with the event counters (see PrintCounters)
+  //  "PerfTimers":   one entry per benchmark timer of the analyzer and
+  //                  the decoder, with time, calls and allocation counts
+  // Enables benchmarks, since the timers are needed for the summary.
+  // The counters and stage times are also available as global variables
+  // "anl.*" during the replay, for use in the output definition.
+
+  fDoPerfSummary = b;
+  if( fDoPerfSummary )
+    fDoBench = true;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EnableOnlineMode( Bool_t b )
+{
+  // Enable/disable low-latency online replay, e.g. with THaOnlRun.
+  // In online mode
+  //  - only histograms are filled (see THaOutput::SetHistogramsOnly),
+  //  - events are read ahead in a separate thread (see EnablePipeline),
+  //  - physics events are dropped while the analysis is behind schedule
+  //    (see OnlineDropEvent, SetEventDeadline, SetSampleInterval),
+  //  - instead of event number marks, a status line with the event
+  //    rate, the fraction of dropped events and the read-ahead queue
+  //    occupancy is printed periodically, and the histograms are written
+  //    to a snapshot file, if set (see SetSnapshotFile).
+
+  fOnlineMode = b;
+  THaOutput::SetHistogramsOnly(b);
+  if( b )
+    fDoPipeline = true;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::SetSnapshotFile( const char* name, Double_t interval )
+{
+  // In online mode, write all histograms to the ROOT file 'name' every
+  // 'interval' seconds of wall-clock time, for display by online GUIs.
+  // The status line is printed at the same interval. An empty name
+  // disables snapshots.
+
+  fSnapshotFileName = name;
+  if( interval > 0 )
+    fOnlineInterval = interval;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::SetHistoServer( const char* mapfile, Double_t interval,
+                                  UInt_t size )
+{
+  // Publish the output histograms (see THaOutput) for live monitoring in
+  // the shared memory map file 'mapfile', updated every 'interval' seconds
+  // of wall-clock time while the replay is running. Clients open the map
+  // file with TMapFile::Create(mapfile) and read the histograms with
+  // TMapFile::Get. 'size' is the maximum size of the map file in bytes
+  // (0: Podd::HistoServer::kDefaultSize). An empty name disables live
+  // histograms. Takes effect at the next Process().
+
+  fHistoMapFile = mapfile;
+  if( interval > 0 )
+    fPublishInterval = interval;
+  fHistoMapSize = size;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::SetSampling( Double_t s, ULong64_t seed )
+{
+  // Reconstruct only a sample of the physics events, for quick-look
+  // replays. With s >= 1, every s-th physics event is analyzed (rounded to
+  // the nearest integer), starting with the first. With 0 < s < 1, each
+  // physics event is analyzed with probability s, using random numbers
+  // from 'seed' (reproducible for a given seed). s = 0 or 1 analyzes all
+  // physics events.
+  //
+  // The decision is made before the detectors are decoded, so skipped
+  // events cost little more than reading them. Event type handlers
+  // (scalers, EPICS etc.) still see all events, and apparatuses with
+  // helicity detectors are decoded for every physics event so that
+  // helicity tracking remains intact. Skipped events are counted
+  // separately; the counts of physics events read remain correct.
+
+  if( s < 0 ) {
+    Warning( "SetSampling", "Invalid sampling %lf. Disabling sampling.", s );
+    s = 0;
+  }
+  fSampling = (s >= 1) ? floor(s + 0.5) : s;
+  if( fSampling == 1 )
+    fSampling = 0;
+  fSampleRng = seed ? seed : 0x9E3779B97F4A7C15ULL;
+  fSampleCount = 0;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::SetTriggerSelection( UInt_t mask, Podd::DecData* trigdata )
+{
+  // Analyze only physics events from the triggers in the bit pattern 'mask'
+  // (bit n = trigger n). Other physics events are counted but not analyzed.
+  // mask = 0 analyzes all events (the default).
+  //
+  // The trigger of an event is taken from the trigger bits (TDC channels)
+  // of the decoder data apparatus 'trigdata', e.g. THaDecData with "bit"
+  // channels, or, if 'trigdata' is null or has no trigger bits, from the
+  // CODA event type, which for CODA 2 data equals the trigger number.
+  //
+  // The selection also enables the pre-filter (see EnablePrefilter), so
+  // that it is made before the detectors are decoded: only the crates of
+  // the trigger bit channels are decoded first, and events of unselected
+  // triggers are skipped without decoding the other crates. Apparatuses
+  // with helicity detectors still see every event, as with SetSampling.
+
+  fTrigMask = mask;
+  fTrigData = trigdata;
+  if( mask != 0 )
+    fDoPrefilter = true;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EnablePipeline( Bool_t b )
+{
+  // Enable/disable pipeline mode. In pipeline mode, events are read from
+  // the input in a separate thread, ahead of the analysis, so that file I/O
+  // overlaps with decoding and reconstruction. Currently only supported
+  // for CODA runs.
+
+  fDoPipeline = b;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EnableLazyClear( Bool_t b )
+{
+  // Enable/disable lazy clearing of event data. Normally, Clear() is
+  // called for all analysis modules at the start of each physics event.
+  // With lazy clearing, modules that allow it (see
+  // THaAnalysisObject::SetLazyClear) are instead cleared right before
+  // their first call in the event, e.g. an apparatus at the start of its
+  // Decode(). This skips the up-front pass over all modules, keeps a
+  // module's data in cache between clearing and refilling, and, with
+  // parallel decoding (EnableParallelApps), spreads the clearing over the
+  // worker threads. Takes effect at the next Init().
+
+  fLazyClear = b;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EnablePrefilter( Bool_t b )
+{
+  // Enable/disable the event pre-filter. With the pre-filter, the header of
+  // each event is inspected before the event is decoded (see
+  // THaEvData::PeekEvent), and events that would not be analyzed anyway
+  // are skipped without decoding their ROC data. These are
+  //  - physics events before the first event of the run's event range,
+  //  - physics events not selected by sampling (see SetSampling), unless
+  //    helicity must be decoded for all events,
+  //  - non-physics events for which no event type handler is defined.
+  // Counters are updated as if these events had been decoded and skipped
+  // by the analysis. Event types that change the state of the decoder
+  // (prestart, prescale factors) and EPICS events are always decoded.
+  //
+  // Post-processing modules (e.g. THaFilter) are not called for
+  // pre-filtered events, and the RawDecode test block is not evaluated
+  // for them.
+
+  fDoPrefilter = b;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EnableShardMode( Bool_t b )
+{
+  // Enable/disable shard mode. This is intended for analyzing one part
+  // (shard) of a run, selected with THaRunBase::SetEventRange, in a
+  // separate job, and merging the outputs of all shards afterwards
+  // (see the mergeshards utility).
+  //
+  // In shard mode, events before the first event of the event range are
+  // only read and counted. Unlike in normal mode, they are not passed to
+  // the event type handlers, slow control or other-event analyses or
+  // post-processing. Otherwise, scaler and EPICS data from the beginning
+  // of the run would appear in the output of every shard.
+
+  fDoShard = b;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EnableSkipUnusedPhysics( Bool_t b )
+{
+  // Enable/disable skipping of physics modules whose results are not
+  // needed. A physics module is needed if the output definitions or the
+  // tests/cuts refer to its global variables, or if a needed physics module
+  // depends on it (see SchedulePhysics). Modules whose results are only
+  // used by post-processing modules, event type handlers or user code
+  // would be skipped as well, so this is off by default.
+  // Must be called before the analysis starts.
+
+  fSkipUnused = b;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EnableSkipUnusedVariables( Bool_t b )
+{
+  // Enable/disable skipping the calculation of global variables that are
+  // not read. A variable is read if the output definitions, the tests/cuts
+  // or a module that looks it up in its Init() refer to it. After
+  // initialization, each module is told which of its variables are read
+  // (see THaAnalysisObject::UpdateVariableUsage) and may leave the others
+  // unset. Values that user code reads directly from the variable list or
+  // the module would then be stale, so this is off by default.
+  // Must be called before Init().
+
+  fSkipUnusedVars = b;
+}
+
 //_____________________________________________________________________________
 void THaAnalyzer::EnableSlowControl( Bool_t b )
 {
@@ -312,26 +755,39 @@ bool THaAnalyzer::EvalStage( int n )
   // If event is skipped, increment associated statistics counter.
   // Call InitCuts() before using!  This is an internal function.
 
-  if( fDoBench ) fBench->Begin("Cuts");
-
   const Stage_t& theStage = fStages[n];
 
+  // The stage may have changed the sizes of variable-size arrays
+  // and the values of shared formula subexpressions
+  Podd::Variable::NewEvent();
+  Podd::FormulaProgram::NewEvent();
+
+  // Nothing to do if this stage has no tests
+  if( !theStage.cut_list )
+    return true;
+
+  if( fDoBench ) fBench->Start(kBenchCuts);
+
   //FIXME: support stage-wise blocks of histograms
   //  if( theStage.hist_list ) {
     // Fill histograms
   //  }
 
   bool ret = true;
-  if( theStage.cut_list ) {
-    THaCutList::EvalBlock( theStage.cut_list );
-    if( theStage.master_cut &&
-	!theStage.master_cut->GetResult() ) {
-      if( theStage.countkey >= 0 ) // stage may not have a counter
-	Incr(theStage.countkey);
-      ret = false;
-    }
+  if( THaCut::IsLazyEval() && theStage.master_cut ) {
+    // Evaluate only the master cut. Any cuts it depends on are evaluated
+    // on demand, skipping those that cannot affect the outcome.
+    if( !theStage.master_cut->IsEvaluated() )
+      theStage.master_cut->EvalCut();
+  } else
+    THaCutList::EvalBlock( theStage.cuts );
+  if( theStage.master_cut &&
+      !theStage.master_cut->GetResult() ) {
+    if( theStage.countkey >= 0 ) // stage may not have a counter
+      Incr(theStage.countkey);
+    ret = false;
   }
-  if( fDoBench ) fBench->Stop("Cuts");
+  if( fDoBench ) fBench->Stop(kBenchCuts);
   return ret;
 }
 
@@ -365,6 +821,10 @@ void THaAnalyzer::InitStages()
     {kReconstruct, kReconstructTest, "Reconstruct"},
     {kPhysics,     kPhysicsTest,     "Physics"}
   };
+  // Timers for the stages. The predefined stages reuse the timers
+  // registered in the constructor.
+  for( auto& theStage : fStages )
+    theStage.bench = fBench->Register(theStage.name, kBenchTotal);
 }
 
 //_____________________________________________________________________________
@@ -373,26 +833,31 @@ void THaAnalyzer::InitCounters() {
   // See notes for InitStages() for additional information.
 
   if( !fCounters.empty() ) return;
-  fCounters.reserve(kPhysicsTest - kNevRead + 1);
+  fCounters.reserve(kNevTrigSkipped - kNevRead + 1);
   fCounters = {
-    {kNevRead,         "events read"},
-    {kNevGood,         "events decoded"},
-    {kNevPhysics,      "physics events"},
-    {kNevEpics,        "slow control events"},
-    {kNevOther,        "other event types"},
-    {kNevPostProcess,  "events post-processed"},
-    {kNevAnalyzed,     "physics events analyzed"},
-    {kNevAccepted,     "events accepted"},
-    {kDecodeErr,       "decoding error"},
-    {kCodaErr,         "CODA errors"},
-    {kRawDecodeTest,   "skipped after raw decoding"},
-    {kDecodeTest,      "skipped after Decode"},
-    {kCoarseTrackTest, "skipped after Coarse Tracking"},
-    {kCoarseReconTest, "skipped after Coarse Reconstruct"},
-    {kTrackTest,       "skipped after Tracking"},
-    {kReconstructTest, "skipped after Reconstruct"},
-    {kPhysicsTest,     "skipped after Physics"}
+    {kNevRead,         "nev.read",         "events read"},
+    {kNevGood,         "nev.good",         "events decoded"},
+    {kNevPhysics,      "nev.physics",      "physics events"},
+    {kNevEpics,        "nev.epics",        "slow control events"},
+    {kNevOther,        "nev.other",        "other event types"},
+    {kNevPostProcess,  "nev.postproc",     "events post-processed"},
+    {kNevAnalyzed,     "nev.analyzed",     "physics events analyzed"},
+    {kNevAccepted,     "nev.accepted",     "events accepted"},
+    {kDecodeErr,       "err.decode",       "decoding error"},
+    {kCodaErr,         "err.coda",         "CODA errors"},
+    {kRawDecodeTest,   "skip.rawdecode",   "skipped after raw decoding"},
+    {kDecodeTest,      "skip.decode",      "skipped after Decode"},
+    {kCoarseTrackTest, "skip.coarsetrack", "skipped after Coarse Tracking"},
+    {kCoarseReconTest, "skip.coarserecon", "skipped after Coarse Reconstruct"},
+    {kTrackTest,       "skip.track",       "skipped after Tracking"},
+    {kReconstructTest, "skip.reconstruct", "skipped after Reconstruct"},
+    {kPhysicsTest,     "skip.physics",     "skipped after Physics"},
+    {kNevDropped,      "nev.dropped",      "physics events dropped (online mode)"},
+    {kNevSampled,      "nev.sampled",      "physics events skipped by sampling"},
+    {kNevPrefiltered,  "nev.prefiltered",  "events skipped without decoding (pre-filter)"},
+    {kNevTrigSkipped,  "nev.trigskipped",  "physics events skipped by trigger selection"}
   };
+  fCounterShards.Resize(fCounters.size());
 }
 
 //_____________________________________________________________________________
@@ -402,19 +867,61 @@ void THaAnalyzer::InitCuts()
   //
   // - Find pointers to the THaNamedList lists that hold the cut blocks.
   // - find pointer to each block's master cut
+  // - cache each block's cuts in a vector for evaluation in the event loop
 
   for( auto& theStage : fStages ) {
     // If block not found, this will return nullptr and work just fine later.
-    theStage.cut_list = gHaCuts->FindBlock( theStage.name );
+    theStage.cut_list = fContext->GetCuts()->FindBlock( theStage.name );
 
     if( theStage.cut_list ) {
       TString master_cut( theStage.name );
       master_cut.Append( '_' );
       master_cut.Append( kMasterCutName );
-      theStage.master_cut = gHaCuts->FindCut( master_cut );
+      theStage.master_cut = fContext->GetCuts()->FindCut( master_cut );
     } else
       theStage.master_cut = nullptr;
+    THaCutList::GetBlockCuts( theStage.cut_list, theStage.cuts );
+  }
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::InitThreads()
+{
+  // Set up multithreading as requested with SetNumThreads() and
+  // SetOutputThreads().
+  //
+  // The event loop itself is still serial since all modules share the
+  // global variable and cut lists. The worker threads are handed to ROOT's
+  // implicit multithreading, which compresses and writes the baskets of the
+  // output tree in parallel with the analysis of the following events.
+  // With EnableParallelApps(), a pool of fNThreads-1 additional threads
+  // processes the apparatuses of each event concurrently.
+
+  UInt_t nthreads = std::max(fNThreads, fOutThreads);
+  if( nthreads <= 1 )
+    return;
+  if( fDoParallelApps && fNThreads > 1 && !fTaskPool ) {
+    ROOT::EnableThreadSafety();
+    fTaskPool = new Podd::TaskPool(fNThreads-1);
+    fTaskPool->SetCpuAffinity(fCpuSet);
+    if( fVerbose>1 )
+      cout << "Processing apparatuses with up to " << fNThreads
+           << " threads" << endl;
   }
+#if defined(R__USE_IMT) && ROOT_VERSION_CODE >= ROOT_VERSION(6,10,0)
+  if( !ROOT::IsImplicitMTEnabled() ) {
+    ROOT::EnableImplicitMT(nthreads);
+    if( fVerbose>1 )
+      cout << "Enabled implicit multithreading with "
+           << ROOT::GetImplicitMTPoolSize() << " threads" << endl;
+  }
+#else
+  Warning( "InitThreads", "ROOT was built without multithreading support. "
+           "Ignoring request for %u threads.", nthreads );
+  fNThreads = 1;
+  if( fOutThreads > 1 )
+    fOutThreads = 1;
+#endif
 }
 
 //_____________________________________________________________________________
@@ -428,18 +935,48 @@ Int_t THaAnalyzer::InitModules(
   static const char* const here = "InitModules()";
 
   Int_t retval = 0;
+  fNReInit = 0;
+  const bool record = fFastReInit || fHotReload;
+  if( fNThreads > 1 )
+    PreloadDatabase(module_list, run_time);
   for( auto it = module_list.begin(); it != module_list.end(); ) {
     auto* theModule = *it;
+    // With fast re-init, skip modules whose database inputs are unchanged
+    auto rec = fModuleInit.find(theModule);
+    if( fReuseInit && rec != fModuleInit.end() && theModule->IsOK() &&
+        Podd::DBFilesUnchanged(rec->second.files, rec->second.date,
+                               run_time) ) {
+      if( fVerbose>1 )
+        cout << "Module " << theModule->GetName()
+             << ": database unchanged, not re-initialized" << endl;
+      ++it;
+      continue;
+    }
+    if( rec != fModuleInit.end() )
+      fModuleInit.erase(rec);
+    ++fNReInit;
+    if( record )
+      Podd::StartDBFileRecording();
     try {
-      retval = theModule->Init( run_time );
+      retval = theModule->Init( run_time, fContext );
     }
     catch( exception& e ) {
+      if( record )
+        Podd::StopDBFileRecording();
       Error(here, "Exception %s caught during initialization of module "
 	     "%s (%s). Analyzer initialization failed.",
             e.what(), theModule->GetName(), theModule->GetTitle() );
       retval = -1;
       goto errexit;
     }
+    if( record ) {
+      auto files = Podd::StopDBFileRecording();
+      if( retval == kOK && theModule->IsOK() ) {
+        ModuleInit_t& init = fModuleInit[theModule];
+        init.date = run_time;
+        init.files = std::move(files);
+      }
+    }
     if( retval != kOK || !theModule->IsOK() ) {
       Error( here, "Error %d initializing module %s (%s). "
              "Analyzer initialization failed.",
@@ -454,6 +991,47 @@ Int_t THaAnalyzer::InitModules(
   return retval;
 }
 
+//_____________________________________________________________________________
+void THaAnalyzer::PreloadDatabase(
+  const std::vector<THaAnalysisObject*>& module_list, const TDatime& run_time )
+{
+  // Read and parse the database files of the modules in 'module_list' in
+  // parallel, using the number of threads set with SetNumThreads().
+  // The modules themselves are still initialized one at a time, since
+  // defining global variables and other initialization steps are not
+  // thread-safe, but their database lookups are then served from memory.
+  // Only the standard file names are preloaded (db_<prefix>dat for each
+  // module and each detector of an apparatus), plus any files the modules
+  // have read in an earlier initialization, if fast re-init is enabled.
+
+  vector<string> names;
+  for( auto* theModule : module_list ) {
+    names.emplace_back(theModule->GetDBFileName());
+    if( auto* app = dynamic_cast<THaApparatus*>(theModule) ) {
+      TIter next(app->GetDetectors());
+      while( auto* det = static_cast<THaDetector*>(next()) ) {
+        // Detector prefixes are set up only when the detector is initialized
+        const char* prefix = det->GetPrefix();
+        string name = (prefix && *prefix) ? det->GetDBFileName()
+          : string(app->GetName()) + "." + det->GetName() + ".";
+        names.push_back(std::move(name));
+      }
+    }
+    auto rec = fModuleInit.find(theModule);
+    if( rec != fModuleInit.end() ) {
+      for( const auto& file : rec->second.files )
+        names.push_back(file.name);
+    }
+  }
+  names.erase(remove_if(names.begin(), names.end(),
+                        []( const string& name ) { return name.empty(); }),
+              names.end());
+  Int_t n = Podd::PreloadDBFiles(names, run_time, fNThreads);
+  if( fVerbose>1 )
+    cout << "Preloaded " << n << " database files using "
+         << fNThreads << " threads" << endl;
+}
+
 //_____________________________________________________________________________
 Int_t THaAnalyzer::Init( THaRunBase* run )
 {
@@ -462,15 +1040,18 @@ Int_t THaAnalyzer::Init( THaRunBase* run )
   // This is a wrapper so we can conveniently control the benchmark counter
   if( !run ) return -1;
 
-  if( !fIsInit ) fBench->Reset();
-  fBench->Begin("Total");
+  if( !fIsInit ) {
+    fBench->Reset();
+    fEvLatency->Clear();
+  }
+  fBench->Start(kBenchTotal);
 
-  if( fDoBench ) fBench->Begin("Init");
+  if( fDoBench ) fBench->Start(kBenchInit);
   Int_t retval = DoInit( run );
-  if( fDoBench ) fBench->Stop("Init");
+  if( fDoBench ) fBench->Stop(kBenchInit);
 
   // Stop "Total" counter since Init() may be called separately from Process()
-  fBench->Stop("Total");
+  fBench->Stop(kBenchTotal);
   return retval;
 }
 
@@ -482,6 +1063,10 @@ Int_t THaAnalyzer::DoInit( THaRunBase* run )
   static const char* const here = "Init";
   Int_t retval = 0;
 
+  // Pin the event loop before the decoder and output buffers are allocated
+  // so that they are placed in the memory of its NUMA node
+  SetThreadAffinity(fCpuSet);
+
   //--- Open the output file if necessary so that Trees and Histograms
   //    are created on disk.
 
@@ -523,12 +1108,16 @@ Int_t THaAnalyzer::DoInit( THaRunBase* run )
     Close();
     return -10;
   }
+  if( fCompressAlgo > 0 )
+    fFile->SetCompressionAlgorithm(fCompressAlgo);
   fFile->SetCompressionLevel(fCompress);
 
   // Set up the analysis stages and allocate counters.
   if( !fIsInit ) {
     InitStages();
     InitCounters();
+    InitThreads();
+    DefinePerfVariables();
   }
 
   // Allocate the event structure.
@@ -646,9 +1235,9 @@ Int_t THaAnalyzer::DoInit( THaRunBase* run )
     *fRun = *run;  // Copy the run via its virtual operator=
   }
 
-  // Make the current run available globally - the run parameters are
-  // needed by some modules
-  gHaRun = fRun;
+  // Make the current run available to the modules via our context (by
+  // default, this sets gHaRun) - the run parameters are needed by some modules
+  fContext->SetRun(fRun);
 
   // Print run info
   if( fVerbose>0 ) {
@@ -669,7 +1258,18 @@ Int_t THaAnalyzer::DoInit( THaRunBase* run )
 
   // Tell the decoder the run time. This will trigger decoder
   // initialization (reading of crate map data etc.)
+  if( fHotReload )
+    Podd::StartDBFileRecording();
   fEvData->SetRunTime( run_time.Convert());
+  if( fHotReload ) {
+    // Nothing is read if the run time is unchanged. The old record is
+    // then still valid.
+    auto files = Podd::StopDBFileRecording();
+    if( !files.empty() ) {
+      fCrateMapFiles = std::move(files);
+      fCrateMapDate = run_time;
+    }
+  }
 
   // Tell the decoder about the run's CODA version
   fEvData->SetDataVersion( run->GetDataVersion() );
@@ -691,22 +1291,38 @@ Int_t THaAnalyzer::DoInit( THaRunBase* run )
   modulesToInit.insert(modulesToInit.end(), ALL(fPhysics));
   modulesToInit.insert(modulesToInit.end(), ALL(fEvtHandlers));
   modulesToInit.insert(modulesToInit.end(), ALL(fInterStage));
+  fReuseInit = ( fFastReInit && fIsInit && !new_event && !new_output &&
+                 !new_decoder );
   retval = InitModules(modulesToInit, run_time);
-  if( retval == 0 ) {
+  fReuseInit = false;
+  // If no module had to be re-initialized, all global variables are
+  // unchanged, so cuts and output need not be set up again
+  bool reuse_all = ( fFastReInit && fIsInit && fNReInit == 0 &&
+                     !new_output && fCutFileName == fLoadedCutFileName );
+  if( retval == 0 && reuse_all ) {
+    if( fVerbose>0 )
+      cout << "Database unchanged for all modules, reusing previous "
+              "initialization" << endl;
+    for( auto* obj : fPostProcess) {
+      retval = obj->Init(run_time);
+      if( retval != 0 )
+        break;
+    }
+  } else if( retval == 0 ) {
 
     // Set up cuts here, now that all global variables are available
     if( fCutFileName.IsNull() ) {
       // No test definitions -> make sure list is clear
-      gHaCuts->Clear();
+      fContext->GetCuts()->Clear();
       fLoadedCutFileName = "";
     } else {
       if( fCutFileName != fLoadedCutFileName ) {
 	// New test definitions -> load them
-	gHaCuts->Load( fCutFileName );
+	fContext->GetCuts()->Load( fCutFileName );
 	fLoadedCutFileName = fCutFileName;
       }
       // Ensure all tests are up-to-date. Global variables may have changed.
-      gHaCuts->Compile();
+      fContext->GetCuts()->Compile();
     }
     // Initialize local pointers to test blocks and master cuts
     InitCuts();
@@ -728,9 +1344,15 @@ Int_t THaAnalyzer::DoInit( THaRunBase* run )
       // If initialized ok, but not re-initialized, make a branch for
       // the event structure in the output tree
       TTree* outputTree = fOutput->GetTree();
-      if( outputTree )
+      if( outputTree ) {
 	outputTree->Branch( "Event_Branch", fEvent->IsA()->GetName(),
 			    &fEvent, 16000, 99 );
+#if defined(R__USE_IMT) && ROOT_VERSION_CODE >= ROOT_VERSION(6,10,0)
+        // Compress baskets in parallel unless serial output was requested
+        if( fOutThreads == 1 )
+          outputTree->SetImplicitMT(false);
+#endif
+      }
     }
     olddir->cd();
 
@@ -742,7 +1364,7 @@ Int_t THaAnalyzer::DoInit( THaRunBase* run )
     }
   }
 
-  if ( retval == 0 ) {
+  if ( retval == 0 && !reuse_all ) {
     if ( ! fOutput ) {
       Error( here, "Error initializing THaOutput for objects(again!)" );
       retval = -5;
@@ -751,11 +1373,19 @@ Int_t THaAnalyzer::DoInit( THaRunBase* run )
       // complex output directly to the TTree
       retval = InitOutput(modulesToInit);
     }
+    if( retval == 0 ) {
+      // All consumers of global variables are set up now. Let the
+      // modules know which of their variables are read.
+      fContext->GetVars()->SetUsageKnown(fSkipUnusedVars);
+      for( auto* theModule : modulesToInit )
+        theModule->UpdateVariableUsage();
+    }
   }
 
   // If initialization succeeded, set status flags accordingly
   if( retval == 0 ) {
     fIsInit = true;
+    CheckMemoryBudget(here);
   }
   return retval;
 }
@@ -789,17 +1419,27 @@ Int_t THaAnalyzer::ReadOneEvent()
   // Read one event from current run (fRun) and raw-decode it using the
   // current decoder (fEvData)
 
-  if( fDoBench ) fBench->Begin("RawDecode");
+  // Between events, pick up changed database files, if enabled
+  if( fHotReload && !fEvData->DataCached() && HotReload() < 0 )
+    return THaRunBase::READ_FATAL;
+
+  if( fDoEvTiming ) StartEventTiming();
+  if( fDoBench ) fBench->Start(kBenchRawDecode);
 
   // Find next event buffer in CODA file. Quit if error.
   Int_t status = THaRunBase::READ_OK;
   if( !fEvData->DataCached() )
-    status = fRun->ReadEvent();
+    status = fEvQueue ? fEvQueue->Next() : fRun->ReadEvent();
 
+  fEvSkipped = fSampleKeep = fTrigKeep = false;
   switch( status ) {
-  case THaRunBase::READ_OK:
-    // Decode the event
-    status = fEvData->LoadEvent( fRun->GetEvBuffer() );
+  case THaRunBase::READ_OK: {
+    // Decode the event, unless the pre-filter finds it is not needed
+    const UInt_t* evbuffer = fEvQueue ? fEvQueue->GetEvBuffer()
+                                      : fRun->GetEvBuffer();
+    fEvSkipped = ( fDoPrefilter && PrefilterEvent(evbuffer) );
+    status = fEvSkipped ? fEvData->SkipEvent(evbuffer)
+                        : fEvData->LoadEvent(evbuffer);
     switch( status ) {
     case THaEvData::HED_OK:     // fall through
     case THaEvData::HED_WARN:
@@ -821,20 +1461,168 @@ Int_t THaAnalyzer::ReadOneEvent()
       break;
     }
     break;
-
+  }
   case THaRunBase::READ_EOF:    // fall through
   case THaRunBase::READ_FATAL:
     // Just exit on EOF - don't count it
     break;
+  case THaRunBase::READ_EMPTY:
+    // Non-blocking online read found no data yet - not an error
+    break;
   default:
     Incr(kCodaErr);
     break;
   }
 
-  if( fDoBench ) fBench->Stop("RawDecode");
+  if( fDoBench ) fBench->Stop(kBenchRawDecode);
   return status;
 }
 
+//_____________________________________________________________________________
+Int_t THaAnalyzer::StartPipeline()
+{
+  // Start the read-ahead thread for the current run if pipeline mode
+  // is enabled. The run must be open.
+
+  if( !fDoPipeline || fEvQueue )
+    return 0;
+  if( !dynamic_cast<THaCodaRun*>(fRun) ) {
+    Warning( "StartPipeline", "Pipeline mode is only supported for "
+             "CODA runs. Reading events sequentially." );
+    return 0;
+  }
+  fEvQueue = new EventQueue( std::max<UInt_t>(EventQueue::kDefaultDepth, 2*fBatchSize),
+                             fBatchSize );
+  if( fEvQueue->Start(fRun) != 0 ) {
+    Error( "StartPipeline", "Failed to start read-ahead thread" );
+    delete fEvQueue; fEvQueue = nullptr;
+    return -1;
+  }
+  fEvQueue->SetCpuAffinity(fCpuSet);
+  if( fVerbose>1 ) {
+    cout << "Pipeline mode: reading up to " << fEvQueue->GetDepth()
+         << " events ahead";
+    if( fEvQueue->GetBatchSize() > 1 )
+      cout << " in batches of " << fEvQueue->GetBatchSize();
+    cout << endl;
+  }
+  return 0;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::StopPipeline()
+{
+  // Stop the read-ahead thread, if any. Must be called before the run
+  // is closed.
+
+  delete fEvQueue; fEvQueue = nullptr;
+}
+
+//_____________________________________________________________________________
+Int_t THaAnalyzer::StartEvtThread()
+{
+  // Start the thread for asynchronous event type handlers if any handler
+  // requests it (see THaEvtTypeHandler::SetAsync). The thread uses its own
+  // instance of the decoder, set up like fEvData.
+
+  static const char* const here = "StartEvtThread";
+
+  delete fEvtThread; fEvtThread = nullptr;
+  bool want = any_of(ALL(fEvtHandlers), [this]( THaEvtTypeHandler* h ) {
+    return h->IsAsync() && h != fEpicsHandler && h->GetNumTypes() > 0;
+  });
+  if( !want )
+    return 0;
+  auto* decoder = static_cast<THaEvData*>(fEvData->IsA()->New());
+  if( !decoder ) {
+    Warning( here, "Failed to create decoder for asynchronous event type "
+             "handlers. Running them in the main event loop." );
+    return -1;
+  }
+  decoder->SetRunTime(fRun->GetDate().Convert());
+  decoder->SetDataVersion(fRun->GetDataVersion());
+  decoder->EnableHelicity(false);
+  if( fEpicsHandler && fEpicsHandler->GetNumTypes() > 0 )
+    decoder->SetEpicsEvtType(fEpicsHandler->GetEvtType());
+  fEvtThread = new EvtHandlerThread(decoder);
+  fEvtThread->SetCpuAffinity(fCpuSet);
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t THaAnalyzer::StartHistoServer()
+{
+  // Start publishing live histograms if requested (see SetHistoServer)
+
+  StopHistoServer();
+  if( fHistoMapFile.IsNull() || !fOutput )
+    return 0;
+  vector<TH1*> histos;
+  fOutput->GetHistograms(histos);
+  fHistoServer = new HistoServer(fHistoMapFile, fHistoMapSize > 0 ?
+                                 fHistoMapSize : HistoServer::kDefaultSize);
+  if( fHistoServer->Start(histos) != 0 ) {
+    Warning( "StartHistoServer", "Cannot publish live histograms in %s",
+             fHistoMapFile.Data() );
+    delete fHistoServer; fHistoServer = nullptr;
+    return -1;
+  }
+  if( fVerbose>1 )
+    cout << "Publishing " << histos.size() << " live histograms in "
+         << fHistoMapFile << endl;
+  return 0;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::StopHistoServer()
+{
+  // Stop publishing live histograms
+
+  delete fHistoServer; fHistoServer = nullptr;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::PublishHistos( Bool_t force )
+{
+  // Publish the current histogram contents for live monitoring every
+  // fPublishInterval seconds, or now if 'force' is set
+
+  if( !fHistoServer )
+    return;
+  Double_t now = WallTime();
+  if( !force && now - fOnline.lastpublish < fPublishInterval )
+    return;
+  vector<TH1*> histos;
+  fOutput->GetHistograms(histos);
+  if( fHistoServer->Publish(histos) != 0 ) {
+    Warning( "PublishHistos", "Failed to publish live histograms. "
+             "Disabling." );
+    StopHistoServer();
+  }
+  fOnline.lastpublish = now;
+}
+
+//_____________________________________________________________________________
+Int_t THaAnalyzer::StopEvtThread()
+{
+  // Finish processing of events queued for the asynchronous event type
+  // handlers and stop their thread. Returns -1 if a handler failed.
+
+  if( !fEvtThread )
+    return 0;
+  Int_t ret = 0;
+  try {
+    fEvtThread->Drain();
+  }
+  catch( exception& e ) {
+    Error( "StopEvtThread", "Caught exception %s in asynchronous event "
+           "type handler.", e.what() );
+    ret = -1;
+  }
+  delete fEvtThread; fEvtThread = nullptr;
+  return ret;
+}
+
 //_____________________________________________________________________________
 void THaAnalyzer::SetEpicsEvtType(Int_t itype)
 {
@@ -868,6 +1656,91 @@ Int_t THaAnalyzer::SetCountMode( Int_t mode )
   return mode;
 }
 
+//_____________________________________________________________________________
+void THaAnalyzer::SetNumThreads( UInt_t n )
+{
+  // Set number of threads to use for the analysis. 0 or 1 selects the
+  // standard single-threaded replay. Must be called before initialization.
+
+  if( fIsInit ) {
+    Warning( "SetNumThreads", "Analyzer already initialized. "
+             "Close() first, then Init() again for this to take effect." );
+  }
+  fNThreads = (n > 0) ? n : 1;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::SetBatchSize( UInt_t n )
+{
+  // Set the number of events handed over at once between the read-ahead
+  // thread and the event loop in pipeline mode (see EnablePipeline and
+  // Podd::EventQueue). The default is 1. Larger values reduce the
+  // synchronization overhead per event at high rates, at the cost of
+  // latency in online replays. Takes effect at the next Process().
+
+  fBatchSize = std::max(n, 1U);
+}
+
+//_____________________________________________________________________________
+Int_t THaAnalyzer::SetCpuAffinity( const char* cpus )
+{
+  // Restrict the analysis threads to the CPUs 'cpus', given as a list like
+  // "0-15,32-47" or as "node<N>" for the CPUs of NUMA node N (Linux only).
+  // An empty string removes the restriction for threads created later.
+  //
+  // On multi-socket machines, running one replay per socket with the CPUs
+  // of that socket keeps each replay's memory local: the event loop, the
+  // read-ahead thread (EnablePipeline), the apparatus worker threads
+  // (EnableParallelApps) and the asynchronous event type handler thread
+  // are all pinned, and the decoder, event buffers and module data they
+  // allocate are placed on the memory of their node on first touch.
+  // ROOT's implicit multithreading pool used for output compression is
+  // not affected. Must be called before Init(). Returns 0 on success.
+
+  fCpuSet.clear();
+  if( !cpus || !*cpus )
+    return 0;
+  if( Podd::ParseCpuList(cpus, fCpuSet) != 0 ) {
+    Error( "SetCpuAffinity", "Invalid CPU specification \"%s\". Ignored.",
+           cpus );
+    return -1;
+  }
+  return 0;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::SetOutputThreads( UInt_t n )
+{
+  // Set number of threads to use for compressing the output tree.
+  // 0 (default) uses the number of threads set with SetNumThreads().
+  // 1 forces serial compression even if more threads are available.
+  // The compression algorithm can be selected with SetCompressionAlgorithm,
+  // e.g. 1 = ZLIB, 2 = LZMA, 4 = LZ4, 5 = ZSTD (ROOT 6.20+), 0 = default.
+  // Must be called before initialization.
+
+  if( fIsInit ) {
+    Warning( "SetOutputThreads", "Analyzer already initialized. "
+             "Close() first, then Init() again for this to take effect." );
+  }
+  fOutThreads = n;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::SetContext( Podd::AnalysisContext* context )
+{
+  // Set the context (lists of global variables and cuts, current run)
+  // that this analyzer and its modules use. nullptr selects the default
+  // context, i.e. gHaVars, gHaCuts and gHaRun. The context is not owned
+  // and must outlive this analyzer and all its modules.
+  // Must be called before initialization.
+
+  if( fIsInit ) {
+    Error( "SetContext", "Analyzer already initialized. Close() first." );
+    return;
+  }
+  fContext = context ? context : &Podd::AnalysisContext::GetDefault();
+}
+
 //_____________________________________________________________________________
 void THaAnalyzer::SetCrateMapFileName( const char* name )
 {
@@ -887,10 +1760,112 @@ void THaAnalyzer::Print( Option_t* ) const
   //FIXME: preliminary
   if( fRun )
     fRun->Print();
+  if( fNThreads > 1 )
+    cout << "Number of threads: " << fNThreads << endl;
+  if( fOutThreads > 0 )
+    cout << "Output compression threads: " << fOutThreads << endl;
+  if( fTaskPool )
+    cout << "Parallel apparatus processing enabled" << endl;
+  if( fFastReInit )
+    cout << "Fast re-initialization enabled" << endl;
+  if( fHotReload )
+    cout << "Hot reload of database files enabled, checking every "
+         << fReloadInterval << " s" << endl;
+  if( Podd::ProfMarkers::IsAvailable() )
+    cout << "External profiler markers: " << Podd::ProfMarkers::GetBackend()
+         << (fDoBench ? "" : " (enable benchmarks to emit them)") << endl;
+  if( fIsInit )
+    PrintMemoryUsage();
 }
 
 //_____________________________________________________________________________
-void THaAnalyzer::PrintCounters() const
+namespace {
+struct MemUsage_t {
+  TString     name;   // Prefix or name of the object
+  const char* cls;    // Class name
+  size_t      bytes;  // Memory held (bytes)
+};
+}
+
+//_____________________________________________________________________________
+static size_t CollectMemoryUsage( const THaOutput* output,
+                                  const THaEvData* evdata,
+                                  vector<MemUsage_t>& usage )
+{
+  // Fill 'usage' with the memory held by all analysis objects, the output
+  // and the decoder's slot data, largest first. Returns the total.
+
+  usage.clear();
+  if( const TList* modules = THaAnalysisObject::GetModules() ) {
+    TIter next(modules);
+    while( auto* obj = static_cast<THaAnalysisObject*>(next()) ) {
+      TString name = obj->GetPrefix() ? obj->GetPrefixName() : obj->GetName();
+      usage.push_back({name, obj->ClassName(), obj->GetMemoryUsage()});
+    }
+  }
+  if( output )
+    usage.push_back({"output", "THaOutput", output->GetMemoryUsage()});
+  if( evdata )
+    usage.push_back({"decoder", evdata->ClassName(), evdata->GetCapacity()});
+
+  sort(ALL(usage), []( const MemUsage_t& a, const MemUsage_t& b ) {
+    return a.bytes > b.bytes;
+  });
+  size_t total = 0;
+  for( const auto& u : usage )
+    total += u.bytes;
+  return total;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::PrintMemoryUsage() const
+{
+  // Print the approximate memory held by each analysis object, the output
+  // buffers and histograms, and the decoder's slot data, largest first.
+  // Per-event arrays grow to their high-water mark during the first events,
+  // so the report is most useful after some events have been analyzed.
+
+  vector<MemUsage_t> usage;
+  size_t total = CollectMemoryUsage(fOutput, fEvData, usage);
+  cout << "Memory held by analysis objects (approximate):" << endl;
+  for( const auto& u : usage ) {
+    cout << "  " << left << setw(24) << u.name << setw(24) << u.cls
+         << right << setw(12) << u.bytes << " bytes" << endl;
+  }
+  cout << "  Total " << total << " bytes";
+  if( fMemBudget > 0 )
+    cout << " (budget " << fMemBudget << " bytes)";
+  cout << endl;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::CheckMemoryBudget( const char* here ) const
+{
+  // Warn if the analysis objects hold more memory than the budget set with
+  // SetMemoryBudget. The budget is a soft limit; the analysis continues.
+
+  if( fMemBudget == 0 )
+    return;
+
+  vector<MemUsage_t> usage;
+  size_t total = CollectMemoryUsage(fOutput, fEvData, usage);
+  if( total <= fMemBudget )
+    return;
+
+  ostringstream largest;
+  for( size_t i = 0; i < usage.size() && i < 3; ++i ) {
+    if( i > 0 ) largest << ", ";
+    largest << usage[i].name << " (" << usage[i].bytes << ")";
+  }
+  Warning( here, "Analysis objects hold %lu bytes, more than the memory "
+           "budget of %llu bytes. Largest: %s. See Print() for details.",
+           static_cast<unsigned long>(total),
+           static_cast<unsigned long long>(fMemBudget),
+           largest.str().c_str() );
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::PrintCounters() const
 {
   // Print statistics counters
   UInt_t w = 0;
@@ -912,6 +1887,22 @@ void THaAnalyzer::PrintCounters() const
       cout << setw(w) << GetCount(i) << "  " << text << endl;
     }
   }
+
+  // Heap allocations per call of each stage
+  if( fDoAllocStats ) {
+    cout << "Allocation summary (per call):" << endl;
+    for( UInt_t h = kBenchRawDecode; h <= kBenchPostProcess; ++h ) {
+      ULong64_t ncalls = fBench->GetNCalls(h);
+      if( ncalls == 0 )
+        continue;
+      cout << "  " << left << setw(18) << fBench->GetName(h) << right
+           << fixed << setprecision(1)
+           << setw(10) << static_cast<Double_t>(fBench->GetNAllocs(h))/ncalls
+           << " allocs  "
+           << setw(12) << static_cast<Double_t>(fBench->GetAllocBytes(h))/ncalls
+           << " bytes" << defaultfloat << endl;
+    }
+  }
 }
 
 //_____________________________________________________________________________
@@ -932,10 +1923,10 @@ void THaAnalyzer::PrintCutSummary() const
   // Only print to screen if fVerbose>1, but always print to
   // the summary file if a summary file is requested.
 
-  if( gHaCuts->GetSize() > 0 ) {
+  if( fContext->GetCuts()->GetSize() > 0 ) {
     cout << "Cut summary:" << endl;
     if( fVerbose>1 )
-      gHaCuts->Print("STATS");
+      fContext->GetCuts()->Print("STATS");
     if( fSummaryFileName.Length() > 0 ) {
       ofstream ostr(fSummaryFileName);
       if( ostr ) {
@@ -946,7 +1937,7 @@ void THaAnalyzer::PrintCutSummary() const
 	cout << "Cut Summary for run " << fRun->GetNumber()
 	     << " completed " << now.AsString()
 	     << endl << endl;
-	gHaCuts->Print("STATS");
+	fContext->GetCuts()->Print("STATS");
 	cout.rdbuf(cout_buf);
 	ostr.close();
       }
@@ -994,9 +1985,17 @@ Int_t THaAnalyzer::PhysicsAnalysis( Int_t code )
   if( code != kOK )
     return code;
 
-  //--- Skip physics events until we reach the first requested event
-  if( fNev < fRun->GetFirstEvent() )
+  //--- Skip physics events until we reach the first requested event.
+  //    When resuming, keep helicity tracking intact up to the checkpoint.
+  if( fNev < fRun->GetFirstEvent() ) {
+    if( fResumeNev > 0 && fNev <= fResumeNev ) {
+      for( auto* app : fSampleExempt ) {
+        app->Clear();
+        app->Decode(*fEvData);
+      }
+    }
     return kSkip;
+  }
 
   if( fFirstPhysics ) {
     fFirstPhysics = false;
@@ -1004,6 +2003,25 @@ Int_t THaAnalyzer::PhysicsAnalysis( Int_t code )
       cout << "Starting physics analysis at event " << GetCount(kNevPhysics)
 	   << endl;
   }
+  //--- Skip events of unselected triggers (see SetTriggerSelection)
+  if( fTrigMask != 0 && !fTrigKeep && !TriggerSelected(fEvData->GetEvType()) ) {
+    Incr(kNevTrigSkipped);
+    for( auto* app : fSampleExempt ) {
+      app->Clear();
+      app->Decode(*fEvData);
+    }
+    return kSkip;
+  }
+  //--- In sampling mode, decode only helicity information of skipped events
+  if( fSampling > 0 && !fSampleKeep && !SampleEvent() ) {
+    Incr(kNevSampled);
+    for( auto* app : fSampleExempt ) {
+      app->Clear();
+      app->Decode(*fEvData);
+    }
+    return kSkip;
+  }
+
   // Update counters
   fRun->IncrNumAnalyzed();
   Incr(kNevAnalyzed);
@@ -1011,27 +2029,19 @@ Int_t THaAnalyzer::PhysicsAnalysis( Int_t code )
   //--- Process all apparatuses that are defined in fApps
   //    First Decode(), then Reconstruct()
 
-  const char* stage = "";
+  Int_t stage = kDecode;
   THaAnalysisObject* obj = nullptr;  // current module, for exception error message
 
   try {
-    stage = "Decode";
-    if( fDoBench ) fBench->Begin(stage);
-    for( auto* mod : fAnalysisModules ) {
+    stage = kDecode;
+    if( fDoBench ) fBench->Start(fStages[stage].bench);
+    ++fClearGen;
+    for( auto* mod : fEagerClear ) {
       obj = mod;
       mod->Clear();
     }
-    for( auto* app : fApps ) {
-      obj = app;
-      app->Decode(*fEvData);
-    }
-    for( auto* mod : fInterStage ) {
-      if( mod->GetStage() == kDecode ) {
-        obj = mod;
-        mod->Process(*fEvData);
-      }
-    }
-    if( fDoBench ) fBench->Stop(stage);
+    RunStage(kDecode, obj);
+    if( fDoBench ) fBench->Stop(fStages[stage].bench);
     if( !EvalStage(kDecode) ) return kSkip;
 
     //--- Main physics analysis. Calls the following for each defined apparatus
@@ -1040,95 +2050,47 @@ Int_t THaAnalyzer::PhysicsAnalysis( Int_t code )
     //    THaSpectrometer::Track        (only for spectrometers)
     //    THaApparatus::Reconstruct
     //
+    // Inter-stage modules are run after the apparatuses of their stage.
     // Test blocks are evaluated after each of these stages
 
     //-- Coarse processing
 
-    stage = "CoarseTracking";
-    if( fDoBench ) fBench->Begin(stage);
-    for( auto* spectro : fSpectrometers ) {
-      obj = spectro;
-      spectro->CoarseTrack();
-    }
-    for( auto* mod : fInterStage ) {
-      if( mod->GetStage() == kCoarseTrack ) {
-        obj = mod;
-        mod->Process(*fEvData);
-      }
-    }
-    if( fDoBench ) fBench->Stop(stage);
+    stage = kCoarseTrack;
+    if( fDoBench ) fBench->Start(fStages[stage].bench);
+    RunStage(kCoarseTrack, obj);
+    if( fDoBench ) fBench->Stop(fStages[stage].bench);
     if( !EvalStage(kCoarseTrack) )  return kSkip;
 
 
-    stage = "CoarseReconstruct";
-    if( fDoBench ) fBench->Begin(stage);
-    for( auto* app : fApps ) {
-      obj = app;
-      app->CoarseReconstruct();
-    }
-    for( auto* mod : fInterStage ) {
-      if( mod->GetStage() == kCoarseRecon ) {
-        obj = mod;
-        mod->Process(*fEvData);
-      }
-    }
-    if( fDoBench ) fBench->Stop(stage);
+    stage = kCoarseRecon;
+    if( fDoBench ) fBench->Start(fStages[stage].bench);
+    RunStage(kCoarseRecon, obj);
+    if( fDoBench ) fBench->Stop(fStages[stage].bench);
     if( !EvalStage(kCoarseRecon) )  return kSkip;
 
     //-- Fine (Full) Reconstruct().
 
-    stage = "Tracking";
-    if( fDoBench ) fBench->Begin(stage);
-    for( auto* spectro : fSpectrometers ) {
-      obj = spectro;
-      spectro->Track();
-    }
-    for( auto* mod : fInterStage ) {
-      if( mod->GetStage() == kTracking ) {
-        obj = mod;
-        mod->Process(*fEvData);
-      }
-    }
-    if( fDoBench ) fBench->Stop(stage);
+    stage = kTracking;
+    if( fDoBench ) fBench->Start(fStages[stage].bench);
+    RunStage(kTracking, obj);
+    if( fDoBench ) fBench->Stop(fStages[stage].bench);
     if( !EvalStage(kTracking) )  return kSkip;
 
 
-    stage = "Reconstruct";
-    if( fDoBench ) fBench->Begin(stage);
-    for( auto* app : fApps ) {
-      obj = app;
-      app->Reconstruct();
-    }
-    for( auto* mod : fInterStage ) {
-      if( mod->GetStage() == kReconstruct ) {
-        obj = mod;
-        mod->Process(*fEvData);
-      }
-    }
-    if( fDoBench ) fBench->Stop(stage);
+    stage = kReconstruct;
+    if( fDoBench ) fBench->Start(fStages[stage].bench);
+    RunStage(kReconstruct, obj);
+    if( fDoBench ) fBench->Stop(fStages[stage].bench);
     if( !EvalStage(kReconstruct) )  return kSkip;
 
     //--- Process the list of physics modules
 
-    stage = "Physics";
-    if( fDoBench ) fBench->Begin(stage);
-    for( auto* physmod : fPhysics ) {
-      obj = physmod;
-      Int_t err = physmod->Process( *fEvData );
-      if( err == THaPhysicsModule::kTerminate )
-        code = kTerminate;
-      else if( err == THaPhysicsModule::kFatal ) {
-        code = kFatal;
-        break;
-      }
-    }
-    for( auto* mod : fInterStage ) {
-      if( mod->GetStage() == kPhysics ) {
-        obj = mod;
-        mod->Process(*fEvData);
-      }
-    }
-    if( fDoBench ) fBench->Stop(stage);
+    stage = kPhysics;
+    if( fDoBench ) fBench->Start(fStages[stage].bench);
+    Int_t err = RunStage(kPhysics, obj);
+    if( err != kOK )
+      code = err;
+    if( fDoBench ) fBench->Stop(fStages[stage].bench);
     if( code == kFatal ) return kFatal;
 
     //--- Evaluate "Physics" test block
@@ -1143,14 +2105,14 @@ Int_t THaAnalyzer::PhysicsAnalysis( Int_t code )
     TString module_desc = (obj != nullptr) ? obj->GetTitle() : "unknown";
     Error( here, "Caught exception %s in module %s (%s) during %s analysis "
 	   "stage. Terminating analysis.", e.what(), module_name.Data(),
-	   module_desc.Data(), stage );
-    if( fDoBench ) fBench->Stop(stage);
+	   module_desc.Data(), fStages[stage].name );
+    if( fDoBench ) fBench->Stop(fStages[stage].bench);
     code = kFatal;
     goto errexit;
   }
 
   //---  Process output
-  if( fDoBench ) fBench->Begin("Output");
+  if( fDoBench ) fBench->Start(kBenchOutput);
   try {
     //--- If Event defined, fill it.
     if( fEvent ) {
@@ -1172,7 +2134,7 @@ Int_t THaAnalyzer::PhysicsAnalysis( Int_t code )
 	   "Terminating analysis.", e.what(), fNev );
     code = kFatal;
   }
-  if( fDoBench ) fBench->Stop("Output");
+  if( fDoBench ) fBench->Stop(kBenchOutput);
 
  errexit:
   return code;
@@ -1188,9 +2150,12 @@ Int_t THaAnalyzer::SlowControlAnalysis( Int_t code )
   if( code == kFatal )
     return code;
   if ( !fEpicsHandler ) return kOK;
-  if( fDoBench ) fBench->Begin("Output");
+  // When resuming, EPICS data up to the checkpoint are already in the
+  // output of the interrupted job
+  if( fResumeNev > 0 && fNev <= fResumeNev ) return kOK;
+  if( fDoBench ) fBench->Start(kBenchOutput);
   if( fOutput ) fOutput->ProcEpics(fEvData, fEpicsHandler);
-  if( fDoBench ) fBench->Stop("Output");
+  if( fDoBench ) fBench->Stop(kBenchOutput);
   if( code == kTerminate )
     return code;
   return kOK;
@@ -1216,7 +2181,7 @@ Int_t THaAnalyzer::PostProcess( Int_t code )
   // THaPostProcess::Process() function for optional evaluation,
   // e.g. skipping events that fail analysis stage cuts.
 
-  if( fDoBench ) fBench->Begin("PostProcess");
+  if( fDoBench ) fBench->Start(kBenchPostProcess);
 
   if( code == kFatal )
     return code;
@@ -1226,7 +2191,7 @@ Int_t THaAnalyzer::PostProcess( Int_t code )
 	ret > code )
       code = ret;
   }
-  if( fDoBench ) fBench->Stop("PostProcess");
+  if( fDoBench ) fBench->Stop(kBenchPostProcess);
   return code;
 }
 
@@ -1246,9 +2211,23 @@ Int_t THaAnalyzer::MainAnalysis()
     rawfail = true;
   }
 
-  for( auto* obj : fEvtHandlers ) {
+  // Event type handlers registered for the type of this event
+  UInt_t evtype = fEvData->GetEvType();
+  for( auto* obj : (evtype < fEvtDispatch.size()) ? fEvtDispatch[evtype]
+                                                  : fEvtOther ) {
     obj->Analyze(fEvData);
   }
+  if( fEvtThread && evtype < fAsyncDispatch.size() &&
+      !fAsyncDispatch[evtype].empty() ) {
+    try {
+      fEvtThread->Push(fEvData->GetRawDataBuffer(), &fAsyncDispatch[evtype]);
+    }
+    catch( exception& e ) {
+      Error( "MainAnalysis", "Caught exception %s in asynchronous event "
+             "type handler. Terminating analysis.", e.what() );
+      return kFatal;
+    }
+  }
 
   bool evdone = false;
   //=== Physics triggers ===
@@ -1307,6 +2286,12 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
       return -1;
   }
 
+  //--- Continue an interrupted analysis after its last checkpoint
+  fResumeNev = 0;
+  fResume = Checkpoint_t();
+  if( fDoResume && ReadCheckpoint(run) != 0 )
+    return -5;
+
   //--- Initialization. Creates fFile, fOutput, and fEvent if necessary.
   //    Also copies run to fRun if run is different from fRun
   Int_t status = Init( run );
@@ -1314,26 +2299,60 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
     return status;
   }
 
+  // Events up to the checkpoint are only read again for the event type
+  // handlers. The requested event range is restored at the end.
+  UInt_t nfirst = fRun->GetFirstEvent();
+  if( fResumeNev >= nfirst )
+    fRun->SetFirstEvent(fResumeNev + 1);
+
   // Restart "Total" since it is stopped in Init()
-  fBench->Begin("Total");
+  fBench->SetCountAllocs(fDoAllocStats);
+  Podd::AllocCounter::Enable(fDoAllocStats);
+  fBench->SetRecordLatency(kBenchRawDecode, fDoLatency);
+  for( const auto& theStage : fStages )
+    fBench->SetRecordLatency(theStage.bench, fDoLatency);
+  fBench->SetRecordLatency(kBenchOutput, fDoLatency);
+  // Per-event wall time, broken down by timer for the slowest events
+  fDoEvTiming = fDoLatency || (fNslow > 0 && !fSlowEvFileName.IsNull());
+  fSlowEvents.clear();
+  fEvTimers.clear();
+  for( const auto& theStage : fStages )
+    fEvTimers.push_back(theStage.bench);
+  for( auto h : { kBenchOutput, kBenchCuts, kBenchPostProcess } )
+    fEvTimers.push_back(h);
+  fEvTimes.assign(fEvTimers.size(), 0);
+  fBench->Start(kBenchTotal);
 
   //--- Re-open the data source. Should succeed since this was tested in Init().
   if( (status = fRun->Open()) != THaRunBase::READ_OK ) {
     Error( here, "Failed to re-open the input file. "
 	   "Make sure the file still exists.");
-    fBench->Stop("Total");
+    fBench->Stop(kBenchTotal);
+    Podd::AllocCounter::Enable(false);
     return -4;
   }
 
-  // Make the current run available globally - the run parameters are
-  // needed by some modules
-  gHaRun = fRun;
+  // Make the current run available to the modules via our context (by
+  // default, this sets gHaRun) - the run parameters are needed by some modules
+  fContext->SetRun(fRun);
+
+  // Start reading ahead in a separate thread if so requested
+  if( StartPipeline() != 0 ) {
+    fRun->Close();
+    fBench->Stop(kBenchTotal);
+    Podd::AllocCounter::Enable(false);
+    return -4;
+  }
 
   // Enable/disable helicity decoding as requested
   fEvData->EnableHelicity( HelicityEnabled() );
   // Set decoder reporting level. FIXME: update when THaEvData is updated
   fEvData->SetVerbose( (fVerbose>2) );
   fEvData->SetDebug( (fVerbose>3) );
+  // With an external profiler, also mark the decoder's steps (roc_decode
+  // etc.), which are timed by the decoder's own timers
+  if( fDoBench && Podd::ProfMarkers::IsAvailable() )
+    fEvData->EnableBenchmarks();
 
   // Informational messages
   if( fVerbose>1 ) {
@@ -1344,15 +2363,33 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
   }
   if( fVerbose>2 && fRun->GetFirstEvent()>1 )
     cout << "Skipping " << fRun->GetFirstEvent() << " events" << endl;
+  if( fVerbose>1 && fSampling > 0 ) {
+    if( fSampling >= 1 )
+      cout << "Sampling every " << fSampling << ". physics event" << endl;
+    else
+      cout << "Sampling " << 100*fSampling << "% of physics events" << endl;
+  }
 
   //--- The main event loop.
 
   fNev = 0;
+  fOnline = OnlineStat_t();
+  fOnline.lastreport = fOnline.lastpublish = fLastFlush = WallTime();
+  fNevFlushed = 0;
+  fSampleCount = 0;
   bool terminate = false, fatal = false;
   UInt_t nlast = fRun->GetLastEvent();
   fAnalysisStarted = true;
   PrepareModuleList();
+  StartEvtThread();
+  BuildEvtDispatch();
+  BuildRocDemand();
   BeginAnalysis();
+  StartHistoServer();
+  // Array lengths and shared formula subexpressions are invalidated per
+  // event and after each analysis stage
+  Podd::Variable::SetLenCache(true);
+  Podd::FormulaProgram::SetCaching(true);
   if( fFile ) {
     fFile->cd();
     fRun->Write("Run_Data");  // Save run data to first ROOT file
@@ -1366,10 +2403,17 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
       terminate = fatal = true;
       continue;
     }
+    if( status == THaRunBase::READ_EMPTY ) {
+      FlushIdle();
+      continue;
+    }
     if( status != THaRunBase::READ_OK )
       continue;
 
+    Podd::Variable::NewEvent();
+    Podd::FormulaProgram::NewEvent();
     UInt_t evnum = fEvData->GetEvNum();
+    UInt_t nprev = fNev;
 
     // Count events according to the requested mode
     // Whether or not to ignore events prior to fRun->GetFirstEvent()
@@ -1389,21 +2433,61 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
       break;
     }
 
+    //--- Save the state after every fCheckpointInterval events. When
+    //    resuming, restore the state saved at the same point.
+    if( fResumeNev > 0 && fNev > fResumeNev )
+      RestoreCheckpoint();
+    else if( fCheckpointInterval > 0 && !fCheckpointFileName.IsNull() &&
+             fNev / fCheckpointInterval > nprev / fCheckpointInterval &&
+             WriteCheckpoint(nprev) != 0 ) {
+      terminate = fatal = true;
+      continue;
+    }
+
     //--- Print marks periodically
-    if( fVerbose>1 && evnum > 0 && (evnum % fMarkInterval == 0))
+    if( fVerbose>1 && !fOnlineMode && evnum > 0 &&
+        (evnum % fMarkInterval == 0))
       cout << dec << evnum << endl;
 
     //--- Update run parameters with current event
     if( fUpdateRun )
       fRun->Update( fEvData );
 
+    //--- Events skipped by the pre-filter need no further processing
+    if( fEvSkipped )
+      continue;
+
+    //--- In shard mode, skip everything before the requested event range
+    if( fDoShard && fNev < fRun->GetFirstEvent() )
+      continue;
+
+    //--- Update live histograms periodically
+    if( fHistoServer )
+      PublishHistos();
+
+    //--- In online mode, drop physics events while behind schedule
+    Double_t tstart = 0;
+    if( fOnlineMode ) {
+      OnlineReport();
+      if( fEvData->IsPhysicsTrigger() && OnlineDropEvent() ) {
+        Incr(kNevDropped);
+        continue;
+      }
+      tstart = WallTime();
+    }
+
     //--- Clear all tests/cuts
-    if( fDoBench ) fBench->Begin("Cuts");
-    gHaCuts->ClearAll();
-    if( fDoBench ) fBench->Stop("Cuts");
+    if( fDoBench ) fBench->Start(kBenchCuts);
+    fContext->GetCuts()->ClearAll();
+    if( fDoBench ) fBench->Stop(kBenchCuts);
+
+    if( fDoBench && fPerfVarsDefined ) UpdatePerfVariables();
 
     //--- Perform the analysis
     Int_t err = MainAnalysis();
+    if( fDoEvTiming ) EndEventTiming(evnum);
+    if( fOnlineMode && fEvData->IsPhysicsTrigger() )
+      fOnline.credit -= WallTime() - tstart;
     switch( err ) {
     case kOK:
       break;
@@ -1425,10 +2509,28 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
 
   }  // End of event loop
 
+  // Show what led up to an abnormal end
+  if( terminate )
+    THaDebugModule::DumpTraces();
+
+  // Per-event arrays have reached their working size now
+  CheckMemoryBudget(here);
+
+  Podd::Variable::SetLenCache(false);
+  Podd::FormulaProgram::SetCaching(false);
+  if( fOnlineMode )
+    OnlineReport(true);
+  PublishHistos(true);
+  if( StopEvtThread() != 0 )
+    fatal = true;
   EndAnalysis();
+  CollectCounters();
 
   //--- Close the input file
+  StopPipeline();
   fRun->Close();
+  fRun->SetFirstEvent(nfirst);
+  fResumeNev = 0;
 
   // Save final run parameters in run object of caller, if any
   *run = *fRun;
@@ -1437,7 +2539,7 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
   // This writes the Tree as well as any objects (histograms etc.)
   // that are defined in the current directory.
 
-  if( fDoBench ) fBench->Begin("Output");
+  if( fDoBench ) fBench->Start(kBenchOutput);
   // Ensure that we are in the output file's current directory
   // ... someone might have pulled the rug from under our feet
 
@@ -1448,12 +2550,14 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
   if( fOutput ) fOutput->End();
   if( fFile ) {
     fRun->Write("Run_Data");  // Save run data to ROOT file
+    WritePerfSummary();
     //    fFile->Write();//already done by fOutput->End()
     fFile->Purge();         // get rid of excess object "cycles"
   }
-  if( fDoBench ) fBench->Stop("Output");
+  if( fDoBench ) fBench->Stop(kBenchOutput);
 
-  fBench->Stop("Total");
+  fBench->Stop(kBenchTotal);
+  Podd::AllocCounter::Enable(false);
 
   //--- Report statistics
   if( fVerbose>0 ) {
@@ -1473,6 +2577,10 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
 
       if( fVerbose>1 )
 	PrintScalers();
+      if( fVerbose>2 ) {
+        cout << "Decoder slot memory:" << endl;
+        fEvData->PrintSlotMemory(cout);
+      }
     }
   }
 
@@ -1483,25 +2591,734 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
   // Print timing statistics, if benchmarking enabled
   if( fDoBench && !fatal ) {
     cout << "Timing summary:" << endl;
-    fBench->Print("Init");
-    fBench->Print("RawDecode");
-    fBench->Print("Decode");
-    fBench->Print("CoarseTracking");
-    fBench->Print("CoarseReconstruct");
-    fBench->Print("Tracking");
-    fBench->Print("Reconstruct");
-    fBench->Print("Physics");
-    fBench->Print("Output");
-    fBench->Print("Cuts");
-  }
-  if( (fVerbose>1 || fDoBench) && !fatal )
-    fBench->Print("Total");
+    fBench->Print(cout);
+    if( fEvLatency->GetCount() > 0 ) {
+      cout << "Event latency: ";
+      fEvLatency->Print(cout);
+      cout << endl;
+    }
+    WriteProfile();
+    WriteSlowEvents();
+  }
+  else if( fVerbose>1 && !fatal )
+    fBench->Print(kBenchTotal, cout);
+
+  // The checkpoint is obsolete once the run has been processed completely
+  if( !fatal && !fCheckpointFileName.IsNull() &&
+      !gSystem->AccessPathName(fCheckpointFileName) )
+    gSystem->Unlink(fCheckpointFileName);
 
   //keep the last run available
   //  gHaRun = nullptr;
   return fNev;
 }
 
+//_____________________________________________________________________________
+Bool_t THaAnalyzer::SampleEvent()
+{
+  // Decide whether the current physics event is to be analyzed in
+  // sampling mode (see SetSampling)
+
+  if( fSampling >= 1 )
+    return ( fSampleCount++ % static_cast<UInt_t>(fSampling) == 0 );
+
+  // xorshift64* random number, uniform in [0,1)
+  ULong64_t& x = fSampleRng;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  Double_t r = static_cast<Double_t>((x * 2685821657736338717ULL) >> 11)
+    * (1.0 / 9007199254740992.0);
+  return ( r < fSampling );
+}
+
+//_____________________________________________________________________________
+Bool_t THaAnalyzer::PrefilterEvent( const UInt_t* evbuffer )
+{
+  // Decide from its header whether the event in 'evbuffer' can be skipped
+  // without decoding (see EnablePrefilter). If so, update the counters as
+  // MainAnalysis would have done and return true.
+
+  THaEvData::EvHeader_t hdr;
+  if( fEvData->PeekEvent(evbuffer, hdr) != THaEvData::HED_OK )
+    return false;
+
+  // Events wanted by any event type handler
+  UInt_t type = hdr.type;
+  if( type < fEvtDispatch.size() ) {
+    if( !fEvtDispatch[type].empty() ||
+        (type < fAsyncDispatch.size() && !fAsyncDispatch[type].empty()) )
+      return false;
+  } else if( !fEvtOther.empty() )
+    return false;
+
+  bool physics = ( type > 0 && type <= MAX_PHYS_EVTYPE );
+  if( physics ) {
+    if( !fDoPhysics || fEvData->HelicityEnabled() )
+      return false;
+    // Event count as Process() will compute it
+    UInt_t nev = fNev;
+    if( fCountMode == kCountRaw )
+      nev = hdr.evnum;
+    else if( fCountMode == kCountPhysics || fCountMode == kCountAll )
+      ++nev;
+    if( fResumeNev > 0 && nev <= fResumeNev && !fSampleExempt.empty() )
+      return false;
+    if( nev >= fRun->GetFirstEvent() ) {
+      if( !fSampleExempt.empty() || (fSampling <= 0 && fTrigMask == 0) )
+        return false;
+      if( fTrigMask != 0 && !TriggerSelected(type, evbuffer) )
+        Incr(kNevTrigSkipped);
+      else {
+        fTrigKeep = (fTrigMask != 0);
+        if( fSampling <= 0 )
+          return false;
+        if( SampleEvent() ) {
+          fSampleKeep = true;
+          return false;
+        }
+        Incr(kNevSampled);
+      }
+    }
+    Incr(kNevGood);
+    Incr(kNevPhysics);
+  } else {
+    if( type == PRESTART_EVTYPE || type == PRESCALE_EVTYPE ||
+        type == TS_PRESCALE_EVTYPE || type == EPICS_EVTYPE ||
+        (fEpicsHandler && fEpicsHandler->IsMyEvent(type)) )
+      return false;
+    Incr(kNevGood);
+    if( fDoOtherEvents )
+      Incr(kNevOther);
+  }
+  Incr(kNevPrefiltered);
+  return true;
+}
+
+//_____________________________________________________________________________
+Bool_t THaAnalyzer::TriggerSelected( UInt_t evtype, const UInt_t* evbuffer )
+{
+  // Return true if the current physics event, of type 'evtype', comes from
+  // one of the triggers selected with SetTriggerSelection. If 'evbuffer' is
+  // given, the event has not been decoded yet, and only the crates of the
+  // trigger bit channels are decoded to find its trigger bits.
+
+  if( fTrigCrates.empty() )
+    return evtype < 32 && (BIT(evtype) & fTrigMask) != 0;
+  if( evbuffer ) {
+    Int_t status = fEvData->LoadRocs(evbuffer, fTrigCrates);
+    if( status != THaEvData::HED_OK && status != THaEvData::HED_WARN )
+      return true;  // Let the full decoding report the error
+  }
+  return (fTrigData->DecodeTriggerBits(*fEvData) & fTrigMask) != 0;
+}
+
+//_____________________________________________________________________________
+Bool_t THaAnalyzer::OnlineDropEvent()
+{
+  // Decide whether to drop the current physics event in online mode.
+  //
+  // The analysis is behind schedule if the read-ahead queue is full, or,
+  // with SetEventDeadline(), if it has used more than the deadline per
+  // physics event. Each physics event seen adds the deadline to a time
+  // budget, from which the analysis time of each analyzed event is
+  // deducted. At most kMaxCredit events' worth of unused time is kept,
+  // so that a quiet period does not hide a later backlog.
+  //
+  // While behind, all physics events are dropped, except for every
+  // n-th one with SetSampleInterval(n).
+
+  const Double_t kMaxCredit = 100;
+
+  auto& st = fOnline;
+  ++st.nseen;
+  bool behind = false;
+  if( fEvDeadline > 0 ) {
+    st.credit = std::min(st.credit + fEvDeadline, kMaxCredit * fEvDeadline);
+    behind = ( st.credit < 0 );
+  }
+  if( fEvQueue && fEvQueue->GetNQueued() + 1 >= fEvQueue->GetDepth() )
+    behind = true;
+  if( !behind ) {
+    st.nbehind = 0;
+    return false;
+  }
+  ++st.nbehind;
+  return !( fSampleInterval > 0 && st.nbehind % fSampleInterval == 0 );
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::FlushIdle()
+{
+  // Called while the input has no new data, e.g. while following a run
+  // file that the DAQ is still writing (see THaRun::SetFollow). At most
+  // every fFlushInterval seconds, write the output buffered so far to the
+  // ROOT file, so that it can be inspected while the run is in progress.
+  // Nothing is written if no events were analyzed since the last flush.
+  // In online mode, also update the status line and snapshot.
+
+  if( fOnlineMode )
+    OnlineReport();
+  Double_t now = WallTime();
+  if( fFlushInterval <= 0 || now - fLastFlush < fFlushInterval ||
+      fNev == fNevFlushed || !fOutput )
+    return;
+  fLastFlush = now;
+  fNevFlushed = fNev;
+
+  if( fDoBench ) fBench->Start(kBenchOutput);
+  TDirectory* dir = gDirectory;
+  if( fFile )
+    fFile->cd();
+  Long64_t entries = fOutput->Checkpoint();
+  if( dir )
+    dir->cd();
+  if( fDoBench ) fBench->Stop(kBenchOutput);
+  if( fVerbose>1 && !fOnlineMode )
+    cout << "Waiting for data, flushed " << entries << " entries" << endl;
+}
+
+//_____________________________________________________________________________
+Int_t THaAnalyzer::HotReload()
+{
+  // Called between events if hot reloading is enabled (see EnableHotReload).
+  // At most every fReloadInterval seconds, check whether the crate map or
+  // the database files of any analysis module have changed since they
+  // were read. Re-read a changed crate map and re-initialize the modules
+  // whose files changed. Then recompile the cuts and re-attach the output
+  // to the global variables, which the modules may have redefined.
+  // Output tree and histograms are kept.
+  // Returns the number of reloaded items (crate map and modules), or <0
+  // if reloading failed, in which case the analysis cannot continue.
+
+  static const char* const here = "HotReload";
+
+  Double_t now = WallTime();
+  if( fReloadInterval <= 0 || now - fLastReload < fReloadInterval )
+    return 0;
+  fLastReload = now;
+
+  Int_t nreload = 0;
+  if( !fCrateMapFiles.empty() &&
+      !Podd::DBFilesUnchanged(fCrateMapFiles, fCrateMapDate, fCrateMapDate) ) {
+    if( fVerbose>0 )
+      cout << "Crate map changed, reloading" << endl;
+    Podd::StartDBFileRecording();
+    Int_t ret = fEvData->ReloadCrateMap();
+    auto files = Podd::StopDBFileRecording();
+    if( ret != THaEvData::HED_OK ) {
+      Error( here, "Error reloading crate map. Fix database." );
+      return -1;
+    }
+    fCrateMapFiles = std::move(files);
+    ++nreload;
+  }
+
+  vector<THaAnalysisObject*> changed;
+  for( auto* theModule : fAnalysisModules ) {
+    auto rec = fModuleInit.find(theModule);
+    if( rec != fModuleInit.end() &&
+        !Podd::DBFilesUnchanged(rec->second.files, rec->second.date,
+                                rec->second.date) )
+      changed.push_back(theModule);
+  }
+  if( changed.empty() )
+    return nreload;
+
+  if( fVerbose>0 ) {
+    cout << "Database changed, re-initializing";
+    for( auto* theModule : changed )
+      cout << " " << theModule->GetName();
+    cout << endl;
+  }
+  TDatime run_time = fRun->GetDate();
+  Int_t retval = InitModules(changed, run_time);
+  if( retval != 0 )
+    return retval;
+  nreload += static_cast<Int_t>(changed.size());
+
+  // Update everything that holds pointers to the modules' global variables
+  if( !fCutFileName.IsNull() )
+    fContext->GetCuts()->Compile();
+  InitCuts();
+  if( fOutput ) {
+    TDirectory* olddir = gDirectory;
+    if( fFile )
+      fFile->cd();
+    retval = fOutput->Init( fOdefFileName );  // Only re-attaches
+    olddir->cd();
+    if( retval < 0 ) {
+      Error( here, "Error re-attaching output to global variables." );
+      return retval;
+    }
+  }
+  for( auto* theModule : changed )
+    theModule->UpdateVariableUsage();
+  // Detector maps may have changed
+  BuildRocDemand();
+  return nreload;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::OnlineReport( Bool_t final )
+{
+  // In online mode, every fOnlineInterval seconds and at the end of the
+  // run, print a status line and write the histogram snapshot file,
+  // if any.
+
+  auto& st = fOnline;
+  Double_t now = WallTime();
+  Double_t dt = now - st.lastreport;
+  if( !final && dt < fOnlineInterval )
+    return;
+
+  UInt_t nread = GetCount(kNevRead), ndrop = GetCount(kNevDropped);
+  UInt_t dread = nread - st.nread, dseen = st.nseen - st.nseenlast;
+  UInt_t ddrop = ndrop - st.ndroplast;
+  if( fVerbose>0 ) {
+    cout << "Online: event " << fEvData->GetEvNum() << fixed
+         << setprecision(1) << ", " << (dt > 0 ? dread/dt : 0.0) << " Hz"
+         << ", dropped " << ddrop << " ("
+         << (dseen > 0 ? 100.0*ddrop/dseen : 0.0) << "%)";
+    if( fEvQueue )
+      cout << ", queue " << fEvQueue->GetNQueued() << "/"
+           << fEvQueue->GetDepth();
+    cout << defaultfloat << endl;
+  }
+  if( !fSnapshotFileName.IsNull() && fOutput &&
+      fOutput->WriteHistos(fSnapshotFileName) != 0 )
+    Warning( "OnlineReport", "Failed to write histogram snapshot %s",
+             fSnapshotFileName.Data() );
+  st.lastreport = now;
+  st.nread = nread;
+  st.nseenlast = st.nseen;
+  st.ndroplast = ndrop;
+}
+
+//_____________________________________________________________________________
+Int_t THaAnalyzer::WriteProfile() const
+{
+  // Write the timing statistics of the analyzer and the decoder to
+  // fProfileFileName, if set, as folded stacks usable by flame graph tools
+  // (e.g. flamegraph.pl). Times are in microseconds. Called at the end of
+  // Process() if benchmarks are enabled.
+
+  if( fProfileFileName.IsNull() )
+    return 0;
+  Int_t ret = fBench->WriteFolded(fProfileFileName.Data());
+  if( ret == 0 && fEvData && fEvData->GetProfiler() )
+    ret = fEvData->GetProfiler()->WriteFolded(fProfileFileName.Data(), true);
+  if( ret == 0 && fVerbose>0 )
+    cout << "Timing profile written to " << fProfileFileName << endl;
+  return ret;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::SetSlowEventFile( const char* name, UInt_t nslow )
+{
+  // Record the 'nslow' events that take the longest time to analyze and
+  // write them to file 'name' at the end of Process(), slowest first,
+  // with the time spent in each analysis stage. Each event is listed with
+  // its event count, so that it can be analyzed again by itself, e.g. for
+  // profiling, with THaRunBase::SetEventRange(count,count) and the same
+  // counting mode (see SetCountMode). Also enables benchmarks.
+  //
+  // An empty name or nslow = 0 disables this feature.
+
+  fSlowEvFileName = name;
+  fNslow = nslow;
+  if( !fSlowEvFileName.IsNull() && fNslow > 0 )
+    fDoBench = true;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::SetCheckpointFile( const char* name, UInt_t interval )
+{
+  // Every 'interval' events (event count as used for the event range),
+  // save the output file and write the state of the analysis to the
+  // checkpoint file 'name': the input and output file names, the event
+  // count, the statistics counters and the cut statistics. The file is
+  // replaced atomically and is removed when the run has been processed
+  // completely.
+  //
+  // If the job is interrupted, it can be resumed with the same checkpoint
+  // file and EnableResume(). The resumed job writes a new output file
+  // with the events after the checkpoint; see ReadCheckpoint.
+  //
+  // An empty name or interval = 0 disables checkpoints.
+
+  fCheckpointFileName = name;
+  fCheckpointInterval = interval;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::StartEventTiming()
+{
+  // Mark the start of the current event for EndEventTiming()
+
+  if( fNslow > 0 ) {
+    for( size_t i = 0; i < fEvTimers.size(); ++i )
+      fEvTimes[i] = fBench->GetRealTime(fEvTimers[i]);
+  }
+  fEvStart = WallTime();
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EndEventTiming( UInt_t evnum )
+{
+  // Record the wall time of the current event. Events skipped before
+  // MainAnalysis() are not included. If requested, keep the event if it
+  // is among the fNslow slowest so far, along with its time breakdown.
+
+  Double_t t = WallTime() - fEvStart;
+  fEvLatency->Record(static_cast<ULong64_t>(1e9*t));
+  if( fNslow == 0 || fSlowEvFileName.IsNull() )
+    return;
+
+  // fSlowEvents is a min-heap, with the fastest kept event at the front
+  auto slower = []( const SlowEvent_t& a, const SlowEvent_t& b ) {
+    return a.time > b.time;
+  };
+  if( fSlowEvents.size() >= fNslow ) {
+    if( t <= fSlowEvents.front().time )
+      return;
+    pop_heap(ALL(fSlowEvents), slower);
+    fSlowEvents.pop_back();
+  }
+  fSlowEvents.emplace_back(fNev, evnum, fEvData->GetEvType(), t);
+  auto& timers = fSlowEvents.back().timers;
+  timers.reserve(fEvTimers.size());
+  for( size_t i = 0; i < fEvTimers.size(); ++i )
+    timers.push_back(fBench->GetRealTime(fEvTimers[i]) - fEvTimes[i]);
+  push_heap(ALL(fSlowEvents), slower);
+}
+
+//_____________________________________________________________________________
+Int_t THaAnalyzer::WriteSlowEvents() const
+{
+  // Write the slowest events of the last Process() to fSlowEvFileName,
+  // if set, one line per event, slowest first. Times are in microseconds.
+
+  if( fSlowEvFileName.IsNull() || fNslow == 0 )
+    return 0;
+
+  ofstream ofs(fSlowEvFileName.Data());
+  if( !ofs ) {
+    Error( "WriteSlowEvents", "Cannot open slow event file %s",
+           fSlowEvFileName.Data() );
+    return -1;
+  }
+  vector<SlowEvent_t> events(fSlowEvents);
+  sort(ALL(events), []( const SlowEvent_t& a, const SlowEvent_t& b ) {
+    return a.time > b.time;
+  });
+  ofs << "# Slowest " << events.size() << " events of run "
+      << fRun->GetNumber() << " (" << fRun->GetName() << ")" << endl
+      << "# Reanalyze with THaRunBase::SetEventRange(count,count)" << endl
+      << "# count evnum evtype time";
+  for( auto h : fEvTimers )
+    ofs << " " << fBench->GetName(h);
+  ofs << endl << fixed << setprecision(1);
+  for( const auto& ev : events ) {
+    ofs << ev.nev << " " << ev.evnum << " " << ev.evtype << " "
+        << 1e6*ev.time;
+    for( Double_t t : ev.timers )
+      ofs << " " << 1e6*t;
+    ofs << endl;
+  }
+  if( !ofs ) {
+    Error( "WriteSlowEvents", "Error writing slow event file %s",
+           fSlowEvFileName.Data() );
+    return -1;
+  }
+  if( fVerbose>0 )
+    cout << "Slowest events written to " << fSlowEvFileName << endl;
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t THaAnalyzer::DefinePerfVariables( Bool_t remove )
+{
+  // Define (or remove) global variables for the analyzer performance:
+  //  anl.<counter>        event counters, e.g. anl.nev.physics
+  //  anl.time.<stage>     real time spent in each analysis stage (s)
+  //  anl.allocs.<stage>   heap allocations in each stage
+  // The times and allocation counts are cumulative for the current
+  // Process() as of the start of the current event. They are only
+  // updated when benchmarks are enabled.
+
+  THaVarList* vars = fContext->GetVars();
+  if( remove ) {
+    if( fPerfVarsDefined && vars && TROOT::Initialized() )
+      vars->RemoveRegexp("anl.*");
+    fPerfVarsDefined = false;
+    return 0;
+  }
+  if( fPerfVarsDefined || !vars )
+    return 0;
+
+  for( const auto& theCounter : fCounters ) {
+    TString name = TString("anl.") + theCounter.name;
+    vars->Define(name, theCounter.description, theCounter.count);
+  }
+  // fPerfTime and fPerfAllocs must not be resized while the variables exist
+  fPerfTime.assign(fStages.size(), 0);
+  fPerfAllocs.assign(fStages.size(), 0);
+  for( size_t i = 0; i < fStages.size(); ++i ) {
+    const char* stage = fStages[i].name;
+    vars->Define(Form("anl.time.%s", stage),
+                 Form("Real time in %s (s)", stage), fPerfTime[i]);
+    vars->Define(Form("anl.allocs.%s", stage),
+                 Form("Heap allocations in %s", stage), fPerfAllocs[i]);
+  }
+  fPerfVarsDefined = true;
+  return 0;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::UpdatePerfVariables()
+{
+  // Copy the stage timer totals to the "anl.*" global variables
+
+  for( size_t i = 0; i < fStages.size(); ++i ) {
+    fPerfTime[i] = fBench->GetRealTime(fStages[i].bench);
+    fPerfAllocs[i] = fBench->GetNAllocs(fStages[i].bench);
+  }
+}
+
+//_____________________________________________________________________________
+Int_t THaAnalyzer::WritePerfSummary()
+{
+  // Write the performance summary of the last Process() to the current
+  // directory of the output file, if enabled with EnablePerfSummary.
+  // "PerfCounters" has one entry with one branch per event counter.
+  // "PerfTimers" has one entry per timer of the analyzer and the decoder,
+  // identified by its path, e.g. "Analyzer;Total;Tracking;R".
+  // Trees from successive runs in the same file are distinguished by
+  // their "run" branch and by their cycle numbers.
+
+  if( !fDoPerfSummary || !fFile )
+    return 0;
+
+  UInt_t run = fRun->GetNumber();
+  TTree counters("PerfCounters", "Analyzer event counters");
+  counters.Branch("run", &run, "run/i");
+  for( auto& theCounter : fCounters ) {
+    TString leaf(theCounter.name);
+    leaf.ReplaceAll(".", "_");
+    counters.Branch(leaf.Data(), &theCounter.count, (leaf + "/i").Data());
+  }
+  counters.Fill();
+
+  TTree timers("PerfTimers", "Analyzer and decoder timers");
+  string path;
+  Double_t real = 0, cpu = 0, p50 = 0, p99 = 0;
+  ULong64_t ncalls = 0, nallocs = 0, nbytes = 0;
+  timers.Branch("run", &run, "run/i");
+  timers.Branch("path", &path);
+  timers.Branch("real", &real, "real/D");        // Real time (s)
+  timers.Branch("cpu", &cpu, "cpu/D");           // CPU time, if measured (s)
+  timers.Branch("ncalls", &ncalls, "ncalls/l");
+  timers.Branch("nallocs", &nallocs, "nallocs/l");
+  timers.Branch("nbytes", &nbytes, "nbytes/l");  // Bytes allocated
+  timers.Branch("p50", &p50, "p50/D");           // Median latency, if recorded (ns)
+  timers.Branch("p99", &p99, "p99/D");
+  for( const Podd::Profiler* prof : { static_cast<const Podd::Profiler*>(fBench),
+                                      fEvData ? fEvData->GetProfiler() : nullptr } ) {
+    if( !prof )
+      continue;
+    for( UInt_t h = 0; h < prof->GetSize(); ++h ) {
+      path    = string(prof->GetName()) + ";" + prof->GetPath(h);
+      real    = prof->GetRealTime(h);
+      cpu     = prof->GetCpuTime(h);
+      ncalls  = prof->GetNCalls(h);
+      nallocs = prof->GetNAllocs(h);
+      nbytes  = prof->GetAllocBytes(h);
+      const Podd::LatencyHistogram* lat = prof->GetLatency(h);
+      bool have_lat = lat && lat->GetCount() > 0;
+      p50 = have_lat ? lat->GetPercentile(50) : 0;
+      p99 = have_lat ? lat->GetPercentile(99) : 0;
+      timers.Fill();
+    }
+  }
+
+  if( counters.Write() == 0 || timers.Write() == 0 ) {
+    Error( "WritePerfSummary", "Error writing performance summary to %s",
+           fFile->GetName() );
+    return -1;
+  }
+  return 0;
+}
+
+//_____________________________________________________________________________
+static string CheckpointRunName( const THaRunBase* run )
+{
+  // Name identifying the input of 'run' in checkpoint files
+
+  const auto* crun = dynamic_cast<const THaRun*>(run);
+  return crun ? crun->GetFilename() : run->GetName();
+}
+
+//_____________________________________________________________________________
+Int_t THaAnalyzer::WriteCheckpoint( UInt_t nev )
+{
+  // Save the output file and write the state of the analysis after 'nev'
+  // events (see SetCheckpointFile). The checkpoint is written to a
+  // temporary file first and then renamed, so that a crash while writing
+  // leaves the previous checkpoint intact. Returns 0 if ok, -1 on error.
+
+  static const char* const here = "WriteCheckpoint";
+
+  CollectCounters();
+  Long64_t entries = 0;
+  if( fOutput ) {
+    if( fDoBench ) fBench->Start(kBenchOutput);
+    TDirectory* dir = gDirectory;
+    if( fFile )
+      fFile->cd();
+    entries = fOutput->Checkpoint();
+    if( dir )
+      dir->cd();
+    if( fDoBench ) fBench->Stop(kBenchOutput);
+  }
+
+  TString tmpname = fCheckpointFileName + ".tmp";
+  ofstream ofs(tmpname.Data());
+  if( !ofs ) {
+    Error( here, "Cannot write checkpoint file %s", tmpname.Data() );
+    return -1;
+  }
+  ofs << "# Podd analysis checkpoint, " << TDatime().AsString() << endl;
+  ofs << "run " << CheckpointRunName(fRun) << endl;
+  for( const auto& out : fResume.outputs )
+    ofs << "output " << out << endl;
+  ofs << "output " << fOutFileName << endl;
+  ofs << "nev " << nev << endl;
+  ofs << "entries " << entries << endl;
+  for( const auto& theCounter : fCounters )
+    ofs << "counter " << theCounter.name << " " << theCounter.count << endl;
+  TIter next(fContext->GetCuts()->GetCutList());
+  while( auto* cut = static_cast<THaCut*>(next()) ) {
+    ofs << "cut " << cut->GetName() << " " << cut->GetNCalled() << " "
+        << cut->GetNPassed() << endl;
+  }
+  ofs.close();
+  if( !ofs || rename(tmpname.Data(), fCheckpointFileName.Data()) != 0 ) {
+    Error( here, "Error writing checkpoint file %s",
+           fCheckpointFileName.Data() );
+    return -1;
+  }
+  if( fVerbose>1 )
+    cout << "Checkpoint at event " << nev << ", " << entries
+         << " entries in output tree" << endl;
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t THaAnalyzer::ReadCheckpoint( const THaRunBase* run )
+{
+  // Read the checkpoint file of an interrupted analysis of 'run' (see
+  // SetCheckpointFile) and prepare to resume it. If there is no
+  // checkpoint file, the run is analyzed from the beginning.
+  //
+  // The events up to the checkpoint are read again, but only passed to
+  // the event type handlers, so that scaler, EPICS and helicity tracking
+  // are exactly as in the interrupted job; apparatuses with helicity
+  // detectors are also decoded. When the checkpoint is reached, the
+  // statistics counters and cut statistics are restored. The output of
+  // the events after the checkpoint goes to a new file, which replaces
+  // the output file name if it is the same as that of the interrupted
+  // job, e.g. "run.root" -> "run_part1.root". The output trees of all
+  // parts together hold every event once and can be chained or merged
+  // (e.g. with hadd). Event type handlers that write their own trees
+  // fill them again from the beginning of the run in every part.
+  //
+  // Returns 0 if ok, -1 on error.
+
+  static const char* const here = "ReadCheckpoint";
+
+  if( fCheckpointFileName.IsNull() ||
+      gSystem->AccessPathName(fCheckpointFileName) )
+    return 0;
+  ifstream ifs(fCheckpointFileName.Data());
+  if( !ifs ) {
+    Error( here, "Cannot read checkpoint file %s",
+           fCheckpointFileName.Data() );
+    return -1;
+  }
+  string line;
+  while( getline(ifs, line) ) {
+    istringstream is(line);
+    string key;
+    if( !(is >> key) || key[0] == '#' )
+      continue;
+    string name;
+    UInt_t n1 = 0, n2 = 0;
+    if( key == "run" ) {
+      getline(is >> ws, fResume.run);
+    } else if( key == "output" ) {
+      getline(is >> ws, name);
+      fResume.outputs.push_back(name);
+    } else if( key == "nev" ) {
+      is >> fResume.nev;
+    } else if( key == "entries" ) {
+      is >> fResume.entries;
+    } else if( key == "counter" ) {
+      if( is >> name >> n1 )
+        fResume.counters[name] = n1;
+    } else if( key == "cut" ) {
+      if( is >> name >> n1 >> n2 )
+        fResume.cuts[name] = make_pair(n1, n2);
+    }
+    if( !is && !is.eof() ) {
+      Error( here, "Invalid line in checkpoint file %s: %s",
+             fCheckpointFileName.Data(), line.c_str() );
+      return -1;
+    }
+  }
+  if( fResume.run != CheckpointRunName(run) ) {
+    Error( here, "Checkpoint file %s is for input %s, not %s. Remove it "
+           "to analyze this run from the beginning.", fCheckpointFileName.Data(),
+           fResume.run.c_str(), CheckpointRunName(run).c_str() );
+    return -1;
+  }
+
+  // Never overwrite the output of an earlier part
+  const auto& outs = fResume.outputs;
+  if( find(ALL(outs), fOutFileName.Data()) != outs.end() ) {
+    TString newname(fOutFileName);
+    Ssiz_t dot = newname.Last('.');
+    if( dot == kNPOS || newname.Index('/', dot) != kNPOS )
+      dot = newname.Length();
+    newname.Insert(dot, Form("_part%u", static_cast<UInt_t>(outs.size())));
+    fOutFileName = newname;
+  }
+  fResumeNev = fResume.nev;
+  if( fVerbose>0 )
+    cout << "Resuming analysis after event " << fResumeNev << " from "
+         << fCheckpointFileName << ", output to " << fOutFileName << endl;
+  return 0;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::RestoreCheckpoint()
+{
+  // Restore the counters and cut statistics saved in the checkpoint being
+  // resumed, once the event loop has reached it again
+
+  for( auto& theCounter : fCounters ) {
+    auto it = fResume.counters.find(theCounter.name);
+    if( it != fResume.counters.end() )
+      theCounter.count = it->second;
+  }
+  THaCutList* cuts = fContext->GetCuts();
+  for( const auto& c : fResume.cuts ) {
+    if( THaCut* cut = cuts->FindCut(c.first.c_str()) )
+      cut->SetCounts(c.second.first, c.second.second);
+  }
+  fResumeNev = 0;
+}
+
 //_____________________________________________________________________________
 void THaAnalyzer::SetCodaVersion( Int_t vers )
 {
@@ -1525,6 +3342,384 @@ void THaAnalyzer::PrepareModuleList()
   fAnalysisModules.insert(fAnalysisModules.end(), ALL(fApps));
   fAnalysisModules.insert(fAnalysisModules.end(), ALL(fInterStage));
   fAnalysisModules.insert(fAnalysisModules.end(), ALL(fPhysics));
+
+  // Apparatuses that must be decoded in every event even when sampling
+  fSampleExempt.clear();
+  for( auto* app : fApps ) {
+    TIter next(app->GetDetectors());
+    while( TObject* det = next() ) {
+      if( det->InheritsFrom(THaHelicityDet::Class()) ) {
+        fSampleExempt.push_back(app);
+        break;
+      }
+    }
+  }
+
+  // Build the per-stage schedule of module calls for PhysicsAnalysis().
+  // Each stage gets only the modules that actually do something in it,
+  // so the event loop need not test module types or stages.
+  for( auto& theStage : fStages )
+    theStage.tasks.clear();
+
+  // With lazy clearing, modules that allow it are cleared by their first
+  // call in each event rather than up front
+  fEagerClear.clear();
+  for( auto* mod : fAnalysisModules ) {
+    if( !fLazyClear || !mod->IsLazyClear() )
+      fEagerClear.push_back(mod);
+  }
+  auto schedule = [this]( Int_t n, THaAnalysisObject* module,
+                          std::function<Int_t()> run ) {
+    assert( n >= 0 && static_cast<size_t>(n) < fStages.size() );
+    Stage_t& theStage = fStages[n];
+    if( fLazyClear && module->IsLazyClear() ) {
+      run = [this,module,run]{
+        module->ClearForEvent(fClearGen);
+        return run();
+      };
+    }
+    theStage.tasks.emplace_back(module, std::move(run),
+                                fBench->Register(module->GetName(),
+                                                 theStage.bench));
+  };
+  for( auto* app : fApps ) {
+    schedule(kDecode, app,
+             [this,app]{ app->Decode(*fEvData); return Int_t(kOK); });
+    schedule(kCoarseRecon, app,
+             [app]{ app->CoarseReconstruct(); return Int_t(kOK); });
+    schedule(kReconstruct, app,
+             [app]{ app->Reconstruct(); return Int_t(kOK); });
+  }
+  // Within each stage, inter-stage modules run last
+  for( auto* spectro : fSpectrometers ) {
+    schedule(kCoarseTrack, spectro,
+             [spectro]{ spectro->CoarseTrack(); return Int_t(kOK); });
+    schedule(kTracking, spectro,
+             [spectro]{ spectro->Track(); return Int_t(kOK); });
+  }
+  // The apparatus calls scheduled so far are independent of each other
+  // and may run concurrently
+  for( Int_t n = kDecode; n <= kReconstruct; ++n )
+    fStages[n].nconcurrent = fStages[n].tasks.size();
+  for( auto* physmod : SchedulePhysics() ) {
+    schedule(kPhysics, physmod,
+             [this,physmod]{ return physmod->Process(*fEvData); });
+  }
+  for( auto* mod : fInterStage ) {
+    Int_t n = mod->GetStage();
+    if( n < kDecode || n > kPhysics ) {
+      Warning( "PrepareModuleList", "Inter-stage module %s has invalid "
+               "stage %d. Module will not be run.", mod->GetName(), n );
+      continue;
+    }
+    schedule(n, mod,
+             [this,mod]{ mod->Process(*fEvData); return Int_t(kOK); });
+  }
+
+  // Wrap the concurrent tasks for the task pool. A task that throws
+  // records its module for the error message in PhysicsAnalysis().
+  // Each task also keeps a running average of its time, which
+  // OrderConcurrentTasks uses to start the most expensive ones first.
+  for( Int_t n = 0; n < static_cast<Int_t>(fStages.size()); ++n ) {
+    Stage_t& theStage = fStages[n];
+    theStage.group.clear();
+    theStage.wrappers.clear();
+    theStage.cost.assign(theStage.nconcurrent, 0.0);
+    theStage.failed.assign(theStage.nconcurrent, nullptr);
+    theStage.ncalls = 0;
+    if( !fTaskPool || theStage.nconcurrent < 2 )
+      continue;
+    for( UInt_t i = 0; i < theStage.nconcurrent; ++i ) {
+      theStage.wrappers.emplace_back([this,n,i]{
+        Stage_t& st = fStages[n];
+        const StageTask_t& task = st.tasks[i];
+        try {
+          if( fDoBench ) fBench->Start(task.bench);
+          Double_t start = WallTime();
+          task.run();
+          st.cost[i] += 0.05 * (WallTime() - start - st.cost[i]);
+          if( fDoBench ) fBench->Stop(task.bench);
+        }
+        catch( ... ) {
+          st.failed[i] = task.module;
+          throw;
+        }
+      });
+    }
+    theStage.group = theStage.wrappers;
+  }
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::BuildRocDemand()
+{
+  // If demand decoding is enabled, tell the decoder which crates
+  // the apparatuses and event type handlers need. Also collect the crates
+  // needed for the trigger selection, if any.
+
+  if( !fEvData )
+    return;
+  fTrigCrates.clear();
+  if( fTrigMask != 0 && fTrigData ) {
+    if( fTrigData->GetTriggerCrates(fTrigCrates) <= 0 )
+      Warning( "BuildRocDemand", "%s has no trigger bits. Selecting "
+               "triggers by event type.", fTrigData->GetName() );
+    sort( ALL(fTrigCrates) );
+    fTrigCrates.erase( unique(ALL(fTrigCrates)), fTrigCrates.end() );
+  }
+  fEvData->ClearRocDemand();
+  // With input in foreign byte order, the ROC banks that are not decoded
+  // need not be swapped either
+  auto* run = dynamic_cast<THaRun*>(fRun);
+  if( run )
+    run->SetSwapRocs(vector<UInt_t>());
+  if( !fDemandDecode )
+    return;
+
+  vector<UInt_t> crates;
+  for( auto* app : fApps ) {
+    if( app->GetCrates(crates) < 0 )
+      return;
+  }
+  for( auto* handler : fEvtHandlers ) {
+    if( handler->GetCrates(crates) < 0 )
+      return;
+  }
+  fEvData->SetRocDemand(crates);
+  if( run ) {
+    // The pre-filter reads the trigger crates before decoding
+    vector<UInt_t> swap(crates);
+    swap.insert(swap.end(), ALL(fTrigCrates));
+    run->SetSwapRocs(swap);
+  }
+
+  if( fVerbose > 1 ) {
+    sort( ALL(crates) );
+    crates.erase( unique(ALL(crates)), crates.end() );
+    cout << "Decoding only crates";
+    for( auto crate : crates )
+      cout << " " << crate;
+    cout << endl;
+  }
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::BuildEvtDispatch()
+{
+  // Build the tables of event type handlers to call for each event type,
+  // so that each event is given only to the handlers registered for its
+  // type. Handlers without event types get all events. Asynchronous
+  // handlers go into a separate table if their thread is running.
+  // Changes to the handlers' event types take effect at the next Process().
+
+  // Largest event type with a table entry. Events of higher types
+  // go to fEvtOther.
+  const UInt_t kMaxDispatchType = 1023;
+
+  fEvtDispatch.clear();
+  fEvtOther.clear();
+  fAsyncDispatch.clear();
+  UInt_t ntypes = 0;
+  for( auto* obj : fEvtHandlers ) {
+    for( auto type : obj->GetEvtTypes() )
+      if( type <= kMaxDispatchType )
+        ntypes = std::max(ntypes, type+1);
+  }
+  fEvtDispatch.resize(ntypes);
+  for( auto* obj : fEvtHandlers ) {
+    auto types = obj->GetEvtTypes();
+    bool async = ( fEvtThread && obj->IsAsync() && obj != fEpicsHandler &&
+                   !types.empty() &&
+                   all_of(ALL(types), [ntypes]( UInt_t t ) { return t < ntypes; }) );
+    if( obj->IsAsync() && !async && fVerbose > 0 )
+      Warning( "BuildEvtDispatch", "Running event type handler %s in the "
+               "main event loop.", obj->GetName() );
+    if( async ) {
+      if( fAsyncDispatch.size() < ntypes )
+        fAsyncDispatch.resize(ntypes);
+      for( auto type : types ) {
+        auto& handlers = fAsyncDispatch[type];
+        if( find(ALL(handlers), obj) == handlers.end() )
+          handlers.push_back(obj);
+      }
+    } else if( types.empty() ) {
+      for( auto& handlers : fEvtDispatch )
+        handlers.push_back(obj);
+      fEvtOther.push_back(obj);
+    } else {
+      bool other = false;
+      for( auto type : types ) {
+        if( type >= ntypes ) {
+          other = true;
+          continue;
+        }
+        auto& handlers = fEvtDispatch[type];
+        if( find(ALL(handlers), obj) == handlers.end() )
+          handlers.push_back(obj);
+      }
+      if( other )
+        fEvtOther.push_back(obj);
+    }
+  }
+}
+
+//_____________________________________________________________________________
+vector<THaPhysicsModule*> THaAnalyzer::SchedulePhysics() const
+{
+  // Return the physics modules in the order in which to process them.
+  //
+  // Physics modules declare the modules whose data they use at
+  // initialization, usually by looking them up with FindModule (see
+  // THaAnalysisObject::AddDependency). Each module is placed after the
+  // physics modules it depends on. Otherwise, the order of the gHaPhysics
+  // list is kept. Dependencies on apparatuses are always satisfied because
+  // the apparatuses are processed in earlier stages.
+  //
+  // With EnableSkipUnusedPhysics(), modules whose results are not needed
+  // are left out.
+
+  static const char* const here = "SchedulePhysics";
+
+  const size_t n = fPhysics.size();
+  vector<vector<size_t>> deps(n);
+  for( size_t i = 0; i < n; ++i ) {
+    for( const auto* dep : fPhysics[i]->GetDependencies() ) {
+      auto it = std::find(ALL(fPhysics), dep);
+      if( it != fPhysics.end() )
+        deps[i].push_back(it - fPhysics.begin());
+    }
+  }
+
+  // Topological sort, preferring the original order
+  vector<size_t> order;
+  order.reserve(n);
+  vector<bool> done(n, false);
+  while( order.size() < n ) {
+    size_t next = n;
+    for( size_t i = 0; i < n && next == n; ++i ) {
+      if( done[i] )
+        continue;
+      if( std::all_of(ALL(deps[i]), [&done]( size_t j ){ return done[j]; }) )
+        next = i;
+    }
+    if( next == n ) {
+      // Circular dependency. Keep the remaining modules in list order.
+      Warning( here, "Circular dependency between physics modules. "
+               "Processing the remaining ones in list order." );
+      for( size_t i = 0; i < n; ++i )
+        if( !done[i] ) order.push_back(i);
+      break;
+    }
+    done[next] = true;
+    order.push_back(next);
+  }
+  if( fVerbose>1 && !std::is_sorted(ALL(order)) ) {
+    cout << "Physics modules reordered according to dependencies:";
+    for( auto i : order )
+      cout << " " << fPhysics[i]->GetName();
+    cout << endl;
+  }
+
+  // Determine which modules are needed, starting from the last one
+  vector<bool> needed(n, !fSkipUnused);
+  if( fSkipUnused ) {
+    const THashList* cuts = fContext->GetCuts()->GetCutList();
+    for( auto it = order.rbegin(); it != order.rend(); ++it ) {
+      const THaPhysicsModule* mod = fPhysics[*it];
+      const char* prefix = mod->GetPrefix();
+      bool used = needed[*it] || !prefix || !*prefix ||
+        (fOutput && fOutput->References(prefix));
+      if( !used && cuts ) {
+        TIter next(cuts);
+        while( auto* cut = static_cast<THaCut*>(next()) ) {
+          if( strstr(cut->GetTitle(), prefix) ) {
+            used = true;
+            break;
+          }
+        }
+      }
+      needed[*it] = used;
+      if( used )
+        for( auto j : deps[*it] ) needed[j] = true;
+    }
+  }
+  vector<THaPhysicsModule*> sched;
+  sched.reserve(n);
+  for( auto i : order ) {
+    if( needed[i] )
+      sched.push_back(fPhysics[i]);
+    else if( fVerbose>1 )
+      cout << "Skipping physics module " << fPhysics[i]->GetName()
+           << ": results not used" << endl;
+  }
+  return sched;
+}
+
+//_____________________________________________________________________________
+Int_t THaAnalyzer::RunStage( Int_t n, THaAnalysisObject*& obj )
+{
+  // Run the module calls scheduled for analysis stage 'n'. 'obj' is set to
+  // the module currently being processed, for error messages.
+  // Returns kOK, kTerminate or kFatal. The latter stops processing of the
+  // stage. Only physics modules return anything other than kOK.
+  // With benchmarks enabled, each module's time is recorded separately.
+
+  Stage_t& theStage = fStages[n];
+  size_t first = 0;
+  if( !theStage.group.empty() ) {
+    // Apparatuses, in parallel. These always return kOK.
+    if( ++theStage.ncalls == kReorderInterval )
+      OrderConcurrentTasks(theStage);
+    std::fill(ALL(theStage.failed), nullptr);
+    try {
+      fTaskPool->Run(theStage.group);
+    }
+    catch( ... ) {
+      for( auto* mod : theStage.failed ) {
+        if( mod ) {
+          obj = mod;
+          break;
+        }
+      }
+      throw;
+    }
+    first = theStage.group.size();
+  }
+  Int_t code = kOK;
+  for( size_t i = first; i < theStage.tasks.size(); ++i ) {
+    const auto& task = theStage.tasks[i];
+    obj = task.module;
+    if( fDoBench ) fBench->Start(task.bench);
+    Int_t err = task.run();
+    if( fDoBench ) fBench->Stop(task.bench);
+    if( err == THaPhysicsModule::kTerminate )
+      code = kTerminate;
+    else if( err == THaPhysicsModule::kFatal )
+      return kFatal;
+  }
+  return code;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::OrderConcurrentTasks( Stage_t& theStage )
+{
+  // Sort the concurrent tasks of 'theStage' by decreasing average time.
+  // The task pool starts the tasks in this order, and idle threads take
+  // the next one, so starting the longest first keeps a large apparatus
+  // from running alone at the end of the stage while the other threads
+  // wait. The time per event varies a lot, but the relative cost of the
+  // apparatuses is fairly stable, so this is redone only every
+  // kReorderInterval events.
+
+  theStage.ncalls = 0;
+  UInt_t ntask = theStage.wrappers.size();
+  vector<UInt_t> order(ntask);
+  for( UInt_t i = 0; i < ntask; ++i )
+    order[i] = i;
+  std::stable_sort(ALL(order), [&theStage]( UInt_t a, UInt_t b ) {
+    return theStage.cost[a] > theStage.cost[b]; });
+  for( UInt_t k = 0; k < ntask; ++k )
+    theStage.group[k] = theStage.wrappers[order[k]];
 }
 
 //_____________________________________________________________________________
@@ -9,7 +9,14 @@
 
 #include "TObject.h"
 #include "TString.h"
+#include "TDatime.h"
+#include "Database.h"
+#include "CounterShards.h"
 #include <vector>
+#include <map>
+#include <string>
+#include <functional>
+#include <utility>
 
 class THaEvent;
 class THaRunBase;
@@ -17,9 +24,7 @@ class THaOutput;
 class TList;
 class TIter;
 class TFile;
-class TDatime;
 class THaCut;
-class THaBenchmark;
 class THaEvData;
 class THaPostProcess;
 class THaCrateMap;
@@ -31,6 +36,14 @@ class THaPhysicsModule;
 class THaAnalysisObject;
 namespace Podd {
   class InterStageModule;
+  class EventQueue;
+  class EvtHandlerThread;
+  class HistoServer;
+  class AnalysisContext;
+  class DecData;
+  class Profiler;
+  class LatencyHistogram;
+  class TaskPool;
 }
 
 class THaAnalyzer : public TObject {
@@ -48,20 +61,49 @@ public:
           Int_t  Process( THaRunBase& run ) { return Process(&run); }
   virtual void   Print( Option_t* opt="" ) const;
 
+  void           EnableAllocTracking( Bool_t b = true );
   void           EnableBenchmarks( Bool_t b = true );
+  void           EnableDemandDecoding( Bool_t b = true );
+  void           EnableFastReInit( Bool_t b = true );
   void           EnableHelicity( Bool_t b = true );
+  void           EnableHotReload( Bool_t b = true );
+  void           EnableLatencyStats( Bool_t b = true );
+  void           EnableLazyClear( Bool_t b = true );
+  void           EnableOnlineMode( Bool_t b = true );
   void           EnableOtherEvents( Bool_t b = true );
   void           EnableOverwrite( Bool_t b = true );
+  void           EnableParallelApps( Bool_t b = true );
+  void           EnablePerfSummary( Bool_t b = true );
   void           EnablePhysicsEvents( Bool_t b = true );
+  void           EnablePipeline( Bool_t b = true );
+  void           EnablePrefilter( Bool_t b = true );
+  void           EnableResume( Bool_t b = true );
   void           EnableRunUpdate( Bool_t b = true );
   void           EnableScalers( Bool_t b = true );   // archaic
+  void           EnableShardMode( Bool_t b = true );
+  void           EnableSkipUnusedPhysics( Bool_t b = true );
+  void           EnableSkipUnusedVariables( Bool_t b = true );
   void           EnableSlowControl( Bool_t b = true );
   const char*    GetOutFileName()      const  { return fOutFileName.Data(); }
   const char*    GetCutFileName()      const  { return fCutFileName.Data(); }
   const char*    GetOdefFileName()     const  { return fOdefFileName.Data(); }
   const char*    GetSummaryFileName()  const  { return fSummaryFileName.Data(); }
+  const char*    GetProfileFileName()  const  { return fProfileFileName.Data(); }
+  const char*    GetSlowEventFileName() const { return fSlowEvFileName.Data(); }
+  const char*    GetCheckpointFileName() const { return fCheckpointFileName.Data(); }
+  UInt_t         GetCheckpointInterval() const { return fCheckpointInterval; }
+  const Podd::Profiler*
+                 GetProfiler()         const  { return fBench; }
+  const Podd::LatencyHistogram*
+                 GetEventLatency()     const  { return fEvLatency; }
   TFile*         GetOutFile()          const  { return fFile; }
   Int_t          GetCompressionLevel() const  { return fCompress; }
+  Int_t          GetCompressionAlgorithm() const { return fCompressAlgo; }
+  Podd::AnalysisContext*
+                 GetContext()          const  { return fContext; }
+  UInt_t         GetNumThreads()       const  { return fNThreads; }
+  UInt_t         GetBatchSize()        const  { return fBatchSize; }
+  UInt_t         GetOutputThreads()    const  { return fOutThreads; }
   THaEvent*      GetEvent()            const  { return fEvent; }
   THaEvData*     GetDecoder()          const;
   const std::vector<THaApparatus*>&
@@ -74,10 +116,22 @@ public:
                  GetEvtHandlers()      const  { return fEvtHandlers; }
   const std::vector<THaPostProcess*>&
                  GetPostProcess()      const  { return fPostProcess; }
+  Bool_t         DemandDecodingEnabled() const { return fDemandDecode; }
+  Bool_t         FastReInitEnabled()   const  { return fFastReInit; }
   Bool_t         HasStarted()          const  { return fAnalysisStarted; }
   Bool_t         HelicityEnabled()     const  { return fDoHelicity; }
+  Bool_t         HotReloadEnabled()    const  { return fHotReload; }
+  Bool_t         LazyClearEnabled()    const  { return fLazyClear; }
+  Bool_t         OnlineModeEnabled()   const  { return fOnlineMode; }
+  Bool_t         ParallelAppsEnabled() const  { return fDoParallelApps; }
   Bool_t         PhysicsEnabled()      const  { return fDoPhysics; }
+  Bool_t         PipelineEnabled()     const  { return fDoPipeline; }
+  Bool_t         PrefilterEnabled()    const  { return fDoPrefilter; }
+  Bool_t         ResumeEnabled()       const  { return fDoResume; }
   Bool_t         OtherEventsEnabled()  const  { return fDoOtherEvents; }
+  Bool_t         ShardModeEnabled()    const  { return fDoShard; }
+  Bool_t         SkipUnusedPhysicsEnabled() const { return fSkipUnused; }
+  Bool_t         SkipUnusedVariablesEnabled() const { return fSkipUnusedVars; }
   Bool_t         SlowControlEnabled()  const  { return fDoSlowControl; }
   virtual Int_t  SetCountMode( Int_t mode );
   void           SetCrateMapFileName( const char* name );
@@ -86,8 +140,36 @@ public:
   void           SetCutFile( const char* name )     { fCutFileName = name; }
   void           SetOdefFile( const char* name )    { fOdefFileName = name; }
   void           SetSummaryFile( const char* name ) { fSummaryFileName = name; }
+  void           SetProfileFile( const char* name ) { fProfileFileName = name; }
+  void           SetSlowEventFile( const char* name, UInt_t nslow = 100 );
+  void           SetCheckpointFile( const char* name, UInt_t interval = 10000 );
   void           SetCompressionLevel( Int_t level ) { fCompress = level; }
+  void           SetCompressionAlgorithm( Int_t algo ) { fCompressAlgo = algo; }
+  void           SetContext( Podd::AnalysisContext* context );
   void           SetMarkInterval( UInt_t interval ) { fMarkInterval = interval; }
+  // Online mode parameters (see EnableOnlineMode)
+  void           SetEventDeadline( Double_t t )     { fEvDeadline = t; }
+  void           SetSampleInterval( UInt_t n )      { fSampleInterval = n; }
+  void           SetSnapshotFile( const char* name, Double_t interval = 10 );
+  void           SetFlushInterval( Double_t t )     { fFlushInterval = t; }
+  Double_t       GetFlushInterval()    const  { return fFlushInterval; }
+  void           SetReloadInterval( Double_t t )    { fReloadInterval = t; }
+  Double_t       GetReloadInterval()   const  { return fReloadInterval; }
+  void           SetHistoServer( const char* mapfile, Double_t interval = 1,
+                                 UInt_t size = 0 );
+  void           SetNumThreads( UInt_t n );
+  void           SetBatchSize( UInt_t n );
+  Int_t          SetCpuAffinity( const char* cpus );
+  const std::vector<UInt_t>&
+                 GetCpuAffinity()      const  { return fCpuSet; }
+  void           SetSampling( Double_t s, ULong64_t seed = 0 );
+  Double_t       GetSampling()         const  { return fSampling; }
+  void           SetTriggerSelection( UInt_t mask, Podd::DecData* trigdata = nullptr );
+  UInt_t         GetTriggerSelection() const  { return fTrigMask; }
+  void           SetMemoryBudget( ULong64_t bytes ) { fMemBudget = bytes; }
+  ULong64_t      GetMemoryBudget()     const  { return fMemBudget; }
+  void           PrintMemoryUsage()    const;
+  void           SetOutputThreads( UInt_t n );
   void           SetVerbosity( Int_t level )        { fVerbose = level; }
   void           SetCodaVersion(Int_t vers);
 
@@ -107,37 +189,79 @@ public:
   };
 
 protected:
+  // Module call scheduled for an analysis stage
+  class StageTask_t {
+  public:
+    StageTask_t( THaAnalysisObject* _module, std::function<Int_t()> _run,
+                 UInt_t _bench )
+      : module(_module), run(std::move(_run)), bench(_bench) {}
+    THaAnalysisObject*     module;
+    std::function<Int_t()> run;
+    UInt_t                 bench;   // Timer handle
+  };
   // Test and histogram blocks
   class Stage_t {
   public:
     Stage_t( Int_t _key, Int_t _countkey, const char* _name )
       : key(_key), countkey(_countkey), name(_name), cut_list(nullptr),
-        hist_list(nullptr), master_cut(nullptr) {}
+        hist_list(nullptr), master_cut(nullptr), bench(0), nconcurrent(0),
+        ncalls(0) {}
     Int_t         key;
     Int_t         countkey;
     const char*   name;
     TList*        cut_list;
+    std::vector<THaCut*> cuts;  // Cuts in cut_list, set by InitCuts
     TList*        hist_list;
     THaCut*       master_cut;
+    UInt_t        bench;      // Timer handle
+    std::vector<StageTask_t> tasks;  // Module calls (see PrepareModuleList)
+    UInt_t        nconcurrent; // Leading tasks that may run concurrently
+    std::vector<std::function<void()>> group;  // Wrappers of these tasks,
+                                               // most expensive first
+    std::vector<std::function<void()>> wrappers; // Same, in task order
+    std::vector<Double_t>              cost;   // Average time per task (s)
+    std::vector<THaAnalysisObject*>    failed; // Modules that threw
+    UInt_t        ncalls;     // Events since last reordering of group
   };
   // Statistics counters and message texts
   enum {
     kNevRead = 0, kNevGood, kNevPhysics, kNevEpics, kNevOther,
     kNevPostProcess, kNevAnalyzed, kNevAccepted,
     kDecodeErr, kCodaErr, kRawDecodeTest, kDecodeTest, kCoarseTrackTest,
-    kCoarseReconTest, kTrackTest, kReconstructTest, kPhysicsTest
+    kCoarseReconTest, kTrackTest, kReconstructTest, kPhysicsTest,
+    kNevDropped, kNevSampled, kNevPrefiltered, kNevTrigSkipped
   };
   class Counter_t {
   public:
-    Counter_t( Int_t _key, const char* _description )
-      : key(_key), count(0), description(_description) {}
+    Counter_t( Int_t _key, const char* _name, const char* _description )
+      : key(_key), count(0), name(_name), description(_description) {}
     Int_t       key;
     UInt_t      count;
+    const char* name;         // Global variable is "anl.<name>"
     const char* description;
   };
 
   enum ECountMode { kCountPhysics, kCountAll, kCountRaw };
 
+  // Analysis state saved in a checkpoint file (see WriteCheckpoint)
+  class Checkpoint_t {
+  public:
+    Checkpoint_t() : nev(0), entries(0) {}
+    std::string              run;      // Input file name
+    std::vector<std::string> outputs;  // Output files, one per (resumed) job
+    UInt_t                   nev;      // Event count (fNev) at checkpoint
+    Long64_t                 entries;  // Entries in output tree of last job
+    std::map<std::string,UInt_t> counters;  // Statistics counters by name
+    std::map<std::string,std::pair<UInt_t,UInt_t>> cuts; // Cuts called/passed
+  };
+
+  // Timers, registered in this order in the constructor
+  enum EBench {
+    kBenchTotal = 0, kBenchInit, kBenchRawDecode, kBenchDecode,
+    kBenchCoarseTrack, kBenchCoarseRecon, kBenchTracking, kBenchReconstruct,
+    kBenchPhysics, kBenchOutput, kBenchCuts, kBenchPostProcess
+  };
+
   TFile*         fFile;            //The ROOT output file.
   THaOutput*     fOutput;          //Flexible ROOT output (tree, histograms)
   THaEpicsEvtHandler* fEpicsHandler; // EPICS event handler used by THaOutput
@@ -146,19 +270,54 @@ protected:
   TString        fLoadedCutFileName;//Name of last loaded cut definition file
   TString        fOdefFileName;    //Name of output definition file
   TString        fSummaryFileName; //Name of test/cut statistics output file
+  TString        fProfileFileName; //Name of timing profile output file
   THaEvent*      fEvent;           //The event structure to be written to file.
   Int_t          fWantCodaVers;    //Version of CODA assumed for file
   std::vector<Stage_t>   fStages;  //Parameters for analysis stages
   std::vector<Counter_t> fCounters;//Statistics counters
+  Podd::CounterShards fCounterShards; //!fCounters of other threads
   UInt_t         fNev;             //Number of events read during most recent replay
   UInt_t         fMarkInterval;    //Interval for printing event numbers
   Int_t          fCompress;        //Compression level for ROOT output file
+  Int_t          fCompressAlgo;    //Compression algorithm (0: ROOT default)
   Int_t          fVerbose;         //Verbosity level
   Int_t          fCountMode;       //Event counting mode (see ECountMode)
-  THaBenchmark*  fBench;           //Counters for timing statistics
+  Double_t       fEvDeadline;      //Online: analysis time budget per event (s)
+  UInt_t         fSampleInterval;  //Online: analyze every n-th event when behind
+  Double_t       fOnlineInterval;  //Online: status/snapshot interval (s)
+  Double_t       fFlushInterval;   //Min time between flushes while idle (s, 0: never)
+  Double_t       fLastFlush;       //Time of last flush of output while idle (s)
+  UInt_t         fNevFlushed;      //Event count at last flush while idle
+  Double_t       fReloadInterval;  //Hot reload: min time between database checks (s)
+  Double_t       fLastReload;      //Hot reload: time of last database check (s)
+  TString        fSnapshotFileName;//Online: histogram snapshot file
+  TString        fHistoMapFile;    //Shared memory file for live histograms
+  Double_t       fPublishInterval; //Live histogram update interval (s)
+  UInt_t         fHistoMapSize;    //Size of fHistoMapFile (bytes, 0: default)
+  Double_t       fSampling;        //Sampling: stride (>=1) or fraction (<1)
+  ULong64_t      fSampleRng;       //Sampling: random generator state
+  UInt_t         fSampleCount;     //Sampling: physics events seen
+  UInt_t         fTrigMask;        //Triggers to analyze (bit pattern, 0=all)
+  Podd::DecData* fTrigData;        //Source of trigger bits for fTrigMask
+  std::vector<UInt_t> fTrigCrates; //Crates of the trigger bits of fTrigData
+  UInt_t         fNThreads;        //Number of worker threads (<=1: serial)
+  UInt_t         fOutThreads;      //Threads for output compression (0: fNThreads)
+  UInt_t         fBatchSize;       //Events handed over per batch (pipeline mode)
+  ULong64_t      fMemBudget;       //Soft limit for memory of analysis objects (bytes, 0: none)
+  std::vector<UInt_t> fCpuSet;     //CPUs for the analysis threads (empty: any)
+  TString        fCheckpointFileName;//Checkpoint file (empty: no checkpoints)
+  UInt_t         fCheckpointInterval;//Events between checkpoints
+  UInt_t         fResumeNev;       //Event count of checkpoint being resumed (0: none)
+  Checkpoint_t   fResume;          //Checkpoint being resumed
+  Podd::Profiler* fBench;          //Counters for timing statistics
   THaEvent*      fPrevEvent;       //Event structure from last Init()
   THaRunBase*    fRun;             //Pointer to current run
   THaEvData*     fEvData;          //Instance of decoder used by us
+  Podd::EventQueue* fEvQueue;      //Read-ahead queue (pipeline mode only)
+  Podd::TaskPool* fTaskPool;       //Worker threads for parallel apparatuses
+  Podd::EvtHandlerThread* fEvtThread; //Thread for asynchronous event type handlers
+  Podd::HistoServer* fHistoServer; //Publisher of live histograms
+  Podd::AnalysisContext* fContext; //Variable/cut lists and run used (not owned)
 
   // Lists of processing modules defined for current analysis
   std::vector<THaApparatus*>           fApps;            // Apparatuses
@@ -168,9 +327,28 @@ protected:
   std::vector<Podd::InterStageModule*> fInterStage;      // Inter-stage modules
   std::vector<THaEvtTypeHandler*>      fEvtHandlers;     // Event type handlers
   std::vector<THaPostProcess*>         fPostProcess;     // Post-processing mods
+  // Event type handlers to call for each event type, in the order of
+  // fEvtHandlers (see BuildEvtDispatch)
+  std::vector<std::vector<THaEvtTypeHandler*>> fEvtDispatch;  // By event type
+  std::vector<THaEvtTypeHandler*>      fEvtOther;        // Types beyond table
+  std::vector<std::vector<THaEvtTypeHandler*>> fAsyncDispatch; // Run in fEvtThread
   // Combined list of fApps, fInterStage and fPhysics for PhysicsAnalysis.
   // Does not include fPostProcess and fEvtHandlers.
   std::vector<THaAnalysisObject*>      fAnalysisModules; // Analysis modules
+  // Apparatuses decoded even in events skipped by sampling (helicity)
+  std::vector<THaApparatus*>           fSampleExempt;
+  std::vector<THaAnalysisObject*>      fEagerClear; // Modules cleared before decoding
+
+  // Database files read by a module at its last initialization
+  class ModuleInit_t {
+  public:
+    TDatime                       date;   // Date the module was initialized for
+    std::vector<Podd::DBFileInfo> files;  // Database files opened by Init
+  };
+  std::map<const THaAnalysisObject*, ModuleInit_t> fModuleInit; // For fast re-init/hot reload
+  UInt_t         fNReInit;         // Modules (re)initialized in last Init()
+  std::vector<Podd::DBFileInfo> fCrateMapFiles; // Crate map files, for hot reload
+  TDatime        fCrateMapDate;    // Date the crate map was read for
 
   // Status and control flags
   Bool_t         fIsInit;          // Init() called successfully
@@ -179,13 +357,73 @@ protected:
   Bool_t         fUpdateRun;       // Update run parameters during replay
   Bool_t         fOverwrite;       // Overwrite existing output files
   Bool_t         fDoBench;         // Collect detailed timing statistics
+  Bool_t         fDoAllocStats;    // Also count heap allocations
+  Bool_t         fDoLatency;       // Also record per-event stage latencies
+  Bool_t         fDoPerfSummary;   // Write performance trees to output file
   Bool_t         fDoHelicity;      // Enable helicity decoding
   Bool_t         fDoPhysics;       // Enable physics event processing
   Bool_t         fDoOtherEvents;   // Enable other event processing
   Bool_t         fDoSlowControl;   // Enable slow control processing
+  Bool_t         fDoPipeline;      // Read events in a separate thread
+  Bool_t         fDoParallelApps;  // Run apparatuses concurrently
+  Bool_t         fDoShard;         // Ignore events before first event
+  Bool_t         fSkipUnused;      // Skip physics modules with unused output
+  Bool_t         fSkipUnusedVars;  // Let modules skip unused global variables
+  Bool_t         fFastReInit;      // Skip re-init of modules with unchanged database
+  Bool_t         fReuseInit;       // Current Init() may reuse module initializations
+  Bool_t         fHotReload;       // Reload changed database files during replay
+  Bool_t         fOnlineMode;      // Low-latency online replay
+  Bool_t         fDoPrefilter;     // Skip unneeded events before decoding
+  Bool_t         fLazyClear;       // Clear modules on first use in event
+  ULong64_t      fClearGen;        // Generation of current event (lazy clear)
+  Bool_t         fDemandDecode;    // Decode only crates used by the modules
+  Bool_t         fDoResume;        // Continue after last checkpoint, if any
 
   // Variables used by analysis functions
   Bool_t         fFirstPhysics;    // Status flag for physics analysis
+  Bool_t         fEvSkipped;       // Current event skipped by pre-filter
+  Bool_t         fSampleKeep;      // Pre-filter selected current event
+  Bool_t         fTrigKeep;        // Pre-filter selected trigger of current event
+
+  // Online mode bookkeeping (see OnlineDropEvent)
+  class OnlineStat_t {
+  public:
+    OnlineStat_t()
+      : lastreport(0), lastpublish(0), credit(0), nseen(0), nbehind(0), nread(0),
+        nseenlast(0), ndroplast(0) {}
+    Double_t lastreport; // Time of last status report (s)
+    Double_t lastpublish;// Time of last live histogram update (s)
+    Double_t credit;     // Unused analysis time budget (s)
+    UInt_t   nseen;      // Physics events seen
+    UInt_t   nbehind;    // Consecutive physics events seen while behind
+    UInt_t   nread, nseenlast, ndroplast; // Counts at last report
+  };
+  OnlineStat_t   fOnline;
+
+  // Per-event timing (see EnableLatencyStats and SetSlowEventFile)
+  class SlowEvent_t {
+  public:
+    SlowEvent_t( UInt_t _nev, UInt_t _evnum, UInt_t _evtype, Double_t _time )
+      : nev(_nev), evnum(_evnum), evtype(_evtype), time(_time) {}
+    UInt_t   nev;     // Event count, as used by THaRunBase::SetEventRange
+    UInt_t   evnum;   // Event number
+    UInt_t   evtype;  // Event type
+    Double_t time;    // Wall time spent on the event (s)
+    std::vector<Double_t> timers; // Time in each of fEvTimers (s)
+  };
+  TString        fSlowEvFileName;  // Output file for slowest events
+  UInt_t         fNslow;           // Number of slowest events to report
+  Bool_t         fDoEvTiming;      // Time each event in current Process()
+  Double_t       fEvStart;         // Start time of current event (s)
+  std::vector<UInt_t>      fEvTimers;   // Timers included in breakdown
+  std::vector<Double_t>    fEvTimes;    // Their totals at start of event
+  std::vector<SlowEvent_t> fSlowEvents; // Slowest events (min-heap)
+  Podd::LatencyHistogram*  fEvLatency;  // Wall time per event
+
+  // Performance global variables (see DefinePerfVariables)
+  Bool_t         fPerfVarsDefined; // Variables exist in fContext->GetVars()
+  std::vector<Double_t>    fPerfTime;   // Time of each stage (s)
+  std::vector<Double_t>    fPerfAllocs; // Heap allocations in each stage
 
   // Main analysis functions
   virtual Int_t  BeginAnalysis();
@@ -197,22 +435,56 @@ protected:
   virtual Int_t  OtherAnalysis( Int_t code );
   virtual Int_t  PostProcess( Int_t code );
   virtual Int_t  ReadOneEvent();
+  virtual Int_t  StartPipeline();
+  virtual void   StopPipeline();
+  virtual Int_t  StartEvtThread();
+  virtual Int_t  StopEvtThread();
+  virtual Int_t  StartHistoServer();
+  virtual void   StopHistoServer();
+  virtual void   PublishHistos( Bool_t force = false );
 
   // Support methods & data
   void           ClearCounters();
+  void           CollectCounters();
   UInt_t         GetCount( Int_t which ) const;
-  UInt_t         Incr( Int_t which );
+  void           Incr( Int_t which );
   virtual bool   EvalStage( int n );
   virtual void   InitCounters();
   virtual void   InitCuts();
+  virtual void   InitThreads();
   virtual void   InitStages();
   virtual Int_t  InitModules( const std::vector<THaAnalysisObject*>& module_list,
                               TDatime& run_time );
   virtual Int_t  InitOutput( const std::vector<THaAnalysisObject*>& module_list );
+  virtual void   PreloadDatabase( const std::vector<THaAnalysisObject*>& module_list,
+                                  const TDatime& run_time );
   virtual void   PrepareModuleList();
+  virtual void   BuildEvtDispatch();
+  virtual void   BuildRocDemand();
+  virtual std::vector<THaPhysicsModule*> SchedulePhysics() const;
+          Int_t  RunStage( Int_t n, THaAnalysisObject*& obj );
+          void   OrderConcurrentTasks( Stage_t& theStage );
   virtual void   PrintCounters() const;
+  virtual void   CheckMemoryBudget( const char* here ) const;
+  virtual Bool_t OnlineDropEvent();
+  virtual Bool_t SampleEvent();
+  virtual Bool_t PrefilterEvent( const UInt_t* evbuffer );
+  virtual Bool_t TriggerSelected( UInt_t evtype, const UInt_t* evbuffer = nullptr );
+  virtual void   OnlineReport( Bool_t final = false );
+  virtual void   FlushIdle();
+  virtual Int_t  HotReload();
   virtual void   PrintScalers() const;  // archaic
   virtual void   PrintCutSummary() const;
+          Int_t  WriteProfile() const;
+          void   StartEventTiming();
+          void   EndEventTiming( UInt_t evnum );
+          Int_t  WriteSlowEvents() const;
+          Int_t  DefinePerfVariables( Bool_t remove = false );
+          void   UpdatePerfVariables();
+          Int_t  WritePerfSummary();
+  virtual Int_t  ReadCheckpoint( const THaRunBase* run );
+  virtual Int_t  WriteCheckpoint( UInt_t nev );
+  virtual void   RestoreCheckpoint();
 
   static THaAnalyzer* fgAnalyzer;  //Pointer to instance of this class
 
@@ -220,6 +492,7 @@ protected:
 
   // In-class constants
   static const char* const kMasterCutName;
+  static const UInt_t      kReorderInterval = 256; // Events between task reorderings
   static const char* const kDefaultOdefFile;
 
 private:
@@ -237,9 +510,14 @@ inline UInt_t THaAnalyzer::GetCount( Int_t which ) const
 }
 
 //_____________________________________________________________________________
-inline UInt_t THaAnalyzer::Incr( Int_t which )
+inline void THaAnalyzer::Incr( Int_t which )
 {
-  return ++(fCounters[which].count);
+  // Threads other than the main thread count in fCounterShards, which are
+  // added to fCounters by CollectCounters()
+  if( Podd::CounterShards::IsMainThread() )
+    ++(fCounters[which].count);
+  else
+    fCounterShards.Incr(which);
 }
 
 #endif
@@ -80,10 +80,13 @@ Int_t THaApparatus::AddDetector( THaDetector* pdet, Bool_t quiet, Bool_t first )
     return -1;
   }
   pdet->SetApparatus(this);
-  if( first )
+  if( first ) {
     fDetectors->AddFirst( pdet );
-  else
+    fDetArray.insert( fDetArray.begin(), pdet );
+  } else {
     fDetectors->AddLast( pdet );
+    fDetArray.push_back( pdet );
+  }
 
   return 0;
 }
@@ -108,8 +111,7 @@ void THaApparatus::Clear( Option_t* opt )
   // No point in doing this during Init. Our own Init will call the detectors'
   // Init() anyway, which will call the detectors' Clear() in turn
   if( !strchr(opt,'I') ) {
-    TIter next(fDetectors);
-    while( auto* theDetector = static_cast<THaDetector*>( next() )) {
+    for( auto* theDetector : fDetArray ) {
 #ifdef WITH_DEBUG
       if( fDebug>1 ) cout << "Clearing " << theDetector->GetName()
 			  << "... " << flush;
@@ -127,8 +129,7 @@ Int_t THaApparatus::Decode( const THaEvData& evdata )
 {
   // Call the Decode() method for all detectors defined for this apparatus.
 
-  TIter next(fDetectors);
-  while( auto* theDetector = static_cast<THaDetector*>( next() )) {
+  for( auto* theDetector : fDetArray ) {
 #ifdef WITH_DEBUG
     if( fDebug>1 ) cout << "Decoding " << theDetector->GetName()
 			<< "... " << flush;
@@ -187,6 +188,9 @@ THaAnalysisObject::EStatus THaApparatus::Init( const TDatime& run_time )
   if( THaAnalysisObject::Init( run_time ) )
     return fStatus;
 
+  // The event loop (Clear, Decode) iterates over fDetArray. Rebuild it here
+  // in case fDetectors was modified directly via GetDetectors().
+  fDetArray.clear();
   TIter next(fDetectors);
   while( TObject* obj = next() ) {
     if( !obj->IsA()->InheritsFrom("THaDetector")) {
@@ -196,6 +200,7 @@ THaAnalysisObject::EStatus THaApparatus::Init( const TDatime& run_time )
       fStatus = kInitError;
     } else {
       auto* theDetector = static_cast<THaDetector*>( obj );
+      fDetArray.push_back( theDetector );
 #ifdef WITH_DEBUG
       if( fDebug>0 ) cout << "Initializing " 
 			  << theDetector->GetName() << "... "
@@ -218,6 +223,23 @@ THaAnalysisObject::EStatus THaApparatus::Init( const TDatime& run_time )
   return fStatus;
 }
 
+//_____________________________________________________________________________
+Int_t THaApparatus::GetCrates( std::vector<UInt_t>& crates ) const
+{
+  // Append the crates needed by this apparatus to 'crates'. The default is
+  // the crates of all its detectors. Returns the number of crates added,
+  // or -1 if all crates must be decoded.
+
+  Int_t n = 0;
+  for( auto* theDetector : fDetArray ) {
+    Int_t ret = theDetector->GetCrates(crates);
+    if( ret < 0 )
+      return -1;
+    n += ret;
+  }
+  return n;
+}
+
 //_____________________________________________________________________________
 void THaApparatus::Print( Option_t* opt ) const
 { 
@@ -243,5 +265,17 @@ void THaApparatus::SetDebugAll( Int_t level )
   }
 }
 
+//_____________________________________________________________________________
+void THaApparatus::UpdateVariableUsage()
+{
+  // Let all detectors of this apparatus update their variable usage
+  // information
+
+  TIter next(fDetectors);
+  while( auto* theDetector = static_cast<THaDetector*>( next() )) {
+    theDetector->UpdateVariableUsage();
+  }
+}
+
 //_____________________________________________________________________________
 ClassImp(THaApparatus)
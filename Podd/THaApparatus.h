@@ -8,6 +8,7 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "THaAnalysisObject.h"
+#include <vector>
 
 class THaDetector;
 class THaEvData;
@@ -33,9 +34,12 @@ public:
   virtual Int_t        CoarseReconstruct() { return 0; }
   virtual Int_t        Reconstruct() = 0;
   virtual void         SetDebugAll( Int_t level );
+  virtual void         UpdateVariableUsage();
+  virtual Int_t        GetCrates( std::vector<UInt_t>& crates ) const;
 
 protected:
   TList*         fDetectors;    // List of all detectors for this apparatus
+  std::vector<THaDetector*> fDetArray; //! fDetectors as typed array, for event loop
 
   THaApparatus( const char* name, const char* description );
   THaApparatus( );
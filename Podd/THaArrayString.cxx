@@ -23,15 +23,35 @@
 //
 // THaArrayStrings are used in particular by THaFormula and THaVar.
 //
+// Since the same strings tend to be parsed over and over while formulas,
+// cuts and output definitions are initialized, the results of successful
+// parses are kept in a cache keyed by the input string.
+//
 //////////////////////////////////////////////////////////////////////////
 
 #include <iostream>
 #include <cstring>
 #include <cstdlib>
 #include "THaArrayString.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
 
 using namespace std;
 
+// Parse results of strings seen so far
+namespace {
+class ParsedString_t {
+public:
+  TString        name;
+  vector<Int_t>  dims;
+  Int_t          len;
+};
+mutex                                  gCacheMutex;
+unordered_map<string, ParsedString_t>  gCache;
+}
+
 //_____________________________________________________________________________
 THaArrayString::THaArrayString( const THaArrayString& rhs )
   : fName(rhs.fName), fNdim(rhs.fNdim), fLen(rhs.fLen), fStatus(rhs.fStatus)
@@ -74,6 +94,81 @@ THaArrayString& THaArrayString::operator=( const THaArrayString& rhs )
 
 //_____________________________________________________________________________
 Int_t THaArrayString::Parse( const char* string )
+{
+  // Parse the given string for array syntax (see DoParse).
+  // Results for strings parsed before are taken from the cache.
+
+  // Without a string, the constructor asks to parse fName
+  std::string key = (string && *string) ? string
+                    : (fLen == -1 ? fName.Data() : "");
+  if( key.empty() || key.length() > 255 )
+    return DoParse(string);
+  if( FromCache(key.c_str()) )
+    return fStatus;
+  Int_t status = DoParse(string);
+  if( status == kOK )
+    ToCache(key.c_str());
+  return status;
+}
+
+//_____________________________________________________________________________
+Bool_t THaArrayString::FromCache( const char* key )
+{
+  // Set this object from the cached result for 'key', if any
+
+  lock_guard<mutex> lock(gCacheMutex);
+  auto it = gCache.find(key);
+  if( it == gCache.end() )
+    return false;
+  const ParsedString_t& p = it->second;
+  if( fNdim>kMaxA )
+    delete [] fDim;
+  fName = p.name;
+  fNdim = p.dims.size();
+  if( fNdim>kMaxA )
+    fDim = new Int_t[fNdim];
+  Int_t* dims = (fNdim>kMaxA) ? fDim : fDimA;
+  for( Int_t i = 0; i<fNdim; i++ )
+    dims[i] = p.dims[i];
+  fLen = p.len;
+  fStatus = kOK;
+  return true;
+}
+
+//_____________________________________________________________________________
+void THaArrayString::ToCache( const char* key ) const
+{
+  // Save the results of parsing 'key', held by this object, in the cache
+
+  ParsedString_t p;
+  p.name = fName;
+  const Int_t* dims = GetDim();
+  p.dims.assign(dims, dims+fNdim);
+  p.len = fLen;
+  lock_guard<mutex> lock(gCacheMutex);
+  gCache.emplace(key, std::move(p));
+}
+
+//_____________________________________________________________________________
+void THaArrayString::ClearCache()
+{
+  // Clear the cache of parsed strings
+
+  lock_guard<mutex> lock(gCacheMutex);
+  gCache.clear();
+}
+
+//_____________________________________________________________________________
+UInt_t THaArrayString::GetCacheSize()
+{
+  // Number of strings in the cache of parsed strings
+
+  lock_guard<mutex> lock(gCacheMutex);
+  return gCache.size();
+}
+
+//_____________________________________________________________________________
+Int_t THaArrayString::DoParse( const char* string )
 {
   // Parse the given string for array syntax.
   // For multidimensional arrays, both C-style and comma-separated subscripts
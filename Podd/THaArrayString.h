@@ -41,6 +41,10 @@ public:
   virtual void    Print( Option_t* opt="" ) const;
   EStatus         Status()  const { return fStatus; }
 
+  // Cache of successfully parsed strings, shared by all instances
+  static void     ClearCache();
+  static UInt_t   GetCacheSize();
+
 protected:
 #ifdef R__B64
   static const Int_t kMaxA = 2;
@@ -56,6 +60,10 @@ protected:
   Int_t    fLen;             //Length of array (product of all dimensions)
   EStatus  fStatus;          //Status of Parse()
 
+  Int_t    DoParse( const char* string );
+  Bool_t   FromCache( const char* key );
+  void     ToCache( const char* key ) const;
+
   ClassDef(THaArrayString,0) //Parser for variable names with support for arrays
 };
 
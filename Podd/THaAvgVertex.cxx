@@ -91,25 +91,28 @@ Int_t THaAvgVertex::Process( const THaEvData& )
 
   // Compute the weighted average of the vertex positions.
   // Use the uncertainty in each vertex z as the weight for each vertex.
-  fVertex.SetXYZ( 0.0, 0.0, 0.0 ); 
+  Double_t v[3] = { 0.0, 0.0, 0.0 };
   Double_t sigsum = 0.0;
   for( const auto* trk : tracks ) {
     if( !trk->HasVertex() ) return 1;
-    Double_t sigma = trk->GetVertexError()(2);
+    Double_t sigma = trk->GetVertexError().Z();
     Double_t sig2  = sigma*sigma;
     if( sig2 > 0.0 ) {
-      sigsum += 1.0/sig2;
-      for( Int_t i=0; i<3; i++ ) {
-	Double_t x  = trk->GetVertex()(i);
-	fVertex(i) += x/sig2;
-      }
+      Double_t w = 1.0/sig2;
+      const TVector3& vtx = trk->GetVertex();
+      sigsum += w;
+      v[0] += w*vtx.X();
+      v[1] += w*vtx.Y();
+      v[2] += w*vtx.Z();
     }
   }
   if( sigsum > 0.0 ) {
-    fVertex *= 1.0/sigsum;
+    Double_t f = 1.0/sigsum;
+    v[0] *= f; v[1] *= f; v[2] *= f;
     // requires beam info to get x/y uncertainties right
     //    fZerror  = 1.0/TMath::Sqrt(sigsum);
   }
+  fVertex.SetXYZ( v[0], v[1], v[2] );
   fVertexOK = true;
 
   return 0;
@@ -183,21 +183,25 @@ Int_t THaBPM::Process()
   // to transform it into the HCS
   // directions are not calculated, they are always set parallel to z
 
+  // Plain arithmetic on the vector and matrix storage, avoiding temporary
+  // TVectorD objects
+  const Double_t* sig = fCorSignal.GetMatrixArray();
+  Double_t* rot = fRotPos.GetMatrixArray();
   for( UInt_t k = 0; k < NCHAN; k += 2 ) {
-    Double_t ap = fCorSignal(k);
-    Double_t am = fCorSignal(k + 1);
+    Double_t ap = sig[k];
+    Double_t am = sig[k + 1];
     if( ap + am != 0.0 ) {
-      fRotPos(k / 2) = fCalibRot * (ap - am) / (ap + am);
+      rot[k / 2] = fCalibRot * (ap - am) / (ap + am);
     } else {
-      fRotPos(k / 2) = 0.0;
+      rot[k / 2] = 0.0;
     }
   }
-  TVectorD dum(fRotPos);
-  dum *= fRot2HCSPos;
+  // fRot2HCSPos * fRotPos, row-major 2x2
+  const Double_t* m = fRot2HCSPos.GetMatrixArray();
   fPosition.SetXYZ(
-    dum(0) + fOrigin(0) + fOffset(0),
-    dum(1) + fOrigin(1) + fOffset(1),
-    fOrigin(2)
+    m[0]*rot[0] + m[1]*rot[1] + fOrigin.X() + fOffset.X(),
+    m[2]*rot[0] + m[3]*rot[1] + fOrigin.Y() + fOffset.Y(),
+    fOrigin.Z()
   );
 
   return 0;
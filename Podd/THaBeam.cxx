@@ -41,13 +41,14 @@ THaAnalysisObject::EStatus THaBeam::Init( const TDatime& run_time )
   // initialization and, in addition, finds pointer to the current 
   // run parameters.
 
-  if( !gHaRun || !gHaRun->IsInit() ) {
+  THaRunBase* run = GetCurrentRun();
+  if( !run || !run->IsInit() ) {
     Error( Here("Init"), "Current run not initialized. "
 	   "Failed to initialize beam apparatus %s (\"%s\"). ",
 	   GetName(), GetTitle() );
     return fStatus = kInitError;
   }
-  fRunParam = gHaRun->GetParameters();
+  fRunParam = run->GetParameters();
   if( !fRunParam ) {
     Error( Here("Init"), "Current run has no parameters?!? "
 	   "Failed to initialize beam apparatus %s (\"%s\"). ",
@@ -86,7 +87,7 @@ void THaBeam::Update()
 {
   // Update the fBeamIfo data with the info from the current event
 
-  THaRunParameters* rp = gHaRun->GetParameters();
+  THaRunParameters* rp = GetCurrentRun()->GetParameters();
   if( rp )
     fBeamIfo.Set( rp->GetBeamP(), fDirection, fPosition,
 		  rp->GetBeamPol() );
@@ -9,6 +9,7 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "THaBeamInfo.h"
+#include "MethodAccessor.h"
 #include "THaBeam.h"
 #include "THaRunParameters.h"
 #include "TMath.h"
@@ -71,3 +72,15 @@ Double_t THaBeamInfo::GetdE() const
 
 //_____________________________________________________________________________
 ClassImp(THaBeamInfo)
+
+// Compiled accessors for functions used in global variable definitions
+PODD_REGISTER_METHOD(THaBeamInfo, GetE)
+PODD_REGISTER_METHOD(THaBeamInfo, GetP)
+PODD_REGISTER_METHOD(THaBeamInfo, GetPx)
+PODD_REGISTER_METHOD(THaBeamInfo, GetPy)
+PODD_REGISTER_METHOD(THaBeamInfo, GetPz)
+PODD_REGISTER_METHOD(THaBeamInfo, GetX)
+PODD_REGISTER_METHOD(THaBeamInfo, GetY)
+PODD_REGISTER_METHOD(THaBeamInfo, GetZ)
+PODD_REGISTER_METHOD(THaBeamInfo, GetTheta)
+PODD_REGISTER_METHOD(THaBeamInfo, GetPhi)
@@ -246,22 +246,25 @@ void THaCherenkov::Clear( Option_t* opt )
 }
 
 //_____________________________________________________________________________
-Int_t THaCherenkov::StoreHit( const DigitizerHitInfo_t& hitinfo, UInt_t data )
+Int_t THaCherenkov::Decode( const THaEvData& evdata )
 {
-  // Put decoded frontend data into fDetectorData. Used by Decode().
-  // hitinfo: channel info (crate/slot/channel/hit/type)
-  // data:    data registered in this channel
-
-  THaPidDetector::StoreHit(hitinfo, data);
-
-  // Add channels with signals to the amplitude sums
-  const auto& PMT = fPMTData->GetPMT(hitinfo);
-  if( PMT.adc_p > 0 )
-    fASUM_p += PMT.adc_p;             // Sum of ADC minus ped
-  if( PMT.adc_c > 0 )
-    fASUM_c += PMT.adc_c;             // Sum of ADC corrected
+  // Decode Cherenkov data via THaDetectorBase::Decode(), then add the
+  // channels with signals to the amplitude sums.
+  // The sums are formed once per channel, after all of the channel's ADC
+  // and TDC hits have been stored, and only over the channels in the
+  // hit list.
+
+  Int_t nhits = THaPidDetector::Decode(evdata);
+
+  for( auto k : fPMTData->GetHitList() ) {
+    const auto& PMT = fPMTData->GetPMT(k);
+    if( PMT.adc_p > 0 )
+      fASUM_p += PMT.adc_p;             // Sum of ADC minus ped
+    if( PMT.adc_c > 0 )
+      fASUM_c += PMT.adc_c;             // Sum of ADC corrected
+  }
 
-  return 0;
+  return nhits;
 }
 
 //_____________________________________________________________________________
@@ -22,8 +22,8 @@ public:
   THaCherenkov(); // for ROOT I/O
   virtual ~THaCherenkov();
 
-  // THaCherenkov now uses THaDetectorBase::Decode()
   virtual void       Clear( Option_t* ="" );
+  virtual Int_t      Decode( const THaEvData& );
   virtual Int_t      CoarseProcess( TClonesArray& tracks );
   virtual Int_t      FineProcess( TClonesArray& tracks );
           Data_t     GetAsum() const { return fASUM_c; }
@@ -34,7 +34,6 @@ protected:
   Data_t         fASUM_p;    // Sum of ADC minus pedestal values of channels
   Data_t         fASUM_c;    // Sum of corrected ADC amplitudes of channels
 
-  virtual Int_t    StoreHit( const DigitizerHitInfo_t& hitinfo, UInt_t data );
   virtual void     PrintDecodedData( const THaEvData& evdata ) const;
 
   virtual Int_t    DefineVariables( EMode mode = kDefine );
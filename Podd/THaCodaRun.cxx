@@ -68,6 +68,9 @@ Int_t THaCodaRun::ReturnCode( Int_t coda_retcode )
   case CODA_FATAL:
     return READ_FATAL;
 
+  case CODA_EMPTY:
+    return READ_EMPTY;
+
   default:
     return READ_ERROR;
   }
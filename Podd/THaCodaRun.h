@@ -20,6 +20,7 @@ public:
   
   virtual Int_t  Close();
   virtual const UInt_t* GetEvBuffer() const;
+  const Decoder::THaCodaData* GetCodaData() const { return fCodaData; }
   virtual Bool_t IsOpen() const;
   virtual Int_t  ReadEvent();
   virtual Int_t  GetDataVersion() { return GetCodaVersion(); }
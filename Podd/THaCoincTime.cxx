@@ -42,6 +42,11 @@ THaCoincTime::THaCoincTime( const char* name,
 
   fVxTime1.reserve(NTR);
   fVxTime2.reserve(NTR);
+  for( auto& td : fTrData ) {
+    td.time.reserve(NTR);
+    td.pathl.reserve(NTR);
+    td.p.reserve(NTR);
+  }
   fTimeCombos.reserve(NTR*NTR);
 
   if (ch_name1 && strlen(ch_name1)>0) {
@@ -72,6 +77,8 @@ void THaCoincTime::Clear( Option_t* opt )
   fVxTime1.clear();
   fVxTime2.clear();
   fTimeCombos.clear();
+  for( auto& td : fTrData )
+    td.clear();
 }
 
 //_____________________________________________________________________________
@@ -216,61 +223,115 @@ Int_t THaCoincTime::Process( const THaEvData& evdata )
     }
   }
 
-  // Calculate the time at the vertex (relative to the trigger time)
-  // for each track in each spectrometer
-  // Use the Beta of the assumed particle type.
-  class Spec_short {
-  public:
-    THaSpectrometer*  Sp;
-    vector<Double_t>& Vxtime;
-    Double_t          Mass;
-  };
+  // Copy the track data of both spectrometers into contiguous arrays,
+  // then calculate the vertex times and all coincidence times from them
+  assert(fVxTime1.empty() && fVxTime2.empty());  // else Clear() not called
+  assert(fTimeCombos.empty());
+  THaSpectrometer* const spect[2] = { fSpect1, fSpect2 };
+  Int_t ibest[2] = { 0, 0 };
+  for( int k = 0; k < 2; ++k ) {
+    ibest[k] = FillTrackData(spect[k], fTrData[k]);
+    if( ibest[k] == -2 ) {
+      Warning(Here(here), "non-THaTrack in %s's tracks array.",
+              spect[k]->GetName());
+      ibest[k] = 0;
+    }
+  }
+  CalcVertexTimes(fTrData[0], fpmass1, fVxTime1);
+  CalcVertexTimes(fTrData[1], fpmass2, fVxTime2);
+  CalcTimeCombos(ibest[0], ibest[1]);
 
-  const vector<Spec_short> SpList = {
-    { fSpect1, fVxTime1, fpmass1 },
-    { fSpect2, fVxTime2, fpmass2 },
-  };
+  fDataValid = true;
+  return 0;
+}
 
-  for( const auto& sp : SpList ) {
-    assert(sp.Vxtime.empty());  // else Clear() not called in order
-    Int_t ntr = sp.Sp->GetNTracks();
-    TClonesArray* tracks = sp.Sp->GetTracks();
-    for( Int_t i = 0; i < ntr; i++ ) {
-      auto* tr = dynamic_cast<THaTrack*>(tracks->At(i));
-      // this should be safe to assume -- only THaTracks go into the tracks array
-      if( !tr ) {
-        Warning(Here(here), "non-THaTrack in %s's tracks array at %d.",
-                sp.Sp->GetName(), i);
-        continue;
-      }
-      Double_t p = tr->GetP();
-      if( tr->GetBeta() != 0. && p > 0. ) {
-        Double_t beta = p / TMath::Sqrt(p * p + sp.Mass * sp.Mass);
-	Double_t c = TMath::C();
-        sp.Vxtime.push_back(tr->GetTime() - tr->GetPathLen() / (beta * c));
-      } else {
-	// Using (i+1)*kBig here prevents differences from being zero
-        sp.Vxtime.push_back((i + 1) * kBig);
-      }
+//_____________________________________________________________________________
+Int_t THaCoincTime::FillTrackData( const THaSpectrometer* sp,
+                                   TrackData& td ) const
+{
+  // Copy time, path length and momentum of all tracks of spectrometer 'sp'
+  // to 'td'. Tracks without a valid beta get zero momentum. Returns the
+  // index of the golden track (0 if none), or -2 if the track array
+  // contains a non-THaTrack object. Such entries are kept as invalid
+  // tracks to preserve the track indices.
+
+  assert(td.time.empty());
+  Int_t ntr = sp->GetNTracks();
+  TClonesArray* tracks = sp->GetTracks();
+  Int_t ibest = 0, ret = 0;
+  const THaTrack* golden = sp->GetGoldenTrack();
+  for( Int_t i = 0; i < ntr; i++ ) {
+    // this should be safe to assume -- only THaTracks go into the tracks array
+    auto* tr = dynamic_cast<THaTrack*>(tracks->At(i));
+    if( !tr ) {
+      td.time.push_back(0);
+      td.pathl.push_back(0);
+      td.p.push_back(0);
+      ret = -2;
+      continue;
     }
+    if( tr == golden )
+      ibest = i;
+    td.time.push_back(tr->GetTime());
+    td.pathl.push_back(tr->GetPathLen());
+    td.p.push_back(tr->GetBeta() != 0. ? tr->GetP() : 0.);
   }
+  return ret ? ret : ibest;
+}
 
-  // now, we have the vertex times -- go through the combinations
-
-  // Take the tracks and the coincidence TDC and construct
-  // the coincidence time
-  assert(fTimeCombos.empty());  // else Clear() not called in order
-  for( size_t i = 0; i < fVxTime1.size(); i++ ) {
-    for( size_t j = 0; j < fVxTime2.size(); j++ ) {
-      fTimeCombos.emplace_back( i, j,
-                                fVxTime2[j] - fVxTime1[i] + fTdcData[0],
-                                fVxTime1[i] - fVxTime2[j] + fTdcData[1]
-      );
-    }
+//_____________________________________________________________________________
+void THaCoincTime::CalcVertexTimes( const TrackData& td, Double_t mass,
+                                    vector<Double_t>& vxtime )
+{
+  // Calculate the time at the vertex (relative to the trigger time)
+  // for each track in 'td'. Use the beta of the assumed particle type.
+  // Tracks without valid momentum get (i+1)*kBig, which prevents
+  // differences from being zero.
+
+  const Double_t m2  = mass * mass;
+  const Double_t ic  = 1.0 / TMath::C();
+  const size_t   ntr = td.time.size();
+  vxtime.resize(ntr);
+  const Double_t* t     = td.time.data();
+  const Double_t* pathl = td.pathl.data();
+  const Double_t* p     = td.p.data();
+  Double_t*       vx    = vxtime.data();
+  for( size_t i = 0; i < ntr; i++ ) {
+    // 1/beta = E/p
+    vx[i] = ( p[i] > 0. )
+      ? t[i] - pathl[i] * TMath::Sqrt(p[i] * p[i] + m2) / p[i] * ic
+      : static_cast<Double_t>(i + 1) * kBig;
   }
+}
 
-  fDataValid = true;
-  return 0;
+//_____________________________________________________________________________
+void THaCoincTime::CalcTimeCombos( Int_t ibest1, Int_t ibest2 )
+{
+  // Take the vertex times of the tracks and the coincidence TDCs and
+  // construct the coincidence times for all track combinations, or only
+  // for the combination of tracks ibest1 and ibest2 if IsBestPairOnly()
+
+  const size_t n1 = fVxTime1.size(), n2 = fVxTime2.size();
+  if( n1 == 0 || n2 == 0 )
+    return;
+  const Double_t* vx1 = fVxTime1.data();
+  const Double_t* vx2 = fVxTime2.data();
+  const Double_t d0 = fTdcData[0], d1 = fTdcData[1];
+  if( IsBestPairOnly() ) {
+    assert(ibest1 >= 0 && static_cast<size_t>(ibest1) < n1);
+    assert(ibest2 >= 0 && static_cast<size_t>(ibest2) < n2);
+    Double_t dt = vx2[ibest2] - vx1[ibest1];
+    fTimeCombos.emplace_back(ibest1, ibest2, dt + d0, d1 - dt);
+    return;
+  }
+  fTimeCombos.reserve(n1 * n2);
+  for( size_t i = 0; i < n1; i++ ) {
+    const Double_t v1 = vx1[i];
+    for( size_t j = 0; j < n2; j++ ) {
+      Double_t dt = vx2[j] - v1;
+      fTimeCombos.emplace_back(i, j, dt + d0, d1 - dt);
+    }
+  }
 }
 
 ClassImp(THaCoincTime)
@@ -39,8 +39,14 @@ public:
   Int_t   GetNTr2()   const { return fVxTime2.size(); }
   Int_t   GetNTimes() const { return fTimeCombos.size(); }
 
+  // Only write the combination of the golden tracks (default: all)
+  void    SetBestPairOnly( Bool_t b = true ) { SetBit(kBestPairOnly, b); }
+  Bool_t  IsBestPairOnly() const { return TestBit(kBestPairOnly); }
+
  protected:
 
+  enum { kBestPairOnly = BIT(14) };
+
   // Configuration
   TString           fSpectN1, fSpectN2; // Names of spectrometers to use
   Double_t          fpmass1, fpmass2;   // masses to use for coinc. time
@@ -75,6 +81,22 @@ public:
   };
   std::vector<TimeCombo> fTimeCombos;  // time combinations to consider
 
+  // Track data of one spectrometer in contiguous arrays
+  class TrackData {
+  public:
+    void clear() { time.clear(); pathl.clear(); p.clear(); }
+    std::vector<Double_t> time;    // track times
+    std::vector<Double_t> pathl;   // path lengths
+    std::vector<Double_t> p;       // momenta, 0 if no valid beta
+  };
+  TrackData         fTrData[2];    //! per-event track data for spec1/spec2
+
+  Int_t         FillTrackData( const THaSpectrometer* sp, TrackData& td ) const;
+
+  static void   CalcVertexTimes( const TrackData& td, Double_t mass,
+                                 std::vector<Double_t>& vxtime );
+  void          CalcTimeCombos( Int_t ibest1, Int_t ibest2 );
+
   virtual Int_t DefineVariables( EMode mode = kDefine );
   virtual Int_t ReadDatabase( const TDatime& date );
 
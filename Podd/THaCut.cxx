@@ -7,6 +7,17 @@
 // This is a slightly expanded version of a THaFormula that supports
 // statistics counters and caches the result of the last evaluation.
 //
+// Results are tagged with an event generation number. NewEvent()
+// (called via THaCutList::ClearAll) invalidates the results of all cuts
+// at once; GetResult() returns false for a cut not yet evaluated in the
+// current event.
+//
+// With SetLazyEval(true), cuts referenced in other cut expressions are
+// evaluated on demand when first needed in an event, and the result is
+// reused for the rest of the event. Together with the short-circuit
+// evaluation of && and ||, this lets THaAnalyzer evaluate only the cuts
+// that the master cut of each block actually depends on.
+//
 //////////////////////////////////////////////////////////////////////////
 
 #include "THaCut.h"
@@ -21,9 +32,13 @@
 
 using namespace std;
 
+UInt_t THaCut::fgGeneration = 1;
+Bool_t THaCut::fgLazyEval   = false;
+
 //_____________________________________________________________________________
 THaCut::THaCut()
-  : THaFormula(), fLastResult(false), fNCalled(0), fNPassed(0), fMode(kAND)
+  : THaFormula(), fLastResult(false), fNCalled(0), fNPassed(0), fMode(kAND),
+    fEvalGen(0), fShards(kNShardCounters)
 {
   // Default constructor
 }
@@ -32,7 +47,7 @@ THaCut::THaCut()
 THaCut::THaCut( const char* name, const char* expression, const char* block,
 		const THaVarList* vlst, const THaCutList* clst )
   : THaFormula(), fLastResult(false), fBlockname(block), fNCalled(0),
-    fNPassed(0), fMode(kAND)
+    fNPassed(0), fMode(kAND), fEvalGen(0), fShards(kNShardCounters)
 {
   // Create a cut 'name' according to 'expression'.
   // The cut may use global variables from the list 'vlst' and other,
@@ -92,9 +107,12 @@ Double_t THaCut::Eval()
   // Evaluate the cut and increment counters. The Double_t return value
   // is awkward, but results are usually retrieved via GetResult anyway.
   // Problems like this will go away if Eval() is templatized.
+  // Threads other than the main thread count in fShards.
 
+  Bool_t main_thread = Podd::CounterShards::IsMainThread();
   ResetBit(kInvalid);
-  fNCalled++;
+  if( main_thread ) fNCalled++; else fShards.Incr(kShardCalled);
+  fEvalGen = fgGeneration;
   if( IsError() ) {
     fLastResult = false;
   }
@@ -139,12 +157,35 @@ Double_t THaCut::Eval()
       fLastResult = false;
     }
     else if( fLastResult ) {
-      fNPassed++;
+      if( main_thread ) fNPassed++; else fShards.Incr(kShardPassed);
     }
   }
   return fLastResult;
 }
 
+//_____________________________________________________________________________
+void THaCut::CollectCounts()
+{
+  // Add the counts of other threads to fNCalled and fNPassed. Must not be
+  // called while other threads may evaluate this cut.
+
+  UInt_t counts[kNShardCounters] = { 0, 0 };
+  fShards.Collect(counts);
+  fNCalled += counts[kShardCalled];
+  fNPassed += counts[kShardPassed];
+}
+
+//_____________________________________________________________________________
+void THaCut::GetDependencies( vector<THaCut*>& cuts ) const
+{
+  // Append the cuts directly referenced in this cut's expression to 'cuts'
+
+  for( const auto& def : fVarDef ) {
+    if( def.type == kCut && def.obj )
+      cuts.push_back(static_cast<THaCut*>(def.obj));
+  }
+}
+
 //_____________________________________________________________________________
 THaCut::EvalMode THaCut::ParsePrefix( TString& expr )
 {
@@ -222,7 +263,7 @@ void THaCut::Print( Option_t* option ) const
     cout << setw(nn) << GetName() << "  "
 	 << setw(nt) << GetTitle() << "  ";
     if( !strcmp( s.GetOption(), kPRINTLINE )) {
-      cout << setw(1)  << (bool)fLastResult << "  "
+      cout << setw(1)  << GetResult() << "  "
 	   << setw(nb) << fBlockname << "  ";
     }
     cout << setw(9)  << fNCalled << "  "
@@ -239,7 +280,7 @@ void THaCut::Print( Option_t* option ) const
 
     cout.flags( ios::right );
     THaFormula::Print( s.GetOption() );
-    cout << "Curval: " << setw(9) << (bool)fLastResult << "  "
+    cout << "Curval: " << setw(9) << GetResult() << "  "
 	 << "Block:  " << fBlockname << endl;
     cout << "Called: " << setw(9) << fNCalled << "  "
 	 << "Passed: " << setw(9) << fNPassed;
@@ -295,6 +336,7 @@ void THaCut::Reset()
 
   ClearResult();
   fNCalled = fNPassed = 0;
+  fShards.Clear();
 }
 
 //_____________________________________________________________________________
@@ -8,6 +8,8 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "THaFormula.h"
+#include "CounterShards.h"
+#include <vector>
 
 class THaCut : public THaFormula {
 
@@ -23,7 +25,8 @@ public:
 
   enum EvalMode { kModeErr = -1, kAND, kOR, kXOR };
 
-          void         ClearResult()        { fLastResult = false; }
+          void         ClearResult()        { fLastResult = false; fEvalGen = 0; }
+          void         CollectCounts();
   // Requires ROOT >= 4.00/00
   virtual Int_t        DefinedVariable( TString& variable, Int_t& action );
   virtual Double_t     Eval();
@@ -33,21 +36,37 @@ public:
           EvalMode     GetMode()      const { return fMode; }
           UInt_t       GetNCalled()   const { return fNCalled; }
           UInt_t       GetNPassed()   const { return fNPassed; }
-          Bool_t       GetResult()    const { return fLastResult; }
+          Bool_t       GetResult()    const { return fLastResult && IsEvaluated(); }
+          void         GetDependencies( std::vector<THaCut*>& cuts ) const;
+          Bool_t       IsEvaluated()  const { return fEvalGen == fgGeneration; }
   virtual Bool_t       IsArray()      const { return false; }
   virtual Bool_t       IsVarArray()   const { return false; }
   virtual void         Print( Option_t *opt="" ) const;
   virtual void         Reset();
+          void         SetCounts( UInt_t ncalled, UInt_t npassed )
+                         { fNCalled = ncalled; fNPassed = npassed; }
   virtual void         SetBlockname( const Text_t* name );
   virtual void         SetName( const Text_t* name );
   virtual void         SetNameTitle( const Text_t* name, const Text_t* title );
 
+  // Per-event result bookkeeping
+  static  void         NewEvent() { if( ++fgGeneration == 0 ) ++fgGeneration; }
+  static  void         SetLazyEval( Bool_t enable = true ) { fgLazyEval = enable; }
+  static  Bool_t       IsLazyEval() { return fgLazyEval; }
+
 protected:
   Bool_t      fLastResult;  // Result of last evaluation of this formula
   TString     fBlockname;   // Name of block this cut belongs to
   UInt_t      fNCalled;     // Number of times this cut has been evaluated
   UInt_t      fNPassed;     // Number of times this cut was true when evaluated
   EvalMode    fMode;        // Evaluation mode of array expressions (AND/OR etc)
+  UInt_t      fEvalGen;     //! Event generation of fLastResult (0 = none)
+  Podd::CounterShards fShards; //! fNCalled/fNPassed of other threads
+
+  enum { kShardCalled, kShardPassed, kNShardCounters };
+
+  static UInt_t fgGeneration; // Current event generation
+  static Bool_t fgLazyEval;   // Evaluate referenced cuts on demand
 
   Bool_t      EvalElement( Int_t instance );
   EvalMode    ParsePrefix( TString& expr );
@@ -16,13 +16,13 @@
 #include "Textvars.h"
 #include "THaGlobals.h"
 #include "FileInclude.h"
+#include "DefFileCache.h"
 #include "TError.h"
 #include "TList.h"
 #include "TString.h"
 #include "TClass.h"
 
 #include <iostream>
-#include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
@@ -101,11 +101,11 @@ void THaCutList::Clear( Option_t* )
 //______________________________________________________________________________
 void THaCutList::ClearAll( Option_t* )
 {
-  // Clear the results of all defined cuts
+  // Clear the results of all defined cuts. This simply starts a new event
+  // generation (see THaCut::NewEvent), which invalidates all cut results
+  // without visiting each cut.
 
-  TIter next( fCuts );
-  while( auto* pcut = static_cast<THaCut*>( next() ))
-    pcut->ClearResult();
+  THaCut::NewEvent();
 }
 
 //______________________________________________________________________________
@@ -246,6 +246,8 @@ Int_t THaCutList::EvalBlock( const TList* plist )
   // Evaluate all cuts in the given list in the order in which they were defined.
   // This is a static member function that can be called externally.
   // Only TObject* in the given list that inherit from THaCut* are evaluated.
+  // In lazy evaluation mode (THaCut::SetLazyEval), cuts already evaluated
+  // in the current event are not evaluated again.
 
   if( !plist ) return -1;
   Int_t i = 0;
@@ -258,26 +260,57 @@ Int_t THaCutList::EvalBlock( const TList* plist )
 #endif
       continue;
     }
-    static_cast<THaCut*>(pobj)->EvalCut();
+    auto* pcut = static_cast<THaCut*>(pobj);
+    if( !THaCut::IsLazyEval() || !pcut->IsEvaluated() )
+      pcut->EvalCut();
     i++;
   }
   return i;
 }
 
 //______________________________________________________________________________
-Int_t THaCutList::EvalBlock( const char* block )
+Int_t THaCutList::EvalBlock( const std::vector<THaCut*>& cuts )
 {
-  // Evaluate all tests in the given block in the order in which they were defined.
-  // If no argument is given, the default block is evaluated.
+  // Evaluate the given cuts in order, as EvalBlock(const TList*) does for
+  // a block. Faster in the event loop since there is no list iteration.
+  // See GetBlockCuts for obtaining the cuts of a block.
 
-  return EvalBlock( FindBlock( block ) );
+  for( auto* pcut : cuts ) {
+    if( !THaCut::IsLazyEval() || !pcut->IsEvaluated() )
+      pcut->EvalCut();
+  }
+  return cuts.size();
+}
+
+//______________________________________________________________________________
+void THaCutList::GetBlockCuts( const TList* plist, std::vector<THaCut*>& cuts )
+{
+  // Put the THaCuts in the given list into 'cuts', in the order in which
+  // they were defined. The result remains valid until cuts are added to
+  // or removed from the list.
+
+  cuts.clear();
+  if( !plist ) return;
+  TIter next( plist );
+  while( TObject* pobj = next() ) {
+    if( !pobj->InheritsFrom(THaCut::Class()) ) {
+#ifdef WITH_DEBUG
+      ::Warning("THaCutList::GetBlockCuts()", "List contains a non-THaCut:" );
+      pobj->Print();
+#endif
+      continue;
+    }
+    cuts.push_back( static_cast<THaCut*>(pobj) );
+  }
 }
 
 //______________________________________________________________________________
-inline static bool IsComment( const string& s, string::size_type pos )
+Int_t THaCutList::EvalBlock( const char* block )
 {
-  return ( pos != string::npos && pos < s.length() &&
-	   (s[pos] == '#' || s.substr(pos,2) == "//") );
+  // Evaluate all tests in the given block in the order in which they were defined.
+  // If no argument is given, the default block is evaluated.
+
+  return EvalBlock( FindBlock( block ) );
 }
 
 //______________________________________________________________________________
@@ -315,30 +348,30 @@ Int_t THaCutList::Load( const char* filename )
   //
 
   static const char* const here   = "THaCutList::Load";
-  static const char* const whtspc = " \t";
 
   if( !filename || !*filename || strspn(filename," ") == strlen(filename) ) {
     Error( here, "invalid file name, no cuts loaded" );
     return -1;
   }
 
-  ifstream ifile( filename );
-  if( !ifile ) {
+  // Blank lines and comments are already removed by the file cache
+  DefFileCache::LinesPtr_t flines =
+    DefFileCache::Instance().Read( filename, DefFileCache::kCutDef );
+  if( !flines ) {
     Error( here, "error opening input file %s, no cuts loaded",
 	   filename );
     return -2;
   }
 
-  // Read the file line by line
-  string line;
   string block = kDefaultBlockName;
   Int_t nlines_read = 0, nlines_ok = 0;
+  vector<string> lines, tokens;
 
-  while( getline(ifile,line) ) {
+  for( const auto& fline : *flines ) {
 
     // #include
-    if( line.substr(0,kIncTag.length()) == kIncTag &&
-	line.length() > kIncTag.length() ) {
+    if( fline.is_include ) {
+      const string& line = fline.text;
       string incfilename;
       if( GetIncludeFileName(line,incfilename) != 0 ) {
 	ostringstream ostr;
@@ -364,50 +397,29 @@ Int_t THaCutList::Load( const char* filename )
       continue;
     }
 
-    // Blank line or comment?
-    string::size_type start, pos = 0;
-    if( line.empty()
-	|| (start = line.find_first_not_of( whtspc )) == string::npos
-	|| IsComment(line, start) )
-      continue;
-
-    // Get rid of trailing comments and whitespace
-    while( (pos = line.find_first_of("#/", pos+1)) != string::npos ) {
-      if( IsComment(line, pos) ) {
-	line.erase(pos);
-	break;
-      }
-    }
-    pos = line.find_last_not_of( whtspc );
-    assert( pos != string::npos );
-    if( pos != string::npos && ++pos < line.length() )
-      line.erase(pos);
-
     // Valid line ... start processing
 
     // Substitute text variables
-    vector<string> lines( 1, line );
-    if( gHaTextvars->Substitute(lines) )
-      continue;
+    if( fline.is_raw ) {
+      lines.assign( 1, fline.text );
+      if( gHaTextvars->Substitute(lines) )
+	continue;
+    }
+    const size_t nlines = fline.is_raw ? lines.size() : 1;
 
-    for( const auto& str : lines ) {
+    for( size_t i = 0; i < nlines; ++i ) {
       nlines_read++;
-      string arg1, arg2;
 
-      // Extract first argument (cut name or "Block:")
-      pos = str.find_first_of( whtspc, start );
-      if( pos == string::npos ) {
+      // Cut name (or "Block:") and expression (or block name)
+      if( fline.is_raw )
+	DefFileCache::Tokenize( lines[i], DefFileCache::kCutDef, tokens );
+      const vector<string>& args = fline.is_raw ? tokens : fline.tokens;
+      if( args.size() < 2 ) {
 	Warning( here, "ignoring label without expression, line = \"%s\"",
-		 str.c_str() );
+		 fline.is_raw ? lines[i].c_str() : fline.text.c_str() );
 	continue;
       }
-      arg1 = str.substr( start, pos-start );
-
-      // Extract second argument (expression or block name)
-      pos = str.find_first_not_of( whtspc, pos );
-      assert( pos != string::npos );
-      if( pos == string::npos ) continue;
-      arg2 = str.substr( pos );
+      const string& arg1 = args[0], & arg2 = args[1];
 
       // Set block name
       if( arg1 == "Block:" ) {
@@ -422,7 +434,6 @@ Int_t THaCutList::Load( const char* filename )
     }
   }
 
-  ifile.close();
   Int_t nbad = nlines_read-nlines_ok;
   if( nbad>0 ) Warning( here, "%d cut(s) could not be defined, check input "
 			"file %s", nbad, filename );
@@ -545,11 +556,23 @@ void THaCutList::Reset()
     pcut->Reset();
 }
 
+//______________________________________________________________________________
+void THaCutList::CollectCounts()
+{
+  // Add the counts of other threads to the statistics of all cuts
+  // (see THaCut::CollectCounts)
+
+  TIter next( fCuts );
+  while( auto* pcut = static_cast<THaCut*>( next() ))
+    pcut->CollectCounts();
+}
+
 //______________________________________________________________________________
 Int_t THaCutList::Result( const char* cutname, EWarnMode mode )
 {
   // Return result of the last evaluation of the named cut
-  // (0 if false, 1 if true).
+  // (0 if false, 1 if true). In lazy evaluation mode, the cut is
+  // evaluated if it has not been yet in the current event.
   // If cut does not exist, return -1. Also, print warning if mode=kWarn.
 
   auto* pcut = static_cast<THaCut*>( fCuts->FindObject( cutname ));
@@ -558,6 +581,8 @@ Int_t THaCutList::Result( const char* cutname, EWarnMode mode )
       Warning("Result", "No such cut: %s", cutname );
     return -1;
   }
+  if( THaCut::IsLazyEval() && !pcut->IsEvaluated() )
+    pcut->EvalCut();
   return static_cast<Int_t>( pcut->GetResult() );
 }
 
@@ -10,6 +10,7 @@
 #include "THashList.h"
 #include "THaCut.h"
 #include "THaNamedList.h"
+#include <vector>
 
 class TList;
 class THaVarList;
@@ -46,6 +47,7 @@ public:
   virtual void      ClearAll( Option_t* opt="" );
   virtual void      ClearBlock( const char* block=kDefaultBlockName,
 				Option_t* opt="" );
+          void      CollectCounts();
   virtual void      Compile();
   virtual Int_t     Define( const char* cutname, const char* expr, 
 			    const char* block=kDefaultBlockName );
@@ -74,6 +76,9 @@ public:
   virtual void      SetList( THaVarList* lst );
 
   static  Int_t     EvalBlock( const TList* plist );
+  static  Int_t     EvalBlock( const std::vector<THaCut*>& cuts );
+  static  void      GetBlockCuts( const TList* plist,
+                                  std::vector<THaCut*>& cuts );
 
 protected:
   THaHashList*      fCuts;    //Hash list holding all cuts
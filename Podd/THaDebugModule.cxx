@@ -7,6 +7,13 @@
 // Diagnostic class to help troubleshoot physics modules.
 // Prints one or more global variables for every event.
 //
+// With the option "TRACE" or "TRACE=N" in the variable list, nothing is
+// printed. Instead, the values of the variables for the last N events
+// (default 1000) are kept in a ring buffer, which is dumped to stderr
+// when the analysis terminates abnormally (a module returning kTerminate,
+// a fatal error, or an exception) or when the process receives SIGUSR1.
+// Array variables are recorded with at most kMaxTraceLen elements.
+//
 //////////////////////////////////////////////////////////////////////////
 
 #include "THaDebugModule.h"
@@ -17,17 +24,38 @@
 #include "THaEvData.h"
 #include "TRegexp.h"
 #include "TClass.h"
+#include "THaVar.h"
 
 #include <cstring>
 #include <cctype>
 #include <iostream>
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
 
 using namespace std;
 
+// Modules in trace mode, in order of setup
+static vector<THaDebugModule*> fgTracers;
+
+// Set by SIGUSR1, checked in Process()
+static volatile sig_atomic_t fgDumpRequest = 0;
+
+static const UInt_t kDefaultTraceDepth = 1000;
+
+//_____________________________________________________________________________
+extern "C" void THaDebugModule_DumpRequest( int )
+{
+  // SIGUSR1 handler. Only sets a flag; the traces are dumped by the
+  // next call to a tracing module's Process().
+  fgDumpRequest = 1;
+}
+
 //_____________________________________________________________________________
 THaDebugModule::THaDebugModule( const char* var_list, const char* test ) :
   THaPhysicsModule("DebugModule",var_list),
-  fVarString(var_list), fFlags(kStop), fCount(0), fTestExpr(test), fTest(nullptr)
+  fVarString(var_list), fFlags(kStop), fCount(0), fTestExpr(test), fTest(nullptr),
+  fTraceDepth(0), fRecSize(0), fTraceNext(0), fTraceCount(0)
 {
   // Normal constructor.
 
@@ -38,6 +66,10 @@ THaDebugModule::THaDebugModule( const char* var_list, const char* test ) :
 THaDebugModule::~THaDebugModule()
 {
   // Destructor
+
+  auto it = find(fgTracers.begin(), fgTracers.end(), this);
+  if( it != fgTracers.end() )
+    fgTracers.erase(it);
   delete fTest;
 }
 
@@ -69,13 +101,26 @@ Int_t THaDebugModule::THaDebugModule::ParseList()
       const char* opt = fVarString.GetOption(i);
       if( !strcmp(opt,"NOSTOP") )
 	fFlags &= ~kStop;
+      else if( !strncmp(opt,"TRACE",5) && (opt[5] == 0 || opt[5] == '=') ) {
+	fTraceDepth = kDefaultTraceDepth;
+	if( opt[5] == '=' ) {
+	  Long_t depth = atol(opt+6);
+	  if( depth > 0 )
+	    fTraceDepth = depth;
+	  else
+	    Warning( Here("ParseList"), "Invalid trace depth %s, using %u",
+		     opt+6, kDefaultTraceDepth );
+	}
+	fFlags |= kTrace;
+	fFlags &= ~kStop;
+      }
       else {
 	// Regexp matching
 	bool found = false;
 	TRegexp re( opt, true);
 	// We can inspect analysis variables and cuts/tests
-	if( gHaVars ) {
-	  TIter next( gHaVars );
+	if( THaVarList* vars = GetVarList() ) {
+	  TIter next( vars );
 	  while( TObject* obj = next() ) {
 	    TString s = obj->GetName();
 	    if( s.Index(re) != kNPOS ) {
@@ -84,8 +129,8 @@ Int_t THaDebugModule::THaDebugModule::ParseList()
 	    }
 	  }
 	}
-	if( gHaCuts ) {
-	  const TList* lst = gHaCuts->GetCutList();
+	if( THaCutList* cuts = GetCutList() ) {
+	  const THashList* lst = cuts->GetCutList();
 	  if( lst ) {
 	    TIter next( lst );
 	    while( TObject* obj = next() ) {
@@ -107,6 +152,110 @@ Int_t THaDebugModule::THaDebugModule::ParseList()
   return 0;
 }
 
+//_____________________________________________________________________________
+void THaDebugModule::InitTrace()
+{
+  // Set up the trace ring buffer. Each record holds the event number and,
+  // per variable, the number of recorded values followed by space for
+  // fTraceLen values.
+
+  fTraceLen.clear();
+  fTraceVars.clear();
+  fRecSize = 1;
+  for( const auto* obj : fVars ) {
+    const THaVar* var = nullptr;
+    UInt_t len = 1;
+    if( obj->IsA()->InheritsFrom("THaVar") ) {
+      var = static_cast<const THaVar*>(obj);
+      if( var->IsVarArray() )
+	len = kMaxTraceLen;
+      else
+	len = min(max(var->GetLen(),1), static_cast<Int_t>(kMaxTraceLen));
+    }
+    fTraceVars.push_back(var);
+    fTraceLen.push_back(len);
+    fRecSize += 1 + len;
+  }
+  fTraceBuf.assign(static_cast<size_t>(fTraceDepth)*fRecSize, 0.0);
+  fTraceNext = fTraceCount = 0;
+
+  if( find(fgTracers.begin(), fgTracers.end(), this) == fgTracers.end() )
+    fgTracers.push_back(this);
+  signal(SIGUSR1, THaDebugModule_DumpRequest);
+}
+
+//_____________________________________________________________________________
+void THaDebugModule::RecordTrace( const THaEvData& evdata )
+{
+  // Record the current values of the variables in the ring buffer,
+  // overwriting the oldest record when full
+
+  if( fTraceDepth == 0 )
+    return;
+
+  Double_t* rec = &fTraceBuf[static_cast<size_t>(fTraceNext)*fRecSize];
+  *rec++ = evdata.GetEvNum();
+  for( size_t i = 0; i < fVars.size(); ++i ) {
+    UInt_t len = fTraceLen[i];
+    if( const THaVar* var = fTraceVars[i] ) {
+      UInt_t n = min(static_cast<UInt_t>(max(var->GetLen(),0)), len);
+      rec[0] = n;
+      for( UInt_t j = 0; j < n; ++j )
+	rec[1+j] = var->GetValue(j);
+    } else {
+      rec[0] = 1;
+      rec[1] = static_cast<const THaCut*>(fVars[i])->GetResult();
+    }
+    rec += 1 + len;
+  }
+  if( ++fTraceNext == fTraceDepth )
+    fTraceNext = 0;
+  if( fTraceCount < fTraceDepth )
+    ++fTraceCount;
+}
+
+//_____________________________________________________________________________
+void THaDebugModule::DumpTrace( ostream& os ) const
+{
+  // Print the recorded events, oldest first
+
+  os << "======>>>>>> " << GetName() << ": trace of last " << fTraceCount
+     << " event(s)" << endl;
+  if( fTraceCount == 0 )
+    return;
+  UInt_t irec = (fTraceNext + fTraceDepth - fTraceCount) % fTraceDepth;
+  for( UInt_t k = 0; k < fTraceCount; ++k ) {
+    const Double_t* rec = &fTraceBuf[static_cast<size_t>(irec)*fRecSize];
+    os << "Event " << static_cast<UInt_t>(*rec++) << ":";
+    for( size_t i = 0; i < fVars.size(); ++i ) {
+      UInt_t n = static_cast<UInt_t>(rec[0]);
+      os << "  " << fVars[i]->GetName() << "=";
+      if( n != 1 ) os << "{";
+      for( UInt_t j = 0; j < n; ++j ) {
+	if( j > 0 ) os << ",";
+	os << rec[1+j];
+      }
+      if( n != 1 ) os << "}";
+      rec += 1 + fTraceLen[i];
+    }
+    os << endl;
+    if( ++irec == fTraceDepth )
+      irec = 0;
+  }
+}
+
+//_____________________________________________________________________________
+void THaDebugModule::DumpTraces()
+{
+  // Dump the traces of all modules in trace mode to stderr. Called by the
+  // analyzer when the analysis terminates abnormally.
+
+  for( const auto* mod : fgTracers ) {
+    if( mod->fTraceCount > 0 )
+      mod->DumpTrace(cerr);
+  }
+}
+
 //_____________________________________________________________________________
 void THaDebugModule::Print( Option_t* opt ) const
 {
@@ -143,6 +292,7 @@ void THaDebugModule::PrintEvNum( const THaEvData& evdata ) const
 Int_t THaDebugModule::Process( const THaEvData& evdata )
 {
   // Print the variables for every event and wait for user input.
+  // In trace mode, just record the variables.
 
   // We have to set up the test here because physics modules' Init() is
   // called before the analyzer's tests are loaded, and we want to be
@@ -156,10 +306,22 @@ Int_t THaDebugModule::Process( const THaEvData& evdata )
 	delete fTest; fTest = nullptr;
       }
     }
+    if( fFlags & kTrace )
+      InitTrace();
     fIsSetup = true;
   }
   bool good = true;
   if ( fTest && !fTest->EvalCut()) good = false;
+
+  if( fFlags & kTrace ) {
+    if( good )
+      RecordTrace( evdata );
+    if( fgDumpRequest ) {
+      fgDumpRequest = 0;
+      DumpTraces();
+    }
+    return 0;
+  }
   
   // Print() the variables
   if( good && (fFlags & kQuiet) == 0) {
@@ -10,8 +10,10 @@
 #include "THaPhysicsModule.h"
 #include "THaPrintOption.h"
 #include <vector>
+#include <iosfwd>
 
 class THaCut;
+class THaVar;
 
 class THaDebugModule : public THaPhysicsModule {
   
@@ -25,14 +27,22 @@ public:
   virtual void      Print( Option_t* opt="" ) const;
   virtual Int_t     Process( const THaEvData& evdata );
 
+  void              DumpTrace( std::ostream& os ) const;
+  UInt_t            GetTraceDepth() const { return fTraceDepth; }
+  static void       DumpTraces();
+
 protected:
 
   enum EFlags { 
     kStop  = BIT(0),    // Wait for key press after every event
     kCount = BIT(1),    // Run for fCount events   
-    kQuiet = BIT(2)     // Run quietly (don't print variables)
+    kQuiet = BIT(2),    // Run quietly (don't print variables)
+    kTrace = BIT(3)     // Record variables in ring buffer, don't print
   };
 
+  // Values recorded per variable and event in trace mode
+  static const UInt_t kMaxTraceLen = 16;
+
   std::vector<const TObject*> fVars; // Array of pointers to variables 
   THaPrintOption  fVarString; // Set of strings with variable/cut names
   Int_t           fFlags;     // Option flags
@@ -40,6 +50,19 @@ protected:
   TString         fTestExpr;  // Definition of test to evaluate before printing
   THaCut*         fTest;      // Pointer to test object to evaluate
 
+  // Trace mode: last fTraceDepth events, fixed-size records of
+  // event number, then per variable the number of values and the values
+  UInt_t          fTraceDepth; // Number of events to keep
+  std::vector<UInt_t>   fTraceLen;  // Values recorded per variable
+  std::vector<const THaVar*> fTraceVars; // Variables of fVars (nullptr=cut)
+  UInt_t          fRecSize;    // Size of one record
+  std::vector<Double_t> fTraceBuf;  // Ring buffer of records
+  UInt_t          fTraceNext;  // Record to fill next
+  UInt_t          fTraceCount; // Number of valid records
+
+  void    InitTrace();
+  void    RecordTrace( const THaEvData& );
+
   void    PrintEvNum( const THaEvData& ) const;
   Int_t   ParseList();
 
@@ -16,6 +16,7 @@
 #include <sstream>
 #include <vector>
 #include <algorithm>
+#include <cassert>
 
 using namespace std;
 using namespace Decoder;
@@ -107,7 +108,7 @@ void THaDetMap::CopyMap( const ModuleVec_t& map )
 
 //_____________________________________________________________________________
 THaDetMap::THaDetMap( const THaDetMap& rhs )
-  : fStartAtZero(rhs.fStartAtZero)
+  : fStartAtZero(rhs.fStartAtZero), fTotNumChan(0), fTableOK(false)
 {
   // Copy constructor
 
@@ -120,7 +121,7 @@ THaDetMap& THaDetMap::operator=( const THaDetMap& rhs )
   // THaDetMap assignment operator
 
   if( this != &rhs ) {
-    fMap.clear();
+    Clear();
     CopyMap(rhs.fMap);
     fStartAtZero = rhs.fStartAtZero;
   }
@@ -188,6 +189,7 @@ Int_t THaDetMap::AddModule( UInt_t crate, UInt_t slot,
     m.type = ChannelType::kUndefined;
 
   fMap.push_back(std::move(pm));
+  fTableOK = false;
   return static_cast<Int_t>(GetSize());
 }
 
@@ -381,6 +383,40 @@ void THaDetMap::Print( Option_t* ) const
   }
 }
 
+//_____________________________________________________________________________
+void THaDetMap::Init()
+{
+  // Build the channel lookup table used by the hit iterators: the logical
+  // channel number and reference channel flag of every channel of every
+  // module. Call this once the map and the modules' parameters are final.
+  // THaDetectorBase does so at the end of its initialization. The table
+  // is also built when an iterator is created and the map has changed
+  // since, i.e. modules have been added or removed. Changes to the
+  // channel parameters of individual modules require calling Init() again.
+
+  fTotNumChan = GetTotNumChan();
+  fChanTable.resize(fTotNumChan);
+  fChanStart.resize(fMap.size());
+  UInt_t k = 0;
+  for( UInt_t i = 0; i < fMap.size(); ++i ) {
+    const Module* m = uGetModule(i);
+    fChanStart[i] = k;
+    for( UInt_t chan = m->lo; chan <= m->hi; ++chan, ++k ) {
+      ChanInfo_t& ci = fChanTable[k];
+      // Logical channel numbers seen by the hit iterators start at zero.
+      // ConvertToLogicalChannel subtracts 1, so undo that if this map
+      // already starts counting at zero.
+      ci.lchan = m->ConvertToLogicalChannel(chan);
+      if( fStartAtZero )
+        ++ci.lchan;
+      ci.valid = (ci.lchan >= 0 && static_cast<UInt_t>(ci.lchan) < fTotNumChan);
+      ci.isref = (m->refchan >= 0 && static_cast<UInt_t>(m->refchan) == chan);
+    }
+  }
+  assert( k == fTotNumChan );
+  fTableOK = true;
+}
+
 //_____________________________________________________________________________
 void THaDetMap::Reset()
 {
@@ -388,6 +424,10 @@ void THaDetMap::Reset()
 
   Clear();
   fMap.shrink_to_fit(); // FWIW
+  fChanTable.clear();
+  fChanTable.shrink_to_fit();
+  fChanStart.clear();
+  fChanStart.shrink_to_fit();
 }
 
 //_____________________________________________________________________________
@@ -403,6 +443,7 @@ void THaDetMap::Sort()
     if( a->slot  > b->slot )  return false;
     return (a->lo < b->lo);
   });
+  fTableOK = false;
 
 }
 
@@ -423,9 +464,12 @@ THaDetMap::MakeMultiHitIterator( const THaEvData& evdata )
 //_____________________________________________________________________________
 THaDetMap::Iterator::Iterator( THaDetMap& detmap, const THaEvData& evdata,
                                bool do_init )
-  : fDetMap(detmap), fEvData(evdata), fMod(nullptr), fNMod(fDetMap.GetSize()),
-    fNTotChan(fDetMap.GetTotNumChan()), fNChan(0), fIMod(-1), fIChan(-1)
+  : fDetMap(detmap), fEvData(evdata), fMod(nullptr), fChanInfo(nullptr),
+    fNMod(fDetMap.GetSize()), fNTotChan(0), fNChan(0), fIMod(-1), fIChan(-1)
 {
+  if( !fDetMap.fTableOK )
+    fDetMap.Init();
+  fNTotChan = fDetMap.fTotNumChan;
   fHitInfo.ev = fEvData.GetEvNum();
   // Initialize iterator state to point to the first item
   if( do_init )
@@ -463,18 +507,22 @@ THaDetMap::Iterator& THaDetMap::Iterator::operator++()
     if( !fMod )
       throw std::logic_error("NULL detector map module. Program bug. "
                              "Call expert.");
+    fChanInfo = fDetMap.GetChanInfo(fIMod);
     fHitInfo.set_crate_slot(fMod);
     fHitInfo.module = fEvData.GetModule(CRATE_SLOT(fHitInfo));
-    fNChan = fEvData.GetNumChan(CRATE_SLOT(fHitInfo));
+    // Fetch all hits of this module at once
+    fSlotHits = fEvData.GetSlotHits(CRATE_SLOT(fHitInfo));
+    fNChan = fSlotHits.size();
     fIChan = -1;
   }
  nextchan:
   if( NO_NEXT(fIChan, fNChan) )
     goto nextmod;
-  UInt_t chan = fEvData.GetNextChan(CRATE_SLOT(fHitInfo), fIChan);
+  UInt_t chan = fSlotHits.chan(fIChan);
   if( chan < fMod->lo or chan > fMod->hi )
     goto nextchan;  // Not one of my channels
-  UInt_t nhit = fEvData.GetNumHits(CRATE_SLOT(fHitInfo), chan);
+  fHitInfo.hits = fSlotHits.hits(fIChan);
+  UInt_t nhit = fHitInfo.hits.size();
   fHitInfo.chan = chan;
   fHitInfo.nhit = nhit;
   if( nhit == 0 ) {
@@ -487,12 +535,11 @@ THaDetMap::Iterator& THaDetMap::Iterator::operator++()
   // If multiple hits on a TDC channel take the one earliest in time.
   // For a common-stop TDC, this is actually the last hit.
   fHitInfo.hit = (fHitInfo.type == ChannelType::kCommonStopTDC) ? nhit - 1 : 0;
-  // Determine logical channel. Decode() methods that use this hit iterator
+  // Look up logical channel. Decode() methods that use this hit iterator
   // should always assume that logical channel numbers start counting from zero.
-  Int_t lchan = fMod->ConvertToLogicalChannel(chan);
-  if( fDetMap.fStartAtZero )
-    ++lchan; // ConvertToLogicalChannel subtracts 1; undo that here
-  if( lchan < 0 or static_cast<UInt_t>(lchan) >= size() ) {
+  const ChanInfo_t& ci = fChanInfo[chan - fMod->lo];
+  Int_t lchan = ci.lchan;
+  if( !ci.valid ) {
     ostringstream ostr;
     size_t lmin = 1, lmax = size(); // Apparent range in the database file
     if( fDetMap.fStartAtZero ) { --lmin; --lmax; }
@@ -501,6 +548,7 @@ THaDetMap::Iterator& THaDetMap::Iterator::operator++()
     throw std::invalid_argument(msg(ostr.str().c_str()));
   }
   fHitInfo.lchan = lchan;
+  fHitInfo.isref = ci.isref;
 
   return *this;
 }
@@ -510,8 +558,14 @@ void THaDetMap::Iterator::reset()
 {
   // Reset iterator to first element, if any
 
+  if( !fDetMap.fTableOK )
+    fDetMap.Init();
   fNMod = fDetMap.GetSize();
+  fNTotChan = fDetMap.fTotNumChan;
+  fChanInfo = nullptr;
   fIMod = fIChan = -1;
+  fNChan = 0;
+  fSlotHits = {};
   fHitInfo.reset();
   ++(*this);
 }
@@ -530,7 +584,7 @@ THaDetMap::MultiHitIterator::MultiHitIterator( THaDetMap& detmap,
 THaDetMap::Iterator& THaDetMap::MultiHitIterator::operator++()
 {
   // Advance iterator to next active hit or channel, allowing multiple hits
-  // per channel
+  // per channel. The hits of the current channel are in fHitInfo.hits.
  nexthit:
   if( LOOPDONE(fIHit, fHitInfo.nhit) ) {
     Iterator::operator++();
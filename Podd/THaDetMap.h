@@ -100,7 +100,15 @@ public:
     kFillSignal          = BIT(15)    // Parse the signal type (for Hall C)
   };
 
-  THaDetMap() : fStartAtZero(false) {}
+  // Precomputed per-channel data, see Init()
+  class ChanInfo_t {
+  public:
+    Int_t  lchan;     // Logical channel, as reported by the hit iterators
+    Bool_t valid;     // Logical channel within range of this map
+    Bool_t isref;     // Channel is its module's reference channel
+  };
+
+  THaDetMap() : fStartAtZero(false), fTotNumChan(0), fTableOK(false) {}
   THaDetMap( const THaDetMap& );
   THaDetMap& operator=( const THaDetMap& );
   virtual ~THaDetMap() = default;
@@ -113,9 +121,12 @@ public:
                                UInt_t first = 0, Int_t model = 0,
                                Int_t refindex = -1, Int_t refchan = -1,
                                UInt_t plane = 0, UInt_t signal = 0 );
-          void      Clear()  { fMap.clear(); }
+          void      Clear()  { fMap.clear(); fTableOK = false; }
   virtual Module*   Find( UInt_t crate, UInt_t slot, UInt_t chan );
   virtual Int_t     Fill( const std::vector<Int_t>& values, UInt_t flags = 0 );
+          void      Init();
+          Bool_t    IsInit() const { return fTableOK; }
+          const ChanInfo_t* GetChanInfo( UInt_t i ) const;
           void      GetMinMaxChan( UInt_t& min, UInt_t& max,
                                    ECountMode mode = kLogicalChan ) const;
           Module*   GetModule( UInt_t i ) const;
@@ -134,7 +145,7 @@ public:
   virtual void      Reset();
   virtual void      Sort();
 
-  void SetStartAtZero( Bool_t value ) { fStartAtZero = value; }
+  void SetStartAtZero( Bool_t value ) { fStartAtZero = value; fTableOK = false; }
 
 protected:
   using ModuleVec_t = std::vector<std::unique_ptr<Module>>;
@@ -146,6 +157,12 @@ protected:
   // Channels in this map start counting at 0. Used by hit iterators.
   Bool_t fStartAtZero;
 
+  // Channel lookup table for the hit iterators, built by Init()
+  std::vector<ChanInfo_t> fChanTable; //! Entries of all modules, [chan-lo]
+  std::vector<UInt_t>     fChanStart; //! Index of each module's 1st entry
+  UInt_t                  fTotNumChan; //! Total number of channels (cached)
+  Bool_t                  fTableOK;   //! Lookup table is up to date
+
   //___________________________________________________________________________
   // Utility classes for iterating over active channels in current event data
 public:
@@ -176,7 +193,7 @@ public:
       HitInfo_t() :
         module{nullptr}, type{Decoder::ChannelType::kUndefined},
         ev{kMaxUInt}, crate{kMaxUInt}, slot{kMaxUInt}, chan{kMaxUInt}, nhit{0},
-        hit{kMaxUInt}, lchan{-1} {}
+        hit{kMaxUInt}, lchan{-1}, isref{false} {}
       void set_crate_slot( const THaDetMap::Module* mod ) {
         if( mod->IsADC() )
           type = Decoder::ChannelType::kADC;
@@ -189,6 +206,7 @@ public:
       void reset() {
         module = nullptr; type = Decoder::ChannelType::kUndefined;
         crate = slot = chan = hit = kMaxUInt; nhit = 0; lchan = -1;
+        isref = false; hits = {};
       }
       Decoder::Module*     module; // Current frontend module being decoded
       Decoder::ChannelType type;   // Type of measurement recorded in current channel
@@ -199,6 +217,8 @@ public:
       UInt_t  nhit;    // Number of hits in current channel
       UInt_t  hit;     // Hit number in current channel
       Int_t   lchan;   // Logical channel according to detector map
+      Bool_t  isref;   // Channel is the reference channel of its module
+      Decoder::HitSpan hits; // Data of all hits in current channel
     };
 
     const HitInfo_t* operator->() const { return &fHitInfo; }
@@ -208,9 +228,11 @@ public:
     THaDetMap& fDetMap;
     const THaEvData& fEvData;
     const THaDetMap::Module* fMod;
+    const ChanInfo_t* fChanInfo; // Lookup table of current module
     UInt_t fNMod;         // Number of modules in detector map (cached)
     UInt_t fNTotChan;     // Total number of detector map channels (cached)
     UInt_t fNChan;        // Number of channels active in current module
+    Decoder::SlotHits fSlotHits; // Hits in current module
     Int_t  fIMod;         // Current module index in detector map
     Int_t  fIChan;        // Current channel
     HitInfo_t fHitInfo;   // Current state of this iterator
@@ -235,7 +257,7 @@ public:
     Int_t fIHit;         // Current raw hit number
   };
 
-  ClassDef(THaDetMap,1)   //The standard detector map
+  ClassDef(THaDetMap,2)   //The standard detector map
 };
 
 using DigitizerHitInfo_t = THaDetMap::Iterator::HitInfo_t;
@@ -245,6 +267,12 @@ inline THaDetMap::Module* THaDetMap::GetModule( UInt_t i ) const {
   return i<fMap.size() ? uGetModule(i) : nullptr;
 }
 
+inline const THaDetMap::ChanInfo_t* THaDetMap::GetChanInfo( UInt_t i ) const {
+  // Lookup table of the i-th module, indexed by channel - lo. Requires Init().
+  if( !fTableOK || i >= fMap.size() ) return nullptr;
+  return fChanTable.data() + fChanStart[i];
+}
+
 inline Bool_t THaDetMap::IsADC(Module* d) {
   if( !d ) return false;
   return d->IsADC();
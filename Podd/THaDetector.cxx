@@ -44,6 +44,18 @@ THaApparatus* THaDetector::GetApparatus() const
   return static_cast<THaApparatus*>(fApparatus.GetObject());
 }
 
+//_____________________________________________________________________________
+Podd::AnalysisContext* THaDetector::GetContext() const
+{
+  // Return the context of this detector. Unless explicitly set, use the
+  // one of the parent apparatus.
+
+  THaApparatus* app = GetApparatus();
+  if( !fContext && app )
+    return app->GetContext();
+  return THaDetectorBase::GetContext();
+}
+
 //_____________________________________________________________________________
 void THaDetector::SetApparatus( THaApparatus* apparatus )
 {
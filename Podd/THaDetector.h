@@ -23,6 +23,7 @@ public:
   virtual ~THaDetector();
   virtual Int_t  End( THaRunBase* r=0 );
   THaApparatus*  GetApparatus() const;
+  virtual Podd::AnalysisContext* GetContext() const;
   virtual void   SetApparatus( THaApparatus* );
 
   THaDetector();  // for ROOT I/O only
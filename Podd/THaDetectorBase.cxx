@@ -16,6 +16,8 @@
 #include "THaDetectorBase.h"
 #include "THaDetMap.h"
 #include "THaEvData.h"
+#include "SimDecoder.h"
+#include "HitCacheWriter.h"
 #include "TMath.h"
 #include "VarType.h"
 #include "TRotation.h"
@@ -55,6 +57,18 @@ THaDetectorBase::~THaDetectorBase()
   delete fDetMap;
 }
 
+//_____________________________________________________________________________
+THaAnalysisObject::EStatus THaDetectorBase::Init( const TDatime& run_time )
+{
+  // Standard initialization, followed by building the channel lookup table
+  // of the detector map, now that the map is final
+
+  EStatus status = THaAnalysisObject::Init(run_time);
+  if( status == kOK && fDetMap )
+    fDetMap->Init();
+  return status;
+}
+
 //_____________________________________________________________________________
 void THaDetectorBase::Clear( Option_t* opt )
 {
@@ -77,6 +91,20 @@ void THaDetectorBase::Reset( Option_t* opt )
   }
 }
 
+//_____________________________________________________________________________
+size_t THaDetectorBase::GetMemoryUsage() const
+{
+  // Approximate memory held by this detector (bytes), including the
+  // detector map and the per-event data and calibrations in fDetectorData
+
+  size_t n = THaAnalysisObject::GetMemoryUsage();
+  if( fDetMap )
+    n += fDetMap->GetSize() * sizeof(THaDetMap::Module);
+  for( const auto& detData : fDetectorData )
+    n += detData->GetMemoryUsage();
+  return n;
+}
+
 //_____________________________________________________________________________
 void THaDetectorBase::DefineAxes( Double_t rotation_angle )
 {
@@ -90,6 +118,24 @@ void THaDetectorBase::DefineAxes( Double_t rotation_angle )
 
 }
 
+//_____________________________________________________________________________
+Int_t THaDetectorBase::GetCrates( vector<UInt_t>& crates ) const
+{
+  // Append the crates from which this detector reads data to 'crates'.
+  // Used to decode only the crates needed by the analysis. The default
+  // is the crates in the detector map. Detectors that read other data
+  // should override this. Return -1 to request decoding of all crates.
+  // Returns the number of crates added.
+
+  if( !fDetMap ) return 0;
+  Int_t n = 0;
+  for( UInt_t i = 0; i < fDetMap->GetSize(); i++ ) {
+    crates.push_back( fDetMap->GetModule(i)->crate );
+    ++n;
+  }
+  return n;
+}
+
 //_____________________________________________________________________________
 Int_t THaDetectorBase::GetView( const DigitizerHitInfo_t& hitinfo ) const
 {
@@ -385,6 +431,9 @@ OptUInt_t THaDetectorBase::LoadData( const THaEvData& evdata,
   // Default method for loading the data for the hit referenced in 'hitinfo'.
   // Callback from Decode().
 
+  // Read from the hit span set up by the detector map iterator, if any
+  if( hitinfo.hit < hitinfo.hits.size() )
+    return hitinfo.hits[hitinfo.hit];
   return evdata.GetData(hitinfo.crate, hitinfo.slot, hitinfo.chan, hitinfo.hit);
 }
 
@@ -405,9 +454,27 @@ Int_t THaDetectorBase::Decode( const THaEvData& evdata )
   //
   // For debugging, each detector may define a PrintDecodedData function.
   // The default version calls Print on all objects in fDetectorData.
+  //
+  // With simulation decoders that inject hits directly for this detector
+  // (see Podd::SimDecoder::AddDirectDetector), the detector map is
+  // bypassed, and the injected hits are passed to StoreHit instead.
 
   const char* const here = "Decode";
 
+  if( SupportsDirectHits() ) {
+    const auto* simdec = dynamic_cast<const Podd::SimDecoder*>(&evdata);
+    if( simdec && simdec->IsDirectMode() ) {
+      Int_t nhits = DecodeDirect(*simdec);
+      if( nhits >= 0 )
+        return nhits;
+    }
+  }
+
+  // Record the hits if a hit cache is being written
+  Podd::HitCacheWriter::Columns_t* cache = nullptr;
+  if( auto* writer = Podd::HitCacheWriter::GetActive() )
+    cache = writer->GetColumns(GetPrefix());
+
   // Loop over all modules defined for this detector
   bool has_warning = false;
   Int_t nhits = 0;
@@ -427,12 +494,15 @@ Int_t THaDetectorBase::Decode( const THaEvData& evdata )
       // Data could not be retrieved (probably decoder bug)
       DataLoadWarning(hitinfo, here);
       has_warning = true;
+      ++hitIter;
       continue;
     }
 
     // Store hit data (and derived quantities) in fDetectorData.
     // Multi-function modules can load additional data here.
     StoreHit(hitinfo, data.value());
+    if( cache )
+      cache->Add(hitinfo.type, hitinfo.lchan, data.value());
 
     // Clear the hit-done flag which can be used in custom StoreHit methods
     // to reorder module processing
@@ -454,6 +524,32 @@ Int_t THaDetectorBase::Decode( const THaEvData& evdata )
   return nhits;
 }
 
+//_____________________________________________________________________________
+Int_t THaDetectorBase::DecodeDirect( const Podd::SimDecoder& simdec )
+{
+  // Pass the hits that 'simdec' injected for this detector to StoreHit.
+  // Returns the number of hits, or -1 if this detector does not get
+  // injected hits.
+
+  const auto* hits = simdec.GetDirectHits(GetPrefix());
+  if( !hits )
+    return -1;
+
+  DigitizerHitInfo_t hitinfo;
+  hitinfo.ev   = simdec.GetEvNum();
+  hitinfo.nhit = 1;
+  hitinfo.hit  = 0;
+  for( const auto& hit : *hits ) {
+    hitinfo.type  = hit.type;
+    hitinfo.lchan = hit.lchan;
+    hitinfo.chan  = hit.lchan;
+    StoreHit(hitinfo, hit.data);
+    for( auto& detData : fDetectorData )
+      detData->ClearHitDone();
+  }
+  return static_cast<Int_t>(hits->size());
+}
+
 //_____________________________________________________________________________
 void THaDetectorBase::PrintDecodedData( const THaEvData& /*evdata*/ ) const
 {
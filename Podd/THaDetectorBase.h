@@ -14,6 +14,10 @@
 #include <vector>
 #include <memory>
 
+namespace Podd {
+  class SimDecoder;
+}
+
 class THaDetectorBase : public THaAnalysisObject {
 public:
   using VecDetData_t = std::vector<std::unique_ptr<Podd::DetectorData>>;
@@ -22,9 +26,12 @@ public:
 
   THaDetectorBase(); // only for ROOT I/O
 
+  using THaAnalysisObject::Init;
+  virtual EStatus  Init( const TDatime& run_time );
   virtual void     Clear( Option_t* ="" );
   virtual Int_t    Decode( const THaEvData& );
   virtual void     Reset( Option_t* opt="" );
+  virtual size_t   GetMemoryUsage() const;
 
   VecDetData_t&    GetDetectorData() { return fDetectorData; }
   THaDetMap*       GetDetMap() const { return fDetMap; }
@@ -51,6 +58,9 @@ public:
   void             PrintDetMap( Option_t* opt="") const;
 
   virtual Int_t    GetView( const DigitizerHitInfo_t& hitinfo ) const;
+  virtual Int_t    GetCrates( std::vector<UInt_t>& crates ) const;
+  // True if Decode() can take hits injected by Podd::SimDecoder
+  virtual Bool_t   SupportsDirectHits() const { return !fDetectorData.empty(); }
 
 protected:
   // Mapping
@@ -83,6 +93,7 @@ protected:
   virtual OptUInt_t LoadData( const THaEvData& evdata,
                               const DigitizerHitInfo_t& hitinfo );
   virtual void      PrintDecodedData( const THaEvData& evdata ) const;
+          Int_t     DecodeDirect( const Podd::SimDecoder& simdec );
 
   void DebugWarning( const char* here, const char* msg, UInt_t evnum );
   void MultipleHitWarning( const DigitizerHitInfo_t& hitinfo, const char* here );
@@ -17,6 +17,13 @@
 // Default tolerance for floating-point equality comparisons of z_med
 static const Double_t eps = 0.1;
 
+// Range and step size of the stopping power table in log10(beta*gamma).
+// Linear interpolation with this step size is accurate to a few 1e-6
+// relative, and to a few 1e-5 close to the onset of the density correction.
+static const Double_t kTabMin  = -1.0;
+static const Double_t kTabMax  =  5.0;
+static const Double_t kTabStep =  1e-3;
+
 using namespace std;
 
 //_____________________________________________________________________________
@@ -70,9 +77,60 @@ THaAnalysisObject::EStatus THaElossCorrection::Init( const TDatime& run_time )
   // Continue with standard initialization
   THaPhysicsModule::Init( run_time );
 
+  // The medium and particle are now fixed
+  if( IsOK() )
+    MakeStopTable();
+
   return fStatus;
 }
 
+//_____________________________________________________________________________
+void THaElossCorrection::MakeStopTable()
+{
+  // Tabulate the stopping power of the medium for the particle vs.
+  // log10(beta*gamma). Nothing is done for unknown media, for which the
+  // per-event calculation prints a warning and returns zero.
+
+  fStopTable.clear();
+  if( fTestMode || fM <= 0.0 || fZmed == 0.0 || fAmed == 0.0 ||
+      ExEnerg(fZmed,fDensity) == 0.0 )
+    return;
+
+  auto n = static_cast<UInt_t>( (kTabMax-kTabMin)/kTabStep + 0.5 ) + 1;
+  fStopTable.resize(n);
+  for( UInt_t i = 0; i < n; ++i ) {
+    Double_t bg = TMath::Power(10.0, kTabMin + i*kTabStep);
+    Double_t beta = bg / TMath::Sqrt(1.0 + bg*bg);
+    fStopTable[i] = fElectronMode
+      ? StopElectron( beta, fZmed, fAmed, fDensity )
+      : StopHadron( fZ, beta, fZmed, fAmed, fDensity );
+  }
+}
+
+//_____________________________________________________________________________
+Double_t THaElossCorrection::ElossForMomentum( Double_t p ) const
+{
+  // Energy loss (GeV) of the particle with momentum 'p' (GeV/c) along
+  // the current pathlength. Interpolates the stopping power table if
+  // possible, otherwise calculates it directly.
+
+  if( !fStopTable.empty() && p > 0.0 ) {
+    Double_t x = (TMath::Log10(p/fM) - kTabMin) / kTabStep;
+    if( x >= 0.0 && x < static_cast<Double_t>(fStopTable.size()-1) ) {
+      if( fPathlength == 0.0 )
+        return 0.0;
+      auto i = static_cast<UInt_t>(x);
+      Double_t f = x - i;
+      Double_t stop = fStopTable[i] + f * (fStopTable[i+1] - fStopTable[i]);
+      return stop * fDensity * (fPathlength*1e2) * 1e-3;
+    }
+  }
+  Double_t beta = p / TMath::Sqrt(p*p + fM*fM);
+  if( fElectronMode )
+    return ElossElectron( beta, fZmed, fAmed, fDensity, fPathlength );
+  return ElossHadron( fZ, beta, fZmed, fAmed, fDensity, fPathlength );
+}
+
 //_____________________________________________________________________________
 Int_t THaElossCorrection::DefineVariables( EMode mode )
 {
@@ -278,6 +336,26 @@ Double_t THaElossCorrection::ElossElectron( Double_t beta, Double_t z_med,
   //
   //-----------------------------------------------------------------------
 
+  if( pathlength == 0.0 )
+    return 0.0;
+
+  Double_t ESTP = StopElectron(beta,z_med,a_med,d_med);
+
+  pathlength *= 1e2;  // internal units are cm
+
+  //---- Electron energy loss
+
+  Double_t eloss = ESTP * d_med * pathlength * 1e-3; // GeV
+
+  return eloss;
+}
+
+//_____________________________________________________________________________
+Double_t THaElossCorrection::StopElectron( Double_t beta, Double_t z_med,
+					   Double_t a_med, Double_t d_med )
+{
+  // Stopping power of electrons (MeV cm^2/g), see ElossElectron.
+  // Returns zero for invalid input or unknown media.
 
   //---- Constant factor corresponding to 2*pi*N_a*(r_e)^2*m_e*c^2
   //     Its units are MeV.cm2/g          
@@ -294,12 +372,9 @@ Double_t THaElossCorrection::ElossElectron( Double_t beta, Double_t z_med,
 
   //---- Input variables consistency check
 
-  if( beta <= 0.0 || beta >= 1.0 || z_med == 0.0 ||
-      a_med == 0.0 || pathlength == 0.0 )
+  if( beta <= 0.0 || beta >= 1.0 || z_med == 0.0 || a_med == 0.0 )
     return 0.0;
 
-  pathlength *= 1e2;  // internal units are cm
-
   Double_t BETA2 = beta * beta;
   Double_t BETA3 = 1.0 - BETA2;
   Double_t GAMMA = 1.0/TMath::Sqrt(BETA3);
@@ -326,11 +401,7 @@ Double_t THaElossCorrection::ElossElectron( Double_t beta, Double_t z_med,
 
   Double_t ESTP = COEF * z_med * ( BETH - DENS ) / a_med / BETA2;
 
-  //---- Electron energy loss
-
-  Double_t eloss = ESTP * d_med * pathlength * 1e-3; // GeV
-
-  return eloss;
+  return ESTP;
 }
 
 //_____________________________________________________________________________
@@ -368,6 +439,27 @@ Double_t THaElossCorrection:: ElossHadron( Int_t Z_hadron, Double_t beta,
   //
   //-----------------------------------------------------------------------
 
+  if( pathlength == 0.0 )
+    return 0.0;
+
+  Double_t HSTP = StopHadron(Z_hadron,beta,z_med,a_med,d_med);
+
+  pathlength *= 1e2;  // internal units are cm
+
+  //---- Electron energy loss
+
+  Double_t eloss = HSTP * d_med * pathlength * 1e-3; // in GeV
+
+  return eloss;
+}
+
+//_____________________________________________________________________________
+Double_t THaElossCorrection::StopHadron( Int_t Z_hadron, Double_t beta,
+					 Double_t z_med, Double_t a_med,
+					 Double_t d_med )
+{
+  // Stopping power of hadrons (MeV cm^2/g), see ElossHadron.
+  // Returns zero for invalid input or unknown media.
 
   //---- Constant factor corresponding to 4*pi*N_a*(r_e)^2*m_e*c^2
   //     Its units are MeV.cm2/g          
@@ -385,11 +477,9 @@ Double_t THaElossCorrection:: ElossHadron( Int_t Z_hadron, Double_t beta,
   //---- Input variables consistency check
 
   if( Z_hadron == 0 || beta <= 0.0 || beta >= 1.0 || z_med == 0.0 ||
-      a_med == 0.0 || pathlength == 0.0 )
+      a_med == 0.0 )
     return 0.0;
 
-  pathlength *= 1e2;  // internal units are cm
-
   Double_t BETA2 = beta * beta;
   Double_t GAMA2 = 1.0 / (1.0 - BETA2);
   Double_t GAMA  = TMath::Sqrt( GAMA2 );
@@ -439,11 +529,7 @@ Double_t THaElossCorrection:: ElossHadron( Int_t Z_hadron, Double_t beta,
   Double_t HSTP = COEF * z_med * Double_t(Z_hadron*Z_hadron) / a_med;
   HSTP = HSTP * ( BETH - DENS - SHEL ) / BETA2;
 
-  //---- Electron energy loss
-
-  Double_t eloss = HSTP * d_med * pathlength * 1e-3; // in GeV
-
-  return eloss;
+  return HSTP;
 }
 
 //_____________________________________________________________________________
@@ -9,6 +9,7 @@
 
 #include "THaPhysicsModule.h"
 #include "TString.h"
+#include <vector>
 
 class THaVertexModule;
 
@@ -41,6 +42,11 @@ public:
 				 Double_t z_med, Double_t a_med, 
 				 Double_t d_med /* g/cm^3 */, 
 				 Double_t pathlength /* m */ );
+  static  Double_t  StopElectron( Double_t beta, Double_t z_med,
+				  Double_t a_med, Double_t d_med );
+  static  Double_t  StopHadron( Int_t Z_hadron, Double_t beta,
+				Double_t z_med, Double_t a_med,
+				Double_t d_med );
 
 protected:
 
@@ -65,6 +71,13 @@ protected:
   TString            fVertexName;  // Name of vertex module for var pathlength, if any
   THaVertexModule*   fVertexModule;// Pointer to vertex module
 
+  // Stopping power of the medium for this particle (MeV cm^2/g) vs.
+  // log10(beta*gamma), tabulated at Init
+  std::vector<Double_t> fStopTable;
+
+  Double_t ElossForMomentum( Double_t p /* GeV/c */ ) const;
+  void     MakeStopTable();
+
   // Setup functions
   virtual Int_t DefineVariables( EMode mode = kDefine );
   virtual Int_t ReadRunDatabase( const TDatime& date );
@@ -64,6 +64,40 @@ TString THaEpicsEvtHandler::GetString( const char* tag, UInt_t event ) const {
   return TString(fEpics->GetString(tag, event).c_str());
 }
 
+UInt_t THaEpicsEvtHandler::GetTagId( const char* tag ) const {
+  if ( !fEpics ) return kMaxUInt;
+  return fEpics->GetTagId(tag);
+}
+
+Double_t THaEpicsEvtHandler::GetData( UInt_t id, UInt_t event ) const {
+  if ( !fEpics ) return 0;
+  return fEpics->GetData(id, event);
+}
+
+Double_t THaEpicsEvtHandler::GetTime( UInt_t id, UInt_t event ) const {
+  if ( !fEpics ) return 0;
+  return fEpics->GetTimeStamp(id, event);
+}
+
+TString THaEpicsEvtHandler::GetString( UInt_t id, UInt_t event ) const {
+  if ( !fEpics ) return TString("nothing");
+  return TString(fEpics->GetString(id, event).c_str());
+}
+
+const string& THaEpicsEvtHandler::GetStdString( UInt_t id,
+                                                UInt_t event ) const {
+  static const string kEmpty;
+  if ( !fEpics ) return kEmpty;
+  return fEpics->GetString(id, event);
+}
+
+void THaEpicsEvtHandler::SetMaxHistory( UInt_t n ) {
+  // Keep only the n most recent values of each EPICS variable, bounding
+  // memory use over long runs. Lookups for events older than the retained
+  // values return the oldest one kept.
+  if ( fEpics ) fEpics->SetMaxHistory(n);
+}
+
 Int_t THaEpicsEvtHandler::Analyze( THaEvData* evdata ) {
 
   if ( !IsMyEvent(evdata->GetEvType()) ) return -1;
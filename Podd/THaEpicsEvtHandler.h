@@ -33,6 +33,17 @@ public:
    Double_t GetTime( const char* tag, UInt_t event = 0 ) const;
    TString GetString( const char* tag, UInt_t event = 0 ) const;
 
+   // Access by tag id, avoiding the lookup by name
+   UInt_t GetTagId( const char* tag ) const;
+   Double_t GetData( UInt_t id, UInt_t event = 0 ) const;
+   Double_t GetTime( UInt_t id, UInt_t event = 0 ) const;
+   TString GetString( UInt_t id, UInt_t event = 0 ) const;
+   // String value without copying, valid until the next EPICS event
+   const std::string& GetStdString( UInt_t id, UInt_t event = 0 ) const;
+
+   // Maximum number of values kept per EPICS variable (0 = unlimited)
+   void SetMaxHistory( UInt_t n );
+
 private:
 
    std::unique_ptr<Decoder::THaEpics> fEpics;
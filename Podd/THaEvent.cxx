@@ -73,10 +73,18 @@ Int_t THaEvent::Fill()
   //
 
   Int_t nvar = 0;
-  for( const auto& datamap : fDataMap ) {
-    if( datamap.ncopy == 0 ) break;
-    if( !datamap.pvar ) continue;
 
+  // Basic-type variables with a fixed address, prepared by Init()
+  for( const auto& cp : fCopyPlan ) {
+    Int_t ncopy = cp.ncopyvar ? *cp.ncopyvar : cp.ncopy;
+    if( ncopy <= 0 ) continue;
+    memcpy( cp.dest, cp.src, ncopy*cp.size );
+    nvar += ncopy;
+  }
+
+  // Everything else
+  for( const auto* pmap : fConvertMap ) {
+    const DataMap& datamap = *pmap;
     THaVar* pvar = datamap.pvar;
     Int_t ncopy = datamap.ncopy;
     if( ncopy < 0 ) {
@@ -173,6 +181,8 @@ Int_t THaEvent::Init()
 
   if( !gHaVars ) return -2;
 
+  fCopyPlan.clear();
+  fConvertMap.clear();
   for( auto& datamap : fDataMap ) {
     if( datamap.ncopy == 0 ) break;
     if( THaVar* pvar = gHaVars->Find( datamap.name )) {
@@ -181,7 +191,22 @@ Int_t THaEvent::Init()
       Warning("Init()", "Global variable %s not found. "
                         "Will be filled with zero.", datamap.name );
       datamap.pvar = nullptr;
+      continue;
     }
+    // Plain basic-type variables and arrays always have their data at the
+    // same address, so Fill() can memcpy them without querying the variable.
+    // Pointers to pointers, pointer arrays, objects and variable-size
+    // arrays without a size variable go through the general path.
+    THaVar* pvar = datamap.pvar;
+    const void* src = pvar->GetValuePointer();
+    if( pvar->IsBasic() && pvar->GetType() <= kByte &&
+        !pvar->IsPointerArray() && src &&
+        (datamap.ncopy > 0 || datamap.ncopyvar) ) {
+      fCopyPlan.push_back( { src, datamap.dest, pvar->GetTypeSize(),
+                             datamap.ncopy,
+                             datamap.ncopy < 0 ? datamap.ncopyvar : nullptr } );
+    } else
+      fConvertMap.push_back( &datamap );
   }
   fInit = true;
   return 0;
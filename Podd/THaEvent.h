@@ -87,6 +87,18 @@ protected:
   };
   std::vector<DataMap> fDataMap; //! Map of global variables to copy
 
+  // Fixed-location basic-type variables, copied with memcpy by Fill()
+  class CopyPlan {
+  public:
+    const void*  src;            //! Address of variable data
+    void*        dest;           //! Address of member variable
+    size_t       size;           //! Size of one element
+    Int_t        ncopy;          //! Number of elements to copy
+    const Int_t* ncopyvar;       //! Variable holding ncopy (if ncopy=-1)
+  };
+  std::vector<CopyPlan>        fCopyPlan;    //! Set up by Init()
+  std::vector<const DataMap*>  fConvertMap;  //! Entries not in fCopyPlan
+
   ClassDef(THaEvent,3)  //Base class for event structure definition
 };
 
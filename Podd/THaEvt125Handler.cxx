@@ -15,6 +15,13 @@
 //    
 //   gHaEvtHandlers->Add (new THaEvt125Handler("hallcpre","for evtype 125"));
 //
+//   The data are taken from the first bank inside the event, or, after
+//   SetBankTag(), from the first bank with that tag. The bank is found
+//   via the decoder's bank directory (THaEvData::GetBankDirectory), which
+//   is built once per event and shared by all handlers, and read in place
+//   through a BankView. Events without bank structure fall back to the
+//   raw words following the event header.
+//
 //   Global variables are defined in Init.  You can see them in Podd, as
 //     analyzer [2] gHaVars->Print()
 //
@@ -40,7 +47,8 @@
 using namespace std;
 
 THaEvt125Handler::THaEvt125Handler(const char *name, const char* description)
-  : THaEvtTypeHandler(name,description), NVars(0), dvars(nullptr)
+  : THaEvtTypeHandler(name,description), NVars(0), dvars(nullptr),
+    fBankTag(0), fAnyBank(true)
 {
 }
 
@@ -62,22 +70,36 @@ Int_t THaEvt125Handler::Analyze(THaEvData *evdata)
 
   if (fDebug) cout << "------------------\n  Event type 125 \n\n" << endl;
 
-  for (UInt_t i = 0; i < evdata->GetEvLength(); i++) {
-
-    if (fDebug) cout << "data[" << dec << i
-                     << "] =  0x" << hex << evdata->GetRawData(i)
-                     << "  = decimal " << dec << evdata->GetRawData(i) << endl;
+  if (fDebug) {
+    for (UInt_t i = 0; i < evdata->GetEvLength(); i++) {
+      cout << "data[" << dec << i
+           << "] =  0x" << hex << evdata->GetRawData(i)
+           << "  = decimal " << dec << evdata->GetRawData(i) << endl;
+    }
+    evdata->GetBankDirectory().Print();
+  }
 
 // This is a fake example of how to decode.  Modify it as you wish,
 // and then change these comments.
 // The data in "dvars" appears as global variables.
 
-    if (i >= startidx) {
+  const Decoder::BankDirectory& banks = evdata->GetBankDirectory();
+  Decoder::BankView data;
+  if (fAnyBank) {
+    if (banks.GetSize() > 1)  // Entry 0 is the event itself
+      data = banks.GetView(1);
+  } else {
+    data = banks.GetView(fBankTag, Decoder::BankDirectory::kAnyNum);
+  }
+  if (!data.empty()) {
+    for (UInt_t i = 0; i < data.size() && i < NVars; i++)
+      dvars[i] = data[i];
+  } else if (fAnyBank) {
+    for (UInt_t i = startidx; i < evdata->GetEvLength(); i++) {
       UInt_t index = i-startidx;
       if (index < NVars) dvars[index] = evdata->GetRawData(i);
     }
-
-  }      
+  }
 
   return 1;
 }
@@ -25,6 +25,9 @@ public:
    virtual Int_t Analyze(THaEvData *evdata);
    virtual EStatus Init( const TDatime& run_time);
    Float_t GetData(const std::string& tag);
+   // Tag of the bank holding the data. By default, the first bank
+   // in the event is used.
+   void SetBankTag(UInt_t tag) { fBankTag = tag; fAnyBank = false; }
 
 private:
 
@@ -32,6 +35,8 @@ private:
    std::vector<std::string> dataKeys;
    UInt_t NVars;
    Double_t *dvars; 
+   UInt_t fBankTag;   // Tag of data bank
+   Bool_t fAnyBank;   // Use first bank, regardless of tag
 
    THaEvt125Handler(const THaEvt125Handler& fh);
    THaEvt125Handler& operator=(const THaEvt125Handler& fh);
@@ -15,7 +15,7 @@
 using namespace std;
 
 THaEvtTypeHandler::THaEvtTypeHandler(const char* name, const char* description)
-  : THaAnalysisObject(name, description), fDebugFile(nullptr)
+  : THaAnalysisObject(name, description), fDebugFile(nullptr), fAsync(false)
 {
 }
 
@@ -88,8 +88,29 @@ void THaEvtTypeHandler::SetDebugFile(const char *filename) {
     fDebugFile->open(filename);
 }
 
+Int_t THaEvtTypeHandler::GetCrates( vector<UInt_t>& /* crates */ ) const
+{
+  // Append the crates this handler reads from physics events to 'crates'.
+  // Only relevant with THaAnalyzer::EnableDemandDecoding. By default,
+  // handlers that may see physics events need all crates (return -1).
+  // Handlers of other event types need none.
+
+  if( eventtypes.empty() )
+    return -1;
+  for( auto type : eventtypes ) {
+    if( type > 0 && type <= Decoder::MAX_PHYS_EVTYPE )
+      return -1;
+  }
+  return 0;
+}
+
 Bool_t THaEvtTypeHandler::IsMyEvent( UInt_t type ) const
 {
+  // THaAnalyzer passes each event only to the handlers registered for
+  // its type (see GetEvtTypes), or to all handlers that have no event
+  // types. Derived classes that override this function must keep it
+  // consistent with the event type list.
+
   return any_of(eventtypes.begin(), eventtypes.end(),
                 [type](UInt_t evtype){ return type == evtype; });
 }
@@ -24,6 +24,7 @@ public:
    virtual EStatus Init( const TDatime& run_time );
    virtual void EvPrint() const;
    virtual Bool_t IsMyEvent( UInt_t type ) const;
+   virtual Int_t GetCrates( std::vector<UInt_t>& crates ) const;
    virtual void EvDump(THaEvData *evdata) const;
    virtual void SetDebugFile(std::ofstream *file) { if (file) fDebugFile=file; };
    virtual void SetDebugFile(const char *filename);
@@ -36,9 +37,17 @@ public:
    }
    virtual std::vector<UInt_t> GetEvtTypes() { return eventtypes; };
 
+   // Run Analyze() in a separate thread, with a separate decoder, instead
+   // of in the main event loop. Only for handlers whose results are not
+   // used by the analysis of other events, e.g. in cuts or in the output
+   // tree. Requires at least one event type.
+   void   SetAsync( Bool_t b = true ) { fAsync = b; }
+   Bool_t IsAsync() const { return fAsync; }
+
 protected:
    std::vector<UInt_t> eventtypes;
    std::ofstream *fDebugFile;
+   Bool_t fAsync;  // Run in separate thread
 
    virtual void MakePrefix();
 
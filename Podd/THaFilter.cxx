@@ -1,9 +1,17 @@
 // a class to handle event filtering
 // Each filter has an associated global 'cut' variable
 // to test against
+//
+// The cut is evaluated with the analysis, since it depends on the global
+// variables of the current event. The events passing it are written to
+// the output file in a background thread (see Podd::CodaWriter), so that
+// the analysis does not wait for the output, unless SetBufferSize(0) is
+// used.
 
 #include "THaFilter.h"
 #include "THaCodaFile.h"
+#include "THaCodaRun.h"
+#include "CodaWriter.h"
 #include "TError.h"
 #include "TString.h"
 #include "THaCutList.h"
@@ -12,13 +20,16 @@
 #include "THaEvData.h"
 // only for ERetVal, used by Process(). Should put ERetVal in a separate header
 #include "THaAnalyzer.h"
+#include <fstream>
 
 using namespace std;
 using namespace Decoder;
 
 //_____________________________________________________________________________
 THaFilter::THaFilter( const char *cutexpr, const char* filename ) :
-  fCutExpr(cutexpr), fFileName(filename), fCodaOut(nullptr), fCut(nullptr)
+  fCutExpr(cutexpr), fFileName(filename), fCodaOut(nullptr), fCut(nullptr),
+  fBufSize(Podd::CodaWriter::kDefaultBufSize), fListOnly(false),
+  fWriter(nullptr), fEvList(nullptr)
 {
   // Constructor
 
@@ -36,16 +47,47 @@ THaFilter::~THaFilter()
   Close();
   delete fCut;
   delete fCodaOut;
+  delete fWriter;
+  delete fEvList;
 }
 
 //_____________________________________________________________________________
 Int_t THaFilter::Close()
 {
-  // Close this filter. Closes output file if open.
-
-  if( !fCodaOut ) return 0;
+  // Close this filter. Closes output files if open.
+
+  Int_t ret = 0;
+  if( fEvList ) {
+    fEvList->close();
+    if( fEvList->fail() )
+      ret = -1;
+    delete fEvList; fEvList = nullptr;
+  }
+  if( fWriter ) {
+    Int_t st = fWriter->Close();
+    delete fWriter; fWriter = nullptr;
+    if( st != CODA_OK )
+      return st;
+  }
+  if( !fCodaOut ) return ret;
   //cout << "Flushing and Closing " << fFileName << endl;
-  return fCodaOut->codaClose();
+  Int_t st = fCodaOut->codaClose();
+  return st != 0 ? st : ret;
+}
+
+//_____________________________________________________________________________
+void THaFilter::SetEventList( const char* filename, Bool_t list_only )
+{
+  // Write a list of the events passing the cut to the text file 'filename',
+  // one line "run evnum evtype position" per event, where 'position' is the
+  // event's position in the input file (see THaCodaFile::GetEventPos), or -1
+  // if unknown (e.g. when events are read ahead in pipeline mode). If
+  // 'list_only' is set, no CODA output file is written. The selected events
+  // can then be re-read with THaCodaFile::ReadEventList, which is much
+  // faster and smaller than a copy of the data. Takes effect at Init().
+
+  fEvListName = filename;
+  fListOnly = list_only && !fEvListName.IsNull();
 }
 
 //_____________________________________________________________________________
@@ -66,17 +108,39 @@ Int_t THaFilter::Init(const TDatime& )
     Warning(here,"Illegal cut expression: %s.\nFilter is inactive.",
 	    fCutExpr.Data());
   } else {
-    fCodaOut = new THaCodaFile;
-    if (!fCodaOut) {
-      Error(here,"Cannot create CODA output file object. "
-	    "Something is very wrong." );
-      return -2;
+    if( !fEvListName.IsNull() ) {
+      fEvList = new ofstream(fEvListName.Data());
+      if( !*fEvList ) {
+        Error(here,"Cannot open event list file %s for writing.",
+              fEvListName.Data());
+        delete fEvList; fEvList = nullptr;
+        return -3;
+      }
+      *fEvList << "# Events passing " << fCutExpr << endl
+               << "# run evnum evtype position" << endl;
     }
-
-    if ( fCodaOut->codaOpen(fFileName, "w", 1) ) {
-      Error(here,"Cannot open CODA file %s for writing.",fFileName.Data());
-      delete fCodaOut;
-      return -3;
+    if( fListOnly ) {
+      // Event list only
+    } else if( fBufSize > 0 ) {
+      fWriter = new Podd::CodaWriter(fBufSize);
+      if( fWriter->Open(fFileName) != CODA_OK ) {
+        Error(here,"Cannot open CODA file %s for writing.",fFileName.Data());
+        delete fWriter; fWriter = nullptr;
+        return -3;
+      }
+    } else {
+      fCodaOut = new THaCodaFile;
+      if (!fCodaOut) {
+        Error(here,"Cannot create CODA output file object. "
+              "Something is very wrong." );
+        return -2;
+      }
+
+      if ( fCodaOut->codaOpen(fFileName, "w", 1) ) {
+        Error(here,"Cannot open CODA file %s for writing.",fFileName.Data());
+        delete fCodaOut; fCodaOut = nullptr;
+        return -3;
+      }
     }
     fIsInit = 1;
   }
@@ -95,8 +159,31 @@ Int_t THaFilter::Process( const THaEvData* evdata, const THaRunBase* run,
   if (!fIsInit || !fCut->EvalCut())
     return THaAnalyzer::kOK;
 
+  // The event being analyzed. With read-ahead, the run's buffer may
+  // already hold a later event.
+  const UInt_t* evbuffer = evdata ? evdata->GetRawDataBuffer()
+                                  : run->GetEvBuffer();
+
+  if( fEvList ) {
+    // The input file's position is that of the analyzed event only if
+    // the event was not read ahead
+    Long64_t pos = -1;
+    auto* crun = dynamic_cast<const THaCodaRun*>(run);
+    auto* cfile = crun
+      ? dynamic_cast<const THaCodaFile*>(crun->GetCodaData()) : nullptr;
+    if( cfile && evbuffer == run->GetEvBuffer() &&
+        cfile->GetEventPos() != kMaxUInt )
+      pos = cfile->GetEventPos();
+    *fEvList << run->GetNumber() << " "
+             << (evdata ? evdata->GetEvNum() : 0) << " "
+             << (evdata ? evdata->GetEvType() : 0) << " " << pos << "\n";
+  }
+  if( fListOnly )
+    return THaAnalyzer::kOK;
+
   // write out the event
-  Int_t ret = fCodaOut->codaWrite(run->GetEvBuffer());
+  Int_t ret = fWriter ? fWriter->Write(evbuffer)
+                      : fCodaOut->codaWrite(evbuffer);
   if( ret == CODA_FATAL ) {
     Error( here, "Fatal error writing to CODA output file %s. Check if you have "
 	   "write permission", fFileName.Data() );
@@ -4,11 +4,13 @@
 #include "THaPostProcess.h"
 #include "TString.h"
 #include "Decoder.h"
+#include <iosfwd>
 
 class THaCut;
 class TString;
 class TDatime;
 class THaRunBase;
+namespace Podd { class CodaWriter; }
 
 class THaFilter : public THaPostProcess {
  public:
@@ -21,11 +23,23 @@ class THaFilter : public THaPostProcess {
 
   THaCut* GetCut() const { return fCut; }
 
+  // Write asynchronously through buffers of 'bufsize' bytes (default
+  // Podd::CodaWriter::kDefaultBufSize; 0: write synchronously)
+  void    SetBufferSize( UInt_t bufsize ) { fBufSize = bufsize; }
+  // Also (or, with 'list_only', only) write a list of the events passing
+  // the cut. See Decoder::THaCodaFile::ReadEventList.
+  void    SetEventList( const char* filename, Bool_t list_only = true );
+
  protected:
   TString   fCutExpr;    // Definition of cut to use for filtering events
   TString   fFileName;   // Name of CODA output file
   Decoder::THaCodaFile* fCodaOut; // The CODA output file
   THaCut*   fCut;        // Pointer to cut used for filtering
+  UInt_t    fBufSize;    // Buffer size for asynchronous writing (bytes)
+  TString   fEvListName; // Name of event list file
+  Bool_t    fListOnly;   // Write only the event list, no CODA data
+  Podd::CodaWriter* fWriter; //! Asynchronous CODA output
+  std::ofstream*    fEvList; //! Event list output
 
  public:
   ClassDef(THaFilter,0)
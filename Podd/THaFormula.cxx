@@ -11,6 +11,13 @@
 // THaFormulas containing arrays are arrays themselves. Each element
 // (instance) of such an array formula may be evaluated separately.
 //
+// Expressions consisting only of numbers, global variables, cuts,
+// operators and common math functions are additionally compiled into
+// a Podd::FormulaProgram, which reads the variables directly and is
+// evaluated much faster than the TFormula interpreter. Other expressions
+// (strings, special functions like Sum$, TMath calls etc.) use the
+// interpreter. This can be turned off with SetCompiledEval(false).
+//
 //////////////////////////////////////////////////////////////////////////
 
 #include "THaFormula.h"
@@ -23,6 +30,7 @@
 #include "TVirtualMutex.h"
 #include "TMath.h"
 #include "DataType.h"
+#include "VarView.h"
 
 #include <cstring>
 #include <cassert>
@@ -40,6 +48,8 @@ enum EFuncCode { kLength, kSum, kMean, kStdDev, kMax, kMin,
 
 #define ALL(c) (c).begin(), (c).end()
 
+Bool_t THaFormula::fgCompiledEval = true;
+
 //_____________________________________________________________________________
 static inline Int_t NumberOfSetBits( UInt_t v )
 {
@@ -159,7 +169,8 @@ Int_t THaFormula::Init( const char* name, const char* expression )
 //_____________________________________________________________________________
 THaFormula::THaFormula( const THaFormula& rhs ) :
   TFormula(rhs), fVarDef(rhs.fVarDef),
-  fVarList(rhs.fVarList), fCutList(rhs.fCutList), fInstance(0)
+  fVarList(rhs.fVarList), fCutList(rhs.fCutList), fInstance(0),
+  fProgram(rhs.fProgram)
 {
   // Copy ctor
 }
@@ -176,6 +187,7 @@ THaFormula& THaFormula::operator=( const THaFormula& rhs )
     fVarList = rhs.fVarList;
     fCutList = rhs.fCutList;
     fInstance = 0;
+    fProgram = rhs.fProgram;
   }
   return *this;
 }
@@ -241,6 +253,7 @@ Int_t THaFormula::Compile( const char* expression )
   fNval = 0;
   fAlreadyFound.ResetAllBits(); // Seems to be missing in ROOT
   fVarDef.clear();
+  fProgram.Clear();
   ResetBit(kArrayFormula);
 
   Int_t status = TFormula::Compile( expression );
@@ -258,10 +271,118 @@ Int_t THaFormula::Compile( const char* expression )
     // but the best we can do with the implementation of TFormula.
     if( fNstring > 0 && fNval > 0 )
       fNval = fNstring = static_cast<Int_t>(fVarDef.size());
+    if( fgCompiledEval )
+      CompileProgram();
   }
   return status;
 }
 
+//_____________________________________________________________________________
+Bool_t THaFormula::CompileProgram()
+{
+  // Try to translate the (already successfully parsed) expression into
+  // a FormulaProgram. Variables with a fixed memory location are read
+  // directly; everything else goes through DefinedValue(). Returns false,
+  // leaving the interpreter in charge, if the expression uses features
+  // not supported by FormulaProgram.
+
+  fProgram.Clear();
+  if( fNstring > 0 )
+    return false;
+  for( const auto& def : fVarDef ) {
+    if( def.type != kVariable && def.type != kArray && def.type != kCut )
+      return false;
+  }
+  auto resolve = [this]( const string& name,
+                         Podd::FormulaProgram::Operand_t& opd ) -> Bool_t {
+    // Look up the name among the variables and cuts that TFormula found
+    TString tname(name.c_str());
+    vector<FVarDef_t>::size_type nvar = fVarDef.size();
+    Int_t k = DefinedGlobalVariable(tname);
+    if( k < 0 )
+      k = DefinedCut(tname);
+    if( fVarDef.size() != nvar ) {
+      // Not a name TFormula used. Should not happen, but don't guess
+      fVarDef.erase(fVarDef.begin()+nvar, fVarDef.end());
+      return false;
+    }
+    if( k < 0 )
+      return false;
+    const FVarDef_t& def = fVarDef[k];
+    opd = Podd::FormulaProgram::Operand_t();
+    opd.index = k;
+    if( def.type == kVariable || def.type == kArray ) {
+      const auto* var = static_cast<const THaVar*>(def.obj);
+      assert(var);
+      VarType type = var->GetType();
+      // Only data members (and fixed-size arrays) keep their address
+      if( type >= kDouble && type <= kUChar && var->IsBasic() &&
+          var->IsContiguous() && !var->IsVarArray() &&
+          def.index < var->GetLen() ) {
+        const void* ptr = var->GetDataPointer(def.type == kArray ? 0 : def.index);
+        if( ptr ) {
+          opd.kind = (def.type == kArray)
+            ? Podd::FormulaProgram::Operand_t::kArrayData
+            : Podd::FormulaProgram::Operand_t::kData;
+          opd.type = type;
+          opd.ptr  = ptr;
+          opd.len  = var->GetLen();
+        }
+      }
+    }
+    return true;
+  };
+  return fProgram.Compile(GetTitle(), resolve);
+}
+
+//_____________________________________________________________________________
+Double_t THaFormula::ProgramValue( void* obj, Int_t i )
+{
+  // Callback for FormulaProgram operands that are not read directly
+
+  return static_cast<THaFormula*>(obj)->DefinedValue(i);
+}
+
+//_____________________________________________________________________________
+void THaFormula::ProgramColumn( void* obj, Int_t i, Int_t first, Int_t n,
+                                Double_t* out )
+{
+  // Callback for FormulaProgram::EvalAll: values of operand 'i' for
+  // instances first ... first+n-1
+
+  auto* f = static_cast<THaFormula*>(obj);
+  const FVarDef_t& def = f->fVarDef[i];
+  if( def.type == kArray ) {
+    // Variable-size arrays etc. Read the data directly if possible.
+    const auto* var = static_cast<const THaVar*>(def.obj);
+    assert(var);
+    Podd::VarView view;
+    Podd::VarReader<Double_t> reader;
+    if( var->GetView(view) && first + n <= view.len &&
+        reader.Init(view.type) ) {
+      view.base += first * view.stride;
+      reader.Read(view, out, n);
+      return;
+    }
+    for( Int_t j = 0; j < n; ++j ) {
+      f->fInstance = first + j;
+      out[j] = f->DefinedValue(i);
+    }
+    return;
+  }
+  // Everything else is the same for all instances
+  std::fill(out, out+n, f->DefinedValue(i));
+}
+
+//_____________________________________________________________________________
+void THaFormula::SetCompiledEval( Bool_t enable )
+{
+  // Enable/disable compiled evaluation of formulas. Takes effect for
+  // formulas compiled afterwards.
+
+  fgCompiledEval = enable;
+}
+
 //_____________________________________________________________________________
 char* THaFormula::DefinedString( Int_t i )
 {
@@ -321,8 +442,10 @@ Double_t THaFormula::DefinedValue( Int_t i )
     break;
   case kCut:
     {
-      const auto* cut = static_cast<const THaCut*>(def.obj);
+      auto* cut = static_cast<THaCut*>(def.obj);
       assert(cut);
+      if( THaCut::IsLazyEval() && !cut->IsEvaluated() )
+        cut->EvalCut();
       return cut->GetResult();
     }
     break;
@@ -362,11 +485,8 @@ Double_t THaFormula::DefinedValue( Int_t i )
 	return NumberOfSetBits( static_cast<ULong64_t>(y) );
       }
 
-      vector<Double_t> values;
-      values.reserve(ndata);
-      for( Int_t instance = 0; instance < ndata; ++instance ) {
-	values.push_back( func->EvalInstance(instance) );
-      }
+      vector<Double_t> values(ndata);
+      func->EvalAll( &values[0], ndata );
       if( func->IsInvalid() ) {
 	SetBit(kInvalid);
 	return 1.0;
@@ -576,6 +696,7 @@ Int_t THaFormula::DefinedGlobalVariableExtraList( TString& name,
   if(!var) {
     return -1;
   }
+  var->SetUsed();
 
   EVariableType type = kVariable;
   Int_t index = 0;
@@ -717,6 +838,49 @@ Double_t THaFormula::EvalInstance( Int_t instance )
   return y;
 }
 
+//_____________________________________________________________________________
+Int_t THaFormula::EvalAll( Double_t* out, Int_t n )
+{
+  // Evaluate instances 0 ... n-1 of this formula, or as many as there are
+  // (see GetNdata), and store the results in 'out'. Returns the number of
+  // instances evaluated. As with EvalInstance, invalid results are kBig.
+  // The kInvalid bit is set if any instance is invalid.
+  //
+  // Compiled formulas without && and || are evaluated for all instances
+  // at once (see Podd::FormulaProgram::EvalAll), which is much faster
+  // than calling EvalInstance for each instance.
+
+  if( !out || n <= 0 )
+    return 0;
+  n = TMath::Min( n, GetNdata() );
+  if( n <= 0 )
+    return 0;
+  if( IsError() ) {
+    std::fill( out, out+n, kBig );
+    return n;
+  }
+
+  ResetBit(kInvalid);
+  if( n > 1 && fProgram.IsValid() ) {
+    Bool_t invalid = false;
+    if( fProgram.EvalAll(ProgramColumn, this, out, n, invalid) ) {
+      if( !invalid && !IsInvalid() )
+        return n;
+      // Redo instance by instance to find the invalid ones
+      ResetBit(kInvalid);
+    }
+  }
+  Bool_t invalid = false;
+  for( Int_t i = 0; i < n; ++i ) {
+    out[i] = EvalInstance(i);
+    if( IsInvalid() )
+      invalid = true;
+  }
+  if( invalid )
+    SetBit(kInvalid);
+  return n;
+}
+
 //_____________________________________________________________________________
 Int_t THaFormula::GetNdataUnchecked() const
 {
@@ -10,6 +10,7 @@
 #include "RVersion.h"
 #include "v5/TFormula.h"
 #include "THaGlobals.h"
+#include "FormulaProgram.h"
 #include <vector>
 #include <iostream>
 
@@ -47,6 +48,7 @@ public:
   // need to hack this-pointer to be non-const - courtesy of ROOT team
   { return const_cast<THaFormula*>(this)->Eval(); }
   virtual Double_t    EvalInstance( Int_t instance );
+  virtual Int_t       EvalAll( Double_t* out, Int_t n );
   virtual Int_t       GetNdata()   const;
   virtual Bool_t      IsArray()    const { return TestBit(kArrayFormula); }
   virtual Bool_t      IsVarArray() const { return TestBit(kVarArray); }
@@ -55,6 +57,10 @@ public:
   virtual void        Print( Option_t* option="" ) const;
           void        SetList( const THaVarList* lst )    { fVarList = lst; }
           void        SetCutList( const THaCutList* lst ) { fCutList = lst; }
+          Bool_t      IsCompiled() const { return fProgram.IsValid(); }
+
+  static  void        SetCompiledEval( Bool_t enable = true );
+  static  Bool_t      GetCompiledEval() { return fgCompiledEval; }
 
 protected:
 
@@ -87,13 +93,21 @@ protected:
   const THaVarList* fVarList;          //Pointer to list of variables
   const THaCutList* fCutList;          //Pointer to list of cuts
   Int_t             fInstance;         //Current instance to evaluate
+  Podd::FormulaProgram fProgram;       //! Compiled expression, if supported
+
+  static Bool_t     fgCompiledEval;    // Use compiled evaluation if possible
 
+          Bool_t    CompileProgram();
           Double_t  EvalInstanceUnchecked( Int_t instance );
           Int_t     GetNdataUnchecked() const;
           Int_t     Init( const char* name, const char* expression );
   virtual Bool_t    IsString( Int_t oper ) const;
   virtual void      RegisterFormula( Bool_t add = true );
 
+  static  Double_t  ProgramValue( void* obj, Int_t i );
+  static  void      ProgramColumn( void* obj, Int_t i, Int_t first, Int_t n,
+                                   Double_t* out );
+
   ClassDef(THaFormula,0)  //Formula defined on list of variables
 };
 
@@ -102,6 +116,13 @@ inline
 Double_t THaFormula::EvalInstanceUnchecked( Int_t instance )
 {
   fInstance = instance;
+  if( fProgram.IsValid() ) {
+    Bool_t invalid = false;
+    Double_t y = fProgram.Eval(ProgramValue, this, instance, invalid);
+    if( invalid )
+      SetBit(kInvalid);
+    return y;
+  }
   if( fNoper == 1 && fVarDef.size() == 1 )
     return DefinedValue(0);
   else
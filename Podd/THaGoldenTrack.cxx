@@ -109,12 +109,16 @@ Int_t THaGoldenTrack::Process( const THaEvData& )
 
   fGoldBeta = fTrack->GetBeta();
 
-  // Find the track's index
+  // Find the track's index. Use the index stored in the track if it is
+  // consistent with the track array, else search for it.
   Int_t ntracks = fSpectro->GetNTracks();
+  TClonesArray* tracks = fSpectro->GetTracks();
+  Int_t idx = fTrack->GetIndex();
   if( ntracks == 1 )
     fIndex = 0;
+  else if( idx >= 0 && idx < ntracks && tracks->At(idx) == fTrack )
+    fIndex = idx;
   else {  // ntracks>1
-    TClonesArray* tracks = fSpectro->GetTracks();
     for( Int_t i=0; i<ntracks; i++ ) {
       if( tracks->At(i) == fTrack ) {
 	fIndex = i;
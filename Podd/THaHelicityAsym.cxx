@@ -0,0 +1,332 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// THaHelicityAsym
+//
+// Helicity-gated accumulators for parity-style analyses. Sums a list of
+// global variables (detector integrals, beam positions etc.) per
+// helicity window, and forms pairs of consecutive windows of opposite
+// helicity. For each pair and variable, the asymmetry
+//
+//    A = (Y+ - Y-) / (Y+ + Y-)
+//
+// and the difference D = Y+ - Y- of the per-event means Y in the two
+// windows are computed. Their running means and errors over the run are
+// available as global variables, updated after each pair, along with
+// the mean yields per helicity state. Optionally (SetPairTree), a tree
+// with one entry per pair is written, so that offline analyses need not
+// read the per-event data.
+//
+// Windows are identified by the helicity reported by the helicity
+// detector (any THaHelicityDet, e.g. THaG0Helicity, THaQWEAKHelicity,
+// THaADCHelicity): a window ends when the helicity flips. Consecutive
+// windows of the same helicity, as in the middle of a +--+ quartet, are
+// thus summed as one. Since these runs of windows always alternate in
+// sign, every two of them form a pair. Events without valid helicity
+// discard the windows not yet paired.
+//
+// The variables are given as a whitespace-separated list of names of
+// global variables, optionally with an array index, e.g.
+//
+//   new THaHelicityAsym("hasym", "Beam asymmetries", "R.hel",
+//                       "urb.BPMA.x urb.BPMA.y R.s0.la_c[0]");
+//
+// Events where any variable has no data (index out of range) are skipped.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "THaHelicityAsym.h"
+#include "THaHelicityDet.h"
+#include "THaVarList.h"
+#include "THaVar.h"
+#include "THaString.h"
+#include "VarDef.h"
+#include "TTree.h"
+#include "TMath.h"
+#include <iostream>
+#include <cstdlib>
+#include <utility>
+
+using namespace std;
+
+//_____________________________________________________________________________
+Double_t THaHelicityAsym::Stat_t::Err() const
+{
+  // Error of the mean
+
+  return (n > 1) ? TMath::Sqrt(m2 / (n-1) / n) : 0.0;
+}
+
+//_____________________________________________________________________________
+THaHelicityAsym::THaHelicityAsym( const char* name, const char* description,
+                                  const char* helicity, const char* var_list )
+  : THaPhysicsModule(name, description), fHelName(helicity),
+    fVarList(var_list), fHelDet(nullptr), fStateN{0, 0}, fNpairs(0),
+    fNbad(0), fDoTree(false), fTree(nullptr), fPairHel(0), fPairN{0, 0}
+{
+  // Constructor. 'helicity' is the name of the helicity detector,
+  // 'var_list' the list of global variables to accumulate.
+}
+
+//_____________________________________________________________________________
+THaHelicityAsym::~THaHelicityAsym()
+{
+  // Destructor
+
+  RemoveVariables();
+  delete fTree;
+}
+
+//_____________________________________________________________________________
+THaAnalysisObject::EStatus THaHelicityAsym::Init( const TDatime& run_time )
+{
+  // Initialize the module. Locate the helicity detector and the input
+  // variables, which must be defined at this point.
+
+  static const char* const here = "Init";
+
+  fHelDet = dynamic_cast<THaHelicityDet*>
+    ( FindModule( fHelName.Data(), "THaHelicityDet" ));
+  if( !fHelDet )
+    return fStatus;
+
+  THaVarList* vars = GetVarList();
+  vector<Input_t> inputs;
+  for( const auto& item : THaString::Split(fVarList.Data()) ) {
+    Input_t input;
+    input.name = item.c_str();
+    Ssiz_t pos = input.name.Index("[");
+    if( pos != kNPOS && input.name.EndsWith("]") ) {
+      TString idx = input.name(pos+1, input.name.Length()-pos-2);
+      input.index = atoi(idx.Data());
+      input.name.Remove(pos);
+    }
+    input.var = vars ? vars->Find(input.name.Data()) : nullptr;
+    if( !input.var || input.index < 0 ) {
+      Error( Here(here), "Global variable %s not found.", item.c_str() );
+      return fStatus = kInitError;
+    }
+    inputs.push_back(input);
+  }
+  if( inputs.empty() ) {
+    Error( Here(here), "No variables to accumulate." );
+    return fStatus = kInitError;
+  }
+  // The variable arrays must not change size once defined
+  if( fIsSetup && inputs.size() != fVars.size() ) {
+    Error( Here(here), "Number of variables changed. Cannot re-initialize." );
+    return fStatus = kInitError;
+  }
+  fVars = std::move(inputs);
+
+  size_t n = fVars.size();
+  fCur.sum.assign(n, 0);
+  fPending.sum.assign(n, 0);
+  fStateSum[0].assign(n, 0);
+  fStateSum[1].assign(n, 0);
+  fAsymStat.resize(n);
+  fDiffStat.resize(n);
+  fAsym.resize(n);
+  fAsymErr.resize(n);
+  fDiff.resize(n);
+  fDiffErr.resize(n);
+  fYieldP.resize(n);
+  fYieldM.resize(n);
+  fPairAsym.resize(n);
+  fPairDiff.resize(n);
+
+  return THaPhysicsModule::Init(run_time);
+}
+
+//_____________________________________________________________________________
+Int_t THaHelicityAsym::DefineVariables( EMode mode )
+{
+  // Define/delete global variables. The arrays hold one element per
+  // input variable, in the order given in the variable list.
+
+  Int_t n = static_cast<Int_t>(fVars.size());
+  VarDef vars[] = {
+    { "npairs",   "Number of helicity pairs",        kInt,    0, &fNpairs },
+    { "nbad",     "Events without valid helicity",   kInt,    0, &fNbad },
+    { "asym",     "Mean pair asymmetry",             kDouble, n, fAsym.data() },
+    { "asym_err", "Error of mean pair asymmetry",    kDouble, n, fAsymErr.data() },
+    { "diff",     "Mean pair difference (+ minus -)", kDouble, n, fDiff.data() },
+    { "diff_err", "Error of mean pair difference",   kDouble, n, fDiffErr.data() },
+    { "yield_p",  "Mean per event, helicity +",      kDouble, n, fYieldP.data() },
+    { "yield_m",  "Mean per event, helicity -",      kDouble, n, fYieldM.data() },
+    { nullptr }
+  };
+  return DefineVarsFromList( vars, mode );
+}
+
+//_____________________________________________________________________________
+Int_t THaHelicityAsym::Begin( THaRunBase* )
+{
+  // Start accumulating for a new run
+
+  for( int s = 0; s < 2; ++s ) {
+    fStateSum[s].assign(fVars.size(), 0);
+    fStateN[s] = 0;
+  }
+  for( auto& st : fAsymStat ) st.Clear();
+  for( auto& st : fDiffStat ) st.Clear();
+  fAsym.assign(fAsym.size(), 0);
+  fAsymErr.assign(fAsymErr.size(), 0);
+  fDiff.assign(fDiff.size(), 0);
+  fDiffErr.assign(fDiffErr.size(), 0);
+  fYieldP.assign(fYieldP.size(), 0);
+  fYieldM.assign(fYieldM.size(), 0);
+  fNpairs = fNbad = 0;
+  ResetPattern();
+  return 0;
+}
+
+//_____________________________________________________________________________
+void THaHelicityAsym::ResetPattern()
+{
+  // Discard the current and the pending window
+
+  fCur.Clear();
+  fPending.Clear();
+}
+
+//_____________________________________________________________________________
+Int_t THaHelicityAsym::Process( const THaEvData& )
+{
+  // Add the current event to the window of its helicity. Complete a
+  // pair of windows when the helicity flips.
+
+  if( !IsOK() ) return -1;
+
+  if( !fHelDet->HelicityValid() ||
+      fHelDet->GetHelicity() == THaHelicityDet::kUnknown ) {
+    ++fNbad;
+    ResetPattern();
+    return 0;
+  }
+  for( const auto& input : fVars ) {
+    if( input.index >= input.var->GetLen() )
+      return 0;
+  }
+
+  Int_t hel = fHelDet->GetHelicity();
+  if( fCur.n > 0 && hel != fCur.hel )
+    CloseWindow();
+  fCur.hel = hel;
+  ++fCur.n;
+  auto& state = fStateSum[hel > 0];
+  ++fStateN[hel > 0];
+  for( size_t i = 0; i < fVars.size(); ++i ) {
+    Double_t x = fVars[i].var->GetValue(fVars[i].index);
+    fCur.sum[i] += x;
+    state[i] += x;
+  }
+
+  fDataValid = true;
+  return 0;
+}
+
+//_____________________________________________________________________________
+void THaHelicityAsym::CloseWindow()
+{
+  // The current window is complete. If there is a pending window, the two
+  // form a pair: update pair statistics and global variables. Otherwise,
+  // the current window becomes the pending one.
+
+  if( fPending.n == 0 ) {
+    std::swap(fPending, fCur);
+    fCur.Clear();
+    return;
+  }
+  // Windows always alternate in helicity
+  const Window_t& wp = (fCur.hel > 0) ? fCur : fPending;
+  const Window_t& wm = (fCur.hel > 0) ? fPending : fCur;
+  for( size_t i = 0; i < fVars.size(); ++i ) {
+    Double_t yp = wp.sum[i] / wp.n, ym = wm.sum[i] / wm.n;
+    Double_t d = yp - ym, s = yp + ym;
+    fPairDiff[i] = d;
+    fDiffStat[i].Add(d);
+    if( s != 0 ) {
+      fPairAsym[i] = d / s;
+      fAsymStat[i].Add(d / s);
+    } else
+      fPairAsym[i] = kBig;
+    fAsym[i]    = fAsymStat[i].mean;
+    fAsymErr[i] = fAsymStat[i].Err();
+    fDiff[i]    = fDiffStat[i].mean;
+    fDiffErr[i] = fDiffStat[i].Err();
+    fYieldM[i]  = fStateN[0] ? fStateSum[0][i] / fStateN[0] : 0;
+    fYieldP[i]  = fStateN[1] ? fStateSum[1][i] / fStateN[1] : 0;
+  }
+  ++fNpairs;
+
+  if( fDoTree ) {
+    if( !fTree )
+      MakeTree();
+    fPairHel  = fPending.hel;
+    fPairN[0] = wm.n;
+    fPairN[1] = wp.n;
+    fTree->Fill();
+  }
+  ResetPattern();
+}
+
+//_____________________________________________________________________________
+void THaHelicityAsym::MakeTree()
+{
+  // Create the pair tree "<name>P" in the current directory, i.e. the
+  // output file. Called at the first pair, like THaScalerEvtHandler.
+
+  TString tname = fName + "P";
+  fTree = new TTree(tname.Data(), Form("%s helicity pairs", fName.Data()));
+  fTree->SetAutoSave(200000000);
+  Int_t n = static_cast<Int_t>(fVars.size());
+  fTree->Branch("hel", &fPairHel, "hel/I");
+  fTree->Branch("n", fPairN, "n[2]/i");
+  fTree->Branch("asym", fPairAsym.data(), Form("asym[%d]/D", n));
+  fTree->Branch("diff", fPairDiff.data(), Form("diff[%d]/D", n));
+}
+
+//_____________________________________________________________________________
+Int_t THaHelicityAsym::End( THaRunBase* )
+{
+  // End of run: print summary and write the pair tree
+
+  if( fDebug > 0 )
+    Print();
+  if( fTree )
+    fTree->Write();
+  return 0;
+}
+
+//_____________________________________________________________________________
+void THaHelicityAsym::Print( Option_t* opt ) const
+{
+  // Print the accumulated asymmetries and differences
+
+  THaPhysicsModule::Print(opt);
+  cout << "Helicity detector: " << fHelName << endl;
+  cout << "Pairs: " << fNpairs << ", events without helicity: " << fNbad
+       << endl;
+  for( size_t i = 0; i < fVars.size() && i < fAsym.size(); ++i ) {
+    cout << "  " << fVars[i].name;
+    if( fVars[i].index > 0 )
+      cout << "[" << fVars[i].index << "]";
+    cout << ": A = " << fAsym[i] << " +- " << fAsymErr[i]
+         << ", D = " << fDiff[i] << " +- " << fDiffErr[i]
+         << ", Y+ = " << fYieldP[i] << ", Y- = " << fYieldM[i] << endl;
+  }
+}
+
+//_____________________________________________________________________________
+void THaHelicityAsym::SetHelicity( const char* name )
+{
+  // Set the name of the helicity detector
+
+  if( !IsInit() )
+    fHelName = name;
+  else
+    PrintInitError("SetHelicity");
+}
+
+//_____________________________________________________________________________
+ClassImp(THaHelicityAsym)
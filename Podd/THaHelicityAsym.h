@@ -0,0 +1,116 @@
+#ifndef Podd_THaHelicityAsym_h_
+#define Podd_THaHelicityAsym_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// THaHelicityAsym
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "THaPhysicsModule.h"
+#include "TString.h"
+#include <vector>
+
+class THaHelicityDet;
+class THaVar;
+class TTree;
+
+class THaHelicityAsym : public THaPhysicsModule {
+
+public:
+  THaHelicityAsym( const char* name, const char* description,
+                   const char* helicity, const char* var_list );
+  THaHelicityAsym( const THaHelicityAsym& ) = delete;
+  THaHelicityAsym& operator=( const THaHelicityAsym& ) = delete;
+  virtual ~THaHelicityAsym();
+
+  virtual Int_t     Begin( THaRunBase* r=nullptr );
+  virtual Int_t     End( THaRunBase* r=nullptr );
+  virtual EStatus   Init( const TDatime& run_time );
+  virtual void      Print( Option_t* opt="" ) const;
+  virtual Int_t     Process( const THaEvData& evdata );
+
+  UInt_t            GetNvars()   const { return fVars.size(); }
+  Int_t             GetNpairs()  const { return fNpairs; }
+  Double_t          GetAsym( UInt_t i )    const { return fAsym[i]; }
+  Double_t          GetAsymErr( UInt_t i ) const { return fAsymErr[i]; }
+  Double_t          GetDiff( UInt_t i )    const { return fDiff[i]; }
+  Double_t          GetDiffErr( UInt_t i ) const { return fDiffErr[i]; }
+
+  void              SetHelicity( const char* name );
+  void              SetPairTree( Bool_t b = true ) { fDoTree = b; }
+
+protected:
+
+  // Running mean and variance of a quantity (Welford's algorithm)
+  class Stat_t {
+  public:
+    Stat_t() : n(0), mean(0), m2(0) {}
+    void     Clear() { n = 0; mean = m2 = 0; }
+    void     Add( Double_t x ) {
+      ++n; Double_t d = x - mean; mean += d/n; m2 += d*(x - mean);
+    }
+    Double_t Err() const;   // Error of the mean
+    Long64_t n;
+    Double_t mean;
+    Double_t m2;
+  };
+
+  // Sums of all variables over the events of one helicity window
+  class Window_t {
+  public:
+    Window_t() : hel(0), n(0) {}
+    void     Clear() { n = 0; sum.assign(sum.size(), 0); }
+    Int_t    hel;                 // Helicity state (+1/-1)
+    UInt_t   n;                   // Number of events
+    std::vector<Double_t> sum;    // Sum of each variable
+  };
+
+  // Input variable, optionally an element of an array ("name[i]")
+  class Input_t {
+  public:
+    Input_t() : index(0), var(nullptr) {}
+    TString       name;   // Global variable name
+    Int_t         index;  // Element index
+    const THaVar* var;    // The variable, found at Init
+  };
+
+  virtual Int_t  DefineVariables( EMode mode = kDefine );
+          void   CloseWindow();
+          void   ResetPattern();
+          void   MakeTree();
+
+  TString               fHelName;  // Name of the helicity detector
+  TString               fVarList;  // Names of the variables to accumulate
+  THaHelicityDet*       fHelDet;   // The helicity detector
+  std::vector<Input_t>  fVars;     // Variables to accumulate
+
+  Window_t              fCur;      // Window being filled
+  Window_t              fPending;  // Last complete window, not yet paired
+  std::vector<Double_t> fStateSum[2]; // Sums per helicity state (-,+) over run
+  Long64_t              fStateN[2];   // Events per helicity state over run
+  std::vector<Stat_t>   fAsymStat;    // Pair asymmetries
+  std::vector<Stat_t>   fDiffStat;    // Pair differences
+
+  // Global variables, updated whenever a pair is complete
+  Int_t                 fNpairs;   // Number of pairs
+  Int_t                 fNbad;     // Events without valid helicity
+  std::vector<Double_t> fAsym;     // Mean pair asymmetry
+  std::vector<Double_t> fAsymErr;  // Its error
+  std::vector<Double_t> fDiff;     // Mean pair difference (+ minus -)
+  std::vector<Double_t> fDiffErr;  // Its error
+  std::vector<Double_t> fYieldP;   // Mean per event in + state
+  std::vector<Double_t> fYieldM;   // Mean per event in - state
+
+  // Optional tree with one entry per pair
+  Bool_t                fDoTree;
+  TTree*                fTree;
+  Int_t                 fPairHel;    // Helicity of the first window
+  UInt_t                fPairN[2];   // Events in the -,+ windows
+  std::vector<Double_t> fPairAsym;   // Asymmetries of the pair
+  std::vector<Double_t> fPairDiff;   // Differences of the pair
+
+  ClassDef(THaHelicityAsym,0)  // Helicity-gated accumulators and asymmetries
+};
+
+#endif
@@ -13,19 +13,12 @@
 #include "TROOT.h"
 #include "TClass.h"
 #include "TError.h"
-#include "TSystem.h"
 #include "TString.h"
-#include "TRegexp.h"
-#include "TTree.h"
 #include "THaInterface.h"
+#include "BatchInterface.h"
 #include "TInterpreter.h"
-#include "THaVarList.h"
-#include "THaCutList.h"
-#include "CodaRawDecoder.h"
 #include "THaGlobals.h"
-#include "THaAnalyzer.h"
 //#include "THaFileDB.h"
-#include "Textvars.h"   // for gHaTextars
 #include "ha_compiledata.h"
 #include <cstring>
 #include <sstream>
@@ -46,8 +39,6 @@ THaDB*       gHaDB       = nullptr;  // Database system to use
 
 THaInterface* THaInterface::fgAint = nullptr;  // Pointer to this interface
 
-static TString fgTZ;
-
 //_____________________________________________________________________________
 THaInterface::THaInterface( const char* appClassName, int* argc, char** argv,
 			    void* options, int numOptions, Bool_t noLogo ) :
@@ -67,70 +58,11 @@ THaInterface::THaInterface( const char* appClassName, int* argc, char** argv,
     PrintLogo();
 
   SetPrompt("analyzer [%d] ");
-  gHaVars    = new THaVarList;
-  gHaCuts    = new THaCutList( gHaVars );
-  gHaApps    = new TList;
-  gHaPhysics = new TList;
-  gHaEvtHandlers = new TList;
-  // Use the standard CODA file decoder by default
-  gHaDecoder = Podd::CodaRawDecoder::Class();
+  Podd::BatchInterface::CreateGlobals();
   // File-based database by default
   //  gHaDB      = new THaFileDB();
-  gHaTextvars = new Podd::Textvars;
-
-  // Set the maximum size for a file written by Podd contained by the TTree
-  //  putting it to 1.5 GB, down from the default 1.9 GB since something odd
-  //  happens for larger files
-  //FIXME: investigate
-  TTree::SetMaxTreeSize(1500000000);
-
-  // Make the Podd header directory(s) available so scripts don't have to
-  // specify an explicit path.
-  // If $ANALYZER defined, we take our includes from there, otherwise we fall
-  // back to the compile-time directories (which may have moved!)
-  TString s = gSystem->Getenv("ANALYZER");
-  if( s.IsNull() ) {
-    s = HA_INCLUDEPATH;
-  } else {
-    // Give preference to $ANALYZER/include
-    TString p = s+"/include";
-    void* dp = gSystem->OpenDirectory(p);
-    if( dp ) {
-      gSystem->FreeDirectory(dp);
-      s = p;
-    } else
-      s = s+"/src " + s+"/hana_decode ";
-  }
-  // Directories names separated by blanks.
-  // FIXME: allow blanks
-  TRegexp re("[^ ]+");
-  TString ss = s(re);
-  while( !ss.IsNull() ) {
-    // Only add dirs that exist
-    void* dp = gSystem->OpenDirectory(ss);
-    if( dp ) {
-      gInterpreter->AddIncludePath(ss);
-      gSystem->FreeDirectory(dp);
-    }
-    s.Remove(0,s.Index(re)+ss.Length());
-    ss = s(re);
-  }
-
-  // Because of lack of foresight, the analyzer uses TDatime objects,
-  // which are kept in localtime() and hence are not portable, and also
-  // uses localtime() directly in several places. As a result, database
-  // lookups depend on the timezone of the machine that the replay is done on!
-  // If this timezone is different from the one in which the data were taken,
-  // mismatches may occur. This is bad.
-  // FIXME: Use TTimeStamp to keep time in UTC internally.
-  // To be done in version 1.6
-  //
-  // As a temporary workaround, we assume that all data were taken in
-  // US/Eastern time, and that the database has US/Eastern timestamps.
-  // This is certainly true for all JLab production data..
-  fgTZ = gSystem->Getenv("TZ");
-  gSystem->Setenv("TZ","US/Eastern");
-
+  Podd::BatchInterface::AddIncludePaths();
+  Podd::BatchInterface::SetTimeZone();
 
   fgAint = this;
 }
@@ -141,18 +73,8 @@ THaInterface::~THaInterface()
   // Destructor
 
   if( fgAint == this ) {
-    // Restore the user's original TZ
-    gSystem->Setenv("TZ",fgTZ.Data());
-    // Clean up the analyzer object if defined
-    delete THaAnalyzer::GetInstance();
-    // Delete all global lists and objects contained in them
-    delete gHaTextvars; gHaTextvars=nullptr;
-    //    delete gHaDB;           gHaDB = nullptr;
-    delete gHaPhysics;   gHaPhysics=nullptr;
-    delete gHaEvtHandlers;  gHaEvtHandlers=nullptr;
-    delete gHaApps;         gHaApps=nullptr;
-    delete gHaVars;         gHaVars=nullptr;
-    delete gHaCuts;         gHaCuts=nullptr;
+    Podd::BatchInterface::RestoreTimeZone();
+    Podd::BatchInterface::DeleteGlobals();
     fgAint = nullptr;
   }
 }
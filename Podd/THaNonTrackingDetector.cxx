@@ -12,6 +12,7 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "THaNonTrackingDetector.h"
+#include "MethodAccessor.h"
 #include "TClonesArray.h"
 #include "THaTrack.h"
 #include "THaTrackProj.h"
@@ -124,3 +125,6 @@ Int_t THaNonTrackingDetector::CalcTrackProj( TClonesArray& tracks )
 
 //_____________________________________________________________________________
 ClassImp(THaNonTrackingDetector)
+
+// Compiled accessors for functions used in global variable definitions
+PODD_REGISTER_METHOD(THaNonTrackingDetector, GetNTracks)
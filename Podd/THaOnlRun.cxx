@@ -20,7 +20,8 @@
 using namespace std;
 
 //______________________________________________________________________________
-THaOnlRun::THaOnlRun() : THaCodaRun(), fMode(1)
+THaOnlRun::THaOnlRun() : THaCodaRun(), fMode(1), fChunkSize(ET_CHUNK_SIZE),
+  fZeroCopy(false)
 {
   // Default constructor
 
@@ -33,7 +34,8 @@ THaOnlRun::THaOnlRun() : THaCodaRun(), fMode(1)
 
 //______________________________________________________________________________
 THaOnlRun::THaOnlRun( const char* computer, const char* session, UInt_t mode) :
-  THaCodaRun(session), fComputer(computer), fSession(session), fMode(mode)
+  THaCodaRun(session), fComputer(computer), fSession(session), fMode(mode),
+  fChunkSize(ET_CHUNK_SIZE), fZeroCopy(false)
 {
   // Normal constructor
 
@@ -48,7 +50,7 @@ THaOnlRun::THaOnlRun( const char* computer, const char* session, UInt_t mode) :
 //______________________________________________________________________________
 THaOnlRun::THaOnlRun( const THaOnlRun& rhs ) : 
   THaCodaRun(rhs), fComputer(rhs.fComputer), fSession(rhs.fSession),
-  fMode(rhs.fMode)
+  fMode(rhs.fMode), fChunkSize(rhs.fChunkSize), fZeroCopy(rhs.fZeroCopy)
 {
   // Copy constructor
 
@@ -70,6 +72,8 @@ THaOnlRun& THaOnlRun::operator=(const THaRunBase& rhs)
        fComputer = static_cast<const THaOnlRun&>(rhs).fComputer;
        fSession  = static_cast<const THaOnlRun&>(rhs).fSession;
        fMode     = static_cast<const THaOnlRun&>(rhs).fMode;
+       fChunkSize = static_cast<const THaOnlRun&>(rhs).fChunkSize;
+       fZeroCopy  = static_cast<const THaOnlRun&>(rhs).fZeroCopy;
      }
      //     delete fCodaData; //already done in THaCodaRun
      fCodaData = new Decoder::THaEtClient;
@@ -89,6 +93,9 @@ Int_t THaOnlRun::Open()
     return -2;   // must set computer and session, at least;
   } 
 
+  auto* et = static_cast<Decoder::THaEtClient*>(fCodaData);
+  et->setChunkSize(fChunkSize);
+  et->setZeroCopy(fZeroCopy);
   Int_t st = fCodaData->codaOpen(fComputer, fSession, fMode);
   st = ReturnCode(st);
   if( st == READ_OK )
@@ -109,5 +116,24 @@ Int_t THaOnlRun::OpenConnection( const char* computer, const char* session,
   return ReturnCode( Open() );
 }
 
+//______________________________________________________________________________
+void THaOnlRun::SetChunkSize( Int_t n )
+{
+  // Set the number of events to get from ET at a time. Larger chunks
+  // reduce the per-event overhead at high rates. Default: ET_CHUNK_SIZE.
+
+  if( n > 0 )
+    fChunkSize = n;
+}
+
+//______________________________________________________________________________
+void THaOnlRun::SetZeroCopy( Bool_t enable )
+{
+  // If enabled, events are decoded directly from ET memory instead of
+  // being copied first. The events are returned to ET a chunk at a time.
+
+  fZeroCopy = enable;
+}
+
 //______________________________________________________________________________
 ClassImp(THaOnlRun)
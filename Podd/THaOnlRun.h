@@ -22,12 +22,17 @@ public:
   virtual  Int_t  Open();
   virtual  Int_t  OpenConnection( const char* computer, const char* session, 
 				  UInt_t mode);
+           void   SetChunkSize( Int_t n );
+           void   SetZeroCopy( Bool_t enable = true );
   
 protected:
   TString  fComputer;   // computer where DAQ is running, e.g. 'adaql2'
   TString  fSession;    // SESSION = unique ID of DAQ, usually an env. var., 
                         // e.g 'onla'
-  UInt_t   fMode;       // mode (0=wait forever for data, 1=time out, recommend 1)
+  UInt_t   fMode;       // mode (0=wait forever for data, 1=time out, 2=poll,
+                        // recommend 1)
+  Int_t    fChunkSize;  //! Number of events to get from ET at a time
+  Bool_t   fZeroCopy;   //! Decode events directly from ET memory
 
   ClassDef(THaOnlRun,1)   //Description of an online run using ET system
 };
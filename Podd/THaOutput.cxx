@@ -23,8 +23,15 @@
 #include "Textvars.h"
 #include "THaGlobals.h"
 #include "TH1.h"
+#include "TArrayF.h"
+#include "TArrayI.h"
+#include "TArrayS.h"
+#include "TArrayC.h"
 #include "TTree.h"
+#include "TBranch.h"
 #include "TFile.h"
+#include "TSystem.h"
+#include "TDirectory.h"
 #include "TRegexp.h"
 #include "TError.h"
 #include "TString.h"
@@ -32,9 +39,16 @@
 #include "THaEpicsEvtHandler.h"
 #include "THaString.h"
 #include "FileInclude.h"
+#include "DefFileCache.h"
+#include "NTupleOutput.h"
+#include "TaskPool.h"
 
 #include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <map>
+#include <unordered_map>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <sstream>
@@ -48,18 +62,49 @@ using namespace THaString;
 using namespace Podd;
 
 Int_t THaOutput::fgVerbose = 1;
+Bool_t THaOutput::fgDirectBinding = false;
+Bool_t THaOutput::fgNativeTypes = false;
+Bool_t THaOutput::fgHistosOnly = false;
+Bool_t THaOutput::fgEpicsTreeOnly = false;
+Double_t THaOutput::fgEpicsDeadband = -1;
+UInt_t THaOutput::fgEpicsMaxSkip = 0;
+Int_t THaOutput::fgBasketSize = 0;
+Long64_t THaOutput::fgAutoFlush = 0;
+Long64_t THaOutput::fgAutoSave = 200000000;
+Long64_t THaOutput::fgOptimizeAt = 0;
+string THaOutput::fgNTupleFile;
 //FIXME: these should be member variables
 static Bool_t fgDoBench = false;
 static THaBenchmark fgBench;
 
-static const char comment('#');
+//_____________________________________________________________________________
+static char LeafCode( VarType type )
+{
+  // TTree leaf type code for basic type 'type'. Returns 0 if the type has
+  // no leaf code of the same size.
+
+  switch( type ) {
+  case kDouble: return 'D';
+  case kFloat:  return 'F';
+  case kLong:   return (sizeof(Long_t) == 8) ? 'L' : 'I';
+  case kULong:  return (sizeof(ULong_t) == 8) ? 'l' : 'i';
+  case kInt:    return 'I';
+  case kUInt:   return 'i';
+  case kShort:  return 'S';
+  case kUShort: return 's';
+  case kChar:   return 'B';
+  case kUChar:  return 'b';
+  default:      break;
+  }
+  return 0;
+}
 
 //_____________________________________________________________________________
 class THaEpicsKey {
 // Utility class used by THaOutput to store a list of
 // 'keys' to access EPICS data 'string=num' assignments
 public:
-  explicit THaEpicsKey(string nm) : fName(std::move(nm))
+  explicit THaEpicsKey(string nm) : fName(std::move(nm)), fId(kMaxUInt)
      { fAssign.clear(); }
   void AddAssign(const string& input) {
 // Add optional assignments.  The input must
@@ -67,7 +112,7 @@ public:
 // epicsvar can be a string with spaces if
 // and only if its enclosed in single spaces.
 // E.g. "Yes=1" "No=2", "'RF On'", etc
-   typedef map<string, double>::value_type valType;
+   typedef Assign_t::value_type valType;
    string sdata = findQuotes(input);
    auto pos = sdata.find('=');
    if (pos != string::npos) {
@@ -100,21 +145,23 @@ public:
   };
   Bool_t IsString() { return !fAssign.empty(); };
   Double_t Eval(const string& input) {
-    if (fAssign.empty()) return 0;
-    for( const auto& pm : fAssign ) {
-      if (input == pm.first) {
-        return pm.second;
-      }
-    }
-    return 0;  
+    auto it = fAssign.find(input);
+    return (it != fAssign.end()) ? it->second : 0;
   };
   Double_t Eval(const TString& input) {
     return Eval(string(input.Data()));
   }
   const string& GetName() { return fName; };
+  // Tag id in the EPICS handler, looked up until the tag has been seen
+  UInt_t GetId( const THaEpicsEvtHandler* h ) {
+    if( fId == kMaxUInt ) fId = h->GetTagId(fName.c_str());
+    return fId;
+  }
 private:
+  typedef unordered_map<string,Double_t> Assign_t;
   string fName;
-  map<string,Double_t> fAssign;
+  UInt_t fId;
+  Assign_t fAssign;   // String value -> number
 };
 
 //_____________________________________________________________________________
@@ -141,16 +188,22 @@ THaOdata& THaOdata::operator=(const THaOdata& rhs )
 }
 
 //_____________________________________________________________________________
-void THaOdata::AddBranches( TTree* _tree, string _name )
+void THaOdata::AddBranches( TTree* _tree, string _name, char type,
+                            Int_t bufsize )
 {
+  // Create the data and Ndata branches. 'type' is the leaf type code of
+  // the array elements. Any type other than 'D' must not be larger than
+  // Double_t, and the caller must fill 'data' with raw elements of that type.
+  // 'bufsize' is the basket size of the data branch.
+
   name = std::move(_name);
   tree = _tree;
   string sname = "Ndata." + name;
   string leaf = sname;
   tree->Branch(sname.c_str(),&ndata,(leaf+"/I").c_str());
   // FIXME: defined this way, ROOT always thinks we are variable-size
-  leaf = name + "[" + leaf + "]/D";
-  tree->Branch(name.c_str(),data,leaf.c_str());
+  leaf = name + "[" + leaf + "]/" + type;
+  tree->Branch(name.c_str(),data,leaf.c_str(),bufsize);
 }
 
 //_____________________________________________________________________________
@@ -171,8 +224,10 @@ Bool_t THaOdata::Resize(Int_t i)
 //_____________________________________________________________________________
 THaOutput::THaOutput()
   : fNvar(0), fVar(nullptr), fEpicsVar(nullptr), fTree(nullptr),
-    fEpicsTree(nullptr), fInit(false),
-    fExtra(nullptr), fEpicsHandler(nullptr),
+    fEpicsTree(nullptr), fInit(false), fNTuple(nullptr),
+    fBasketSize(0), fAutoFlush(0), fAutoSave(0), fOptimizeAt(0),
+    fEpicsDeadband(-1), fEpicsMaxSkip(0), fEpicsSkipped(0), fEpicsEvNum(0),
+    fExtra(nullptr), fWriters(nullptr), fEpicsHandler(nullptr),
     nx(0), ny(0), iscut(0), xlo(0), xhi(0), ylo(0), yhi(0),
     fOpenEpics(false), fFirstEpics(false), fIsScalar(false)
 {
@@ -191,16 +246,22 @@ THaOutput::~THaOutput()
   // destructor, at which point the trees already have been deleted.
   // FIXME: Trees would also be deleted if deleting the output file, right?
   // Can we use this here?
+  delete fWriters;
   if( TROOT::Initialized() ) {
+    CloseFriends(false);
     delete fTree;
+    for( auto& fr : fFriends )
+      delete fr.tree;
     delete fEpicsTree;
   }
+  delete fNTuple;  // closes the file
   delete [] fVar;
   delete [] fEpicsVar;
   for (auto & od : fOdata) delete od;
   for (auto & form : fFormulas) delete form;
   for (auto & cut : fCuts) delete cut;
   for (auto & histo : fHistos) delete histo;
+  for (auto & form : fHistForms) delete form;
   for (auto & ek : fEpicsKey) delete ek;
 }
 
@@ -230,10 +291,17 @@ Int_t THaOutput::Init( const char* filename )
 
   if( fgDoBench ) fgBench.Begin("Init");
 
-  fTree = new TTree("T","Hall A Analyzer Output DST");
-  fTree->SetAutoSave(200000000);
+  // In histogram-only mode, there is no output tree at all
+  if( !fgHistosOnly )
+    fTree = new TTree("T","Hall A Analyzer Output DST");
   fOpenEpics  = false;
   fFirstEpics = true;
+  fBasketSize = fgBasketSize;
+  fAutoFlush  = fgAutoFlush;
+  fAutoSave   = fgAutoSave;
+  fOptimizeAt = fgOptimizeAt;
+  fEpicsDeadband = fgEpicsDeadband;
+  fEpicsMaxSkip  = fgEpicsMaxSkip;
 
   Int_t err = LoadFile( filename );
   if( fgDoBench && err != 0 ) fgBench.Stop("Init");
@@ -246,7 +314,27 @@ Int_t THaOutput::Init( const char* filename )
     return -3;
   }
 
-  fNvar = fVarnames.size();  // this gets reassigned below
+  if( fTree ) {
+    fTree->SetAutoSave(fAutoSave);
+    if( fAutoFlush != 0 )
+      fTree->SetAutoFlush(fAutoFlush);
+  }
+  if( InitFriends() != 0 )
+    return -3;
+
+  // Without a tree, only the formulas and cuts that histograms refer to by
+  // name are needed. Tree variables are not evaluated and not marked used.
+  auto histo_uses = [this]( const string& name ) {
+    for( const auto* pVhist : fHistos ) {
+      if( CmpNoCase(name, pVhist->GetVarX()) == 0 ||
+          CmpNoCase(name, pVhist->GetVarY()) == 0 ||
+          (pVhist->HasCut() && CmpNoCase(name, pVhist->GetCutStr()) == 0) )
+        return true;
+    }
+    return false;
+  };
+
+  fNvar = fTree ? fVarnames.size() : 0;  // this gets reassigned below
   fArrayNames.clear();
   fVNames.clear();
 
@@ -267,6 +355,8 @@ Int_t THaOutput::Init( const char* filename )
   }
   UInt_t k = 0;
   for (auto inam = fFormnames.begin(); inam != fFormnames.end(); ++inam, ++k) {
+    if( !fTree && !histo_uses(*inam) )
+      continue;
     string tinfo = Form("f%d",k);
     // FIXME: avoid duplicate formulas
     auto* pform = new THaVform("formula",inam->c_str(),fFormdef[k].c_str());
@@ -280,10 +370,12 @@ Int_t THaOutput::Init( const char* filename )
       --k;
       continue;
     }
-    pform->SetOutput(fTree);
     fFormulas.push_back(pform);
     if( fgVerbose > 2 )
       pform->LongPrint();  // for debug
+    if( !fTree )
+      continue;
+    pform->SetOutput(BranchTree(*inam));
 // Add variables (i.e. those var's used by the formula) to tree.
 // Reason is that TTree::Draw() may otherwise fail with ERROR 26 
     vector<string> avar = pform->GetVars();
@@ -306,16 +398,32 @@ Int_t THaOutput::Init( const char* filename )
     }
   }
   k = 0;
-  for( auto iodat = fOdata.begin(); iodat != fOdata.end(); ++iodat, ++k )
-    (*iodat)->AddBranches(fTree, fArrayNames[k]);
+  fArrayType.clear();
+  for( auto iodat = fOdata.begin(); iodat != fOdata.end(); ++iodat, ++k ) {
+    VarType type = BranchType(gHaVars->Find(fArrayNames[k].c_str()));
+    fArrayType.push_back(type);
+    TTree* tree = BranchTree(fArrayNames[k]);
+    if( fBasketSize > 0 )
+      (*iodat)->AddBranches(tree, fArrayNames[k], LeafCode(type),
+                            fBasketSize);
+    else
+      (*iodat)->AddBranches(tree, fArrayNames[k], LeafCode(type));
+  }
   fNvar = fVNames.size();
   fVar = new Double_t[fNvar];
+  fVarType.clear();
   for (k = 0; k < fNvar; ++k) {
-    string tinfo = fVNames[k] + "/D";
-    fTree->Branch(fVNames[k].c_str(), &fVar[k], tinfo.c_str(), kNbout);
+    // Scalars of any native type fit into a Double_t slot
+    VarType type = BranchType(gHaVars->Find(fVNames[k].c_str()));
+    fVarType.push_back(type);
+    string tinfo = fVNames[k] + "/" + LeafCode(type);
+    BranchTree(fVNames[k])->Branch(fVNames[k].c_str(), &fVar[k], tinfo.c_str(),
+                                   fBasketSize > 0 ? fBasketSize : kNbout);
   }
   k = 0;
   for( auto inam = fCutnames.begin(); inam != fCutnames.end(); ++inam, ++k ) {
+    if( !fTree && !histo_uses(*inam) )
+      continue;
     // FIXME: avoid duplicate cuts
     auto* pcut = new THaVform("cut", inam->c_str(), fCutdef[k].c_str());
     Int_t status = pcut->Init();
@@ -328,11 +436,15 @@ Int_t THaOutput::Init( const char* filename )
       --k;
       continue;
     }
-    pcut->SetOutput(fTree);
+    if( fTree )
+      pcut->SetOutput(BranchTree(*inam));
     fCuts.push_back(pcut);
     if( fgVerbose>2 )
       pcut->LongPrint();  // for debug
   }
+  // Histogram axis expressions and cuts that do not refer to one of the
+  // formulas or cuts above, keyed by type and expression
+  map<string, vector<pair<THaVhist*,char>>> histexpr;
   for( auto* pVhist : fHistos ) {
 
 // After initializing formulas and cuts, must sort through
@@ -341,13 +453,16 @@ Int_t THaOutput::Init( const char* filename )
 // encode a formula) or an externally defined THaVform. 
     sfvarx = pVhist->GetVarX();
     sfvary = pVhist->GetVarY();
+    bool gotx = false, goty = false, gotcut = false;
     for( auto* pVform : fFormulas ) {
       string stemp(pVform->GetName());
       if (CmpNoCase(sfvarx,stemp) == 0) { 
 	pVhist->SetX(pVform);
+	gotx = true;
       }
       if (CmpNoCase(sfvary,stemp) == 0) { 
 	pVhist->SetY(pVform);
+	goty = true;
       }
     }
     if (pVhist->HasCut()) {
@@ -356,27 +471,64 @@ Int_t THaOutput::Init( const char* filename )
         string stemp(pcut->GetName());
         if (CmpNoCase(scut,stemp) == 0) { 
 	  pVhist->SetCut(pcut);
+	  gotcut = true;
         }
       }
+      if( !gotcut )
+        histexpr["cut:"+scut].emplace_back(pVhist, 'C');
     }
-    pVhist->Init();
+    if( !gotx && IsShareable(sfvarx) )
+      histexpr["formula:"+sfvarx].emplace_back(pVhist, 'X');
+    if( !goty && IsShareable(sfvary) )
+      histexpr["formula:"+sfvary].emplace_back(pVhist, 'Y');
   }
+  // Expressions used by more than one histogram get a single THaVform,
+  // so that they are evaluated only once per event
+  for( const auto& entry : histexpr ) {
+    const auto& users = entry.second;
+    if( users.size() < 2 )
+      continue;
+    string::size_type colon = entry.first.find(':');
+    string type = entry.first.substr(0, colon);
+    string expr = entry.first.substr(colon+1);
+    string sname = "histo_" + type + to_string(fHistForms.size());
+    auto* pform = new THaVform(type.c_str(), sname.c_str(), expr.c_str());
+    if( pform->Init() != 0 ) {
+      // Leave it to the histograms to report the error
+      delete pform;
+      continue;
+    }
+    fHistForms.push_back(pform);
+    for( const auto& user : users ) {
+      switch( user.second ) {
+      case 'X': user.first->SetX(pform); break;
+      case 'Y': user.first->SetY(pform); break;
+      default:  user.first->SetCut(pform); break;
+      }
+    }
+  }
+  for( auto* pVhist : fHistos )
+    pVhist->Init();
 
   if (!fEpicsKey.empty()) {
     vector<THaEpicsKey*>::size_type siz = fEpicsKey.size();
     fEpicsVar = new Double_t[siz+1];
+    Int_t bufsize = (fBasketSize > 0) ? fBasketSize : kNbout;
     UInt_t i = 0;
     for (auto it = fEpicsKey.begin(); it != fEpicsKey.end(); ++it, ++i) {
       fEpicsVar[i] = -1e32;
       string epicsbr = CleanEpicsName((*it)->GetName());
       string tinfo = epicsbr + "/D";
-      fTree->Branch(epicsbr.c_str(), &fEpicsVar[i], 
-        tinfo.c_str(), kNbout);
+      if( !fgEpicsTreeOnly && fTree )
+        fTree->Branch(epicsbr.c_str(), &fEpicsVar[i],
+                      tinfo.c_str(), bufsize);
       fEpicsTree->Branch(epicsbr.c_str(), &fEpicsVar[i], 
-        tinfo.c_str(), kNbout);
+        tinfo.c_str(), bufsize);
     }
     fEpicsVar[siz] = -1e32;
-    fEpicsTree->Branch("timestamp",&fEpicsVar[siz],"timestamp/D", kNbout);
+    fEpicsTree->Branch("timestamp",&fEpicsVar[siz],"timestamp/D", bufsize);
+    if( fEpicsDeadband >= 0 )
+      fEpicsTree->Branch("evnum", &fEpicsEvNum, "evnum/i", bufsize);
   }
 
   Print();
@@ -391,9 +543,107 @@ Int_t THaOutput::Init( const char* filename )
   if ( st )
     return -4;
 
+  if( InitNTuple() != 0 )
+    return -5;
+
   return 0;
 }
 
+//_____________________________________________________________________________
+Int_t THaOutput::InitNTuple()
+{
+  // If requested with SetNTupleFile, set up the columnar output. It gets
+  // the same variables, formulas, and cuts as the tree, as defined in the
+  // output definition file.
+
+  if( fgNTupleFile.empty() || fNTuple || !fTree )
+    return 0;
+
+  fNTuple = new NTupleOutput(fgNTupleFile);
+  for( const auto& name : fVNames )
+    fNTuple->AddScalar(name);
+  for( const auto& name : fArrayNames )
+    fNTuple->AddArray(name);
+  fFormIsArray.clear();
+  for( auto* forms : { &fFormulas, &fCuts } ) {
+    for( auto* form : *forms ) {
+      Bool_t is_array = (form->GetSize() > 1);
+      fFormIsArray.push_back(is_array);
+      if( is_array )
+        fNTuple->AddArray(form->GetName());
+      else
+        fNTuple->AddScalar(form->GetName());
+    }
+  }
+  if( fNTuple->Init() != 0 ) {
+    delete fNTuple; fNTuple = nullptr;
+    return -1;
+  }
+  if( fgVerbose > 0 )
+    cout << "THaOutput: writing RNTuple output to "
+         << fNTuple->GetFileName() << endl;
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t THaOutput::ReadArray( UInt_t k, Double_t* buf, Int_t nmax ) const
+{
+  // Read up to 'nmax' elements of array 'k' into 'buf', mapping kMinInt
+  // to kBig. Uses a strided view of the data if possible. Returns the
+  // number of elements read.
+
+  Int_t n = 0;
+  VarView view;
+  if( k < fArrayReader.size() && fArrayReader[k].IsValid() &&
+      fArrays[k]->GetView(view) && view.type == fArrayReader[k].GetType() ) {
+    n = min(view.len, nmax);
+    fArrayReader[k].Read(view, buf, n);
+  } else if( nmax > 0 ) {
+    n = static_cast<Int_t>(fArrays[k]->GetValues(buf, nmax));
+  }
+  for( Int_t i = 0; i < n; ++i )
+    if( buf[i] == kMinInt ) buf[i] = kBig;
+  return n;
+}
+
+//_____________________________________________________________________________
+void THaOutput::FillNTuple()
+{
+  // Copy the current values of all output quantities to the columnar
+  // output and write the entry. Values are always Double_t.
+
+  UInt_t is = 0, ia = 0;
+  for (UInt_t ivar = 0; ivar < fNvar; ivar++) {
+    const auto* pvar = fVariables[ivar];
+    Double_t x = pvar ? pvar->GetValue() : kBig;
+    if( x == kMinInt ) x = kBig;
+    fNTuple->SetScalar(is++, x);
+  }
+  for( const auto* pvar : fArrays ) {
+    auto* v = fNTuple->GetArray(ia++);
+    v->clear();
+    if( !pvar ) continue;
+    Int_t n = pvar->GetLen();
+    if( n <= 0 ) continue;
+    v->resize(n);
+    v->resize(ReadArray(ia-1, v->data(), n));
+  }
+  UInt_t k = 0;
+  for( auto* forms : { &fFormulas, &fCuts } ) {
+    for( auto* form : *forms ) {
+      if( fFormIsArray[k++] ) {
+        auto* v = fNTuple->GetArray(ia++);
+        v->clear();
+        Int_t n = form->GetSize();
+        for( Int_t i = 0; i < n; ++i )
+          v->push_back(form->GetData(i));
+      } else
+        fNTuple->SetScalar(is++, form->GetData());
+    }
+  }
+  fNTuple->Fill();
+}
+
 void THaOutput::BuildList( const vector<string>& vdata) 
 {
   // Build list of EPICS variables and
@@ -448,6 +698,7 @@ Int_t THaOutput::Attach()
   for (UInt_t ivar = 0; ivar < NVar; ivar++) {
     auto* pvar = gHaVars->Find(fVNames[ivar].c_str());
     if (pvar) {
+      pvar->SetUsed();
       if ( !pvar->IsArray() ) {
 	fVariables[ivar] = pvar;
       } else {
@@ -467,6 +718,7 @@ Int_t THaOutput::Attach()
   for (UInt_t ivar = 0; ivar < NAry; ivar++) {
     auto* pvar = gHaVars->Find(fArrayNames[ivar].c_str());
     if (pvar) {
+      pvar->SetUsed();
       if ( pvar->IsArray() ) {
 	fArrays[ivar] = pvar;
       } else {
@@ -482,6 +734,43 @@ Int_t THaOutput::Attach()
     }
   }
 
+  // Native-type branches require the variable's type to be unchanged
+  for (UInt_t ivar = 0; ivar < NVar; ivar++) {
+    const auto* pvar = fVariables[ivar];
+    if( pvar && fVarType[ivar] != kDouble &&
+        ElementType(pvar->GetType()) != fVarType[ivar] ) {
+      cout << "\tTHaOutput::Attach: ERROR: Global variable " << fVNames[ivar]
+           << " changed type!! Leaving empty space for variable" << endl;
+      fVariables[ivar] = nullptr;
+    }
+  }
+  for (UInt_t ivar = 0; ivar < NAry; ivar++) {
+    const auto* pvar = fArrays[ivar];
+    if( pvar && fArrayType[ivar] != kDouble &&
+        ElementType(pvar->GetType()) != fArrayType[ivar] ) {
+      cout << "\tTHaOutput::Attach: ERROR: Global variable " << fArrayNames[ivar]
+           << " changed type!! Leaving empty space for variable" << endl;
+      fArrays[ivar] = nullptr;
+    }
+  }
+
+  // Typed readers for the arrays, used with strided views of their data
+  fArrayReader.assign(NAry, VarReader<Double_t>());
+  for (UInt_t ivar = 0; ivar < NAry; ivar++) {
+    if( fArrays[ivar] )
+      fArrayReader[ivar].Init(fArrays[ivar]->GetType());
+  }
+
+  // Bind branches directly to the variables' data where possible
+  fVarBind.resize(NVar);
+  for (UInt_t ivar = 0; ivar < NVar; ivar++)
+    BindBranch(fVarBind[ivar], fVariables[ivar], &fVar[ivar], fVNames[ivar],
+               fVarType[ivar]);
+  fArrayBind.resize(NAry);
+  for (UInt_t ivar = 0; ivar < NAry; ivar++)
+    BindBranch(fArrayBind[ivar], fArrays[ivar], fOdata[ivar]->data,
+               fArrayNames[ivar], fArrayType[ivar]);
+
   // Reattach formulas, cuts, histos
 
   for (auto & form : fFormulas) {
@@ -490,6 +779,9 @@ Int_t THaOutput::Attach()
   for (auto & cut : fCuts) {
     cut->ReAttach();
   }
+  for (auto & form : fHistForms) {
+    form->ReAttach();
+  }
   for (auto & hist : fHistos) {
     hist->ReAttach();
   }
@@ -509,25 +801,37 @@ Int_t THaOutput::ProcEpics(THaEvData *evdata, THaEpicsEvtHandler *epicshandle)
   if( fgDoBench ) fgBench.Begin("EPICS");
   fEpicsVar[fEpicsKey.size()] = -1e32;
   for (size_t i = 0; i < fEpicsKey.size(); i++) {
-    if (epicshandle->IsLoaded(fEpicsKey[i]->GetName().c_str())) {
-      //      cout << "EPICS name "<<fEpicsKey[i]->GetName()<<"    val "<< epicshandle->GetString(fEpicsKey[i]->GetName().c_str())<<endl;
+    UInt_t id = fEpicsKey[i]->GetId(epicshandle);
+    if (id != kMaxUInt) {
       if (fEpicsKey[i]->IsString()) {
-        fEpicsVar[i] = fEpicsKey[i]->Eval(
-          epicshandle->GetString(
-             fEpicsKey[i]->GetName().c_str()));
+        fEpicsVar[i] = fEpicsKey[i]->Eval(epicshandle->GetStdString(id));
       } else {
-        fEpicsVar[i] = 
-           epicshandle->GetData(
-              fEpicsKey[i]->GetName().c_str());
+        fEpicsVar[i] = epicshandle->GetData(id);
       }
  // fill time stamp (once is ok since this is an EPICS event)
-      fEpicsVar[fEpicsKey.size()] =
- 	 epicshandle->GetTime(
-           fEpicsKey[i]->GetName().c_str());
+      fEpicsVar[fEpicsKey.size()] = epicshandle->GetTime(id);
     } else {
       fEpicsVar[i] = -1e32;  // data not yet found
     }
   }
+  // With decimation, write a row only if a value has moved by more than
+  // the deadband since the last row written, or after fEpicsMaxSkip
+  // skipped events. The values in the event tree are always updated.
+  if( fEpicsDeadband >= 0 ) {
+    const size_t n = fEpicsKey.size();
+    bool changed = fEpicsLast.empty() ||
+      (fEpicsMaxSkip > 0 && fEpicsSkipped >= fEpicsMaxSkip);
+    for( size_t i = 0; i < n && !changed; i++ )
+      changed = ( std::abs(fEpicsVar[i] - fEpicsLast[i]) > fEpicsDeadband );
+    if( !changed ) {
+      ++fEpicsSkipped;
+      if( fgDoBench ) fgBench.Stop("EPICS");
+      return 1;
+    }
+    fEpicsLast.assign(fEpicsVar, fEpicsVar + n);
+    fEpicsSkipped = 0;
+    fEpicsEvNum = evdata->GetEvNum();
+  }
   if (fEpicsTree) fEpicsTree->Fill();
   if( fgDoBench ) fgBench.Stop("EPICS");
   return 1;
@@ -539,20 +843,42 @@ Int_t THaOutput::Process()
   // Process the variables, formulas, and histograms.
   // This is called by THaAnalyzer.
 
+  // Formulas and cuts are computed at most once per event, even if used
+  // by several histograms. Those used only by histograms are computed
+  // by the histograms, and only if the histogram's cut passes.
+  THaVform::NewEvent();
+
+  if( fgHistosOnly ) {
+    if( fgDoBench ) fgBench.Begin("Histos");
+    for (auto & hist : fHistos)
+      hist->Process();
+    if( fgDoBench ) fgBench.Stop("Histos");
+    return 0;
+  }
+
   if( fgDoBench ) fgBench.Begin("Formulas");
   for (auto & form : fFormulas)
-    if (form) form->Process();
+    if (form) form->Update();
   if( fgDoBench ) fgBench.Stop("Formulas");
 
   if( fgDoBench ) fgBench.Begin("Cuts");
   for (auto & cut : fCuts)
-    if (cut) cut->Process();
+    if (cut) cut->Update();
   if( fgDoBench ) fgBench.Stop("Cuts");
 
   if( fgDoBench ) fgBench.Begin("Variables");
   for (UInt_t ivar = 0; ivar < fNvar; ivar++) {
     const auto* pvar = fVariables[ivar];
     if( pvar ) {
+      auto& bind = fVarBind[ivar];
+      if( bind.active && (bind.fixed || UpdateAddress(bind, pvar)) )
+        continue;
+      if( fVarType[ivar] != kDouble ) {
+        // Native type: copy the raw value
+        fVar[ivar] = 0;
+        pvar->GetData(&fVar[ivar]);
+        continue;
+      }
       Double_t x = pvar->GetValue();
       if( x == kMinInt ) x = kBig;
       fVar[ivar] = x;
@@ -564,22 +890,39 @@ Int_t THaOutput::Process()
     pdat->Clear();
     const auto* pvar = fArrays[k];
     if ( pvar == nullptr ) continue;
-    // Fill array in reverse order so that fOdata[k] gets resized just once
-    Int_t i = pvar->GetLen();
-    bool first = true;
-    while( i-- > 0 ) {
-      // FIXME: for better efficiency, should use pointer to data and 
-      // Fill(int n,double* data) method in case of a contiguous array
-      Double_t x = pvar->GetValue(i);
-      if( x == kMinInt ) x = kBig;
-      if (pdat->Fill(i,x) != 1) {
-	if( fgVerbose>0 && first ) {
-	  cerr << "THaOutput::ERROR: storing too much variable sized data: " 
-	       << pvar->GetName() <<"  "<<pvar->GetLen()<<endl;
-	  first = false;
-	}
+    auto& bind = fArrayBind[k];
+    if( bind.active ) {
+      // Branch reads the variable's data; only the element count is needed
+      Int_t n = pvar->GetLen();
+      if( n > 0 && (bind.fixed || UpdateAddress(bind, pvar)) )
+        pdat->ndata = n;
+      continue;
+    }
+    if( fArrayType[k] != kDouble ) {
+      // Native type: copy the raw elements in one go
+      Int_t n = pvar->GetLen();
+      if( n <= 0 )
+        continue;
+      if( n > pdat->nsize && pdat->Resize(n-1) ) {
+        if( fgVerbose>0 )
+          cerr << "THaOutput::ERROR: storing too much variable sized data: "
+               << pvar->GetName() <<"  "<<pvar->GetLen()<<endl;
+        continue;
       }
+      pdat->ndata = pvar->GetData(pdat->data) / pvar->GetTypeSize();
+      continue;
+    }
+    // Read the whole array at once into the output buffer
+    Int_t n = pvar->GetLen();
+    if( n <= 0 )
+      continue;
+    if( n > pdat->nsize && pdat->Resize(n-1) ) {
+      if( fgVerbose>0 )
+        cerr << "THaOutput::ERROR: storing too much variable sized data: "
+             << pvar->GetName() <<"  "<<n<<endl;
+      n = pdat->nsize;
     }
+    pdat->ndata = ReadArray(k, pdat->data, n);
   }
   if( fgDoBench ) fgBench.Stop("Variables");
 
@@ -589,7 +932,8 @@ Int_t THaOutput::Process()
   if( fgDoBench ) fgBench.Stop("Histos");
 
   if( fgDoBench ) fgBench.Begin("TreeFill");
-  if (fTree) fTree->Fill();
+  FillTrees();
+  if (fNTuple) FillNTuple();
   if( fgDoBench ) fgBench.Stop("TreeFill");
 
   return 0;
@@ -600,8 +944,20 @@ Int_t THaOutput::End()
 {
   if( fgDoBench ) fgBench.Begin("End");
 
-  if (fTree) fTree->Write();
-  if (fEpicsTree) fEpicsTree->Write();
+  if (fTree && !fgHistosOnly) fTree->Write();
+  for( auto& fr : fFriends ) {
+    if( fr.tree && !fr.file && !fgHistosOnly )
+      fr.tree->Write();
+  }
+  CloseFriends(!fgHistosOnly);
+  if (fEpicsTree) {
+    // Index of the decimated rows by event number. The row valid at event
+    // N is then found in O(log n) with
+    // E->GetTreeIndex()->GetEntryNumberWithBestIndex(N)
+    if( fEpicsDeadband >= 0 && fEpicsTree->GetEntries() > 0 )
+      fEpicsTree->BuildIndex("evnum");
+    fEpicsTree->Write();
+  }
   for (auto & hist : fHistos)
     hist->End();
   if( fgDoBench ) fgBench.Stop("End");
@@ -621,6 +977,43 @@ Int_t THaOutput::End()
   return 0;
 }
 
+//_____________________________________________________________________________
+Long64_t THaOutput::Checkpoint()
+{
+  // Save the current state of the output to the file, so that after a
+  // crash the file holds everything filled up to now (see
+  // THaAnalyzer::SetCheckpointFile). The trees are auto-saved and the
+  // histograms written to the current directory, replacing the copies
+  // from the previous checkpoint. Returns the number of entries in the
+  // output tree.
+
+  if( fEpicsTree )
+    fEpicsTree->AutoSave("SaveSelf FlushBaskets");
+  vector<TH1*> histos;
+  GetHistograms(histos);
+  for( auto* h : histos )
+    h->Write(nullptr, TObject::kOverwrite);
+  if( !fTree || fgHistosOnly )
+    return 0;
+  fTree->AutoSave("SaveSelf FlushBaskets");
+  for( auto& fr : fFriends ) {
+    if( fr.tree )
+      fr.tree->AutoSave("SaveSelf FlushBaskets");
+  }
+  return fTree->GetEntries();
+}
+
+//_____________________________________________________________________________
+Bool_t THaOutput::References( const char* name ) const
+{
+  // Test whether any output definition (variable, formula, cut, histogram,
+  // block) contains the text 'name', e.g. a global variable prefix like
+  // "EK_L.". This is conservative: a match does not necessarily mean that
+  // the name is actually used.
+
+  return name && *name && fDefText.find(name) != string::npos;
+}
+
 //_____________________________________________________________________________
 Int_t THaOutput::LoadFile( const char* filename ) 
 {
@@ -632,19 +1025,19 @@ Int_t THaOutput::LoadFile( const char* filename )
     ::Error( here, "invalid file name, no output definition loaded" );
     return -2;
   }
-  string loadfile(filename);
-  ifstream odef(loadfile.c_str());
-  if ( !odef ) {
-    ErrFile(-1, loadfile);
+  // Blank lines and comments are already removed by the file cache
+  DefFileCache::LinesPtr_t flines =
+    DefFileCache::Instance().Read( filename, DefFileCache::kOutputDef );
+  if ( !flines ) {
+    ErrFile(-1, filename);
     return -1;
   }
-  vector<string> strvect;
-  string sline;
+  vector<string> lines, tokens;
 
-  while (getline(odef,sline)) {
+  for( const auto& fline : *flines ) {
     // #include
-    if( sline.substr(0,kIncTag.length()) == kIncTag &&
-	sline.length() > kIncTag.length() ) {
+    if( fline.is_include ) {
+      const string& sline = fline.text;
       string incfilename;
       if( GetIncludeFileName(sline,incfilename) != 0 ) {
 	ostringstream ostr;
@@ -671,22 +1064,21 @@ Int_t THaOutput::LoadFile( const char* filename )
 	return ret;
       continue;
     }
-    // Blank line or comment line?
-    string::size_type pos = 0;
-    if( sline.empty() ||
-	(pos = sline.find_first_not_of(kWhiteSpace)) == string::npos ||
-	sline[pos] == comment )
-      continue;
-    // Get rid of trailing comments
-    if( (pos = sline.find(comment)) != string::npos )
-      sline.erase(pos);
     // Substitute text variables
-    vector<string> lines( 1, sline );
-    if( gHaTextvars->Substitute(lines) )
-      continue;
-    for( auto& str : lines ) {
+    if( fline.is_raw ) {
+      lines.assign( 1, fline.text );
+      if( gHaTextvars->Substitute(lines) )
+	continue;
+    }
+    const size_t nlines = fline.is_raw ? lines.size() : 1;
+    for( size_t i = 0; i < nlines; ++i ) {
+      const string& str = fline.is_raw ? lines[i] : fline.text;
+      fDefText += str;
+      fDefText += '\n';
       // Split the line into tokens separated by whitespace
-      strvect = Split(str);
+      if( fline.is_raw )
+	DefFileCache::Tokenize( str, DefFileCache::kOutputDef, tokens );
+      const vector<string>& strvect = fline.is_raw ? tokens : fline.tokens;
       bool special_before = (fOpenEpics);
       BuildList(strvect);
       bool special_now = (fOpenEpics);
@@ -748,6 +1140,18 @@ Int_t THaOutput::LoadFile( const char* filename )
 	  cout << "There is probably a typo error... "<<endl;
 	}
 	break;
+      case kTree:
+	if( strvect.size() < 3 || SetTreeOption(strvect[1], strvect[2]) != 0 ) {
+	  ErrFile(ikey, str);
+	  continue;
+	}
+	break;
+      case kFriend:
+	if( AddFriendDef(strvect) != 0 ) {
+	  ErrFile(ikey, str);
+	  continue;
+	}
+	break;
       case kBegin:
       case kEnd:
 	break;
@@ -774,7 +1178,7 @@ Int_t THaOutput::LoadFile( const char* filename )
 }
 
 //_____________________________________________________________________________s
-string THaOutput::svPrefix(string& histtype)
+string THaOutput::svPrefix(const string& histtype)
 {
 // If the arg is a string for a histogram type, we strip the initial 
 // "s" or "v".  If the first character is "s" we set fIsScalar true.
@@ -825,7 +1229,9 @@ Int_t THaOutput::FindKey(const string& key) const
     { "th2d",     kH2d },
     { "block",    kBlock },
     { "begin",    kBegin },
-    { "end",      kEnd }
+    { "end",      kEnd },
+    { "tree",     kTree },
+    { "friend",   kFriend }
   };
 
   for( const auto& it : keymap ) {
@@ -835,6 +1241,16 @@ Int_t THaOutput::FindKey(const string& key) const
   return -1;
 }
 
+//_____________________________________________________________________________
+Bool_t THaOutput::IsShareable( const string& expr )
+{
+  // True if histogram axis expression 'expr' may be shared between
+  // histograms. "Eye" variables ("[I]") depend on the histogram.
+
+  return !expr.empty() &&
+    expr.find("[I]") == string::npos && expr.find("[i]") == string::npos;
+}
+
 //_____________________________________________________________________________
 string THaOutput::StripBracket(const string& var) const
 {
@@ -985,6 +1401,21 @@ void THaOutput::ErrFile(Int_t iden, const string& sline) const
        cerr << "(Title in single quotes.  Variable can be a formula)"<<endl;
        cerr << "optionally can impose THaCut expression 'cut-expr'"<<endl;
        break;
+     case kTree:
+       cerr << "For output tree options, the syntax is: "<<endl;
+       cerr << "    tree  option  value"<<endl;
+       cerr << "with option = basketsize, autoflush, autosave or optimize"<<endl;
+       cerr << "Example: "<<endl;
+       cerr << "    tree  autoflush  -30000000"<<endl;
+       break;
+     case kFriend:
+       cerr << "For friend trees, the syntax is: "<<endl;
+       cerr << "    friend  tree-name  branch-pattern  [file-name]"<<endl;
+       cerr << "Example: "<<endl;
+       cerr << "    friend  TL  L.vdc.*  vdc_L.root"<<endl;
+       cerr << "(The tree name must differ from T and E, and all lines"<<endl;
+       cerr << "for the same tree must give the same file name or none)"<<endl;
+       break;
      default:
        cerr << "Illegal line: " << sline << endl;
        cerr << "See the documentation or ask Bob Michaels"<<endl;
@@ -1129,18 +1560,15 @@ Int_t THaOutput::BuildBlock(const string& blockn)
   // would save all variables from the left spectrometer.
 
 
-  TRegexp re(blockn.c_str(),true);
-  TIter next(gHaVars);
-
-  Int_t nvars=0;
-  while( TObject* obj = next() ) {
-    TString s = obj->GetName();
-    if ( s.Index(re) != kNPOS ) {
-      fVarnames.emplace_back(s.Data());
-      nvars++;
-    }
+  vector<THaVar*> vars;
+  if( gHaVars->FindMatching(blockn.c_str(), vars) < 0 )
+    return 0;
+  for( const auto* var : vars ) {
+    fVarnames.emplace_back(var->GetName());
+    fDefText += var->GetName();
+    fDefText += '\n';
   }
-  return nvars;
+  return static_cast<Int_t>(vars.size());
 }
 
 //_____________________________________________________________________________
@@ -1151,6 +1579,506 @@ void THaOutput::SetVerbosity( Int_t level )
   fgVerbose = level;
 }
 
+//_____________________________________________________________________________
+void THaOutput::SetDirectBinding( Bool_t enable )
+{
+  // Enable/disable direct binding of tree branches to the data of global
+  // variables. When enabled, variables that are stored contiguously in
+  // memory and whose type matches the branch type (Double_t, or the native
+  // type, see SetNativeTypes) are written directly from the analysis
+  // objects' data members, without copying them each event. Method-based
+  // and non-contiguous variables are always copied. Takes effect at the
+  // next Init/Attach.
+  //
+  // Note that directly bound values of exactly kMinInt are written as-is;
+  // in copy mode they are replaced by kBig.
+
+  fgDirectBinding = enable;
+}
+
+//_____________________________________________________________________________
+void THaOutput::SetEpicsTreeOnly( Bool_t enable )
+{
+  // Enable/disable writing EPICS variables only to the EPICS tree ("E"),
+  // which is filled once per EPICS event. By default, they are also
+  // written to the event tree ("T"), where their current values are
+  // repeated for every event. Takes effect at the next Init.
+
+  fgEpicsTreeOnly = enable;
+}
+
+//_____________________________________________________________________________
+void THaOutput::SetEpicsDecimation( Double_t deadband, UInt_t maxskip )
+{
+  // Write a row to the EPICS tree ("E") only when the value of any EPICS
+  // variable has changed by more than 'deadband' (absolute) since the last
+  // row written, or, if 'maxskip' > 0, when 'maxskip' EPICS events in a
+  // row have been skipped. deadband = 0 writes a row whenever any value
+  // changes. deadband < 0 (default) writes every EPICS event.
+  //
+  // With decimation, the EPICS tree gets a branch "evnum" with the event
+  // number of each row, and an index on it is saved with the tree, so that
+  // the values valid at a given event can be looked up efficiently.
+  // The EPICS values in the event tree ("T") are not affected.
+  // Takes effect at the next Init.
+
+  fgEpicsDeadband = deadband;
+  fgEpicsMaxSkip  = maxskip;
+}
+
+//_____________________________________________________________________________
+Int_t THaOutput::SetTreeOption( const string& opt, const string& val )
+{
+  // Set output tree option 'opt' from a "tree" line of the output
+  // definition file. Returns 0 if ok, -1 if the option is unknown or
+  // 'val' is not a valid number.
+
+  char* end = nullptr;
+  Long64_t n = strtoll(val.c_str(), &end, 0);
+  if( val.empty() || *end )
+    return -1;
+  if( CmpNoCase(opt, "basketsize") == 0 ) {
+    if( n < 0 || n > kMaxInt )
+      return -1;
+    fBasketSize = static_cast<Int_t>(n);
+  } else if( CmpNoCase(opt, "autoflush") == 0 )
+    fAutoFlush = n;
+  else if( CmpNoCase(opt, "autosave") == 0 )
+    fAutoSave = n;
+  else if( CmpNoCase(opt, "optimize") == 0 )
+    fOptimizeAt = n;
+  else
+    return -1;
+  return 0;
+}
+
+//_____________________________________________________________________________
+void THaOutput::SetBasketSize( Int_t bytes )
+{
+  // Set the basket size of the variable, array and EPICS branches of the
+  // output tree. 0 (default) uses 4000 bytes for scalars and 32000 bytes
+  // for arrays. Output definition file: "tree basketsize <bytes>".
+  // Takes effect at the next Init.
+
+  fgBasketSize = (bytes > 0) ? bytes : 0;
+}
+
+//_____________________________________________________________________________
+void THaOutput::SetAutoFlush( Long64_t n )
+{
+  // Set the cluster size of the output tree, i.e. how often all baskets
+  // are written out (see TTree::SetAutoFlush). n > 0: every n entries,
+  // n < 0: every -n bytes of uncompressed data, 0 (default): ROOT's
+  // default. Smaller clusters spread the cost of compressing and writing
+  // the baskets more evenly over the event loop, at the cost of a
+  // somewhat larger file. Output definition file: "tree autoflush <n>".
+  // Takes effect at the next Init.
+
+  fgAutoFlush = n;
+}
+
+//_____________________________________________________________________________
+void THaOutput::SetAutoSave( Long64_t n )
+{
+  // Set how often the tree header is saved to the file, so that a crashed
+  // analysis leaves a readable file (see TTree::SetAutoSave). Default:
+  // every 200 MB. Output definition file: "tree autosave <n>".
+  // Takes effect at the next Init.
+
+  fgAutoSave = n;
+}
+
+//_____________________________________________________________________________
+void THaOutput::SetOptimizeBaskets( Long64_t nentries )
+{
+  // Resize the baskets of the output tree according to the amount of
+  // data in each branch after 'nentries' events (see
+  // TTree::OptimizeBaskets). 0 (default): never. Output definition file:
+  // "tree optimize <nentries>". Takes effect at the next Init.
+
+  fgOptimizeAt = nentries;
+}
+
+//_____________________________________________________________________________
+Int_t THaOutput::AddFriendDef( const vector<string>& def )
+{
+  // Add a friend tree definition from a "friend" line of the output
+  // definition file: friend <tree> <pattern> [<file>]. Returns 0 if ok,
+  // -1 if the line is malformed or conflicts with an earlier one.
+
+  if( def.size() < 3 || def.size() > 4 || def[1] == "T" || def[1] == "E" )
+    return -1;
+  TRegexp re(def[2].c_str(), kTRUE);
+  if( re.Status() != TRegexp::kOK )
+    return -1;
+  string filename = (def.size() > 3) ? def[3] : string();
+  auto it = find_if(fFriends.begin(), fFriends.end(),
+                    [&def]( const FriendTree_t& fr ) {
+                      return fr.name == def[1]; });
+  if( it == fFriends.end() ) {
+    fFriends.emplace_back();
+    it = fFriends.end()-1;
+    it->name = def[1];
+    it->filename = filename;
+  } else if( !filename.empty() && filename != it->filename )
+    return -1;
+  it->patterns.push_back(def[2]);
+  return 0;
+}
+
+//_____________________________________________________________________________
+static void FillTree( TTree* tree, Long64_t optimize_at )
+{
+  tree->Fill();
+  // Resize baskets once according to the data volume of each branch
+  if( optimize_at > 0 && tree->GetEntries() == optimize_at )
+    tree->OptimizeBaskets();
+}
+
+//_____________________________________________________________________________
+Int_t THaOutput::InitFriends()
+{
+  // Create the friend trees of T defined with "friend" lines in the output
+  // definition file. A friend tree receives all variables, formulas and
+  // cuts whose names match one of its wildcard patterns (the first
+  // matching tree wins), everything else stays in T. Readers see the
+  // same branches via T's friend list, but only decompress the baskets
+  // of the trees they use.
+  //
+  // Friend trees with their own file name are written to that file (which
+  // is replaced), and filled by one thread per file, concurrently with
+  // the filling of T and the friend trees in T's file. This parallelizes
+  // the compression of the baskets, in addition to ROOT's implicit
+  // multithreading, if enabled.
+
+  fFillTasks.clear();
+  if( !fTree )
+    return 0;
+  if( !fFriends.empty() ) {
+    TDirectory* olddir = gDirectory;
+    TDirectory* maindir = fTree->GetDirectory();
+    TFile* mainfile = maindir ? maindir->GetFile() : nullptr;
+    for( auto& fr : fFriends ) {
+      if( !fr.filename.empty() ) {
+        auto it = find_if(fFriends.begin(), fFriends.end(),
+                          [&fr]( const FriendTree_t& f ) {
+                            return f.file && f.filename == fr.filename; });
+        if( it != fFriends.end() )
+          fr.file = it->file;
+        else {
+          fr.file = TFile::Open(fr.filename.c_str(), "RECREATE");
+          if( !fr.file || fr.file->IsZombie() ) {
+            ::Error( "THaOutput::Init", "Cannot create file %s for friend "
+                     "tree %s", fr.filename.c_str(), fr.name.c_str() );
+            delete fr.file; fr.file = nullptr;
+            if( olddir ) olddir->cd();
+            return -1;
+          }
+          if( mainfile )
+            fr.file->SetCompressionSettings(mainfile->GetCompressionSettings());
+          fFriendFiles.push_back(fr.file);
+        }
+      }
+      if( fr.file )
+        fr.file->cd();
+      else if( maindir )
+        maindir->cd();
+      string title = "Hall A Analyzer Output DST, " + fr.name + " branches";
+      fr.tree = new TTree(fr.name.c_str(), title.c_str());
+      fr.tree->SetAutoSave(fAutoSave);
+      if( fAutoFlush != 0 )
+        fr.tree->SetAutoFlush(fAutoFlush);
+      fTree->AddFriend(fr.tree);
+      if( fgVerbose > 0 )
+        cout << "THaOutput: friend tree " << fr.name << " in "
+             << (fr.file ? fr.filename : string("main output file")) << endl;
+    }
+    if( olddir )
+      olddir->cd();
+  }
+
+  // One task for the trees in T's file, one for each other file
+  fFillTasks.emplace_back([this]{
+    FillTree(fTree, fOptimizeAt);
+    for( auto& fr : fFriends ) {
+      if( !fr.file && fr.tree )
+        FillTree(fr.tree, fOptimizeAt);
+    }
+  });
+  for( auto* file : fFriendFiles ) {
+    fFillTasks.emplace_back([this,file]{
+      for( auto& fr : fFriends ) {
+        if( fr.file == file )
+          FillTree(fr.tree, fOptimizeAt);
+      }
+    });
+  }
+  if( !fFriendFiles.empty() && !fWriters ) {
+    ROOT::EnableThreadSafety();
+    fWriters = new TaskPool(fFriendFiles.size());
+  }
+  return 0;
+}
+
+//_____________________________________________________________________________
+TTree* THaOutput::BranchTree( const string& name ) const
+{
+  // Tree that holds the branch for output quantity 'name'
+
+  TString sname(name.c_str());
+  for( const auto& fr : fFriends ) {
+    if( !fr.tree )
+      continue;
+    for( const auto& pat : fr.patterns ) {
+      if( sname.Index(TRegexp(pat.c_str(), kTRUE)) != kNPOS )
+        return fr.tree;
+    }
+  }
+  return fTree;
+}
+
+//_____________________________________________________________________________
+void THaOutput::FillTrees()
+{
+  // Fill the output tree and its friends for the current event
+
+  if( fFillTasks.empty() ) {
+    // Not initialized from an output definition file
+    if( fTree )
+      FillTree(fTree, fOptimizeAt);
+  } else if( fWriters )
+    fWriters->Run(fFillTasks);
+  else
+    fFillTasks.front()();
+}
+
+//_____________________________________________________________________________
+void THaOutput::CloseFriends( Bool_t write )
+{
+  // Write the friend trees in their own files, if 'write' is true, and
+  // close these files. Friend trees in T's file are treated like T.
+
+  for( auto& fr : fFriends ) {
+    if( !fr.file )
+      continue;
+    if( fTree && fr.tree )
+      fTree->RemoveFriend(fr.tree);
+    if( write && fr.tree ) {
+      TDirectory* olddir = gDirectory;
+      fr.file->cd();
+      fr.tree->Write();
+      if( olddir )
+        olddir->cd();
+    }
+    fr.tree = nullptr;  // Deleted with its file
+    fr.file = nullptr;
+  }
+  for( auto* file : fFriendFiles ) {
+    file->Close();
+    delete file;
+  }
+  fFriendFiles.clear();
+  // Keep filling T and the friend trees in its file
+  if( fFillTasks.size() > 1 )
+    fFillTasks.resize(1);
+}
+
+//_____________________________________________________________________________
+void THaOutput::BindBranch( BranchBind_t& bind, const THaVar* pvar, void* buf,
+                            const string& name, VarType btype )
+{
+  // Point the branch 'name' either at the data of 'pvar', if direct binding
+  // is enabled and possible for this variable, or at our buffer 'buf'.
+  // 'btype' is the element type of the branch.
+
+  if( !bind.branch ) {
+    TTree* tree = BranchTree(name);
+    bind.branch = tree ? tree->GetBranch(name.c_str()) : nullptr;
+  }
+  bind.buf = buf;
+  bind.active = false;
+  bind.fixed = false;
+  if( fgDirectBinding && bind.branch && pvar && pvar->IsBasic() &&
+      pvar->IsContiguous() ) {
+    VarType type = pvar->GetType();
+    if( ElementType(type) == btype ) {
+      bind.active = true;
+      // Addresses of data members themselves are stable, but pointers
+      // and vectors may be reallocated by their owner
+      bind.fixed = ( type == btype );
+    }
+  }
+  const void* addr = buf;
+  if( bind.active && pvar->GetLen() > 0 ) {
+    const void* ptr = pvar->GetDataPointer();
+    if( ptr )
+      addr = ptr;
+    else
+      bind.fixed = false;
+  } else if( bind.active )
+    bind.fixed = false;
+  if( bind.branch && addr != bind.addr ) {
+    bind.branch->SetAddress(const_cast<void*>(addr));
+    bind.addr = addr;
+  }
+}
+
+//_____________________________________________________________________________
+void THaOutput::SetNativeTypes( Bool_t enable )
+{
+  // Enable/disable writing basic-type global variables with their native
+  // type (Int_t, Float_t, UShort_t etc.) instead of converting them to
+  // Double_t. Method-based variables and types without a corresponding
+  // TTree leaf type are still written as Double_t. Takes effect at the
+  // next (full) Init.
+  //
+  // Native integer values are written as-is, i.e. kMinInt is not replaced
+  // by kBig.
+
+  fgNativeTypes = enable;
+}
+
+//_____________________________________________________________________________
+void THaOutput::SetNTupleFile( const char* filename )
+{
+  // Also write all output variables, formulas, and cuts in ROOT's columnar
+  // RNTuple format to the file 'filename'. Null or empty disables it.
+  // Arrays become vector fields, and all values are written as Double_t.
+  // Field names are the variable names with '.' replaced by '_'.
+  // Takes effect at the next (full) Init. See Podd::NTupleOutput.
+
+  fgNTupleFile = filename ? filename : "";
+}
+
+//_____________________________________________________________________________
+void THaOutput::SetHistogramsOnly( Bool_t enable )
+{
+  // Enable/disable filling of histograms only, e.g. for online replay and
+  // quick calibration looks, together with event sampling. No output tree
+  // (nor friend trees or RNTuple) is created. Only the formulas and cuts
+  // referred to by histograms are created and evaluated, and variables
+  // that would only go to the tree are not marked used, so modules may
+  // skip computing them (see THaAnalyzer::EnableSkipUnusedVariables).
+  // Takes effect at the next (full) Init.
+
+  fgHistosOnly = enable;
+}
+
+//_____________________________________________________________________________
+Int_t THaOutput::WriteHistos( const char* filename ) const
+{
+  // Write the current contents of all histograms to the ROOT file
+  // 'filename', replacing it. The file is written under a temporary name
+  // and then renamed, so readers, e.g. an online display, never see a
+  // partially written file. May be called at any time during the replay.
+
+  if( !filename || !*filename )
+    return -1;
+  TString tmpname(filename);
+  tmpname += ".tmp";
+  TDirectory* olddir = gDirectory;
+  Int_t ret = 0;
+  {
+    TFile file(tmpname, "RECREATE");
+    if( file.IsZombie() ) {
+      ret = -2;
+    } else {
+      for( auto* hist : fHistos )
+        hist->End();  // Writes to the current directory
+      file.Close();
+    }
+  }
+  if( olddir )
+    olddir->cd();
+  if( ret == 0 && gSystem->Rename(tmpname, filename) != 0 )
+    ret = -3;
+  return ret;
+}
+
+//_____________________________________________________________________________
+void THaOutput::GetHistograms( vector<TH1*>& histos ) const
+{
+  // Fill 'histos' with all histograms currently booked, e.g. for live
+  // monitoring (see Podd::HistoServer). The histograms remain owned by
+  // their THaVhist. The list may grow during the first events if the
+  // sizes of histogrammed arrays change.
+
+  histos.clear();
+  for( auto* hist : fHistos ) {
+    const auto& h = hist->GetHistograms();
+    histos.insert(histos.end(), h.begin(), h.end());
+  }
+}
+
+//_____________________________________________________________________________
+static size_t HistoMemory( const TH1* h )
+{
+  // Memory of the bin contents and errors of histogram 'h' (bytes)
+
+  size_t elsize = sizeof(Double_t);
+  if( dynamic_cast<const TArrayF*>(h) )
+    elsize = sizeof(Float_t);
+  else if( dynamic_cast<const TArrayI*>(h) )
+    elsize = sizeof(Int_t);
+  else if( dynamic_cast<const TArrayS*>(h) )
+    elsize = sizeof(Short_t);
+  else if( dynamic_cast<const TArrayC*>(h) )
+    elsize = sizeof(Char_t);
+  return h->GetNcells() * elsize + h->GetSumw2N() * sizeof(Double_t);
+}
+
+//_____________________________________________________________________________
+size_t THaOutput::GetMemoryUsage() const
+{
+  // Approximate memory held by the output buffers of array variables,
+  // formulas and cuts (THaOdata) and by the histograms (bytes).
+  // The tree baskets are not included.
+
+  size_t n = 0;
+  for( const auto* odata : fOdata ) {
+    if( odata )
+      n += sizeof(THaOdata) + odata->nsize * sizeof(Double_t);
+  }
+  for( const auto* hist : fHistos ) {
+    for( const auto* h : hist->GetHistograms() ) {
+      if( h )
+        n += HistoMemory(h);
+    }
+  }
+  return n;
+}
+
+//_____________________________________________________________________________
+VarType THaOutput::BranchType( const THaVar* pvar )
+{
+  // Element type of the output branch for global variable 'pvar'
+
+  if( !fgNativeTypes || !pvar || !pvar->IsBasic() )
+    return kDouble;
+  VarType type = ElementType(pvar->GetType());
+  if( type == kVarTypeEnd || LeafCode(type) == 0 ||
+      Vars::GetTypeSize(type) > sizeof(Double_t) )
+    return kDouble;
+  return type;
+}
+
+//_____________________________________________________________________________
+Bool_t THaOutput::UpdateAddress( BranchBind_t& bind, const THaVar* pvar )
+{
+  // Re-point a directly bound branch at the current location of the data
+  // of 'pvar'. Returns false if the variable has no data, in which case
+  // the caller must fill our own buffer instead.
+
+  const void* ptr = (pvar->GetLen() > 0) ? pvar->GetDataPointer() : nullptr;
+  if( !ptr )
+    ptr = bind.buf;
+  if( ptr != bind.addr ) {
+    bind.branch->SetAddress(const_cast<void*>(ptr));
+    bind.addr = ptr;
+  }
+  return ptr != bind.buf;
+}
+
 //_____________________________________________________________________________
 //ClassImp(THaOdata)
 ClassImp(THaOutput)
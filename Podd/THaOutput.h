@@ -8,19 +8,26 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "Rtypes.h"
+#include "VarType.h"
+#include "VarView.h"
 #include <vector>
 #include <map>
 #include <string> 
 #include <cstring>
+#include <functional>
 
 class THaVar;
+class TH1;
 class TH1F;
 class TH2F;
 class THaVform;
 class THaVhist;
 class THaEvData;
 class TTree;
+class TBranch;
+class TFile;
 class THaEvtTypeHandler;
+namespace Podd { class NTupleOutput; class TaskPool; }
 
 class THaOdata {
 // Utility class used by THaOutput to store arrays 
@@ -31,7 +38,8 @@ public:
   THaOdata(const THaOdata& other);
   THaOdata& operator=(const THaOdata& rhs);
   virtual ~THaOdata() { delete [] data; };
-  void AddBranches(TTree* T, std::string name);
+  void AddBranches(TTree* T, std::string name, char type = 'D',
+                   Int_t bufsize = 32000);
   void Clear( Option_t* ="" ) { ndata = 0; }  
   Bool_t Resize(Int_t i);
   Int_t Fill(Int_t i, Double_t dat) {
@@ -56,7 +64,7 @@ public:
   std::string name;    // Name of the tree branch for the data
   Int_t       ndata;   // Number of array elements
   Int_t       nsize;   // Maximum number of elements
-  Double_t*   data;    // [ndata] Array data
+  Double_t*   data;    // [ndata] Array data (element type per branch leaf)
 
 private:
 
@@ -78,10 +86,28 @@ public:
   virtual Int_t Process();
   virtual Int_t ProcEpics(THaEvData *ev, THaEpicsEvtHandler *han);
   virtual Int_t End();
+  virtual Long64_t Checkpoint();
   virtual Bool_t TreeDefined() const { return fTree != nullptr; };
   virtual TTree* GetTree() const { return fTree; };
+  virtual Bool_t References( const char* name ) const;
+  virtual Int_t WriteHistos( const char* filename ) const;
+  void          GetHistograms( std::vector<TH1*>& histos ) const;
+  size_t        GetMemoryUsage() const;
 
   static void SetVerbosity( Int_t level );
+  static void SetDirectBinding( Bool_t enable = true );
+  static void SetNativeTypes( Bool_t enable = true );
+  static void SetNTupleFile( const char* filename );
+  static void SetHistogramsOnly( Bool_t enable = true );
+  static Bool_t IsHistogramsOnly() { return fgHistosOnly; }
+  static void SetEpicsTreeOnly( Bool_t enable = true );
+  static void SetEpicsDecimation( Double_t deadband, UInt_t maxskip = 0 );
+  // Output tree tuning, see THaOutput.cxx. Defaults for the "tree"
+  // options of the output definition file.
+  static void SetBasketSize( Int_t bytes );
+  static void SetAutoFlush( Long64_t n );
+  static void SetAutoSave( Long64_t n );
+  static void SetOptimizeBaskets( Long64_t nentries );
   
 protected:
 
@@ -92,7 +118,7 @@ protected:
   virtual Int_t ChkHistTitle(Int_t key, const std::string& sline);
   virtual Int_t BuildBlock(const std::string& blockn);
   virtual std::string StripBracket(const std::string& var) const; 
-  std::string svPrefix(std::string& histype);
+  std::string svPrefix(const std::string& histype);
   static std::vector<std::string> reQuote(const std::vector<std::string>& input);
   static std::string CleanEpicsName(const std::string& var);
   void BuildList(const std::vector<std::string>& vdata);
@@ -104,20 +130,97 @@ protected:
                            fFormnames, fFormdef,
                            fCutnames, fCutdef,
                            fArrayNames, fVNames; 
+  std::string fDefText;  // All definitions loaded (see References)
   std::vector<THaVar* >  fVariables, fArrays;
   std::vector<THaVform* > fFormulas, fCuts;
   std::vector<THaVhist* > fHistos;
+  std::vector<THaVform* > fHistForms;  // Forms shared by several histograms
   std::vector<THaOdata* > fOdata;
   std::vector<THaEpicsKey*>  fEpicsKey;
   TTree *fTree, *fEpicsTree; 
   bool fInit;
   
   enum EId {kVar = 1, kForm, kCut, kH1f, kH1d, kH2f, kH2d, kBlock,
-            kBegin, kEnd, kRate, kCount };
+            kBegin, kEnd, kRate, kCount, kTree, kFriend };
   static const Int_t kNbout = 4000;
   static const Int_t fgNocut = -1;
 
+  // Binding of a tree branch directly to the data of a global variable,
+  // avoiding the per-event copy into fVar/THaOdata
+  class BranchBind_t {
+  public:
+    BranchBind_t() : branch(nullptr), buf(nullptr), addr(nullptr),
+                     active(false), fixed(false) {}
+    TBranch*    branch;  // Branch holding the variable's data
+    void*       buf;     // Our own buffer for this branch (copy mode)
+    const void* addr;    // Address currently set on the branch
+    Bool_t      active;  // Branch is bound to the variable's data
+    Bool_t      fixed;   // Data address cannot change between events
+  };
+  std::vector<BranchBind_t> fVarBind, fArrayBind;
+  // Element types of the variable and array branches (kDouble unless
+  // native types are enabled)
+  std::vector<VarType> fVarType, fArrayType;
+  // Readers for the elements of the arrays, set up in Attach
+  std::vector<Podd::VarReader<Double_t>> fArrayReader;
+  Int_t  ReadArray( UInt_t k, Double_t* buf, Int_t nmax ) const;
+  void   BindBranch( BranchBind_t& bind, const THaVar* pvar, void* buf,
+                     const std::string& name, VarType btype );
+  static VarType BranchType( const THaVar* pvar );
+  static Bool_t UpdateAddress( BranchBind_t& bind, const THaVar* pvar );
+  static Bool_t IsShareable( const std::string& expr );
+
+  // Optional columnar (RNTuple) copy of the tree output
+  Podd::NTupleOutput* fNTuple;
+  std::vector<Bool_t> fFormIsArray;  // Formula/cut fields are arrays
+  Int_t  InitNTuple();
+  void   FillNTuple();
+
   static Int_t fgVerbose;
+  static Bool_t fgDirectBinding;
+  static std::string fgNTupleFile;
+  static Bool_t fgNativeTypes;
+  static Bool_t fgHistosOnly;
+  static Bool_t fgEpicsTreeOnly;
+  static Double_t fgEpicsDeadband;
+  static UInt_t   fgEpicsMaxSkip;
+  static Int_t    fgBasketSize;
+  static Long64_t fgAutoFlush, fgAutoSave, fgOptimizeAt;
+
+  // Output tree tuning for this instance
+  Int_t    fBasketSize;  // Basket size of all branches (0 = built-in)
+  Long64_t fAutoFlush;   // Cluster size (>0: entries, <0: bytes, 0: ROOT)
+  Long64_t fAutoSave;    // Autosave interval (>0: entries, <0: bytes)
+  Long64_t fOptimizeAt;  // Optimize basket sizes after this many entries
+  Int_t    SetTreeOption( const std::string& opt, const std::string& val );
+
+  // EPICS tree decimation (see SetEpicsDecimation)
+  Double_t fEpicsDeadband;  // Min change of any value to write a row (<0: off)
+  UInt_t   fEpicsMaxSkip;   // Write a row after this many skipped (0: never)
+  UInt_t   fEpicsSkipped;   // EPICS events skipped since last row written
+  UInt_t   fEpicsEvNum;     // Event number of last row written ("evnum")
+  std::vector<Double_t> fEpicsLast;  // Values in last row written
+
+  // Friend trees of T holding groups of branches ("friend" definitions)
+  class FriendTree_t {
+  public:
+    FriendTree_t() : tree(nullptr), file(nullptr) {}
+    std::string name;                   // Tree name
+    std::string filename;               // Own output file (empty: T's file)
+    std::vector<std::string> patterns;  // Wildcard patterns of branch names
+    TTree*      tree;                   // The tree
+    TFile*      file;                   // Own output file, if any
+  };
+  std::vector<FriendTree_t> fFriends;
+  std::vector<TFile*>       fFriendFiles;  // Files of friend trees (owned)
+  // Fill tasks for the trees, one per output file
+  std::vector<std::function<void()>> fFillTasks;
+  Podd::TaskPool* fWriters;  // Threads filling the trees of own files
+  Int_t  AddFriendDef( const std::vector<std::string>& def );
+  Int_t  InitFriends();
+  TTree* BranchTree( const std::string& name ) const;
+  void   FillTrees();
+  void   CloseFriends( Bool_t write );
   TObject*  fExtra;     // Additional member data (for binary compat.)
 
 private:
@@ -34,11 +34,13 @@
 #include "THaSpectrometer.h"
 #include "THaTrackingDetector.h"
 #include <iostream>
+#include <cmath>
+#include <limits>
 
 using namespace std;
 
 //_____________________________________________________________________________
-THaPIDinfo::THaPIDinfo() : fNdet{0}, fNpart{0}
+THaPIDinfo::THaPIDinfo() : fNdet{0}, fNpart{0}, fChanged{true}
 {
   // Default constructor
 }
@@ -46,14 +48,15 @@ THaPIDinfo::THaPIDinfo() : fNdet{0}, fNpart{0}
 //_____________________________________________________________________________
 THaPIDinfo::THaPIDinfo( UInt_t ndet, UInt_t npart ) :
   fPrior(npart), fProb(ndet*npart), fCombinedProb(npart),
-  fNdet{ndet}, fNpart{npart}
+  fNdet{ndet}, fNpart{npart}, fCovered(npart), fChanged{true}
 {
   // Normal constructor
   SetDefaultPriors();
 }
 
 //_____________________________________________________________________________
-THaPIDinfo::THaPIDinfo( const THaTrack* track ) : fNdet{0}, fNpart{0}
+THaPIDinfo::THaPIDinfo( const THaTrack* track )
+  : fNdet{0}, fNpart{0}, fChanged{true}
 {
   // Normal constructor from a track. Retrieves array dimensions from
   // the size of the detector and particle arrays of the track's spectrometer.
@@ -76,33 +79,59 @@ void THaPIDinfo::Clear( Option_t* )
 
   fProb.assign(fProb.size(), 0.0);
   fCombinedProb.assign(fCombinedProb.size(), 0.0);
+  fCovered.assign(fCovered.size(), false);
+  fChanged = true;
 }
 
 //_____________________________________________________________________________
 void THaPIDinfo::CombinePID()
 {
-  // Compute combined PID of all detectors
+  // Compute combined PID of all detectors. Does nothing if no
+  // probabilities or priors have changed since the last call.
 
-  // Likelihood products per particle hypothesis across all detectors
+  if( !fChanged )
+    return;
+  fChanged = false;
+
+  // Log-likelihood sums per particle hypothesis across all detectors.
+  // Summing logarithms rather than multiplying the probabilities avoids
+  // underflow when many detectors report small likelihoods. A particle for
+  // which no detector has a nonzero likelihood has zero probability, so
+  // the loop over the detectors can be skipped.
+  const Double_t kNoLike = -numeric_limits<Double_t>::infinity();
+  Double_t maxlog = kNoLike;
   for( UInt_t p = 0; p < fNpart; p++ ) {
-    fCombinedProb[p] = 1.0;
-    for( UInt_t d = 0; d < fNdet; d++ ) {
-      fCombinedProb[p] *= fProb[idx(d, p)];
+    if( fNdet > 0 && p < fCovered.size() && !fCovered[p] ) {
+      fCombinedProb[p] = kNoLike;
+      continue;
+    }
+    Double_t loglike = 0.0;
+    for( UInt_t d = 0; d < fNdet && loglike > kNoLike; d++ ) {
+      Double_t prob = fProb[idx(d, p)];
+      loglike = (prob > 0.0) ? loglike + log(prob) : kNoLike;
     }
+    fCombinedProb[p] = loglike;
+    if( fPrior[p] > 0.0 && loglike > maxlog )
+      maxlog = loglike;
   }
 
   // Weigh above results with the priors to get the conditional
-  // probabilities for each particle hypothesis
+  // probabilities for each particle hypothesis. The likelihoods are scaled
+  // by that of the most likely hypothesis, which cancels in the ratio.
+  if( maxlog == kNoLike ) {
+    fCombinedProb.assign(fCombinedProb.size(), 0.0);
+    return;
+  }
   Double_t sum = 0.0;
   for( UInt_t p = 0; p < fNpart; p++ ) {
-    sum += fPrior[p] * fCombinedProb[p];
+    Double_t loglike = fCombinedProb[p];
+    fCombinedProb[p] = (loglike > kNoLike && fPrior[p] > 0.0)
+      ? fPrior[p] * exp(loglike - maxlog) : 0.0;
+    sum += fCombinedProb[p];
   }
-  if( sum != 0.0 ) {
-    for( UInt_t p = 0; p < fNpart; p++ ) {
-      fCombinedProb[p] *= fPrior[p] / sum;
-    }
+  for( UInt_t p = 0; p < fNpart; p++ ) {
+    fCombinedProb[p] /= sum;
   }
-
 }
 
 //_____________________________________________________________________________
@@ -131,6 +160,7 @@ void THaPIDinfo::SetDefaultPriors()
   for( UInt_t p = 0; p < fNpart; p++ ) {
     fPrior[p] = 1.0/fNpart;
   }
+  fChanged = true;
 }
 
 //_____________________________________________________________________________
@@ -144,7 +174,9 @@ void THaPIDinfo::SetSize( UInt_t ndet, UInt_t npart )
     fPrior.clear();
     fProb.clear();
     fCombinedProb.clear();
+    fCovered.clear();
     fNdet = fNpart = 0;
+    fChanged = true;
     return;
   }
   if( ndet != fNdet || npart != fNpart )
@@ -153,12 +185,15 @@ void THaPIDinfo::SetSize( UInt_t ndet, UInt_t npart )
   if( npart != fNpart ) {
     fPrior.resize(npart);
     fCombinedProb.resize(npart);
-    if( fNpart == 0 )
-      SetDefaultPriors();
+    fCovered.resize(npart);
   }
 
+  bool new_priors = (fNpart == 0);
   fNdet  = ndet;
   fNpart = npart;
+  if( new_priors )
+    SetDefaultPriors();
+  fChanged = true;
 }
 
 //_____________________________________________________________________________
@@ -46,6 +46,10 @@ protected:
   UInt_t                fNdet;
   // Number of particles
   UInt_t                fNpart;
+  // Particles for which any detector has set a probability
+  std::vector<char>     fCovered;  //!
+  // Probabilities or priors changed since last CombinePID
+  Bool_t                fChanged;  //!
 
   UInt_t            idx( UInt_t detector, UInt_t particle ) const;
 
@@ -90,6 +94,7 @@ inline void THaPIDinfo::SetPrior( UInt_t part, Double_t prob )
   if( part >= fNpart )
     throw std::logic_error("illegal particle index");
   fPrior[part] = prob;
+  fChanged = true;
 }
 
 //_____________________________________________________________________________
@@ -98,6 +103,9 @@ inline void THaPIDinfo::SetProb( UInt_t det, UInt_t part, Double_t prob )
   if( det >= fNdet || part >= fNpart )
     throw std::logic_error("illegal detector or particle index");
   fProb[idx(det, part)] = prob;
+  if( prob != 0.0 && part < fCovered.size() )
+    fCovered[part] = true;
+  fChanged = true;
 }
 
 #endif
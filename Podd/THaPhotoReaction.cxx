@@ -108,7 +108,7 @@ Int_t THaPhotoReaction::Process( const THaEvData& )
   // This Procedure calculates the energy of the (REAL)
   // photon from the detected proton momentum 
 
-  if( !IsOK() || !gHaRun ) return -1;
+  if( !IsOK() || !GetCurrentRun() ) return -1;
 
   // Get tracking info of detected proton
   THaTrackInfo* trkifo = fSpectro->GetTrackInfo();
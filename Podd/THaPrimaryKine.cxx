@@ -13,11 +13,14 @@
 
 #include "THaPrimaryKine.h"
 #include "THaTrackingModule.h"
+#include "THaSpectrometer.h"
+#include "THaTrack.h"
 #include "THaRunBase.h"
 #include "THaRunParameters.h"
 #include "THaBeam.h"
 #include "VarDef.h"
 #include "TMath.h"
+#include "TClonesArray.h"
 
 using namespace std;
 using namespace Podd;
@@ -135,50 +138,111 @@ THaAnalysisObject::EStatus THaPrimaryKine::Init( const TDatime& run_time )
 }
 
 //_____________________________________________________________________________
-Int_t THaPrimaryKine::Process( const THaEvData& )
+Podd::FourVector THaPrimaryKine::GetBeam4Vector() const
 {
-  // Calculate electron kinematics for the Golden Track of the spectrometer
+  // Determine 4-momentum of incident particle.
+  // If a beam module given, use it to get the beam momentum. This
+  // module may apply corrections for beam energy loss, variations, etc.
 
-  if( !IsOK() || !gHaRun ) return -1;
+  if( fBeam )
+    return FourVector::FromMass(
+      ThreeVector(fBeam->GetBeamInfo()->GetPvect()), fM );
 
-  THaTrackInfo* trkifo = fSpectro->GetTrackInfo();
-  if( !trkifo || !trkifo->IsOK() ) return 1;
-
-  // Determine 4-momentum of incident particle. 
-  // If a beam module given, use it to get the beam momentum. This 
-  // module may apply corrections for beam energy loss, variations, etc.
-  if( fBeam ) {
-    fP0.SetVectM( fBeam->GetBeamInfo()->GetPvect(), fM );
-  } else {
-    // If no beam given, assume beam along z_lab
-    Double_t p_in  = gHaRun->GetParameters()->GetBeamP();
-    fP0.SetXYZM( 0.0, 0.0, p_in, fM );
-  }
+  // If no beam given, assume beam along z_lab
+  Double_t p_in  = GetCurrentRun()->GetParameters()->GetBeamP();
+  return FourVector::FromMass( ThreeVector(0.0, 0.0, p_in), fM );
+}
 
-  fP1.SetVectM( trkifo->GetPvect(), fM );
-  fA.SetXYZM( 0.0, 0.0, 0.0, fMA );         // Assume target at rest
+//_____________________________________________________________________________
+void THaPrimaryKine::CalcKine( const FourVector& p0, const FourVector& p1,
+                               const FourVector& A, Kine_t& kine )
+{
+  // Standard electron kinematics for incident particle p0, scattered
+  // particle p1 and target A. All arithmetic is inline on value types,
+  // so this can be called for any number of tracks per event.
 
   // proton mass (for x_bj)
   const Double_t Mp = 0.938;
 
-  // Standard electron kinematics
-  fQ         = fP0 - fP1;
-  fQ2        = -fQ.M2();
-  fQ3mag     = fQ.P();
-  fOmega     = fQ.E();
-  fA1        = fA + fQ;
-  fW2        = fA1.M2();
-  fScatAngle = fP0.Angle( fP1.Vect() );
-  fEpsilon   = 1.0 / ( 1.0 + 2.0*fQ3mag*fQ3mag/fQ2*
-		       TMath::Power( TMath::Tan(fScatAngle/2.0), 2.0 ));
-  fThetaQ    = fQ.Theta();
-  fPhiQ      = fQ.Phi();
-  fXbj       = fQ2/(2.0*Mp*fOmega);
+  kine.q         = p0 - p1;
+  kine.Q2        = -kine.q.M2();
+  kine.q3mag     = kine.q.P();
+  kine.omega     = kine.q.E();
+  kine.A1        = A + kine.q;
+  kine.W2        = kine.A1.M2();
+  kine.scatangle = p0.p.Angle( p1.p );
+  Double_t tan2  = TMath::Tan(kine.scatangle/2.0);
+  kine.epsilon   = 1.0 / ( 1.0 + 2.0*kine.q3mag*kine.q3mag/kine.Q2*tan2*tan2 );
+  kine.thetaq    = kine.q.Theta();
+  kine.phiq      = kine.q.Phi();
+  kine.xbj       = kine.Q2/(2.0*Mp*kine.omega);
+}
+
+//_____________________________________________________________________________
+Int_t THaPrimaryKine::Process( const THaEvData& )
+{
+  // Calculate electron kinematics for the Golden Track of the spectrometer
+
+  if( !IsOK() || !GetCurrentRun() ) return -1;
+
+  THaTrackInfo* trkifo = fSpectro->GetTrackInfo();
+  if( !trkifo || !trkifo->IsOK() ) return 1;
+
+  FourVector p0 = GetBeam4Vector();
+  FourVector p1 = FourVector::FromMass( ThreeVector(trkifo->GetPvect()), fM );
+  FourVector A( ThreeVector(), fMA );         // Assume target at rest
+
+  Kine_t kine;
+  CalcKine( p0, p1, A, kine );
+
+  fQ2        = kine.Q2;
+  fQ3mag     = kine.q3mag;
+  fOmega     = kine.omega;
+  fW2        = kine.W2;
+  fScatAngle = kine.scatangle;
+  fEpsilon   = kine.epsilon;
+  fThetaQ    = kine.thetaq;
+  fPhiQ      = kine.phiq;
+  fXbj       = kine.xbj;
+
+  // 4-vectors exposed via global variables and used by other modules
+  p0.Get(fP0);
+  p1.Get(fP1);
+  A.Get(fA);
+  kine.A1.Get(fA1);
+  kine.q.Get(fQ);
 
   fDataValid = true;
   return 0;
 }
 
+//_____________________________________________________________________________
+Int_t THaPrimaryKine::CalcAllTracks( vector<Kine_t>& kine ) const
+{
+  // Calculate the kinematics for every track of the spectrometer, not just
+  // the Golden Track, e.g. for multi-track event studies. Results are
+  // stored in 'kine' in track order. Requires the spectrometer to be a
+  // THaSpectrometer. Returns the number of tracks, or -1 on error.
+
+  kine.clear();
+  if( !IsOK() || !GetCurrentRun() ) return -1;
+  auto* spectro = dynamic_cast<THaSpectrometer*>(fSpectro);
+  if( !spectro ) return -1;
+
+  const TClonesArray* tracks = spectro->GetTracks();
+  Int_t ntracks = spectro->GetNTracks();
+  kine.resize(ntracks);
+  FourVector p0 = GetBeam4Vector();
+  FourVector A( ThreeVector(), fMA );
+  for( Int_t i = 0; i < ntracks; ++i ) {
+    auto* theTrack = static_cast<THaTrack*>(tracks->UncheckedAt(i));
+    FourVector p1 =
+      FourVector::FromMass( ThreeVector(theTrack->GetPvect()), fM );
+    CalcKine( p0, p1, A, kine[i] );
+  }
+  return ntracks;
+}
+
 //_____________________________________________________________________________
 Int_t THaPrimaryKine::ReadRunDatabase( const TDatime& date )
 {
@@ -10,6 +10,8 @@
 #include "THaPhysicsModule.h"
 #include "TLorentzVector.h"
 #include "TString.h"
+#include "FourVector.h"
+#include <vector>
 
 class THaTrackingModule;
 class THaBeamModule;
@@ -26,7 +28,18 @@ public:
 		  const char* spectro, const char* beam,
 		  Double_t target_mass = 0.0 /* GeV */ );
   virtual ~THaPrimaryKine();
-  
+
+  // Kinematics of one scattering, computed with value-type vectors
+  struct Kine_t {
+    Double_t         Q2, omega, W2, xbj, scatangle, epsilon, q3mag, thetaq, phiq;
+    Podd::FourVector q;   // Momentum transfer
+    Podd::FourVector A1;  // Recoil system
+  };
+  static  void      CalcKine( const Podd::FourVector& p0,
+                              const Podd::FourVector& p1,
+                              const Podd::FourVector& A, Kine_t& kine );
+          Int_t     CalcAllTracks( std::vector<Kine_t>& kine ) const;
+
   virtual void      Clear( Option_t* opt="" );
 
   Double_t          GetQ2()         const { return fQ2; }
@@ -77,6 +90,7 @@ protected:
 
   virtual Int_t DefineVariables( EMode mode = kDefine );
   virtual Int_t ReadRunDatabase( const TDatime& date );
+  Podd::FourVector  GetBeam4Vector() const;
 
   TString                 fSpectroName;  // Name of spectrometer to consider
   TString                 fBeamName;     // Name of beam position apparatus
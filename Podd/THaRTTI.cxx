@@ -20,11 +20,27 @@
 #include "TRealData.h"
 #include <iostream>
 #include <cassert>
+#include <string>
+#include <unordered_map>
+#include <mutex>
 
 using namespace std;
 
 static TObject* FindRealDataVar( TList* lrd, const TString& var );
 
+namespace {
+// TRealData entries of a class indexed by plain member name, i.e. without
+// pointer prefixes and array subscripts. Built once per list of real data
+// (= once per class) on first use.
+struct RealDataIndex_t {
+  RealDataIndex_t() : size(-1) {}
+  Int_t                           size;   // Size of the list when indexed
+  unordered_map<string, TObject*> byname;
+};
+mutex                                      gIndexMutex;
+unordered_map<const TList*, RealDataIndex_t> gRealDataIndex;
+}
+
 //_____________________________________________________________________________
 Int_t THaRTTI::Find( TClass* cl, const TString& var,
 		     const void* const prototype )
@@ -245,20 +261,31 @@ TObject* FindRealDataVar( TList* lrd, const TString& var )
   // stripping pointer prefixes "*" and array subscripts.
   // Return corresponding TRealData entry if found, else 0.
   // Local function used by Find().
-
-  TObjLink* lnk = lrd->FirstLink();
-  while (lnk) {
-    TObject* obj = lnk->GetObject();
-    TString name( obj->GetName() );
-    name = name.Strip( TString::kLeading, '*' );
-    Ssiz_t i = name.Index( "[" );
-    if( i != kNPOS )
-      name = name(0,i);
-    if( name == var )
-      return obj;
-    lnk = lnk->Next();
+  //
+  // The stripped names are indexed the first time a list is searched, so
+  // defining many variables of a class does not rescan its data members
+  // for each variable.
+
+  lock_guard<mutex> lock(gIndexMutex);
+  auto& index = gRealDataIndex[lrd];
+  if( index.size != lrd->GetSize() ) {
+    index.byname.clear();
+    index.size = lrd->GetSize();
+    TObjLink* lnk = lrd->FirstLink();
+    while (lnk) {
+      TObject* obj = lnk->GetObject();
+      TString name( obj->GetName() );
+      name = name.Strip( TString::kLeading, '*' );
+      Ssiz_t i = name.Index( "[" );
+      if( i != kNPOS )
+        name = name(0,i);
+      // Keep the first match, as a linear search would
+      index.byname.emplace(name.Data(), obj);
+      lnk = lnk->Next();
+    }
   }
-  return nullptr;
+  auto it = index.byname.find(var.Data());
+  return (it != index.byname.end()) ? it->second : nullptr;
 }
 
 //_____________________________________________________________________________
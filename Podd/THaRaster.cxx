@@ -225,20 +225,18 @@ Int_t THaRaster::Decode( const THaEvData& evdata )
 
 Int_t THaRaster::Process()
 {
+  // fPosition[i] = fRaw2Pos[i]*fRawPos + fPosOff[i], written out on the
+  // matrix storage (NPOS x NBPM, row-major) to avoid temporary TVectorDs
+  const Double_t* raw = fRawPos.GetMatrixArray();
   for( UInt_t i = 0; i < NPOS; i++ ) {
-
-    //      fPosition[i] = fRaw2Pos[i]*fRawPos+fPosOff[i] ;
-    //    this is how i wish it would look like,
-    //    but unluckily multiplications between tmatrix and tvector
-    //    are not defined, as well as adding a tvector and a tvector3
-    //    so i have to do it by hand instead ):
-
-    TVectorD dum(fRawPos);
-    dum *= fRaw2Pos[i];
-    fPosition[i].SetXYZ(dum(0) + fPosOff[i](0),
-                        dum(1) + fPosOff[i](1),
-                        dum(2) + fPosOff[i](2));
-
+    const Double_t* m = fRaw2Pos[i].GetMatrixArray();
+    Double_t p[NPOS];
+    for( UInt_t k = 0; k < NPOS; k++ ) {
+      p[k] = fPosOff[i](k);
+      for( UInt_t j = 0; j < NBPM; j++ )
+        p[k] += m[k*NBPM + j] * raw[j];
+    }
+    fPosition[i].SetXYZ(p[0], p[1], p[2]);
   }
 
   fDirection = fPosition[1] - fPosition[0];
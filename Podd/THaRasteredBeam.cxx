@@ -21,8 +21,10 @@ ClassImp(THaRasteredBeam)
 
 //_____________________________________________________________________________
 
-THaRasteredBeam::THaRasteredBeam( const char* name, const char* description ) :
-    THaBeam( name, description ) 
+THaRasteredBeam::THaRasteredBeam( const char* name, const char* description,
+                                  Int_t runningsum_depth ) :
+    THaBeam( name, description ),
+    fRSDirection( runningsum_depth > 1 ? runningsum_depth : 0 )
 {
   AddDetector( new THaRaster("Raster","raster",this) );
 }
@@ -48,6 +50,10 @@ Int_t THaRasteredBeam::Reconstruct()
     theBeamDet->Process();
     fPosition = theBeamDet->GetPosition();
     fDirection = theBeamDet->GetDirection();
+    if( fRSDirection.GetDepth() > 0 ) {
+      fRSDirection.Add( fDirection );
+      fRSDirection.Get( fDirection );
+    }
   }
   else {
     Error( Here("Reconstruct"), 
@@ -8,18 +8,24 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "THaBeam.h"
+#include "RunningAverage.h"
 
 class THaRasteredBeam : public THaBeam {
 
 public:
-  THaRasteredBeam( const char* name, const char* description ) ;
+  THaRasteredBeam( const char* name, const char* description,
+                   Int_t runningsum_depth = 0 ) ;
 
   virtual ~THaRasteredBeam() {}
   
   virtual Int_t Reconstruct() ;
 
-protected:
+  void ClearRunningSum() { fRSDirection.Clear(); }
 
+protected:
+  // Optional running average of the beam direction. The position follows
+  // the raster and is always taken from the current event.
+  Podd::RunningAverage fRSDirection;  //! Running average of direction
 
   ClassDef(THaRasteredBeam,0)    // A beam with rastered beam, analyzed event by event using raster currents
 };
@@ -95,20 +95,21 @@ Int_t THaReacPointFoil::Process( const THaEvData& )
   }
   static const TVector3 yax( 0.0, 1.0, 0.0 );
   static const TVector3 xax( 1.0, 0.0, 0.0 );
-  TVector3 org, v; 
+  static const TVector3 org( 0.0, 0.0, 0.0 );
+  TVector3 v;
+
+  // The vertex is the intersection of the beam with the foil plane. It
+  // depends only on the beam, so it is the same for all tracks.
+  Double_t t = 0;  // dummy
+  if( !IntersectPlaneWithRay( xax, yax, org,
+			      beam_org, beam_ray, t, v ))
+    return 0; // Oops, beam parallel to foil?
 
   for( Int_t i = 0; i<ntracks; i++ ) {
     auto* theTrack = static_cast<THaTrack*>( tracks->At(i) );
     // Ignore junk tracks
     if( !theTrack || !theTrack->HasTarget() ) 
       continue;  
-    org.SetX( 0. );
-    org.SetZ( 0. ); 
-    org.SetY( 0. );
-    Double_t t = 0;  // dummy
-    if( !IntersectPlaneWithRay( xax, yax, org,
-				beam_org, beam_ray, t, v ))
-      continue; // Oops, track and beam parallel?
     theTrack->SetVertex(v);
 
     // FIXME: preliminary
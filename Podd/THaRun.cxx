@@ -6,11 +6,22 @@
 //
 // Description of a CODA run on disk.
 //
+// The file name may also be a root:// or https:// URL, which is streamed
+// without a local copy, and/or a compressed file (see THaCodaFile).
+// Such files can only be read sequentially, and the prescan in Init()
+// reads the beginning of the file a second time.
+//
+// The segments of a split run (<name>.0, <name>.1, ...) can be analyzed
+// with separate THaRun objects, or chained in one pass, see
+// SetChainSegments().
+//
 //////////////////////////////////////////////////////////////////////////
 
 #include "THaRun.h"
 #include "THaEvData.h"
 #include "THaCodaFile.h"
+#include "CodaDecoder.h"
+#include "EventQueue.h"
 #include "THaGlobals.h"
 #include "TClass.h"
 #include "TError.h"
@@ -19,6 +30,9 @@
 #include <iostream>
 #include <cstdlib>
 #include <cassert>
+#include <algorithm>
+#include <memory>
+#include <mutex>
 
 using namespace std;
 using namespace Decoder;
@@ -26,9 +40,16 @@ using namespace Decoder;
 static const int   fgMaxScan   = 5000;
 static const char* fgThisClass = "THaRun";
 
+// Next segment of a run, opened ahead of time by the read-ahead thread
+static mutex                   fgNextSegMutex;
+static TString                 fgNextSegName;
+static unique_ptr<THaCodaFile> fgNextSegFile;
+
 //_____________________________________________________________________________
 THaRun::THaRun( const char* fname, const char* description ) :
-  THaCodaRun(description), fFilename(fname), fMaxScan(fgMaxScan), fSegment(0)
+  THaCodaRun(description), fFilename(fname), fMaxScan(fgMaxScan), fSegment(0),
+  fLastSegment(-1), fCurSegment(0), fZeroCopy(false), fReadAhead(0),
+  fFollow(false), fFollowIdle(0), fEvQueue(nullptr)
 {
   // Normal & default constructor
 
@@ -42,7 +63,9 @@ THaRun::THaRun( const char* fname, const char* description ) :
 //_____________________________________________________________________________
 THaRun::THaRun( const vector<TString>& pathList, const char* filename,
 		const char* description )
-  : THaCodaRun(description), fMaxScan(fgMaxScan), fSegment(0)
+  : THaCodaRun(description), fMaxScan(fgMaxScan), fSegment(0),
+  fLastSegment(-1), fCurSegment(0), fZeroCopy(false), fReadAhead(0),
+  fFollow(false), fFollowIdle(0), fEvQueue(nullptr)
 {
   //  cout << "Looking for file:\n";
   for(const auto & path : pathList) {
@@ -63,7 +86,11 @@ THaRun::THaRun( const vector<TString>& pathList, const char* filename,
 
 //_____________________________________________________________________________
 THaRun::THaRun( const THaRun& rhs ) :
-  THaCodaRun(rhs), fFilename(rhs.fFilename), fMaxScan(rhs.fMaxScan), fSegment(0)
+  THaCodaRun(rhs), fFilename(rhs.fFilename), fMaxScan(rhs.fMaxScan),
+  fSegment(0), fLastSegment(rhs.fLastSegment), fCurSegment(0),
+  fZeroCopy(rhs.fZeroCopy), fReadAhead(rhs.fReadAhead),
+  fFollow(rhs.fFollow), fFollowIdle(rhs.fFollowIdle),
+  fSwapRocs(rhs.fSwapRocs), fEvQueue(nullptr)
 {
   // Copy ctor
 
@@ -80,23 +107,37 @@ THaRun& THaRun::operator=(const THaRunBase& rhs)
   // than this object, then its special properties are lost.
 
   if (this != &rhs) {
+     delete fEvQueue; fEvQueue = nullptr;
      THaCodaRun::operator=(rhs);
      //     delete fCodaData; //already done in THaCodaRun
      fCodaData   = new THaCodaFile;
      if( rhs.InheritsFrom(fgThisClass) ) {
        fFilename   = static_cast<const THaRun&>(rhs).fFilename;
        fMaxScan    = static_cast<const THaRun&>(rhs).fMaxScan;
+       fZeroCopy   = static_cast<const THaRun&>(rhs).fZeroCopy;
+       fReadAhead  = static_cast<const THaRun&>(rhs).fReadAhead;
+       fFollow     = static_cast<const THaRun&>(rhs).fFollow;
+       fFollowIdle = static_cast<const THaRun&>(rhs).fFollowIdle;
+       fSwapRocs   = static_cast<const THaRun&>(rhs).fSwapRocs;
+       fLastSegment = static_cast<const THaRun&>(rhs).fLastSegment;
        FindSegmentNumber();
      } else {
        fMaxScan    = fgMaxScan;
        fSegment    = 0;
+       fLastSegment = -1;
      }
+     fCurSegment = fSegment;
   }
   return *this;
 }
 
 //_____________________________________________________________________________
-THaRun::~THaRun() = default;
+THaRun::~THaRun()
+{
+  // Destructor. Stops the read-ahead thread, if any.
+
+  delete fEvQueue;
+}
 
 //_____________________________________________________________________________
 void THaRun::Clear( Option_t* opt )
@@ -113,6 +154,15 @@ void THaRun::Clear( Option_t* opt )
     fMaxScan = fgMaxScan;
 }
 
+//_____________________________________________________________________________
+Int_t THaRun::Close()
+{
+  // Close the CODA file. Stops the read-ahead thread, if any.
+
+  delete fEvQueue; fEvQueue = nullptr;
+  return THaCodaRun::Close();
+}
+
 //_____________________________________________________________________________
 Int_t THaRun::Compare( const TObject* obj ) const
 {
@@ -144,8 +194,30 @@ Int_t THaRun::Open()
     return READ_FATAL;  // filename not set
   }
 
+  delete fEvQueue; fEvQueue = nullptr;
   fOpened = false;
-  Int_t st = fCodaData->codaOpen( fFilename );
+  fCurSegment = fSegment;
+
+  // If the read-ahead thread of the previous segment already opened this
+  // file, use it. Only do so once the run is initialized, since Init()
+  // closes the file again after prescanning.
+  THaCodaFile* next = nullptr;
+  if( fIsInit ) {
+    lock_guard<mutex> lock(fgNextSegMutex);
+    if( fgNextSegFile && fgNextSegName == fFilename ) {
+      next = fgNextSegFile.release();
+      fgNextSegName = "";
+    }
+  }
+  Int_t st = CODA_OK;
+  if( next ) {
+    delete fCodaData;
+    fCodaData = next;
+  } else {
+    static_cast<THaCodaFile*>(fCodaData)->SetZeroCopy(fZeroCopy);
+    SetupFile(static_cast<THaCodaFile*>(fCodaData), fCurSegment);
+    st = fCodaData->codaOpen( fFilename );
+  }
   if( st == CODA_OK ) {
     // Get CODA version from data; however, if a version was set by
     // explicitly by the user, use that instead
@@ -159,9 +231,52 @@ Int_t THaRun::Open()
     if( st == CODA_OK )
       fOpened = true;
   }
+  if( fOpened && fReadAhead > 0 ) {
+    fEvQueue = new Podd::EventQueue(fReadAhead);
+    Int_t qst = fEvQueue->Start( [this]( const UInt_t*& evbuf ) -> Int_t {
+      Int_t status = THaCodaRun::ReadEvent();
+      while( status == READ_EOF && NextChainedSegment() )
+        status = THaCodaRun::ReadEvent();
+      if( status == READ_OK )
+        evbuf = THaCodaRun::GetEvBuffer();
+      else if( status == READ_EOF )
+        OpenNextSegment();
+      return status;
+    });
+    if( qst != 0 ) {
+      Warning( here, "Cannot start read-ahead thread. "
+               "Reading events synchronously." );
+      delete fEvQueue; fEvQueue = nullptr;
+    }
+  }
   return ReturnCode( st );
 }
 
+//_____________________________________________________________________________
+const UInt_t* THaRun::GetEvBuffer() const
+{
+  // Return address of the buffer of the current event
+
+  if( fEvQueue )
+    return fEvQueue->GetEvBuffer();
+  return THaCodaRun::GetEvBuffer();
+}
+
+//_____________________________________________________________________________
+Int_t THaRun::ReadEvent()
+{
+  // Read one event from the CODA file, or take it from the read-ahead
+  // queue if read-ahead is enabled. At the end of a segment, continue
+  // with the next one if segment chaining is enabled.
+
+  if( fEvQueue )
+    return fEvQueue->Next();
+  Int_t status = THaCodaRun::ReadEvent();
+  while( status == READ_EOF && NextChainedSegment() )
+    status = THaCodaRun::ReadEvent();
+  return status;
+}
+
 //_____________________________________________________________________________
 void THaRun::Print( Option_t* opt ) const
 {
@@ -169,6 +284,16 @@ void THaRun::Print( Option_t* opt ) const
   cout << "Max # scan:     " << fMaxScan  << endl;
   cout << "CODA file:      " << fFilename << endl;
   cout << "Segment number: " << fSegment  << endl;
+  if( fLastSegment > fSegment ) {
+    cout << "Chain segments: up to ";
+    if( fLastSegment < kMaxInt )
+      cout << fLastSegment;
+    else
+      cout << "last";
+    cout << ", current " << fCurSegment << endl;
+  }
+  if( fReadAhead > 0 )
+    cout << "Read-ahead:     " << fReadAhead << " events" << endl;
 }
 
 //_____________________________________________________________________________
@@ -189,12 +314,20 @@ Int_t THaRun::ReadInitInfo()
       evdata->EnableScalers(false);
       evdata->EnableHelicity(false);
       evdata->SetDataVersion(GetCodaVersion());
+      // Do not wait for new data while prescanning a followed file
+      auto* file = static_cast<THaCodaFile*>(fCodaData);
+      file->SetFollow(false);
+      Int_t nsel = SelectInitEvents();
+      if( nsel == 0 )
+	status = READ_EOF;  // No prestart or prescale events in scan range
       UInt_t nev = 0;
-      while( nev<fMaxScan && !HasInfo(fDataRequired) &&
+      while( nsel != 0 && nev<fMaxScan && !HasInfo(fDataRequired) &&
 	     (status = ReadEvent()) == READ_OK ) {
 
 	// Decode events. Skip bad events.
 	nev++;
+	if( nsel > 0 )
+	  nev = static_cast<THaCodaFile*>(fCodaData)->GetEventPos() + 1;
 	status = evdata->LoadEvent( GetEvBuffer());
 	if( status != THaEvData::HED_OK ) {
 	  if( status == THaEvData::HED_ERR ||
@@ -220,6 +353,7 @@ Int_t THaRun::ReadInitInfo()
 	  break;
 	}
       }//end while
+      file->SetFollow(fFollow, fFollowIdle);
 
       if( status != READ_OK && status != READ_EOF ) {
 	Error( here, "Error %d reading CODA file %s. Check file type & "
@@ -233,6 +367,8 @@ Int_t THaRun::ReadInitInfo()
       // First look in the same directory as the continuation segment.
       // If the filename's dirname contains dataN, with N=1...9, also look in
       // all other dataN's.
+      // The read-ahead thread, if any, must not access fCodaData meanwhile.
+      delete fEvQueue; fEvQueue = nullptr;
       Ssiz_t dot = fFilename.Last('.');
       assert( dot != kNPOS );  // if fSegment>0, there must be a dot
       TString s = fFilename(0,dot);
@@ -274,6 +410,47 @@ Int_t THaRun::ReadInitInfo()
   return status;
 }
 
+//_____________________________________________________________________________
+Int_t THaRun::SelectInitEvents()
+{
+  // If the file has an event index, restrict reading to the prestart and
+  // prescale events among the first fMaxScan events, the only ones that
+  // Update() uses, so that ReadInitInfo() does not decode all the others.
+  // The index is only used if it is already built or a sidecar index file
+  // exists, since building it scans the entire file. Init() reopens the
+  // file afterwards, so normal sequential reading is unaffected.
+  // Returns the number of selected events, or -1 if the index cannot be
+  // used and the file should be scanned sequentially.
+
+  auto* file = dynamic_cast<THaCodaFile*>(fCodaData);
+  if( !file || file->IsCompressed() || file->IsRemote() ||
+      (!file->HasIndex() && !file->HasIndexFile()) )
+    return -1;
+  // The read-ahead thread, if any, must not access the file meanwhile
+  delete fEvQueue; fEvQueue = nullptr;
+  if( file->BuildIndex() != CODA_OK || file->Seek(0) != CODA_OK )
+    return -1;
+
+  bool coda3 = (GetCodaVersion() == 3);
+  UInt_t n = min(fMaxScan, file->GetNevents());
+  vector<UInt_t> positions;
+  for( UInt_t i = 0; i < n; ++i ) {
+    UInt_t type = file->GetEventTag(i);
+    if( coda3 )
+      type = CodaDecoder::Coda3EventType(type);
+    if( type == PRESTART_EVTYPE || type == PRESCALE_EVTYPE ||
+        type == TS_PRESCALE_EVTYPE )
+      positions.push_back(i);
+  }
+  if( positions.empty() )
+    return 0;
+  if( file->SelectEvents(positions) != CODA_OK ) {
+    file->Seek(0);
+    return -1;
+  }
+  return positions.size();
+}
+
 //_____________________________________________________________________________
 Int_t THaRun::SetFilename( const char* name )
 {
@@ -302,6 +479,27 @@ Int_t THaRun::SetFilename( const char* name )
   return 0;
 }
 
+//_____________________________________________________________________________
+void THaRun::SetChainSegments( Int_t last )
+{
+  // Continue reading with the following segments of a split run, up to and
+  // including segment 'last', when the end of the current segment is
+  // reached (default: all segments that exist). The run is then analyzed
+  // as a whole in one pass: the decoder, crate map and database state stay
+  // initialized across segment boundaries, and with read-ahead enabled,
+  // the next segment is opened by the read-ahead thread. Segments are
+  // expected to follow the naming convention <name>.<segment>.
+  //
+  // To analyze a split run in parallel jobs, give each job a different
+  // starting segment and a range of segments to chain, e.g. segments 0-3,
+  // 4-7, ..., and merge the outputs with mergeshards.
+  //
+  // A value less than the segment number of this run disables chaining.
+  // Takes effect the next time the run is opened.
+
+  fLastSegment = last;
+}
+
 //_____________________________________________________________________________
 void THaRun::SetNscan( UInt_t n )
 {
@@ -310,6 +508,18 @@ void THaRun::SetNscan( UInt_t n )
   fMaxScan = n;
 }
 
+//_____________________________________________________________________________
+void THaRun::SetReadAhead( UInt_t depth )
+{
+  // Read up to 'depth' events ahead in a background thread, so that file
+  // I/O overlaps with the analysis (0 = disable, the default). When the
+  // end of the file is reached, the next segment of the run, if present,
+  // is opened in the background as well, ready for the next THaRun.
+  // Takes effect the next time the run is opened.
+
+  fReadAhead = depth;
+}
+
 //_____________________________________________________________________________
 Int_t THaRun::FindSegmentNumber()
 {
@@ -323,9 +533,134 @@ Int_t THaRun::FindSegmentNumber()
     fSegment = atoi(s.Data());
   } else
     fSegment = 0;
+  fCurSegment = fSegment;
 
   return fSegment;
 }
 
+//_____________________________________________________________________________
+TString THaRun::GetSegmentFilename( Int_t segment ) const
+{
+  // Name of the file of the given segment of this run, assuming the usual
+  // naming convention <name>.<segment>. Returns an empty string if the
+  // file name does not follow this convention.
+  // Internal function.
+
+  TString name;
+  Ssiz_t dot = fFilename.Last('.');
+  if( dot == kNPOS )
+    return name;
+  TString s = fFilename(dot+1,fFilename.Length()-dot-1);
+  if( s.IsNull() || !s.IsDigit() )
+    return name;
+  name = fFilename(0,dot+1);
+  name += segment;
+  return name;
+}
+
+//_____________________________________________________________________________
+void THaRun::SetFollow( Bool_t enable, Double_t idle )
+{
+  // Follow the run file while the DAQ is still writing it: at the end of
+  // the file, wait for more data instead of stopping, like "tail -f"
+  // (see THaCodaFile::SetFollow). Reading ends once the next segment of
+  // the run appears, or after the file has not grown for 'idle' seconds
+  // (0 = never; stop the analysis by other means, e.g. Ctrl-C). While
+  // waiting, ReadEvent() returns READ_EMPTY about once per second, so
+  // that the analyzer can flush its output (see
+  // THaAnalyzer::SetFlushInterval). Combine with SetChainSegments() to
+  // follow a split run across segments. Takes effect at the next Open().
+
+  fFollow = enable;
+  fFollowIdle = idle;
+}
+
+//_____________________________________________________________________________
+void THaRun::SetSwapRocs( const std::vector<UInt_t>& rocs )
+{
+  // For input files in foreign byte order, byte-swap the ROC banks of
+  // physics events only for these ROCs (see THaCodaFile::SetSwapRocs).
+  // Set by the analyzer with demand decoding. Applies to the current
+  // file, if open, and to all segments opened later.
+
+  fSwapRocs = rocs;
+  if( fCodaData )
+    static_cast<THaCodaFile*>(fCodaData)->SetSwapRocs(fSwapRocs);
+}
+
+//_____________________________________________________________________________
+void THaRun::SetupFile( THaCodaFile* file, Int_t segment ) const
+{
+  // Configure follow mode and byte swapping of 'file', which holds
+  // 'segment' of this run. Internal function.
+
+  file->SetSwapRocs(fSwapRocs);
+  file->SetFollow(fFollow, fFollowIdle);
+  file->SetFollowEnd( fFollow ? GetSegmentFilename(segment+1).Data() : "" );
+}
+
+//_____________________________________________________________________________
+Bool_t THaRun::NextChainedSegment()
+{
+  // Switch to the next segment of the run if segment chaining is enabled
+  // and the next segment exists. Uses the file pre-opened by the read-ahead
+  // thread, if available. Returns true if the next segment is now open.
+  // Called at the end of the current segment, either from ReadEvent()
+  // or from the read-ahead thread.
+  // Internal function.
+
+  if( fCurSegment >= fLastSegment )
+    return false;
+  TString name = GetSegmentFilename(fCurSegment+1);
+  if( name.IsNull() )
+    return false;
+  unique_ptr<THaCodaFile> file;
+  {
+    lock_guard<mutex> lock(fgNextSegMutex);
+    if( fgNextSegFile && fgNextSegName == name ) {
+      file = std::move(fgNextSegFile);
+      fgNextSegName = "";
+    }
+  }
+  if( !file ) {
+    if( gSystem->AccessPathName(name, kReadPermission) )
+      return false;
+    file.reset(new THaCodaFile);
+    file->SetZeroCopy(fZeroCopy);
+    SetupFile(file.get(), fCurSegment+1);
+    if( file->codaOpen(name) != CODA_OK ) {
+      Warning( "NextChainedSegment", "Cannot open segment %s. "
+               "Stopping at end of segment %d.", name.Data(), fCurSegment );
+      return false;
+    }
+  }
+  fCodaData->codaClose();
+  delete fCodaData;
+  fCodaData = file.release();
+  ++fCurSegment;
+  return true;
+}
+
+//_____________________________________________________________________________
+void THaRun::OpenNextSegment() const
+{
+  // Open the segment following this one, if it exists, so that it is
+  // ready when the THaRun for that segment is opened. Called from the
+  // read-ahead thread when the current segment reaches end of file.
+  // Internal function.
+
+  TString name = GetSegmentFilename(fCurSegment+1);
+  if( name.IsNull() || gSystem->AccessPathName(name, kReadPermission) )
+    return;
+  unique_ptr<THaCodaFile> file{new THaCodaFile};
+  file->SetZeroCopy(fZeroCopy);
+  SetupFile(file.get(), fCurSegment+1);
+  if( file->codaOpen(name) != CODA_OK )
+    return;
+  lock_guard<mutex> lock(fgNextSegMutex);
+  fgNextSegName = name;
+  fgNextSegFile = std::move(file);
+}
+
 //_____________________________________________________________________________
 ClassImp(THaRun)
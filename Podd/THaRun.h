@@ -11,6 +11,13 @@
 #include "TString.h"
 #include <vector>
 
+namespace Podd {
+  class EventQueue;
+}
+namespace Decoder {
+  class THaCodaFile;
+}
+
 class THaRun : public THaCodaRun {
 
 public:
@@ -22,24 +29,49 @@ public:
   virtual ~THaRun();
 
   virtual void         Clear( Option_t* opt="" );
+  virtual Int_t        Close();
   virtual Int_t        Compare( const TObject* obj ) const;
+  virtual const UInt_t* GetEvBuffer() const;
           const char*  GetFilename() const { return fFilename.Data(); }
+          Int_t        GetCurrentSegment() const { return fCurSegment; }
+          Int_t        GetLastSegment() const { return fLastSegment; }
+          UInt_t       GetReadAhead() const { return fReadAhead; }
+          Bool_t       IsFollow()     const { return fFollow; }
           Int_t        GetSegment()  const { return fSegment; }
   virtual Int_t        Open();
   virtual void         Print( Option_t* opt="" ) const;
+  virtual Int_t        ReadEvent();
   virtual Int_t        SetFilename( const char* name );
+          void         SetChainSegments( Int_t last = kMaxInt );
+          void         SetFollow( Bool_t enable = true, Double_t idle = 0 );
+          void         SetSwapRocs( const std::vector<UInt_t>& rocs );
           void         SetNscan( UInt_t n );
+          void         SetReadAhead( UInt_t depth );
+          void         SetZeroCopy( Bool_t enable = true ) { fZeroCopy = enable; }
 
 protected:
 
   TString       fFilename;     //  File name
   UInt_t        fMaxScan;      //  Max. no. of events to prescan (0=don't scan)
   Int_t         fSegment;      //  Segment number (for split runs)
+  Int_t         fLastSegment;  //  Last segment to chain (-1=this one only)
+  Int_t         fCurSegment;   //  Segment currently/last read
+  Bool_t        fZeroCopy;     //! Read events directly from mapped file
+  UInt_t        fReadAhead;    //! Number of events to read ahead (0=off)
+  Bool_t        fFollow;       //! Wait for data appended to the file
+  Double_t      fFollowIdle;   //! Follow: end after no growth for (s)
+  std::vector<UInt_t> fSwapRocs; //! ROCs to byte-swap (empty: all)
+  Podd::EventQueue* fEvQueue;  //! Read-ahead queue
 
-          Int_t FindSegmentNumber();
+          Int_t   FindSegmentNumber();
+          TString GetSegmentFilename( Int_t segment ) const;
+          Bool_t  NextChainedSegment();
+          void    OpenNextSegment() const;
+          void    SetupFile( Decoder::THaCodaFile* file, Int_t segment ) const;
   virtual Int_t ReadInitInfo();
+          Int_t   SelectInitEvents();
 
-  ClassDef(THaRun,6)           // A run based on a CODA data file on disk
+  ClassDef(THaRun,7)           // A run based on a CODA data file on disk
 };
 
 
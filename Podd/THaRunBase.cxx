@@ -13,7 +13,9 @@
 #include "THaEvData.h"
 #include "TClass.h"
 #include "TError.h"
+#include "TCollection.h"
 #include <iostream>
+#include <algorithm>
 
 using namespace std;
 
@@ -241,6 +243,37 @@ Int_t THaRunBase::Compare( const TObject* obj ) const
   return 0;
 }
 
+//_____________________________________________________________________________
+Long64_t THaRunBase::Merge( TCollection* list )
+{
+  // Merge run objects in 'list' into this one. Used by hadd/TFileMerger
+  // when combining output files of several analyses of parts (shards) of
+  // the same run. The event range becomes the union of all ranges, and the
+  // numbers of analyzed events are summed. The other run information is
+  // kept from this object.
+  // Returns the total number of analyzed events, or -1 on error.
+
+  if( !list )
+    return -1;
+  TIter next(list);
+  while( TObject* obj = next() ) {
+    auto* run = dynamic_cast<THaRunBase*>(obj);
+    if( !run ) {
+      Error( "Merge", "Cannot merge object %s of class %s into run object",
+             obj->GetName(), obj->ClassName() );
+      return -1;
+    }
+    if( run->fNumber != fNumber ) {
+      Warning( "Merge", "Merging data of different runs, %u and %u. "
+               "Keeping run number %u.", fNumber, run->fNumber, fNumber );
+    }
+    fEvtRange[0] = std::min(fEvtRange[0], run->fEvtRange[0]);
+    fEvtRange[1] = std::max(fEvtRange[1], run->fEvtRange[1]);
+    fNumAnalyzed += run->fNumAnalyzed;
+  }
+  return fNumAnalyzed;
+}
+
 //_____________________________________________________________________________
 Bool_t THaRunBase::HasInfo( UInt_t bits ) const
 {
@@ -13,6 +13,7 @@
 
 class THaRunParameters;
 class THaEvData;
+class TCollection;
 
 class THaRunBase : public TNamed {
   
@@ -30,7 +31,8 @@ public:
   virtual bool operator>=( const THaRunBase& ) const;
 
   // Return codes for Init/Open/ReadEvent/Close
-  enum { READ_OK = 0, READ_EOF = EOF, READ_ERROR = 32, READ_FATAL = 64 };
+  enum { READ_OK = 0, READ_EOF = EOF, READ_EMPTY = 16, READ_ERROR = 32,
+         READ_FATAL = 64 };
 
   // Main functions
   virtual const UInt_t* GetEvBuffer() const = 0;
@@ -59,6 +61,7 @@ public:
   virtual Bool_t       HasInfoRead( UInt_t bits ) const;
           Bool_t       IsInit()         const { return fIsInit; }
   virtual Bool_t       IsOpen()         const;
+  virtual Long64_t     Merge( TCollection* list );
   virtual void         Print( Option_t* opt="" ) const;
   virtual void         SetDate( const TDatime& date );
           void         SetDate( UInt_t tloc );
@@ -49,7 +49,7 @@ Int_t THaSAProtonEP::Process( const THaEvData& )
   // Calculate the electron kinematics for elastic eX -> eX using the 
   // 4-vector from the outgoing X.
 
-  if( !IsOK() || !gHaRun ) return -1;
+  if( !IsOK() || !GetCurrentRun() ) return -1;
 
   THaTrackInfo* trkifo = fSpectro->GetTrackInfo();
   if( !trkifo || !trkifo->IsOK() ) return 1;
@@ -59,7 +59,7 @@ Int_t THaSAProtonEP::Process( const THaEvData& )
   if( fBeam ) {
     fP0.SetVectM( fBeam->GetBeamInfo()->GetPvect(), fM );
   } else {
-    Double_t p_in  = gHaRun->GetParameters()->GetBeamP();
+    Double_t p_in  = GetCurrentRun()->GetParameters()->GetBeamP();
     fP0.SetXYZM( 0.0, 0.0, p_in, fM );
   }
 
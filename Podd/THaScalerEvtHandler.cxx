@@ -28,6 +28,11 @@
 //     lscaler->SetDebugFile("LeftScaler.txt");
 //     gHaEvtHandlers->Add (lscaler);
 //
+//   For high-frequency scaler readout, the "TS" tree can be turned off
+//   with SetAccumulateOnly(); the global variables are still updated.
+//   SetSingleBranch() stores all variables in one branch of the tree.
+//   SetDecimation() fills the tree only when the values change.
+//
 /////////////////////////////////////////////////////////////////////
 
 #include "THaEvtTypeHandler.h"
@@ -42,19 +47,25 @@
 #include <cstdlib>
 #include <iostream>
 #include <string>
+#include <algorithm>
 #include "THaVarList.h"
 #include "VarDef.h"
 #include "THaString.h"
 #include "TTree.h"
+#include "TMath.h"
 
 using namespace std;
 using namespace Decoder;
 using namespace THaString;
 
+#define ALL(c) (c).begin(), (c).end()
+
 THaScalerEvtHandler::THaScalerEvtHandler(const char *name,
     const char* description)
   : THaEvtTypeHandler(name,description), evcount(0), fNormIdx(-1),
-    fNormSlot(-1), dvars(nullptr), fScalerTree(nullptr)
+    fNormSlot(-1), dvars(nullptr), fScalerTree(nullptr),
+    fAccumulateOnly(false), fSingleBranch(false), fDeadband(-1),
+    fMaxSkip(0), fNskipped(0), fEvNum(0)
 {
 }
 
@@ -65,10 +76,50 @@ THaScalerEvtHandler::~THaScalerEvtHandler()
 
 Int_t THaScalerEvtHandler::End( THaRunBase* )
 {
-  if (fScalerTree) fScalerTree->Write();
+  if (fScalerTree) {
+    // With decimation, index the rows by event number, so that the row
+    // valid at event N can be found in O(log n) with
+    // GetTreeIndex()->GetEntryNumberWithBestIndex(N)
+    if (fDeadband >= 0 && fScalerTree->GetEntries() > 0)
+      fScalerTree->BuildIndex("evnum");
+    fScalerTree->Write();
+  }
   return 0;
 }
 
+void THaScalerEvtHandler::SetDecimation( Double_t deadband, UInt_t maxskip )
+{
+  // Fill the "TS" tree only if any scaler variable has changed by more
+  // than 'deadband' (absolute) since the last fill, or, if 'maxskip' > 0,
+  // after 'maxskip' scaler events in a row were skipped. deadband = 0
+  // fills whenever any value changes; deadband < 0 (default) fills for
+  // every scaler event. The global variables are always updated.
+  // With decimation, the tree gets a branch "evnum" with the event number
+  // of each row, which is indexed at the end of the run.
+
+  fDeadband = deadband;
+  fMaxSkip = maxskip;
+}
+
+Bool_t THaScalerEvtHandler::ValuesChanged()
+{
+  // Decide whether to fill the tree for the current scaler event when
+  // decimating (see SetDecimation). Updates the decimation state.
+
+  size_t n = scalerloc.size();
+  bool changed = fLastFilled.empty() ||
+    (fMaxSkip > 0 && fNskipped >= fMaxSkip);
+  for( size_t i = 0; i < n && !changed; i++ )
+    changed = ( TMath::Abs(dvars[i] - fLastFilled[i]) > fDeadband );
+  if( !changed ) {
+    ++fNskipped;
+    return false;
+  }
+  fLastFilled.assign(dvars, dvars + n);
+  fNskipped = 0;
+  return true;
+}
+
 Int_t THaScalerEvtHandler::Analyze(THaEvData *evdata)
 {
   if ( !IsMyEvent(evdata->GetEvType()) ) return -1;
@@ -79,31 +130,8 @@ Int_t THaScalerEvtHandler::Analyze(THaEvData *evdata)
     EvDump(evdata);
   }
 
-  if (!fScalerTree) {
-
-    TString sname1 = "TS";
-    TString sname2 = sname1 + fName;
-    TString sname3 = fName + "  Scaler Data";
-
-    if (fDebugFile) {
-      *fDebugFile << "\nAnalyze 1st time for fName = "<<fName<<endl;
-      *fDebugFile << sname2 << "      " <<sname3<<endl;
-    }
-
-    fScalerTree = new TTree(sname2.Data(),sname3.Data());
-    fScalerTree->SetAutoSave(200000000);
-
-    TString name = "evcount";
-    TString tinfo = name + "/D";
-    fScalerTree->Branch(name.Data(), &evcount, tinfo.Data(), 4000);
-
-    for( size_t i = 0; i < scalerloc.size(); i++) {
-      name = scalerloc[i]->name;
-      tinfo = name + "/D";
-      fScalerTree->Branch(name.Data(), &dvars[i], tinfo.Data(), 4000);
-    }
-
-  }  // if (!fScalerTree)
+  if (!fScalerTree && !fAccumulateOnly)
+    MakeTree();
 
 
   // Parse the data, load local data arrays.
@@ -119,15 +147,34 @@ Int_t THaScalerEvtHandler::Analyze(THaEvData *evdata)
     << "Debugging event type " << dec << evdata->GetEvType() << endl << endl;
 
   const UInt_t *p = evdata->GetRawDataBuffer();
-  const UInt_t *pstop = p+ndata;
+  const UInt_t *pstart = p, *pstop = p+ndata;
   Bool_t ifound = false;
 
   while (p < pstop) {
     if (fDebugFile) {
       *fDebugFile << "p  and  pstop  "<<p<<"   "<<pstop<<"   "<<hex<<*p<<"   "<<dec<<endl;
     }
+    // Offer the word to the scalers whose header pattern matches it, found
+    // via the lookup table, and to scalers without a header pattern.
+    // The first word (the event length) goes to all scalers, as
+    // GenScaler::Decode computes rates from its second call onwards.
+    fCand.clear();
+    if( p == pstart ) {
+      for( UInt_t j = 0; j < scalers.size(); j++ )
+        fCand.push_back(j);
+    } else {
+      for( UInt_t im = 0; im < fMasks.size(); ++im ) {
+        ULong64_t key = (ULong64_t(im) << 32) + (*p & fMasks[im]);
+        auto it = fHeaders.find(key);
+        if( it != fHeaders.end() )
+          fCand.insert(fCand.end(), ALL(it->second));
+      }
+      fCand.insert(fCand.end(), ALL(fUntabled));
+      if( fCand.size() > 1 )
+        sort(ALL(fCand));
+    }
     Int_t nskip = 1;
-    for (size_t j=0; j<scalers.size(); j++) {
+    for( auto j : fCand ) {
       nskip = scalers[j]->Decode(p);
       if (fDebugFile && nskip > 1) {
 	*fDebugFile << "\n===== Scaler # "<<j<<"     fName = "<<fName<<"   nskip = "<<nskip<<endl;
@@ -161,8 +208,12 @@ Int_t THaScalerEvtHandler::Analyze(THaEvData *evdata)
     UInt_t ichan = scalerloc[i]->ichan;
     if (fDebugFile) *fDebugFile << "Debug dvars "<<i<<"  "<<idx<<"  "<<ichan<<endl;
     if( idx < scalers.size() && ichan < MAXCHAN ) {
-      if (scalerloc[i]->ikind == ICOUNT) dvars[i] = scalers[idx]->GetData(ichan);
-      if (scalerloc[i]->ikind == IRATE)  dvars[i] = scalers[idx]->GetRate(ichan);
+      // Read the scaler's arrays directly, skipping the per-channel accessors
+      const Decoder::GenScaler* s = scalers[idx];
+      if (scalerloc[i]->ikind == ICOUNT)
+        dvars[i] = (ichan < s->GetCounts().size()) ? s->GetCounts()[ichan] : 0;
+      if (scalerloc[i]->ikind == IRATE)
+        dvars[i] = (ichan < s->GetRates().size()) ? s->GetRates()[ichan] : 0;
       if (fDebugFile) *fDebugFile << "   dvars  "<<scalerloc[i]->ikind<<"  "<<dvars[i]<<endl;
     } else {
       cout << "THaScalerEvtHandler:: ERROR:: incorrect index "<<i<<"  "<<idx<<"  "<<ichan<<endl;
@@ -176,8 +227,12 @@ Int_t THaScalerEvtHandler::Analyze(THaEvData *evdata)
 
   if (fDebugFile) *fDebugFile << "scaler tree ptr  "<<fScalerTree<<endl;
 
-  if (fScalerTree)
-    fScalerTree->Fill();
+  if (fScalerTree && !fAccumulateOnly) {
+    if (fDeadband < 0 || ValuesChanged()) {
+      fEvNum = evdata->GetEvNum();
+      fScalerTree->Fill();
+    }
+  }
 
   return 1;
 }
@@ -360,6 +415,8 @@ THaAnalysisObject::EStatus THaScalerEvtHandler::Init(const TDatime& date)
     }
   }
 
+  MakeHeaderTable();
+
 
   if(fDebugFile) {
     *fDebugFile << "THaScalerEvtHandler:: Name of scaler bank "<<fName<<endl;
@@ -374,6 +431,73 @@ THaAnalysisObject::EStatus THaScalerEvtHandler::Init(const TDatime& date)
   return kOK;
 }
 
+void THaScalerEvtHandler::MakeHeaderTable()
+{
+  // Build the lookup table from header patterns to scalers[] indices
+  // (see Decoder::Module::GetHeaderPattern). Scalers sharing a pattern
+  // are tried in index order, as are scalers without a pattern.
+
+  fMasks.clear();
+  fHeaders.clear();
+  fUntabled.clear();
+  for( UInt_t i = 0; i < scalers.size(); i++ ) {
+    UInt_t header = 0, mask = 0;
+    if( !scalers[i]->GetHeaderPattern(header, mask) ) {
+      fUntabled.push_back(i);
+      continue;
+    }
+    auto im = find(ALL(fMasks), mask);
+    if( im == fMasks.end() )
+      im = fMasks.insert(im, mask);
+    ULong64_t key = (ULong64_t(im - fMasks.begin()) << 32) + header;
+    fHeaders[key].push_back(i);
+  }
+  fCand.reserve(scalers.size());
+}
+
+void THaScalerEvtHandler::MakeTree()
+{
+  // Create the "TS" tree. Its variables point to dvars, which is filled
+  // for each scaler event.
+
+  TString sname1 = "TS";
+  TString sname2 = sname1 + fName;
+  TString sname3 = fName + "  Scaler Data";
+
+  if (fDebugFile) {
+    *fDebugFile << "\nAnalyze 1st time for fName = "<<fName<<endl;
+    *fDebugFile << sname2 << "      " <<sname3<<endl;
+  }
+
+  fScalerTree = new TTree(sname2.Data(),sname3.Data());
+  fScalerTree->SetAutoSave(200000000);
+
+  TString name = "evcount";
+  TString tinfo = name + "/D";
+  fScalerTree->Branch(name.Data(), &evcount, tinfo.Data(), 4000);
+  if (fDeadband >= 0)
+    fScalerTree->Branch("evnum", &fEvNum, "evnum/i", 4000);
+
+  if( scalerloc.empty() )
+    return;
+  if( fSingleBranch ) {
+    // dvars is contiguous, so all variables fit into one leaf list
+    TString leaflist;
+    for( const auto* loc : scalerloc ) {
+      if( !leaflist.IsNull() )
+        leaflist += ":";
+      leaflist += loc->name + "/D";
+    }
+    fScalerTree->Branch("data", dvars, leaflist.Data(), 32000);
+  } else {
+    for( size_t i = 0; i < scalerloc.size(); i++) {
+      name = scalerloc[i]->name;
+      tinfo = name + "/D";
+      fScalerTree->Branch(name.Data(), &dvars[i], tinfo.Data(), 4000);
+    }
+  }
+}
+
 void THaScalerEvtHandler::AddVars( const TString& name, const TString& desc,
                                    UInt_t iscal, UInt_t ichan, UInt_t ikind)
 {
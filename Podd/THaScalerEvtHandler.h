@@ -13,6 +13,7 @@
 #include "Decoder.h"
 #include "TString.h"
 #include <vector>
+#include <unordered_map>
 
 class TTree;
 
@@ -46,12 +47,28 @@ public:
    virtual EStatus Init( const TDatime& run_time);
    virtual Int_t End( THaRunBase* r=nullptr );
 
+   // Update the global variables only, without filling the "TS" tree.
+   // For high-frequency scaler readout.
+   void   SetAccumulateOnly( Bool_t b = true ) { fAccumulateOnly = b; }
+   Bool_t IsAccumulateOnly() const { return fAccumulateOnly; }
+   // Store the scaler variables in a single branch "data", one leaf per
+   // variable, instead of one branch per variable. Must be set before the
+   // first event is analyzed.
+   void   SetSingleBranch( Bool_t b = true ) { fSingleBranch = b; }
+   Bool_t IsSingleBranch() const { return fSingleBranch; }
+   // Fill the "TS" tree only when a variable has changed by more than
+   // 'deadband', or after 'maxskip' skipped scaler events (see .cxx).
+   // Must be set before the first event is analyzed.
+   void   SetDecimation( Double_t deadband, UInt_t maxskip = 0 );
+
 
 protected:
 
    void AddVars( const TString& name, const TString& desc, UInt_t iscal,
                  UInt_t ichan, UInt_t ikind );
    void DefVars();
+   void MakeHeaderTable();
+   void MakeTree();
 
    std::vector<Decoder::GenScaler*> scalers;
    std::vector<ScalerLoc*> scalerloc;
@@ -59,6 +76,22 @@ protected:
    UInt_t fNormIdx, fNormSlot;
    Double_t *dvars;
    TTree *fScalerTree;
+   Bool_t fAccumulateOnly, fSingleBranch;
+
+   // Tree decimation
+   Double_t fDeadband;     // Min change of any variable to fill (<0: off)
+   UInt_t   fMaxSkip;      // Fill after this many skipped events (0: never)
+   UInt_t   fNskipped;     // Scaler events skipped since last fill
+   UInt_t   fEvNum;        // Event number of last fill ("evnum")
+   std::vector<Double_t> fLastFilled;  // Values at last fill
+   Bool_t   ValuesChanged();
+
+   // Header lookup table, built from the scalers' header patterns at Init
+   std::vector<UInt_t> fMasks;     // Distinct header masks
+   // (mask index << 32) + header -> indices into scalers
+   std::unordered_map<ULong64_t,std::vector<UInt_t>> fHeaders;
+   std::vector<UInt_t> fUntabled;  // Scalers without header pattern
+   std::vector<UInt_t> fCand;      // Candidate scalers for current word
 
    ClassDef(THaScalerEvtHandler,0)  // Scaler Event handler
 
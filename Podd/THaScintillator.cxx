@@ -8,6 +8,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "THaScintillator.h"
+#include "MethodAccessor.h"
 #include "THaEvData.h"
 #include "THaDetMap.h"
 #include "THaTrackProj.h"
@@ -23,6 +24,7 @@
 #include <cstdlib>
 #include <algorithm>
 #include <memory>
+#include <cmath>
 
 #define ALL(c) (c).begin(), (c).end()
 
@@ -39,7 +41,8 @@ using namespace Podd;
 THaScintillator::THaScintillator( const char* name, const char* description,
 				  THaApparatus* apparatus )
   : THaNonTrackingDetector(name,description,apparatus), fCn(0),
-    fAttenuation(0), fResolution(0), fRightPMTs(nullptr), fLeftPMTs(nullptr)
+    fAttenuation(0), fResolution(0), fRightPMTs(nullptr), fLeftPMTs(nullptr),
+    fHasTimeWalk(false), fNeedADCPos(true)
 {
   // Constructor
 
@@ -49,7 +52,8 @@ THaScintillator::THaScintillator( const char* name, const char* description,
 //_____________________________________________________________________________
 THaScintillator::THaScintillator()
   : THaNonTrackingDetector(), fCn(0), fAttenuation(0), fResolution(0),
-    fRightPMTs(nullptr), fLeftPMTs(nullptr)
+    fRightPMTs(nullptr), fLeftPMTs(nullptr), fHasTimeWalk(false),
+    fNeedADCPos(true)
 {
   // Default constructor (for ROOT RTTI)
 
@@ -178,7 +182,9 @@ Int_t THaScintillator::ReadDatabase( const TDatime& date )
     fDetectorData.emplace_back(std::move(detdata));
   }
   fPadData.resize(nval);
+  fPadHit.assign(nval, -1);
   fHits.reserve(nval);
+  fHitPads.reserve(nval);
 
   // Read calibration parameters
 
@@ -231,7 +237,7 @@ Int_t THaScintillator::ReadDatabase( const TDatime& date )
     calibL.off   = loff[i];
     calibL.ped   = lped[i];
     calibL.gain  = lgain[i];
-    calibR.mip   = adcmip;
+    calibL.mip   = adcmip;
     if( !twalk.empty() ) {
       calibR.twalk = twalk[i];
       calibL.twalk = twalk[nval+i];
@@ -239,6 +245,28 @@ Int_t THaScintillator::ReadDatabase( const TDatime& date )
       calibR.twalk = calibL.twalk = 0;
     }
   }
+
+  // Tabulate the timewalk parameters for ApplyCorrections
+  fHasTimeWalk = false;
+  for( int i = kRight; i <= kLeft; ++i ) {
+    const PMTData* pmtData = (i == kRight) ? fRightPMTs : fLeftPMTs;
+    auto& tw = fTWalk[i];
+    tw.par.assign(nval, 0);
+    tw.rsqmip.assign(nval, 0);
+    for( UInt_t k = 0; k < nval; ++k ) {
+      const auto& calib = pmtData->GetCalib(k);
+      if( calib.mip > 0 && calib.twalk != 0 ) {
+        tw.par[k] = calib.twalk;
+        tw.rsqmip[k] = 1./TMath::Sqrt(calib.mip);
+        fHasTimeWalk = true;
+      }
+    }
+  }
+  fTWPad.reserve(nval);
+  fTWAdc.reserve(nval);
+  fTWPar.reserve(nval);
+  fTWRef.reserve(nval);
+  fTWCorr.reserve(nval);
   if( fResolution == kBig )
     fResolution = 3.*tdc2t; // guess at timing resolution
 
@@ -337,10 +365,17 @@ void THaScintillator::Clear( Option_t* opt )
 {
   // Reset per-event data.
 
+  // Only paddles with right-side PMT data can have paddle data. Do this
+  // before the PMT hit lists are cleared.
+  if( fRightPMTs ) {
+    for( auto pad : fRightPMTs->GetHitList() )
+      fPadData[pad].clear();
+  }
   THaNonTrackingDetector::Clear(opt);
-  fHitIdx.clear();
-  for_each(ALL(fPadData), []( HitData_t& d ) { d.clear(); });
+  for( const auto& h : fHits )
+    fPadHit[h.pad] = -1;
   fHits.clear();
+  fHitPads.clear();
 }
 
 //_____________________________________________________________________________
@@ -357,11 +392,10 @@ Int_t THaScintillator::StoreHit( const DigitizerHitInfo_t& hitinfo, UInt_t data
 
   Int_t pad = hitinfo.lchan % fNelem;
   auto side = static_cast<ESide>(GetView(hitinfo));
+  assert( pad < fNelem );
 
-  // Make a note that this side/pad registered some kind of data
-  fHitIdx.emplace(side, pad);
-
-  // Store data for either left or right PMTs, as determined by 'side'
+  // Store data for either left or right PMTs, as determined by 'side'.
+  // The PMT data keep track of the channels with data.
   Podd::PMTData* pmtData = (side == kRight) ? fRightPMTs : fLeftPMTs;
   if( !pmtData->HitDone() )
     pmtData->StoreHit(hitinfo, data);
@@ -418,14 +452,33 @@ Int_t THaScintillator::ApplyCorrections()
   //
   // Currently only TDC timewalk corrections are applied, and those only if
   // the database parameters "MIP" and "timewalk_params" are set.
+  //
+  // The corrections for all fired PMTs of a side are calculated in one
+  // batch with TimeWalkCorrections, which gives the same results as
+  // TimeWalkCorrection for each PMT.
+
+  if( !fHasTimeWalk )
+    return 0;
 
-  for( const auto& idx : fHitIdx ) {
-    ESide side = idx.first;
-    Int_t pad = idx.second;
-    auto& PMT = (side == kRight) ? fRightPMTs->GetPMT(pad)
-                                 : fLeftPMTs->GetPMT(pad);
-    if( PMT.nadc > 0 && PMT.ntdc > 0 )
-      PMT.tdc_c -= TimeWalkCorrection(idx, PMT.adc_p);
+  for( auto side : { kRight, kLeft } ) {
+    Podd::PMTData* pmtData = (side == kRight) ? fRightPMTs : fLeftPMTs;
+    const auto& tw = fTWalk[side];
+    fTWPad.clear(); fTWAdc.clear(); fTWPar.clear(); fTWRef.clear();
+    for( auto pad : pmtData->GetHitList() ) {
+      const auto& PMT = pmtData->GetPMT(pad);
+      if( PMT.nadc > 0 && PMT.ntdc > 0 && tw.par[pad] != 0 ) {
+        fTWPad.push_back(pad);
+        fTWAdc.push_back(PMT.adc_p);
+        fTWPar.push_back(tw.par[pad]);
+        fTWRef.push_back(tw.rsqmip[pad]);
+      }
+    }
+    auto n = static_cast<UInt_t>(fTWPad.size());
+    fTWCorr.resize(n);
+    TimeWalkCorrections(n, fTWAdc.data(), fTWPar.data(), fTWRef.data(),
+                        fTWCorr.data());
+    for( UInt_t i = 0; i < n; ++i )
+      pmtData->GetPMT(fTWPad[i]).tdc_c -= fTWCorr[i];
   }
 
   return 0;
@@ -456,6 +509,27 @@ Data_t THaScintillator::TimeWalkCorrection( Idx_t idx, Data_t adc )
   return corr;
 }
 
+//_____________________________________________________________________________
+void THaScintillator::TimeWalkCorrections( UInt_t n, const Data_t* adc,
+                                           const Data_t* par,
+                                           const Data_t* rsqmip, Data_t* corr )
+{
+  // Calculate TDC timewalk corrections for 'n' PMTs at once, using the
+  // same formula as TimeWalkCorrection. The loop has no branches and can
+  // be vectorized by the compiler.
+  //
+  // adc:    ADC values above pedestal (adc_p)
+  // par:    timewalk coefficients
+  // rsqmip: 1/sqrt(MIP)
+  // corr:   output, timewalk corrections
+
+  for( UInt_t i = 0; i < n; ++i ) {
+    Data_t a = adc[i] > 0 ? adc[i] : 1;
+    Data_t c = par[i] * ( 1./std::sqrt(a) - rsqmip[i] );
+    corr[i] = adc[i] > 0 ? c : 0;
+  }
+}
+
 //_____________________________________________________________________________
 Int_t THaScintillator::FindPaddleHits()
 {
@@ -464,35 +538,31 @@ Int_t THaScintillator::FindPaddleHits()
   static const Double_t sqrt2 = TMath::Sqrt(2.);
 
   fHits.clear();
-  for( const auto& idx : fHitIdx ) {
-    const ESide side = idx.first;
-    if( side == kLeft )
-      // std::pair is sorted by first, then second, so from this point on only
-      // kLeft elements will follow, the matching ones of which we've already
-      // paired up. So, no more work to do :)
-      break;
-    assert(side == kRight);
-    const Int_t pad = idx.second;
-    if( fHitIdx.find(make_pair(kLeft, pad)) != fHitIdx.end()) {
-      // There are data from both PMTs of this paddle
-      const auto &RPMT = fRightPMTs->GetPMT(pad), &LPMT = fLeftPMTs->GetPMT(pad);
-
-      // Calculate mean time and rough transverse (y) position
-      if( RPMT.ntdc > 0 && LPMT.ntdc > 0 ) {
-        Data_t time = 0.5 * (RPMT.tdc_c + LPMT.tdc_c) - fSize[1] / fCn;
-        Data_t dtime = fResolution / sqrt2;
-        Data_t yt = 0.5 * fCn * (RPMT.tdc_c - LPMT.tdc_c);
-
-        // Record a hit on this paddle
-        fHits.emplace_back(pad, time, dtime, yt, kBig, kBig);
-        // Also save the hit data in the per-paddle array
-        fPadData[pad] = fHits.back();
-      }
+  fHitPads.clear();
+  // Paddles with data on both sides must be in the right hit list. PMTs
+  // without data have ntdc = 0.
+  for( auto pad : fRightPMTs->GetHitList() ) {
+    const auto &RPMT = fRightPMTs->GetPMT(pad), &LPMT = fLeftPMTs->GetPMT(pad);
+
+    // Calculate mean time and rough transverse (y) position
+    if( RPMT.ntdc > 0 && LPMT.ntdc > 0 ) {
+      Data_t time = 0.5 * (RPMT.tdc_c + LPMT.tdc_c) - fSize[1] / fCn;
+      Data_t dtime = fResolution / sqrt2;
+      Data_t yt = 0.5 * fCn * (RPMT.tdc_c - LPMT.tdc_c);
+
+      // Record a hit on this paddle
+      fHits.emplace_back(pad, time, dtime, yt, kBig, kBig);
+      // Also save the hit data in the per-paddle array
+      fPadData[pad] = fHits.back();
+      fHitPads.push_back(pad);
     }
   }
 
-  // Sort hits by mean time, earliest first
+  // Sort hits by mean time, earliest first, and paddle numbers for lookup
   std::sort( ALL(fHits) );
+  std::sort( ALL(fHitPads) );
+  for( Int_t i = 0; i < GetNHits(); ++i )
+    fPadHit[fHits[i].pad] = i;
 
   return 0;
 }
@@ -505,13 +575,9 @@ Int_t THaScintillator::CoarseProcess( TClonesArray& tracks )
   // - Calculate rough transverse position and energy deposition from ADC data
   // - Calculate rough track crossing points
 
-  for( const auto& idx : fHitIdx ) {
-    const ESide side = idx.first;
-    if( side == kLeft )
-      break;
-    assert(side == kRight);
-    const Int_t pad = idx.second;
-    if( fHitIdx.find(make_pair(kLeft, pad)) != fHitIdx.end()) {
+  // Skipped if no one reads the results (see UpdateVariableUsage)
+  if( fNeedADCPos ) {
+    for( auto pad : fRightPMTs->GetHitList() ) {
       const auto &RPMT = fRightPMTs->GetPMT(pad), &LPMT = fLeftPMTs->GetPMT(pad);
 
       // rough calculation of position from ADC reading
@@ -525,11 +591,10 @@ Int_t THaScintillator::CoarseProcess( TClonesArray& tracks )
 
         // Save these ADC-derived values to the entry in the hit array as well
         // (may not exist if TDCs didn't fire on both sides)
-        auto theHit = find_if(ALL(fHits),
-          [pad]( const HitData_t& h ) { return h.pad == pad; });
-        if( theHit != fHits.end() ) {
-          theHit->yt = thePad.yt;
-          theHit->ampl = thePad.ampl;
+        Int_t ihit = fPadHit[pad];
+        if( ihit >= 0 ) {
+          fHits[ihit].ya = thePad.ya;
+          fHits[ihit].ampl = thePad.ampl;
         }
       }
     }
@@ -541,6 +606,15 @@ Int_t THaScintillator::CoarseProcess( TClonesArray& tracks )
   return 0;
 }
 
+//_____________________________________________________________________________
+void THaScintillator::UpdateVariableUsage()
+{
+  // The ADC-derived position and dE/dx are only calculated if read
+
+  fNeedADCPos = IsVariableUsed("y_adc") || IsVariableUsed("dedx") ||
+    IsVariableUsed("hit.y_adc") || IsVariableUsed("hit.dedx");
+}
+
 //_____________________________________________________________________________
 Int_t THaScintillator::FineProcess( TClonesArray& tracks )
 {
@@ -570,10 +644,23 @@ Int_t THaScintillator::FineProcess( TClonesArray& tracks )
       Int_t pad = -1;                      // paddle number of closest hit
       Double_t xc = proj->GetX();          // track intercept x-coordinate
       Double_t dx = kBig;                  // xc - distance paddle center
-      for( const auto& h : fHits ) {
-        Double_t dx2 = xc - (padx0 + h.pad * dpadx);
-        if( TMath::Abs(dx2) < TMath::Abs(dx)) {
-          pad = h.pad;
+      // The paddles are equally spaced, so the closest hit paddle is one of
+      // the two hit paddles adjacent to the (fractional) paddle number of
+      // the track crossing point. If equally close, take the earlier hit.
+      Double_t xpad = (xc - padx0) / dpadx;
+      auto it = lower_bound(ALL(fHitPads), xpad,
+        []( Int_t p, Double_t x ) { return p < x; });
+      auto jt = it;
+      if( jt != fHitPads.begin() )
+        --jt;
+      for( auto kt : { jt, it } ) {
+        if( kt == fHitPads.end() )
+          continue;
+        Double_t dx2 = xc - (padx0 + *kt * dpadx);
+        if( TMath::Abs(dx2) < TMath::Abs(dx) ||
+            (pad >= 0 && TMath::Abs(dx2) == TMath::Abs(dx) &&
+             fPadHit[*kt] < fPadHit[pad]) ) {
+          pad = *kt;
           dx = dx2;
         }
       }
@@ -590,3 +677,6 @@ Int_t THaScintillator::FineProcess( TClonesArray& tracks )
 
 //_____________________________________________________________________________
 ClassImp(THaScintillator)
+
+// Compiled accessors for functions used in global variable definitions
+PODD_REGISTER_METHOD(THaScintillator, GetNHits)
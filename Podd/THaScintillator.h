@@ -10,7 +10,6 @@
 #include "THaNonTrackingDetector.h"
 #include "DetectorData.h"
 #include <vector>
-#include <set>
 
 class TClonesArray;
 
@@ -46,6 +45,7 @@ public:
   virtual Int_t     Decode( const THaEvData& );
   virtual Int_t     CoarseProcess( TClonesArray& tracks );
   virtual Int_t     FineProcess( TClonesArray& tracks );
+  virtual void      UpdateVariableUsage();
 
   Int_t             GetNHits() const  { return static_cast<Int_t>(fHits.size()); }
   const HitData_t&  GetHit( Int_t i ) { return fHits[i]; }
@@ -61,22 +61,43 @@ protected:
   // Per-event data
   Podd::PMTData*         fRightPMTs;      // Raw PMT data (right side)
   Podd::PMTData*         fLeftPMTs;       // Raw PMT data (left side)
-  std::set<Idx_t>        fHitIdx;         // Indices of PMTs with data
   std::vector<HitData_t> fHits;           // Calculated hit data, per hit
   // fPadData duplicates the info in fHits for direct access via paddle number
   std::vector<HitData_t> fPadData;        // Calculated hit data, per paddle
+  std::vector<Int_t>     fPadHit;         //! Index into fHits per paddle (-1=none)
+  std::vector<Int_t>     fHitPads;        //! Paddles with hits, sorted
+
+  // Timewalk correction parameters per side (kRight, kLeft), copied from
+  // the PMT calibrations for batch processing
+  class TimeWalkPar_t {
+  public:
+    std::vector<Data_t> par;     // Timewalk coefficients (0 = no correction)
+    std::vector<Data_t> rsqmip;  // 1/sqrt(MIP)
+  };
+  TimeWalkPar_t          fTWalk[2];       //! Timewalk parameters
+  Bool_t                 fHasTimeWalk;    //! Any timewalk corrections defined
+  Bool_t                 fNeedADCPos;     //! Calculate ADC position & dE/dx
+  // Work arrays for batch timewalk corrections
+  std::vector<Int_t>     fTWPad;          //! Paddle numbers
+  std::vector<Data_t>    fTWAdc;          //! ADC amplitudes above pedestal
+  std::vector<Data_t>    fTWPar;          //! Timewalk coefficients
+  std::vector<Data_t>    fTWRef;          //! 1/sqrt(MIP)
+  std::vector<Data_t>    fTWCorr;         //! Calculated corrections
 
   virtual Int_t  StoreHit( const DigitizerHitInfo_t& hitinfo, UInt_t data );
   virtual void   PrintDecodedData( const THaEvData& evdata ) const;
 
   virtual Int_t  ApplyCorrections();
   virtual Data_t TimeWalkCorrection( Idx_t idx, Data_t adc );
+  static  void   TimeWalkCorrections( UInt_t n, const Data_t* adc,
+                                      const Data_t* par, const Data_t* rsqmip,
+                                      Data_t* corr );
   virtual Int_t  FindPaddleHits();
 
   virtual Int_t  ReadDatabase( const TDatime& date );
   virtual Int_t  DefineVariables( EMode mode = kDefine );
 
-  ClassDef(THaScintillator,1)   // Generic scintillator class
+  ClassDef(THaScintillator,2)   // Generic scintillator class
 };
 
 ////////////////////////////////////////////////////////////////////////////////
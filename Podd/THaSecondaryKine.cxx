@@ -21,11 +21,11 @@
 #include "THaSecondaryKine.h"
 #include "THaPrimaryKine.h"
 #include "THaTrackingModule.h"
+#include "THaSpectrometer.h"
+#include "THaTrack.h"
 #include "VarDef.h"
-#include "TLorentzVector.h"
-#include "TVector3.h"
 #include "TMath.h"
-#include "TRotation.h"
+#include "TClonesArray.h"
 
 using namespace std;
 using namespace Podd;
@@ -141,135 +141,200 @@ THaAnalysisObject::EStatus THaSecondaryKine::Init( const TDatime& run_time )
 }
 
 //_____________________________________________________________________________
-Int_t THaSecondaryKine::Process( const THaEvData& )
+void THaSecondaryKine::CalcKine( const FourVector& X, const FourVector& A,
+                                 const FourVector& A1, const FourVector& q,
+                                 const FourVector& p1, Double_t omega,
+                                 Double_t MX, Kine_t& kine )
 {
-  // Calculate the kinematics.
-
-  if( !IsOK() ) return -1;
-
-  // Tracking information from the secondary spectrometer
-  THaTrackInfo* trkifo = fSpectro->GetTrackInfo();
-  if( !trkifo || !trkifo->IsOK() ) return 1;
+  // Calculate the kinematics of secondary particle X (mass MX) given the
+  // 4-momenta of the primary interaction: initial target A, final target
+  // A1, momentum transfer q, final electron p1, and energy transfer omega.
+  // All arithmetic is inline on value types, so this can be called for
+  // any number of tracks per event.
 
-  // Require valid input data
-  if( !fPrimary->DataValid() ) return 2;
-
-  // Measured momentum of secondary particle X in lab
-  const TVector3& pX3 = trkifo->GetPvect();
-  // 4-momentum of X
-  fX.SetVectM( pX3, fMX );
-
-  // 4-momenta of the the primary interaction
-  const TLorentzVector* pA  = fPrimary->GetA();  // Initial target
-  const TLorentzVector* pA1 = fPrimary->GetA1(); // Final target
-  const TLorentzVector* pQ  = fPrimary->GetQ();  // Momentum xfer
-  const TLorentzVector* pP1 = fPrimary->GetP1(); // Final electron
-  Double_t omega      = fPrimary->GetOmega(); // Energy xfer
+  kine.X = X;
 
   // 4-momentum of undetected recoil system B
-  fB = *pA1 - fX;
+  kine.B = A1 - X;
+  const FourVector& B = kine.B;
 
   // Angle of X with scattered primary particle
-  fXangle = fX.Angle( pP1->Vect());
+  kine.xangle = X.p.Angle( p1.p );
 
-  // Angles of X and B wrt q-vector 
+  // Angles of X and B wrt q-vector
   // xq and bq are the 3-momentum vectors of X and B expressed in
   // the coordinate system where q is the z-axis and the x-axis
   // lies in the scattering plane (defined by q and e') and points
   // in the direction of e', so the out-of-plane angle lies within
   // -90<phi_xq<90deg if X is detected on the downstream/forward side of q.
-  TRotation rot_to_q;
-  rot_to_q.SetZAxis( pQ->Vect(), pP1->Vect()).Invert();
-  TVector3 xq = fX.Vect();
-  TVector3 bq = fB.Vect();
-  xq *= rot_to_q;  
-  bq *= rot_to_q;
-  fTheta_xq = xq.Theta();   //"theta_xq"
-  fPhi_xq   = xq.Phi();     //"out-of-plane angle", "phi"
-  fTheta_bq = bq.Theta();
-  fPhi_bq   = bq.Phi();
+  AxisFrame q_frame( q.p, p1.p );
+  ThreeVector xq = q_frame.ToFrame( X.p );
+  ThreeVector bq = q_frame.ToFrame( B.p );
+  kine.theta_xq = xq.Theta();   //"theta_xq"
+  kine.phi_xq   = xq.Phi();     //"out-of-plane angle", "phi"
+  kine.theta_bq = bq.Theta();
+  kine.phi_bq   = bq.Phi();
 
   // Missing momentum and components wrt q-vector
   // The definition of p_miss as the negative of the undetected recoil
   // momentum is the standard nuclear physics convention.
-  TVector3 p_miss = -bq;
-  fPmiss   = p_miss.Mag();  //=fB.P()
+  ThreeVector p_miss = -bq;
+  kine.pmiss   = p_miss.Mag();  //=B.P()
   //The missing momentum components in the q coordinate system.
-  //FIXME: just store p_miss in member variable
-  fPmiss_x = p_miss.X();
-  fPmiss_y = p_miss.Y();
-  fPmiss_z = p_miss.Z();
+  kine.pmiss_x = p_miss.x;
+  kine.pmiss_y = p_miss.y;
+  kine.pmiss_z = p_miss.z;
 
   // Invariant mass of the recoil system, a.k.a. "missing mass".
   // This invariant mass equals MB(ground state) plus any excitation energy.
-  fMrecoil = fB.M();
+  kine.mrecoil = B.M();
 
   // Kinetic energies of X and B
-  fTX = fX.E() - fMX;
-  fTB = fB.E() - fMrecoil;
-    
+  kine.tx = X.E() - MX;
+  kine.tb = B.E() - kine.mrecoil;
+
   // Standard nuclear physics definition of "missing energy":
   // binding energy of X in the target (= removal energy of X).
   // NB: If X is knocked out of a lower shell, the recoil system carries
   // a significant excitation energy. This excitation is included in Emiss
   // here, as it should, since it results from the binding of X.
-  fEmiss = omega - fTX - fTB;
+  kine.emiss = omega - kine.tx - kine.tb;
 
-  // In production reactions, the "missing energy" is defined 
+  // In production reactions, the "missing energy" is defined
   // as the total energy of the undetected recoil system.
   // This is the "missing mass", Mrecoil, plus any kinetic energy.
-  fErecoil = fB.E();
+  kine.erecoil = B.E();
 
   // Calculate some interesting quantities in the CM system of A'.
   // NB: If the target is initially at rest, the A'-vector (spatial part)
-  // is the same as the q-vector, so we could just reuse the q rotation
-  // matrix. The following is completely general, i.e. allows for a moving 
+  // is the same as the q-vector, so we could just reuse the q frame.
+  // The following is completely general, i.e. allows for a moving
   // target.
 
-  // Boost of the A' system.
-  // NB: ROOT's Boost() boosts particle to lab if the boost vector points
-  // along the particle's lab velocity, so we need the negative here to 
-  // boost from the lab to the particle frame.
-  Double_t beta = pA1->P()/(pA1->E());
-  TVector3 boost(0.,0.,-beta); 
+  // Boost of the A' system, negative to boost from the lab to the
+  // particle frame.
+  Double_t beta = A1.P()/A1.E();
 
-  // CM vectors of X and B. 
-  // Express X and B in the frame where q is along the z-axis 
+  // CM vectors of X and B.
+  // Express X and B in the frame where q is along the z-axis
   // - the typical head-on collision picture.
-  TRotation rot_to_A1;
-  rot_to_A1.SetZAxis( pA1->Vect(), pP1->Vect()).Invert();
-  TVector3 x_cm_vect = fX.Vect();
-  x_cm_vect *= rot_to_A1;
-  TLorentzVector x_cm(x_cm_vect,fX.E());
-  x_cm.Boost(boost);
-  TLorentzVector b_cm(-x_cm.Vect(), pA1->E()-x_cm.E());
-  fPX_cm = x_cm.P();
+  AxisFrame A1_frame( A1.p, p1.p );
+  FourVector x_cm = FourVector( A1_frame.ToFrame(X.p), X.E() ).BoostZ(-beta);
+  FourVector b_cm( -x_cm.p, A1.E()-x_cm.E() );
+  kine.px_cm = x_cm.P();
   // pB_cm, by construction, is the same as pX_cm.
 
   // CM angles of X and B in the A' frame
-  fTheta_x_cm = x_cm.Theta();
-  fPhi_x_cm   = x_cm.Phi();
-  fTheta_b_cm = b_cm.Theta();
-  fPhi_b_cm   = b_cm.Phi();
+  kine.theta_x_cm = x_cm.Theta();
+  kine.phi_x_cm   = x_cm.Phi();
+  kine.theta_b_cm = b_cm.Theta();
+  kine.phi_b_cm   = b_cm.Phi();
 
   // CM kinetic energies of X and B and total kinetic energy
-  fTX_cm = x_cm.E() - fMX;
-  fTB_cm = b_cm.E() - fMrecoil;
-  fTtot_cm = fTX_cm + fTB_cm;
-    
+  kine.tx_cm = x_cm.E() - MX;
+  kine.tb_cm = b_cm.E() - kine.mrecoil;
+  kine.ttot_cm = kine.tx_cm + kine.tb_cm;
+
   // Mandelstam variables for the secondary vertex.
   // These variables are defined for the reaction gA->XB,
   // where g is the virtual photon (with momentum q), and A, X, and B
   // are as before.
 
-  fMandelS = (*pQ+*pA).M2();
-  fMandelT = (*pQ-fX).M2();
-  fMandelU = (*pQ-fB).M2();
+  kine.mandelS = (q+A).M2();
+  kine.mandelT = (q-X).M2();
+  kine.mandelU = (q-B).M2();
+}
+
+//_____________________________________________________________________________
+Int_t THaSecondaryKine::Process( const THaEvData& )
+{
+  // Calculate the kinematics.
+
+  if( !IsOK() ) return -1;
+
+  // Tracking information from the secondary spectrometer
+  THaTrackInfo* trkifo = fSpectro->GetTrackInfo();
+  if( !trkifo || !trkifo->IsOK() ) return 1;
+
+  // Require valid input data
+  if( !fPrimary->DataValid() ) return 2;
+
+  // 4-momentum of X from its measured momentum in the lab
+  FourVector X = FourVector::FromMass( ThreeVector(trkifo->GetPvect()), fMX );
+
+  // 4-momenta of the the primary interaction
+  Kine_t kine;
+  CalcKine( X,
+            FourVector(*fPrimary->GetA()),    // Initial target
+            FourVector(*fPrimary->GetA1()),   // Final target
+            FourVector(*fPrimary->GetQ()),    // Momentum xfer
+            FourVector(*fPrimary->GetP1()),   // Final electron
+            fPrimary->GetOmega(),             // Energy xfer
+            fMX, kine );
+
+  fTheta_xq   = kine.theta_xq;
+  fPhi_xq     = kine.phi_xq;
+  fTheta_bq   = kine.theta_bq;
+  fPhi_bq     = kine.phi_bq;
+  fXangle     = kine.xangle;
+  fPmiss      = kine.pmiss;
+  fPmiss_x    = kine.pmiss_x;
+  fPmiss_y    = kine.pmiss_y;
+  fPmiss_z    = kine.pmiss_z;
+  fEmiss      = kine.emiss;
+  fMrecoil    = kine.mrecoil;
+  fErecoil    = kine.erecoil;
+  fTX         = kine.tx;
+  fTB         = kine.tb;
+  fPX_cm      = kine.px_cm;
+  fTheta_x_cm = kine.theta_x_cm;
+  fPhi_x_cm   = kine.phi_x_cm;
+  fTheta_b_cm = kine.theta_b_cm;
+  fPhi_b_cm   = kine.phi_b_cm;
+  fTX_cm      = kine.tx_cm;
+  fTB_cm      = kine.tb_cm;
+  fTtot_cm    = kine.ttot_cm;
+  fMandelS    = kine.mandelS;
+  fMandelT    = kine.mandelT;
+  fMandelU    = kine.mandelU;
+
+  // 4-vectors exposed via global variables and used by other modules
+  kine.X.Get(fX);
+  kine.B.Get(fB);
 
   fDataValid = true;
   return 0;
 }
 
+//_____________________________________________________________________________
+Int_t THaSecondaryKine::CalcAllTracks( vector<Kine_t>& kine ) const
+{
+  // Calculate the secondary kinematics for every track of the secondary
+  // spectrometer, using the primary kinematics of the current event.
+  // Results are stored in 'kine' in track order. Requires the secondary
+  // spectrometer to be a THaSpectrometer. Returns the number of tracks,
+  // or -1 on error.
+
+  kine.clear();
+  if( !IsOK() || !fPrimary->DataValid() ) return -1;
+  auto* spectro = dynamic_cast<THaSpectrometer*>(fSpectro);
+  if( !spectro ) return -1;
+
+  const TClonesArray* tracks = spectro->GetTracks();
+  Int_t ntracks = spectro->GetNTracks();
+  kine.resize(ntracks);
+  FourVector A(*fPrimary->GetA()), A1(*fPrimary->GetA1());
+  FourVector q(*fPrimary->GetQ()), p1(*fPrimary->GetP1());
+  Double_t omega = fPrimary->GetOmega();
+  for( Int_t i = 0; i < ntracks; ++i ) {
+    auto* theTrack = static_cast<THaTrack*>(tracks->UncheckedAt(i));
+    FourVector X =
+      FourVector::FromMass( ThreeVector(theTrack->GetPvect()), fMX );
+    CalcKine( X, A, A1, q, p1, omega, fMX, kine[i] );
+  }
+  return ntracks;
+}
+
 //_____________________________________________________________________________
 Int_t THaSecondaryKine::ReadRunDatabase( const TDatime& date )
 {
@@ -9,6 +9,8 @@
 
 #include "THaPhysicsModule.h"
 #include "TLorentzVector.h"
+#include "FourVector.h"
+#include <vector>
 #include "TString.h"
 
 class THaPrimaryKine;
@@ -23,7 +25,24 @@ public:
 		    const char* primary_kine = "", 
 		    Double_t secondary_mass = 0.0 /* GeV */ );
   virtual ~THaSecondaryKine();
-  
+
+  // Kinematics of one secondary particle, computed with value-type vectors
+  struct Kine_t {
+    Double_t theta_xq, phi_xq, theta_bq, phi_bq, xangle;
+    Double_t pmiss, pmiss_x, pmiss_y, pmiss_z, emiss, mrecoil, erecoil;
+    Double_t tx, tb, px_cm, theta_x_cm, phi_x_cm, theta_b_cm, phi_b_cm;
+    Double_t tx_cm, tb_cm, ttot_cm, mandelS, mandelT, mandelU;
+    Podd::FourVector X;   // Detected secondary particle
+    Podd::FourVector B;   // Recoil system
+  };
+  static  void      CalcKine( const Podd::FourVector& X,
+                              const Podd::FourVector& A,
+                              const Podd::FourVector& A1,
+                              const Podd::FourVector& q,
+                              const Podd::FourVector& p1,
+                              Double_t omega, Double_t MX, Kine_t& kine );
+          Int_t     CalcAllTracks( std::vector<Kine_t>& kine ) const;
+
   virtual void      Clear( Option_t* opt="" );
 
   Double_t          GetTheta_xq()   const { return fTheta_xq; }
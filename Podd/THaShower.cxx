@@ -4,9 +4,15 @@
 //                                                                           //
 // Shower counter class, describing a generic segmented shower detector      //
 // (preshower or shower).                                                    //
-// Currently, only the "main" cluster, i.e. cluster with the largest energy  //
-// deposition is considered. Units of measurements are MeV for energy of     //
-// shower and meters for coordinates.                                        //
+// By default, only the "main" cluster, i.e. cluster with the largest       //
+// energy deposition is considered. With "multi_cluster = 1" in the          //
+// database, all clusters are found. Units of measurements are MeV for       //
+// energy of shower and meters for coordinates.                              //
+//                                                                           //
+// Each track crossing the detector is matched to the nearest cluster        //
+// within "trk_max_dxdy" (default: one block spacing) of the track's         //
+// crossing point. The blocks' cluster indices serve as a spatial index,     //
+// so only clusters near the track are examined.                             //
 //                                                                           //
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -16,6 +22,7 @@
 #include "VarDef.h"
 #include "VarType.h"
 #include "THaTrack.h"
+#include "THaTrackProj.h"
 #include "TClonesArray.h"
 #include "TDatime.h"
 #include "TMath.h"
@@ -40,7 +47,8 @@ using namespace Podd;
 THaShower::THaShower( const char* name, const char* description,
 		      THaApparatus* apparatus ) :
   THaPidDetector(name,description,apparatus),
-  fNrows(0), fEmin(0), fAsum_p(kBig), fAsum_c(kBig),
+  fNrows(0), fNcols(0), fEmin(0), fMultiClust(false), fDx(0), fDy(0),
+  fTrkMaxDx(0), fTrkMaxDy(0), fAsum_p(kBig), fAsum_c(kBig),
   fNclust(0), fE(kBig), fX(kBig), fY(kBig), fADCData(nullptr)
 {
   // Constructor
@@ -49,7 +57,8 @@ THaShower::THaShower( const char* name, const char* description,
 //_____________________________________________________________________________
 THaShower::THaShower() :
   THaPidDetector(),
-  fNrows(0), fEmin(0), fAsum_p(kBig), fAsum_c(kBig),
+  fNrows(0), fNcols(0), fEmin(0), fMultiClust(false), fDx(0), fDy(0),
+  fTrkMaxDx(0), fTrkMaxDy(0), fAsum_p(kBig), fAsum_c(kBig),
   fNclust(0), fE(kBig), fX(kBig), fY(kBig), fADCData(nullptr)
 {
   // Default constructor (for ROOT I/O)
@@ -82,8 +91,8 @@ Int_t THaShower::ReadDatabase( const TDatime& date )
   }
 
   vector<Int_t> detmap, chanmap;
-  vector<Double_t> xy, dxy;
-  Int_t ncols = 0, nrows = 0;
+  vector<Double_t> xy, dxy, trk_dxy;
+  Int_t ncols = 0, nrows = 0, multi = 0;
 
   // Read mapping/geometry/configuration parameters
   DBRequest config_request[] = {
@@ -94,6 +103,8 @@ Int_t THaShower::ReadDatabase( const TDatime& date )
     { "xy",           &xy,      kDoubleV, 2 },  // center pos of block 1
     { "dxdy",         &dxy,     kDoubleV, 2 },  // dx and dy block spacings
     { "emin",         &fEmin,   kDataType },
+    { "multi_cluster", &multi,  kInt,     0, true },
+    { "trk_max_dxdy", &trk_dxy, kDoubleV, 2, true }, // track matching window
     { nullptr }
   };
   err = LoadDB( file, date, config_request, fPrefix );
@@ -118,6 +129,7 @@ Int_t THaShower::ReadDatabase( const TDatime& date )
     } else {
       fNelem = nelem;
       fNrows = nrows;
+      fNcols = ncols;
     }
   }
   assert( fNelem >= 0 );
@@ -160,8 +172,11 @@ Int_t THaShower::ReadDatabase( const TDatime& date )
     return err;
   }
 
-  fBlockPos.clear(); fBlockPos.reserve(nval);
+  fMultiClust = (multi != 0);
+  fBlockPos.clear(); fBlockPos.resize(nval);
   fClBlk.clear();    fClBlk.reserve(nclbl);
+  fClusters.clear();
+  fBlkClust.assign(nval, -1);
   fDetectorData.clear();
   auto detdata = MKADCDATA(GetPrefixName(), fTitle, nval, fChanMap);
   fADCData = detdata.get();
@@ -178,6 +193,28 @@ Int_t THaShower::ReadDatabase( const TDatime& date )
       fBlockPos[k].y = xy[1] + c * dxy[1];
     }
   }
+  fDx = dxy[0];
+  fDy = dxy[1];
+  if( trk_dxy.size() == 2 ) {
+    fTrkMaxDx = trk_dxy[0];
+    fTrkMaxDy = trk_dxy[1];
+  } else {
+    fTrkMaxDx = TMath::Abs(fDx);
+    fTrkMaxDy = TMath::Abs(fDy);
+  }
+
+  // Tabulate the neighbors of each block, including diagonal ones,
+  // in increasing order of block number
+  fNeighbors.assign(nval, {});
+  for( int c=0; c<ncols; c++ ) {
+    for( int r=0; r<nrows; r++ ) {
+      auto& nb = fNeighbors[nrows*c + r];
+      for( int ic = TMath::Max(c-1,0); ic <= TMath::Min(c+1,ncols-1); ic++ )
+        for( int ir = TMath::Max(r-1,0); ir <= TMath::Min(r+1,nrows-1); ir++ )
+          if( ic != c || ir != r )
+            nb.push_back(nrows*ic + ir);
+    }
+  }
 
   // Read calibration parameters
 
@@ -213,6 +250,8 @@ Int_t THaShower::ReadDatabase( const TDatime& date )
       { "Position of block 1",    &xy,         kDoubleV    },
       { "Block x/y spacings",     &dxy,        kDoubleV    },
       { "Minimum cluster energy", &fEmin,      kDataType,  1  },
+      { "Multi-cluster finding",  &multi,      kInt        },
+      { "Track matching dx/dy",   &trk_dxy,    kDoubleV    },
       { "ADC pedestals",          &ped,        kDataTypeV,  N  },
       { "ADC gains",              &gain,       kDataTypeV,  N  },
       { nullptr }
@@ -244,6 +283,11 @@ Int_t THaShower::DefineVariables( EMode mode )
     { "mult",   "Multiplicity of largest cluster",    "GetMainClusterSize()" },
     { "nblk",   "Numbers of blocks in main cluster",  "fClBlk.n" },
     { "eblk",   "Energies of blocks in main cluster", "fClBlk.E" },
+    { "cl.e",   "Energies (MeV) of all clusters",     "fClusters.E" },
+    { "cl.x",   "x-positions of all clusters",        "fClusters.X" },
+    { "cl.y",   "y-positions of all clusters",        "fClusters.Y" },
+    { "cl.mult","Multiplicities of all clusters",     "fClusters.mult" },
+    { "trcl",   "Cluster matched to each track",      "fTrkClust" },
     { nullptr }
   };
   return DefineVarsFromList( vars, mode );
@@ -262,10 +306,18 @@ void THaShower::Clear( Option_t* opt )
 {
   // Clear event data
 
+  // Only blocks with hits can have been assigned to a cluster. Do this
+  // before clearing the hit list.
+  if( fADCData ) {
+    for( auto k : fADCData->GetHitList() )
+      fBlkClust[k] = -1;
+  }
   THaPidDetector::Clear(opt);
   fAsum_p = fAsum_c = 0.0;
   fE = fX = fY = kBig;
   fClBlk.clear();
+  fClusters.clear();
+  fTrkClust.clear();
 }
 
 //_____________________________________________________________________________
@@ -319,60 +371,157 @@ Int_t THaShower::CoarseProcess( TClonesArray& tracks )
   // fClBlk         -  Numbers and energies of blocks composing the cluster
   //
   // Only one ("main") cluster, i.e. the cluster with the largest energy
-  // deposition is considered. Units are MeV for energies and meters for
-  // coordinates.
+  // deposition is considered, unless multi-cluster finding is enabled.
+  // In that case, further clusters are formed around the most energetic
+  // of the remaining blocks until none above fEmin are left, and all
+  // clusters are available in fClusters. Units are MeV for energies and
+  // meters for coordinates.
+  //
+  // Only blocks with hits are examined.
 
   fNclust = 0;
   fClBlk.clear();
-
-  // Find block with maximum energy deposit
-  int nmax = -1;
-  double emax = fEmin;                      // Min threshold of energy in center
-  for( int i = 0; i < fNelem; i++ ) {       // Find the block with max energy:
-    double ei = fADCData->GetADC(i).adc_c;  // Energy in next block
-    if( ei > 0.5*kBig ) continue;           // Skip invalid data
-    if( ei > emax ) {
-      nmax = i;                             // Number of block with max energy
-      emax = ei;                            // Max energy per a blocks
+  fClusters.clear();
+
+  const auto& hits = fADCData->GetHitList();
+  while( true ) {
+    // Find unassigned block with maximum energy deposit
+    int nmax = -1;
+    double emax = fEmin;                    // Min threshold of energy in center
+    for( auto i : hits ) {                  // Find the block with max energy:
+      if( fBlkClust[i] >= 0 ) continue;     // Skip blocks already in a cluster
+      double ei = fADCData->GetADC(i).adc_c;// Energy in next block
+      if( ei > 0.5*kBig ) continue;         // Skip invalid data
+      if( ei > emax || (ei == emax && nmax >= 0 && static_cast<int>(i) < nmax) ) {
+        nmax = static_cast<int>(i);         // Number of block with max energy
+        emax = ei;                          // Max energy per a blocks
+      }
     }
-  }
-  if ( nmax >= 0 ) {
-    int nc = nmax/fNrows;                   // Column of the block with max energy
-    int nr = nmax%fNrows;                   // Row of the block with max energy
-
-    fClBlk.push_back( {nmax,emax} );        // Add the block to cluster (center)
+    if( nmax < 0 )
+      break;
+
+    auto icl = static_cast<Int_t>(fClusters.size());
+    bool is_main = (icl == 0);
+    Cluster cl{};
+    fBlkClust[nmax] = icl;
+    if( is_main )
+      fClBlk.push_back( {nmax,emax} );      // Add the block to cluster (center)
     double sxe = emax * fBlockPos[nmax].x;  // Sum of xi*ei
     double sye = emax * fBlockPos[nmax].y;  // Sum of yi*ei
-    for( int i = 0; i < fNelem; i++ ) {     // Detach surround blocks:
+    cl.mult = 1;
+    for( auto i : fNeighbors[nmax] ) {      // Detach surround blocks:
+      if( fBlkClust[i] >= 0 ) continue;     // Already in a cluster
       double ei = fADCData->GetADC(i).adc_c;// Energy in next block
       if( ei > 0.5*kBig ) continue;         // Skip invalid data
-      if( ei > 0 && i != nmax ) {           // Some energy out of cluster center
-        int ic = i / fNrows;                // Column of next block
-        int ir = i % fNrows;                // Row of next block
-        int dr = nr - ir;                   // Distance on row up to center
-        int dc = nc - ic;                   // Distance on column up to center
-        if( -2<dr && dr<2 && -2<dc && dc<2 ) {   // Surround block:
-                                            // Add block to cluster (surround)
+      if( ei > 0 ) {                        // Some energy out of cluster center
+        fBlkClust[i] = icl;                 // Add block to cluster (surround)
+        if( is_main )
           fClBlk.push_back( {i,ei} );       // Add surround block to cluster
-          sxe += ei * fBlockPos[i].x;       // Sum of xi*ei of cluster blocks
-          sye += ei * fBlockPos[i].y;       // Sum of yi*ei of cluster blocks
-          emax += ei;                       // Sum of energies in cluster blocks
-        }
+        sxe += ei * fBlockPos[i].x;         // Sum of xi*ei of cluster blocks
+        sye += ei * fBlockPos[i].y;         // Sum of yi*ei of cluster blocks
+        emax += ei;                         // Sum of energies in cluster blocks
+        cl.mult++;
       }
     }
-    fNclust = 1;                            // One ("main") cluster detected
-    fE      = emax;                         // Energy (MeV) in "main" cluster
-    fX      = sxe/emax;                     // X coordinate (m) of the cluster
-    fY      = sye/emax;                     // Y coordinate (m) of the cluster
+    cl.E = emax;                            // Energy (MeV) in cluster
+    cl.X = sxe/emax;                        // X coordinate (m) of the cluster
+    cl.Y = sye/emax;                        // Y coordinate (m) of the cluster
+    fClusters.push_back(cl);
+    if( !fMultiClust )
+      break;
+  }
+  fNclust = fClusters.size();
+  if( fNclust > 0 ) {
+    fE = fClusters[0].E;                    // Energy (MeV) in "main" cluster
+    fX = fClusters[0].X;                    // X coordinate (m) of the cluster
+    fY = fClusters[0].Y;                    // Y coordinate (m) of the cluster
   }
 
-  // Calculate track projections onto shower plane
+  // Calculate track projections onto shower plane and match clusters
 
   CalcTrackProj( tracks );
+  MatchTracks();
 
   return 0;
 }
 
+//_____________________________________________________________________________
+Int_t THaShower::FindBlock( Data_t x, Data_t y ) const
+{
+  // Return number of the block whose center is closest to position (x,y),
+  // or -1 if (x,y) is outside of the detector
+
+  if( fBlockPos.empty() || fDx == 0 || fDy == 0 )
+    return -1;
+  Int_t r = TMath::Nint( (x - fBlockPos[0].x) / fDx );
+  Int_t c = TMath::Nint( (y - fBlockPos[0].y) / fDy );
+  if( r < 0 || r >= fNrows || c < 0 || c >= fNcols )
+    return -1;
+  return fNrows*c + r;
+}
+
+//_____________________________________________________________________________
+Int_t THaShower::FindCluster( Data_t x, Data_t y,
+                              Data_t maxdx, Data_t maxdy ) const
+{
+  // Find the cluster of the current event closest to position (x,y) with
+  // |dx| < maxdx and |dy| < maxdy. Only clusters with blocks near (x,y)
+  // are examined. Returns the cluster index or -1 if none found.
+
+  if( fClusters.empty() || fDx == 0 || fDy == 0 )
+    return -1;
+  // Search window in units of blocks. Cluster positions lie within the
+  // area covered by their blocks, so one extra block suffices.
+  Int_t wr = TMath::CeilNint( maxdx / TMath::Abs(fDx) ) + 1;
+  Int_t wc = TMath::CeilNint( maxdy / TMath::Abs(fDy) ) + 1;
+  Int_t r0 = TMath::Nint( (x - fBlockPos[0].x) / fDx );
+  Int_t c0 = TMath::Nint( (y - fBlockPos[0].y) / fDy );
+
+  Int_t best = -1;
+  Data_t dmin = kBig;
+  for( Int_t c = TMath::Max(c0-wc,0); c <= TMath::Min(c0+wc,fNcols-1); c++ ) {
+    for( Int_t r = TMath::Max(r0-wr,0); r <= TMath::Min(r0+wr,fNrows-1); r++ ) {
+      Int_t icl = fBlkClust[fNrows*c + r];
+      if( icl < 0 || icl == best )
+        continue;
+      const auto& cl = fClusters[icl];
+      Data_t dx = cl.X - x, dy = cl.Y - y;
+      if( TMath::Abs(dx) >= maxdx || TMath::Abs(dy) >= maxdy )
+        continue;
+      Data_t d2 = dx*dx + dy*dy;
+      if( d2 < dmin ) {
+        dmin = d2;
+        best = icl;
+      }
+    }
+  }
+  return best;
+}
+
+//_____________________________________________________________________________
+void THaShower::MatchTracks()
+{
+  // Associate the track projections from CalcTrackProj with the clusters
+  // of the current event. For each track crossing the detector, set the
+  // channel of its projection to the block hit and dX to the x-distance
+  // to the matched cluster, and record the cluster index in fTrkClust.
+
+  Int_t ntr = fTrackProj->GetLast()+1;
+  fTrkClust.assign(ntr, -1);
+  for( Int_t i = 0; i < ntr; i++ ) {
+    auto* proj = static_cast<THaTrackProj*>( fTrackProj->UncheckedAt(i) );
+    if( !proj || !proj->IsOK() )
+      continue;
+    Data_t x = proj->GetX(), y = proj->GetY();
+    proj->SetChannel( FindBlock(x, y) );
+    Int_t icl = FindCluster( x, y, fTrkMaxDx, fTrkMaxDy );
+    if( icl >= 0 ) {
+      fTrkClust[i] = icl;
+      proj->SetdX( fClusters[icl].X - x );
+    }
+  }
+}
+
 //_____________________________________________________________________________
 Int_t THaShower::FineProcess( TClonesArray& tracks )
 {
@@ -382,6 +531,7 @@ Int_t THaShower::FineProcess( TClonesArray& tracks )
   // during the FineTracking stage.
 
   CalcTrackProj( tracks );
+  MatchTracks();
 
   return 0;
 }
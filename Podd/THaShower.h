@@ -32,6 +32,26 @@ public:
           Data_t     GetX() const      { return fX; }
           Data_t     GetY() const      { return fY; }
 
+  // Cluster info. Cluster 0 is the main cluster. Unless multi-cluster
+  // finding is enabled, there is at most one cluster.
+  class Cluster {
+  public:
+    Data_t E;     // Energy (MeV)
+    Data_t X;     // Energy-weighted x position (m)
+    Data_t Y;     // Energy-weighted y position (m)
+    Int_t  mult;  // Number of blocks
+  };
+  const Cluster&  GetCluster( UInt_t i ) const { return fClusters.at(i); }
+          Int_t   GetClusterOfBlock( UInt_t k ) const { return fBlkClust.at(k); }
+          Int_t   FindBlock( Data_t x, Data_t y ) const;
+          Int_t   FindCluster( Data_t x, Data_t y,
+                               Data_t maxdx, Data_t maxdy ) const;
+  // Cluster matched to track i of the last CoarseProcess/FineProcess call
+          Int_t   GetTrackCluster( UInt_t i ) const
+  { return i < fTrkClust.size() ? fTrkClust[i] : -1; }
+  const std::vector<Int_t>& GetNeighbors( UInt_t k ) const
+  { return fNeighbors.at(k); }
+
   // Extension of standard ADCData to handle channel mapping
   class ShowerADCData : public Podd::ADCData {
   public:
@@ -50,7 +70,9 @@ protected:
 
   // Configuration
   Int_t      fNrows;     // Number of rows
+  Int_t      fNcols;     // Number of columns
   Data_t     fEmin;      // Minimum energy for a cluster center
+  Bool_t     fMultiClust; // Find all clusters, not only the main one
 
   // Geometry
   class CenterPos {
@@ -59,6 +81,11 @@ protected:
     Data_t y;  // y-position of block center (m)
   };
   std::vector<CenterPos> fBlockPos;  // Block center positions
+  Data_t     fDx;        // Block spacing along rows (m)
+  Data_t     fDy;        // Block spacing along columns (m)
+  Data_t     fTrkMaxDx;  // Max |dx| between track and matched cluster (m)
+  Data_t     fTrkMaxDy;  // Max |dy| between track and matched cluster (m)
+  std::vector<std::vector<Int_t>> fNeighbors; // Adjacent blocks of each block
 
   // Per-event data
   Data_t     fAsum_p;    // Sum of blocks ADC minus pedestal values
@@ -74,6 +101,9 @@ protected:
     Data_t E;  // Energy deposit (MeV) for current event
   };
   std::vector<ClusterBlock> fClBlk; // Blocks of main cluster
+  std::vector<Cluster> fClusters;   // All clusters found
+  std::vector<Int_t>   fBlkClust;   // Cluster index of each block (-1=none)
+  std::vector<Int_t>   fTrkClust;   // Cluster index for each track (-1=none)
 
   ShowerADCData* fADCData; // Convenience pointer to ADC data in fDetectorData
 
@@ -83,6 +113,8 @@ protected:
   virtual Int_t  ReadDatabase( const TDatime& date );
   virtual Int_t  DefineVariables( EMode mode = kDefine );
 
+          void   MatchTracks();
+
   ClassDef(THaShower,0)     //Generic shower detector class
 };
 
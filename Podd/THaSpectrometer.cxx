@@ -15,6 +15,7 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "THaSpectrometer.h"
+#include "MethodAccessor.h"
 #include "THaParticleInfo.h"
 #include "THaTrackingDetector.h"
 #include "THaNonTrackingDetector.h"
@@ -26,6 +27,9 @@
 #include "TMath.h"
 #include "TList.h"
 #include "VarDef.h"
+#include <algorithm>
+#include <string>
+#include <vector>
 
 #ifdef WITH_DEBUG
 #include <iostream>
@@ -44,6 +48,7 @@ THaSpectrometer::THaSpectrometer( const char* name, const char* desc ) :
   fPidParticles{new TObjArray},
   fGoldenTrack{nullptr},
   fPID{false},
+  fNeedPID{true},
   fThetaGeo{0.0}, fPhiGeo{0.0},   fThetaSph{0.0}, fPhiSph{0.0},
   fSinThGeo{0.0}, fCosThGeo{1.0}, fSinPhGeo{0.0}, fCosPhGeo{1.0},
   fSinThSph{0.0}, fCosThSph{1.0}, fSinPhSph{0.0}, fCosPhSph{1.0},
@@ -102,10 +107,13 @@ Int_t THaSpectrometer::AddDetector( THaDetector* pdet, Bool_t quiet, Bool_t firs
   if( status != 0 ) return status;
 
   auto* sdet = dynamic_cast<THaSpectrometerDetector*>( pdet );
-  if( sdet->IsTracking() )
+  if( sdet->IsTracking() ) {
     fTrackingDetectors->Add( sdet );
-  else
+    fTrackingDetArray.push_back( static_cast<THaTrackingDetector*>(sdet) );
+  } else {
     fNonTrackingDetectors->Add( sdet );
+    fNonTrackingDetArray.push_back( static_cast<THaNonTrackingDetector*>(sdet) );
+  }
 
   if( sdet->IsPid() )
     fPidDetectors->Add( sdet );
@@ -130,16 +138,28 @@ Int_t THaSpectrometer::CalcPID()
 {
   // Combine the PID information from all detectors into an overall PID
   // for each track.  The actual work is done in the THaPIDinfo class.
-  // This is just a loop over all tracks.
+  // This is just a loop over all tracks. THaPIDinfo::CombinePID only
+  // recomputes tracks whose probabilities changed. The results are
+  // copied to the global variables tr.pid.<particle>.
+  // Skipped if none of these is read (see UpdateVariableUsage).
   // Called by Reconstruct().
 
-  for( int i = 0; i < fTracks->GetLast()+1; i++ ) {
-    if( auto* theTrack = static_cast<THaTrack*>( fTracks->At(i) ) ) {
+  if( !fNeedPID )
+    return 0;
+
+  Int_t ntr = GetNTracks();
+  for( auto& prob : fPidProb )
+    prob.assign(ntr, 0.0);
+  for( int i = 0; i < ntr; i++ ) {
+    if( auto* theTrack = static_cast<THaTrack*>( fTracks->UncheckedAt(i) ) ) {
       if( THaPIDinfo* pid = theTrack->GetPIDinfo() ) {
         pid->CombinePID();
+        UInt_t npart = std::min<size_t>(pid->GetNpart(), fPidProb.size());
+        for( UInt_t p = 0; p < npart; p++ )
+          fPidProb[p][i] = pid->GetCombinedProb(p);
       }
     }
-  }    
+  }
   return 0;
 }
 
@@ -152,6 +172,8 @@ void THaSpectrometer::Clear( Option_t* opt )
   // Clear the track array and also the track objects themselves since they
   // need to deallocate memory
   fTracks->Clear("C");
+  for( auto& prob : fPidProb )
+    prob.clear();
   TrkIfoClear();
   VertexClear();
   fGoldenTrack = nullptr;
@@ -213,8 +235,44 @@ Int_t THaSpectrometer::DefineVariables( EMode mode )
     { "status",   "Bits of completed analysis stages", "fStagesDone" },
     { nullptr }
   };
+  Int_t ret = DefineVarsFromList( vars, mode );
+  if( ret != kOK )
+    return ret;
+
+  // Combined PID probability of each track for each particle hypothesis.
+  // The PID particles must be defined before initialization.
+  Int_t npart = GetNpidParticles();
+  if( mode == kDefine )
+    fPidProb.resize(npart);
+  vector<string> names, descs;
+  for( Int_t i = 0; i < npart; i++ ) {
+    const THaParticleInfo* part = GetPidParticleInfo(i);
+    names.push_back(string("tr.pid.") + part->GetName());
+    descs.push_back(string("PID probability for ") + part->GetTitle());
+  }
+  vector<VarDef> pidvars;
+  for( size_t i = 0; i < names.size() && i < fPidProb.size(); i++ )
+    pidvars.push_back({ names[i].c_str(), descs[i].c_str(), kDoubleV, 0,
+                        &fPidProb[i], nullptr });
+  pidvars.push_back({ nullptr, nullptr, 0, 0, nullptr, nullptr });
+  return DefineVarsFromList( pidvars.data(), mode );
+}
 
-  return DefineVarsFromList( vars, mode );
+//_____________________________________________________________________________
+void THaSpectrometer::UpdateVariableUsage()
+{
+  // The combined PID is only calculated if any of the tr.pid variables
+  // is read by the output or cuts, once the analyzer knows the variable
+  // usage (see THaAnalyzer::EnableSkipUnusedVariables). Code using the
+  // tracks' THaPIDinfo directly must then call CalcPID itself.
+
+  THaApparatus::UpdateVariableUsage();
+  fNeedPID = false;
+  for( Int_t i = 0; i < GetNpidParticles() && !fNeedPID; i++ ) {
+    TString name = "tr.pid.";
+    name += GetPidParticleInfo(i)->GetName();
+    fNeedPID = IsVariableUsed(name.Data());
+  }
 }
 
 //_____________________________________________________________________________
@@ -232,6 +290,27 @@ Bool_t THaSpectrometer::HasVertex() const
   return (fGoldenTrack) != nullptr && fGoldenTrack->HasVertex();
 }
 
+//_____________________________________________________________________________
+static size_t ClonesMemory( const TClonesArray* arr )
+{
+  // Upper estimate of the memory of 'arr' (bytes), assuming all slots
+  // have been used
+
+  if( !arr || !arr->GetClass() )
+    return 0;
+  return arr->GetSize() * (sizeof(TObject*) + arr->GetClass()->Size());
+}
+
+//_____________________________________________________________________________
+size_t THaSpectrometer::GetMemoryUsage() const
+{
+  // Approximate memory held by this spectrometer (bytes), including the
+  // track and track PID arrays. The detectors report their own memory.
+
+  return THaApparatus::GetMemoryUsage() + ClonesMemory(fTracks)
+         + ClonesMemory(fTrackPID);
+}
+
 //_____________________________________________________________________________
 void THaSpectrometer::ListInit()
 {
@@ -241,14 +320,21 @@ void THaSpectrometer::ListInit()
   fTrackingDetectors->Clear();
   fNonTrackingDetectors->Clear();
   fPidDetectors->Clear();
+  fTrackingDetArray.clear();
+  fNonTrackingDetArray.clear();
 
   TIter next(fDetectors);
   while( auto* theDetector = dynamic_cast<THaSpectrometerDetector*>( next() )) {
 
-    if( theDetector->IsTracking() )
+    if( theDetector->IsTracking() ) {
       fTrackingDetectors->Add( theDetector );
-    else
+      fTrackingDetArray.push_back(
+        static_cast<THaTrackingDetector*>(theDetector) );
+    } else {
       fNonTrackingDetectors->Add( theDetector );
+      fNonTrackingDetArray.push_back(
+        static_cast<THaNonTrackingDetector*>(theDetector) );
+    }
 
     if( theDetector->IsPid() )
       fPidDetectors->Add( theDetector );
@@ -260,8 +346,12 @@ void THaSpectrometer::ListInit()
   UInt_t npart = GetNpidParticles();
   TClonesArray& pid  = *fTrackPID;
 
+  // Existing objects are reused; only their dimensions are updated
   for( int i = 0; i < kInitTrackMultiplicity; i++ ) {
-    new( pid[i] )  THaPIDinfo( ndet, npart );
+    if( i > pid.GetLast() || !pid.At(i) )
+      new( pid[i] )  THaPIDinfo( ndet, npart );
+    else
+      static_cast<THaPIDinfo*>( pid.At(i) )->SetSize( ndet, npart );
   }
   
   fListInit = true;
@@ -277,9 +367,7 @@ Int_t THaSpectrometer::CoarseTrack()
 
   // 1st step: Coarse tracking.  This should be quick and dirty.
   // Any tracks found are put in the fTrack array.
-  TIter next( fTrackingDetectors );
-  while( auto* theTrackDetector =
-	 static_cast<THaTrackingDetector*>( next() )) {
+  for( auto* theTrackDetector : fTrackingDetArray ) {
 #ifdef WITH_DEBUG
     if( fDebug>1 ) cout << "Call CoarseTrack() for " 
 			<< theTrackDetector->GetName() << "... ";
@@ -305,9 +393,7 @@ Int_t THaSpectrometer::CoarseReconstruct()
   if( !IsDone(kCoarseTrack))
     CoarseTrack();
 
-  TIter next( fNonTrackingDetectors );
-  while( auto* theNonTrackDetector =
-	 static_cast<THaNonTrackingDetector*>( next() )) {
+  for( auto* theNonTrackDetector : fNonTrackingDetArray ) {
 #ifdef WITH_DEBUG
     if( fDebug>1 ) cout << "Call CoarseProcess() for " 
 			<< theNonTrackDetector->GetName() << "... ";
@@ -332,9 +418,7 @@ Int_t THaSpectrometer::Track()
   if( !IsDone(kCoarseRecon))
     CoarseReconstruct();
 
-  TIter next( fTrackingDetectors );
-  while( auto* theTrackDetector =
-	 static_cast<THaTrackingDetector*>( next() )) {
+  for( auto* theTrackDetector : fTrackingDetArray ) {
 #ifdef WITH_DEBUG
     if( fDebug>1 ) cout << "Call FineTrack() for " 
 			<< theTrackDetector->GetName() << "... ";
@@ -385,9 +469,7 @@ Int_t THaSpectrometer::Reconstruct()
   // remaining detectors for any precision processing.
   // PID likelihoods should be calculated here.
 
-  TIter next( fNonTrackingDetectors );
-  while( auto* theNonTrackDetector =
-	 static_cast<THaNonTrackingDetector*>( next() )) {
+  for( auto* theNonTrackDetector : fNonTrackingDetArray ) {
 #ifdef WITH_DEBUG
     if( fDebug>1 ) cout << "Call FineProcess() for " 
 			<< theNonTrackDetector->GetName() << "... ";
@@ -553,3 +635,6 @@ Int_t THaSpectrometer::ReadRunDatabase( const TDatime& date )
 //_____________________________________________________________________________
 ClassImp(THaSpectrometer)
 
+// Compiled accessors for functions used in global variable definitions
+PODD_REGISTER_METHOD(THaSpectrometer, GetNTracks)
+
@@ -15,10 +15,13 @@
 #include "TRotation.h"
 #include "THaParticleInfo.h"
 #include "THaPidDetector.h"
+#include <vector>
 
 class THaTrack;
 class TList;
 class THaCut;
+class THaTrackingDetector;
+class THaNonTrackingDetector;
 
 class THaSpectrometer : public THaApparatus, public THaTrackingModule,
 			public THaVertexModule {
@@ -44,6 +47,7 @@ public:
 					   Double_t mass, Int_t charge = 0 );
   virtual void             DefinePidParticles();
   virtual Int_t            DefineVariables( EMode mode = kDefine );
+  virtual void             UpdateVariableUsage();
           THaTrack*        GetGoldenTrack() const { return fGoldenTrack; }
           Int_t            GetNpidParticles() const;
           Int_t            GetNpidDetectors() const;
@@ -54,6 +58,7 @@ public:
           TClonesArray*    GetTrackPID() const { return fTrackPID; }
   virtual const TVector3&  GetVertex()   const;
   virtual Bool_t           HasVertex() const;
+  virtual size_t           GetMemoryUsage() const;
 
           Bool_t           IsDone( UInt_t stage ) const;
           Bool_t           IsPID() const       { return fPID; }
@@ -101,9 +106,13 @@ protected:
   TList*          fTrackingDetectors;     //Tracking detectors
   TList*          fNonTrackingDetectors;  //Non-tracking detectors
   TObjArray*      fPidDetectors;          //PID detectors
+  std::vector<THaTrackingDetector*>    fTrackingDetArray;    //!Typed copy
+  std::vector<THaNonTrackingDetector*> fNonTrackingDetArray; //!Typed copy
   TObjArray*      fPidParticles;          //Particles for which we want PID
   THaTrack*       fGoldenTrack;           //Golden track within fTracks
   Bool_t          fPID;                   //PID enabled
+  Bool_t          fNeedPID;               //Combined PID is read (see UpdateVariableUsage)
+  std::vector<std::vector<Double_t>> fPidProb; //Combined PID [particle][track]
 
   // The following is specific to small-acceptance pointing spectrometers
   TRotation       fToLabRot;              //Rotation matrix from TRANSPORT to lab
@@ -42,6 +42,31 @@ Bool_t THaSpectrometerDetector::CalcTrackIntercept( THaTrack* theTrack,
   return IntersectPlaneWithRay( fXax, fYax, fOrigin, t0, td, pathl, icept );
 }
 
+//_____________________________________________________________________________
+Bool_t THaSpectrometerDetector::CalcTrackIntercept( Double_t x, Double_t y,
+						    Double_t theta,
+						    Double_t phi,
+						    Double_t& pathl,
+						    Double_t& xdet,
+						    Double_t& ydet )
+{
+  // Same as CalcTrackIntercept(THaTrack*,pathl,xdet,ydet), but for a track
+  // given by its TRANSPORT coordinates x, y, theta, phi. Allows checking
+  // track candidates before THaTrack objects are made for them.
+
+  TVector3 t0( x, y, 0.0 );
+  TVector3 td( theta, phi, 1.0 );
+  td = td.Unit();
+
+  TVector3 icept;
+  if( !IntersectPlaneWithRay( fXax, fYax, fOrigin, t0, td, pathl, icept ) )
+    return false;
+  TVector3 v = TrackToDetCoord(icept);
+  xdet = v.X();
+  ydet = v.Y();
+  return true;
+}
+
 //_____________________________________________________________________________
 Bool_t THaSpectrometerDetector::CalcTrackIntercept( THaTrack* theTrack,
 						    Double_t& pathl,
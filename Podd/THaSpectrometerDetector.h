@@ -33,6 +33,10 @@ public:
 				       Double_t& pathl );
           Bool_t   CalcTrackIntercept( THaTrack* track, Double_t& pathl,
 				       Double_t& xdet, Double_t& ydet );
+          Bool_t   CalcTrackIntercept( Double_t x, Double_t y,
+                                       Double_t theta, Double_t phi,
+                                       Double_t& pathl,
+                                       Double_t& xdet, Double_t& ydet );
 
   THaSpectrometerDetector() = default;    // for ROOT I/O only
 
@@ -39,6 +39,18 @@ THaApparatus* THaSubDetector::GetApparatus() const
   return det ? det->GetApparatus() : nullptr;
 }
 
+//_____________________________________________________________________________
+Podd::AnalysisContext* THaSubDetector::GetContext() const
+{
+  // Return the context of this subdetector. Unless explicitly set, use the
+  // one of the parent (sub)detector.
+
+  THaDetectorBase* det = GetParent();
+  if( !fContext && det )
+    return det->GetContext();
+  return THaDetectorBase::GetContext();
+}
+
 //_____________________________________________________________________________
 const char* THaSubDetector::GetDBFileName() const
 {
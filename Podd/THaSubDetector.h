@@ -31,6 +31,7 @@ public:
   // Search for parent THaDetector (not subdetector)
   THaDetector*     GetMainDetector() const;
   THaApparatus*    GetApparatus() const;
+  virtual Podd::AnalysisContext* GetContext() const;
   
   virtual void     SetParent( THaDetectorBase* );
   void             SetDetector( THaDetectorBase* det ) { SetParent(det); }
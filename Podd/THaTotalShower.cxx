@@ -5,12 +5,20 @@
 // A total shower counter, consisting of a shower and a preshower.           //
 // Calculates the total energy deposited in Shower+Preshower.                //
 //                                                                           //
+// With multi-cluster finding, each shower cluster is matched to the         //
+// nearest preshower cluster within "max_dxdy". The search uses the          //
+// preshower's block-to-cluster map as a spatial index, so the cost grows    //
+// with the number of clusters, not with the number of cluster pairs.        //
+// The total energy is also given for each track, from the clusters that     //
+// the shower and preshower matched to it.                                   //
+//                                                                           //
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "THaTotalShower.h"
 #include "THaShower.h"
 #include "VarType.h"
 #include "VarDef.h"
+#include "TClonesArray.h"
 #include "TMath.h"
 #include <string>
 
@@ -147,6 +155,9 @@ void THaTotalShower::Clear( Option_t* opt )
   THaPidDetector::Clear(opt);
   fE = kBig;
   fID = -1;
+  fClE.clear();
+  fClPs.clear();
+  fTrkE.clear();
 }
 
 //_____________________________________________________________________________
@@ -186,6 +197,9 @@ Int_t THaTotalShower::DefineVariables( EMode mode )
   RVarDef vars[] = {
     { "e",  "Energy (MeV) of largest cluster",    "fE" },
     { "id", "ID of Psh&Sh coincidence (1==good)", "fID" },
+    { "cl.e",  "Total energy (MeV) of each shower cluster", "fClE" },
+    { "cl.ps", "Preshower cluster matched to each shower cluster", "fClPs" },
+    { "tr.e",  "Total energy (MeV) of clusters matched to each track", "fTrkE" },
     { nullptr }
   };
   return DefineVarsFromList( vars, mode );
@@ -230,21 +244,69 @@ Int_t THaTotalShower::CoarseProcess( TClonesArray& tracks )
     Data_t dy = fPreShower->GetY() - fShower->GetY();
     if( TMath::Abs(dx) < fMaxDx && TMath::Abs(dy) < fMaxDy )
       fID = 1;
+    else if( fPreShower->GetNclust() > 1 ) {
+      // Multi-cluster preshower: look for another preshower cluster
+      // matching the main shower cluster
+      Int_t icl = fPreShower->FindCluster( fShower->GetX(), fShower->GetY(),
+                                           fMaxDx, fMaxDy );
+      if( icl >= 0 ) {
+        fE = fShower->GetE() + fPreShower->GetCluster(icl).E;
+        fID = 1;
+      }
+    }
   }
+  MatchClusters();
   return 0;
 }
+
+//_____________________________________________________________________________
+void THaTotalShower::MatchClusters()
+{
+  // Match each shower cluster to the nearest preshower cluster within
+  // (fMaxDx,fMaxDy) and compute the total energy of each shower cluster:
+  // its own plus that of the matched preshower cluster, if any.
+
+  UInt_t ncl = fShower->GetNclust();
+  fClE.resize(ncl);
+  fClPs.resize(ncl);
+  for( UInt_t i = 0; i < ncl; i++ ) {
+    const auto& cl = fShower->GetCluster(i);
+    Int_t icl = fPreShower->FindCluster( cl.X, cl.Y, fMaxDx, fMaxDy );
+    fClPs[i] = icl;
+    fClE[i] = cl.E;
+    if( icl >= 0 )
+      fClE[i] += fPreShower->GetCluster(icl).E;
+  }
+}
+
 //_____________________________________________________________________________
 Int_t THaTotalShower::FineProcess( TClonesArray& tracks )
 {
   // Fine processing. 
-  // Call fPreShower->FineProcess() and fShower->FineProcess() in turn.
+  // Call fPreShower->FineProcess() and fShower->FineProcess() in turn,
+  // then compute the total energy of each track.
   // Return return value of fShower->FineProcess().
 
   if( !IsOK() )
     return -1;
 
   fPreShower->FineProcess( tracks );
-  return fShower->FineProcess( tracks );
+  Int_t ret = fShower->FineProcess( tracks );
+
+  // Total energy per track, from the clusters matched to it in the
+  // shower and preshower
+  Int_t ntr = tracks.GetLast()+1;
+  fTrkE.assign(ntr, kBig);
+  for( Int_t i = 0; i < ntr; i++ ) {
+    Int_t ish = fShower->GetTrackCluster(i);
+    if( ish < 0 )
+      continue;
+    fTrkE[i] = fShower->GetCluster(ish).E;
+    Int_t ips = fPreShower->GetTrackCluster(i);
+    if( ips >= 0 )
+      fTrkE[i] += fPreShower->GetCluster(ips).E;
+  }
+  return ret;
 }
 
 //_____________________________________________________________________________
@@ -8,6 +8,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "THaPidDetector.h"
+#include <vector>
 
 class THaShower;
 
@@ -45,10 +46,15 @@ protected:
   // Per event data
   Data_t     fE;           // Total shower energy
   Int_t      fID;          // ID of Presh and Shower coincidence
+  std::vector<Data_t> fClE;   // Total energy of each shower cluster
+  std::vector<Int_t>  fClPs;  // Preshower cluster matched to each (-1=none)
+  std::vector<Data_t> fTrkE;  // Total energy of clusters matched to each track
 
   virtual Int_t  ReadDatabase( const TDatime& date );
   virtual Int_t  DefineVariables( EMode mode = kDefine );
 
+          void   MatchClusters();
+
 private:
   void           Setup( const char* name,  const char* desc, 
 			const char* shnam, const char* psnam,
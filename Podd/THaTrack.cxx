@@ -9,6 +9,7 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "THaTrack.h"
+#include "MethodAccessor.h"
 #include "THaCluster.h"
 #include "THaTrackID.h"
 #include <iostream>
@@ -109,3 +110,16 @@ Int_t THaTrack::Compare(const TObject * obj) const
 //_____________________________________________________________________________
 
 ClassImp(THaTrack)
+
+// Compiled accessors for functions used in global variable definitions
+PODD_REGISTER_METHOD(THaTrack, GetLabPx)
+PODD_REGISTER_METHOD(THaTrack, GetLabPy)
+PODD_REGISTER_METHOD(THaTrack, GetLabPz)
+PODD_REGISTER_METHOD(THaTrack, GetVertexX)
+PODD_REGISTER_METHOD(THaTrack, GetVertexY)
+PODD_REGISTER_METHOD(THaTrack, GetVertexZ)
+PODD_REGISTER_METHOD(THaTrack, GetPathLen)
+PODD_REGISTER_METHOD(THaTrack, GetTime)
+PODD_REGISTER_METHOD(THaTrack, GetdTime)
+PODD_REGISTER_METHOD(THaTrack, GetBeta)
+PODD_REGISTER_METHOD(THaTrack, GetdBeta)
@@ -0,0 +1,214 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// THaTrackCompare
+//
+// Compare the tracks that two spectrometers reconstruct from the same
+// event, e.g. two copies of the same spectrometer with different VDC
+// implementations (HallA/THaVDC and plugins/OldVDC) or different tracking
+// parameters. Both spectrometers decode the same raw data, so the
+// differences come entirely from the reconstruction.
+//
+// For every event, the numbers of tracks and the differences (B - A) of
+// the focal-plane and target coordinates of the golden tracks are
+// available as global variables:
+//
+//   ntr_a, ntr_b:   Number of tracks of spectrometers A and B
+//   d_x, d_y:       Focal-plane x, y (m)
+//   d_th, d_ph:     Focal-plane tangents of theta, phi
+//   d_tg_y:         Target y (m)
+//   d_tg_th, d_tg_ph: Target tangents of theta, phi
+//   d_dp:           Delta
+//
+// At the end of the run, a summary with the RMS and largest differences
+// is printed. The time each spectrometer takes is part of the analyzer's
+// benchmark summary (THaAnalyzer::EnableBenchmarks).
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "THaTrackCompare.h"
+#include "THaSpectrometer.h"
+#include "THaTrack.h"
+#include "VarDef.h"
+#include "TMath.h"
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+static const char* const kDiffName[] = {
+  "x", "y", "th", "ph", "tg_y", "tg_th", "tg_ph", "dp"
+};
+
+//_____________________________________________________________________________
+THaTrackCompare::THaTrackCompare( const char* name, const char* description,
+                                  const char* spectroA, const char* spectroB ) :
+  THaPhysicsModule(name,description), fNtrA(0), fNtrB(0), fTolerance(1e-6),
+  fSpectroNameA(spectroA), fSpectroNameB(spectroB),
+  fSpectroA(nullptr), fSpectroB(nullptr)
+{
+  // Normal constructor. Tracks of 'spectroB' are compared to those of
+  // the reference 'spectroA'.
+
+  THaTrackCompare::Clear();
+  ResetStatistics();
+}
+
+//_____________________________________________________________________________
+THaTrackCompare::~THaTrackCompare()
+{
+  // Destructor
+
+  RemoveVariables();
+}
+
+//_____________________________________________________________________________
+void THaTrackCompare::Clear( Option_t* opt )
+{
+  // Clear event-by-event data
+
+  THaPhysicsModule::Clear(opt);
+  fNtrA = fNtrB = 0;
+  for( auto& d : fDiff )
+    d = kBig;
+}
+
+//_____________________________________________________________________________
+void THaTrackCompare::ResetStatistics()
+{
+  // Reset the run statistics
+
+  fNev = fNdiffNtr = fNgold = fNbeyond = 0;
+  for( Int_t k = 0; k < kNdiff; ++k )
+    fSum2[k] = fMaxAbs[k] = 0;
+}
+
+//_____________________________________________________________________________
+THaAnalysisObject::EStatus THaTrackCompare::Init( const TDatime& run_time )
+{
+  // Initialize the module. Locate the two spectrometers.
+
+  fSpectroA = static_cast<THaSpectrometer*>
+    ( FindModule( fSpectroNameA.Data(), "THaSpectrometer"));
+  if( !fSpectroA )
+    return fStatus;
+  fSpectroB = static_cast<THaSpectrometer*>
+    ( FindModule( fSpectroNameB.Data(), "THaSpectrometer"));
+  if( !fSpectroB )
+    return fStatus;
+  if( fSpectroA == fSpectroB ) {
+    Error( Here("Init"), "Cannot compare spectrometer %s with itself.",
+           fSpectroNameA.Data() );
+    return fStatus = kInitError;
+  }
+
+  // Standard initialization. Calls this object's DefineVariables().
+  if( THaPhysicsModule::Init( run_time ) != kOK )
+    return fStatus;
+
+  ResetStatistics();
+  return fStatus;
+}
+
+//_____________________________________________________________________________
+Int_t THaTrackCompare::DefineVariables( EMode mode )
+{
+  // Define/delete global variables.
+
+  const RVarDef vars[] = {
+    { "ntr_a",    "Number of tracks of A",              "fNtrA" },
+    { "ntr_b",    "Number of tracks of B",              "fNtrB" },
+    { "d_x",      "Golden track fp x, B-A (m)",         "fDiff[0]" },
+    { "d_y",      "Golden track fp y, B-A (m)",         "fDiff[1]" },
+    { "d_th",     "Golden track fp tan(theta), B-A",    "fDiff[2]" },
+    { "d_ph",     "Golden track fp tan(phi), B-A",      "fDiff[3]" },
+    { "d_tg_y",   "Golden track target y, B-A (m)",     "fDiff[4]" },
+    { "d_tg_th",  "Golden track target tan(theta), B-A","fDiff[5]" },
+    { "d_tg_ph",  "Golden track target tan(phi), B-A",  "fDiff[6]" },
+    { "d_dp",     "Golden track delta, B-A",            "fDiff[7]" },
+    { nullptr }
+  };
+  return DefineVarsFromList( vars, mode );
+}
+
+//_____________________________________________________________________________
+Int_t THaTrackCompare::Process( const THaEvData& )
+{
+  // Compare the tracks of the two spectrometers
+
+  if( !IsOK() ) return -1;
+
+  fNtrA = fSpectroA->GetNTracks();
+  fNtrB = fSpectroB->GetNTracks();
+  ++fNev;
+  if( fNtrA != fNtrB )
+    ++fNdiffNtr;
+
+  const THaTrack* a = fSpectroA->GetGoldenTrack();
+  const THaTrack* b = fSpectroB->GetGoldenTrack();
+  if( !a || !b )
+    return 0;
+
+  fDiff[kX]    = b->GetX()      - a->GetX();
+  fDiff[kY]    = b->GetY()      - a->GetY();
+  fDiff[kTh]   = b->GetTheta()  - a->GetTheta();
+  fDiff[kPh]   = b->GetPhi()    - a->GetPhi();
+  fDiff[kTgY]  = b->GetTY()     - a->GetTY();
+  fDiff[kTgTh] = b->GetTTheta() - a->GetTTheta();
+  fDiff[kTgPh] = b->GetTPhi()   - a->GetTPhi();
+  fDiff[kDp]   = b->GetDp()     - a->GetDp();
+
+  ++fNgold;
+  bool beyond = false;
+  for( Int_t k = 0; k < kNdiff; ++k ) {
+    Double_t d = TMath::Abs(fDiff[k]);
+    fSum2[k] += d*d;
+    if( d > fMaxAbs[k] )
+      fMaxAbs[k] = d;
+    if( d > fTolerance )
+      beyond = true;
+  }
+  if( beyond )
+    ++fNbeyond;
+
+  fDataValid = true;
+  return 0;
+}
+
+//_____________________________________________________________________________
+void THaTrackCompare::Print( Option_t* opt ) const
+{
+  // Print the comparison statistics
+
+  THaPhysicsModule::Print(opt);
+  cout << "Tracks of " << fSpectroNameB << " compared to " << fSpectroNameA
+       << endl;
+  cout << "  Events:                           " << fNev << endl;
+  cout << "  Different number of tracks:       " << fNdiffNtr << endl;
+  cout << "  Golden tracks in both:            " << fNgold << endl;
+  cout << "  Golden tracks differing > " << setw(8) << fTolerance << ": "
+       << fNbeyond << endl;
+  if( fNgold == 0 )
+    return;
+  cout << "  Golden track differences (B-A):" << endl
+       << "    " << left << setw(8) << "" << right << setw(14) << "rms"
+       << setw(14) << "max |diff|" << endl;
+  for( Int_t k = 0; k < kNdiff; ++k ) {
+    cout << "    " << left << setw(8) << kDiffName[k] << right
+         << setw(14) << TMath::Sqrt(fSum2[k]/fNgold)
+         << setw(14) << fMaxAbs[k] << endl;
+  }
+}
+
+//_____________________________________________________________________________
+Int_t THaTrackCompare::End( THaRunBase* run )
+{
+  // Print the summary of the run
+
+  if( fNev > 0 )
+    Print();
+  return THaPhysicsModule::End(run);
+}
+
+//_____________________________________________________________________________
+ClassImp(THaTrackCompare)
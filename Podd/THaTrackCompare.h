@@ -0,0 +1,69 @@
+#ifndef Podd_THaTrackCompare_h_
+#define Podd_THaTrackCompare_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// THaTrackCompare
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "THaPhysicsModule.h"
+#include "TString.h"
+
+class THaSpectrometer;
+
+class THaTrackCompare : public THaPhysicsModule {
+
+public:
+  THaTrackCompare( const char* name, const char* description,
+                   const char* spectroA="", const char* spectroB="" );
+  virtual ~THaTrackCompare();
+
+  virtual void      Clear( Option_t* opt="" );
+  virtual Int_t     End( THaRunBase* r=nullptr );
+  virtual EStatus   Init( const TDatime& run_time );
+  virtual void      Print( Option_t* opt="" ) const;
+  virtual Int_t     Process( const THaEvData& evdata );
+
+  Double_t          GetTolerance() const { return fTolerance; }
+  void              SetSpectrometers( const char* spectroA, const char* spectroB );
+  void              SetTolerance( Double_t tol ) { fTolerance = tol; }
+
+protected:
+
+  // Compared track parameters, B minus A
+  enum { kX, kY, kTh, kPh, kTgY, kTgTh, kTgPh, kDp, kNdiff };
+
+  Int_t             fNtrA;         // Number of tracks of spectrometer A
+  Int_t             fNtrB;         // Number of tracks of spectrometer B
+  Double_t          fDiff[kNdiff]; // Golden track differences, B-A
+
+  Double_t          fTolerance;    // Differences considered significant
+  ULong64_t         fNev;          // Events compared
+  ULong64_t         fNdiffNtr;     // Events with different number of tracks
+  ULong64_t         fNgold;        // Events with golden tracks in both
+  ULong64_t         fNbeyond;      // Events with golden tracks differing > fTolerance
+  Double_t          fSum2[kNdiff]; // Sums of squared differences
+  Double_t          fMaxAbs[kNdiff]; // Largest absolute differences
+
+  TString           fSpectroNameA; // Name of reference spectrometer
+  TString           fSpectroNameB; // Name of spectrometer to compare
+  THaSpectrometer*  fSpectroA;     // Reference spectrometer
+  THaSpectrometer*  fSpectroB;     // Spectrometer to compare
+
+  virtual Int_t DefineVariables( EMode mode = kDefine );
+          void  ResetStatistics();
+
+  ClassDef(THaTrackCompare,0)   //Compare tracks of two spectrometers
+};
+
+//_________ inlines __________________________________________________________
+inline
+void THaTrackCompare::SetSpectrometers( const char* spectroA,
+                                        const char* spectroB )
+{
+  fSpectroNameA = spectroA;
+  fSpectroNameB = spectroB;
+}
+
+#endif
@@ -9,6 +9,7 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "THaTrackInfo.h"
+#include "MethodAccessor.h"
 #include "THaTrack.h"
 #include "THaSpectrometer.h"
 #include "THaTrackingDetector.h"
@@ -56,3 +57,8 @@ THaTrackInfo& THaTrackInfo::operator=( const THaTrack& track )
 
 //_____________________________________________________________________________
 ClassImp(THaTrackInfo)
+
+// Compiled accessors for functions used in global variable definitions
+PODD_REGISTER_METHOD(THaTrackInfo, GetPx)
+PODD_REGISTER_METHOD(THaTrackInfo, GetPy)
+PODD_REGISTER_METHOD(THaTrackInfo, GetPz)
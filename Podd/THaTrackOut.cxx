@@ -81,6 +81,10 @@ Int_t THaTrackOut::InitOutput( THaOutput* output )
     return -2;
   }
   TTree* tree = output->GetTree();
+  if (!tree && THaOutput::IsHistogramsOnly()) {
+    fOKOut = true;  // No tree output wanted
+    return 0;
+  }
   if (!tree) {
     Error("InitOutput","Cannot get Tree! Output initialization FAILED!");
     return -3;
@@ -100,7 +104,7 @@ Int_t THaTrackOut::Process( const THaEvData& )
 {
   // Calculate the 4-vector for the golden track from fSrc
   
-  if ( !IsOK() || !gHaRun ) return -1;
+  if ( !IsOK() || !GetCurrentRun() ) return -1;
   
   THaTrackInfo *trkifo = fSrc->GetTrackInfo();
   if ( !trkifo || !trkifo->IsOK() ) return 1;
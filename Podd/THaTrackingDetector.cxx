@@ -74,6 +74,7 @@ THaTrack* THaTrackingDetector::AddTrack( TClonesArray& tracks,
 
     if( i > c.GetLast() || !c.At(i) )  new( c[i] ) THaPIDinfo( ndet, npart );
     pid = static_cast<THaPIDinfo*>( c.At(i) );
+    pid->SetSize( ndet, npart );  // no-op unless the PID setup changed
   
   } else if( fDebug>0 ) {
     ::Warning("THaTrackingDetector::AddTrack", "No spectrometer defined for "
@@ -28,8 +28,7 @@ ClassImp(THaUnRasteredBeam)
 THaUnRasteredBeam::THaUnRasteredBeam( const char* name, 
 				      const char* description,
 				      Int_t runningsum_depth )
-  : THaBeam( name, description ), fRunningSumDepth(runningsum_depth),
-    fRunningSumWrap(false), fRunningSumNext(0)
+  : THaBeam( name, description ), fRunningSumDepth(runningsum_depth)
 {
 
 
@@ -37,10 +36,8 @@ THaUnRasteredBeam::THaUnRasteredBeam( const char* name,
   AddDetector( new THaBPM("BPMB","2nd bpm",this) );
 
   if (fRunningSumDepth>1) {
-    fRSPosition.clear();
-    fRSDirection.clear();
-    fRSPosition.resize(fRunningSumDepth);
-    fRSDirection.resize(fRunningSumDepth);
+    fRSPosition.SetDepth(fRunningSumDepth);
+    fRSDirection.SetDepth(fRunningSumDepth);
   } else {
     fRunningSumDepth=0;
   }
@@ -76,46 +73,24 @@ Int_t THaUnRasteredBeam::Reconstruct()
     theBeamDet->Process();
   }
 
-  if( fRunningSumDepth != 0 ) {
-
-
-    if (fRunningSumWrap) {
-      fRSAvPos = fRSAvPos - ( ( 1./fRunningSumDepth) * fRSPosition[fRunningSumNext] );
-      fRSAvDir = fRSAvDir - ( ( 1./fRunningSumDepth) * fRSDirection[fRunningSumNext]);
+  // Direction from the two BPMs and extrapolated position at z = 0
+  Double_t dx = pos[1].X() - pos[0].X();
+  Double_t dy = pos[1].Y() - pos[0].Y();
+  Double_t dz = pos[1].Z() - pos[0].Z();
+  Double_t s  = pos[1].Z() / (pos[0].Z() - pos[1].Z());
+  fDirection.SetXYZ( dx, dy, dz );
+  fPosition.SetXYZ( pos[1].X() + s*dx, pos[1].Y() + s*dy, pos[1].Z() + s*dz );
 
-    }      
-
-    fRSDirection[fRunningSumNext] = pos[1] - pos[0] ;
-    fRSPosition[fRunningSumNext]  = pos[1] +
-                                    (pos[1](2) / (pos[0](2) - pos[1](2))) * fRSDirection[fRunningSumNext] ;
-
-    if (fRunningSumWrap) {
-      fRSAvPos = fRSAvPos + ( ( 1./fRunningSumDepth) * fRSPosition[fRunningSumNext] );
-      fRSAvDir = fRSAvDir +  (( 1./fRunningSumDepth) * fRSDirection[fRunningSumNext]);
-    } else {
-      if (fRunningSumNext==0) { 
-	fRSAvPos = fRSPosition[fRunningSumNext];
-	fRSAvDir = fRSDirection[fRunningSumNext];
-      } else {
-	fRSAvPos = ((double)fRunningSumNext/(fRunningSumNext+1.))*fRSAvPos 
-	  + ( (1./(fRunningSumNext+1)) * fRSPosition[fRunningSumNext] );
-	fRSAvDir = ((double)fRunningSumNext/(fRunningSumNext+1.))*fRSAvDir 
-	  + ( (1./(fRunningSumNext+1)) * fRSDirection[fRunningSumNext] );
-      }
-    }
-    fRunningSumNext++;
-    if (fRunningSumNext==fRunningSumDepth) {
-      fRunningSumNext = 0;
-      fRunningSumWrap = true ;
+  if( fRunningSumDepth != 0 ) {
+    // Average over the last fRunningSumDepth events
+    if( fRSPosition.GetDepth() != static_cast<UInt_t>(fRunningSumDepth) ) {
+      fRSPosition.SetDepth( fRunningSumDepth );
+      fRSDirection.SetDepth( fRunningSumDepth );
     }
-    fDirection = fRSAvDir;
-    fPosition =  fRSAvPos;
-
-  } else {
-
-    fDirection = pos[1] - pos[0];
-    fPosition = pos[1] + (pos[1](2) / (pos[0](2) - pos[1](2))) * fDirection ;
-
+    fRSPosition.Add( fPosition );
+    fRSDirection.Add( fDirection );
+    fRSPosition.Get( fPosition );
+    fRSDirection.Get( fDirection );
   }
   Update();
 
@@ -126,6 +101,6 @@ Int_t THaUnRasteredBeam::Reconstruct()
 //_____________________________________________________________________________
 void  THaUnRasteredBeam::ClearRunningSum()
 {
-  fRunningSumNext = 0 ;
-  fRunningSumWrap = false ;
+  fRSPosition.Clear();
+  fRSDirection.Clear();
 }
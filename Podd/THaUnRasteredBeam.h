@@ -8,7 +8,7 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "THaBeam.h"
-#include <vector>
+#include "RunningAverage.h"
 
 class THaUnRasteredBeam : public THaBeam {
 
@@ -25,12 +25,8 @@ public:
 
 protected:
 
-  Bool_t fRunningSumWrap;
-  Int_t fRunningSumNext;
-  std::vector<TVector3> fRSPosition;
-  std::vector<TVector3> fRSDirection;
-  TVector3 fRSAvPos;
-  TVector3 fRSAvDir;   
+  Podd::RunningAverage fRSPosition;   //! Running average of position
+  Podd::RunningAverage fRSDirection;  //! Running average of direction
 
   ClassDef(THaUnRasteredBeam,0)    // A beam with unrastered beam, analyzed event by event
 };
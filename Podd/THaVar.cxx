@@ -67,7 +67,7 @@ static const char* const here = "THaVar";
 template <typename T>
 THaVar::THaVar( const char* name, const char* descript, T& var,
 		const Int_t* count )
-  : TNamed(name,descript), fImpl(nullptr)
+  : TNamed(name,descript), fImpl(nullptr), fUsed(false)
 {
   // Constructor for basic types and fixed and variable-size arrays
 
@@ -96,10 +96,12 @@ THaVar::THaVar( const char* name, const char* descript, T& var,
 
 //_____________________________________________________________________________
 THaVar::THaVar( const char* name, const char* descript, const void* obj,
-	VarType type, Int_t offset, TMethodCall* method, const Int_t* count )
-  : TNamed(name,descript), fImpl(nullptr)
+	VarType type, Int_t offset, TMethodCall* method, const Int_t* count,
+	const Podd::MethodAccessor* acc )
+  : TNamed(name,descript), fImpl(nullptr), fUsed(false)
 {
-  // Generic constructor (used by THaVarList::DefineByType)
+  // Generic constructor (used by THaVarList::DefineByType).
+  // Method variables are called via 'acc' if given, else via 'method'.
 
   if( type == kObject  || type == kObjectP  || type == kObject2P ||
       type == kObjectV || type == kObjectPV ) {
@@ -120,7 +122,7 @@ THaVar::THaVar( const char* name, const char* descript, const void* obj,
     fImpl = new Podd::VectorVar( this, obj, type );
   }
   else if( count ) {
-    if( offset >= 0 || method ) {
+    if( offset >= 0 || method || acc ) {
       Error( here, "Variable %s: Inconsistent arguments. Cannot specify "
 	     "both count and offset/method", name );
       MakeZombie();
@@ -128,17 +130,17 @@ THaVar::THaVar( const char* name, const char* descript, const void* obj,
     }
     fImpl = new Podd::VariableArrayVar( this, obj, type, count );
   }
-  else if( method || offset >= 0 ) {
-    if( method && offset >= 0 ) {
+  else if( method || acc || offset >= 0 ) {
+    if( (method || acc) && offset >= 0 ) {
       if( offset > 0 ) {
 	Warning( here, "Variable %s: Offset > 0 ignored for method call on "
 		 "object in collection. Fix code or call expert", name );
       }
-      fImpl = new Podd::SeqCollectionMethodVar( this, obj, type, method );
-    } else if( !method )
+      fImpl = new Podd::SeqCollectionMethodVar( this, obj, type, method, acc );
+    } else if( !method && !acc )
       fImpl = new Podd::SeqCollectionVar( this, obj, type, offset );
     else
-      fImpl = new Podd::MethodVar( this, obj, type, method );
+      fImpl = new Podd::MethodVar( this, obj, type, method, acc );
   }
   else if( fName.Index("[") != kNPOS )
     fImpl = new Podd::FixedArrayVar( this, obj, type );
@@ -151,8 +153,9 @@ THaVar::THaVar( const char* name, const char* descript, const void* obj,
 
 //_____________________________________________________________________________
 THaVar::THaVar( const char* name, const char* descript, const void* obj,
-	VarType type, Int_t elem_size, Int_t offset, TMethodCall* method )
-  : TNamed(name,descript), fImpl(nullptr)
+	VarType type, Int_t elem_size, Int_t offset, TMethodCall* method,
+	const Podd::MethodAccessor* acc )
+  : TNamed(name,descript), fImpl(nullptr), fUsed(false)
 {
   // Generic constructor for std::vector<TObject(*)>
   // (used by THaVarList::DefineByType)
@@ -169,12 +172,13 @@ THaVar::THaVar( const char* name, const char* descript, const void* obj,
     MakeZombie();
     return;
   }
-  if( method ) {
+  if( method || acc ) {
     if( offset > 0 ) {
       Warning( here, "Variable %s: Offset > 0 ignored for method call on "
 	       "object", name );
     }
-    fImpl = new Podd::VectorObjMethodVar( this, obj, type, elem_size, method );
+    fImpl = new Podd::VectorObjMethodVar( this, obj, type, elem_size, method,
+					  acc );
   } else {
     fImpl = new Podd::VectorObjVar( this, obj, type, elem_size, offset );
   }
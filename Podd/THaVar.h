@@ -16,6 +16,7 @@
 
 class THaArrayString;
 class TMethodCall;
+namespace Podd { class MethodAccessor; }
 
 class THaVar : public TNamed {
 
@@ -28,10 +29,12 @@ public:
   THaVar( const char* name, const char* descript, T& var, const Int_t* count=nullptr );
 
   THaVar( const char* name, const char* descript, const void* obj,
-	  VarType type, Int_t offset, TMethodCall* method=nullptr, const Int_t* count=nullptr );
+	  VarType type, Int_t offset, TMethodCall* method=nullptr, const Int_t* count=nullptr,
+	  const Podd::MethodAccessor* acc=nullptr );
 
   THaVar( const char* name, const char* descript, const void* obj,
-	  VarType type, Int_t elem_size, Int_t offset, TMethodCall* method=nullptr );
+	  VarType type, Int_t elem_size, Int_t offset, TMethodCall* method=nullptr,
+	  const Podd::MethodAccessor* acc=nullptr );
 
   //TODO: copy, assignment
   virtual ~THaVar();
@@ -45,11 +48,14 @@ public:
   const char*  GetTypeName()                    const { return Vars::GetTypeName(GetType()); }
 
   std::vector<Double_t>     GetValues()         const { return fImpl->GetValues(); }
+  template< typename T >
+  size_t       GetValues( T* out, size_t cap )  const { return fImpl->GetValues(out,cap); }
   Double_t     GetValue( Int_t i = 0 )          const { return fImpl->GetValue(i); }
   Long64_t     GetValueInt( Int_t i = 0 )       const { return fImpl->GetValueInt(i); }
 
   const void*  GetValuePointer()                const { return fImpl->GetValuePointer(); }
   const void*  GetDataPointer( Int_t i = 0 )    const { return fImpl->GetDataPointer(i); }
+  Bool_t       GetView( Podd::VarView& view )   const { return fImpl->GetView(view); }
   size_t       GetData( void* buf )             const { return fImpl->GetData(buf); }
   size_t       GetData( void* buf, Int_t i )    const { return fImpl->GetData(buf,i); }
 
@@ -69,6 +75,10 @@ public:
   Bool_t       IsVarArray()                     const { return fImpl->IsVarArray(); }
   Bool_t       IsVector()                       const { return fImpl->IsVector(); }
 
+  // Usage flag, set by the analysis objects that read this variable
+  Bool_t       IsUsed()                         const { return fUsed; }
+  void         SetUsed( Bool_t used = true )          { fUsed = used; }
+
   // Overrides of TNamed methods
   virtual void         Print( Option_t* opt="FULL" )
 						const { return fImpl->Print(opt); }
@@ -78,6 +88,7 @@ public:
 
 protected:
   Podd::Variable* fImpl;   //Pointer to implementation
+  Bool_t          fUsed;   //! Variable is read by output/cuts/tests
 
   ClassDef(THaVar,0)   //Global symbolic variable
 };
@@ -56,11 +56,15 @@
 #include "TString.h"
 #include "TClass.h"
 #include "TMethodCall.h"
+#include "MethodAccessor.h"
 #include "TFunction.h"
 #include "TROOT.h"
+#include "THashTable.h"
 
 #include <string>  // for TFunction::GetReturnTypeNormalizedName
+#include <cstring>
 #include <cassert>
+#include <algorithm>
 
 ClassImp(THaVarList)
 
@@ -70,7 +74,8 @@ static const Int_t kInitVarListCapacity = 100;
 static const Int_t kVarListRehashLevel  = 3;
 
 //_____________________________________________________________________________
-THaVarList::THaVarList() : THashList(kInitVarListCapacity, kVarListRehashLevel)
+THaVarList::THaVarList()
+  : THashList(kInitVarListCapacity, kVarListRehashLevel), fUsageKnown(false)
 {
   // Default constructor
 
@@ -320,6 +325,31 @@ THaVar* THaVarList::DefineByRTTI( const TString& name, const TString& desc,
     assert(pos2 != kNPOS );  // else EndsWith("()") lied
     funcName = funcName(0, pos2);
 
+    // Prefer a compiled accessor, if one is registered for this function
+    const Podd::MethodAccessor* acc =
+      Podd::MethodAccessor::Find(theClass, funcName);
+    if( acc ) {
+      if( !objrtti.IsObjVector() )
+	var = new THaVar( name, desc, (void*)loc, acc->GetType(),
+			  ((ndot==2) ? 0 : -1), nullptr, nullptr, acc );
+      else {
+	assert( ndot == 1 );
+	VarType otype = objrtti.GetType();
+	assert( otype == kObjectV || otype == kObjectPV );
+	Int_t sz = (otype == kObjectV) ? objrtti.GetClass()->Size() : 0;
+	var = new THaVar( name, desc, (void*)loc, acc->GetType(), sz, 0,
+			  nullptr, acc );
+      }
+      if( !var->IsZombie() )
+	AddLast( var );
+      else {
+	Warning( errloc, "Error creating variable %s", name.Data() );
+	delete var;
+	return nullptr;
+      }
+      return var;
+    }
+
     auto* theMethod = new TMethodCall(theClass, funcName, "" );
     if( !theMethod->IsValid() ) {
       Warning( errloc, "Error getting function information for variable %s. "
@@ -458,6 +488,11 @@ Int_t THaVarList::DefineVariables( const VarDef* list, const char* prefix,
   if( !prefix )
     prefix = "";
 
+  Int_t nitems = 0;
+  for( const VarDef* it = list; it->name; ++it )
+    ++nitems;
+  Reserve(nitems);
+
   const VarDef* item = list;
   Int_t ndef = 0;
   TString name;
@@ -546,6 +581,11 @@ Int_t THaVarList::DefineVariables( const RVarDef* list, const TObject* obj,
     return -3;
   }
 
+  Int_t nitems = 0;
+  for( const RVarDef* it = list; it->name; ++it )
+    ++nitems;
+  Reserve(nitems);
+
   const RVarDef* item;
   Int_t ndef = 0;
   while( (item = list++) && item->name ) {
@@ -593,6 +633,79 @@ Int_t THaVarList::DefineVariables( const RVarDef* list, const TObject* obj,
   return ndef;
 }
 
+//_____________________________________________________________________________
+void THaVarList::SyncIndex() const
+{
+  // Rebuild the name index if variables were added to the list without
+  // going through AddFirst/AddLast (e.g. via AddAt or AddBefore)
+
+  if( fIndex.Size() != static_cast<size_t>(GetSize()) )
+    fIndex.Rebuild(this);
+}
+
+//_____________________________________________________________________________
+void THaVarList::Reserve( Int_t n )
+{
+  // Make room for 'n' more variables, so that adding them rehashes the
+  // list and the name index at most once. The capacity grows at least
+  // geometrically, so frequent small reservations stay cheap.
+
+  if( n <= 0 )
+    return;
+  Int_t need = GetSize() + n;
+  if( fTable && fTable->Capacity() < need )
+    Rehash(max(need, 2 * fTable->Capacity()));
+  SyncIndex();
+  fIndex.Reserve(need);
+}
+
+//_____________________________________________________________________________
+void THaVarList::AddFirst( TObject* obj )
+{
+  THashList::AddFirst(obj);
+  if( fIndex.Size() + 1 == static_cast<size_t>(GetSize()) )
+    fIndex.Add(obj, true);
+}
+
+//_____________________________________________________________________________
+void THaVarList::AddLast( TObject* obj )
+{
+  THashList::AddLast(obj);
+  if( fIndex.Size() + 1 == static_cast<size_t>(GetSize()) )
+    fIndex.Add(obj);
+}
+
+//_____________________________________________________________________________
+TObject* THaVarList::Remove( TObject* obj )
+{
+  TObject* ret = THashList::Remove(obj);
+  if( ret )
+    fIndex.Remove(ret);
+  return ret;
+}
+
+//_____________________________________________________________________________
+TObject* THaVarList::Remove( TObjLink* lnk )
+{
+  if( lnk )
+    fIndex.Remove(lnk->GetObject());
+  return THashList::Remove(lnk);
+}
+
+//_____________________________________________________________________________
+void THaVarList::Clear( Option_t* option )
+{
+  fIndex.Clear();
+  THashList::Clear(option);
+}
+
+//_____________________________________________________________________________
+void THaVarList::Delete( Option_t* option )
+{
+  fIndex.Clear();
+  THashList::Delete(option);
+}
+
 //_____________________________________________________________________________
 THaVar* THaVarList::Find( const char* name ) const
 {
@@ -601,12 +714,72 @@ THaVar* THaVarList::Find( const char* name ) const
 
   if( !name )
     return nullptr;
-  string s(name);
-  auto pos = s.find('[');
-  return dynamic_cast<THaVar*>(
-    (pos == string::npos) ? FindObject(name)
-                          : FindObject(s.erase(pos).c_str())
-  );
+  SyncIndex();
+  return dynamic_cast<THaVar*>( fIndex.Find(name, strcspn(name, "[")) );
+}
+
+//_____________________________________________________________________________
+static string LiteralPrefix( const char* expr, Bool_t wildcard )
+{
+  // Return the leading literal part of the pattern 'expr', i.e. the
+  // string that all matching names must begin with. Empty if there is
+  // no such part or the pattern is not anchored at the beginning.
+  // Wildcard patterns are always anchored (see TRegexp::MakeWildcard).
+
+  string prefix;
+  const char* p = expr;
+  if( *p == '^' )
+    ++p;
+  else if( !wildcard )
+    return prefix;
+  const char* special = wildcard ? "*?[]+^$\\" : ".*?[]+^$\\(){}|";
+  while( *p && !strchr(special, *p) )
+    prefix += *p++;
+  // In regular expressions, '*' and '?' make the preceding character optional
+  if( !wildcard && (*p == '*' || *p == '?') && !prefix.empty() )
+    prefix.erase(prefix.size() - 1);
+  return prefix;
+}
+
+//_____________________________________________________________________________
+Int_t THaVarList::FindMatching( const char* expr, vector<THaVar*>& vars,
+                                Bool_t wildcard ) const
+{
+  // Append to 'vars' all variables whose names match the regular expression
+  // 'expr', in the order in which they were defined. If 'wildcard' is true,
+  // the wildcard format is used (see TRegexp).
+  // For patterns beginning with a literal string (e.g. "L.tr.*"), only
+  // variables with that prefix are examined.
+  // Returns number of variables found, or <0 if error.
+
+  if( !expr )
+    return -1;
+  TRegexp re( expr, wildcard );
+  if( re.Status() ) return -1;
+
+  Int_t nfound = 0;
+  auto check = [&]( TObject* obj ) {
+    TString name = obj->GetName();
+    if( name.Index( re ) != kNPOS ) {
+      if( auto* var = dynamic_cast<THaVar*>(obj) ) {
+        vars.push_back(var);
+        nfound++;
+      }
+    }
+  };
+  string prefix = LiteralPrefix( expr, wildcard );
+  if( prefix.empty() ) {
+    TIter next( this );
+    while( TObject* obj = next() )
+      check(obj);
+  } else {
+    SyncIndex();
+    vector<TObject*> candidates;
+    fIndex.FindPrefix( prefix, candidates );
+    for( auto* obj : candidates )
+      check(obj);
+  }
+  return nfound;
 }
 
 //_____________________________________________________________________________
@@ -655,18 +828,13 @@ Int_t THaVarList::RemoveRegexp( const char* expr, Bool_t wildcard )
   // is true, the more user-friendly wildcard format is used (see TRegexp).
   // Returns number of variables removed, or <0 if error.
 
-  TRegexp re( expr, wildcard );
-  if( re.Status() ) return -1;
+  vector<THaVar*> vars;
+  if( FindMatching( expr, vars, wildcard ) < 0 )
+    return -1;
 
-  Int_t ndel = 0;
-  TIter next( this );
-  while( TObject* ptr = next() ) {
-    TString name = ptr->GetName();
-    if( name.Index( re ) != kNPOS ) {
-      ptr = Remove( ptr );
-      delete ptr;
-      ndel++;
-    }
+  for( auto* var : vars ) {
+    Remove( var );
+    delete var;
   }
-  return ndel;
+  return static_cast<Int_t>(vars.size());
 }
@@ -10,6 +10,7 @@
 #include "THashList.h"
 #include "THaVar.h"
 #include "VarDef.h"
+#include "NameIndex.h"
 #include <vector>
 
 class THaVarList : public THashList {
@@ -185,11 +186,34 @@ public:
                                     const char* def_prefix = "",
                                     const char* comment_subst = "");
   virtual THaVar*  Find( const char* name ) const;
+  virtual Int_t    FindMatching( const char* expr, std::vector<THaVar*>& vars,
+                                 Bool_t wildcard = true ) const;
   virtual void     PrintFull(Option_t *opt="") const;
   virtual Int_t    RemoveName( const char* name );
   virtual Int_t    RemoveRegexp( const char* expr, Bool_t wildcard = true );
 
+  // Usage flags of the variables are complete (see THaVar::IsUsed)
+  Bool_t           IsUsageKnown() const { return fUsageKnown; }
+  void             SetUsageKnown( Bool_t known ) { fUsageKnown = known; }
+
+  // Pre-size the hash tables for 'n' additional variables
+  void             Reserve( Int_t n );
+
+  // Keep the name index in sync with the list
+  using THashList::AddFirst;
+  using THashList::AddLast;
+  virtual void     AddFirst( TObject* obj );
+  virtual void     AddLast( TObject* obj );
+  virtual TObject* Remove( TObject* obj );
+  virtual TObject* Remove( TObjLink* lnk );
+  virtual void     Clear( Option_t* option="" );
+  virtual void     Delete( Option_t* option="" );
+
 protected:
+  mutable Podd::NameIndex fIndex;  //! Fast lookup table of variable names
+  Bool_t           fUsageKnown;    //! Usage flags of variables are valid
+
+  void             SyncIndex() const;
 
   ClassDef(THaVarList,2)   //List of analyzer global variables
 };
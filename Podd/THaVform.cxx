@@ -20,16 +20,19 @@
 
 #include <iostream>
 #include <cassert>
+#include <algorithm>
 
 using namespace std;
 using namespace THaString;
 
+ULong64_t THaVform::fgEvtGen = 1;
+
 //_____________________________________________________________________________
 THaVform::THaVform( const char *type, const char* name, const char* formula,
 		    const THaVarList* vlst, const THaCutList* clst )
   : THaFormula(), fNvar(0), fObjSize(0), fEyeOffset(0), fData(0.0),
     fType(kUnknown), fDebug(0), fVarPtr(nullptr), fOdata(nullptr),
-    fPrefix(kNoPrefix)
+    fPrefix(kNoPrefix), fEvtGen(0)
 {
   SetName(name);
   SetList(vlst);
@@ -60,7 +63,7 @@ THaVform::THaVform( const THaVform& rhs ) :
   fType(rhs.fType), fDebug(rhs.fDebug), fAndStr(rhs.fAndStr), fOrStr(rhs.fOrStr),
   fSumStr(rhs.fSumStr), fVarName(rhs.fVarName), fVarStat(rhs.fVarStat),
   fSarray(rhs.fSarray), fVectSform(rhs.fVectSform), fStitle(rhs.fStitle),
-  fVarPtr(rhs.fVarPtr), fOdata(nullptr), fPrefix(rhs.fPrefix)
+  fVarPtr(rhs.fVarPtr), fOdata(nullptr), fPrefix(rhs.fPrefix), fEvtGen(0)
 {
   // Copy ctor
 
@@ -130,10 +133,12 @@ void THaVform::Create(const THaVform &rhs)
   fVectSform = rhs.fVectSform;
   fStitle = rhs.fStitle;
   fVarPtr = rhs.fVarPtr;
+  fReader = rhs.fReader;
   delete fOdata; fOdata = nullptr;
   if( rhs.fOdata )
     fOdata = new THaOdata(*rhs.fOdata);
   fPrefix = rhs.fPrefix;
+  fEvtGen = 0;
 }
 
 //_____________________________________________________________________________
@@ -279,7 +284,9 @@ Int_t THaVform::Init()
  	 status = 0;
          fVarPtr = fVarList->Find(fVarName[i].c_str());
          if( fVarPtr ) {
+           fVarPtr->SetUsed();
            fType = kVarArray;
+           fReader.Init(fVarPtr->GetType());
            fObjSize = fVarPtr->GetLen();
            if( fPrefix == kNoPrefix ) {
 	      delete fOdata;
@@ -309,6 +316,7 @@ Int_t THaVform::Init()
     }
     if (fVarStat[i] != kFAType ) continue;
     auto* pvar1 = fVarList->Find(fVarName[i].c_str());
+    if( pvar1 ) pvar1->SetUsed();
     fVarPtr = pvar1; // Store one pointer to be able to get the size
                      // later since it may change. This works since all
                      // elements were verified to be the same size.
@@ -365,9 +373,18 @@ void THaVform::ReAttach( )
 // Store one pointer to be able to get the size.
 // (see explanation in Init).  Also recompile the
 // THaCut's and THaFormula's to reattach to variables.
+  if( IsFormula() ) {
+    // Array formulas are evaluated directly (see Process), so this
+    // formula needs to be recompiled as well
+    fVarName.clear();
+    fVarStat.clear();
+    fNvar = 0;
+    Compile();
+  }
   for (Int_t i = 0; i < fNvar; ++i) {
     if (fVarStat[i] != kFAType ) continue;
     fVarPtr = fVarList->Find(fVarName[i].c_str());
+    if( fVarPtr ) fVarPtr->SetUsed();
     break;
   }
   for( auto& itc : fCut ) itc->Compile();
@@ -560,6 +577,18 @@ Int_t THaVform::SetOutput(TTree *tree)
 
 }
 
+//_____________________________________________________________________________
+Int_t THaVform::Update()
+{
+  // Process this THaVform if it has not been processed yet in the
+  // current event, i.e. since the last call to NewEvent().
+
+  if( fEvtGen == fgEvtGen )
+    return 0;
+  fEvtGen = fgEvtGen;
+  return Process();
+}
+
 //_____________________________________________________________________________
 Int_t THaVform::Process()
 {
@@ -573,6 +602,21 @@ Int_t THaVform::Process()
   switch (fType) {
 
   case kForm:
+    if( fOdata && fPrefix == kNoPrefix && IsArray() &&
+        fProgram.IsColumnar() ) {
+      // Array formula. Evaluate all elements in one go instead of
+      // evaluating each element's formula separately.
+      Int_t n = fObjSize;
+      if( n > fOdata->nsize && fOdata->Resize(n-1) ) {
+        cout << "THaVform::ERROR: storing too much";
+        cout << " formula data: " << GetName() << "  " << n << endl;
+        n = fOdata->nsize;
+      }
+      fOdata->ndata = EvalAll(fOdata->data, n);
+      if( fOdata->ndata > 0 )
+        fData = fOdata->data[0];
+      return 0;
+    }
     if (!fFormula.empty()) {
       THaFormula* theFormula = fFormula[0];
       if ( !theFormula->IsError() ) {
@@ -599,18 +643,25 @@ Int_t THaVform::Process()
       // Standard case first
       if (fOdata) {
 	fObjSize = fVarPtr->GetLen();
-	// Fill array in reverse order so that fOdata is resized just once
-	Int_t i = fObjSize;
-	Bool_t first = true;
-	while( i-- > 0 ) {
-	  // FIXME: for better efficiency, should use pointer to data and
-	  // Fill(int n,double* data) method in case of a contiguous array
-	  if (fOdata->Fill(i,fVarPtr->GetValue(i)) != 1 && first ) {
+	// Copy the whole array at once, directly from the variable's data
+	// if possible
+	Int_t n = fObjSize;
+	if( n > 0 ) {
+	  if( n > fOdata->nsize && fOdata->Resize(n-1) ) {
 	    cout << "THaVform::ERROR: storing too much";
 	    cout << " variable sized data: ";
-	    cout << fVarPtr->GetName() <<"  "<<fVarPtr->GetLen()<<endl;
-	    first = false;
+	    cout << fVarPtr->GetName() <<"  "<<n<<endl;
+	    n = fOdata->nsize;
+	  }
+	  Podd::VarView view;
+	  if( fReader.IsValid() && fVarPtr->GetView(view) &&
+	      view.type == fReader.GetType() ) {
+	    n = min(n, view.len);
+	    fReader.Read(view, fOdata->data, n);
+	  } else {
+	    n = static_cast<Int_t>(fVarPtr->GetValues(fOdata->data, n));
 	  }
+	  fOdata->ndata = n;
 	}
       }
       break;
@@ -621,9 +672,16 @@ Int_t THaVform::Process()
 
     case kSum:
       {
-	Int_t i = fVarPtr->GetLen();
-	while( i-- > 0 )
-	  fData += fVarPtr->GetValue(i);
+	Podd::VarView view;
+	if( fReader.IsValid() && fVarPtr->GetView(view) &&
+	    view.type == fReader.GetType() ) {
+	  for( Int_t i = 0; i < view.len; ++i )
+	    fData += fReader(view, i);
+	} else {
+	  Int_t i = fVarPtr->GetLen();
+	  while( i-- > 0 )
+	    fData += fVarPtr->GetValue(i);
+	}
 	fObjSize = 1;
       }
       break;
@@ -27,7 +27,7 @@ public:
 
   THaVform() : THaFormula(), fNvar(0), fObjSize(0), fEyeOffset(0),
     fData(0), fType(kUnknown), fDebug(0), fVarPtr(nullptr), fOdata(nullptr),
-    fPrefix(0) {}
+    fPrefix(0), fEvtGen(0) {}
   THaVform( const char* type, const char* name, const char* formula,
       const THaVarList* vlst=gHaVars, const THaCutList* clst=gHaCuts );
   virtual  ~THaVform();
@@ -52,6 +52,11 @@ public:
 // Must 'Process' once per event before processing the things
 // that use this object.
   Int_t Process();
+// Process this object unless already done since the last NewEvent().
+// Use this for objects that may be shared between several users.
+  Int_t Update();
+// Start a new event (invalidates results of all Update() calls)
+  static void NewEvent() { ++fgEvtGen; }
 // To get the data (from index of array).  In the case of a
 // cut this will be a 0 or 1 (false or true).
   Double_t GetData(Int_t index = 0) const;
@@ -99,8 +104,12 @@ protected:
   std::vector<std::string> fVectSform;
   std::string   fStitle;
   THaVar   *fVarPtr;
+  Podd::VarReader<Double_t> fReader; //! Element reader for variable-size array
   THaOdata *fOdata;
   Int_t fPrefix;
+  ULong64_t fEvtGen;  //! Event generation of last Update()
+
+  static ULong64_t fgEvtGen;  // Current event generation
 
 private:
 
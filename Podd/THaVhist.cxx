@@ -448,13 +448,18 @@ Int_t THaVhist::Process()
   }
   if ( !IsValid() ) return -1;
   
-  if (fMyFormX) fFormX->Process();
-  if (fFormY && fMyFormY) fFormY->Process();
+  // Evaluate the cut first. If it is a scalar and fails, nothing will be
+  // filled, so the X and Y formulas need not be computed at all.
+  // Update() computes forms shared with other histograms or with the
+  // tree output only once per event.
   Int_t sizec = 0;
-  if (fCut && fMyCut) {
-     fCut->Process();
-     sizec = fCut->GetSize();
+  if (fCut) {
+     fCut->Update();
+     if ( fCut->GetSize() <= 1 && CheckCut()==0 ) return 0;
+     if (fMyCut) sizec = fCut->GetSize();
   }
+  fFormX->Update();
+  if (fFormY) fFormY->Update();
 
   if ( IsScalar() ) {  
     // The following is my interpretation of the original code with a bugfix
@@ -487,15 +492,25 @@ Int_t THaVhist::Process()
       //  (diagonal elements of the XY index matrix)
       Int_t n = (sizex == 0 || sizey == 0) ? max(sizex,sizey) : min(sizex,sizey);
       if(fDebug) cout << "THaVhist :: Process   n  " << n << endl;
+      // Collect this event's entries, then fill them in one go
+      if( static_cast<Int_t>(fBufX.size()) < n ) {
+        fBufX.resize(n);
+        fBufY.resize(n);
+      }
+      Int_t nfill = 0;
       for ( ; i < n; ++i) {
-	//        cout << "THaVhist :: proc loop: data  "<<i<<"  "<<fFormX->GetData(*ix)<<"   "<<fFormY->GetData(*iy)<<"  *ic "<<*ic<<endl<<flush;
 	if ( CheckCut(*ic)==0 ) continue;
-	//  cout << "THaVhist :: proc loop:     FILLING HISTO "<<i<<endl;
- 	fH1[0]->Fill(fFormX->GetData(*ix), fFormY->GetData(*iy));
+	fBufX[nfill] = fFormX->GetData(*ix);
+	fBufY[nfill] = fFormY->GetData(*iy);
+	++nfill;
       }
+      FillBuffered(fH1[0], nfill);
 
     } else {  // 1D histo
       
+      if( static_cast<Int_t>(fBufX.size()) < sizex )
+        fBufX.resize(sizex);
+      Int_t nfill = 0;
       for (Int_t i = 0; i < sizex; ++i) {
         if(fDebug) cout << "THaVhist :: 1D histo " << i << "  " << sizec << endl;
         if (sizec == sizex) {
@@ -503,8 +518,9 @@ Int_t THaVhist::Process()
 	} else {
  	   if ( CheckCut()==0 ) continue;
 	}
-	fH1[0]->Fill(fFormX->GetData(i));
+	fBufX[nfill++] = fFormX->GetData(i);
       }
+      FillBuffered(fH1[0], nfill);
     }
 
   } else { // Vector histogram.  
@@ -536,6 +552,79 @@ Int_t THaVhist::Process()
   return 0;
 }
 
+//_____________________________________________________________________________
+static void FillFixedBins( TH1* h, const Double_t* x, Int_t n )
+{
+  // Fill 1D histogram 'h', which must have fixed-width bins and no fill
+  // buffer, with the n values 'x' with unit weight. The result is the
+  // same as calling h->Fill(x[i]) for each value, but the bin numbers are
+  // computed directly and the statistics are updated just once.
+
+  Float_t*  binsF = nullptr;
+  Double_t* binsD = nullptr;
+  if( auto* hf = dynamic_cast<TH1F*>(h) )
+    binsF = hf->GetArray();
+  else if( auto* hd = dynamic_cast<TH1D*>(h) )
+    binsD = hd->GetArray();
+  else {
+    h->FillN(n, x, nullptr);
+    return;
+  }
+  const TAxis* ax = h->GetXaxis();
+  const Int_t nbins = ax->GetNbins();
+  const Double_t xlo = ax->GetXmin(), xhi = ax->GetXmax();
+  Double_t* sumw2 = (h->GetSumw2N() > 0) ? h->GetSumw2()->GetArray() : nullptr;
+  const Bool_t stat_overflows = TH1::GetStatOverflows();
+
+  Double_t stats[4];
+  h->GetStats(stats);
+  for( Int_t i = 0; i < n; ++i ) {
+    Double_t xi = x[i];
+    // Same bin finding as TAxis::FindBin
+    Int_t bin;
+    if( xi < xlo )
+      bin = 0;
+    else if( !(xi < xhi) )
+      bin = nbins + 1;
+    else
+      bin = 1 + Int_t(nbins * (xi - xlo) / (xhi - xlo));
+    if( binsF )
+      binsF[bin] += 1;
+    else
+      binsD[bin] += 1;
+    if( sumw2 )
+      sumw2[bin] += 1;
+    if( (bin == 0 || bin > nbins) && !stat_overflows )
+      continue;
+    stats[0] += 1;
+    stats[1] += 1;
+    stats[2] += xi;
+    stats[3] += xi * xi;
+  }
+  h->PutStats(stats);
+  h->SetEntries(h->GetEntries() + n);
+}
+
+//_____________________________________________________________________________
+void THaVhist::FillBuffered( TH1* h, Int_t n )
+{
+  // Fill histogram 'h' with the first n values in fBufX (and fBufY for
+  // 2D histograms)
+
+  if( n <= 0 )
+    return;
+  if( fFormY ) {
+    static_cast<TH2*>(h)->FillN(n, &fBufX[0], &fBufY[0], nullptr);
+    return;
+  }
+  const TAxis* ax = h->GetXaxis();
+  if( ax->GetXbins()->GetSize() == 0 && !h->GetBuffer() &&
+      !h->CanExtendAllAxes() )
+    FillFixedBins(h, &fBufX[0], n);
+  else
+    h->FillN(n, &fBufX[0], nullptr);
+}
+
 //_____________________________________________________________________________
 Int_t THaVhist::End() 
 {
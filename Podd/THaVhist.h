@@ -57,6 +57,7 @@ public:
 // IsScalar() is true if histogram is a scalar.
    Bool_t IsScalar() const { return (fScalar==1); };
    Int_t GetSize() const { return fSize; };
+   const std::vector<TH1*>& GetHistograms() const { return fH1; };
 
 protected:
 
@@ -65,6 +66,7 @@ protected:
    Int_t FindVarSize();
    Bool_t FindEye(const string& var);
    Bool_t FindEyeOffset(const string& var);
+   void FillBuffered(TH1* h, Int_t n);
 //   Int_t GetCut(Int_t index=0);
 
    enum FEr { kOK = 0, kNoBinX, kIllFox, kIllFoy, kIllCut,
@@ -83,6 +85,7 @@ protected:
    THaVform *fFormX, *fFormY, *fCut;
    Bool_t fMyFormX, fMyFormY, fMyCut;
    Int_t fDebug;
+   std::vector<Double_t> fBufX, fBufY;  // Per-event values to fill (scalar histos)
 
 private:
 
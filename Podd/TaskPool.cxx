@@ -0,0 +1,137 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::TaskPool
+//
+// A fixed set of worker threads that run groups of independent tasks.
+// Run() hands a group of tasks to the workers, takes part in processing
+// them itself, and returns when all of them have finished. The threads
+// are kept between calls, so this is cheap enough to be used for every
+// analysis stage of every event.
+//
+// The tasks are started in the order given, each by the next thread that
+// becomes free, so callers should put the longest tasks first when their
+// cost is known (see THaAnalyzer::OrderConcurrentTasks).
+//
+// If a task throws, the remaining tasks of the group still run, and the
+// first exception is rethrown by Run() in the calling thread.
+//
+// Only one thread may call Run() at a time.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "TaskPool.h"
+#include "ThreadAffinity.h"
+#include <cassert>
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+TaskPool::TaskPool( UInt_t nworkers )
+  : fTasks(nullptr), fNext(0), fPending(0), fStop(false)
+{
+  // Constructor. Starts 'nworkers' threads in addition to the thread that
+  // calls Run().
+
+  fThreads.reserve(nworkers);
+  for( UInt_t i = 0; i < nworkers; ++i )
+    fThreads.emplace_back(&TaskPool::WorkLoop, this);
+}
+
+//_____________________________________________________________________________
+TaskPool::~TaskPool()
+{
+  // Destructor. Stops the worker threads.
+
+  {
+    lock_guard<mutex> lock(fMutex);
+    fStop = true;
+  }
+  fWork.notify_all();
+  for( auto& thr : fThreads )
+    thr.join();
+}
+
+//_____________________________________________________________________________
+void TaskPool::Execute( unique_lock<mutex>& lock )
+{
+  // Run tasks of the current group until none are left to start.
+  // Must be called with 'lock' held.
+
+  while( fTasks && fNext < fTasks->size() ) {
+    const Task_t& task = (*fTasks)[fNext++];
+    lock.unlock();
+    exception_ptr err;
+    try {
+      task();
+    }
+    catch( ... ) {
+      err = current_exception();
+    }
+    lock.lock();
+    if( err && !fError )
+      fError = err;
+    assert( fPending > 0 );
+    if( --fPending == 0 )
+      fDone.notify_all();
+  }
+}
+
+//_____________________________________________________________________________
+void TaskPool::Run( const vector<Task_t>& tasks )
+{
+  // Run all 'tasks' concurrently and wait for them to finish
+
+  if( tasks.empty() )
+    return;
+  if( fThreads.empty() || tasks.size() == 1 ) {
+    for( const auto& task : tasks )
+      task();
+    return;
+  }
+  unique_lock<mutex> lock(fMutex);
+  fTasks = &tasks;
+  fNext = 0;
+  fPending = tasks.size();
+  fError = nullptr;
+  fWork.notify_all();
+  Execute(lock);
+  fDone.wait(lock, [this]{ return fPending == 0; });
+  fTasks = nullptr;
+  exception_ptr err = fError;
+  fError = nullptr;
+  lock.unlock();
+  if( err )
+    rethrow_exception(err);
+}
+
+//_____________________________________________________________________________
+Int_t TaskPool::SetCpuAffinity( const vector<UInt_t>& cpus )
+{
+  // Restrict the worker threads to the given CPUs (see ThreadAffinity.h)
+
+  Int_t err = 0;
+  for( auto& thr : fThreads ) {
+    if( SetThreadAffinity(thr, cpus) != 0 )
+      err = -1;
+  }
+  return err;
+}
+
+//_____________________________________________________________________________
+void TaskPool::WorkLoop()
+{
+  // Main loop of the worker threads
+
+  unique_lock<mutex> lock(fMutex);
+  while( true ) {
+    fWork.wait(lock, [this]{
+      return fStop || (fTasks && fNext < fTasks->size()); });
+    if( fStop )
+      return;
+    Execute(lock);
+  }
+}
+
+} // namespace Podd
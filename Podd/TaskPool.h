@@ -0,0 +1,54 @@
+#ifndef Podd_TaskPool_h_
+#define Podd_TaskPool_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::TaskPool
+//
+// Persistent worker threads for running groups of independent tasks
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+namespace Podd {
+
+class TaskPool {
+
+public:
+  typedef std::function<void()> Task_t;
+
+  explicit TaskPool( UInt_t nworkers );
+  TaskPool( const TaskPool& ) = delete;
+  TaskPool& operator=( const TaskPool& ) = delete;
+  ~TaskPool();
+
+  void   Run( const std::vector<Task_t>& tasks );
+  UInt_t GetNWorkers() const { return static_cast<UInt_t>(fThreads.size()); }
+  Int_t  SetCpuAffinity( const std::vector<UInt_t>& cpus );
+
+private:
+  const std::vector<Task_t>* fTasks;   // Current group of tasks
+  size_t                     fNext;    // Next task to start
+  size_t                     fPending; // Tasks not yet finished
+  std::exception_ptr         fError;   // First exception thrown by a task
+  Bool_t                     fStop;    // Request to stop worker threads
+
+  std::vector<std::thread>   fThreads;
+  std::mutex                 fMutex;
+  std::condition_variable    fWork;
+  std::condition_variable    fDone;
+
+  void Execute( std::unique_lock<std::mutex>& lock );
+  void WorkLoop();
+};
+
+} // namespace Podd
+
+#endif
@@ -0,0 +1,130 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::ThreadAffinity
+//
+// CPU affinity of analysis threads (see THaAnalyzer::SetCpuAffinity).
+// Memory is allocated on the NUMA node of the thread that first touches
+// it, and glibc's malloc gives each thread its own arena, so keeping the
+// event loop, the read-ahead thread and the task pool workers on the
+// cores of one socket keeps the decoder buffers and module data they
+// allocate in that socket's memory. Only supported on Linux; elsewhere
+// the functions report an error and do nothing.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "ThreadAffinity.h"
+#include "TError.h"
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+Int_t ParseCpuList( const char* spec, CpuSet_t& cpus )
+{
+  // Parse 'spec' into 'cpus'. 'spec' can be a comma-separated list of CPU
+  // numbers and ranges, as in /sys/devices/system/node/node0/cpulist,
+  // or "node<N>" for the CPUs of NUMA node N.
+
+  cpus.clear();
+  if( !spec || !*spec )
+    return -1;
+  string list(spec);
+  if( list.compare(0, 4, "node") == 0 ) {
+    string fname = "/sys/devices/system/node/" + list + "/cpulist";
+    ifstream ifs(fname);
+    if( !ifs || !getline(ifs, list) ) {
+      ::Error( "ParseCpuList", "Cannot read CPUs of NUMA node %s from %s",
+               spec + 4, fname.c_str() );
+      return -1;
+    }
+  }
+  istringstream is(list);
+  string item;
+  while( getline(is, item, ',') ) {
+    if( item.empty() )
+      continue;
+    char* end = nullptr;
+    unsigned long lo = strtoul(item.c_str(), &end, 10), hi = lo;
+    if( *end == '-' )
+      hi = strtoul(end + 1, &end, 10);
+    if( end == item.c_str() || (*end && *end != '\n') || hi < lo ) {
+      ::Error( "ParseCpuList", "Invalid CPU list \"%s\"", spec );
+      cpus.clear();
+      return -1;
+    }
+    for( unsigned long c = lo; c <= hi; ++c )
+      cpus.push_back(c);
+  }
+  return cpus.empty() ? -1 : 0;
+}
+
+#ifdef __linux__
+//_____________________________________________________________________________
+static Int_t SetAffinity( pthread_t thr, const CpuSet_t& cpus )
+{
+  if( cpus.empty() )
+    return 0;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for( auto c : cpus ) {
+    if( c < CPU_SETSIZE )
+      CPU_SET(c, &set);
+  }
+  Int_t err = pthread_setaffinity_np(thr, sizeof(set), &set);
+  if( err ) {
+    ::Error( "SetThreadAffinity", "Cannot set CPU affinity: %s",
+             strerror(err) );
+    return -1;
+  }
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t SetThreadAffinity( const CpuSet_t& cpus )
+{
+  return SetAffinity(pthread_self(), cpus);
+}
+
+//_____________________________________________________________________________
+Int_t SetThreadAffinity( std::thread& thr, const CpuSet_t& cpus )
+{
+  if( !thr.joinable() )
+    return -1;
+  return SetAffinity(thr.native_handle(), cpus);
+}
+
+#else
+//_____________________________________________________________________________
+static Int_t NotSupported( const CpuSet_t& cpus )
+{
+  if( cpus.empty() )
+    return 0;
+  ::Error( "SetThreadAffinity", "CPU affinity is not supported on this "
+           "platform" );
+  return -1;
+}
+
+//_____________________________________________________________________________
+Int_t SetThreadAffinity( const CpuSet_t& cpus )
+{
+  return NotSupported(cpus);
+}
+
+//_____________________________________________________________________________
+Int_t SetThreadAffinity( std::thread&, const CpuSet_t& cpus )
+{
+  return NotSupported(cpus);
+}
+#endif
+
+} // namespace Podd
@@ -0,0 +1,32 @@
+#ifndef Podd_ThreadAffinity_h_
+#define Podd_ThreadAffinity_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::ThreadAffinity
+//
+// Functions for restricting analysis threads to a set of CPUs, e.g. the
+// cores of one socket of a multi-socket machine
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <vector>
+#include <thread>
+
+namespace Podd {
+
+  typedef std::vector<UInt_t> CpuSet_t;
+
+  // Parse a CPU list like "0-7,16-23", or "node<N>" for the CPUs of NUMA
+  // node N. Returns 0 on success.
+  Int_t ParseCpuList( const char* spec, CpuSet_t& cpus );
+
+  // Restrict the calling thread, or the given thread, to 'cpus'.
+  // Returns 0 on success. An empty set is a no-op.
+  Int_t SetThreadAffinity( const CpuSet_t& cpus );
+  Int_t SetThreadAffinity( std::thread& thr, const CpuSet_t& cpus );
+
+} // namespace Podd
+
+#endif
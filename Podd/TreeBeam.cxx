@@ -0,0 +1,78 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::TreeBeam
+//
+// Beam apparatus for second-pass replays with Podd::OutputTreeRun.
+// Takes the beam position and direction of each event from the beam
+// variables of the previous replay (<prefix>x, y, z, dir.x, dir.y, dir.z),
+// as defined by all THaBeam-derived classes. The beam must have the same
+// name as in the previous replay. If the variables are missing, the
+// beam is at the origin along the z-axis, as with THaIdealBeam.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "TreeBeam.h"
+#include "OutputTreeDecoder.h"
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+TreeBeam::TreeBeam( const char* name, const char* description )
+  : THaBeam(name, description), fHaveData(false)
+{
+  // Constructor
+
+  fDirection.SetXYZ(0.0,0.0,1.0);
+}
+
+//_____________________________________________________________________________
+TreeBeam::TreeBeam()
+  : THaBeam("", ""), fHaveData(false)
+{
+  // Default constructor (for ROOT I/O)
+}
+
+//_____________________________________________________________________________
+Int_t TreeBeam::Decode( const THaEvData& evdata )
+{
+  // Get the beam position and direction of the current event
+
+  fHaveData = false;
+  const auto* dec = dynamic_cast<const OutputTreeDecoder*>(&evdata);
+  if( !dec )
+    return 0;
+
+  static const char* const names[] = { "x", "y", "z", "dir.x", "dir.y", "dir.z" };
+  Double_t val[6];
+  string prefix(GetPrefix());
+  for( Int_t k = 0; k < 6; ++k ) {
+    const auto* col = dec->GetColumn(prefix + names[k]);
+    if( !col )
+      return 0;
+    val[k] = col->At(0);
+  }
+  fPosition.SetXYZ( val[0], val[1], val[2] );
+  fDirection.SetXYZ( val[3], val[4], val[5] );
+  fHaveData = true;
+
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t TreeBeam::Reconstruct()
+{
+  // Copy the beam data to the beam info variables
+
+  if( !fHaveData ) {
+    fPosition.SetXYZ(0.0,0.0,0.0);
+    fDirection.SetXYZ(0.0,0.0,1.0);
+  }
+  Update();
+  return 0;
+}
+
+} // namespace Podd
+
+ClassImp(Podd::TreeBeam)
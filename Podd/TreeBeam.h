@@ -0,0 +1,32 @@
+#ifndef Podd_TreeBeam_h_
+#define Podd_TreeBeam_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::TreeBeam
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "THaBeam.h"
+
+namespace Podd {
+
+class TreeBeam : public THaBeam {
+
+public:
+  TreeBeam( const char* name, const char* description );
+  TreeBeam();
+  virtual ~TreeBeam() = default;
+
+  virtual Int_t   Decode( const THaEvData& evdata );
+  virtual Int_t   Reconstruct();
+
+protected:
+  Bool_t  fHaveData;  // Beam data found in current event
+
+  ClassDef(TreeBeam,0)  // Beam restored from an analysis output tree
+};
+
+} // namespace Podd
+
+#endif
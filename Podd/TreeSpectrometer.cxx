@@ -0,0 +1,138 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::TreeSpectrometer
+//
+// Spectrometer without detectors for second-pass replays of the output
+// tree of a previous replay with Podd::OutputTreeRun and
+// Podd::OutputTreeDecoder. In Decode(), the tracks are recreated from
+// the standard spectrometer track variables in the tree (<prefix>tr.x,
+// tr.y, tr.th, tr.ph, tr.p, tr.tg_*, tr.d_*, tr.r_*, tr.chi2, tr.pathl,
+// tr.time, tr.beta etc.). Missing variables are left undefined (kBig).
+// The lab momentum vectors are recalculated from the spectrometer angles
+// in the run database.
+//
+// The golden track is the one given by <prefix>gold.index (the usual
+// THaGoldenTrack module), if present, else the first track, which is
+// the golden track of THaHRS with default settings.
+//
+// The spectrometer must have the same name as in the previous replay.
+// Physics modules, e.g. THaPrimaryKine, THaExtTarCor or
+// THaReactionPoint, can then be run on these tracks as usual.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "TreeSpectrometer.h"
+#include "OutputTreeDecoder.h"
+#include "THaTrack.h"
+#include "TClonesArray.h"
+#include "TVector3.h"
+
+using namespace std;
+
+namespace Podd {
+
+// Names of the restored track variables, in the order of EColumn
+static const char* const kColumnName[] = {
+  "tr.x", "tr.y", "tr.th", "tr.ph", "tr.p", "tr.flag", "tr.chi2", "tr.ndof",
+  "tr.d_x", "tr.d_y", "tr.d_th", "tr.d_ph",
+  "tr.r_x", "tr.r_y", "tr.r_th", "tr.r_ph",
+  "tr.tg_y", "tr.tg_th", "tr.tg_ph", "tr.tg_dp",
+  "tr.vx", "tr.vy", "tr.vz",
+  "tr.pathl", "tr.time", "tr.dtime", "tr.beta", "tr.dbeta",
+  "gold.index"
+};
+
+//_____________________________________________________________________________
+TreeSpectrometer::TreeSpectrometer( const char* name, const char* description )
+  : THaSpectrometer(name, description), fGoldIndex(0)
+{
+  // Constructor
+}
+
+//_____________________________________________________________________________
+TreeSpectrometer::TreeSpectrometer()
+  : THaSpectrometer("", ""), fGoldIndex(0)
+{
+  // Default constructor (for ROOT I/O)
+}
+
+//_____________________________________________________________________________
+Int_t TreeSpectrometer::Decode( const THaEvData& evdata )
+{
+  // Recreate the tracks of the current event from the input tree.
+  // Returns the number of tracks.
+
+  static_assert( sizeof(kColumnName)/sizeof(kColumnName[0]) == kNColumns,
+                 "Column name list inconsistent with EColumn" );
+
+  const auto* dec = dynamic_cast<const OutputTreeDecoder*>(&evdata);
+  if( !dec )
+    return 0;
+
+  if( fColNames.empty() ) {
+    for( const char* name : kColumnName )
+      fColNames.push_back(string(GetPrefix()) + name);
+  }
+  const OutputTreeEvent::Column_t* col[kNColumns];
+  for( Int_t k = 0; k < kNColumns; ++k )
+    col[k] = dec->GetColumn(fColNames[k]);
+  if( !col[kX] )
+    return 0;
+
+  auto get = [&col]( Int_t k, size_t i ) -> Double_t {
+    return col[k] ? col[k]->At(i) : kBig;
+  };
+
+  size_t ntr = col[kX]->val.size();
+  for( size_t i = 0; i < ntr; ++i ) {
+    auto* tr = new( (*fTracks)[i] )
+      THaTrack(get(kX,i), get(kY,i), get(kTh,i), get(kPh,i));
+    tr->SetD(get(kDX,i), get(kDY,i), get(kDTh,i), get(kDPh,i));
+    tr->SetR(get(kRX,i), get(kRY,i), get(kRTh,i), get(kRPh,i));
+    tr->SetTarget(0.0, get(kTgY,i), get(kTgTh,i), get(kTgPh,i));
+    tr->SetDp(get(kTgDp,i));
+    tr->SetMomentum(get(kP,i));
+    tr->SetChi2(get(kChi2,i), col[kNDoF] ? static_cast<Int_t>(get(kNDoF,i)) : 0);
+    if( col[kFlag] )
+      tr->SetFlag(static_cast<UInt_t>(get(kFlag,i)));
+    if( col[kVx] && col[kVy] && col[kVz] )
+      tr->SetVertex(get(kVx,i), get(kVy,i), get(kVz,i));
+    tr->SetPathLen(get(kPathl,i));
+    tr->SetTime(get(kTime,i));
+    tr->SetdTime(get(kdTime,i));
+    tr->SetBeta(get(kBeta,i));
+    tr->SetdBeta(get(kdBeta,i));
+    tr->SetIndex(static_cast<Int_t>(i));
+    if( tr->GetP() < kBig ) {
+      TVector3 pvect;
+      TrackToLab(*tr, pvect);
+      tr->SetPvect(pvect);
+    }
+  }
+  fGoldIndex = col[kGold] ? static_cast<Int_t>(col[kGold]->At(0, 0)) : 0;
+
+  return static_cast<Int_t>(ntr);
+}
+
+//_____________________________________________________________________________
+Int_t TreeSpectrometer::FindVertices( TClonesArray& /* tracks */ )
+{
+  // The target coordinates were restored with the tracks. Only set the
+  // golden track.
+
+  Int_t ntr = GetNTracks();
+  if( ntr > 0 ) {
+    if( fGoldIndex < 0 || fGoldIndex >= ntr )
+      fGoldIndex = 0;
+    fGoldenTrack = static_cast<THaTrack*>( fTracks->At(fGoldIndex) );
+    fTrkIfo      = *fGoldenTrack;
+    fTrk         = fGoldenTrack;
+  } else
+    fGoldenTrack = nullptr;
+
+  return 0;
+}
+
+} // namespace Podd
+
+ClassImp(Podd::TreeSpectrometer)
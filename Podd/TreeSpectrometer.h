@@ -0,0 +1,45 @@
+#ifndef Podd_TreeSpectrometer_h_
+#define Podd_TreeSpectrometer_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::TreeSpectrometer
+//
+// Spectrometer whose tracks are restored from the output tree of a
+// previous replay (see Podd::OutputTreeRun).
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "THaSpectrometer.h"
+#include <string>
+#include <vector>
+
+namespace Podd {
+
+class TreeSpectrometer : public THaSpectrometer {
+
+public:
+  TreeSpectrometer( const char* name, const char* description );
+  TreeSpectrometer();  // for ROOT I/O
+  virtual ~TreeSpectrometer() = default;
+
+  virtual Int_t   Decode( const THaEvData& evdata );
+  virtual Int_t   FindVertices( TClonesArray& tracks );
+  virtual Int_t   TrackCalc() { return 0; }
+
+protected:
+  // Track quantities restored from the tree, in the order of fColNames
+  enum EColumn { kX, kY, kTh, kPh, kP, kFlag, kChi2, kNDoF,
+                 kDX, kDY, kDTh, kDPh, kRX, kRY, kRTh, kRPh,
+                 kTgY, kTgTh, kTgPh, kTgDp, kVx, kVy, kVz,
+                 kPathl, kTime, kdTime, kBeta, kdBeta, kGold, kNColumns };
+
+  std::vector<std::string> fColNames;   // Column names, e.g. "R.tr.x"
+  Int_t                    fGoldIndex;  // Golden track index in this event
+
+  ClassDef(TreeSpectrometer,0)  // Spectrometer with tracks from an output tree
+};
+
+} // namespace Podd
+
+#endif
@@ -0,0 +1,115 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::TreeVariables
+//
+// Physics module for second-pass replays with Podd::OutputTreeRun.
+// Defines a global variable for each branch of the input tree (or each
+// branch matching the optional wildcard 'pattern') that is not already
+// defined by another module, e.g. by a Podd::TreeSpectrometer. The
+// variables refer directly to the values read by the run object, so
+// they can be used in cuts, histograms and the output of the second pass
+// without running the modules that originally computed them.
+//
+// Add this module after all other modules so that their own variables
+// take precedence. All values are Double_t; arrays are variable-size.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "TreeVariables.h"
+#include "OutputTreeRun.h"
+#include "THaVarList.h"
+#include "TRegexp.h"
+#include "TString.h"
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+TreeVariables::TreeVariables( const char* name, const char* description,
+                              const char* pattern )
+  : THaPhysicsModule(name, description), fPattern(pattern ? pattern : "")
+{
+  // Constructor
+}
+
+//_____________________________________________________________________________
+TreeVariables::TreeVariables()
+  : THaPhysicsModule("", "")
+{
+  // Default constructor (for ROOT I/O)
+}
+
+//_____________________________________________________________________________
+TreeVariables::~TreeVariables()
+{
+  // Destructor
+
+  RemoveVariables();
+}
+
+//_____________________________________________________________________________
+THaAnalysisObject::EStatus TreeVariables::Init( const TDatime& run_time )
+{
+  // Initialize. The variables are redefined for every run since they
+  // point into the current run object.
+
+  RemoveVariables();
+  if( THaPhysicsModule::Init(run_time) )
+    return fStatus;
+
+  return fStatus = kOK;
+}
+
+//_____________________________________________________________________________
+Int_t TreeVariables::DefineVariables( EMode mode )
+{
+  // Define/delete the global variables for the columns of the input tree
+
+  THaVarList* vars = GetVarList();
+  if( !vars )
+    return kInitError;
+
+  if( mode == kDelete ) {
+    for( const auto& name : fDefined )
+      vars->RemoveName(name.c_str());
+    fDefined.clear();
+    return kOK;
+  }
+
+  auto* run = dynamic_cast<OutputTreeRun*>(GetCurrentRun());
+  if( !run ) {
+    Error( Here("DefineVariables"), "Current run is not an OutputTreeRun. "
+           "Cannot define variables." );
+    return kInitError;
+  }
+  if( run->SetupColumns() < 0 )
+    return kInitError;
+
+  TRegexp re(fPattern.c_str(), true);
+  for( const auto& col : run->GetEvent().columns ) {
+    const char* name = col->name.c_str();
+    if( !fPattern.empty() ) {
+      TString s(name);
+      Ssiz_t len = 0;
+      if( s.Index(re, &len) != 0 || len != s.Length() )
+        continue;
+    }
+    if( vars->Find(name) )
+      continue;
+    THaVar* var = col->scalar
+      ? vars->Define(name, name, col->val[0])
+      : vars->Define(name, name, col->val);
+    if( var )
+      fDefined.push_back(col->name);
+  }
+  if( fDebug > 0 )
+    Info( Here("DefineVariables"), "Defined %lu variables from input tree",
+          static_cast<unsigned long>(fDefined.size()) );
+
+  return kOK;
+}
+
+} // namespace Podd
+
+ClassImp(Podd::TreeVariables)
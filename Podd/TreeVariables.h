@@ -0,0 +1,38 @@
+#ifndef Podd_TreeVariables_h_
+#define Podd_TreeVariables_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::TreeVariables
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "THaPhysicsModule.h"
+#include <string>
+#include <vector>
+
+namespace Podd {
+
+class TreeVariables : public THaPhysicsModule {
+
+public:
+  TreeVariables( const char* name, const char* description,
+                 const char* pattern = "" );
+  TreeVariables();
+  virtual ~TreeVariables();
+
+  virtual EStatus Init( const TDatime& run_time );
+  virtual Int_t   Process( const THaEvData& ) { return 0; }
+
+protected:
+  std::string               fPattern;  // Wildcard for branches to export
+  std::vector<std::string>  fDefined;  // Names of the variables we defined
+
+  virtual Int_t   DefineVariables( EMode mode = kDefine );
+
+  ClassDef(TreeVariables,0)  // Export input tree branches as global variables
+};
+
+} // namespace Podd
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef Podd_VarView_h_
+#define Podd_VarView_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::VarView, Podd::VarReader
+//
+// Strided view of the data of a global variable and typed readers
+// for such views.
+//
+// A VarView describes the current data of a variable as 'len' elements
+// of basic type 'type', starting at 'base' and spaced 'stride' bytes
+// apart. Views are available for scalars, fixed and variable-size arrays,
+// pointer arrays, std::vectors of basic types and data members of objects
+// held by value in std::vectors. Variables whose data are obtained via
+// method calls or are scattered in memory (TSeqCollections, arrays of
+// pointers) do not provide views.
+//
+// The base pointer and length may change from event to event, so views
+// must be obtained anew for each event (THaVar::GetView). The element
+// type is fixed, so a VarReader can be set up once when attaching to
+// the variable. It converts elements to type T without a per-element
+// type switch or range check.
+//
+//   Podd::VarReader<Double_t> reader(var->GetType());  // once
+//   Podd::VarView view;                                // every event
+//   if( reader.IsValid() && var->GetView(view) )
+//     reader.Read(view, buffer, view.len);
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include "VarType.h"
+#include <cstddef>
+
+namespace Podd {
+
+//_____________________________________________________________________________
+// Basic element type of scalars, arrays, pointers and vectors of type
+// 'type', or kVarTypeEnd if there is none
+inline VarType ElementType( VarType type )
+{
+  if( type >= kDouble && type <= kUChar )
+    return type;
+  if( type >= kDoubleP && type <= kUCharP )
+    return static_cast<VarType>(kDouble + (type - kDoubleP));
+  if( type >= kDouble2P && type <= kUChar2P )
+    return static_cast<VarType>(kDouble + (type - kDouble2P));
+  switch( type ) {
+  case kIntV:    return kInt;
+  case kUIntV:   return kUInt;
+  case kFloatV:  return kFloat;
+  case kDoubleV: return kDouble;
+  default:       break;
+  }
+  return kVarTypeEnd;
+}
+
+//_____________________________________________________________________________
+// VarType of basic type T
+template< typename T > struct VarTypeOf {
+  static constexpr VarType kType = kVarTypeEnd;
+};
+#define PODD_VARTYPEOF(T,t)                                  \
+  template<> struct VarTypeOf<T> { static constexpr VarType kType = t; };
+PODD_VARTYPEOF(Double_t,  kDouble)
+PODD_VARTYPEOF(Float_t,   kFloat)
+PODD_VARTYPEOF(Long64_t,  kLong)
+PODD_VARTYPEOF(ULong64_t, kULong)
+PODD_VARTYPEOF(Int_t,     kInt)
+PODD_VARTYPEOF(UInt_t,    kUInt)
+PODD_VARTYPEOF(Short_t,   kShort)
+PODD_VARTYPEOF(UShort_t,  kUShort)
+PODD_VARTYPEOF(Char_t,    kChar)
+PODD_VARTYPEOF(UChar_t,   kUChar)
+#undef PODD_VARTYPEOF
+
+//_____________________________________________________________________________
+struct VarView {
+  VarView() : base(nullptr), stride(0), len(0), type(kVarTypeEnd) {}
+
+  const char* base;    // Address of first element
+  size_t      stride;  // Distance between elements (bytes)
+  Int_t       len;     // Number of elements
+  VarType     type;    // Basic type of the elements (kDouble ... kUChar)
+
+  Bool_t      IsContiguous() const
+  { return len <= 1 || stride == Vars::GetTypeSize(type); }
+};
+
+//_____________________________________________________________________________
+template< typename T >
+class VarReader {
+
+public:
+  VarReader() : fType(kVarTypeEnd), fElem(nullptr), fBulk(nullptr) {}
+  explicit VarReader( VarType type ) : VarReader() { Init(type); }
+
+  // Set up reader for elements of variables of type 'type'
+  Bool_t   Init( VarType type );
+  Bool_t   IsValid() const { return fElem != nullptr; }
+  VarType  GetType() const { return fType; }
+
+  // Read element i of 'view'. 'view' must have the type given to Init.
+  T        operator()( const VarView& view, Int_t i ) const
+  { return fElem(view.base + i*view.stride); }
+  // Read the first 'n' elements of 'view' into 'out'
+  void     Read( const VarView& view, T* out, Int_t n ) const
+  { fBulk(view, out, n); }
+
+private:
+  typedef T    (*Elem_t)( const char* loc );
+  typedef void (*Bulk_t)( const VarView& view, T* out, Int_t n );
+
+  VarType  fType;   // Element type
+  Elem_t   fElem;   // Single-element reader for fType
+  Bulk_t   fBulk;   // Multi-element reader for fType
+
+  template< typename S > static T ReadElem( const char* loc )
+  { return static_cast<T>(*reinterpret_cast<const S*>(loc)); }
+
+  template< typename S > static void ReadBulk( const VarView& view, T* out,
+                                               Int_t n ) {
+    const char* loc = view.base;
+    if( view.stride == sizeof(S) ) {
+      const S* src = reinterpret_cast<const S*>(loc);
+      for( Int_t i = 0; i < n; ++i )
+        out[i] = static_cast<T>(src[i]);
+    } else {
+      for( Int_t i = 0; i < n; ++i, loc += view.stride )
+        out[i] = static_cast<T>(*reinterpret_cast<const S*>(loc));
+    }
+  }
+
+  template< typename S > void Set() {
+    fElem = &ReadElem<S>;
+    fBulk = &ReadBulk<S>;
+  }
+};
+
+//_____________________________________________________________________________
+template< typename T >
+Bool_t VarReader<T>::Init( VarType type )
+{
+  // Select the conversion routines for variables of type 'type'. Returns
+  // false if the type has no basic element type.
+
+  fType = ElementType(type);
+  fElem = nullptr;
+  fBulk = nullptr;
+  switch( fType ) {
+  case kDouble: Set<Double_t>();  break;
+  case kFloat:  Set<Float_t>();   break;
+  case kLong:   Set<Long64_t>();  break;
+  case kULong:  Set<ULong64_t>(); break;
+  case kInt:    Set<Int_t>();     break;
+  case kUInt:   Set<UInt_t>();    break;
+  case kShort:  Set<Short_t>();   break;
+  case kUShort: Set<UShort_t>();  break;
+  case kChar:   Set<Char_t>();    break;
+  case kUChar:  Set<UChar_t>();   break;
+  default:
+    fType = kVarTypeEnd;
+    return false;
+  }
+  return true;
+}
+
+} // namespace Podd
+
+#endif
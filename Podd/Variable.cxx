@@ -21,9 +21,12 @@ using namespace std;
 
 namespace Podd {
 
+UInt_t Variable::fgGeneration = 1;
+Bool_t Variable::fgLenCache = false;
+
 //_____________________________________________________________________________
 Variable::Variable( THaVar* pvar, const void* addr, VarType type )
-  : fSelf(pvar), fValueP(addr), fType(type)
+  : fSelf(pvar), fValueP(addr), fType(type), fLen(0), fLenGen(0)
 {
   // Base class constructor
 
@@ -78,6 +81,25 @@ Int_t Variable::GetLen() const
   return 1;
 }
 
+//_____________________________________________________________________________
+Int_t Variable::ComputeLen() const
+{
+  // Compute the current number of elements. Called via CachedLen() by
+  // variable types with data-dependent sizes.
+
+  return 1;
+}
+
+//_____________________________________________________________________________
+void Variable::SetLenCache( Bool_t enable )
+{
+  // Enable/disable caching of array lengths. Enabling starts a new
+  // generation, so nothing cached earlier is used.
+
+  fgLenCache = enable;
+  NewEvent();
+}
+
 //_____________________________________________________________________________
 Int_t Variable::GetNdim() const
 {
@@ -97,11 +119,15 @@ const Int_t* Variable::GetDim() const
 //_____________________________________________________________________________
 std::vector<Double_t> Variable::GetValues() const
 {
+  // Return all elements of the variable as doubles. Use
+  // GetValues(out,cap) to avoid allocating a new vector for every call.
+
   std::vector<Double_t> res;
-  res.reserve(GetLen() );
-  for(int i = 0 ; i < GetLen(); i++) {
-    res.push_back(GetValue(i));
-  }
+  Int_t len = GetLen();
+  if( len <= 0 )
+    return res;
+  res.resize(len);
+  res.resize( GetValues(res.data(), res.size()) );
   return res;
 }
 
@@ -331,6 +357,28 @@ size_t Variable::GetData( void* buf ) const
   return nbytes;
 }
 
+//_____________________________________________________________________________
+Bool_t Variable::GetView( VarView& view ) const
+{
+  // Describe the current data as a strided view (see VarView.h).
+  // Returns false if the data cannot be described this way.
+
+  if( !fValueP || !IsBasic() )
+    return false;
+
+  if( fType >= kDouble && fType <= kUChar )
+    view.base = static_cast<const char*>(fValueP);
+  else if( fType >= kDoubleP && fType <= kUCharP )
+    view.base = *reinterpret_cast<const char* const *>(fValueP);
+  else
+    return false;
+
+  view.type = ElementType(fType);
+  view.stride = Vars::GetTypeSize(view.type);
+  view.len = view.base ? GetLen() : 0;
+  return view.len >= 0;
+}
+
 //_____________________________________________________________________________
 size_t Variable::GetData( void* buf, Int_t i ) const
 {
@@ -11,6 +11,11 @@
 
 #include "Rtypes.h"
 #include "VarType.h"
+#include "VarView.h"
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
 
 class THaVar;
 class THaArrayString;
@@ -29,6 +34,8 @@ namespace Podd {
             VarType      GetType() const { return fType; }
 
     virtual std::vector<Double_t>     GetValues() const;
+    template< typename T >
+            size_t       GetValues( T* out, size_t cap ) const;
     virtual Double_t     GetValue( Int_t i = 0 ) const;
     virtual Long64_t     GetValueInt( Int_t i = 0 ) const;
 
@@ -36,6 +43,7 @@ namespace Podd {
     virtual const void*  GetDataPointer( Int_t i = 0 ) const;
     virtual size_t       GetData( void* buf ) const;
     virtual size_t       GetData( void* buf, Int_t i ) const;
+    virtual Bool_t       GetView( VarView& view ) const;
 
     virtual Bool_t       HasSameSize( const Variable& rhs ) const;
     virtual Bool_t       HasSizeVar() const;
@@ -55,10 +63,34 @@ namespace Podd {
     virtual void         SetName( const char* name );
     virtual void         SetNameTitle( const char* name, const char* descript );
 
+    // Per-event caching of array lengths. While enabled, the lengths of
+    // variable-size arrays are computed at most once per generation.
+    // NewEvent() must be called whenever the data may have changed.
+    static  void         NewEvent() { if( ++fgGeneration == 0 ) ++fgGeneration; }
+    static  void         SetLenCache( Bool_t enable = true );
+    static  Bool_t       IsLenCache() { return fgLenCache; }
+
   protected:
     THaVar*              fSelf;     //Back-pointer to parent (containing name & description)
     const void*          fValueP;   //Pointer to data (interpretation depends on fType)
     VarType              fType;     //Data type (see VarType.h)
+    mutable Int_t        fLen;      //Cached number of elements
+    mutable UInt_t       fLenGen;   //Generation of fLen (0 = none)
+
+    static UInt_t        fgGeneration; // Current event generation
+    static Bool_t        fgLenCache;   // Length caching enabled
+
+    // Number of elements, cached via ComputeLen() if enabled
+    Int_t                CachedLen() const {
+      if( !fgLenCache )
+        return ComputeLen();
+      if( fLenGen != fgGeneration ) {
+        fLen = ComputeLen();
+        fLenGen = fgGeneration;
+      }
+      return fLen;
+    }
+    virtual Int_t        ComputeLen() const;
 
     const char*          GetName() const;
     size_t               GetTypeSize() const;
@@ -67,6 +99,40 @@ namespace Podd {
 
   };
 
+//_____________________________________________________________________________
+template< typename T >
+size_t Variable::GetValues( T* out, size_t cap ) const
+{
+  // Copy up to 'cap' elements of the variable, converted to type T, into
+  // the caller's buffer 'out'. Returns the number of elements copied.
+  // Contiguous data of type T are copied with memcpy.
+
+  VarView view;
+  if( GetView(view) ) {
+    size_t n = std::min(cap, static_cast<size_t>(view.len));
+    if( n == 0 )
+      return 0;
+    if( view.type == VarTypeOf<T>::kType && view.IsContiguous() )
+      memcpy( out, view.base, n*sizeof(T) );
+    else
+      VarReader<T>(view.type).Read(view, out, static_cast<Int_t>(n));
+    return n;
+  }
+
+  // No direct view of the data (method calls, collections etc.)
+  Int_t len = GetLen();
+  if( len <= 0 )
+    return 0;
+  size_t n = std::min(cap, static_cast<size_t>(len));
+  Bool_t use_int = !IsFloat() && !std::is_floating_point<T>::value;
+  for( size_t i = 0; i < n; ++i ) {
+    auto k = static_cast<Int_t>(i);
+    out[i] = use_int ? static_cast<T>(GetValueInt(k))
+                     : static_cast<T>(GetValue(k));
+  }
+  return n;
+}
+
 } //namespace Podd
 
 #endif
@@ -37,6 +37,14 @@ Int_t VariableArrayVar::GetLen() const
 {
   // Get number of elements of the variable
 
+  return CachedLen();
+}
+
+//_____________________________________________________________________________
+Int_t VariableArrayVar::ComputeLen() const
+{
+  // Get current value of the size variable
+
   if( !fCount )
     return 0;
   return *fCount;
@@ -31,6 +31,8 @@ namespace Podd {
 
   protected:
     const Int_t*         fCount;    //Pointer to array size variable
+
+    virtual Int_t        ComputeLen() const;
   };
 
 }// namespace Podd
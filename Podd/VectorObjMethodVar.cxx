@@ -17,10 +17,11 @@ namespace Podd {
 
 //_____________________________________________________________________________
 VectorObjMethodVar::VectorObjMethodVar( THaVar* pvar, const void* addr,
-	VarType type, Int_t elem_size, TMethodCall* method )
+	VarType type, Int_t elem_size, TMethodCall* method,
+	const MethodAccessor* acc )
   : Variable(pvar,addr,type),
     SeqCollectionVar(pvar,addr,type,0),
-    MethodVar(pvar,addr,type,method),
+    MethodVar(pvar,addr,type,method,acc),
     VectorObjVar(pvar,addr,type,elem_size,0)
 {
   // Constructor
@@ -40,6 +41,14 @@ const void* VectorObjMethodVar::GetDataPointer( Int_t i ) const
   return MethodVar::GetDataPointer(obj);
 }
 
+//_____________________________________________________________________________
+Bool_t VectorObjMethodVar::GetView( VarView& ) const
+{
+  // Method call results are not stored in the objects, so there is no view
+
+  return false;
+}
+
 //_____________________________________________________________________________
 Bool_t VectorObjMethodVar::IsBasic() const
 {
@@ -19,9 +19,11 @@ namespace Podd {
 
   public:
     VectorObjMethodVar( THaVar* pvar, const void* addr, VarType type,
-			Int_t elem_size, TMethodCall* method );
+			Int_t elem_size, TMethodCall* method,
+			const MethodAccessor* acc = nullptr );
 
     virtual const void*  GetDataPointer( Int_t i = 0 ) const;
+    virtual Bool_t       GetView( VarView& view ) const;
     virtual Bool_t       IsBasic() const;
   };
 
@@ -38,6 +38,14 @@ Int_t VectorObjVar::GetLen() const
 {
   // Get number of elements of the variable
 
+  return CachedLen();
+}
+
+//_____________________________________________________________________________
+Int_t VectorObjVar::ComputeLen() const
+{
+  // Get current number of objects in the vector
+
   assert( fValueP );
 
   const auto *const pvec = reinterpret_cast<const VecType*>( fValueP );
@@ -104,6 +112,31 @@ const void* VectorObjVar::GetDataPointer( Int_t i ) const
   return obj;
 }
 
+//_____________________________________________________________________________
+Bool_t VectorObjVar::GetView( VarView& view ) const
+{
+  // Describe the data members of the objects in the vector as a strided
+  // view. Only possible if the vector holds the objects themselves and the
+  // data member is a basic type.
+
+  assert( fValueP );
+
+  if( fElemSize == 0 || fType < kDouble || fType > kUChar )
+    return false;
+
+  Int_t len = GetLen();
+  if( len == kInvalidInt || len < 0 )
+    return false;
+
+  const VecType& vec = *reinterpret_cast<const VecType*>(fValueP);
+  view.base = (len > 0)
+    ? reinterpret_cast<const char*>(&vec[0]) + fOffset : nullptr;
+  view.stride = fElemSize;
+  view.len = len;
+  view.type = fType;
+  return true;
+}
+
 //_____________________________________________________________________________
 Bool_t VectorObjVar::HasSameSize( const Variable& rhs ) const
 {
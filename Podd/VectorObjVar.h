@@ -21,12 +21,15 @@ namespace Podd {
 
     virtual Int_t        GetLen()  const;
     virtual const void*  GetDataPointer( Int_t i = 0 ) const;
+    virtual Bool_t       GetView( VarView& view ) const;
     virtual Bool_t       HasSameSize( const Variable& rhs ) const;
 
   protected:
     Int_t   fElemSize;  // Size of one vector element. If 0, assume pointers
 			// (This is Int_t, not size_t, because that's what
 			//  TClass::GetClassSize() returns)
+
+    virtual Int_t        ComputeLen() const;
   };
 
 }// namespace Podd
@@ -134,6 +134,25 @@ const void* VectorVar::GetDataPointer( Int_t i ) const
   return nullptr;
 }
 
+//_____________________________________________________________________________
+Bool_t VectorVar::GetView( VarView& view ) const
+{
+  // Describe the current contents of the vector as a strided view
+
+  assert( fValueP && IsVector() );
+
+  view.type = ElementType(fType);
+  if( view.type == kVarTypeEnd )
+    return false;
+  view.stride = Vars::GetTypeSize(view.type);
+  view.len = GetLen();
+  if( view.len < 0 )
+    return false;
+  view.base = (view.len > 0) ? static_cast<const char*>(GetDataPointer(0))
+    : nullptr;
+  return true;
+}
+
 //_____________________________________________________________________________
 Bool_t VectorVar::HasSameSize( const Variable& ) const
 {
@@ -22,6 +22,7 @@ namespace Podd {
     virtual Int_t        GetNdim() const;
     virtual const Int_t* GetDim()  const;
     virtual const void*  GetDataPointer( Int_t i = 0 ) const;
+    virtual Bool_t       GetView( VarView& view ) const;
     virtual Bool_t       HasSameSize( const Variable& rhs ) const;
     virtual Bool_t       IsBasic() const;
     virtual Bool_t       IsContiguous() const;
@@ -0,0 +1,280 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FastDetector                                                              //
+//                                                                           //
+// The same detector as UserDetector, written with the bulk data APIs.       //
+// Use it as the starting point for new detectors that must be fast.         //
+//                                                                           //
+// The differences from UserDetector are:                                    //
+//                                                                           //
+//  - Decode() fetches all hits of a frontend module with one call to        //
+//    THaEvData::GetSlotHits instead of going through the generic            //
+//    THaDetectorBase::Decode, which makes a virtual LoadData/StoreHit call  //
+//    per hit.                                                               //
+//  - Per-event data are kept in one array per quantity, sized once in       //
+//    ReadDatabase. Clear() only resets the hit count.                       //
+//  - Global variables are defined with VarDef, pointing directly at these   //
+//    arrays, instead of with RVarDef, which resolves member names and       //
+//    methods via ROOT's RTTI and reads through it.                          //
+//  - Calibration is applied to all hits of an event at once, in the         //
+//    ProcessHits() batch hook, in a loop the compiler can optimize.         //
+//                                                                           //
+// Not supported here (use THaDetectorBase::Decode if you need them):        //
+// direct hit injection from simulation decoders and the hit cache writer.   //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FastDetector.h"
+#include "VarDef.h"
+#include "THaDetMap.h"
+#include "THaEvData.h"
+#include "TMath.h"
+#include "Helper.h"
+#include <iostream>
+#include <sstream>
+#include <type_traits>
+
+using namespace std;
+using namespace Podd;
+
+// Arbitrary hardcoded limit, as in UserDetector
+static const int MAXCHAN = 100;
+
+//_____________________________________________________________________________
+FastDetector::FastDetector( const char* name, const char* description,
+                            THaApparatus* apparatus )
+  : THaNonTrackingDetector(name, description, apparatus), fNhit(0), fNmulti(0)
+{
+  // Constructor
+}
+
+//_____________________________________________________________________________
+FastDetector::~FastDetector()
+{
+  // Destructor. Remove variables from global list (see UserDetector).
+
+  RemoveVariables();
+}
+
+//_____________________________________________________________________________
+Int_t FastDetector::ReadDatabase( const TDatime& date )
+{
+  // Read the database for this detector. The keys are the same as for
+  // UserDetector. See UserDetector::ReadDatabase for a detailed discussion.
+
+  const char* const here = "ReadDatabase";
+
+  FILE* file = OpenFile( date );
+  if( !file ) return kFileError;
+
+  Int_t nelem = 0;
+  Double_t angle = 0.0;
+  fPed.clear();
+  fGain.clear();
+  vector<Int_t> detmap;
+
+  Int_t err = 0;
+  try {
+    VarType kDataTypeV = std::is_same<Data_t, Float_t>::value ? kFloatV : kDoubleV;
+
+    const DBRequest request[] = {
+      { "detmap",    &detmap, kIntV },
+      { "nelem",     &nelem,  kInt,       0, false, -1},
+      { "angle",     &angle,  kDouble,    0, true },
+      { "pedestals", &fPed,   kDataTypeV, 0, true },
+      { "gains",     &fGain,  kDataTypeV, 0, true },
+      { nullptr }
+    };
+    err = LoadDB( file, date, request );
+
+    if( err == kOK ) {
+      if( FillDetMap( detmap, THaDetMap::kFillLogicalChannel, here ) <= 0 ) {
+        err = kInitError;
+      }
+    }
+  }
+  catch(...) {
+    fclose(file);
+    throw;
+  }
+  fclose(file);
+  if( err != kOK )
+    return err;
+
+  if( nelem <= 0 || nelem > MAXCHAN ) {
+    Error( Here(here), "Illegal number of elements = %d. Must be > 0 and "
+           "<= %d. Fix database.", nelem, MAXCHAN );
+    return kInitError;
+  }
+  // The per-event arrays must not be resized once the global variables
+  // point to them
+  if( fIsInit && nelem != fNelem ) {
+    ostringstream ostr;
+    ostr << "Cannot re-initialize with different number of elements. "
+         << "(was: " << fNelem << ", now: " << nelem << "). "
+         << "Detector not re-initialized.";
+    Error( Here(here), "%s", ostr.str().c_str() );
+    return kInitError;
+  }
+  fNelem = nelem;
+
+  UInt_t nchan = fDetMap->GetTotNumChan(), nval = nelem;
+  if( nchan != nval ) {
+    ostringstream ostr;
+    ostr << "Incorrect number of detector map channels = " << nchan
+         << ". Must equal nelem = " << nval << ". Fix database.";
+    Error( Here(here), "%s", ostr.str().c_str() );
+    return kInitError;
+  }
+  if( (!fPed.empty() && fPed.size() != nval) ||
+      (!fGain.empty() && fGain.size() != nval) ) {
+    ostringstream ostr;
+    ostr << "Incorrect number of pedestal or gain values = "
+         << fPed.size() << ", " << fGain.size()
+         << ". Must match nelem = " << nval << ". Fix database.";
+    Error( Here(here), "%s", ostr.str().c_str() );
+    return kInitError;
+  }
+  if( fPed.empty() )
+    fPed.assign( nelem, 0.0 );
+  if( fGain.empty() )
+    fGain.assign( nelem, 1.0 );
+
+  // Size the per-event arrays for the largest possible event: one hit per
+  // channel. Only done on the first initialization (see above).
+  if( !fIsInit ) {
+    fChannel.assign( nelem, -1 );
+    fRawADC.assign( nelem, kBig );
+    fCalADC.assign( nelem, kBig );
+  }
+
+  const Double_t degrad = TMath::Pi()/180.0;
+  DefineAxes(angle*degrad);
+
+  fIsInit = true;
+
+  return kOK;
+}
+
+//_____________________________________________________________________________
+Int_t FastDetector::DefineVariables( EMode mode )
+{
+  // Define (or delete) global variables of this detector.
+  //
+  // Each variable points directly at the data. Variable-size arrays get
+  // the address of their first element and of the element count.
+  // This is called after ReadDatabase, so the arrays are already sized.
+
+  VarType kDataType = std::is_same<Data_t, Float_t>::value ? kFloat : kDouble;
+
+  VarDef vars[] = {
+    { "nhit",   "Number of hits",                 kInt,      0, &fNhit },
+    { "nmulti", "Channels with multiple hits",    kInt,      0, &fNmulti },
+    { "chan",   "Channel number",                 kInt,      0, fChannel.data(), &fNhit },
+    { "adc",    "Raw ADC value",                  kDataType, 0, fRawADC.data(),  &fNhit },
+    { "adc_c",  "Calibrated ADC",                 kDataType, 0, fCalADC.data(),  &fNhit },
+    { nullptr }
+  };
+  return DefineVarsFromList( vars, mode );
+}
+
+//_____________________________________________________________________________
+void FastDetector::Clear( Option_t* opt )
+{
+  // Reset per-event data. The array contents beyond fNhit are never read,
+  // so only the counters need to be reset.
+
+  THaNonTrackingDetector::Clear(opt);
+  fNhit = fNmulti = 0;
+}
+
+//_____________________________________________________________________________
+Int_t FastDetector::Decode( const THaEvData& evdata )
+{
+  // Decode the hits of this detector in the current event.
+  //
+  // For every frontend module in the detector map, get all hits of the
+  // module at once. The returned view gives the channels hit and,
+  // for each channel, a contiguous span of hit data. It is valid until
+  // the next event is loaded.
+  //
+  // Like THaDetectorBase::Decode, only the first hit of each channel is
+  // used here. Loop over the whole span for multi-hit hardware.
+
+  const Int_t nmax = static_cast<Int_t>(fChannel.size());
+  for( UInt_t imod = 0; imod < fDetMap->GetSize(); ++imod ) {
+    const THaDetMap::Module* d = fDetMap->GetModule(imod);
+    Decoder::SlotHits hits = evdata.GetSlotHits(d->crate, d->slot);
+    for( UInt_t i = 0; i < hits.size(); ++i ) {
+      UInt_t chan = hits.chan(i);
+      if( chan < d->lo || chan > d->hi )
+        continue;  // Not one of our channels
+      if( fNhit == nmax )
+        break;     // Overlapping detector map entries
+      Decoder::HitSpan span = hits.hits(i);
+      if( span.size() > 1 )
+        ++fNmulti;
+      fChannel[fNhit] = d->ConvertToLogicalChannel(chan);
+      fRawADC[fNhit]  = span[0];
+      ++fNhit;
+    }
+  }
+
+  ProcessHits();
+
+  return fNhit;
+}
+
+//_____________________________________________________________________________
+void FastDetector::ProcessHits()
+{
+  // Calibrate all hits of the current event. The loop has no function
+  // calls and no branches, so the compiler can unroll and vectorize it.
+
+  const Int_t*  chan = fChannel.data();
+  const Data_t* raw  = fRawADC.data();
+  const Data_t* ped  = fPed.data();
+  const Data_t* gain = fGain.data();
+  Data_t*       cal  = fCalADC.data();
+  for( Int_t i = 0; i < fNhit; ++i )
+    cal[i] = (raw[i] - ped[chan[i]]) * gain[chan[i]];
+}
+
+//_____________________________________________________________________________
+Int_t FastDetector::CoarseProcess( TClonesArray& /* tracks */ )
+{
+  // Coarse processing. 'tracks' contains coarse tracks.
+
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t FastDetector::FineProcess( TClonesArray& /* tracks */ )
+{
+  // Fine processing. 'tracks' contains final tracking results.
+
+  return 0;
+}
+
+//_____________________________________________________________________________
+void FastDetector::Print( Option_t* opt ) const
+{
+  // Print current configuration and event data
+
+  THaDetector::Print(opt);
+  cout << "detmap = "; fDetMap->Print();
+  cout << "nelem = " << fNelem << endl;
+  cout << "pedestals = "; PrintArray( fPed );
+  cout << "gains = ";     PrintArray( fGain );
+  cout << "nhits = " << fNhit << endl;
+  const vector<Int_t> chan( fChannel.begin(), fChannel.begin() + fNhit );
+  const DataVec_t raw( fRawADC.begin(), fRawADC.begin() + fNhit );
+  const DataVec_t cal( fCalADC.begin(), fCalADC.begin() + fNhit );
+  cout << "channel = "; PrintArray( chan );
+  cout << "rawadc = ";  PrintArray( raw );
+  cout << "coradc = ";  PrintArray( cal );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ClassImp(FastDetector)
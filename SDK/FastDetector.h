@@ -0,0 +1,66 @@
+#ifndef Podd_FastDetector_h_
+#define Podd_FastDetector_h_
+
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FastDetector                                                              //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include "THaNonTrackingDetector.h"
+#include <vector>
+
+class FastDetector : public THaNonTrackingDetector {
+
+public:
+  explicit FastDetector( const char* name, const char* description = "",
+                         THaApparatus* a = nullptr );
+
+  // Default constructor (for ROOT I/O). Basic-type members must be
+  // initialized here because "= default" would leave them undefined.
+  FastDetector() : fNhit(0), fNmulti(0) {}
+
+  virtual ~FastDetector();
+
+  // Public base class functions that one typically overrides
+  // (see comments in FastDetector.cxx for details)
+  virtual void   Clear( Option_t* opt="" );
+  virtual Int_t  Decode( const THaEvData& evdata );
+  virtual Int_t  CoarseProcess( TClonesArray& tracks );
+  virtual Int_t  FineProcess( TClonesArray& tracks );
+  virtual void   Print( Option_t* opt="" ) const;
+
+  Int_t GetNhits() const { return fNhit; }
+
+protected:
+  virtual Int_t  ReadDatabase( const TDatime& date );
+  virtual Int_t  DefineVariables( EMode mode );
+
+  // Batch hook, called once per event by Decode() after all hits have been
+  // collected. Works on whole arrays instead of on one hit at a time.
+  virtual void   ProcessHits();
+
+  //---- Data stored with this detector follow here ----
+
+  typedef std::vector<Data_t> DataVec_t;
+
+  // Calibration data from database
+  DataVec_t fPed;       // ADC pedestals
+  DataVec_t fGain;      // ADC gains
+
+  // Per-event data, one array per quantity ("structure of arrays").
+  // The arrays are sized to fNelem in ReadDatabase and never reallocated,
+  // so the global variables can point directly at them. Only the first
+  // fNhit elements are valid.
+  Int_t              fNhit;     // Number of hits
+  Int_t              fNmulti;   // Channels with more than one hit
+  std::vector<Int_t> fChannel;  // [fNhit] Logical channel number
+  DataVec_t          fRawADC;   // [fNhit] Raw ADC data
+  DataVec_t          fCalADC;   // [fNhit] Calibrated ADC data
+
+  ClassDef(FastDetector,0)   // Example detector using the bulk hit APIs
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
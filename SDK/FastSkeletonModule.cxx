@@ -0,0 +1,98 @@
+/////////////////////////////////////////////////////////////////////
+//
+//   FastSkeletonModule
+//   Example decoder module that loads all data words of a slot
+//   with one call. See the header and SkeletonModule for more advice.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include "FastSkeletonModule.h"
+#include "THaSlotData.h"
+#include <cassert>
+
+using namespace Decoder;
+using namespace std;
+
+// Model number 4445, see SkeletonModule.cxx for the rules
+Module::TypeIter_t FastSkeletonModule::fgThisType =
+  DoRegister( ModuleType( "Decoder::FastSkeletonModule" , 4445 ));
+
+namespace Decoder {
+
+//_____________________________________________________________________________
+FastSkeletonModule::FastSkeletonModule( UInt_t crate, UInt_t slot )
+  : VmeModule(crate, slot), fNumHits(0)
+{
+  fDebugFile = nullptr;
+  FastSkeletonModule::Init();
+}
+
+//_____________________________________________________________________________
+FastSkeletonModule::~FastSkeletonModule() = default;
+
+//_____________________________________________________________________________
+void FastSkeletonModule::Init()
+{
+  VmeModule::Init();
+  fNumChan = 32;
+  fData.resize(fNumChan);
+  fDebugFile = nullptr;
+  Clear();
+  IsInit = true;
+  fName = "Fast Skeleton Module (example)";
+}
+
+//_____________________________________________________________________________
+UInt_t FastSkeletonModule::LoadSlot( THaSlotData* sldat, const UInt_t* evbuffer,
+                                     const UInt_t* pstop )
+{
+  // Load the data of this slot. Same data format as SkeletonModule.
+  //
+  // The number of data words is known from the header, so all of them are
+  // handed to THaSlotData::loadBlock at once. loadBlock checks and grows
+  // the slot's arrays once per block and extracts channel and data with
+  // the constant masks, without a function call per word.
+
+  if( evbuffer + 1 > pstop || evbuffer[1] < 2 )
+    return 0;
+  const UInt_t* p = evbuffer + 3;  // first data word
+  UInt_t nword = evbuffer[1] - 2;
+  if( p > pstop )
+    nword = 0;
+  else if( nword > static_cast<UInt_t>(pstop + 1 - p) )
+    nword = pstop + 1 - p;         // truncated block
+
+  Int_t status = sldat->loadBlock(p, nword, kChanMask, kChanShift, kDataMask);
+
+  // Keep the per-channel copy for GetData in a simple loop
+  for( UInt_t i = 0; i < nword; ++i ) {
+    UInt_t chan = (p[i] & kChanMask) >> kChanShift;
+    if( chan < fData.size() )
+      fData[chan] = p[i] & kDataMask;
+  }
+  fWordsSeen = nword;
+  fNumHits = sldat->getNumChan();
+  if( status != SD_OK )
+    return -1;
+  return fWordsSeen;
+}
+
+//_____________________________________________________________________________
+UInt_t FastSkeletonModule::GetData( UInt_t chan ) const
+{
+  assert(chan < fNumChan);  // caller expected to ensure that 'chan' is in range
+  return fData[chan];
+}
+
+//_____________________________________________________________________________
+void FastSkeletonModule::Clear( const Option_t* opt )
+{
+  VmeModule::Clear(opt);
+  fNumHits = 0;
+  fData.assign(fNumChan,0);
+}
+
+} // namespace Decoder
+
+//_____________________________________________________________________________
+ClassImp(Decoder::FastSkeletonModule)
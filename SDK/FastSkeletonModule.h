@@ -0,0 +1,56 @@
+#ifndef Podd_FastSkeletonModule_h_
+#define Podd_FastSkeletonModule_h_
+
+/////////////////////////////////////////////////////////////////////
+//
+//   FastSkeletonModule
+//   The SkeletonModule example, decoding the same V792-like data
+//   with the bulk THaSlotData::loadBlock call instead of one
+//   loadData call per word. Start from this one if your module
+//   has one data word per hit with fixed channel and data fields.
+//
+//   The registration steps are the same as for SkeletonModule.
+//   The model number (4445) must appear in db_cratemap.dat.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include "VmeModule.h"
+
+namespace Decoder {
+
+class FastSkeletonModule : public Decoder::VmeModule {
+
+public:
+
+  FastSkeletonModule() : fNumHits(0) {};
+  FastSkeletonModule( UInt_t crate, UInt_t slot );
+  virtual ~FastSkeletonModule();
+
+  using Decoder::Module::GetData;
+  using Decoder::Module::LoadSlot;
+
+  virtual UInt_t GetData( UInt_t chan ) const;
+  virtual void   Init();
+  virtual void   Clear( const Option_t* opt = "" );
+  virtual Int_t  Decode( const UInt_t* /* p */ ) { return 0; };
+
+  virtual UInt_t LoadSlot( Decoder::THaSlotData* sldat,
+                           const UInt_t* evbuffer, const UInt_t* pstop );
+
+  // Data word layout, fixed at compile time
+  static const UInt_t kChanMask  = 0x00ff0000;
+  static const UInt_t kChanShift = 16;
+  static const UInt_t kDataMask  = 0x00000fff;
+
+private:
+
+  UInt_t fNumHits;    // Number of hits in current event
+
+  static TypeIter_t fgThisType;
+
+  ClassDef(FastSkeletonModule,0)  // Skeleton decoder module using bulk loading
+};
+
+} // namespace Decoder
+
+#endif
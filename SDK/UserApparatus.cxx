@@ -38,6 +38,7 @@
 #include "UserApparatus.h"
 #include "THaScintillator.h"
 #include "UserDetector.h"
+#include "FastDetector.h"
 #include "VarDef.h"
 #include "TList.h"
 
@@ -116,6 +117,8 @@ Int_t UserApparatus::Reconstruct()
       fNtotal += d->GetNHits();
     } else if( auto* ud = dynamic_cast<UserDetector*>( theDetector )) {
       fNtotal += ud->GetNhits();
+    } else if( auto* fd = dynamic_cast<FastDetector*>( theDetector )) {
+      fNtotal += fd->GetNhits();
     } else {
       // do nothing for all other detector types
     }
@@ -10,5 +10,7 @@
 #pragma link C++ class UserModule+;
 #pragma link C++ class UserEvtHandler+;
 #pragma link C++ class Decoder::SkeletonModule+;
+#pragma link C++ class FastDetector+;
+#pragma link C++ class Decoder::FastSkeletonModule+;
 
 #endif
@@ -0,0 +1,268 @@
+// Benchmark of the classic and the fast SDK detector
+//
+// Reads up to N events of a CODA file into memory and analyzes them
+// repeatedly with UserDetector "U.u1" and FastDetector "U.f1". Both
+// detectors read the same channels (see db_U.u1.dat and db_U.f1.dat;
+// adapt the detector maps to the crates in your data). For each
+// detector, two quantities are measured per physics event:
+//
+//   Decode:     Clear, Decode, CoarseProcess and FineProcess
+//   Variables:  reading all of the detector's global variables, as the
+//               output and the cuts do
+//
+// Decoding the raw event is needed before each detector call. It is
+// measured separately ("LoadEvent") and subtracted from the Decode times.
+// Each benchmark repeats passes over all events for at least the
+// minimum time.
+//
+// Results are written as JSON in the layout of Google Benchmark, like
+// those of decbench.
+//
+// The database is looked up as usual, i.e. via $DB_DIR or ./DB.
+//
+// Usage: sdkbench [options] input.dat
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <ctime>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <functional>
+#include <getopt.h>
+
+#include "TROOT.h"
+#include "TError.h"
+#include "TClonesArray.h"
+
+#include "THaInterface.h"
+#include "THaGlobals.h"
+#include "THaVarList.h"
+#include "THaVar.h"
+#include "THaRun.h"
+#include "THaTrack.h"
+#include "CodaDecoder.h"
+#include "UserApparatus.h"
+#include "UserDetector.h"
+#include "FastDetector.h"
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+// Result of one benchmark
+class Result_t {
+public:
+  explicit Result_t( string _name )
+    : name(std::move(_name)), passes(0), time(0), events(0) {}
+  string    name;
+  ULong64_t passes;  // Passes over the data
+  Double_t  time;    // Total real time (s)
+  ULong64_t events;  // Physics events processed
+};
+
+//_____________________________________________________________________________
+static void usage( const char* prgname )
+{
+  cerr << "Usage: " << prgname << " [options] input.dat" << endl
+       << "  -n <events>   read at most this many events (default 10000)"
+       << endl
+       << "  -c <2|3>      CODA version of the input (default: auto)" << endl
+       << "  -t <seconds>  minimum time per benchmark (default 1)" << endl
+       << "  -O <file>     JSON output file (default stdout)" << endl;
+  exit(255);
+}
+
+//_____________________________________________________________________________
+template< typename Func >
+static Result_t Measure( const string& name, Double_t mintime, Func pass )
+{
+  // Call 'pass' until 'mintime' seconds have elapsed. 'pass' processes
+  // all events once and returns the number of physics events.
+
+  Result_t res(name);
+  auto start = Clock::now();
+  do {
+    res.events += pass();
+    ++res.passes;
+    res.time = chrono::duration<Double_t>(Clock::now() - start).count();
+  } while( res.time < mintime );
+  return res;
+}
+
+//_____________________________________________________________________________
+static void WriteJSON( ostream& os, const string& input, ULong64_t nev,
+                       const vector<Result_t>& results )
+{
+  char date[32];
+  time_t now = time(nullptr);
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+  os << "{" << endl
+     << "  \"context\": {" << endl
+     << "    \"date\": \"" << date << "\"," << endl
+     << "    \"input\": \"" << input << "\"," << endl
+     << "    \"events\": " << nev << endl
+     << "  }," << endl
+     << "  \"benchmarks\": [" << endl;
+  size_t n = 0;
+  for( const auto& r : results ) {
+    Double_t t = (r.time > 0) ? r.time : 1e-30;
+    os << "    {" << endl
+       << "      \"name\": \"" << r.name << "\"," << endl
+       << "      \"run_type\": \"iteration\"," << endl
+       << "      \"iterations\": " << r.events << "," << endl
+       << "      \"passes\": " << r.passes << "," << endl
+       << "      \"real_time\": " << (r.events ? 1e9*r.time/r.events : 0.)
+       << "," << endl
+       << "      \"time_unit\": \"ns\"," << endl
+       << "      \"events_per_second\": " << r.events/t << endl
+       << "    }" << (++n < results.size() ? "," : "") << endl;
+  }
+  os << "  ]" << endl << "}" << endl;
+}
+
+//_____________________________________________________________________________
+int main( int argc, char* argv[] )
+{
+  ULong64_t maxev = 10000;
+  Int_t coda_version = 0;
+  Double_t mintime = 1.0;
+  const char* outfile = nullptr;
+  int opt;
+  while( (opt = getopt(argc, argv, "n:c:t:O:h")) != -1 ) {
+    switch( opt ) {
+    case 'n':
+      maxev = strtoull(optarg, nullptr, 0);
+      break;
+    case 'c':
+      coda_version = atoi(optarg);
+      if( coda_version != 2 && coda_version != 3 )
+        usage(argv[0]);
+      break;
+    case 't':
+      mintime = atof(optarg);
+      break;
+    case 'O':
+      outfile = optarg;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if( argc - optind != 1 || maxev == 0 )
+    usage(argv[0]);
+  const string input = argv[optind];
+
+  // Set up the analyzer environment (global lists etc.) without passing
+  // our options to ROOT
+  int rargc = 1;
+  THaInterface theApp("sdkbench", &rargc, argv, nullptr, 0, true);
+  gROOT->SetBatch(true);
+
+  // Read the events into memory, so that no I/O is timed
+  THaRun run(input.c_str());
+  if( coda_version > 0 )
+    run.SetDataVersion(coda_version);
+  if( run.Init() != 0 || run.Open() != 0 ) {
+    ::Error( "sdkbench", "Cannot open %s", input.c_str() );
+    return 2;
+  }
+  vector<vector<UInt_t>> events;
+  while( events.size() < maxev && run.ReadEvent() == THaRunBase::READ_OK ) {
+    const UInt_t* evbuf = run.GetEvBuffer();
+    events.emplace_back(evbuf, evbuf + evbuf[0] + 1);
+  }
+  run.Close();
+
+  // The detectors under test, in one apparatus. gHaApps owns it.
+  auto* app = new UserApparatus("U", "SDK benchmark apparatus");
+  app->AddDetector( new FastDetector("f1", "Fast detector 1") );
+  gHaApps->Add(app);
+  const TDatime run_time = run.GetDate();
+  if( app->Init(run_time) != THaAnalysisObject::kOK ) {
+    ::Error( "sdkbench", "Cannot initialize detectors" );
+    return 3;
+  }
+  vector<THaNonTrackingDetector*> dets = {
+    static_cast<THaNonTrackingDetector*>(app->GetDetector("u1")),
+    static_cast<THaNonTrackingDetector*>(app->GetDetector("f1"))
+  };
+
+  CodaDecoder dec;
+  dec.SetRunTime(run_time.Convert());
+  dec.SetDataVersion(run.GetDataVersion());
+
+  // Pass over all events, calling 'work' for each physics event
+  auto decode_all = [&]( const std::function<void()>& work ) {
+    ULong64_t nphys = 0;
+    for( const auto& ev : events ) {
+      dec.LoadEvent(ev.data());
+      if( dec.IsPhysicsTrigger() ) {
+        work();
+        ++nphys;
+      }
+    }
+    return nphys;
+  };
+
+  vector<Result_t> results;
+  results.push_back(Measure("LoadEvent", mintime,
+                            [&]{ return decode_all([]{}); }));
+  if( results.back().events == 0 ) {
+    ::Error( "sdkbench", "No physics events in %s", input.c_str() );
+    return 3;
+  }
+  const Double_t t_load = results.back().time / results.back().events;
+
+  TClonesArray tracks("THaTrack", 1);
+  volatile Double_t sink = 0;
+  for( auto* det : dets ) {
+    auto process = [&]{
+      det->Clear();
+      det->Decode(dec);
+      det->CoarseProcess(tracks);
+      det->FineProcess(tracks);
+    };
+
+    // Decode + processing, minus the raw event decoding
+    Result_t res = Measure(string("Decode/") + det->ClassName(), mintime,
+                           [&]{ return decode_all(process); });
+    res.time -= t_load * res.events;
+    results.push_back(res);
+    const Double_t t_proc = res.time / res.events;
+
+    // Reading the global variables of this detector, minus the above
+    vector<THaVar*> vars;
+    const TString prefix = det->GetPrefix();
+    TIter next(gHaVars);
+    while( auto* var = static_cast<THaVar*>(next()) ) {
+      if( TString(var->GetName()).BeginsWith(prefix) )
+        vars.push_back(var);
+    }
+    res = Measure(string("Variables/") + det->ClassName(), mintime,
+      [&]{ return decode_all([&]{
+          process();
+          for( const auto* var : vars ) {
+            Int_t len = var->GetLen();
+            for( Int_t i = 0; i < len; ++i )
+              sink = sink + var->GetValue(i);
+          }
+        }); });
+    res.time -= (t_load + t_proc) * res.events;
+    results.push_back(res);
+  }
+
+  if( outfile ) {
+    ofstream ofs(outfile);
+    if( !ofs ) {
+      ::Error( "sdkbench", "Cannot open output file %s", outfile );
+      return 4;
+    }
+    WriteJSON(ofs, input, events.size(), results);
+  } else
+    WriteJSON(cout, input, events.size(), results);
+
+  return 0;
+}
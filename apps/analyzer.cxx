@@ -2,12 +2,24 @@
 //
 //  The Hall A analyzer interactive interface
 //
+//  With -B, the following arguments are macros that are run in batch
+//  mode without starting the interactive ROOT session, e.g.
+//     analyzer -B 'replay.C(1234)'
+//  This skips the TRint setup (logon scripts, history, prompt), which
+//  speeds up the startup of short batch jobs. The exit status is 1 if
+//  a macro fails. Replay configuration files (*.cfg, see
+//  Podd::ReplayConfig) may be given instead of macros.
+//
 //////////////////////////////////////////////////////////////////////////
 
 #include "THaInterface.h"
+#include "BatchInterface.h"
+#include "ReplayConfig.h"
+#include "TROOT.h"
 #include <iostream>
 #include <cstring>
 #include <memory>
+#include <vector>
 
 using namespace std;
 
@@ -16,9 +28,14 @@ int main(int argc, char **argv)
   // Create a ROOT-style interactive interface
 
   // Handle convenience command line options
-  bool print_version = false, no_logo = false;
+  bool print_version = false, no_logo = false, batch = false;
+  vector<const char*> macros;
   for( int i=1; i<argc; ++i ) {
-    if( !strcmp(argv[i],"-l") )
+    if( batch && argv[i][0] != '-' )
+      macros.push_back(argv[i]);
+    else if( !strcmp(argv[i],"-B") )
+      batch = true;
+    else if( !strcmp(argv[i],"-l") )
       no_logo = true;
     else if( !strcmp(argv[1],"-v") || !strcmp(argv[1],"--version") ) {
       print_version = true;
@@ -31,6 +48,25 @@ int main(int argc, char **argv)
     return 0;
   }
 
+  if( batch ) {
+    Podd::BatchInterface env(true);
+    if( env.IsZombie() )
+      return 2;
+    for( const char* macro : macros ) {
+      int err = 0;
+      if( Podd::ReplayConfig::IsConfigFile(macro) ) {
+        Podd::ReplayConfig config(macro);
+        err = config.IsValid() ? config.InstantiateCompiled() : -1;
+      } else
+        gROOT->Macro(macro, &err);
+      if( err != 0 ) {
+        cerr << "Error executing macro " << macro << endl;
+        return 1;
+      }
+    }
+    return 0;
+  }
+
   unique_ptr<TApplication> theApp{
     new THaInterface("The Hall A analyzer", &argc, argv, nullptr, 0, no_logo)};
   theApp->Run(false);
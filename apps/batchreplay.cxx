@@ -0,0 +1,348 @@
+//
+// batchreplay.cxx
+//
+// Non-interactive replay of a list of runs, for reprocessing campaigns.
+// The analysis setup (apparatuses, physics modules etc.) is defined once
+// by a setup macro, as in the usual replay scripts, e.g. examples/setup.C
+// without the THaAnalyzer and THaRun parts, or by a replay configuration
+// file (*.cfg, see Podd::ReplayConfig). The database files of the
+// setup are then parsed once for the dates of all runs (see
+// Podd::PreloadDBFiles), and the runs are analyzed by a pool of worker
+// processes forked from this warm setup. The workers share the parsed
+// database read-only (copy-on-write) and take the next run from the list
+// whenever they finish one. Each worker keeps its analyzer, modules and
+// database cache between its runs, so only the per-run initialization
+// is repeated.
+//
+// The run list has one CODA file per line, optionally followed by the name
+// of the ROOT output file. Empty lines and lines starting with '#' are
+// ignored. The default output file is <outdir>/<input base name>.root.
+//
+// A summary line per run (input, output, worker, status, events, real
+// time, events/s) is written to the summary file as it completes, and a
+// total is printed at the end. The exit status is 1 if any run failed.
+//
+// Usage: batchreplay [options] -s setup.C runlist.txt
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <getopt.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "TROOT.h"
+#include "TList.h"
+#include "TError.h"
+#include "TDatime.h"
+
+#include "BatchInterface.h"
+#include "ReplayConfig.h"
+#include "THaGlobals.h"
+#include "THaAnalyzer.h"
+#include "THaOutput.h"
+#include "THaApparatus.h"
+#include "THaDetector.h"
+#include "THaRun.h"
+#include "Database.h"
+
+using namespace std;
+
+//_____________________________________________________________________________
+class RunSpec_t {
+public:
+  RunSpec_t( string in, string out )
+    : input(std::move(in)), output(std::move(out)) {}
+  string input;
+  string output;
+};
+
+//_____________________________________________________________________________
+static void usage( const char* prgname )
+{
+  cerr << "Usage: " << prgname << " [options] -s setup.C runlist.txt" << endl
+       << "  -s <macro>    setup macro or configuration file (*.cfg)"
+       << " defining the analysis modules" << endl
+       << "  -j <n>        number of worker processes (default 1)" << endl
+       << "  -D <dir>      directory for output files (default .)" << endl
+       << "  -d <file>     output definition file" << endl
+       << "  -C <file>     cut definition file" << endl
+       << "  -n <events>   analyze at most this many events per run" << endl
+       << "  -H            fill histograms only, no output tree" << endl
+       << "  -O <file>     summary file (default batchreplay.txt)" << endl
+       << "  -v            verbose analyzer output" << endl;
+  exit(255);
+}
+
+//_____________________________________________________________________________
+static int ReadRunList( const char* filename, const string& outdir,
+                        vector<RunSpec_t>& runs )
+{
+  // Read the list of runs to analyze from 'filename'
+
+  ifstream ifs(filename);
+  if( !ifs ) {
+    ::Error( "batchreplay", "Cannot open run list %s", filename );
+    return -1;
+  }
+  string line;
+  while( getline(ifs, line) ) {
+    istringstream is(line);
+    string input, output;
+    if( !(is >> input) || input[0] == '#' )
+      continue;
+    if( !(is >> output) ) {
+      string base = input.substr(input.rfind('/') + 1);
+      base = base.substr(0, base.find('.'));
+      output = outdir + "/" + base + ".root";
+    }
+    runs.emplace_back(input, output);
+  }
+  return 0;
+}
+
+//_____________________________________________________________________________
+static void PreloadDatabase( const vector<RunSpec_t>& runs )
+{
+  // Parse the standard database files of all modules in the global lists
+  // for the dates of all runs, so that forked workers find them in memory
+
+  vector<string> names;
+  TIter next(gHaApps);
+  while( auto* app = static_cast<THaApparatus*>(next()) ) {
+    names.emplace_back(string(app->GetName()) + ".");
+    TIter nextdet(app->GetDetectors());
+    while( auto* det = static_cast<THaDetector*>(nextdet()) )
+      names.emplace_back(string(app->GetName()) + "." + det->GetName() + ".");
+  }
+  TIter nextphys(gHaPhysics);
+  while( auto* mod = static_cast<TObject*>(nextphys()) )
+    names.emplace_back(string(mod->GetName()) + ".");
+
+  set<UInt_t> dates;
+  for( const auto& spec : runs ) {
+    THaRun run(spec.input.c_str());
+    if( run.Init() == 0 )
+      dates.insert(run.GetDate().Convert());
+  }
+  Int_t n = 0;
+  for( auto d : dates ) {
+    TDatime date(d);
+    n += Podd::PreloadDBFiles(names, date, 1);
+  }
+  cout << "Preloaded " << n << " database files for " << dates.size()
+       << " run date(s)" << endl;
+}
+
+//_____________________________________________________________________________
+static int Worker( int id, const vector<RunSpec_t>& runs,
+                   atomic<UInt_t>* next_run, int summary_fd, UInt_t nev,
+                   const string& odef, const string& cuts, int verbose )
+{
+  // Analyze runs from 'runs', taking the next one from the shared
+  // counter 'next_run' until all are done. Returns the number of
+  // failed runs.
+
+  THaAnalyzer analyzer;
+  analyzer.SetVerbosity(verbose);
+  analyzer.EnableOverwrite();
+  if( !odef.empty() )
+    analyzer.SetOdefFile(odef.c_str());
+  if( !cuts.empty() )
+    analyzer.SetCutFile(cuts.c_str());
+
+  int nfail = 0;
+  UInt_t i;
+  while( (i = next_run->fetch_add(1)) < runs.size() ) {
+    const auto& spec = runs[i];
+    THaRun run(spec.input.c_str());
+    if( nev > 0 )
+      run.SetLastEvent(nev);
+    analyzer.SetOutFile(spec.output.c_str());
+    auto start = chrono::steady_clock::now();
+    Int_t nread = analyzer.Process(run);
+    Double_t t =
+      chrono::duration<Double_t>(chrono::steady_clock::now() - start).count();
+    analyzer.Close();
+    bool ok = nread > 0;
+    if( !ok )
+      ++nfail;
+
+    // One write per line, so that lines from different workers do not mix
+    char buf[1024];
+    int len = snprintf(buf, sizeof(buf), "%s\t%s\t%d\t%s\t%d\t%.3f\t%.1f\n",
+                       spec.input.c_str(), spec.output.c_str(), id,
+                       ok ? "ok" : "failed", nread, t,
+                       (ok && t > 0) ? nread / t : 0.0);
+    if( len > 0 && write(summary_fd, buf, min<size_t>(len, sizeof(buf)-1)) < 0 )
+      ::Warning( "batchreplay", "Error writing summary for %s",
+                 spec.input.c_str() );
+  }
+  return nfail;
+}
+
+//_____________________________________________________________________________
+int main( int argc, char* argv[] )
+{
+  string setup, outdir = ".", odef, cuts, summary = "batchreplay.txt";
+  UInt_t nwork = 1, nev = 0;
+  Int_t verbose = 0;
+  int opt;
+  while( (opt = getopt(argc, argv, "s:j:D:d:C:n:HO:vh")) != -1 ) {
+    switch( opt ) {
+    case 's':
+      setup = optarg;
+      break;
+    case 'j':
+      nwork = strtoul(optarg, nullptr, 0);
+      if( nwork == 0 )
+        usage(argv[0]);
+      break;
+    case 'D':
+      outdir = optarg;
+      break;
+    case 'd':
+      odef = optarg;
+      break;
+    case 'C':
+      cuts = optarg;
+      break;
+    case 'n':
+      nev = strtoul(optarg, nullptr, 0);
+      break;
+    case 'H':
+      THaOutput::SetHistogramsOnly();
+      break;
+    case 'O':
+      summary = optarg;
+      break;
+    case 'v':
+      ++verbose;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if( setup.empty() || argc - optind != 1 )
+    usage(argv[0]);
+
+  vector<RunSpec_t> runs;
+  if( ReadRunList(argv[optind], outdir, runs) != 0 )
+    return 2;
+  if( runs.empty() ) {
+    ::Error( "batchreplay", "No runs in run list %s", argv[optind] );
+    return 2;
+  }
+
+  // Set up the analyzer environment without an interactive ROOT session
+  Podd::BatchInterface env(true);
+  if( env.IsZombie() )
+    return 2;
+
+  int err = 0;
+  if( Podd::ReplayConfig::IsConfigFile(setup.c_str()) ) {
+    Podd::ReplayConfig config(setup.c_str());
+    err = config.IsValid() ? config.InstantiateCompiled() : -1;
+  } else
+    gROOT->Macro(setup.c_str(), &err);
+  if( err != 0 ) {
+    ::Error( "batchreplay", "Error executing setup macro %s", setup.c_str() );
+    return 2;
+  }
+  PreloadDatabase(runs);
+
+  int summary_fd = open(summary.c_str(), O_WRONLY|O_CREAT|O_TRUNC|O_APPEND,
+                        0644);
+  if( summary_fd < 0 ) {
+    ::Error( "batchreplay", "Cannot open summary file %s", summary.c_str() );
+    return 2;
+  }
+  const char* header =
+    "# input\toutput\tworker\tstatus\tevents\treal_time_s\tevents_per_s\n";
+  if( write(summary_fd, header, strlen(header)) < 0 )
+    ::Warning( "batchreplay", "Error writing summary file header" );
+
+  // Index of the next run to analyze, shared by all workers
+  void* shm = mmap(nullptr, sizeof(atomic<UInt_t>), PROT_READ|PROT_WRITE,
+                   MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+  if( shm == MAP_FAILED ) {
+    ::Error( "batchreplay", "Cannot allocate shared memory" );
+    return 2;
+  }
+  auto* next_run = new(shm) atomic<UInt_t>(0);
+
+  auto start = chrono::steady_clock::now();
+  int nfail = 0;
+  if( nwork == 1 ) {
+    nfail = Worker(0, runs, next_run, summary_fd, nev, odef, cuts, verbose);
+  } else {
+    cout.flush();
+    cerr.flush();
+    vector<pid_t> workers;
+    for( UInt_t w = 0; w < nwork && w < runs.size(); ++w ) {
+      pid_t pid = fork();
+      if( pid == 0 ) {
+        int n = Worker(w, runs, next_run, summary_fd, nev, odef, cuts,
+                       verbose);
+        cout.flush();
+        _exit(n > 0 ? 1 : 0);
+      }
+      if( pid < 0 ) {
+        ::Error( "batchreplay", "Cannot start worker %u", w );
+        break;
+      }
+      workers.push_back(pid);
+    }
+    if( workers.empty() )
+      return 2;
+    for( auto pid : workers ) {
+      int status = 0;
+      if( waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) ||
+          WEXITSTATUS(status) != 0 )
+        ++nfail;
+    }
+  }
+  Double_t t =
+    chrono::duration<Double_t>(chrono::steady_clock::now() - start).count();
+  close(summary_fd);
+
+  // Totals from the summary file
+  ifstream ifs(summary);
+  string line;
+  UInt_t nruns = 0, nok = 0;
+  ULong64_t nevents = 0;
+  while( getline(ifs, line) ) {
+    if( line.empty() || line[0] == '#' )
+      continue;
+    istringstream is(line);
+    string in, out, status;
+    int w = 0;
+    Long64_t n = 0;
+    if( is >> in >> out >> w >> status >> n ) {
+      ++nruns;
+      if( status == "ok" ) {
+        ++nok;
+        nevents += n;
+      }
+    }
+  }
+  cout << "Analyzed " << nok << " of " << runs.size() << " runs ("
+       << nruns - nok << " failed), " << nevents << " events in " << t
+       << " s, " << (t > 0 ? nevents / t : 0) << " events/s with " << nwork
+       << " worker(s)" << endl
+       << "Summary written to " << summary << endl;
+
+  munmap(shm, sizeof(atomic<UInt_t>));
+  return (nfail > 0 || nok < runs.size()) ? 1 : 0;
+}
@@ -34,14 +34,18 @@
 #include <getopt.h>   // got getopt_long
 #include <libgen.h>   // for POSIX basename()
 #include <memory>
+#include <thread>
+#include <atomic>
 
 #include "TString.h"
 #include "TDatime.h"
 #include "TMath.h"
 #include "TVector3.h"
 #include "TError.h"
+#include "TROOT.h"     // for EnableThreadSafety
 
 #include "THaAnalysisObject.h"
+#include "Database.h"   // for WriteDBSnapshot, LoadDBvalue
 #include "THaVDC.h"
 #include "THaDetMap.h"
 #include "THaString.h"  // for Split()
@@ -64,14 +68,15 @@ static bool IsDBSubDir( const string& fname, time_t& date );
 // Command line parameter defaults
 static int do_debug = 0, verbose = 0, do_file_copy = 1, do_subdirs = 0;
 static int do_clean = 1, do_verify = 1, do_dump = 0, purge_all_default_keys = 1;
-static int format_fp = 1, format_fixed = 0;
+static int format_fp = 1, format_fixed = 0, do_snapshot = 0, do_validate = 0;
+static unsigned int nthreads = 0;  // 0 = number of CPUs
 static string srcdir;
 static string destdir;
 static string prgname;
 static const char* mapfile = nullptr;
 static const char* inp_tz_arg = nullptr, *outp_tz_arg = nullptr;
 static string inp_tz, outp_tz, cur_tz;
-static string current_filename;
+static thread_local string current_filename;
 static const char* c_out_subdirs = nullptr;
 static vector<string> out_subdirs;
 
@@ -87,12 +92,15 @@ static struct option longopts[] = {
   { "no-preserve-subdirs",  no_argument, &do_subdirs,  0  },
   { "no-clean",             no_argument, &do_clean,    0  },
   { "no-verify",            no_argument, &do_verify,   0  },
+  { "snapshot",             no_argument, &do_snapshot, 1  },
+  { "validate",             no_argument, &do_validate, 1  },
   // Parameters
   { "mapfile",              required_argument, nullptr, 'm' },
   { "detlist",              required_argument, nullptr, 'l' },  // wildcard list detector names
   { "subdirs",              required_argument, nullptr, 's' },  // overrides preserve-subdirs
   { "input-timezone",       required_argument, nullptr, 'z' },
   { "output-timezone",      required_argument, nullptr, 1   },
+  { "jobs",                 required_argument, nullptr, 'j' },
   { nullptr, 0, nullptr, 0 }
 };
 
@@ -104,6 +112,11 @@ static const char* const opthelp[] = {
   "don't preserve subdirectory structure (negates -p)",
   "don't erase all existing files from DEST_DIR if it exists",
   "don't ask for confirmation before deleting any files",
+  "also write a binary snapshot <file>.snap of each output file, "
+    "which the analyzer loads instead of parsing the text file",
+  "after conversion, load every converted key through the analyzer's "
+    "database reader (and snapshots, if written) and check that it has the "
+    "value extracted from the input",
   "read mapping from file names to detector types from <ARG>",
   "convert only detectors given in <ARG>. ARG is a comma-separated "
     "list of detector names which may contain wildcards * and ?.",
@@ -118,7 +131,9 @@ static const char* const opthelp[] = {
     "to use the current timezone at run time.",
   "write all output timestamps relative to timezone ARG, specified in the "
     "same way as --input-timezone. The default is to use the current "
-    "timezone at run time."
+    "timezone at run time.",
+  "read and convert input files using <ARG> threads. The default is the "
+    "number of CPUs."
   /*
   //TODO...
   // cout << " -o <outfile>: Write output to <outfile>. Default: "
@@ -457,7 +472,7 @@ static void getargs( int argc, char* const argv[] )
   free(argv0);
 
   int opt;
-  while( (opt = getopt_long(argc, argv, "hvdpm:s:z:", longopts, nullptr)) != -1) {
+  while( (opt = getopt_long(argc, argv, "hvdpm:s:z:j:", longopts, nullptr)) != -1) {
     switch( opt ) {
     case 'h':
       help();
@@ -485,6 +500,9 @@ static void getargs( int argc, char* const argv[] )
     case 1:
       outp_tz_arg = optarg;
       break;
+    case 'j':
+      nthreads = strtoul(optarg, nullptr, 10);
+      break;
     case ':':
     case '?':
       usage();
@@ -558,20 +576,15 @@ static void getargs( int argc, char* const argv[] )
 //-----------------------------------------------------------------------------
 static inline time_t MkTime( struct tm& td, bool have_tz = false )
 {
-  string save_tz;
+  // With an explicit offset from UTC, compute the time directly instead of
+  // switching $TZ, so that this can be called from several threads
   if( have_tz ) {
-    save_tz = cur_tz;
-    set_tz( TZfromOffset(td.tm_gmtoff) );
-  } else
-    td.tm_isdst = -1;
-
-  time_t ret = mktime( &td );
-
-  if( have_tz ) {
-    reset_tz();
-    cur_tz = save_tz;
+    long off = td.tm_gmtoff;
+    time_t ret = timegm( &td );
+    return (ret != static_cast<time_t>(-1)) ? ret - off : ret;
   }
-  return ret;
+  td.tm_isdst = -1;
+  return mktime( &td );
 }
 
 //-----------------------------------------------------------------------------
@@ -1164,6 +1177,8 @@ static int WriteFileDB( const string& target_dir, const vector<string>& subdirs
       ofs.close();
       // Don't create empty files (should never happen)
       assert( nw > 0 );
+      if( do_snapshot && Podd::WriteDBSnapshot(fname.c_str()) != 0 )
+	return 1;
       // if( nw == 0 ) {
       //	unlink( fname.c_str() );
       // }
@@ -1173,6 +1188,121 @@ static int WriteFileDB( const string& target_dir, const vector<string>& subdirs
   return 0;
 }
 
+//-----------------------------------------------------------------------------
+static int ValidateDB( const string& target_dir, const vector<string>& subdirs )
+{
+  // Check the database written by WriteFileDB: read back each key for each
+  // validity time range through Podd::LoadDBvalue, i.e. the parser and
+  // cache that the analyzer uses (including snapshots, if written), and
+  // compare to the value in gDB. Keys of copied files and values with a
+  // version are not checked.
+  // Should be called with the output timezone set.
+  // Returns the number of mismatches.
+
+  set<time_t> dir_times;
+  map<time_t,string> dir_names;
+  if( !do_subdirs || subdirs.empty() ) {
+    dir_times.insert(0);
+    dir_names.insert(make_pair(0,target_dir));
+  } else {
+    for(const auto& subdir : subdirs) {
+      time_t date{};
+      if( IsDBSubDir(subdir,date) ) {
+	dir_times.insert(date);
+	dir_names.insert( make_pair(date, MakePath(target_dir,subdir)) );
+      }
+    }
+  }
+  if( dir_times.empty() )
+    return 0;
+
+  // Earliest time representable by TDatime
+  const time_t min_time = TDatime(1995,1,1,0,0,0).Convert();
+
+  // Group the checks by output file, so that each file is parsed only once
+  struct Check_t {
+    Check_t( const string& k, const DBvalue* v, time_t d )
+      : key(&k), val(v), date(d) {}
+    const string*  key;
+    const DBvalue* val;
+    time_t         date;  // Time at which to look up 'key'
+  };
+  map<string,vector<Check_t>> checks;
+  size_t nskipped = 0;
+  for( const auto& keyToDet : gKeyToDet ) {
+    const string& key = keyToDet.first;
+    auto jt = gDB.find( key );
+    if( jt == gDB.end() || jt->second.isCopy )
+      continue;  // Purged or copied
+    const ValSet_t& vals = jt->second.values;
+    for( auto vt = vals.begin(); vt != vals.end(); ++vt ) {
+      if( !vt->version.empty() ) {
+	++nskipped;
+	continue;
+      }
+      // Directory holding this value (see WriteFileDB)
+      auto dt = dir_times.upper_bound( vt->validity_start );
+      if( dt != dir_times.begin() )
+	--dt;
+      time_t date = max( max(vt->validity_start, *dt), min_time );
+      // Values superseded at the lookup time cannot be checked
+      auto nt = vt; ++nt;
+      if( nt != vals.end() && nt->validity_start <= date ) {
+	++nskipped;
+	continue;
+      }
+      string fname = dir_names[*dt];
+      fname += "/db_"; fname += keyToDet.second; fname += ".dat";
+      checks[fname].emplace_back( key, &*vt, date );
+    }
+  }
+
+  int nbad = 0;
+  size_t nchecked = 0;
+  for( const auto& fileChecks : checks ) {
+    const string& fname = fileChecks.first;
+    FILE* fi = fopen( fname.c_str(), "r" );
+    if( !fi ) {
+      stringstream ss("Error opening ",ios::out|ios::app);
+      ss << fname;
+      perror(ss.str().c_str());
+      nbad += static_cast<int>(fileChecks.second.size());
+      continue;
+    }
+    for( const auto& check : fileChecks.second ) {
+      string text;
+      TDatime date( static_cast<UInt_t>(check.date) );
+      Int_t st = LoadDBvalue( fi, date, check.key->c_str(), text );
+      // Compare as whitespace-separated items, since WriteAllKeysForTime
+      // may reformat arrays
+      istringstream istr_new(text), istr_old(check.val->value);
+      vector<string> items_new{ istream_iterator<string>(istr_new),
+				istream_iterator<string>() };
+      vector<string> items_old{ istream_iterator<string>(istr_old),
+				istream_iterator<string>() };
+      ++nchecked;
+      if( st != 0 || items_new != items_old ) {
+	cerr << "Validation error: " << fname << ": key " << *check.key
+	     << " at " << format_time(check.date);
+	if( st != 0 )
+	  cerr << " not found" << endl;
+	else
+	  cerr << " = \"" << text << "\", expected \""
+	       << check.val->value << "\"" << endl;
+	++nbad;
+      }
+    }
+    fclose(fi);
+  }
+  cout << "Validated " << nchecked << " values in " << checks.size()
+       << " files, " << nbad << " errors";
+  if( nskipped > 0 )
+    cout << ", " << nskipped << " not checked";
+  cout << endl;
+
+  return nbad;
+}
+
 //-----------------------------------------------------------------------------
 // Common detector data
 class Detector {
@@ -1180,7 +1310,7 @@ public:
   explicit Detector( const string& name )
     : fName(name), fDBName(name), fDetMap(new THaDetMap),
       fDetMapHasLogicalChan(true), fDetMapHasModel(false),
-      fNelem(0), fAngle(0) /*, fXax(1.,0,0), fYax(0,1.,0), fZax(0,0,1.) */{
+      fNelem(0), fAngle(0), fStaging(false) /*, fXax(1.,0,0), fYax(0,1.,0), fZax(0,0,1.) */{
     fSize[0] = fSize[1] = fSize[2] = 0.;
     string::size_type pos = fName.find('.');
     if( pos == string::npos )
@@ -1196,7 +1326,7 @@ public:
       fDetMapHasLogicalChan(rhs.fDetMapHasLogicalChan),
       fDetMapHasModel(rhs.fDetMapHasModel),
       fNelem(rhs.fNelem), fAngle(rhs.fAngle), fOrigin(rhs.fOrigin),
-      fDefaults(rhs.fDefaults)
+      fDefaults(rhs.fDefaults), fStaging(rhs.fStaging)
   {
     memcpy( fSize, rhs.fSize, 3*sizeof(fSize[0]) );
   }
@@ -1206,6 +1336,7 @@ public:
       fConfig = rhs.fConfig; fDetMapHasLogicalChan = rhs.fDetMapHasLogicalChan,
       fDetMapHasModel = rhs.fDetMapHasModel; fNelem = rhs.fNelem;
       fAngle = rhs.fAngle; fOrigin = rhs.fOrigin; fDefaults = rhs.fDefaults;
+      fStaging = rhs.fStaging; fStaged.clear();
       memcpy( fSize, rhs.fSize, 3*sizeof(fSize[0]) );
 #if __cplusplus >= 201402L
       fDetMap = make_unique<THaDetMap>(*rhs.fDetMap);
@@ -1235,9 +1366,16 @@ public:
   void SetDBName( const string& s ) { fDBName = s; }
   const string& GetDBName() const { return fDBName; }
 
+  // Staging: collect values saved by this detector instead of adding them to
+  // the in-memory database right away. Detectors can then be read in
+  // parallel and their values added in a fixed order with CommitStaged().
+  void SetStaging( bool enable ) { fStaging = enable; }
+  int  CommitStaged();
+
 protected:
   virtual int AddToMap( const string& key, const Value_t& value, time_t start,
 			const string& version = string(), int max = 0 ) const;
+  virtual int StoreValue( const string& key, const DBvalue& val ) const;
   // void DefineAxes( Double_t rot ) {
   //   fXax.SetXYZ( TMath::Cos(rot), 0.0, TMath::Sin(rot) );
   //   fYax.SetXYZ( 0.0, 1.0, 0.0 );
@@ -1305,6 +1443,9 @@ protected:
 
   mutable string fNelemName;
 
+  bool        fStaging;
+  mutable vector<pair<string,DBvalue>> fStaged; // Values not yet in gDB
+
   static bool TestBit(UInt_t flags, UInt_t bit) { return (flags & bit) != 0; }
 
 private:
@@ -1327,8 +1468,7 @@ public:
   virtual const char* GetClassName() const { return "CopyFile"; }
 
 protected:
-  virtual int AddToMap( const string& key, const Value_t& value, time_t start,
-			const string& version = string(), int max = 0 ) const;
+  virtual int StoreValue( const string& key, const DBvalue& val ) const;
 
   bool fDoingFileCopy; // If true, mark DB values with isCopy = true
   DB   fDB;
@@ -2255,9 +2395,129 @@ static int InsertDefaultFiles( const vector<string>& subdirs,
 }
 
 //-----------------------------------------------------------------------------
-static int ExtractKeys( Detector* det, const multiset<Filenames_t>& filenames )
+// Contents of a source database file, read once and shared by all passes
+// over the file (files may be referenced several times, e.g. default files
+// applying to several date ranges, and are read again by CopyFiles)
+struct SourceFile_t {
+  SourceFile_t() : want_tstamps(false), ok(false), err(0) {}
+  bool        want_tstamps; // Parse timestamps (parser supports them)
+  bool        ok;           // File read successfully
+  int         err;          // errno if not ok
+  string      text;         // File contents
+  set<time_t> timestamps;   // Timestamps in the file, if requested
+};
+typedef map<string,SourceFile_t> SourceCache_t;
+
+//-----------------------------------------------------------------------------
+static unsigned int GetNthreads( size_t njobs )
+{
+  // Number of worker threads to use for 'njobs' independent jobs
+
+  unsigned int n = nthreads;
+  if( n == 0 )
+    n = std::thread::hardware_concurrency();
+  if( n > njobs )
+    n = static_cast<unsigned int>(njobs);
+  return max(n, 1U);
+}
+
+//-----------------------------------------------------------------------------
+template<typename Work>
+static void RunParallel( size_t njobs, Work work )
+{
+  // Call work(i) for i = 0..njobs-1, distributing the calls over
+  // GetNthreads() threads, including the calling thread
+
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    size_t i;
+    while( (i = next++) < njobs )
+      work(i);
+  };
+  vector<std::thread> threads;
+  for( unsigned int i = 1; i < GetNthreads(njobs); ++i )
+    threads.emplace_back(worker);
+  worker();
+  for( auto& t : threads )
+    t.join();
+}
+
+//-----------------------------------------------------------------------------
+static FILE* OpenSource( const SourceCache_t& cache, const string& path )
 {
-  // Extract keys for given detector from the database files in 'filenames'
+  // Open the source file 'path' for reading. Use the cached contents
+  // if available.
+
+  auto it = cache.find(path);
+  if( it != cache.end() && it->second.ok && !it->second.text.empty() ) {
+    const string& text = it->second.text;
+    return fmemopen( const_cast<char*>(text.data()), text.size(), "r" );
+  }
+  if( it != cache.end() && !it->second.ok ) {
+    errno = it->second.err;
+    return nullptr;
+  }
+  return fopen( path.c_str(), "r" );
+}
+
+//-----------------------------------------------------------------------------
+static int ReadSources( SourceCache_t& cache )
+{
+  // Read all files in 'cache' into memory in parallel and, where requested,
+  // find their timestamps. The cache entries must already exist; only their
+  // contents are modified here.
+  // Must be called with the input timezone set.
+
+  vector<pair<const string,SourceFile_t>*> files;
+  files.reserve(cache.size());
+  for( auto& item : cache )
+    files.push_back(&item);
+
+  RunParallel(files.size(), [&files]( size_t i ) {
+    const string& path = files[i]->first;
+    SourceFile_t& src = files[i]->second;
+    errno = 0;
+    FILE* fi = fopen( path.c_str(), "r" );
+    if( !fi ) {
+      src.err = errno;
+      return;
+    }
+    char buf[8192];
+    size_t n;
+    while( (n = fread(buf, 1, sizeof(buf), fi)) > 0 )
+      src.text.append(buf, n);
+    if( ferror(fi) ) {
+      src.err = errno ? errno : EIO;
+      src.text.clear();
+    } else {
+      src.ok = true;
+      if( src.want_tstamps )
+        ParseTimestamps(fi, src.timestamps);
+    }
+    fclose(fi);
+  });
+
+  int nerr = 0;
+  for( const auto* item : files ) {
+    if( !item->second.ok ) {
+      errno = item->second.err;
+      stringstream ss("Error reading database file ",ios::out|ios::app);
+      ss << item->first;
+      perror(ss.str().c_str());
+      ++nerr;
+    }
+  }
+  return nerr;
+}
+
+//-----------------------------------------------------------------------------
+static int ExtractKeys( Detector* det, const multiset<Filenames_t>& filenames,
+			const SourceCache_t& cache )
+{
+  // Extract keys for given detector from the database files in 'filenames',
+  // whose contents and timestamps are taken from 'cache'.
+  // May be called for different detectors in parallel, provided they
+  // stage their values (see Detector::SetStaging).
 
   auto lastf = filenames.end();
   if( lastf != filenames.begin() )
@@ -2266,7 +2526,12 @@ static int ExtractKeys( Detector* det, const multiset<Filenames_t>& filenames )
     const string& path = st->path;
     time_t val_from = st->val_start, val_until = (++st)->val_start;
 
-    FILE* fi = fopen( path.c_str(), "r" );
+    auto it = cache.find(path);
+    assert( it != cache.end() );  // else bug in main
+    if( it == cache.end() || !it->second.ok )
+      continue;  // Error already reported by ReadSources
+    const SourceFile_t& src = it->second;
+    FILE* fi = OpenSource( cache, path );
     if( !fi ) {
       stringstream ss("Error opening database file ",ios::out|ios::app);
       ss << path;
@@ -2275,48 +2540,34 @@ static int ExtractKeys( Detector* det, const multiset<Filenames_t>& filenames )
     }
     current_filename = path;
 
-    // Parse the file for any timestamps and "configurations" (=variations)
+    // Timestamps in the file were found by ReadSources
     set<time_t> timestamps;
     vector<string> variations;
     timestamps.insert(val_from);
-    if( det->SupportsTimestamps() ) {
-      errno = 0;
-      ParseTimestamps(fi, timestamps);
-      if( errno ) {
-	stringstream ss("Error reading database file ",ios::out|ios::app);
-	ss << path;
-	perror(ss.str().c_str());
-	goto next;
-      }
-    }
+    if( det->SupportsTimestamps() )
+      timestamps.insert( ALL(src.timestamps) );
     if( det->SupportsVariations() ) {
       ParseVariations(fi, variations);
     }
-
     timestamps.insert( numeric_limits<time_t>::max() );
-    {
-      auto it    = timestamps.lower_bound( val_from );
-      auto lastt = timestamps.lower_bound( val_until );
-      for( ; it != lastt; ) {
-	time_t date_from = *it, date_until = *(++it);
-	if( date_from  < val_from  )  date_from  = val_from;
-	if( date_until > val_until )  date_until = val_until;
-	rewind(fi);
-	det->Clear();
-	if( det->ReadDB(fi,date_from,date_until) == 0 ) {
-	  // } else {
-	  //   cout << "Read " << path << endl;
-	  //TODO: support variations
-	  det->Save( date_from );
-	}
-	else {
-	  cerr << "Failed to read " << path << " as " << det->GetClassName()
-	       << endl;
-	}
+
+    auto jt    = timestamps.lower_bound( val_from );
+    auto lastt = timestamps.lower_bound( val_until );
+    for( ; jt != lastt; ) {
+      time_t date_from = *jt, date_until = *(++jt);
+      if( date_from  < val_from  )  date_from  = val_from;
+      if( date_until > val_until )  date_until = val_until;
+      rewind(fi);
+      det->Clear();
+      if( det->ReadDB(fi,date_from,date_until) == 0 ) {
+	//TODO: support variations
+	det->Save( date_from );
+      }
+      else {
+	cerr << "Failed to read " << path << " as " << det->GetClassName()
+	     << endl;
       }
     }
-
-  next:
     fclose(fi);
   } // end for st = filenames
 
@@ -2344,7 +2595,8 @@ static void AddSection( SectionMap_t& sections, time_t cur_date, size_t ndata,
 
 //-----------------------------------------------------------------------------
 static int CopyFiles( const string& target_dir, const vector<string>& subdirs,
-		      FilenameMap_t::const_iterator ft )
+		      FilenameMap_t::const_iterator ft,
+		      const SourceCache_t& cache )
 {
   // Copy source files given in the map 'ft' to 'target_dir' and given set
   // of subdirs. If 'subdirs' is empty or no output subdirs are requested,
@@ -2423,7 +2675,7 @@ static int CopyFiles( const string& target_dir, const vector<string>& subdirs,
       cout << "Copy " << path << " val_from = " << format_time(val_from)
 	   << " val_until = " << format_time(val_until) << endl;
 
-      FILE* fi = fopen( path.c_str(), "r" );
+      FILE* fi = OpenSource( cache, path );
       assert(fi);   // already succeeded previously
       if( !fi )
 	continue;
@@ -2648,6 +2900,19 @@ int main( int argc, char* const argv[] )
   // If the original parser supported in-file timestamps, pre-parse the
   // corresponding files to find any timestamps in them.
   // Keep all found keys/values along with timestamps in a central map.
+  //
+  // All source files are read only once, in parallel, into 'cache'. The
+  // detectors are then converted in parallel, each saving its values in a
+  // staging area. The values are added to the central map in the order of
+  // detector names, so the result does not depend on the number of threads.
+  struct ConvJob_t {
+    string        detname;
+    EDetectorType type;
+    unique_ptr<Detector> det;
+    const multiset<Filenames_t>* filenames;
+  };
+  vector<ConvJob_t> jobs;
+  SourceCache_t cache;
   for(auto & ft : filemap) {
     const string& detname = ft.first;
     multiset<Filenames_t>& filenames = ft.second;
@@ -2671,18 +2936,37 @@ int main( int argc, char* const argv[] )
 
     filenames.insert( Filenames_t(numeric_limits<time_t>::max()) );
 
-    ExtractKeys( det.get(), filenames );
+    for( const auto& fn : filenames ) {
+      if( !fn.path.empty() )
+	cache[fn.path].want_tstamps |= det->SupportsTimestamps();
+    }
+    det->SetStaging(true);
+    jobs.push_back( ConvJob_t{detname, type, std::move(det), &filenames} );
+  } // end for ft = filemap
+
+  ReadSources( cache );
+
+  if( GetNthreads(jobs.size()) > 1 )
+    ROOT::EnableThreadSafety();  // for ROOT's error message handler
+  RunParallel(jobs.size(), [&jobs, &cache]( size_t i ) {
+    ExtractKeys( jobs[i].det.get(), *jobs[i].filenames, cache );
+  });
+
+  for( auto& job : jobs ) {
+    Detector* det = job.det.get();
+    det->CommitStaged();
 
     // If requested, remove keys for this detector that only have default values
     if( purge_all_default_keys )
       det->PurgeAllDefaultKeys();
 
     // Save detector names whose database files are to be copied
-    if( do_file_copy && type == kCopyFile )
-      copy_dets.insert( detname );
+    if( do_file_copy && job.type == kCopyFile )
+      copy_dets.insert( job.detname );
 
     // Done with this detector
-  } // end for ft = filemap
+  }
+  jobs.clear();
 
   reset_tz();
 
@@ -2720,11 +3004,18 @@ int main( int argc, char* const argv[] )
       const string& detname = *it;
       auto ft = filemap.find( detname );
       assert( ft != filemap.end() );
-      if( CopyFiles(destdir,out_subdirs,ft) )
+      if( CopyFiles(destdir,out_subdirs,ft,cache) )
 	err = 8;
     }
   }
 
+  if( !err && do_validate ) {
+    set_tz( outp_tz );
+    if( ValidateDB(destdir,out_subdirs) != 0 )
+      err = 9;
+    reset_tz();
+  }
+
   return err;
 }
 
@@ -4894,7 +5185,8 @@ int Detector::AddToMap( const string& key, const Value_t& v, time_t start,
 			const string& version, int maxv ) const
 {
   // Add given key and value with given validity start time and optional
-  // "version" (secondary index) to the in-memory database.
+  // "version" (secondary index) to the in-memory database, or, if staging
+  // is enabled, to the list of values to be added by CommitStaged().
   // If value is empty, do nothing (i.e. bail if MakeValue fails).
 
   if( v.value.empty() )
@@ -4902,6 +5194,34 @@ int Detector::AddToMap( const string& key, const Value_t& v, time_t start,
   assert( v.nelem > 0 );
   assert( v.width > 0 );
 
+  DBvalue val( v, start, version, maxv );
+  if( fStaging ) {
+    fStaged.emplace_back( key, std::move(val) );
+    return 0;
+  }
+  return StoreValue( key, val );
+}
+
+//-----------------------------------------------------------------------------
+int Detector::CommitStaged()
+{
+  // Add all staged values to the in-memory database, in the order in which
+  // they were saved. Not thread-safe.
+
+  int err = 0;
+  for( const auto& keyval : fStaged ) {
+    if( StoreValue(keyval.first, keyval.second) )
+      err = 1;
+  }
+  fStaged.clear();
+  return err;
+}
+
+//-----------------------------------------------------------------------------
+int Detector::StoreValue( const string& key, const DBvalue& val ) const
+{
+  // Add given key and value to the in-memory database. Not thread-safe.
+
   // Ensure that each key can only be associated with one detector name
   auto itn = gKeyToDet.find( key );
   if( itn == gKeyToDet.end() ) {
@@ -4914,7 +5234,6 @@ int Detector::AddToMap( const string& key, const Value_t& v, time_t start,
     return 1;
   }
 
-  DBvalue val( v, start, version, maxv );
   KeyAttr_t& attr = gDB[key];
   ValSet_t& vals = attr.values;
   // Find existing values with the exact timestamp of 'val' (='start')
@@ -4925,13 +5244,13 @@ int Detector::AddToMap( const string& key, const Value_t& v, time_t start,
       // (This case is silently ignored in THaAnalysisObject::LoadDBvalue,
       // which simply takes the last value encountered.)
       cerr << "WARNING: key " << key << " already exists for time "
-	   << format_time(start);
-      if( !version.empty() )
-	cerr << " and version \"" << version << "\"";
+	   << format_time(val.validity_start);
+      if( !val.version.empty() )
+	cerr << " and version \"" << val.version << "\"";
       cerr << ", but with a different value:" << endl;
       cerr << " old = " << pos->value << endl;
-      cerr << " new = " << v.value << endl;
-      const_cast<DBvalue&>(*pos).value = v.value;
+      cerr << " new = " << val.value << endl;
+      const_cast<DBvalue&>(*pos).value = val.value;
     }
     return 0;
   }
@@ -4944,10 +5263,9 @@ int Detector::AddToMap( const string& key, const Value_t& v, time_t start,
 }
 
 //-----------------------------------------------------------------------------
-int CopyFile::AddToMap( const string& key, const Value_t& value, time_t start,
-			const string& version, int maxv ) const
+int CopyFile::StoreValue( const string& key, const DBvalue& val ) const
 {
-  int err = Detector::AddToMap(key, value, start, version, maxv);
+  int err = Detector::StoreValue(key, val);
   if( err )
     return err;
 
@@ -0,0 +1,169 @@
+//
+// mergeshards.cxx
+//
+// Utility to merge the ROOT output files of several analyses of parts
+// (shards) of the same run, made with THaAnalyzer::EnableShardMode and
+// THaRunBase::SetEventRange.
+//
+// Unlike a plain hadd, the input files are sorted by the first event
+// of the event range recorded in their run object ("Run_Data"), so the
+// merged trees are in event order regardless of the order in which the
+// files are given. Shards of a split run analyzed as chained segments
+// (THaRun::SetChainSegments) are sorted by their first segment instead.
+// The ranges are checked for overlaps. Histograms are
+// summed, trees are concatenated, and the run objects are combined via
+// THaRunBase::Merge.
+//
+// Usage: mergeshards [-f] [-v] output.root input1.root input2.root ...
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <cstdlib>
+#include <utility>
+#include <getopt.h>
+
+#include "TFile.h"
+#include "TFileMerger.h"
+#include "TError.h"
+
+#include "THaRunBase.h"
+#include "THaRun.h"
+
+using namespace std;
+
+static const char* const kRunObjName = "Run_Data";
+
+class Shard_t {
+public:
+  Shard_t( string _name, UInt_t _first, UInt_t _last, UInt_t _run )
+    : name(std::move(_name)), first(_first), last(_last), run(_run),
+      firstseg(0), lastseg(0) {}
+  string name;    // File name
+  UInt_t first;   // First event of range analyzed
+  UInt_t last;    // Last event of range analyzed
+  UInt_t run;     // Run number
+  Int_t  firstseg; // First segment analyzed
+  Int_t  lastseg;  // Last segment analyzed
+};
+
+//_____________________________________________________________________________
+static void usage( const char* prgname )
+{
+  cerr << "Usage: " << prgname
+       << " [-f] [-v] output.root input1.root [input2.root ...]" << endl
+       << "  -f  overwrite existing output file" << endl
+       << "  -v  verbose output" << endl;
+  exit(255);
+}
+
+//_____________________________________________________________________________
+static bool GetShardInfo( const string& filename, vector<Shard_t>& shards )
+{
+  // Read the run object from 'filename' and record its event range
+
+  unique_ptr<TFile> file(TFile::Open(filename.c_str(), "READ"));
+  if( !file || file->IsZombie() ) {
+    ::Error( "mergeshards", "Cannot open input file %s", filename.c_str() );
+    return false;
+  }
+  auto* run = dynamic_cast<THaRunBase*>(file->Get(kRunObjName));
+  if( !run ) {
+    ::Error( "mergeshards", "File %s contains no run object \"%s\"",
+             filename.c_str(), kRunObjName );
+    return false;
+  }
+  shards.emplace_back(filename, run->GetFirstEvent(), run->GetLastEvent(),
+                      run->GetNumber());
+  if( auto* segrun = dynamic_cast<THaRun*>(run) ) {
+    shards.back().firstseg = segrun->GetSegment();
+    shards.back().lastseg  = segrun->GetCurrentSegment();
+  }
+  delete run;
+  return true;
+}
+
+//_____________________________________________________________________________
+int main( int argc, char* argv[] )
+{
+  bool force = false, verbose = false;
+  int opt;
+  while( (opt = getopt(argc, argv, "fvh")) != -1 ) {
+    switch( opt ) {
+    case 'f':
+      force = true;
+      break;
+    case 'v':
+      verbose = true;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if( argc - optind < 2 )
+    usage(argv[0]);
+
+  string outname = argv[optind++];
+  vector<Shard_t> shards;
+  for( int i = optind; i < argc; ++i ) {
+    if( !GetShardInfo(argv[i], shards) )
+      return 1;
+  }
+
+  // Sort by segment and event range so that the result does not depend on
+  // the order of the input files
+  stable_sort( shards.begin(), shards.end(),
+               []( const Shard_t& a, const Shard_t& b ) {
+                 if( a.firstseg != b.firstseg )
+                   return a.firstseg < b.firstseg;
+                 return a.first < b.first;
+               });
+
+  int ret = 0;
+  for( size_t i = 0; i < shards.size(); ++i ) {
+    const Shard_t& sh = shards[i];
+    if( verbose ) {
+      cout << sh.name << ": run " << sh.run;
+      if( sh.lastseg > sh.firstseg )
+        cout << ", segments " << sh.firstseg << "-" << sh.lastseg;
+      else
+        cout << ", segment " << sh.firstseg;
+      cout << ", events " << sh.first << "-" << sh.last << endl;
+    }
+    if( sh.run != shards[0].run ) {
+      ::Error( "mergeshards", "File %s is from run %u, expected run %u",
+               sh.name.c_str(), sh.run, shards[0].run );
+      ret = 2;
+    }
+    if( i > 0 && sh.firstseg <= shards[i-1].lastseg &&
+        sh.first <= shards[i-1].last ) {
+      ::Error( "mergeshards", "Event ranges of %s and %s overlap",
+               shards[i-1].name.c_str(), sh.name.c_str() );
+      ret = 2;
+    }
+  }
+  if( ret != 0 )
+    return ret;
+
+  TFileMerger merger(false);
+  merger.SetPrintLevel(verbose ? 1 : 0);
+  if( !merger.OutputFile(outname.c_str(), force) ) {
+    ::Error( "mergeshards", "Cannot open output file %s. "
+             "Use -f to overwrite an existing file.", outname.c_str() );
+    return 3;
+  }
+  for( const auto& sh : shards ) {
+    if( !merger.AddFile(sh.name.c_str(), false) )
+      return 3;
+  }
+  if( !merger.Merge() ) {
+    ::Error( "mergeshards", "Merging failed" );
+    return 4;
+  }
+  if( verbose )
+    cout << "Merged " << shards.size() << " files into " << outname << endl;
+
+  return 0;
+}
@@ -0,0 +1,386 @@
+//
+// replaybench.cxx
+//
+// End-to-end replay benchmark. Analyzes a CODA file with a standard
+// single-arm setup, modeled on examples/setup.C: the right HRS with VDC,
+// S1 and S2 scintillators, gas Cherenkov, preshower and shower, an ideal
+// beam, and the golden track, reaction point, extended target correction
+// and electron kinematics physics modules. The output tree is defined by
+// a representative output definition file, or by the one given with -d.
+//
+// The result is written as JSON, for comparison across releases and
+// compiler options: the overall event rate, the real time and the
+// per-event latency percentiles of each analysis stage (from the
+// analyzer's timers, see THaAnalyzer::EnableLatencyStats), and the peak
+// resident set size of the process. With -S, the slowest events are
+// written to a file for replay (see THaAnalyzer::SetSlowEventFile).
+//
+// -P selects the allocation policy for the large decoder buffers (see
+// Podd::PageAlloc), e.g. "huge,prefault". The page faults during the
+// replay are part of the report, so that runs with and without -P can
+// be compared.
+//
+// The database is looked up as usual, i.e. via $DB_DIR or ./DB.
+//
+// Usage: replaybench [options] input.dat
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <getopt.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include "TROOT.h"
+#include "TList.h"
+#include "TError.h"
+
+#include "THaInterface.h"
+#include "THaGlobals.h"
+#include "THaAnalyzer.h"
+#include "THaRun.h"
+#include "THaEvent.h"
+#include "THaHRS.h"
+#include "THaCherenkov.h"
+#include "THaShower.h"
+#include "THaIdealBeam.h"
+#include "THaGoldenTrack.h"
+#include "THaReactionPoint.h"
+#include "THaExtTarCor.h"
+#include "THaElectronKine.h"
+#include "Profiler.h"
+#include "PageAlloc.h"
+
+using namespace std;
+
+// Default output definition, similar in size to a typical production
+// replay on one spectrometer arm
+static const char* const kDefaultOdef =
+  "block R.tr.*\n"
+  "block R.gold.*\n"
+  "block R.s1.*\n"
+  "block R.s2.*\n"
+  "block R.cer.*\n"
+  "block R.ps.*\n"
+  "block R.sh.*\n"
+  "block EK_R.*\n"
+  "block EKxc_R.*\n"
+  "variable R.vdc.u1.nhit\n"
+  "variable R.vdc.v1.nhit\n"
+  "variable R.vdc.u2.nhit\n"
+  "variable R.vdc.v2.nhit\n"
+  "formula Etot_R R.ps.e+R.sh.e\n"
+  "TH1F rtrn 'R-arm number of tracks' R.tr.n 10 0 10\n"
+  "TH1F rdp 'R-arm golden track dp' R.gold.dp 200 -0.1 0.1\n"
+  "TH1F rv1 'R-arm VDC V1 wires' R.vdc.v1.wire 400 0 400\n"
+  "TH1F rcer 'R-arm Cherenkov sum' R.cer.asum_c 200 0 10000\n"
+  "TH1F retot 'R-arm total shower energy' Etot_R 200 0 5000\n"
+  "TH1F rq2 'R-arm Q^2' EK_R.Q2 200 0 2\n"
+  "TH2F rthph 'R-arm theta vs phi' R.gold.ph R.gold.th"
+  " 100 -0.05 0.05 100 -0.1 0.1\n"
+  "TH2F rshps 'R-arm shower vs preshower' R.ps.e R.sh.e"
+  " 100 0 2000 100 0 4000\n";
+
+// Analysis stages reported, in order. These are the names of the
+// THaAnalyzer timers below "Total".
+static const char* const kStages[] = {
+  "RawDecode", "Decode", "CoarseTracking", "CoarseReconstruct",
+  "Tracking", "Reconstruct", "Physics", "Output"
+};
+
+//_____________________________________________________________________________
+static void usage( const char* prgname )
+{
+  cerr << "Usage: " << prgname << " [options] input.dat" << endl
+       << "  -n <events>   analyze at most this many events" << endl
+       << "  -f <event>    first event to analyze (default 1)" << endl
+       << "  -c <2|3>      CODA version of the input (default: auto)" << endl
+       << "  -d <file>     output definition file (default: built-in)" << endl
+       << "  -C <file>     cut definition file (default: none)" << endl
+       << "  -o <file>     ROOT output file (default replaybench.root)" << endl
+       << "  -O <file>     JSON report file (default replaybench.json)" << endl
+       << "  -l <label>    label to include in the report" << endl
+       << "  -S <file>     write the slowest events to this file" << endl
+       << "  -N <n>        number of slowest events (default 100)" << endl
+       << "  -P <mode>     buffer allocation: huge,prefault or off (default)"
+       << endl
+       << "  -v            verbose analyzer output" << endl;
+  exit(255);
+}
+
+//_____________________________________________________________________________
+static long PeakRSS()
+{
+  // Peak resident set size of this process in kB
+
+  struct rusage ru{};
+  if( getrusage(RUSAGE_SELF, &ru) != 0 )
+    return -1;
+#ifdef __APPLE__
+  return ru.ru_maxrss / 1024;  // bytes
+#else
+  return ru.ru_maxrss;         // kB
+#endif
+}
+
+//_____________________________________________________________________________
+static void PageFaults( long& minflt, long& majflt )
+{
+  // Page faults of this process so far
+
+  struct rusage ru{};
+  minflt = majflt = -1;
+  if( getrusage(RUSAGE_SELF, &ru) == 0 ) {
+    minflt = ru.ru_minflt;
+    majflt = ru.ru_majflt;
+  }
+}
+
+//_____________________________________________________________________________
+static string Quote( const string& s )
+{
+  // String 's' as a JSON string literal
+
+  string q = "\"";
+  for( char c : s ) {
+    if( c == '"' || c == '\\' ) {
+      q += '\\'; q += c;
+    } else if( static_cast<unsigned char>(c) < 0x20 ) {
+      char esc[8];
+      snprintf(esc, sizeof(esc), "\\u%04x", c);
+      q += esc;
+    } else
+      q += c;
+  }
+  return q + "\"";
+}
+
+//_____________________________________________________________________________
+static void SetupHRS()
+{
+  // Right HRS with the detectors of a typical single-arm experiment,
+  // plus beam and physics modules. gHaApps/gHaPhysics own the objects.
+
+  THaApparatus* HRSR = new THaHRS("R", "Right arm HRS");  // vdc, s1, s2
+  HRSR->AddDetector( new THaCherenkov("cer", "Gas Cherenkov counter") );
+  HRSR->AddDetector( new THaShower("ps", "Preshower counter") );
+  HRSR->AddDetector( new THaShower("sh", "Shower counter") );
+  gHaApps->Add( HRSR );
+  gHaApps->Add( new THaIdealBeam("Beam", "Ideal beam") );
+
+  const Double_t mass_tg = 12.0 * 0.931494;  // C12 (GeV)
+  gHaPhysics->Add( new THaGoldenTrack("R.gold", "Golden track for HRS-R",
+                                      "R") );
+  gHaPhysics->Add( new THaElectronKine("EK_R", "Electron kinematics in HRS-R",
+                                       "R", mass_tg) );
+  gHaPhysics->Add( new THaReactionPoint("ReactPt_R", "Reaction vertex HRS-R",
+                                        "R", "Beam") );
+  gHaPhysics->Add( new THaExtTarCor("ExTgtCor_R", "Extended target "
+                                    "corrections HRS-R", "R", "ReactPt_R") );
+  gHaPhysics->Add( new THaElectronKine("EKxc_R", "Corrected electron "
+                                       "kinematics HRS-R", "ExTgtCor_R",
+                                       mass_tg) );
+}
+
+//_____________________________________________________________________________
+int main( int argc, char* argv[] )
+{
+  UInt_t nev = 0, first = 1;
+  Int_t coda_version = 0, verbose = 0;
+  string odef, cuts, outfile = "replaybench.root";
+  string report = "replaybench.json", label, slowfile, pagemode = "off";
+  UInt_t nslow = 100;
+  int opt;
+  while( (opt = getopt(argc, argv, "n:f:c:d:C:o:O:l:S:N:P:vh")) != -1 ) {
+    switch( opt ) {
+    case 'n':
+      nev = strtoul(optarg, nullptr, 0);
+      break;
+    case 'f':
+      first = strtoul(optarg, nullptr, 0);
+      break;
+    case 'c':
+      coda_version = atoi(optarg);
+      if( coda_version != 2 && coda_version != 3 )
+        usage(argv[0]);
+      break;
+    case 'd':
+      odef = optarg;
+      break;
+    case 'C':
+      cuts = optarg;
+      break;
+    case 'o':
+      outfile = optarg;
+      break;
+    case 'O':
+      report = optarg;
+      break;
+    case 'l':
+      label = optarg;
+      break;
+    case 'S':
+      slowfile = optarg;
+      break;
+    case 'N':
+      nslow = strtoul(optarg, nullptr, 0);
+      break;
+    case 'P': {
+      Int_t mode = Podd::PageAlloc::ParseMode(optarg);
+      if( mode < 0 )
+        usage(argv[0]);
+      Podd::PageAlloc::SetMode(mode);
+      pagemode = optarg;
+      break;
+    }
+    case 'v':
+      ++verbose;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if( argc - optind != 1 )
+    usage(argv[0]);
+  const string input = argv[optind];
+
+  // Set up the analyzer environment (global lists etc.) without passing
+  // our options to ROOT
+  int rargc = 1;
+  THaInterface theApp("replaybench", &rargc, argv, nullptr, 0, true);
+  gROOT->SetBatch(true);
+
+  if( odef.empty() ) {
+    odef = outfile + ".odef";
+    ofstream ofs(odef);
+    ofs << kDefaultOdef;
+    if( !ofs ) {
+      ::Error( "replaybench", "Cannot write output definition %s",
+               odef.c_str() );
+      return 2;
+    }
+  }
+
+  SetupHRS();
+
+  THaAnalyzer analyzer;
+  THaEvent event;
+  THaRun run(input.c_str());
+  if( nev > 0 )
+    run.SetEventRange(first, first + nev - 1);
+  else
+    run.SetFirstEvent(first);
+
+  analyzer.SetEvent(&event);
+  analyzer.SetOutFile(outfile.c_str());
+  analyzer.SetOdefFile(odef.c_str());
+  if( !cuts.empty() )
+    analyzer.SetCutFile(cuts.c_str());
+  if( coda_version > 0 )
+    analyzer.SetCodaVersion(coda_version);
+  analyzer.SetVerbosity(verbose);
+  analyzer.EnableLatencyStats();
+  if( !slowfile.empty() )
+    analyzer.SetSlowEventFile(slowfile.c_str(), nslow);
+
+  long minflt0, majflt0, minflt, majflt;
+  PageFaults(minflt0, majflt0);
+  auto start = chrono::steady_clock::now();
+  Int_t nread = analyzer.Process(run);
+  Double_t real_time =
+    chrono::duration<Double_t>(chrono::steady_clock::now() - start).count();
+  PageFaults(minflt, majflt);
+  if( nread <= 0 ) {
+    ::Error( "replaybench", "Analysis of %s failed (status %d)",
+             input.c_str(), nread );
+    return 3;
+  }
+
+  const Podd::Profiler* prof = analyzer.GetProfiler();
+  auto total = prof->Find("Total");
+  auto decode = prof->Find("Decode", total);
+  ULong64_t nphys = (decode != Podd::Profiler::kNoParent)
+                    ? prof->GetNCalls(decode) : 0;
+
+  // The analyzer prints its own summary to standard output, so the
+  // report goes to a file
+  ofstream os(report);
+  if( !os ) {
+    ::Error( "replaybench", "Cannot open report file %s", report.c_str() );
+    return 2;
+  }
+
+  char host[256] = "";
+  gethostname(host, sizeof(host)-1);
+  time_t now = time(nullptr);
+  char date[32];
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+  os << "{" << endl
+     << "  \"context\": {" << endl
+     << "    \"date\": " << Quote(date) << "," << endl
+     << "    \"host_name\": " << Quote(host) << "," << endl
+     << "    \"version\": " << Quote(THaInterface::GetVersionString()) << ","
+     << endl
+     << "    \"label\": " << Quote(label) << "," << endl
+     << "    \"input\": " << Quote(input) << "," << endl
+     << "    \"odef\": " << Quote(odef) << "," << endl
+     << "    \"page_mode\": " << Quote(pagemode) << endl
+     << "  }," << endl
+     << "  \"events\": " << nread << "," << endl
+     << "  \"physics_events\": " << nphys << "," << endl
+     << "  \"real_time_s\": " << real_time << "," << endl
+     << "  \"events_per_second\": " << nread / real_time << "," << endl
+     << "  \"physics_events_per_second\": " << nphys / real_time << ","
+     << endl
+     << "  \"peak_rss_kb\": " << PeakRSS() << "," << endl
+     << "  \"minor_page_faults\": " << minflt - minflt0 << "," << endl
+     << "  \"major_page_faults\": " << majflt - majflt0 << "," << endl;
+  const Podd::LatencyHistogram* evlat = analyzer.GetEventLatency();
+  if( evlat && evlat->GetCount() > 0 ) {
+    os << "  \"event_latency\": {" << endl
+       << "    \"mean_ns\": " << evlat->GetMean() << "," << endl
+       << "    \"p50_ns\": " << evlat->GetPercentile(50) << "," << endl
+       << "    \"p90_ns\": " << evlat->GetPercentile(90) << "," << endl
+       << "    \"p99_ns\": " << evlat->GetPercentile(99) << "," << endl
+       << "    \"p999_ns\": " << evlat->GetPercentile(99.9) << "," << endl
+       << "    \"max_ns\": " << evlat->GetMax() << endl
+       << "  }," << endl;
+  }
+  os << "  \"stages\": [";
+  const char* sep = "";
+  for( const char* name : kStages ) {
+    auto h = prof->Find(name, total);
+    if( h == Podd::Profiler::kNoParent )
+      continue;
+    const Podd::LatencyHistogram* lat = prof->GetLatency(h);
+    os << sep << endl
+       << "    {" << endl
+       << "      \"name\": " << Quote(name) << "," << endl
+       << "      \"calls\": " << prof->GetNCalls(h) << "," << endl
+       << "      \"real_time_s\": " << prof->GetRealTime(h);
+    if( lat && lat->GetCount() > 0 ) {
+      os << "," << endl
+         << "      \"mean_ns\": " << lat->GetMean() << "," << endl
+         << "      \"p50_ns\": " << lat->GetPercentile(50) << "," << endl
+         << "      \"p90_ns\": " << lat->GetPercentile(90) << "," << endl
+         << "      \"p99_ns\": " << lat->GetPercentile(99) << "," << endl
+         << "      \"p999_ns\": " << lat->GetPercentile(99.9) << "," << endl
+         << "      \"max_ns\": " << lat->GetMax();
+    }
+    os << endl << "    }";
+    sep = ",";
+  }
+  os << endl << "  ]" << endl << "}" << endl;
+  if( !os ) {
+    ::Error( "replaybench", "Error writing report file %s", report.c_str() );
+    return 2;
+  }
+  cout << "Benchmark report written to " << report << endl;
+
+  return 0;
+}
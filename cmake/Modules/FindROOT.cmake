@@ -205,6 +205,7 @@ endif()
 #
 # Creates a custom target ${dictionary}_ROOTDICT.
 # With ROOT 6, also installs the PCM file in ${CMAKE_INSTALL_LIBDIR}
+# and, if PODD_ROOTMAP is set, generates and installs lib${pcmname}.rootmap.
 #
 function(build_root_dictionary dictionary)
 
@@ -250,13 +251,23 @@ function(build_root_dictionary dictionary)
     else()
       set(pcmname ${dictionary})
     endif()
+    # With a rootmap, ROOT loads the library only when one of its classes is
+    # first used, so programs and macros need not load it at startup
+    set(rootmap_args)
+    set(rootmap_file)
+    if(PODD_ROOTMAP)
+      set(rootmap_file lib${pcmname}.rootmap)
+      set(rootmap_args
+        -rml lib${pcmname}${CMAKE_SHARED_LIBRARY_SUFFIX} -rmf ${rootmap_file})
+    endif()
     add_custom_command(
-      OUTPUT ${dictionary}Dict.cxx lib${pcmname}_rdict.pcm
+      OUTPUT ${dictionary}Dict.cxx lib${pcmname}_rdict.pcm ${rootmap_file}
       COMMAND ${MK_ROOTDICT}
       ARGS
         ${ROOTCLING}
         -f ${dictionary}Dict.cxx
         -s lib${pcmname}
+        ${rootmap_args}
         ${RGD_OPTIONS}
         INCDIRS "${incdirs}"
         DEFINES "${defines}"
@@ -267,6 +278,10 @@ function(build_root_dictionary dictionary)
     )
     set(PCM_FILE ${CMAKE_CURRENT_BINARY_DIR}/lib${pcmname}_rdict.pcm)
     install(FILES ${PCM_FILE} DESTINATION ${CMAKE_INSTALL_LIBDIR})
+    if(PODD_ROOTMAP)
+      install(FILES ${CMAKE_CURRENT_BINARY_DIR}/${rootmap_file}
+        DESTINATION ${CMAKE_INSTALL_LIBDIR})
+    endif()
   else()
     # ROOT5
     add_custom_command(
@@ -14,6 +14,7 @@ endif()
 # Build options
 option(WITH_DEBUG "Enable support for detailed debug messages" ON)
 option(PODD_SET_RPATH "Set RPATH on installed executables & libraries" ON)
+option(PODD_ROOTMAP "Generate rootmap files for on-demand library loading" OFF)
 
 #----------------------------------------------------------------------------
 # Project-specific build flags
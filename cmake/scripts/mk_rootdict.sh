@@ -49,7 +49,7 @@ shift
 while [[ $# -gt 0 ]]; do
     key="$1"
     case $key in
-	-s)
+	-s|-rml|-rmf)
 	    PCMNAME+=("$1")
 	    shift
 	    PCMNAME+=("$1")
@@ -0,0 +1,148 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::AllocCounter
+//
+// Counts calls to the global operator new and the number of bytes
+// requested, per thread. The difference of two Get() results from the
+// same thread gives the allocations made by the code in between, which is
+// what Profiler timers record if Profiler::SetCountAllocs is set.
+//
+// Counting requires replacing the global operator new/delete, so it is
+// only compiled in if the build option PODD_ALLOC_TRACKING is set
+// (cmake -DPODD_ALLOC_TRACKING=ON). Otherwise, IsAvailable() is false and
+// all counts remain zero. The replacement only takes effect if this
+// library is linked into the executable, as for "analyzer". Even when
+// compiled in, counting is off until Enable() is called, which leaves
+// the cost of one test per allocation.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "AllocCounter.h"
+#include <atomic>
+
+#ifdef PODD_ALLOC_TRACKING
+#include <cstdlib>
+#include <new>
+
+static std::atomic<bool> gCountAllocs(false);
+static thread_local ULong64_t tNalloc = 0;
+static thread_local ULong64_t tNbytes = 0;
+
+//_____________________________________________________________________________
+static inline void* CountedAlloc( size_t sz )
+{
+  if( gCountAllocs.load(std::memory_order_relaxed) ) {
+    ++tNalloc;
+    tNbytes += sz;
+  }
+  return std::malloc(sz ? sz : 1);
+}
+
+//_____________________________________________________________________________
+void* operator new( size_t sz )
+{
+  void* p = CountedAlloc(sz);
+  if( !p )
+    throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[]( size_t sz )
+{
+  void* p = CountedAlloc(sz);
+  if( !p )
+    throw std::bad_alloc();
+  return p;
+}
+
+void* operator new( size_t sz, const std::nothrow_t& ) noexcept
+{
+  return CountedAlloc(sz);
+}
+
+void* operator new[]( size_t sz, const std::nothrow_t& ) noexcept
+{
+  return CountedAlloc(sz);
+}
+
+void operator delete( void* p ) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[]( void* p ) noexcept
+{
+  std::free(p);
+}
+
+void operator delete( void* p, const std::nothrow_t& ) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[]( void* p, const std::nothrow_t& ) noexcept
+{
+  std::free(p);
+}
+
+#ifdef __cpp_sized_deallocation
+void operator delete( void* p, size_t ) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[]( void* p, size_t ) noexcept
+{
+  std::free(p);
+}
+#endif
+#endif
+
+namespace Podd {
+
+//_____________________________________________________________________________
+Bool_t AllocCounter::IsAvailable()
+{
+#ifdef PODD_ALLOC_TRACKING
+  return true;
+#else
+  return false;
+#endif
+}
+
+//_____________________________________________________________________________
+void AllocCounter::Enable( Bool_t enable )
+{
+  // Start/stop counting allocations in all threads
+
+#ifdef PODD_ALLOC_TRACKING
+  gCountAllocs.store(enable, std::memory_order_relaxed);
+#else
+  (void)enable;
+#endif
+}
+
+//_____________________________________________________________________________
+Bool_t AllocCounter::IsEnabled()
+{
+#ifdef PODD_ALLOC_TRACKING
+  return gCountAllocs.load(std::memory_order_relaxed);
+#else
+  return false;
+#endif
+}
+
+//_____________________________________________________________________________
+AllocCounter::Count_t AllocCounter::Get()
+{
+  // Allocations made so far by the calling thread while counting was enabled
+
+  Count_t c;
+#ifdef PODD_ALLOC_TRACKING
+  c.n = tNalloc;
+  c.bytes = tNbytes;
+#endif
+  return c;
+}
+
+} // namespace Podd
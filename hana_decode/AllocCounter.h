@@ -0,0 +1,35 @@
+#ifndef Podd_AllocCounter_h_
+#define Podd_AllocCounter_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::AllocCounter
+//
+// Optional counting of heap allocations, for profiling
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+
+namespace Podd {
+
+class AllocCounter {
+
+public:
+  struct Count_t {
+    Count_t() : n(0), bytes(0) {}
+    ULong64_t n;      // Number of allocations
+    ULong64_t bytes;  // Number of bytes allocated
+  };
+
+  // Allocation counting compiled in (build option PODD_ALLOC_TRACKING)
+  static Bool_t  IsAvailable();
+  static void    Enable( Bool_t enable = true );
+  static Bool_t  IsEnabled();
+  // Allocations made by the calling thread while counting was enabled
+  static Count_t Get();
+};
+
+} // namespace Podd
+
+#endif
@@ -0,0 +1,154 @@
+/////////////////////////////////////////////////////////////////////
+//
+//   BankDirectory
+//
+//   Directory of the EVIO banks of one raw event, for event type
+//   handlers and other code that looks for data by bank tag.
+//
+//   Build() walks the EVIO structure of the event once: the event
+//   bank itself (level 0), its children (level 1), and so on for all
+//   containers (banks of banks, segments or tagsegments). Banks with
+//   any other content type are leaves; their data are not interpreted.
+//   Parsing of a container stops at the first child whose length
+//   exceeds the container, as in corrupt or non-EVIO data, keeping the
+//   banks found so far.
+//
+//   Find() and GetView() then look up banks by tag and num. Views
+//   point directly into the event buffer; nothing is copied.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include "BankDirectory.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+using namespace std;
+
+namespace Decoder {
+
+// Limit on the nesting depth, against pathological input
+static const UInt_t kMaxLevel = 16;
+
+//_____________________________________________________________________________
+UInt_t BankDirectory::Build( const UInt_t* evbuffer, UInt_t length )
+{
+  // Parse the event in 'evbuffer', which has 'length' words including the
+  // length word, and list all banks found. Returns the number of banks.
+
+  fBanks.clear();
+  fBuffer = evbuffer;
+  fLength = length;
+  fValid = true;
+  if( !evbuffer || length < 2 || evbuffer[0]+1 > length )
+    return 0;
+
+  UInt_t end = evbuffer[0]+1;
+  UInt_t head = evbuffer[1];
+  UInt_t type = (head >> 8) & 0x3f;
+  fBanks.emplace_back(head >> 16, head & 0xff, type, 0, 2, end-2);
+  ParseChildren(type, 2, end, 1);
+
+  return fBanks.size();
+}
+
+//_____________________________________________________________________________
+void BankDirectory::ParseChildren( UInt_t type, UInt_t pos, UInt_t end,
+                                   UInt_t level )
+{
+  // Add the children of the container of EVIO content 'type' whose data
+  // occupy fBuffer[pos] to fBuffer[end-1], and recursively theirs.
+
+  if( level > kMaxLevel )
+    return;
+
+  switch( type ) {
+  case 0x0e:
+  case 0x10:  // Banks: length word, then tag(16) type(8) num(8)
+    while( pos+2 <= end ) {
+      UInt_t len = fBuffer[pos];
+      if( len == 0 || len+1 > end-pos )
+        break;
+      UInt_t head = fBuffer[pos+1];
+      UInt_t ctype = (head >> 8) & 0x3f;
+      fBanks.emplace_back(head >> 16, head & 0xff, ctype, level, pos+2, len-1);
+      ParseChildren(ctype, pos+2, pos+len+1, level+1);
+      pos += len+1;
+    }
+    break;
+  case 0x0d:
+  case 0x20:  // Segments: tag(8) type(8) length(16)
+  case 0x0c:  // Tagsegments: tag(12) type(4) length(16)
+    while( pos < end ) {
+      UInt_t head = fBuffer[pos];
+      UInt_t len = head & 0xffff;
+      if( len+1 > end-pos )
+        break;
+      UInt_t tag, ctype;
+      if( type == 0x0c ) {
+        tag = head >> 20;
+        ctype = (head >> 16) & 0xf;
+      } else {
+        tag = head >> 24;
+        ctype = (head >> 16) & 0x3f;
+      }
+      fBanks.emplace_back(tag, 0, ctype, level, pos+1, len);
+      ParseChildren(ctype, pos+1, pos+len+1, level+1);
+      pos += len+1;
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+//_____________________________________________________________________________
+Int_t BankDirectory::Find( UInt_t tag, UInt_t num, UInt_t start ) const
+{
+  // Index of the first bank at or after 'start' with the given tag and,
+  // unless 'num' is kAnyNum, num. Returns -1 if there is none.
+
+  for( UInt_t i = start; i < fBanks.size(); ++i ) {
+    const BankInfo_t& b = fBanks[i];
+    if( b.tag == tag && (num == kAnyNum || b.num == num) )
+      return static_cast<Int_t>(i);
+  }
+  return -1;
+}
+
+//_____________________________________________________________________________
+BankView BankDirectory::GetView( UInt_t i ) const
+{
+  // View of the data of bank #i
+
+  const BankInfo_t& b = fBanks.at(i);
+  return { fBuffer + b.pos, b.len, b.tag, b.num, b.type };
+}
+
+//_____________________________________________________________________________
+BankView BankDirectory::GetView( UInt_t tag, UInt_t num ) const
+{
+  // View of the data of the first bank with the given tag and num
+  // (or any num if kAnyNum). Empty if there is no such bank.
+
+  Int_t i = Find(tag, num);
+  return (i >= 0) ? GetView(i) : BankView();
+}
+
+//_____________________________________________________________________________
+void BankDirectory::Print() const
+{
+  // Print the directory, children indented below their parent
+
+  cout << "Bank directory: " << fBanks.size() << " banks" << endl;
+  for( const auto& b : fBanks ) {
+    cout << string(2*b.level, ' ')
+         << "tag = 0x" << hex << setw(4) << setfill('0') << b.tag
+         << setfill(' ') << dec
+         << "  num = " << setw(3) << b.num
+         << "  type = 0x" << hex << b.type << dec
+         << "  pos = " << b.pos << "  len = " << b.len << endl;
+  }
+}
+
+} // namespace Decoder
@@ -0,0 +1,98 @@
+#ifndef Podd_BankDirectory_h_
+#define Podd_BankDirectory_h_
+
+/////////////////////////////////////////////////////////////////////
+//
+//   BankDirectory
+//   Directory of the EVIO banks of one raw event.
+//
+//   Lists the tag, num, content type, nesting level and the data
+//   coordinates of every bank, segment and tagsegment in the event,
+//   in buffer order. Built once per event by THaEvData on first use,
+//   so that all event type handlers share one parse of the event.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <cassert>
+#include <vector>
+
+namespace Decoder {
+
+// Read-only view of the data words of one bank in the raw event buffer.
+// Valid until the next event is loaded.
+class BankView {
+public:
+  BankView() : fData(nullptr), fN(0), fTag(0), fNum(0), fType(0) {}
+  BankView( const UInt_t* dat, UInt_t n, UInt_t tag, UInt_t num, UInt_t type )
+    : fData(dat), fN(n), fTag(tag), fNum(num), fType(type) {}
+  UInt_t        size()  const { return fN; }
+  bool          empty() const { return fN == 0; }
+  UInt_t        operator[]( UInt_t i ) const { assert(i < fN); return fData[i]; }
+  const UInt_t* data()  const { return fData; }
+  const UInt_t* begin() const { return fData; }
+  const UInt_t* end()   const { return fData+fN; }
+  UInt_t        tag()   const { return fTag; }
+  UInt_t        num()   const { return fNum; }
+  UInt_t        type()  const { return fType; }
+private:
+  const UInt_t* fData;  // First data word (after the header)
+  UInt_t        fN;     // Number of data words
+  UInt_t        fTag;   // Bank tag
+  UInt_t        fNum;   // Bank num (0 for segments)
+  UInt_t        fType;  // EVIO content type
+};
+
+class BankDirectory {
+public:
+  BankDirectory() : fBuffer(nullptr), fLength(0), fValid(false) {}
+
+  static const UInt_t kAnyNum = kMaxUInt;
+
+  class BankInfo_t {           // Coordinates of one bank in the raw event
+  public:
+    BankInfo_t( UInt_t tag, UInt_t num, UInt_t type, UInt_t level,
+                UInt_t pos, UInt_t len )
+      : tag(tag), num(num), type(type), level(level), pos(pos), len(len) {}
+    UInt_t tag;    // Bank tag
+    UInt_t num;    // Bank num (0 for segments and tagsegments)
+    UInt_t type;   // EVIO content type
+    UInt_t level;  // Nesting level (0 = the event itself)
+    UInt_t pos;    // Position of first data word in evbuffer[]
+    UInt_t len;    // Number of data words
+  };
+
+  // Parse the event in 'evbuffer' of 'length' words. Returns the number
+  // of banks found.
+  UInt_t Build( const UInt_t* evbuffer, UInt_t length );
+  void   Clear() { fBanks.clear(); fBuffer = nullptr; fLength = 0; fValid = false; }
+
+  // True if the directory is current for the given event buffer
+  Bool_t IsFor( const UInt_t* evbuffer, UInt_t length ) const {
+    return fValid && evbuffer == fBuffer && length == fLength;
+  }
+
+  UInt_t            GetSize() const { return fBanks.size(); }
+  const BankInfo_t& GetBank( UInt_t i ) const { return fBanks.at(i); }
+  // Index of the first bank with the given tag and num at or after
+  // index 'start', or -1 if none
+  Int_t             Find( UInt_t tag, UInt_t num = kAnyNum,
+                          UInt_t start = 0 ) const;
+  BankView          GetView( UInt_t i ) const;
+  // View of the first bank with the given tag and num. Empty if none.
+  BankView          GetView( UInt_t tag, UInt_t num ) const;
+
+  void              Print() const;
+
+private:
+  const UInt_t*           fBuffer;  // Event buffer parsed
+  UInt_t                  fLength;  // Its length
+  Bool_t                  fValid;   // Build() has been called for fBuffer
+  std::vector<BankInfo_t> fBanks;   // Banks in buffer order
+
+  void ParseChildren( UInt_t type, UInt_t pos, UInt_t end, UInt_t level );
+};
+
+} // namespace Decoder
+
+#endif
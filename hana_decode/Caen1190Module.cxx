@@ -11,6 +11,8 @@
 #include "Caen1190Module.h"
 #include "THaSlotData.h"
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
 
 using namespace std;
 
@@ -21,13 +23,15 @@ namespace Decoder {
 
   const UInt_t NTDCCHAN = 128;
   const UInt_t MAXHIT = 100;
+  const UInt_t TDCRANGE = 0x80000;  // 19-bit time measurement
 
   Module::TypeIter_t Caen1190Module::fgThisType =
     DoRegister( ModuleType( "Decoder::Caen1190Module" , 1190 ));
 
   Caen1190Module::Caen1190Module(Int_t crate, Int_t slot)
     : VmeModule(crate, slot), fNumHits(NTDCCHAN), fTdcData(NTDCCHAN*MAXHIT),
-      fTdcOpt(NTDCCHAN*MAXHIT), slot_data(nullptr)
+      fTdcOpt(NTDCCHAN*MAXHIT), slot_data(nullptr), fRefChan(kMaxUInt),
+      fRefOffset(0), fRollover(TDCRANGE), fRefTime(0), fHasRefTime(false)
   {
     Caen1190Module::Init();
   }
@@ -40,6 +44,31 @@ namespace Decoder {
     Clear();
     IsInit = true;
     fName = "Caen TDC 1190 Module";
+    fRefChan = kMaxUInt;
+    fRefOffset = 0;
+    fRollover = TDCRANGE;
+  }
+
+  void Caen1190Module::Init( const char* configstr ) {
+    // Initialize with optional reference channel configuration from the
+    // crate map: "refchan=<chan> offset=<channels> rollover=<channels>".
+    // The rollover period defaults to the full 19-bit range of the TDC.
+    Init();
+    ParseConfigStr(configstr, {
+      {"refchan", fRefChan}, {"offset", fRefOffset}, {"rollover", fRollover}
+    });
+    if( fRefChan != kMaxUInt && fRefChan >= NTDCCHAN ) {
+      ostringstream ostr;
+      ostr << "Caen1190Module: Invalid reference channel " << fRefChan
+           << ". Must be < " << NTDCCHAN << ". Fix the cratemap.";
+      throw invalid_argument(ostr.str());
+    }
+    if( fRollover == 0 ) {
+      ostringstream ostr;
+      ostr << "Caen1190Module: Rollover period must be > 0. "
+           << "Fix the cratemap.";
+      throw invalid_argument(ostr.str());
+    }
   }
 
   UInt_t Caen1190Module::LoadSlot( THaSlotData* sldat, const UInt_t* evbuffer,
@@ -49,11 +78,13 @@ namespace Decoder {
     slot_data = sldat;
     fWordsSeen = 0; 		// Word count including global header  
     Int_t glbl_trl = 0;
+    // Decode is final in this class, so these calls are statically bound
     while(p <= pstop && glbl_trl == 0) {
       glbl_trl = Decode(p);
       fWordsSeen++;
       ++p;
     }
+    LoadReferencedHits();
     return fWordsSeen;
   }
 
@@ -68,6 +99,7 @@ namespace Decoder {
       Decode(&evbuffer[pos+fWordsSeen]);
       fWordsSeen++;
     }
+    LoadReferencedHits();
     return fWordsSeen;
   }
 
@@ -81,7 +113,7 @@ namespace Decoder {
 	tdc_data.glb_hdr_slno =  *p & 0x0000001f;       // bits 4-0
 	if (tdc_data.glb_hdr_slno == fSlot) {
 #ifdef WITH_DEBUG
-	if (fDebugFile)
+	if (DEBUG_FILE(fDebugFile))
 	  *fDebugFile << "Caen1190Module:: 1190 GLOBAL HEADER >> data = " 
 		      << hex << *p << " >> event number = " << dec 
 		      << tdc_data.glb_hdr_evno << " >> slot number = "  
@@ -95,7 +127,7 @@ namespace Decoder {
 	tdc_data.hdr_event_id = (*p & 0x00fff000) >> 12; // bits 23-12
 	tdc_data.hdr_bunch_id =  *p & 0x00000fff;        // bits 11-0
 #ifdef WITH_DEBUG
-	if (fDebugFile)
+	if (DEBUG_FILE(fDebugFile))
 	  *fDebugFile << "Caen1190Module:: 1190 TDC HEADER >> data = " 
 		      << hex << *p << " >> chip id = " << dec 
 		      << tdc_data.hdr_chip_id  << " >> event id = "
@@ -109,9 +141,13 @@ namespace Decoder {
 	tdc_data.chan   = (*p & 0x03f80000)>>19; // bits 25-19
 	tdc_data.raw    =  *p & 0x0007ffff;      // bits 18-0
 	tdc_data.opt    = (*p & 0x04000000)>>26;      // bit 26
-	tdc_data.status = slot_data->loadData("tdc", tdc_data.chan, tdc_data.raw, tdc_data.opt);
+	// With a reference channel, hits are loaded after the whole slot
+	// has been decoded, see LoadReferencedHits
+	tdc_data.status = (fRefChan == kMaxUInt)
+	  ? slot_data->loadData("tdc", tdc_data.chan, tdc_data.raw, tdc_data.opt)
+	  : SD_OK;
 #ifdef WITH_DEBUG
-	if (fDebugFile)
+	if (DEBUG_FILE(fDebugFile))
 	  *fDebugFile << "Caen1190Module:: 1190 MEASURED DATA >> data = " 
 		      << hex << *p << " >> channel = " << dec
 		      << tdc_data.chan << " >> edge = "
@@ -133,7 +169,7 @@ namespace Decoder {
 	tdc_data.trl_event_id    = (*p & 0x00fff000) >> 12; // bits 23-12
 	tdc_data.trl_word_cnt    =  *p & 0x00000fff;        // bits 11-0
 #ifdef WITH_DEBUG
-	if (fDebugFile)
+	if (DEBUG_FILE(fDebugFile))
 	  *fDebugFile << "Caen1190Module:: 1190 TDC TRAILER >> data = " 
 		      << hex << *p << " >> chip id = " << dec 
 		      << tdc_data.trl_chip_id  << " >> event id = "
@@ -149,7 +185,7 @@ namespace Decoder {
 	cout << "TDC1190 Error: Slot " << tdc_data.glb_hdr_slno << ", Chip " << tdc_data.chip_nr_hd << 
 	  ", Flags " << hex << tdc_data.flags << dec << " " << ", Ev #" << tdc_data.glb_hdr_evno << endl;
 #ifdef WITH_DEBUG
-	if (fDebugFile)
+	if (DEBUG_FILE(fDebugFile))
 	  *fDebugFile << "Caen1190Module:: 1190 TDC ERROR >> data = " 
 		      << hex << *p << " >> chip header = " << dec
 		      << tdc_data.chip_nr_hd << " >> error flags = " << hex
@@ -165,7 +201,7 @@ namespace Decoder {
       if (tdc_data.glb_hdr_slno == fSlot) {
 	tdc_data.trig_time = *p & 0x7ffffff; // bits 27-0
 #ifdef WITH_DEBUG
-	if (fDebugFile)
+	if (DEBUG_FILE(fDebugFile))
 	  *fDebugFile << "Caen1190Module:: 1190 GLOBAL TRIGGER TIME >> data = " 
 		      << hex << *p << " >> trigger time = " << dec
 		      << tdc_data.trig_time << endl;
@@ -178,7 +214,7 @@ namespace Decoder {
        tdc_data.glb_trl_wrd_cnt = (*p & 0x001fffe0) >> 5;  // bits 20-5
        tdc_data.glb_trl_slno    =  *p & 0x0000001f;        // bits 4-0   
 #ifdef WITH_DEBUG
-	if (fDebugFile)
+	if (DEBUG_FILE(fDebugFile))
 	  *fDebugFile << "Caen1190Module:: 1190 GLOBAL TRAILER >> data = " 
 		      << hex << *p << " >> status = "
 		      << tdc_data.glb_trl_status << " >> word count = " << dec 
@@ -192,6 +228,30 @@ namespace Decoder {
     return glbl_trl;
   }
  
+  Int_t Caen1190Module::LoadReferencedHits() {
+    // Convert the buffered hits to times relative to the first hit in the
+    // reference channel and load them into the slot data. The reference
+    // channel itself is loaded unchanged. Without a reference hit, all hits
+    // are loaded unchanged, and HasRefTime() is false.
+    if( fRefChan == kMaxUInt || !slot_data )
+      return 0;
+    fHasRefTime = (fNumHits[fRefChan] > 0);
+    fRefTime = fHasRefTime ? fTdcData[fRefChan * MAXHIT] : 0;
+    for( UInt_t chan = 0; chan < NTDCCHAN; ++chan ) {
+      UInt_t idx = chan * MAXHIT;
+      Bool_t apply = fHasRefTime && chan != fRefChan;
+      for( UInt_t hit = 0; hit < fNumHits[chan]; ++hit, ++idx ) {
+        if( apply )
+          fTdcData[idx] = ReferencedTime(fTdcData[idx], fRefTime, fRefOffset,
+                                         fRollover);
+        if( slot_data->loadData("tdc", chan, fTdcData[idx], fTdcOpt[idx])
+            != SD_OK )
+          return -1;
+      }
+    }
+    return 0;
+  }
+
   UInt_t Caen1190Module::GetData( UInt_t chan, UInt_t hit ) const {
     if( hit >= fNumHits[chan] ) return 0;
     UInt_t idx = chan * MAXHIT + hit;
@@ -206,10 +266,17 @@ namespace Decoder {
     return fTdcOpt[idx];
   }
 
+  size_t Caen1190Module::GetCapacity() const {
+    return ( fNumHits.capacity() + fTdcData.capacity() + fTdcOpt.capacity() )
+      * sizeof(UInt_t) + VmeModule::GetCapacity();
+  }
+
   void Caen1190Module::Clear( Option_t* ) {
+    // Only the hit counters need resetting. Data beyond the current
+    // number of hits of a channel are never read.
     fNumHits.assign(NTDCCHAN, 0);
-    fTdcData.assign(NTDCCHAN * MAXHIT, 0);
-    fTdcOpt.assign(NTDCCHAN * MAXHIT, 0);
+    fRefTime = 0;
+    fHasRefTime = false;
   }
 }
 
@@ -18,17 +18,28 @@ namespace Decoder {
 
   public:
 
-    Caen1190Module() : slot_data(nullptr) {}
+    Caen1190Module() : slot_data(nullptr), fRefChan(kMaxUInt), fRefOffset(0),
+                       fRollover(0), fRefTime(0), fHasRefTime(false) {}
     Caen1190Module(Int_t crate, Int_t slot);
     virtual ~Caen1190Module() = default;
 
     using Module::GetData;
 
+    // Reference channel configuration, set via the crate map, e.g.
+    // "cfg: refchan=127 offset=1000". If a reference channel is set, the
+    // times of all other channels are given relative to the first hit in
+    // the reference channel.
+    UInt_t GetRefChan()  const { return fRefChan; }
+    UInt_t GetRefTime()  const { return fRefTime; }
+    Bool_t HasRefTime()  const { return fHasRefTime; }
+
     virtual void  Init();
+    virtual void  Init( const char* configstr );
     virtual void  Clear(Option_t *opt="");
-    virtual Int_t Decode(const UInt_t *p);
+    virtual Int_t Decode(const UInt_t *p) final;
     virtual UInt_t GetData( UInt_t chan, UInt_t hit) const;
     virtual UInt_t GetOpt( UInt_t chan, UInt_t hit) const;
+    virtual size_t GetCapacity() const;
 
     // Loads slot data.  if you don't define this, the base class's method is used
     virtual UInt_t LoadSlot( THaSlotData *sldat, const UInt_t *evbuffer, const UInt_t *pstop );
@@ -42,6 +53,14 @@ namespace Decoder {
     std::vector<UInt_t> fTdcOpt;  // Edge flag =0 Leading edge, = 1 Trailing edge
 
     THaSlotData *slot_data;  // Need to fix if multi-threading becomes available
+
+    UInt_t fRefChan;     // Reference channel (kMaxUInt = none)
+    UInt_t fRefOffset;   // Offset added to referenced times (channels)
+    UInt_t fRollover;    // TDC counter rollover period (channels)
+    UInt_t fRefTime;     // Raw reference time in current event
+    Bool_t fHasRefTime;  // Reference channel has a hit in current event
+
+    Int_t  LoadReferencedHits();
    
     class tdcData {
     public:
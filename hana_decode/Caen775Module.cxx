@@ -14,6 +14,7 @@
 #include "THaSlotData.h"
 #include "TString.h"
 #include <iostream>
+#include <algorithm>
 
 using namespace std;
 
@@ -26,7 +27,7 @@ Module::TypeIter_t Caen775Module::fgThisType =
   DoRegister( ModuleType( "Decoder::Caen775Module" , 775 ));
 
 Caen775Module::Caen775Module( UInt_t crate, UInt_t slot ) :
-  VmeModule(crate, slot)
+  VmeModule(crate, slot), fNumOverflow(0), fNumUnder(0)
 {
   fDebugFile=nullptr;
   Caen775Module::Init();
@@ -52,28 +53,72 @@ void Caen775Module::Init() {
   fName = Form("Caen %s %s Module",modtypeup.Data(),MyModName());
 }
 
+// Data word fields. The format is fixed-width, so whole blocks are decoded
+// with straight-line loops that the compiler can vectorize.
+static const UInt_t kChanMask   = 0x00ff0000;
+static const UInt_t kChanShift  = 16;
+static const UInt_t kDataMask   = 0x00000fff;
+static const UInt_t kOverflow   = 0x00001000;  // OV bit 12
+static const UInt_t kUnderThr   = 0x00002000;  // UN bit 13
+
+static inline void ExtractWords( const UInt_t* p, UInt_t n, UInt_t* chan,
+                                 UInt_t* dat, UInt_t& nov, UInt_t& nun )
+{
+  // Extract channel numbers and data of 'n' data words into packed arrays,
+  // and count the words with overflow/under-threshold bits set
+
+  UInt_t ov = 0, un = 0;
+  for( UInt_t i = 0; i < n; ++i ) {
+    UInt_t w = p[i];
+    chan[i] = (w & kChanMask) >> kChanShift;
+    dat[i]  = w & kDataMask;
+    ov += (w & kOverflow) >> 12;
+    un += (w & kUnderThr) >> 13;
+  }
+  nov += ov;
+  nun += un;
+}
+
+Int_t Caen775Module::LoadBlock( THaSlotData* sldat, const UInt_t* p, UInt_t n )
+{
+  // Decode 'n' consecutive data words at 'p' and store them in 'sldat'
+  // with one THaSlotData::loadBlock call per kMaxBlock words.
+  // Returns the worst status of the individual hits.
+
+  UInt_t chan[kMaxBlock], dat[kMaxBlock];
+  const char* type = MyModType();  // once per slot, not per word
+  Int_t status = SD_OK;
+  while( n > 0 ) {
+    UInt_t m = (n < kMaxBlock) ? n : kMaxBlock;
+    ExtractWords(p, m, chan, dat, fNumOverflow, fNumUnder);
+    for( UInt_t i = 0; i < m; ++i ) {
+      if( chan[i] < fData.size() )
+        fData[chan[i]] = dat[i];
+    }
+    Int_t st = sldat->loadBlock(type, chan, dat, m);
+    if( st != SD_OK && status != SD_ERR )
+      status = st;
+    p += m;
+    n -= m;
+  }
+  return status;
+}
+
 UInt_t Caen775Module::LoadSlot( THaSlotData* sldat, const UInt_t* evbuffer,
                                 const UInt_t* pstop )
 {
-// This is a simple, default method for loading a slot
-  const UInt_t *p = evbuffer;
-  fWordsSeen = 0;
-//  cout << "version like V792"<<endl;
-  ++p;
-  UInt_t nword = *p-2;
-  ++p;
-  for (UInt_t i=0;i<nword;i++) {
-       ++p;
-       if (p>pstop)
-	 break;
-       UInt_t chan=((*p)&0x00ff0000)>>16;
-       UInt_t raw=((*p)&0x00000fff);
-       Int_t status = sldat->loadData(MyModType(),chan,raw,raw);
-       fWordsSeen++;
-       if (chan < fData.size()) fData[chan]=raw;
-//       cout << "word   "<<i<<"   "<<chan<<"   "<<raw<<endl;
-       if( status != SD_OK ) return -1;
-  }
+  // This is a simple, default method for loading a slot.
+  // evbuffer[1] is the word count including two header words; the data
+  // words start at evbuffer[3]. All of them are decoded in one block.
+  const UInt_t* p = evbuffer + 3;
+  UInt_t nword = evbuffer[1] - 2;
+  if( p > pstop )
+    nword = 0;
+  else if( nword > static_cast<UInt_t>(pstop - p) + 1 )
+    nword = pstop - p + 1;
+  fWordsSeen = nword;
+  if( LoadBlock(sldat, p, nword) != SD_OK )
+    return -1;
   return fWordsSeen;
 }
 
@@ -81,50 +126,37 @@ UInt_t Caen775Module::LoadSlot( THaSlotData* sldat, const UInt_t* evbuffer,
                                 UInt_t pos, UInt_t len )
 {
   // Fill data structures of this class
-  // Read until out of data or until decode says that the slot is finished
-  // len = ndata in event, pos = word number for block header in event
+  // len = ndata in event, pos = word number for block header in event.
+  // Find the block header of this slot, then decode the number of data
+  // words given in the header in one block. The End of Block (EOB) word
+  // and anything else up to 'len' is skipped.
   Clear();
-  UInt_t counter = 0;
+  const UInt_t* p = evbuffer + pos;
+  UInt_t nword = 0, i = 0;
   Bool_t found_slot = kFALSE;
-  UInt_t nword = 0;
-  UInt_t slot_counter = 0;
-  const UInt_t *p = evbuffer;
-  fWordsSeen = 0; 
-
-#ifdef WITH_DEBUG
-  //cout << "Number of words from 775: \t" << len << endl << endl;
-#endif
-  while (fWordsSeen < len) {   
-    UInt_t index = pos + fWordsSeen;
-    // first word is the header
-    if( !found_slot ) {
-      nword = (p[index] & 0x00003f00) >> 8; // number of converted channels bits 8-13
-      auto slot_num = (p[index] & 0xf8000000) >> 27;
-      fWordsSeen++;
-      if (slot_num == fSlot) found_slot = kTRUE;
-     } else if (slot_counter < nword) { // excludes the End of Block (EOB) word
-      UInt_t chan = (p[index] & 0x00ff0000) >> 16; // number of channel which data are coming from bits 16-20
-      UInt_t raw  =  p[index] & 0x00000fff;        // raw datum bits 0-11
-      Int_t status = sldat->loadData(MyModType(),chan,raw,raw);
-      fWordsSeen++;
-      counter++;
-      slot_counter++;
-      if( chan < fData.size() ) fData[chan] = raw;
-#ifdef WITH_DEBUG
-      //cout << "word\t"<<index<<"\t"<<chan<<"\t"<<raw<<endl;
-#endif
-      if( status != SD_OK ) return -1;
-    } else fWordsSeen++; // increment the counter for the EOB word
+  while( i < len && !found_slot ) {
+    nword = (p[i] & 0x00003f00) >> 8;   // number of converted channels bits 8-13
+    auto slot_num = (p[i] & 0xf8000000) >> 27;
+    found_slot = (slot_num == fSlot);
+    ++i;
+  }
+  UInt_t counter = 0;
+  if( found_slot ) {
+    counter = std::min(nword, len - i);
+    if( LoadBlock(sldat, p + i, counter) != SD_OK ) {
+      fWordsSeen = i + counter;
+      return -1;
+    }
+  }
+  fWordsSeen = len;
 
 #ifdef WITH_DEBUG
-    if( fDebugFile )
-      *fDebugFile << "\n" << "Caen775Module::LoadSlot >> evbuffer[" << index 
-		  << "] = " << hex << evbuffer[index] << dec << " >> crate = "
-		  << fCrate << " >> slot = " << fSlot << " >> pos = " 
-		  << pos << " >> fWordsSeen = " << fWordsSeen 
-		  << " >> len = " << len << " >> index = " << index << "\n" << endl;
+  if( DEBUG_FILE(fDebugFile) )
+    *fDebugFile << "\n" << "Caen775Module::LoadSlot >> crate = " << fCrate
+                << " >> slot = " << fSlot << " >> pos = " << pos
+                << " >> len = " << len << " >> header at " << pos + i - 1
+                << " >> ndata = " << counter << "\n" << endl;
 #endif
-  }
   if( counter != nword )
     cout << Form("Warning in v%s Number of converted channels, %u, is not "
                  "equal to number of decoded words, %u!",
@@ -141,6 +173,7 @@ UInt_t Caen775Module::GetData( UInt_t chan ) const {
 void Caen775Module::Clear(Option_t* opt) {
   VmeModule::Clear(opt);
   fData.assign(fNumChan,0);
+  fNumOverflow = fNumUnder = 0;
 }
 
 }
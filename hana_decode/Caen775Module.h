@@ -16,7 +16,7 @@ class Caen775Module : public VmeModule {
 
 public:
 
-   Caen775Module() = default;
+   Caen775Module() : fNumOverflow(0), fNumUnder(0) {}
    Caen775Module( UInt_t crate, UInt_t slot );
    virtual ~Caen775Module() = default;
 
@@ -30,10 +30,20 @@ public:
    virtual UInt_t LoadSlot( THaSlotData *sldat, const UInt_t* evbuffer, UInt_t pos, UInt_t len );
    virtual const char* MyModType() {return "tdc";}
    virtual const char* MyModName() {return "775";}
- 
+
+   // Hits with the overflow/under-threshold bit set in the current event
+   UInt_t GetNumOverflow()       const { return fNumOverflow; }
+   UInt_t GetNumUnderThreshold() const { return fNumUnder; }
+
 private:
 
    static const size_t NTDCCHAN = 32;
+   static const UInt_t kMaxBlock = 64;  // Data words extracted per pass
+
+   UInt_t fNumOverflow;  // Hits with overflow bit set
+   UInt_t fNumUnder;     // Hits with under-threshold bit set
+
+   Int_t  LoadBlock( THaSlotData* sldat, const UInt_t* p, UInt_t n );
 
    static TypeIter_t fgThisType;
    ClassDef(Caen775Module,0)  //  Caen775 of a module; make your replacements
@@ -9,9 +9,11 @@
 
 #include "CodaDecoder.h"
 #include "THaCrateMap.h"
-#include "THaBenchmark.h"
+#include "Profiler.h"
 #include "THaUsrstrutils.h"
 #include "TError.h"
+#include "RConfigure.h"  // for R__USE_IMT
+#include "RVersion.h"
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>
@@ -21,10 +23,35 @@
 
 using namespace std;
 
+#if defined(R__USE_IMT) && ROOT_VERSION_CODE >= ROOT_VERSION(6,14,0)
+#define PARALLEL_ROCS
+#include "ROOT/TThreadExecutor.hxx"
+#include "ROOT/TSeq.hxx"
+#endif
+
 #define ALL(c) (c).begin(), (c).end()
 
 namespace Decoder {
 
+//_____________________________________________________________________________
+// Thread pool for decoding the ROCs of one event concurrently
+class CodaDecoder::RocPool {
+public:
+#ifdef PARALLEL_ROCS
+  explicit RocPool( UInt_t nthreads ) : fExecutor(nthreads) {}
+  template<typename F> void Foreach( F func, UInt_t n, UInt_t first = 0 ) {
+    fExecutor.Foreach(func, ROOT::TSeqU(first, first+n));
+  }
+private:
+  ROOT::TThreadExecutor fExecutor;
+#else
+  template<typename F> void Foreach( F func, UInt_t n, UInt_t first = 0 ) {
+    for( UInt_t i = first; i < first+n; ++i )
+      func(i);
+  }
+#endif
+};
+
 //_____________________________________________________________________________
 CodaDecoder::CodaDecoder() :
   THaEvData(),
@@ -33,9 +60,11 @@ CodaDecoder::CodaDecoder() :
   fbfound(MAXROC*MAXSLOT_FB, false),
   psfact(MAX_PSFACT, kMaxUInt),
   fdfirst(true), chkfbstat(1),
+  fNRocThreads(1),
   evcnt_coda3(0),
   fMultiBlockMode{false},
-  fBlockIsDone{false}
+  fBlockIsDone{false},
+  fBlockIndex{0}
 {
   bankdat.reserve(32);
   // Please leave these 3 lines for me to debug if I need to.  thanks, Bob
@@ -87,7 +116,7 @@ Int_t CodaDecoder::LoadEvent( const UInt_t* evbuffer )
 
   assert(evbuffer);
 
-  if (fDebugFile) {
+  if (DEBUG_FILE(fDebugFile)) {
     *fDebugFile << "CodaDecode:: Loading event  ... " << endl
                 << "evbuffer ptr " << hex << evbuffer << dec << endl;
   }
@@ -114,8 +143,10 @@ Int_t CodaDecoder::LoadEvent( const UInt_t* evbuffer )
 
   buffer = evbuffer;
   event_length = evbuffer[0]+1;  // in longwords (4 bytes)
+  fBankDir.Clear();   // The buffer may be reused for the new event
   event_num = 0;
   event_type = 0;
+  fBlockIndex = 0;
 
   // Determine event type
   if (fDataVersion == 2) {
@@ -123,7 +154,7 @@ Int_t CodaDecoder::LoadEvent( const UInt_t* evbuffer )
   } else {  // CODA version 3
     interpretCoda3(evbuffer);
   }
-  if(fDebugFile) {
+  if(DEBUG_FILE(fDebugFile)) {
       *fDebugFile << "CodaDecode:: dumping "<<endl;
       dump(evbuffer);
   }
@@ -138,7 +169,7 @@ Int_t CodaDecoder::LoadEvent( const UInt_t* evbuffer )
     run_num  = evbuffer[3];
     run_type = evbuffer[4];
     evt_time = fRunTime;
-    if (fDebugFile) {
+    if (DEBUG_FILE(fDebugFile)) {
       *fDebugFile << "Prestart Event : run_num " << run_num
                   << "  run type "   << run_type
                   << "  event_type " << event_type
@@ -159,13 +190,15 @@ Int_t CodaDecoder::LoadEvent( const UInt_t* evbuffer )
         return ret;
     }
     assert(fMap);
-    if( fDoBench ) fBench->Begin("clearEvent");
-    for( auto i : fSlotClear )
-      crateslot[i]->clearEvent();
-    if( fDoBench ) fBench->Stop("clearEvent");
+    if( fDoBench ) fBench->Start(kBenchClear);
+    ClearSlotData();
+    bankdat.clear();
+    if( fDoBench ) fBench->Stop(kBenchClear);
 
     if( fDataVersion == 3 ) {
       event_num = ++evcnt_coda3;
+      if( !fBlockTS.empty() )
+        evt_time = fBlockTS[0];
       FindRocsCoda3(evbuffer);
     } else {
       event_num = evbuffer[4];
@@ -173,7 +206,7 @@ Int_t CodaDecoder::LoadEvent( const UInt_t* evbuffer )
     }
     recent_event = event_num;
 
-    if( fdfirst && fDebugFile ) {
+    if( fdfirst && DEBUG_FILE(fDebugFile) ) {
       fdfirst = false;
       CompareRocs();
     }
@@ -181,9 +214,17 @@ Int_t CodaDecoder::LoadEvent( const UInt_t* evbuffer )
    // Decode each ROC
    // From this point onwards there is no diff between CODA 2.* and CODA 3.*
 
+    if( fRocPool && !DEBUG_FILE(fDebugFile) && nroc > 1 ) {
+      DecodeRocsParallel(evbuffer);
+      PackSlotData();
+      return ret;
+    }
+
     for( UInt_t i = 0; i < nroc; i++ ) {
 
       UInt_t iroc = irn[i];
+      if( !IsRocDemanded(iroc) )
+        continue;
       const RocDat_t& ROC = rocdat[iroc];
       UInt_t ipt = ROC.pos + 1;
       UInt_t iptmax = ROC.pos + ROC.len;
@@ -200,7 +241,7 @@ Int_t CodaDecoder::LoadEvent( const UInt_t* evbuffer )
       // If at least one module is in a bank, must split the banks for this roc
 
       if( fMap->isBankStructure(iroc) ) {
-        if( fDebugFile )
+        if( DEBUG_FILE(fDebugFile) )
           *fDebugFile << "\nCodaDecode::Calling bank_decode "
                       << i << "   " << iroc << "  " << ipt << "  " << iptmax
                       << endl;
@@ -208,7 +249,7 @@ Int_t CodaDecoder::LoadEvent( const UInt_t* evbuffer )
         bank_decode(iroc, evbuffer, ipt, iptmax);
       }
 
-      if( fDebugFile )
+      if( DEBUG_FILE(fDebugFile) )
         *fDebugFile << "\nCodaDecode::Calling roc_decode " << i << "   "
                     << evbuffer << "  " << iroc << "  " << ipt
                     << "  " << iptmax << endl;
@@ -220,12 +261,208 @@ Int_t CodaDecoder::LoadEvent( const UInt_t* evbuffer )
         break;
 
     }
+    PackSlotData();
   }
 
   return ret;
 }
 
 
+//_____________________________________________________________________________
+Int_t CodaDecoder::DecodeRocsParallel( const UInt_t* evbuffer )
+{
+  // Decode the ROCs of the current event concurrently (see SetNumRocThreads).
+  //
+  // Fastbus ROCs, which keep track of flag data in shared state, and ROCs
+  // with bank structure, which share bankdat, are decoded sequentially,
+  // in order, as usual. All other ROCs are then decoded in parallel.
+  // Afterwards, the decoder flags are set as if all ROCs had been
+  // decoded sequentially.
+
+  class RocJob_t {
+  public:
+    RocJob_t( UInt_t _roc, UInt_t _ipt, UInt_t _istop,
+              const SlotLookup_t* _lookup )
+      : roc(_roc), ipt(_ipt), istop(_istop), lookup(_lookup),
+        blockdone(false), synchmiss(false), synchextra(false),
+        buffmode(false) {}
+    UInt_t roc, ipt, istop;
+    const SlotLookup_t* lookup;  // Null if decoded sequentially
+    std::string error;           // Error message from parallel decoding
+    // State of decoder after sequential decoding of this ROC
+    Bool_t blockdone, synchmiss, synchextra, buffmode;
+  };
+  vector<RocJob_t> jobs;
+  jobs.reserve(nroc);
+  vector<UInt_t> parallel;
+  parallel.reserve(nroc);
+
+  for( UInt_t i = 0; i < nroc; i++ ) {
+
+    UInt_t iroc = irn[i];
+    if( !IsRocDemanded(iroc) )
+      continue;
+    const RocDat_t& ROC = rocdat[iroc];
+    UInt_t ipt = ROC.pos + 1;
+    UInt_t iptmax = ROC.pos + ROC.len;
+
+    if( fMap->isFastBus(iroc) ) {  // checking that slots found = expected
+      if( GetEvNum() > 200 && chkfbstat < 3 ) chkfbstat = 2;
+      if( chkfbstat == 1 ) ChkFbSlot(iroc, evbuffer, ipt, iptmax);
+      if( chkfbstat == 2 ) {
+        ChkFbSlots();
+        chkfbstat = 3;
+      }
+    }
+
+    if( fMap->isFastBus(iroc) || fMap->isBankStructure(iroc) ) {
+      if( fMap->isBankStructure(iroc) )
+        bank_decode(iroc, evbuffer, ipt, iptmax);
+      Int_t status = roc_decode(iroc, evbuffer, ipt, iptmax);
+      if( status )
+        break;
+      jobs.emplace_back(iroc, ipt, iptmax, nullptr);
+      RocJob_t& job = jobs.back();
+      job.blockdone  = fBlockIsDone;
+      job.synchmiss  = synchmiss;
+      job.synchextra = synchextra;
+      job.buffmode   = buffmode;
+    }
+    else if( ipt+1 < iptmax && RocIsDefined(iroc) ) {
+      if( iptmax > event_length )
+        throw logic_error("ERROR:: roc_decode:  stop point exceeds event length (?!)");
+      parallel.push_back(jobs.size());
+      jobs.emplace_back(iroc, ipt, iptmax, &GetSlotLookup(iroc));
+    }
+  }
+
+  if( !parallel.empty() ) {
+    if( fDoBench ) fBench->Start(kBenchRocDecode);
+    fRocPool->Foreach( [&]( UInt_t k ) {
+      RocJob_t& job = jobs[parallel[k]];
+      try {
+        DecodeRocData(job.roc, *job.lookup, evbuffer, job.ipt, job.istop);
+      }
+      catch( const exception& e ) {
+        job.error = e.what();
+      }
+    }, parallel.size());
+    if( fDoBench ) fBench->Stop(kBenchRocDecode);
+  }
+
+  Int_t retval = HED_OK;
+  for( const auto& job : jobs ) {
+    if( job.lookup ) {
+      if( !job.error.empty() ) {
+        cerr << job.error << endl;
+        retval = HED_ERR;
+      }
+      fBlockIsDone = false;
+      UpdateBlockFlags(*job.lookup);
+      synchmiss = synchextra = buffmode = false;
+    } else {
+      fBlockIsDone = job.blockdone;
+      synchmiss    = job.synchmiss;
+      synchextra   = job.synchextra;
+      buffmode     = job.buffmode;
+    }
+  }
+  return retval;
+}
+
+//_____________________________________________________________________________
+void CodaDecoder::SetNumRocThreads( UInt_t n )
+{
+  // Decode the ROCs of each event concurrently with up to 'n' threads.
+  // 0 or 1 (the default) selects sequential decoding. This reduces the
+  // decoding latency per event, which matters online, where events must
+  // be analyzed in order. Only ROCs without Fastbus modules and without
+  // bank structure are decoded in parallel. Decoding is always sequential
+  // while a debug file is set. Requires ROOT with multithreading support.
+
+  fRocPool.reset();
+  fNRocThreads = 1;
+  if( n <= 1 )
+    return;
+#ifdef PARALLEL_ROCS
+  fRocPool.reset(new RocPool(n));
+  fNRocThreads = n;
+#else
+  Warning( "SetNumRocThreads", "ROOT was built without multithreading "
+           "support. Decoding ROCs sequentially." );
+#endif
+}
+
+//_____________________________________________________________________________
+Int_t CodaDecoder::PeekEvent( const UInt_t* evbuffer, EvHeader_t& hdr ) const
+{
+  // Get type, length and number of the event in 'evbuffer' from its header
+  // only, without changing the state of the decoder. Returns HED_WARN if
+  // the event cannot be skipped safely and must be loaded with LoadEvent,
+  // i.e. for multiblock data.
+
+  assert(evbuffer);
+  if( fDataVersion != 2 && fDataVersion != 3 )
+    return HED_ERR;
+  if( fMultiBlockMode && !fBlockIsDone )
+    return HED_WARN;
+
+  hdr.length = evbuffer[0]+1;
+  hdr.evnum = 0;
+  if( fDataVersion == 2 ) {
+    hdr.type = evbuffer[1]>>16;
+    if( hdr.type > 0 && hdr.type <= MAX_PHYS_EVTYPE && hdr.length > 4 )
+      hdr.evnum = evbuffer[4];
+  } else {
+    hdr.type = Coda3EventType((evbuffer[1] & 0xffff0000) >> 16);
+    if( hdr.type == 1 ) {
+      if( (evbuffer[1] & 0xff) > 1 )
+        return HED_WARN;  // Block of several events
+      hdr.evnum = evcnt_coda3+1;
+    }
+  }
+  return HED_OK;
+}
+
+//_____________________________________________________________________________
+Int_t CodaDecoder::SkipEvent( const UInt_t* evbuffer )
+{
+  // Advance past the event in 'evbuffer' without decoding any ROC data.
+  // Event type, length and number are set as LoadEvent would. Events that
+  // change the state of the decoder (prestart, prescale factors) and
+  // events that cannot be peeked at are decoded normally.
+
+  EvHeader_t hdr;
+  if( PeekEvent(evbuffer, hdr) != HED_OK || hdr.type == PRESTART_EVTYPE ||
+      hdr.type == PRESCALE_EVTYPE || hdr.type == TS_PRESCALE_EVTYPE )
+    return LoadEvent(evbuffer);
+
+  buffer = evbuffer;
+  event_length = hdr.length;
+  fBankDir.Clear();
+  event_type = hdr.type;
+  event_num = hdr.evnum;
+  fBlockIndex = 0;
+  if( fDataVersion == 3 && hdr.type == 1 )
+    ++evcnt_coda3;
+  if( hdr.evnum != 0 )
+    recent_event = event_num;
+  return HED_OK;
+}
+
+//_____________________________________________________________________________
+Int_t CodaDecoder::LoadRocs( const UInt_t* evbuffer,
+                             const vector<UInt_t>& rocs )
+{
+  // Decode only the given ROCs of the event in 'evbuffer'. The CODA3 event
+  // counter is restored, since the event will be loaded or skipped again.
+
+  UInt_t save_evcnt = evcnt_coda3;
+  Int_t ret = THaEvData::LoadRocs(evbuffer, rocs);
+  evcnt_coda3 = save_evcnt;
+  return ret;
+}
+
 //_____________________________________________________________________________
 Int_t CodaDecoder::interpretCoda3(const UInt_t* evbuffer) {
 
@@ -234,48 +471,54 @@ Int_t CodaDecoder::interpretCoda3(const UInt_t* evbuffer) {
   data_type  = (evbuffer[1] & 0xff00) >> 8;
   block_size = evbuffer[1] & 0xff;
 
+  event_type = Coda3EventType(bank_tag);
   if( bank_tag >= 0xff00 ) { /* CODA Reserved bank type */
+    if( event_type == 0 )
+      cout << "CodaDecoder:: WARNING:  Undefined CODA 3 event type" << endl;
+  } else { /* User event type */
+    if( DEBUG_FILE(fDebugFile) )
+      *fDebugFile << " User defined event type " << event_type << endl;
+  }
+
+  tbLen = 0;
+  if( event_type == 1 ) tbLen = trigBankDecode(&evbuffer[2], block_size);
+
+  return HED_OK;
+}
 
-    switch( bank_tag ) {
 
+//_____________________________________________________________________________
+UInt_t CodaDecoder::Coda3EventType( UInt_t tag )
+{
+  // Event type corresponding to CODA 3 bank tag 'tag'. Returns 0 for
+  // undefined reserved tags.
+
+  if( tag >= 0xff00 ) { /* CODA Reserved bank type */
+    switch( tag ) {
     case 0xffd1:
-      event_type = PRESTART_EVTYPE;
-      break;
+      return PRESTART_EVTYPE;
     case 0xffd2:
-      event_type = GO_EVTYPE;
-      break;
+      return GO_EVTYPE;
     case 0xffd4:
-      event_type = END_EVTYPE;
-      break;
+      return END_EVTYPE;
     case 0xff50:
     case 0xff58: // Physics event with sync bit
     case 0xff70:
-      event_type = 1;  // Physics event type
-      break;
+      return 1;  // Physics event type
     default:
-      cout << "CodaDecoder:: WARNING:  Undefined CODA 3 event type" << endl;
+      return 0;
     }
-  } else { /* User event type */
-
-    event_type = bank_tag;  // need to check this.
-
-    if( fDebugFile )
-      *fDebugFile << " User defined event type " << event_type << endl;
-
   }
-
-  tbLen = 0;
-  if( event_type == 1 ) tbLen = trigBankDecode(&evbuffer[2], block_size);
-
-  return HED_OK;
+  return tag;  /* User event type */  // need to check this.
 }
 
-
 //_____________________________________________________________________________
 UInt_t CodaDecoder::trigBankDecode( const UInt_t* evbuffer, UInt_t blkSize) {
 
 // Decode the "Trigger Bank" which is a CODA3 structure that appears
-// near the top of the event buffer.  
+// near the top of the event buffer.  The time stamps and trigger types
+// of all events of the block are decoded here, once per block, and
+// cached for LoadFromMultiBlock.
 
   memset((void *)&tbank, 0, sizeof(TBOBJ));
 
@@ -291,26 +534,80 @@ UInt_t CodaDecoder::trigBankDecode( const UInt_t* evbuffer, UInt_t blkSize) {
   if((tbank.tag)&2)
     tbank.withRunInfo = 1;
 
-  if(tbank.withTimeStamp) {
-    tbank.evTS = (uint64_t *)&evbuffer[5];
-    if(tbank.withRunInfo) {
-      tbank.evType = (uint16_t *)&evbuffer[5 + 2*blkSize + 3];
-    }else{
-      tbank.evType = (uint16_t *)&evbuffer[5 + 2*blkSize + 1];
-    }
-  }else{
-    tbank.evTS = nullptr;
-    if(tbank.withRunInfo) {
-      tbank.evType = (uint16_t *)&evbuffer[5 + 3];
-    }else{
-      tbank.evType = (uint16_t *)&evbuffer[5 + 1];
-    }
-  }
+  fBlockTS.assign(blkSize, 0);
+  fBlockTrigType.assign(blkSize, 0);
+  if( !trigBankFastPath(evbuffer, blkSize) )
+    trigBankParse(evbuffer, blkSize);
 
   return(tbank.len);
 
 }
 
+//_____________________________________________________________________________
+Bool_t CodaDecoder::trigBankFastPath( const UInt_t* evbuffer, UInt_t blkSize )
+{
+  // Decode the trigger bank assuming the standard layout: a segment of
+  // 64-bit words with the event number, time stamps (if any) and run
+  // info (if any), followed by a segment of 16-bit event types. Both
+  // segment headers are checked. Returns false if the layout differs.
+
+  UInt_t len1 = 2 + (tbank.withTimeStamp ? 2*blkSize : 0)
+    + (tbank.withRunInfo ? 2 : 0);
+  UInt_t ntypes = (blkSize+1)/2;
+  UInt_t ihdr2 = 3 + len1;
+  if( ihdr2 + 1 + ntypes > tbank.len )
+    return false;
+  UInt_t hdr1 = evbuffer[2], hdr2 = evbuffer[ihdr2];
+  if( ((hdr1 >> 8) & 0x3f) != 0x0a || (hdr1 & 0xffff) != len1 ||
+      ((hdr2 >> 8) & 0x3f) != 0x05 || (hdr2 & 0xffff) < ntypes )
+    return false;
+
+  tbank.evTS = tbank.withTimeStamp ? (uint64_t *)&evbuffer[5] : nullptr;
+  tbank.evType = (uint16_t *)&evbuffer[ihdr2+1];
+  for( UInt_t i = 0; i < blkSize; i++ ) {
+    if( tbank.evTS )
+      fBlockTS[i] = tbank.evTS[i];
+    fBlockTrigType[i] = tbank.evType[i];
+  }
+  return true;
+}
+
+//_____________________________________________________________________________
+void CodaDecoder::trigBankParse( const UInt_t* evbuffer, UInt_t blkSize )
+{
+  // General parser for trigger banks with an unusual layout. Walks the
+  // segments of the bank and takes the event number and time stamps from
+  // the first segment of 64-bit words and the event types from the first
+  // segment of 16-bit words. Other segments (e.g. per-ROC data) are skipped.
+
+  tbank.evTS = nullptr;
+  tbank.evType = nullptr;
+  bool have_ts = false, have_types = false;
+  UInt_t pos = 2;
+  while( pos < tbank.len ) {
+    UInt_t hdr = evbuffer[pos];
+    UInt_t type = (hdr >> 8) & 0x3f, len = hdr & 0xffff;
+    if( pos + 1 + len > tbank.len )
+      break;  // Corrupt segment
+    const UInt_t* seg = &evbuffer[pos+1];
+    if( type == 0x0a && !have_ts ) {
+      have_ts = true;
+      tbank.evtNum = seg[0];
+      if( tbank.withTimeStamp && len >= 2 + 2*blkSize ) {
+        tbank.evTS = (uint64_t *)&seg[2];
+        for( UInt_t i = 0; i < blkSize; i++ )
+          fBlockTS[i] = tbank.evTS[i];
+      }
+    } else if( type == 0x05 && !have_types && 2*len >= blkSize ) {
+      have_types = true;
+      tbank.evType = (uint16_t *)seg;
+      for( UInt_t i = 0; i < blkSize; i++ )
+        fBlockTrigType[i] = tbank.evType[i];
+    }
+    pos += 1 + len;
+  }
+}
+
 //_____________________________________________________________________________
 Int_t CodaDecoder::LoadFromMultiBlock()
 {
@@ -325,6 +622,9 @@ Int_t CodaDecoder::LoadFromMultiBlock()
     return HED_ERR;
   }
   fBlockIsDone = false;
+  ++fBlockIndex;
+  if( fBlockIndex < fBlockTS.size() )
+    evt_time = fBlockTS[fBlockIndex];
 
   if( first_decode || fNeedInit ) {
     Int_t ret = Init();
@@ -332,9 +632,9 @@ Int_t CodaDecoder::LoadFromMultiBlock()
       return ret;
   }
 
-  for( auto i : fSlotClear ) {
-    if( crateslot[i]->GetModule()->IsMultiBlockMode() )
-      crateslot[i]->clearEvent();
+  for( auto* sd : fClearSlots ) {
+    if( sd->GetModule()->IsMultiBlockMode() )
+      sd->clearEvent();
   }
 
   for( UInt_t i = 0; i < nroc; i++ ) {
@@ -344,7 +644,7 @@ Int_t CodaDecoder::LoadFromMultiBlock()
       auto* sd = crateslot[idx(roc, slot)].get();
       auto* mod = sd->GetModule();
       // for CODA3, cross-check the block size (found in trigger bank and, separately, in modules)
-      if( fDebugFile )
+      if( DEBUG_FILE(fDebugFile) )
         *fDebugFile << "cross chk blk size " << roc << "  " << slot << "  "
                     << mod->GetBlockSize() << "   " << block_size << endl;
       if( fDataVersion > 2 && mod->GetBlockSize() != block_size ) {
@@ -357,9 +657,119 @@ Int_t CodaDecoder::LoadFromMultiBlock()
       }
     }
   }
+  PackSlotData();
   return HED_OK;
 }
 
+//_____________________________________________________________________________
+Int_t CodaDecoder::LoadFromMultiBlock( UInt_t ievent )
+{
+  // Load event 'ievent' (0 = first) of the current multiblock buffer.
+  // Unlike LoadFromMultiBlock(), the events may be loaded in any order.
+
+  if( !fMultiBlockMode ) {
+    Error("CodaDecoder::LoadFromMultiBlock",
+          "Not in multiblock mode. Logic error. Call expert.");
+    return HED_ERR;
+  }
+  if( ievent >= GetNumBlockEvents() ) {
+    Error("CodaDecoder::LoadFromMultiBlock",
+          "Event %u requested, but block has only %u events",
+          ievent, GetNumBlockEvents());
+    return HED_ERR;
+  }
+  for( UInt_t i = 0; i < nroc; i++ ) {
+    UInt_t roc = irn[i];
+    for( auto slot : fMap->GetUsedSlots(roc) ) {
+      auto* mod = crateslot[idx(roc, slot)]->GetModule();
+      if( mod && mod->IsMultiBlockMode() )
+        mod->SetBlockIndex(ievent);
+    }
+  }
+  Int_t ret = LoadFromMultiBlock();
+  fBlockIndex = ievent;
+  if( fBlockIndex < fBlockTS.size() )
+    evt_time = fBlockTS[fBlockIndex];
+  return ret;
+}
+
+//_____________________________________________________________________________
+UInt_t CodaDecoder::GetNumBlockEvents() const
+{
+  // Number of events in the current CODA buffer (1 unless in multiblock mode)
+
+  if( !fMultiBlockMode )
+    return 1;
+  if( block_size > 0 )
+    return block_size;
+  // CODA2 has no trigger bank; ask the modules
+  for( auto* sd : fActiveSlots ) {
+    const Module* mod = sd->GetModule();
+    if( mod && mod->IsMultiBlockMode() )
+      return mod->GetBlockSize();
+  }
+  return 1;
+}
+
+//_____________________________________________________________________________
+Int_t CodaDecoder::FanOutBlock( const UInt_t* evbuffer,
+                                const vector<CodaDecoder*>& views )
+{
+  // Decode all events of the CODA buffer 'evbuffer' into separate decoders,
+  // so that views[i] holds event i of a multiblock buffer. The views must
+  // be set up like this decoder (CODA version, crate map, run time) and
+  // must not be used by anyone else during this call. Afterwards they are
+  // independent and may be analyzed concurrently; GetBlockIndex() of each
+  // view gives the original event order.
+  //
+  // Returns the number of views filled, or a negative HED_* code on error.
+  // If the block has more events than there are views, the last view
+  // remains positioned in the block (DataCached() is true) and can load the
+  // remaining events with LoadFromMultiBlock().
+  //
+  // Views other than the first are decoded in parallel if this decoder has
+  // ROC threads enabled (see SetNumRocThreads) and all views are
+  // initialized.
+
+  if( views.empty() || !views[0] )
+    return HED_ERR;
+  CodaDecoder* first = views[0];
+  Int_t ret = first->LoadEvent(evbuffer);
+  if( ret != HED_OK && ret != HED_WARN )
+    return ret;
+  UInt_t nview = std::min<UInt_t>(first->GetNumBlockEvents(), views.size());
+  if( nview == 1 )
+    return 1;
+
+  Bool_t need_init = false;
+  for( UInt_t i = 1; i < nview; ++i ) {
+    if( !views[i] || views[i] == first )
+      return HED_ERR;
+    if( views[i]->first_decode || views[i]->fNeedInit )
+      need_init = true;
+  }
+
+  vector<Int_t> status(nview, HED_OK);
+  auto decode_one = [&]( UInt_t i ) {
+    CodaDecoder* view = views[i];
+    Int_t st = view->LoadEvent(evbuffer);
+    if( (st == HED_OK || st == HED_WARN) && view->IsMultiBlockMode() )
+      st = view->LoadFromMultiBlock(i);
+    status[i] = st;
+  };
+  if( fRocPool && !need_init )
+    fRocPool->Foreach(decode_one, nview-1, 1);
+  else {
+    for( UInt_t i = 1; i < nview; ++i )
+      decode_one(i);
+  }
+  for( UInt_t i = 1; i < nview; ++i ) {
+    if( status[i] != HED_OK && status[i] != HED_WARN )
+      return status[i];
+  }
+  return nview;
+}
+
 //_____________________________________________________________________________
 Int_t CodaDecoder::roc_decode( UInt_t roc, const UInt_t* evbuffer,
                                UInt_t ipt, UInt_t istop )
@@ -376,119 +786,193 @@ Int_t CodaDecoder::roc_decode( UInt_t roc, const UInt_t* evbuffer,
 
   if( ipt+1 >= istop )
     return HED_OK;
-  if( fDoBench ) fBench->Begin("roc_decode");
+  if( !RocIsDefined(roc) )
+    return HED_OK;
+  if( fDoBench ) fBench->Start(kBenchRocDecode);
   Int_t retval = HED_OK;
   try {
-    UInt_t Nslot = fMap->getNslot(roc);
-    if( Nslot == 0 || Nslot == kMaxUInt ) {
-      // Found data for a ROC which is not defined in the crate map.
-      // Just ignore it. Do debug log occurrences and warn user once about it.
-      if( fDebugFile ) {
-        *fDebugFile << "CodaDecode:: roc_decode:: WARNING: Undefined ROC # "
-                    << dec << roc << ", event " << event_num << endl;
-      }
-      UInt_t ibit = roc;
-      if( !fMsgPrinted.TestBitNumber(ibit) ) {
-        Warning("roc_decode", "ROC %d found in data but NOT in cratemap. "
-                           "Ignoring it.", roc);
-        fMsgPrinted.SetBitNumber(ibit);
-      }
-      return HED_OK;
-    }
-
-    if( fDebugFile )
+    if( DEBUG_FILE(fDebugFile) )
       *fDebugFile << "CodaDecode:: roc_decode:: roc#  " << dec << roc
-                  << " nslot " << Nslot << endl;
+                  << " nslot " << fMap->getNslot(roc) << endl;
 
     synchmiss = false;
     synchextra = false;
     buffmode = false;
     fBlockIsDone = false;
-    const UInt_t* p = evbuffer + ipt;    // Points to ROC ID word (1 before data)
-    const UInt_t* pstop = evbuffer + istop;   // Points to last word of data
-
-    assert(fMap->GetUsedSlots(roc).size() == Nslot); // else bug in THaCrateMap
-
-    // Build the to-do list of slots based on the contents of the crate map
-    vector<pair<UInt_t,THaSlotData*>> slots_todo; slots_todo.reserve(Nslot);
-    for( auto slot : fMap->GetUsedSlots(roc) ) {
-      assert(fMap->slotUsed(roc, slot));   // else bug in THaCrateMap
-      // ignore bank structure slots; they are decoded with bank_decode
-      if( fMap->getBank(roc, slot) >= 0 )
-        continue;
-      slots_todo.emplace_back(slot,crateslot[idx(roc,slot)].get());
-    }
-
-    // higher slot # appears first in multiblock mode
-    // the decoding order improves efficiency
-    bool is_fastbus = fMap->isFastBus(roc);
-    if( is_fastbus )
-      std::reverse( ALL(slots_todo) );
-
-    // Crawl through this ROC's data block. Each word is tested against all the
-    // defined modules (slots) in the crate for a match with the expected slot
-    // header. If a match is found, this word is the slot header. Zero or more
-    // words following the slot header represent the data for the slot. These
-    // data are loaded into the module's internal storage, and the corresponding
-    // slot is removed from the search list. The search for the remaining slots
-    // then resumes at the first word after the data.
-    UInt_t nextidx = 0;
-    while( p++ < pstop ) {
-      if( fDebugFile )
-        *fDebugFile << "CodaDecode::roc_decode:: evbuff " << (p - evbuffer)
-                    << "  " << hex << *p << dec << endl;
-
-      if( is_fastbus && LoadIfFlagData(p) )
-        continue;
 
-      bool update_nextidx = true;
-      for( UInt_t i = nextidx; i < slots_todo.size(); ++i ) {
-        UInt_t slot = slots_todo[i].first;
-        // ignore bank structure slots; they are decoded with bank_decode
-        if( slot == kMaxUInt )
-          continue;
-        auto* sd = slots_todo[i].second;
-
-        if( fDebugFile )
-          *fDebugFile << "roc_decode:: slot logic " << roc << "  " << slot;
-
-        // Check if data word at p belongs to the module at the current slot
-        UInt_t nwords = sd->LoadIfSlot(p, pstop);
-
-        if( sd->IsMultiBlockMode() ) fMultiBlockMode = true;
-        if( sd->BlockIsDone() ) fBlockIsDone = true;
-
-        if( fDebugFile )
-          *fDebugFile << "CodaDecode:: roc_decode:: after LoadIfSlot "
-                      << p + ((nwords > 0) ? nwords - 1 : 0) << "  " << pstop
-                      << "    " << hex << *p << "  " << dec << nwords << endl;
-
-        if( nwords > 0 ) {
-          if( fDebugFile )
-            *fDebugFile << "CodaDecode::  slot " << slot << "  is DONE    "
-                        << nwords << endl;
-          // Data for this slot found and loaded. Advance to next data block.
-          p += nwords-1;
-          slots_todo[i].first = kMaxUInt;  // Mark slot as done
-          if( update_nextidx )
-            nextidx = i+1;
-          break;
-        } else if( update_nextidx ) {
-          nextidx = i;
-          update_nextidx = false;
-        }
-      }
-    } //end while(p++<pstop)
+    const SlotLookup_t& lookup = GetSlotLookup(roc);
+    DecodeRocData(roc, lookup, evbuffer, ipt, istop);
+    UpdateBlockFlags(lookup);
   }
   catch( const exception& e ) {
     cerr << e.what() << endl;
     retval = HED_ERR;
   }
 
-  if( fDoBench ) fBench->Stop("roc_decode");
+  if( fDoBench ) fBench->Stop(kBenchRocDecode);
   return retval;
 }
 
+//_____________________________________________________________________________
+Bool_t CodaDecoder::RocIsDefined( UInt_t roc )
+{
+  // Check if the given ROC is defined in the crate map. If not, the caller
+  // should just ignore its data. Do debug log occurrences and warn user
+  // once about it.
+
+  UInt_t Nslot = fMap->getNslot(roc);
+  if( Nslot == 0 || Nslot == kMaxUInt ) {
+    if( DEBUG_FILE(fDebugFile) ) {
+      *fDebugFile << "CodaDecode:: roc_decode:: WARNING: Undefined ROC # "
+                  << dec << roc << ", event " << event_num << endl;
+    }
+    UInt_t ibit = roc;
+    if( !fMsgPrinted.TestBitNumber(ibit) ) {
+      Warning("roc_decode", "ROC %d found in data but NOT in cratemap. "
+                         "Ignoring it.", roc);
+      fMsgPrinted.SetBitNumber(ibit);
+    }
+    return false;
+  }
+  assert(fMap->GetUsedSlots(roc).size() == Nslot); // else bug in THaCrateMap
+  return true;
+}
+
+//_____________________________________________________________________________
+void CodaDecoder::DecodeRocData( UInt_t roc, const SlotLookup_t& lookup,
+                                 const UInt_t* evbuffer, UInt_t ipt,
+                                 UInt_t istop )
+{
+  // Load the data of all slots of the given ROC. The ROC data start after
+  // evbuffer[ipt] and end at evbuffer[istop].
+  // Only the slots of this ROC are modified, so different ROCs may be
+  // decoded concurrently, except for Fastbus ROCs (see LoadIfFlagData).
+
+  const UInt_t* p = evbuffer + ipt;    // Points to ROC ID word (1 before data)
+  const UInt_t* pstop = evbuffer + istop;   // Points to last word of data
+  const auto& slots = lookup.slots;
+  vector<bool> done(slots.size(), false);
+  bool is_fastbus = fMap->isFastBus(roc);
+  static thread_local vector<UInt_t> cand;  // Candidate slots for a word
+
+  // Crawl through this ROC's data block. Each word is tested against the
+  // defined modules (slots) in the crate for a match with the expected slot
+  // header. If a match is found, this word is the slot header. Zero or more
+  // words following the slot header represent the data for the slot. These
+  // data are loaded into the module's internal storage, and the corresponding
+  // slot is removed from the search list. The search for the remaining slots
+  // then resumes at the first word after the data.
+  // Only slots whose header pattern matches the word, found via the lookup
+  // table, and slots without a header pattern are actually tested.
+  while( p++ < pstop ) {
+    if( DEBUG_FILE(fDebugFile) )
+      *fDebugFile << "CodaDecode::roc_decode:: evbuff " << (p - evbuffer)
+                  << "  " << hex << *p << dec << endl;
+
+    if( is_fastbus && LoadIfFlagData(p) )
+      continue;
+
+    // Collect candidate slots for this word, in decoding order
+    cand.clear();
+    for( UInt_t im = 0; im < lookup.masks.size(); ++im ) {
+      ULong64_t key = (ULong64_t(im) << 32) + (*p & lookup.masks[im]);
+      auto it = lookup.headers.find(key);
+      if( it != lookup.headers.end() )
+        cand.insert(cand.end(), ALL(it->second));
+    }
+    cand.insert(cand.end(), ALL(lookup.untabled));
+    if( cand.size() > 1 )
+      sort(ALL(cand));
+
+    for( auto i : cand ) {
+      if( done[i] )
+        continue;
+      UInt_t slot = slots[i].first;
+      auto* sd = slots[i].second;
+
+      if( DEBUG_FILE(fDebugFile) )
+        *fDebugFile << "roc_decode:: slot logic " << roc << "  " << slot;
+
+      // Check if data word at p belongs to the module at the current slot
+      UInt_t nwords = sd->LoadIfSlot(p, pstop);
+
+      if( DEBUG_FILE(fDebugFile) )
+        *fDebugFile << "CodaDecode:: roc_decode:: after LoadIfSlot "
+                    << p + ((nwords > 0) ? nwords - 1 : 0) << "  " << pstop
+                    << "    " << hex << *p << "  " << dec << nwords << endl;
+
+      if( nwords > 0 ) {
+        if( DEBUG_FILE(fDebugFile) )
+          *fDebugFile << "CodaDecode::  slot " << slot << "  is DONE    "
+                      << nwords << endl;
+        // Data for this slot found and loaded. Advance to next data block.
+        p += nwords-1;
+        done[i] = true;  // Mark slot as done
+        break;
+      }
+    }
+  } //end while(p++<pstop)
+}
+
+//_____________________________________________________________________________
+void CodaDecoder::UpdateBlockFlags( const SlotLookup_t& lookup )
+{
+  // Set the multiblock flags from the state of the slots of one ROC
+
+  for( const auto& slot : lookup.slots ) {
+    auto* sd = slot.second;
+    if( sd->IsMultiBlockMode() ) fMultiBlockMode = true;
+    if( sd->BlockIsDone() ) fBlockIsDone = true;
+  }
+}
+
+//_____________________________________________________________________________
+const CodaDecoder::SlotLookup_t& CodaDecoder::GetSlotLookup( UInt_t roc )
+{
+  // Get the slot lookup table for the given ROC, building it if necessary.
+  // The table is built from the header patterns of the modules in the
+  // crate map (see Module::GetHeaderPattern) and is reset whenever the
+  // slots are reinitialized.
+
+  assert( roc < MAXROC );
+  if( fSlotLookup.size() <= roc )
+    fSlotLookup.resize(roc+1);
+  SlotLookup_t& lookup = fSlotLookup[roc];
+  if( lookup.ready )
+    return lookup;
+
+  // Build the list of slots based on the contents of the crate map
+  auto& slots = lookup.slots;
+  for( auto slot : fMap->GetUsedSlots(roc) ) {
+    assert(fMap->slotUsed(roc, slot));   // else bug in THaCrateMap
+    // ignore bank structure slots; they are decoded with bank_decode
+    if( fMap->getBank(roc, slot) >= 0 )
+      continue;
+    slots.emplace_back(slot,crateslot[idx(roc,slot)].get());
+  }
+
+  // higher slot # appears first in multiblock mode
+  // the decoding order improves efficiency
+  if( fMap->isFastBus(roc) )
+    std::reverse( ALL(slots) );
+
+  for( UInt_t i = 0; i < slots.size(); ++i ) {
+    Module* module = slots[i].second->GetModule();
+    UInt_t header = 0, mask = 0;
+    if( !module || !module->GetHeaderPattern(header, mask) ) {
+      lookup.untabled.push_back(i);
+      continue;
+    }
+    auto im = find(ALL(lookup.masks), mask);
+    if( im == lookup.masks.end() )
+      im = lookup.masks.insert(im, mask);
+    ULong64_t key = (ULong64_t(im - lookup.masks.begin()) << 32) + header;
+    lookup.headers[key].push_back(i);
+  }
+  lookup.ready = true;
+  return lookup;
+}
+
 //_____________________________________________________________________________
 Int_t CodaDecoder::bank_decode( UInt_t roc, const UInt_t* evbuffer,
                                 UInt_t ipt, UInt_t istop )
@@ -508,39 +992,45 @@ Int_t CodaDecoder::bank_decode( UInt_t roc, const UInt_t* evbuffer,
   if (!fMap->isBankStructure(roc))
     return HED_OK;
 
-  if( fDoBench ) fBench->Begin("bank_decode");
-  if (fDebugFile)
+  if( fDoBench ) fBench->Start(kBenchBankDecode);
+  if (DEBUG_FILE(fDebugFile))
     *fDebugFile << "CodaDecode:: bank_decode  ... " << roc << "   " << ipt
                 << "  " << istop << endl;
 
   fBlockIsDone = false;
-  bankdat.clear();
+  size_t nbank0 = bankdat.size();
   UInt_t pos = ipt+1;  // ipt points to ROC ID word
   while (pos < istop) {
     UInt_t len = evbuffer[pos];
     UInt_t head = evbuffer[pos+1];
     UInt_t bank = head >> 16;
-    if( fDebugFile )
+    if( DEBUG_FILE(fDebugFile) )
       *fDebugFile << "bank 0x" << hex << bank << "  head 0x" << head
                   << "    len 0x" << len << dec << endl;
 
     UInt_t key = (roc << 16) + bank;
-    assert( find(ALL(bankdat), key) == bankdat.end()); // else bug in CODA or corrupt input
     bankdat.emplace_back(key, pos + 2, len - 1);
     pos += len+1;
   }
+  // Keep bankdat sorted by key for FindBank. Banks and ROCs normally
+  // arrive in increasing order, so this rarely has to move anything.
+  auto mid = bankdat.begin() + nbank0;
+  if( !is_sorted(mid, bankdat.end()) )
+    sort(mid, bankdat.end());
+  if( nbank0 > 0 && !(mid[-1] < *mid) )
+    inplace_merge(bankdat.begin(), mid, bankdat.end());
+  assert( adjacent_find(ALL(bankdat)) == bankdat.end() ); // else bug in CODA or corrupt input
 
   for( auto slot : fMap->GetUsedSlots(roc) ) {
     assert(fMap->slotUsed(roc,slot));
     Int_t bank=fMap->getBank(roc,slot);
     assert( bank < MAXBANK ); // bank numbers are uint16_t
     if( bank < 0 ) continue;  // skip non-bank mode modules in mixed-mode crate
-    UInt_t key = (roc << 16) + bank;
-    auto theBank = find(ALL(bankdat), key);
-    if( theBank == bankdat.end() )
+    const BankDat_t* theBank = FindBank((roc << 16) + bank);
+    if( !theBank )
       // Bank defined in crate map but not present in this event
       continue;
-    if (fDebugFile)
+    if (DEBUG_FILE(fDebugFile))
       *fDebugFile << "CodaDecoder::bank_decode: loading bank "
                   << roc << "  " << slot << "   " << bank << "  "
                   << theBank->pos << "   " << theBank->len << endl;
@@ -550,34 +1040,69 @@ Int_t CodaDecoder::bank_decode( UInt_t roc, const UInt_t* evbuffer,
     if (sd->BlockIsDone()) fBlockIsDone = true;
   }
 
-  if( fDoBench ) fBench->Stop("bank_decode");
+  if( fDoBench ) fBench->Stop(kBenchBankDecode);
   return HED_OK;
 }
 
+//_____________________________________________________________________________
+const CodaDecoder::BankDat_t* CodaDecoder::FindBank( UInt_t key ) const
+{
+  // Find the coordinates of the bank with the given key (bank number +
+  // (roc << 16)) in the current event. Returns nullptr if not present.
+
+  auto it = lower_bound(ALL(bankdat), key,
+                        []( const BankDat_t& b, UInt_t k ) { return b.key < k; });
+  if( it == bankdat.end() || it->key != key )
+    return nullptr;
+  return &*it;
+}
+
 //_____________________________________________________________________________
  Int_t CodaDecoder::FillBankData( UInt_t *rdat, UInt_t roc, Int_t bank,
                                   UInt_t offset, UInt_t num ) const
 {
+  // Copy 'num' words of the given bank of the given ROC, starting at
+  // 'offset', to 'rdat'. See GetBankData.
+
+  const UInt_t* data = nullptr;
+  UInt_t ndata = 0;
+  Int_t ret = GetBankData(roc, bank, offset, num, data, ndata);
+  if( ret == HED_OK )
+    copy(data, data+ndata, rdat);
+  return ret;
+}
+
+//_____________________________________________________________________________
+Int_t CodaDecoder::GetBankData( UInt_t roc, Int_t bank, UInt_t offset,
+                                UInt_t num, const UInt_t*& data,
+                                UInt_t& ndata ) const
+{
+  // Set 'data' to the location of word 'offset' of the given bank of
+  // the given ROC in the current event buffer, and 'ndata' to the number
+  // of words available there, at most 'num'. No data are copied; the
+  // pointer is valid until the next event is loaded.
+
   if( fDebug > 1 )
-    cout << "Into FillBankData v1 " << dec << roc << "  " << bank << "  "
+    cout << "Into GetBankData v1 " << dec << roc << "  " << bank << "  "
          << offset << "  " << num << endl;
-  if( fDebugFile )
-    *fDebugFile << "Check FillBankData " << roc << "  " << bank << endl;
+  if( DEBUG_FILE(fDebugFile) )
+    *fDebugFile << "Check GetBankData " << roc << "  " << bank << endl;
 
+  data = nullptr;
+  ndata = 0;
   if( roc >= MAXROC )
     return HED_ERR;
-  UInt_t jk = (roc << 16) + bank;
-  auto bankInfo = find(ALL(bankdat), jk);
-  if( bankInfo == bankdat.end() ) {
-    cerr << "FillBankData::ERROR:  bankdat not in current event "<<endl;
+  const BankDat_t* bankInfo = FindBank((roc << 16) + bank);
+  if( !bankInfo ) {
+    cerr << "GetBankData::ERROR:  bankdat not in current event "<<endl;
     return HED_ERR;
   }
   UInt_t pos = bankInfo->pos;
   UInt_t len = bankInfo->len;
   if( fDebug > 1 )
-    cout        << "FillBankData: pos, len " << pos << "   " << len << endl;
-  if( fDebugFile )
-    *fDebugFile << "FillBankData  pos, len " << pos << "   " << len << endl;
+    cout        << "GetBankData: pos, len " << pos << "   " << len << endl;
+  if( DEBUG_FILE(fDebugFile) )
+    *fDebugFile << "GetBankData  pos, len " << pos << "   " << len << endl;
   assert( pos < event_length && pos+len <= event_length ); // else bug in bank_decode
   if( offset+2 > len )
     return HED_ERR;
@@ -588,7 +1113,8 @@ Int_t CodaDecoder::bank_decode( UInt_t roc, const UInt_t* evbuffer,
   UInt_t ihi = pos + offset + num;
   if( ihi > event_length )
     ihi = event_length;
-  memcpy(rdat, buffer+ilo, ihi-ilo);
+  data = buffer + ilo;
+  ndata = ihi - ilo;
 
   return HED_OK;
 }
@@ -604,7 +1130,7 @@ Int_t CodaDecoder::LoadIfFlagData(const UInt_t* evbuffer)
   // Returns 0 if no flag data detected, != 0 otherwise
   assert( evbuffer );
   UInt_t word = *evbuffer;
-  if (fDebugFile)
+  if (DEBUG_FILE(fDebugFile))
     *fDebugFile << "CodaDecode:: TestBit on :  Flag data ? "
                 << hex << word << dec << endl;
   UInt_t stdslot = word >> 27;
@@ -661,7 +1187,7 @@ Int_t CodaDecoder::FindRocs(const UInt_t *evbuffer) {
 
   assert( evbuffer );
 #ifdef FIXME
-  if( fDoBench ) fBench->Begin("physics_decode");
+  if( fDoBench ) fBench->Start(kBenchPhysicsDecode);
 #endif
   Int_t status = HED_OK;
 
@@ -681,7 +1207,7 @@ Int_t CodaDecoder::FindRocs(const UInt_t *evbuffer) {
 	cout << "ERROR in EvtTypeHandler::FindRocs "<<endl;
 	cout << "  illegal ROC number " <<dec<<iroc<<endl;
       }
-      if( fDoBench ) fBench->Stop("physics_decode");
+      if( fDoBench ) fBench->Stop(kBenchPhysicsDecode);
 #endif
       return HED_ERR;
     }
@@ -692,7 +1218,7 @@ Int_t CodaDecoder::FindRocs(const UInt_t *evbuffer) {
     pos += len+1;
   }
 
-  if (fDebugFile) {
+  if (DEBUG_FILE(fDebugFile)) {
     *fDebugFile << "CodaDecode:: num rocs "<<dec<<nroc<<endl;
     for( UInt_t i = 0; i < nroc; i++ ) {
       UInt_t iroc = irn[i];
@@ -739,7 +1265,7 @@ Int_t CodaDecoder::FindRocsCoda3(const UInt_t *evbuffer) {
 
   }
 
-  if (fDebugFile) {  // debug
+  if (DEBUG_FILE(fDebugFile)) {  // debug
 
     *fDebugFile << endl << "  FindRocsCoda3 :: Starting Event number = " << dec << tbank.evtNum;
     *fDebugFile << endl;
@@ -756,10 +1282,10 @@ Int_t CodaDecoder::FindRocsCoda3(const UInt_t *evbuffer) {
     *fDebugFile << "         Event #       Time Stamp       Event Type"<<endl;
     for( UInt_t i = 0; i < tbank.blksize; i++ ) {
       if( tbank.evTS ) {
-          *fDebugFile << "      "<<dec<<tbank.evtNum+i<<"   "<<tbank.evTS[i]<<"   "<<tbank.evType[i];
+          *fDebugFile << "      "<<dec<<tbank.evtNum+i<<"   "<<fBlockTS[i]<<"   "<<fBlockTrigType[i];
           *fDebugFile << endl;
        } else {
-	  *fDebugFile << "     "<<tbank.evtNum+i<<"(No Time Stamp)   "<<tbank.evType[i];
+	  *fDebugFile << "     "<<tbank.evtNum+i<<"(No Time Stamp)   "<<fBlockTrigType[i];
 	  *fDebugFile << endl;
        }
        *fDebugFile << endl<<endl;
@@ -787,13 +1313,16 @@ int CodaDecoder::init_slotdata()
 
   if(!fMap) return HED_ERR;
 
+  // Slot lookup tables are rebuilt on demand
+  fSlotLookup.clear();
+
   try {
     for( auto iroc : fMap->GetUsedCrates() ) {
       assert(fMap->crateUsed(iroc));
       for( auto islot : fMap->GetUsedSlots(iroc) ) {
         assert(fMap->slotUsed(iroc, islot));
         makeidx(iroc, islot);
-        if( fDebugFile )
+        if( DEBUG_FILE(fDebugFile) )
           *fDebugFile << "CodaDecode::  crate, slot " << iroc << "  " << islot
                       << "   Dev type  = " << crateslot[idx(iroc, islot)]->devType()
                       << endl;
@@ -805,7 +1334,7 @@ int CodaDecoder::init_slotdata()
     return HED_FATAL;
   }
 
-  if (fDebugFile)
+  if (DEBUG_FILE(fDebugFile))
     *fDebugFile << "CodaDecode:: fNSlotUsed "<<fSlotUsed.size()<<endl;
 
   // Update lists of used/clearable slots in case crate map changed
@@ -817,7 +1346,7 @@ int CodaDecoder::init_slotdata()
 void CodaDecoder::dump(const UInt_t* evbuffer) const
 {
   if( !evbuffer ) return;
-  if ( !fDebugFile ) return;
+  if ( !DEBUG_FILE(fDebugFile) ) return;
   *fDebugFile << "\n\n Raw Data Dump  " << endl;
   *fDebugFile << "\n Event number  " << dec << event_num;
   *fDebugFile << "  length " << event_length << "  type " << event_type << endl;
@@ -841,7 +1370,7 @@ void CodaDecoder::dump(const UInt_t* evbuffer) const
 //_____________________________________________________________________________
 void CodaDecoder::CompareRocs()
 {
-  if (!fMap || !fDebugFile) return;
+  if (!fMap || !DEBUG_FILE(fDebugFile)) return;
   *fDebugFile<< "Comparing cratemap rocs with found rocs"<<endl;
   for( UInt_t i = 0; i < nroc; i++ ) {
     UInt_t iroc = irn[i];
@@ -892,18 +1421,18 @@ void CodaDecoder::ChkFbSlots()
       bool inEvent = fbfound[index], inMap = fMap->slotUsed(iroc, islot);
       if( inEvent ) {
         if( inMap ) {
-          if (fDebugFile)
+          if (DEBUG_FILE(fDebugFile))
             *fDebugFile << "FB slot in cratemap and in data.  (good!).  "
                         << "roc = "<<iroc<<"   slot = "<<islot<<endl;
         } else {
-          if (fDebugFile)
+          if (DEBUG_FILE(fDebugFile))
             *fDebugFile << "FB slot in data, but NOT in cratemap  (bad!).  "
                         << "roc = "<<iroc<<"   slot = "<<islot<<endl;
           Warning("ChkFbSlots", "Fastbus module in (roc,slot) = (%d,%d)  "
                                 "found in data but NOT in cratemap !", iroc, islot);
         }
       } else if( inMap ) {
-        if (fDebugFile)
+        if (DEBUG_FILE(fDebugFile))
           *fDebugFile << "FB slot NOT in data, but in cratemap  (bad!).  "
                       << "roc = "<<iroc<<"   slot = "<<islot<<endl;
         // Why do we care? If the cratemap has info about additional hardware
@@ -968,10 +1497,12 @@ Int_t CodaDecoder::prescale_decode(const UInt_t* evbuffer)
   else if( event_type == PRESCALE_EVTYPE ) {
     if( event_length <= HEAD_OFF2 )
       return HED_ERR;  //oops, event too short?
-    THaUsrstrutils sut;
-    sut.string_from_evbuffer(evbuffer+HEAD_OFF2, event_length-HEAD_OFF2);
+    UInt_t psval[MAX_PSFACT];
+    THaUsrstrutils::getints_from_evbuffer(evbuffer+HEAD_OFF2,
+                                          event_length-HEAD_OFF2,
+                                          pstr, MAX_PSFACT, psval);
     for(Int_t trig=0; trig<MAX_PSFACT; trig++) {
-      UInt_t ps =  sut.getint(pstr[trig]);
+      UInt_t ps = psval[trig];
       UInt_t psmax = 65536; // 2^16 for trig > 3
       if (trig < 4) psmax = 16777216;  // 2^24 for 1st 4 trigs
       if (trig > 7) ps = 1;  // cannot prescale trig 9-12
@@ -13,6 +13,9 @@
 #include "THaEvData.h"
 #include <vector>
 #include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <memory>
 
 namespace Decoder {
 
@@ -24,6 +27,10 @@ public:
   virtual Int_t  Init();
 
   virtual Int_t  LoadEvent(const UInt_t* evbuffer);
+  virtual Int_t  PeekEvent( const UInt_t* evbuffer, EvHeader_t& hdr ) const;
+  virtual Int_t  SkipEvent( const UInt_t* evbuffer );
+  virtual Int_t  LoadRocs( const UInt_t* evbuffer,
+                           const std::vector<UInt_t>& rocs );
 
   virtual UInt_t GetPrescaleFactor( UInt_t trigger ) const;
   virtual void   SetRunTime( ULong64_t tloc );
@@ -32,11 +39,30 @@ public:
 
   virtual Bool_t DataCached() { return fMultiBlockMode && !fBlockIsDone; }
   virtual Int_t  LoadFromMultiBlock();
+  virtual Int_t  LoadFromMultiBlock( UInt_t ievent );
+          UInt_t GetNumBlockEvents() const;
+          UInt_t GetBlockIndex() const { return fBlockIndex; }
+  // Trigger bank data of the events of the current CODA3 block
+          ULong64_t GetBlockTimeStamp( UInt_t ievent ) const
+  { return ievent < fBlockTS.size() ? fBlockTS[ievent] : 0; }
+          UInt_t GetBlockTrigType( UInt_t ievent ) const
+  { return ievent < fBlockTrigType.size() ? fBlockTrigType[ievent] : 0; }
+          Int_t  FanOutBlock( const UInt_t* evbuffer,
+                              const std::vector<CodaDecoder*>& views );
   virtual Bool_t IsMultiBlockMode() { return fMultiBlockMode; };
   virtual Bool_t BlockIsDone() { return fBlockIsDone; };
 
   virtual Int_t  FillBankData( UInt_t* rdat, UInt_t roc, Int_t bank,
                                UInt_t offset = 0, UInt_t num = 1 ) const;
+          Int_t  GetBankData( UInt_t roc, Int_t bank, UInt_t offset,
+                              UInt_t num, const UInt_t*& data,
+                              UInt_t& ndata ) const;
+
+  // Event type corresponding to a CODA 3 bank tag
+  static  UInt_t Coda3EventType( UInt_t tag );
+
+          void   SetNumRocThreads( UInt_t n );
+          UInt_t GetNumRocThreads() const { return fNRocThreads; }
 
   enum { MAX_PSFACT = 12 };
 
@@ -46,6 +72,7 @@ protected:
   Int_t FindRocs(const UInt_t *evbuffer);  // CODA2 version
   Int_t FindRocsCoda3(const UInt_t *evbuffer); // CODA3 version
   Int_t roc_decode( UInt_t roc, const UInt_t* evbuffer, UInt_t ipt, UInt_t istop );
+  Int_t DecodeRocsParallel( const UInt_t* evbuffer );
   Int_t bank_decode( UInt_t roc, const UInt_t* evbuffer, UInt_t ipt, UInt_t istop );
 
   void CompareRocs();
@@ -55,6 +82,8 @@ protected:
   virtual Int_t  init_slotdata();
   virtual Int_t  interpretCoda3( const UInt_t* buffer );
   virtual UInt_t trigBankDecode( const UInt_t* evbuffer, UInt_t blkSize );
+  Bool_t trigBankFastPath( const UInt_t* evbuffer, UInt_t blkSize );
+  void   trigBankParse( const UInt_t* evbuffer, UInt_t blkSize );
   Int_t prescale_decode( const UInt_t* evbuffer );
   void  dump( const UInt_t* evbuffer ) const;
 
@@ -80,11 +109,37 @@ protected:
     UInt_t pos;   // position in evbuffer[]
     UInt_t len;   // length of data
   };
-  std::vector<BankDat_t> bankdat;
+  std::vector<BankDat_t> bankdat;  // Banks of the current event, sorted by key
+
+  const BankDat_t* FindBank( UInt_t key ) const;
+
+  class SlotLookup_t {         // Slot header lookup table for one ROC
+  public:
+    SlotLookup_t() : ready(false) {}
+    Bool_t ready;
+    std::vector<std::pair<UInt_t,THaSlotData*>> slots; // In decoding order
+    std::vector<UInt_t> masks;      // Distinct header masks
+    // (mask index << 32) + header -> indices into slots
+    std::unordered_map<ULong64_t,std::vector<UInt_t>> headers;
+    std::vector<UInt_t> untabled;   // Slots without header pattern
+  };
+  std::vector<SlotLookup_t> fSlotLookup; // Indexed by ROC
+
+  const SlotLookup_t& GetSlotLookup( UInt_t roc );
+  Bool_t RocIsDefined( UInt_t roc );
+  void   DecodeRocData( UInt_t roc, const SlotLookup_t& lookup,
+                        const UInt_t* evbuffer, UInt_t ipt, UInt_t istop );
+  void   UpdateBlockFlags( const SlotLookup_t& lookup );
+
+  // Parallel decoding of ROCs within one event
+  class RocPool;
+  UInt_t                   fNRocThreads;
+  std::unique_ptr<RocPool> fRocPool;
 
   // CODA3 stuff
   UInt_t evcnt_coda3;
   Bool_t fMultiBlockMode, fBlockIsDone;
+  UInt_t fBlockIndex;  // Index of current event within multiblock buffer
 
   class TBOBJ {
   public:
@@ -104,6 +159,10 @@ protected:
    };
 
   TBOBJ tbank;
+  // Time stamps and trigger types of all events of the block, decoded
+  // once per block from tbank
+  std::vector<ULong64_t> fBlockTS;
+  std::vector<UInt_t>    fBlockTrigType;
 
   ClassDef(CodaDecoder,0) // Decoder for CODA event buffer
 };
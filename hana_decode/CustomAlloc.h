@@ -3,7 +3,10 @@
 
 // Custom allocators for Decoder package
 
+#include "PageAlloc.h"
 #include <memory>
+#include <new>
+#include <vector>
 
 namespace Decoder {
 // From https://stackoverflow.com/questions/21028299/is-this-behavior-of-vectorresizesize-type-n-under-c11-and-boost-container/21028912#21028912
@@ -33,9 +36,46 @@ public:
   }
 };
 
+// Allocator that takes buffers of at least Podd::PageAlloc::kMinSize bytes
+// from Podd::PageAlloc, which may back them with huge pages or pre-fault
+// them (see Podd::PageAlloc::SetMode), and smaller ones from operator new.
+// The choice depends only on the size, so deallocate() always matches.
+template<typename T>
+class page_allocator {
+public:
+  typedef T value_type;
+
+  page_allocator() noexcept = default;
+  template<typename U>
+  page_allocator( const page_allocator<U>& ) noexcept {}
+
+  T* allocate( std::size_t n ) {
+    std::size_t bytes = n * sizeof(T);
+    if( bytes >= Podd::PageAlloc::kMinSize )
+      return static_cast<T*>(Podd::PageAlloc::Allocate(bytes));
+    return static_cast<T*>(::operator new(bytes));
+  }
+  void deallocate( T* p, std::size_t n ) noexcept {
+    std::size_t bytes = n * sizeof(T);
+    if( bytes >= Podd::PageAlloc::kMinSize )
+      Podd::PageAlloc::Deallocate(p, bytes);
+    else
+      ::operator delete(p);
+  }
+};
+
+template<typename T, typename U>
+bool operator==( const page_allocator<T>&, const page_allocator<U>& )
+{ return true; }
+template<typename T, typename U>
+bool operator!=( const page_allocator<T>&, const page_allocator<U>& )
+{ return false; }
+
 using VectorUInt = std::vector<UInt_t>;
-// std::vector that does NOT zero-initialize its elements on resize()
-using VectorUIntNI = std::vector<UInt_t, default_init_allocator<UInt_t>>;
+// std::vector that does NOT zero-initialize its elements on resize().
+// Large instances are allocated according to Podd::PageAlloc::SetMode.
+using VectorUIntNI = std::vector<UInt_t,
+  default_init_allocator<UInt_t, page_allocator<UInt_t>>>;
 
 } // namespace Decoder
 
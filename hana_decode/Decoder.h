@@ -58,6 +58,15 @@ namespace Decoder {
     kMultiFunctionADC, kMultiFunctionTDC };
 }
 
+// Decoder debug tracing to the file set with SetDebugFile() is compiled in
+// only in tracing builds (DECODER_TRACE defined). In production builds,
+// tests like "if( DEBUG_FILE(fDebugFile) )" are constant false, so the
+// tracing code drops out of the decoding loops entirely.
+#ifdef DECODER_TRACE
+#define DEBUG_FILE(f) (f)
+#else
+#define DEBUG_FILE(f) (static_cast<decltype(f)>(nullptr))
+#endif
 
 
 #endif
@@ -10,6 +10,9 @@
 #include "THaEvData.h"
 #include "TMath.h"
 #include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
 
 using namespace std;
 
@@ -17,6 +20,8 @@ namespace Decoder {
 
   const Int_t NTDCCHAN = 32;
   const Int_t MAXHIT   = 100;
+  const UInt_t MAXCHAN  = 64;       // Channel numbers after renumbering
+  const UInt_t TDCRANGE = 0x10000;  // 16-bit time measurement
 
   Module::TypeIter_t F1TDCModule::fgThisType =
     DoRegister( ModuleType( "Decoder::F1TDCModule" , 3201 ));
@@ -24,7 +29,8 @@ namespace Decoder {
 F1TDCModule::F1TDCModule( UInt_t crate, UInt_t slot ) :
   VmeModule(crate, slot), fNumHits(0), fResol(ILO),
   fTdcData(NTDCCHAN*MAXHIT),
-  IsInit(false), slotmask(0), chanmask(0), datamask(0)
+  IsInit(false), slotmask(0), chanmask(0), datamask(0), fRefChan(kMaxUInt),
+  fRefOffset(0), fRollover(TDCRANGE), fRefTime(0), fHasRefTime(false)
 {
   F1TDCModule::Init();
 }
@@ -39,12 +45,38 @@ void F1TDCModule::Init() {
   fWdcntMask=0;
   SetResolution(1);
   if (fModelNum == 6401) SetResolution(0);
+  fRefChan = kMaxUInt;
+  fRefOffset = 0;
+  fRollover = TDCRANGE;
+}
+
+void F1TDCModule::Init( const char* configstr ) {
+  // Initialize with optional reference channel configuration from the
+  // crate map: "refchan=<chan> offset=<channels> rollover=<channels>".
+  // The rollover period defaults to the full 16-bit range of the data word.
+  // The actual rollover of the F1 depends on its setup registers.
+  Init();
+  ParseConfigStr(configstr, {
+    {"refchan", fRefChan}, {"offset", fRefOffset}, {"rollover", fRollover}
+  });
+  if( fRefChan != kMaxUInt && fRefChan >= MAXCHAN ) {
+    ostringstream ostr;
+    ostr << "F1TDCModule: Invalid reference channel " << fRefChan
+         << ". Must be < " << MAXCHAN << ". Fix the cratemap.";
+    throw invalid_argument(ostr.str());
+  }
+  if( fRollover == 0 ) {
+    ostringstream ostr;
+    ostr << "F1TDCModule: Rollover period must be > 0. "
+         << "Fix the cratemap.";
+    throw invalid_argument(ostr.str());
+  }
 }
 
 
 Bool_t F1TDCModule::IsSlot(UInt_t rdata)
 {
-  if (fDebugFile)
+  if (DEBUG_FILE(fDebugFile))
     *fDebugFile << "is F1TDC slot ? "<<hex<<fHeader
                 <<"  "<<fHeaderMask<<"  "<<rdata<<dec<<endl;
   return ((rdata != 0xffffffff) & ((rdata & fHeaderMask)==fHeader));
@@ -57,16 +89,45 @@ UInt_t F1TDCModule::GetData( UInt_t chan, UInt_t hit ) const
   return fTdcData[idx];
 }
 
+size_t F1TDCModule::GetCapacity() const {
+  return ( fTdcData.capacity() + fHitChan.capacity() + fHitRaw.capacity() )
+    * sizeof(UInt_t) + VmeModule::GetCapacity();
+}
+
 void F1TDCModule::Clear(Option_t* opt) {
   VmeModule::Clear(opt);
   fNumHits = 0;
   fTdcData.assign(NTDCCHAN*MAXHIT,0);
+  fRefTime = 0;
+  fHasRefTime = false;
+  fHitChan.clear();
+  fHitRaw.clear();
+}
+
+void F1TDCModule::LoadReferencedHits( THaSlotData* sldat ) {
+  // Convert the buffered hits to times relative to the first hit in the
+  // reference channel and load them into the slot data, in the original
+  // order. The reference channel itself is loaded unchanged. Without a
+  // reference hit, all hits are loaded unchanged, and HasRefTime() is false.
+  auto ref = find(fHitChan.begin(), fHitChan.end(), fRefChan);
+  fHasRefTime = (ref != fHitChan.end());
+  if( fHasRefTime )
+    fRefTime = fHitRaw[ref - fHitChan.begin()];
+  for( size_t i = 0; i < fHitChan.size(); ++i ) {
+    UInt_t chan = fHitChan[i];
+    UInt_t data = fHitRaw[i];
+    if( fHasRefTime && chan != fRefChan )
+      data = ReferencedTime(data, fRefTime, fRefOffset, fRollover);
+    sldat->loadData("tdc",chan,data,fHitRaw[i]);
+    UInt_t idx = chan * MAXHIT + 0;
+    if( idx < MAXHIT * NTDCCHAN ) fTdcData[idx] = data;
+  }
 }
 
 UInt_t F1TDCModule::LoadSlot( THaSlotData *sldat, const UInt_t *evbuffer,
                               const UInt_t *pstop ) {
 // this increments evbuffer
-  if (fDebugFile) *fDebugFile << "F1TDCModule:: loadslot "<<endl;
+  if (DEBUG_FILE(fDebugFile)) *fDebugFile << "F1TDCModule:: loadslot "<<endl;
   fWordsSeen = 0;
 
   // CAUTION: this routine re-numbers the channels
@@ -109,14 +170,15 @@ UInt_t F1TDCModule::LoadSlot( THaSlotData *sldat, const UInt_t *evbuffer,
    // look at all the data
    const UInt_t *loc = evbuffer;
 #ifdef WITH_DEBUG
-   if(fDebug > 1 && fDebugFile)
+   if(fDebug > 1 && DEBUG_FILE(fDebugFile))
      *fDebugFile<< "Debug of F1TDC data, fResol =  "<<fResol<<"  model num  "<<fModelNum<<endl;
 #endif
+   // IsSlot is final, so this per-word test is statically bound
    while ( loc <= pstop && IsSlot(*loc) ) {
      if ( !( (*loc) & DATA_MARKER ) ) {
        // header/trailer word, to be ignored
 #ifdef WITH_DEBUG
-       if(fDebug > 1 && fDebugFile)
+       if(fDebug > 1 && DEBUG_FILE(fDebugFile))
          *fDebugFile<< "[" << (loc-evbuffer) << "] header/trailer  0x"
          <<hex<<*loc<<dec<<endl;
 #endif
@@ -124,7 +186,7 @@ UInt_t F1TDCModule::LoadSlot( THaSlotData *sldat, const UInt_t *evbuffer,
        UInt_t chan = ((*loc) >> 16) & 0x3f;  // internal channel number
 #ifdef WITH_DEBUG
        UInt_t chn = chan; // save original for debug message below
-       if (fDebug > 1 && fDebugFile)
+       if (fDebug > 1 && DEBUG_FILE(fDebugFile))
          *fDebugFile<< "[" << (loc-evbuffer) << "] data            0x"
          <<hex<<*loc<<dec<<endl;
 #endif
@@ -155,18 +217,26 @@ UInt_t F1TDCModule::LoadSlot( THaSlotData *sldat, const UInt_t *evbuffer,
 
        UInt_t raw = (*loc) & 0xffff;
 #ifdef WITH_DEBUG
-       if(fDebug > 1 && fDebugFile) {
+       if(fDebug > 1 && DEBUG_FILE(fDebugFile)) {
          *fDebugFile<<" int_chn chan data "<<dec<<chn<<"  "<<chan
              <<"  0x"<<hex<<raw<<dec<<endl;
        }
 #endif
-       /*Int_t status = */sldat->loadData("tdc",chan,raw,raw);
-       UInt_t idx = chan * MAXHIT + 0;  // 1 hit per chan ???
-       if( idx < MAXHIT * NTDCCHAN ) fTdcData[idx] = raw;
+       if( fRefChan != kMaxUInt ) {
+         // Loaded after the whole slot has been seen, see LoadReferencedHits
+         fHitChan.push_back(chan);
+         fHitRaw.push_back(raw);
+       } else {
+         /*Int_t status = */sldat->loadData("tdc",chan,raw,raw);
+         UInt_t idx = chan * MAXHIT + 0;  // 1 hit per chan ???
+         if( idx < MAXHIT * NTDCCHAN ) fTdcData[idx] = raw;
+       }
        fWordsSeen++;
      }
      loc++;
    }
+   if( fRefChan != kMaxUInt )
+     LoadReferencedHits(sldat);
 
   return fWordsSeen;
 }
@@ -18,7 +18,9 @@ class F1TDCModule : public VmeModule {
 public:
 
    F1TDCModule() : fNumHits(0), fResol(ILO), IsInit(false),
-                   slotmask(0), chanmask(0), datamask(0) {}
+                   slotmask(0), chanmask(0), datamask(0), fRefChan(kMaxUInt),
+                   fRefOffset(0), fRollover(0), fRefTime(0),
+                   fHasRefTime(false) {}
    F1TDCModule( UInt_t crate, UInt_t slot );
    virtual ~F1TDCModule() = default;
 
@@ -28,9 +30,11 @@ public:
    enum EResolution { ILO = 0, IHI = 1 };
 
    virtual void Init();
+   virtual void Init( const char* configstr );
    virtual void Clear(Option_t *opt="");
-   virtual Bool_t IsSlot(UInt_t rdata);
+   virtual Bool_t IsSlot(UInt_t rdata) final;
    virtual UInt_t GetData( UInt_t chan, UInt_t hit) const;
+   virtual size_t GetCapacity() const;
 
    void SetResolution(Int_t which=0) {
      fResol = (which==0) ? ILO : IHI;
@@ -39,6 +43,14 @@ public:
    Bool_t IsHiResolution() const { return (fResol==IHI); };
 
    UInt_t GetNumHits() const { return fNumHits; };
+
+   // Reference channel configuration, set via the crate map, e.g.
+   // "cfg: refchan=31 offset=1000". If a reference channel is set, the
+   // times of all other channels are given relative to the first hit in
+   // the reference channel.
+   UInt_t GetRefChan() const { return fRefChan; }
+   UInt_t GetRefTime() const { return fRefTime; }
+   Bool_t HasRefTime() const { return fHasRefTime; }
    Int_t Decode(const UInt_t*) { return 0; };
 
 private:
@@ -52,6 +64,16 @@ private:
    Bool_t IsInit;
    UInt_t slotmask, chanmask, datamask;
 
+   UInt_t fRefChan;     // Reference channel (kMaxUInt = none)
+   UInt_t fRefOffset;   // Offset added to referenced times (channels)
+   UInt_t fRollover;    // TDC counter rollover period (channels)
+   UInt_t fRefTime;     // Raw reference time in current event
+   Bool_t fHasRefTime;  // Reference channel has a hit in current event
+   std::vector<UInt_t> fHitChan;  // Hit channels, if referencing
+   std::vector<UInt_t> fHitRaw;   // Raw hit times, if referencing
+
+   void LoadReferencedHits( THaSlotData* sldat );
+
    static TypeIter_t fgThisType;
    ClassDef(F1TDCModule,0)  //  JLab F1 TDC Module
 
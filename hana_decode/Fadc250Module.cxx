@@ -51,12 +51,13 @@
 
 #include "Fadc250Module.h"
 #include "THaSlotData.h"
+#include "FadcWaveform.h"
 #include "TMath.h"
 
 #include <unistd.h>
 #include <iostream>
 #include <iomanip>
-#include <numeric>
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
 
@@ -77,7 +78,7 @@ namespace Decoder {
     DoRegister( ModuleType( "Decoder::Fadc250Module" , 250 ));
 
   Fadc250Module::Fadc250Module()
-    : fadc_data{}, fPulseData(NADCCHAN),
+    : fadc_data{}, fPulseData(NADCCHAN), fSampleResults(NADCCHAN),
       data_type_4(false), data_type_6(false), data_type_7(false),
       data_type_8(false), data_type_9(false), data_type_10(false),
       block_header_found(false), block_trailer_found(false),
@@ -86,7 +87,7 @@ namespace Decoder {
 
   Fadc250Module::Fadc250Module(UInt_t crate, UInt_t slot)
     : PipeliningModule(crate, slot), fadc_data{}, fPulseData(NADCCHAN),
-      data_type_4(false), data_type_6(false), data_type_7(false),
+      fSampleResults(NADCCHAN), data_type_4(false), data_type_6(false), data_type_7(false),
       data_type_8(false), data_type_9(false), data_type_10(false),
       block_header_found(false), block_trailer_found(false),
       event_header_found(false), slots_match(false)
@@ -113,8 +114,10 @@ namespace Decoder {
   void Fadc250Module::ClearDataVectors() {
     // Clear all data objects
     assert(fPulseData.size() == NADCCHAN);  // Initialization error in constructor
+    assert(fSampleResults.size() == NADCCHAN);
     for (uint32_t i = 0; i < NADCCHAN; i++) {
       fPulseData[i].clear();
+      fSampleResults[i].clear();
     }
   }
 
@@ -125,9 +128,32 @@ namespace Decoder {
       data_vector.push_back(data);
   }
 
+  // Same for raw samples, which have at most 13 bits
+  void Fadc250Module::PopulateDataVector(vector<uint16_t>& data_vector, uint32_t data) {
+    assert(data <= 0xFFFF);
+    if (static_cast <uint32_t> (fSlot) == fadc_data.slot_blk_hdr)
+      data_vector.push_back(static_cast<uint16_t>(data));
+  }
+
   // Sum elements contained in data vector
-  uint32_t Fadc250Module::SumVectorElements( const vector<uint32_t>& data_vector) {
-    return accumulate(data_vector.begin(), data_vector.end(), 0U);
+  uint32_t Fadc250Module::SumVectorElements( const vector<uint16_t>& data_vector) {
+    return FadcWaveform::Sum(data_vector.data(), 0, data_vector.size());
+  }
+
+  size_t Fadc250Module::GetCapacity() const {
+    // Memory reserved for pulse data and sample results of all channels
+    size_t n32 = 0, n16 = 0;
+    for( const auto& d : fPulseData ) {
+      n32 += d.integral.capacity() + d.time.capacity() + d.peak.capacity()
+        + d.pedestal.capacity() + d.coarse_time.capacity()
+        + d.fine_time.capacity() + d.pedestal_quality.capacity()
+        + d.overflow.capacity() + d.underflow.capacity();
+      n16 += d.samples.capacity();
+    }
+    return n32 * sizeof(uint32_t) + n16 * sizeof(uint16_t)
+      + fPulseData.capacity() * sizeof(fadc_pulse_data)
+      + fSampleResults.capacity() * sizeof(fadc_sample_results)
+      + VmeModule::GetCapacity();
   }
 
   void Fadc250Module::Clear(Option_t* opt) {
@@ -224,7 +250,7 @@ namespace Decoder {
     }
     else {
 #ifdef WITH_DEBUG
-      if (fDebugFile)
+      if (DEBUG_FILE(fDebugFile))
 	*fDebugFile << "Fadc250Module::GetPulseIntegralData channel "
 		    << chan << ", event " << ievent << " = "
 		    <<  fPulseData[chan].integral[ievent] << endl;
@@ -242,7 +268,7 @@ namespace Decoder {
     }
     else {
 #ifdef WITH_DEBUG
-      if (fDebugFile)
+      if (DEBUG_FILE(fDebugFile))
 	*fDebugFile << "Fadc250Module::GetEmulatedPulseIntegralData channel "
 		    << chan << " = " <<  SumVectorElements(fPulseData[chan].samples) << endl;
 #endif
@@ -262,7 +288,7 @@ namespace Decoder {
     }
     else {
 #ifdef WITH_DEBUG
-      if (fDebugFile)
+      if (DEBUG_FILE(fDebugFile))
 	*fDebugFile << "Fadc250Module::GetPulseTimeData channel "
 		    << chan << ", event " << ievent << " = "
 		    <<  fPulseData[chan].time[ievent] << endl;
@@ -283,7 +309,7 @@ namespace Decoder {
     }
     else {
 #ifdef WITH_DEBUG
-      if (fDebugFile)
+      if (DEBUG_FILE(fDebugFile))
         *fDebugFile << "Fadc250Module::GetPulseCoarseTimeData channel "
                     << chan << ", event " << ievent << " = "
                     <<  fPulseData[chan].coarse_time[ievent] << endl;
@@ -304,7 +330,7 @@ namespace Decoder {
     }
     else {
 #ifdef WITH_DEBUG
-      if (fDebugFile)
+      if (DEBUG_FILE(fDebugFile))
 	*fDebugFile << "Fadc250Module::GetPulseFineTimeData channel "
 		    << chan << ", event " << ievent << " = "
 		    <<  fPulseData[chan].fine_time[ievent] << endl;
@@ -325,7 +351,7 @@ namespace Decoder {
     }
     else {
 #ifdef WITH_DEBUG
-      if (fDebugFile)
+      if (DEBUG_FILE(fDebugFile))
 	*fDebugFile << "Fadc250Module::GetPulsePeakData channel "
 		    << chan << ", event " << ievent << " = "
 		    <<  fPulseData[chan].peak[ievent] << endl;
@@ -347,7 +373,7 @@ namespace Decoder {
       }
       else {
 #ifdef WITH_DEBUG
-	if (fDebugFile)
+	if (DEBUG_FILE(fDebugFile))
 	  *fDebugFile << "Fadc250Module::GetPulsePedestalData channel "
 		      << chan << ", event " << ievent << " = "
 		      <<  fPulseData[chan].pedestal[ievent] << endl;
@@ -361,7 +387,7 @@ namespace Decoder {
     }
     else {
 #ifdef WITH_DEBUG
-      if (fDebugFile)
+      if (DEBUG_FILE(fDebugFile))
 	*fDebugFile << "Fadc250Module::GetPulsePedestalData channel "
 		    << chan << ", event " << ievent << " = "
 		    <<  fPulseData[chan].pedestal[0] << endl;
@@ -382,7 +408,7 @@ namespace Decoder {
     }
     else {
 #ifdef WITH_DEBUG
-      if (fDebugFile)
+      if (DEBUG_FILE(fDebugFile))
 	*fDebugFile << "Fadc250Module::GetPedestalQuality channel "
 		    << chan << ", event " << ievent << " = "
 		    <<  fPulseData[chan].pedestal_quality[0] << endl;
@@ -403,7 +429,7 @@ namespace Decoder {
     }
     else {
 #ifdef WITH_DEBUG
-      if (fDebugFile)
+      if (DEBUG_FILE(fDebugFile))
 	*fDebugFile << "Fadc250Module::GetOverflowBit channel "
 		    << chan << ", event " << ievent << " = "
 		    <<  fPulseData[chan].overflow[ievent] << endl;
@@ -424,7 +450,7 @@ namespace Decoder {
     }
     else {
 #ifdef WITH_DEBUG
-      if (fDebugFile)
+      if (DEBUG_FILE(fDebugFile))
 	*fDebugFile << "Fadc250Module::GetUnderflowBit channel "
 		    << chan << ", event " << ievent << " = "
 		    <<  fPulseData[chan].underflow[ievent] << endl;
@@ -437,7 +463,7 @@ namespace Decoder {
     // Truncate to 32 bits
     UInt_t shorttime = fadc_data.trig_time;
 #ifdef WITH_DEBUG
-    if (fDebugFile)
+    if (DEBUG_FILE(fDebugFile))
       *fDebugFile << "Fadc250Module::GetTriggerTime = "
       << fadc_data.trig_time << " " << shorttime << endl;
 #endif
@@ -456,7 +482,7 @@ namespace Decoder {
     }
     else {
 #ifdef WITH_DEBUG
-      if (fDebugFile)
+      if (DEBUG_FILE(fDebugFile))
 	*fDebugFile << "Fadc250Module::GetPulseSamplesData channel "
 		    << chan << ", event " << ievent << " = "
 		    <<  fPulseData[chan].samples[ievent] << endl;
@@ -473,17 +499,145 @@ namespace Decoder {
     }
     else {
 #ifdef WITH_DEBUG
-      if (fDebugFile)
+      if (DEBUG_FILE(fDebugFile))
 	*fDebugFile << "Fadc250Module::GetPulseSamplesVector channel "
 		    << chan << " = " <<  &fPulseData[chan].samples << endl;
 #endif
-      return fPulseData[chan].samples;
+      const auto& samples = fPulseData[chan].samples;
+      return vector<uint32_t>(samples.begin(), samples.end());
+    }
+  }
+
+  Bool_t Fadc250Module::GetPulseData( UInt_t chan, UInt_t ievent,
+                                      PulseData_t& pulse ) const {
+    // Get all data of pulse 'ievent' on channel 'chan' at once. The values
+    // are the same as those from the individual Get...Data functions, but
+    // without repeated checks and error messages. Unavailable items are set
+    // to kMaxUInt. Returns false if 'chan' is invalid.
+    if( chan >= NADCCHAN ) {
+      pulse = { kMaxUInt, kMaxUInt, kMaxUInt, kMaxUInt,
+                kMaxUInt, kMaxUInt, kMaxUInt };
+      return false;
     }
+    const auto& d = fPulseData[chan];
+    auto item = [ievent]( const vector<uint32_t>& v ) -> UInt_t {
+      return ievent < v.size() ? v[ievent] : kMaxUInt;
+    };
+    pulse.integral  = item(d.integral);
+    pulse.time      = item(d.time);
+    pulse.peak      = item(d.peak);
+    pulse.overflow  = item(d.overflow);
+    pulse.underflow = item(d.underflow);
+    // Except for firmware version 2, there is one pedestal per channel
+    if( fFirmwareVers == 2 )
+      pulse.pedestal = item(d.pedestal);
+    else
+      pulse.pedestal = (d.pedestal.size() == 1 && ievent < d.integral.size())
+                       ? d.pedestal[0] : kMaxUInt;
+    pulse.pedestal_quality = (d.pedestal_quality.size() == 1)
+                             ? d.pedestal_quality[0] : kMaxUInt;
+    return true;
+  }
+
+  UInt_t Fadc250Module::GetPulseData( UInt_t chan,
+                                      vector<PulseData_t>& pulses ) const {
+    // Get the data of all pulses on channel 'chan'. Returns the number of
+    // pulses.
+    pulses.clear();
+    if( chan >= NADCCHAN )
+      return 0;
+    const auto& d = fPulseData[chan];
+    vsiz_t n = max(d.integral.size(), max(d.time.size(), d.peak.size()));
+    pulses.resize(n);
+    for( vsiz_t i = 0; i < n; ++i )
+      GetPulseData(chan, i, pulses[i]);
+    return n;
+  }
+
+  const vector<uint16_t>& Fadc250Module::GetPulseSamples( UInt_t chan ) const {
+    // Reference to the raw samples of 'chan'. Unlike GetPulseSamplesVector,
+    // this does not copy, so it is suitable for per-event processing.
+    assert(chan < NADCCHAN);
+    return fPulseData[chan].samples;
+  }
+
+  void Fadc250Module::GetEncodedPulseSamples( UInt_t chan, vector<int16_t>& out ) const {
+    // Delta-encode the raw samples of 'chan' into 'out' for compact output.
+    // Decode with FadcWaveform::DeltaDecode.
+    out.clear();
+    if( chan >= NADCCHAN )
+      return;
+    const auto& samples = fPulseData[chan].samples;
+    FadcWaveform::DeltaEncode(samples.data(), samples.size(), out);
+  }
+
+  Int_t Fadc250Module::ProcessPulseSamples( UInt_t chan, UInt_t nped, UInt_t threshold ) {
+    // Emulate the FPGA pulse processing on the raw samples of 'chan':
+    // - pedestal = sum of the first 'nped' samples
+    // - threshold crossing = first sample above pedestal average + 'threshold'
+    // - integral = sum of samples from NSB before to NSA after the crossing,
+    //   with NSB/NSA taken from the block header (whole window if both are 0)
+    // - peak = largest sample in the integration window
+    // Results go into a per-channel buffer and are read back with the
+    // GetEmulated... methods. Returns 0 if a pulse was found, 1 if no
+    // sample crossed the threshold, -1 if there are no samples.
+
+    if( chan >= NADCCHAN )
+      return -1;
+    const vector<uint16_t>& samples = fPulseData[chan].samples;
+    fadc_sample_results& res = fSampleResults[chan];
+    res.clear();
+    size_t n = samples.size();
+    if( n == 0 || nped > n )
+      return -1;
+    const uint16_t* s = samples.data();
+
+    res.pedestal_sum = FadcWaveform::Sum(s, 0, nped);
+    uint32_t pedavg = (nped > 0) ? res.pedestal_sum / nped : 0;
+    size_t tc = FadcWaveform::FirstAbove(s, nped, n, pedavg + threshold);
+    res.valid = true;
+    if( tc == n )
+      return 1;
+    res.crossing = tc;
+
+    size_t first = 0, last = n;
+    if( fadc_data.NSA > 0 || fadc_data.NSB > 0 ) {
+      first = (tc > fadc_data.NSB) ? tc - fadc_data.NSB : 0;
+      last  = std::min(n, tc + fadc_data.NSA);
+    }
+    res.integral = FadcWaveform::Sum(s, first, last);
+    size_t ipeak = last;
+    res.peak = FadcWaveform::Max(s, first, last, ipeak);
+    res.peak_pos = ipeak;
+    return 0;
+  }
+
+  UInt_t Fadc250Module::GetEmulatedPedestalSum( UInt_t chan ) const {
+    return (chan < NADCCHAN && fSampleResults[chan].valid)
+      ? fSampleResults[chan].pedestal_sum : kMaxUInt;
+  }
+
+  UInt_t Fadc250Module::GetEmulatedThresholdCrossing( UInt_t chan ) const {
+    return (chan < NADCCHAN) ? fSampleResults[chan].crossing : kMaxUInt;
+  }
+
+  UInt_t Fadc250Module::GetEmulatedPulseIntegral( UInt_t chan ) const {
+    return (chan < NADCCHAN && fSampleResults[chan].crossing != kMaxUInt)
+      ? fSampleResults[chan].integral : kMaxUInt;
+  }
+
+  UInt_t Fadc250Module::GetEmulatedPulsePeak( UInt_t chan ) const {
+    return (chan < NADCCHAN && fSampleResults[chan].crossing != kMaxUInt)
+      ? fSampleResults[chan].peak : kMaxUInt;
+  }
+
+  UInt_t Fadc250Module::GetEmulatedPulsePeakPosition( UInt_t chan ) const {
+    return (chan < NADCCHAN) ? fSampleResults[chan].peak_pos : kMaxUInt;
   }
 
   void Fadc250Module::PrintDataType() const {
 #ifdef WITH_DEBUG
-    if (!fDebugFile) return;
+    if (!DEBUG_FILE(fDebugFile)) return;
     *fDebugFile << "start,  Print Data Type "<<endl;
     if (data_type_4) *fDebugFile << "data type 4"<<endl;
     if (data_type_6) *fDebugFile << "data type 6"<<endl;
@@ -511,7 +665,7 @@ namespace Decoder {
     else {
       //      PrintDataType();
       cout << "ERROR:: Fadc250Module:: GetFadcMode:: FADC is in invalid mode for slot = " << fSlot << endl;
-      if (fDebugFile) *fDebugFile << "ERROR:: Fadc250Module:: GetFadcMode:: FADC is in invalid mode for slot = " << fSlot << endl;
+      if (DEBUG_FILE(fDebugFile)) *fDebugFile << "ERROR:: Fadc250Module:: GetFadcMode:: FADC is in invalid mode for slot = " << fSlot << endl;
       return -1;
     }
   }
@@ -520,7 +674,7 @@ namespace Decoder {
     assert(chan < NADCCHAN);
     UInt_t sz = 0;
     Int_t mode = GetFadcMode();
-    if (fDebugFile) PrintDataType();
+    if (DEBUG_FILE(fDebugFile)) PrintDataType();
     // For some "old" firmware version
     if( fFirmwareVers == 1 ) {
       if( mode == 7 &&
@@ -558,7 +712,7 @@ namespace Decoder {
        fPulseData[chan].peak.size() == sz)
       ) {
 #ifdef WITH_DEBUG
-      if (fDebugFile)
+      if (DEBUG_FILE(fDebugFile))
 	*fDebugFile << "Fadc250Module::GetNumFadcEvents channel "
 		    << chan << " = " <<  sz << endl;
 #endif
@@ -585,7 +739,7 @@ namespace Decoder {
       }
       else  {
 #ifdef WITH_DEBUG
-	if (fDebugFile)
+	if (DEBUG_FILE(fDebugFile))
 	  *fDebugFile << "Fadc250Module::GetNumFadcSamples channel "
 		      << chan << ", event " << ievent << " = "
 		      <<  fPulseData[chan].samples.size() << endl;
@@ -602,11 +756,10 @@ namespace Decoder {
   UInt_t Fadc250Module::LoadSlot( THaSlotData *sldat, const UInt_t* evbuffer, const UInt_t *pstop) {
     // the 3-arg version of LoadSlot
 
-    std::vector<UInt_t> evb(evbuffer, pstop);
-
     // Note, methods SplitBuffer, GetNextBlock  are defined in PipeliningModule
+    // The events of the block refer directly to the words in evbuffer.
 
-    SplitBuffer(evb);
+    SplitBuffer(evbuffer, pstop);
     return LoadThisBlock(sldat, GetNextBlock());
   }
 
@@ -643,20 +796,21 @@ namespace Decoder {
     return LoadThisBlock(sldat, GetNextBlock());
   }
 
-  UInt_t Fadc250Module::LoadThisBlock( THaSlotData *sldat, const vector<UInt_t>& evb) {
+  UInt_t Fadc250Module::LoadThisBlock( THaSlotData *sldat, const EventBlock_t& evb) {
 
     // Fill data structures of this class using the event buffer of one "event".
     // An "event" is defined in the traditional way -- a scattering from a target, etc.
 
     Clear();
 
-    UInt_t index = 0;
-    for( vsiz_t i = 0; i < evb.size(); i++ )
-      DecodeOneWord(evb[index++]);
+    if( evb.has_header )
+      DecodeOneWord(evb.header);
+    for( UInt_t i = 0; i < evb.len; i++ )
+      DecodeOneWord(evb.data[i]);
 
     LoadTHaSlotDataObj(sldat);
 
-    return index;
+    return evb.size();
   }
 
   UInt_t Fadc250Module::DecodeOneWord( UInt_t pdat)
@@ -666,7 +820,7 @@ namespace Decoder {
       data_type_def = (pdat >> 27) & 0xF;        // Data type defining words, mask 4 bits
     // Debug output
 #ifdef WITH_DEBUG
-    if (fDebugFile)
+    if (DEBUG_FILE(fDebugFile))
       *fDebugFile << "Fadc250Module::Decode:: FADC DATA TYPES >> data = " << hex
                   << pdat << dec << " >> data word id = " << data_type_id
                   << " >> data type = " << data_type_def << endl;
@@ -676,7 +830,7 @@ namespace Decoder {
     // Ensure that slots match and do not decode if they differ
     if (!slots_match && data_type_def != 0) {
 #ifdef WITH_DEBUG
-      if (fDebugFile)
+      if (DEBUG_FILE(fDebugFile))
 	*fDebugFile << "Fadc250Module::Decode:: fSlot & FADC slot do not match AND data type != 0" << endl;
 #endif
       return kMaxUInt;
@@ -691,7 +845,7 @@ namespace Decoder {
 	  fadc_data.slot_blk_hdr = (pdat >> 22) & 0x1F;  // Slot number (set by VME64x backplane), mask 5 bits
 	  // Debug output
 #ifdef WITH_DEBUG
-	  if (fDebugFile)
+	  if (DEBUG_FILE(fDebugFile))
 	    *fDebugFile << "Fadc250Module::Decode:: Slot from FADC block header = " << fadc_data.slot_blk_hdr << endl;
 #endif
 	  // Ensure that slots from cratemap and FADC match
@@ -703,7 +857,7 @@ namespace Decoder {
 	  fadc_data.nblock_events = (pdat >> 0) & 0xFF;  // Number of events in block, mask 8 bits
 	  // Debug output
 #ifdef WITH_DEBUG
-	  if (fDebugFile)
+	  if (DEBUG_FILE(fDebugFile))
 	    *fDebugFile << "Fadc250Module::Decode:: FADC BLOCK HEADER >> data = " << hex
                         << pdat << dec << " >> slot = " << fadc_data.slot_blk_hdr
                         << " >> module id = " << fadc_data.mod_id << " >> event block number = " << fadc_data.iblock_num
@@ -716,7 +870,7 @@ namespace Decoder {
 	  fadc_data.NSA = (pdat >> 0) & 0x1FF;  // Number of samples after threshold crossing to include processing, mask 9 bits
 	  // Debug output
 #ifdef WITH_DEBUG
-	  if (fDebugFile)
+	  if (DEBUG_FILE(fDebugFile))
 	    *fDebugFile << "Fadc250Module::Decode:: FADC BLOCK HEADER >> data = " << hex
                         << pdat << dec << " >> NSB trigger point (PL) = " << fadc_data.PL
                         << " >> NSB threshold crossing = " << fadc_data.NSA
@@ -730,7 +884,7 @@ namespace Decoder {
 	fadc_data.nwords_inblock = (pdat >> 0) & 0x3FFFFF;  // Total number of words in block of events, mask 22 bits
 	// Debug output
 #ifdef WITH_DEBUG
-	if (fDebugFile)
+	if (DEBUG_FILE(fDebugFile))
 	  *fDebugFile << "Fadc250Module::Decode:: FADC BLOCK TRAILER >> data = " << hex
                       << pdat << dec << " >> slot = " << fadc_data.slot_blk_trl
                       << " >> nwords in block = " << fadc_data.nwords_inblock << endl;
@@ -746,13 +900,13 @@ namespace Decoder {
 	fadc_data.trig_num = (pdat >> 0) & 0xFFF;       // Trigger number
 	// Debug output
 	// #ifdef WITH_DEBUG
-	//	if (fDebugFile)
+	//	if (DEBUG_FILE(fDebugFile))
 	//	  *fDebugFile << "Fadc250Module::Decode:: FADC EVENT HEADER >> data = " << hex
 	//		      << data << dec << " >> slot = " << fadc_data.slot_evt_hdr
 	//		      << " >> event number = " << fadc_data.evt_num << endl;
 	// #endif
 #ifdef WITH_DEBUG
-	if (fDebugFile)
+	if (DEBUG_FILE(fDebugFile))
 	  *fDebugFile << "Fadc250Module::Decode:: FADC EVENT HEADER >> data = " << hex
                       << pdat << dec << " >> event header trigger time = " << fadc_data.eh_trig_time
                       << " >> trigger number = " << fadc_data.trig_num << endl;
@@ -767,7 +921,7 @@ namespace Decoder {
 	fadc_data.trig_time = (fadc_data.trig_time_w2 << 24) | fadc_data.trig_time_w1;
 	// Debug output
 #ifdef WITH_DEBUG
-	if (fDebugFile)
+	if (DEBUG_FILE(fDebugFile))
 	  *fDebugFile << "Fadc250Module::Decode:: FADC TRIGGER TIME >> data = " << hex
                       << pdat << dec << " >> trigger time word 1 = " << fadc_data.trig_time_w1
                       << " >> trigger time word 2 = " << fadc_data.trig_time_w2
@@ -779,9 +933,10 @@ namespace Decoder {
 	if (data_type_id == 1) {
 	  fadc_data.chan = (pdat >> 23) & 0xF;        // FADC channel number
 	  fadc_data.win_width = (pdat >> 0) & 0xFFF;  // Window width
+	  fPulseData[fadc_data.chan].samples.reserve(fadc_data.win_width);
 	  // Debug output
 #ifdef WITH_DEBUG
-	  if (fDebugFile)
+	  if (DEBUG_FILE(fDebugFile))
 	    *fDebugFile << "Fadc250Module::Decode:: FADC WINDOW RAW DATA >> data = " << hex
                         << pdat << dec << " >> channel = " << fadc_data.chan
                         << " >> window width  = " << fadc_data.win_width << endl;
@@ -808,7 +963,7 @@ namespace Decoder {
 	  fadc_data.overflow = (sample_2 >> 12) & 0x1;                   // Sample 2 overflow bit
 	  // Debug output
 #ifdef WITH_DEBUG
-	  if (fDebugFile)
+	  if (DEBUG_FILE(fDebugFile))
 	    *fDebugFile << "Fadc250Module::Decode:: FADC WINDOW RAW DATA >> data = " << hex
                         << pdat << dec << " >> channel = " << fadc_data.chan
 			<< " >> sample 1 = " << sample_1
@@ -821,7 +976,7 @@ namespace Decoder {
       case 5:  // Undefined type
 	{
 #ifdef WITH_DEBUG
-	  if (fDebugFile)
+	  if (DEBUG_FILE(fDebugFile))
 	    *fDebugFile << "Fadc250Module::Decode:: UNDEFINED TYPE >> data = " << hex << pdat
                         << dec << " >> data type id = " << data_type_id << endl;
 #endif
@@ -835,7 +990,7 @@ namespace Decoder {
 	  fadc_data.sample_num_tc = (pdat >> 0) & 0x3FF;  // FADC sample number of threshold crossing
 	  // Debug output
 #ifdef WITH_DEBUG
-	  if (fDebugFile)
+	  if (DEBUG_FILE(fDebugFile))
 	    *fDebugFile << "Fadc250Module::Decode:: FADC PULSE RAW DATA >> data = " << hex
                         << pdat << dec << " >> channel = " << fadc_data.chan
                         << " >> window width  = " << fadc_data.win_width << endl;
@@ -862,7 +1017,7 @@ namespace Decoder {
 	  fadc_data.overflow = (sample_2 >> 12) & 0x1;                    // Sample 2 overflow bit
 	  // Debug output
 #ifdef WITH_DEBUG
-	  if (fDebugFile)
+	  if (DEBUG_FILE(fDebugFile))
 	    *fDebugFile << "Fadc250Module::Decode:: FADC PULSE RAW DATA >> data = " << hex
                         << pdat << dec << " >> sample 1 = " << sample_1
                         << " >> sample 2 = " << sample_2
@@ -881,7 +1036,7 @@ namespace Decoder {
 	PopulateDataVector(fPulseData[fadc_data.chan].integral, fadc_data.pulse_integral);
 	// Debug output
 #ifdef WITH_DEBUG
-	if (fDebugFile)
+	if (DEBUG_FILE(fDebugFile))
 	  *fDebugFile << "Fadc250Module::Decode:: FADC PULSE INTEGRAL >> data = " << hex
                       << pdat << dec << " >> chan = " << fadc_data.chan
                       << " >> pulse num = " << fadc_data.pulse_num
@@ -903,7 +1058,7 @@ namespace Decoder {
 	PopulateDataVector(fPulseData[fadc_data.chan].time, fadc_data.time);
 	// Debug output
 #ifdef WITH_DEBUG
-	if (fDebugFile)
+	if (DEBUG_FILE(fDebugFile))
 	  *fDebugFile << "Fadc250Module::Decode:: FADC PULSE TIME >> data = " << hex
                       << pdat << dec << " >> chan = " << fadc_data.chan
                       << " >> pulse num = " << fadc_data.pulse_num
@@ -925,7 +1080,7 @@ namespace Decoder {
 	  PopulateDataVector(fPulseData[fadc_data.chan].pedestal_quality, fadc_data.qual_factor);
 	  // Debug output
 #ifdef WITH_DEBUG
-	  if (fDebugFile)
+	  if (DEBUG_FILE(fDebugFile))
 	    *fDebugFile << "Fadc250Module::Decode:: FADC PULSE PARAMETERS >> data = " << hex
                         << pdat << dec << " >> chan = " << fadc_data.chan
                         << " >> event of block = " << fadc_data.evnt_of_blk
@@ -947,7 +1102,7 @@ namespace Decoder {
 	    PopulateDataVector(fPulseData[fadc_data.chan].underflow, fadc_data.samp_underflow);
 	    // Debug output
 #ifdef WITH_DEBUG
-	    if (fDebugFile)
+	    if (DEBUG_FILE(fDebugFile))
 	      *fDebugFile << "Fadc250Module::Decode:: FADC PULSE PARAMETERS >> data = " << hex
                           << pdat << dec << " >> chan = " << fadc_data.chan
                           << " >> integral = " << fadc_data.sample_sum
@@ -972,7 +1127,7 @@ namespace Decoder {
 	    PopulateDataVector(fPulseData[fadc_data.chan].peak, fadc_data.pulse_peak);
 	    // Debug output
 #ifdef WITH_DEBUG
-	    if (fDebugFile)
+	    if (DEBUG_FILE(fDebugFile))
 	      *fDebugFile << "Fadc250Module::Decode:: FADC PULSE PARAMETERS >> data = " << hex
                           << pdat << dec << " >> chan = " << fadc_data.chan
 			  << " >> coarse time = " << fadc_data.coarse_pulse_time
@@ -997,7 +1152,7 @@ namespace Decoder {
 	PopulateDataVector(fPulseData[fadc_data.chan].peak, fadc_data.pulse_peak);
 	// Debug output
 #ifdef WITH_DEBUG
-	if (fDebugFile)
+	if (DEBUG_FILE(fDebugFile))
 	  *fDebugFile << "Fadc250Module::Decode:: FADC PULSE PEDESTAL >> data = " << hex
                       << pdat << dec << " >> chan = " << fadc_data.chan
                       << " >> pulse num = " << fadc_data.pulse_num
@@ -1009,7 +1164,7 @@ namespace Decoder {
 	{
 	  // Debug output
 #ifdef WITH_DEBUG
-	  if (fDebugFile)
+	  if (DEBUG_FILE(fDebugFile))
 	    *fDebugFile << "Fadc250Module::Decode:: UNDEFINED TYPE >> data = " << hex << pdat
                         << dec << " >> data type id = " << data_type_id << endl;
 #endif
@@ -1020,7 +1175,7 @@ namespace Decoder {
 	  fadc_data.scaler_words = (pdat >> 0) & 0x3F;  // FADC scaler words
 	  // Debug output
 #ifdef WITH_DEBUG
-	  if (fDebugFile)
+	  if (DEBUG_FILE(fDebugFile))
 	    *fDebugFile << "Fadc250Module::Decode:: FADC SCALER HEADER >> data = " << hex
                         << pdat << dec << " >> data words = "
                         << hex << fadc_data.scaler_words << dec << endl;
@@ -1031,7 +1186,7 @@ namespace Decoder {
 	{
 	  // Debug output
 #ifdef WITH_DEBUG
-	  if (fDebugFile)
+	  if (DEBUG_FILE(fDebugFile))
 	    *fDebugFile << "Fadc250Module::Decode:: UNDEFINED TYPE >> data = " << hex << pdat
                         << dec << " >> data type id = " << data_type_id << endl;
 #endif
@@ -1041,7 +1196,7 @@ namespace Decoder {
 	{
 	  // Debug output
 #ifdef WITH_DEBUG
-	  if (fDebugFile)
+	  if (DEBUG_FILE(fDebugFile))
 	    *fDebugFile << "Fadc250Module::Decode:: DATA NOT VALID >> data = " << hex << pdat
                         << dec << " >> data type id = " << data_type_id << endl;
 #endif
@@ -1051,7 +1206,7 @@ namespace Decoder {
 	{
 	  // Debug output
 #ifdef WITH_DEBUG
-	  if (fDebugFile)
+	  if (DEBUG_FILE(fDebugFile))
 	    *fDebugFile << "Fadc250Module::Decode:: FILLER WORD >> data = " << hex << pdat
                         << dec << " >> data type id = " << data_type_id << endl;
 #endif
@@ -1060,7 +1215,7 @@ namespace Decoder {
       }  // data_type_def switch
 
 #ifdef WITH_DEBUG
-    if (fDebugFile)
+    if (DEBUG_FILE(fDebugFile))
       *fDebugFile << "**********************************************************************"
 		  << "\n" << endl;
 #endif
@@ -25,6 +25,7 @@ namespace Decoder {
     using Module::GetData;
 
     virtual void Clear( Option_t *opt="" );
+    virtual size_t GetCapacity() const;
     virtual void Init();
     virtual void CheckDecoderStatus() const;
     virtual UInt_t GetPulseIntegralData( UInt_t chan, UInt_t ievent ) const;
@@ -39,6 +40,25 @@ namespace Decoder {
     virtual UInt_t GetOverflowBit( UInt_t chan, UInt_t ievent ) const;
     virtual UInt_t GetUnderflowBit( UInt_t chan, UInt_t ievent ) const;
     virtual std::vector<uint32_t> GetPulseSamplesVector( UInt_t chan ) const;
+    // All data of one pulse, retrieved with a single call. Items that are
+    // not available are set to kMaxUInt.
+    struct PulseData_t {
+      UInt_t integral, time, peak, pedestal;
+      UInt_t pedestal_quality, overflow, underflow;
+    };
+    Bool_t GetPulseData( UInt_t chan, UInt_t ievent, PulseData_t& pulse ) const;
+    UInt_t GetPulseData( UInt_t chan, std::vector<PulseData_t>& pulses ) const;
+    // Raw samples without copying. Valid until the next event is decoded
+    const std::vector<uint16_t>& GetPulseSamples( UInt_t chan ) const;
+    // Delta-encoded raw samples (see FadcWaveform::DeltaEncode)
+    void   GetEncodedPulseSamples( UInt_t chan, std::vector<int16_t>& out ) const;
+    // Software pulse analysis of raw samples (modes 1, 8 and 10)
+    Int_t  ProcessPulseSamples( UInt_t chan, UInt_t nped, UInt_t threshold );
+    UInt_t GetEmulatedPedestalSum( UInt_t chan ) const;
+    UInt_t GetEmulatedThresholdCrossing( UInt_t chan ) const;
+    UInt_t GetEmulatedPulseIntegral( UInt_t chan ) const;
+    UInt_t GetEmulatedPulsePeak( UInt_t chan ) const;
+    UInt_t GetEmulatedPulsePeakPosition( UInt_t chan ) const;
     virtual Int_t  GetFadcMode() const;
     virtual Int_t  GetMode() const { return GetFadcMode(); };
     virtual UInt_t GetNumFadcEvents( UInt_t chan ) const;
@@ -95,7 +115,8 @@ namespace Decoder {
 
     struct fadc_pulse_data {
       std::vector<uint32_t> integral, time, peak, pedestal;
-      std::vector<uint32_t> samples, coarse_time, fine_time;
+      std::vector<uint16_t> samples;  // Raw samples (13 bits incl. overflow)
+      std::vector<uint32_t> coarse_time, fine_time;
       std::vector<uint32_t> pedestal_quality, overflow, underflow;
       void clear() {
 	integral.clear(); time.clear(); peak.clear(); pedestal.clear();
@@ -105,14 +126,27 @@ namespace Decoder {
     };
     std::vector<fadc_pulse_data> fPulseData; // Pulse data for each channel
 
+    // Results of ProcessPulseSamples, preallocated for each channel
+    struct fadc_sample_results {
+      uint32_t pedestal_sum, crossing, integral, peak, peak_pos;
+      bool valid;
+      void clear() {
+	pedestal_sum = integral = peak = 0;
+	crossing = peak_pos = kMaxUInt;
+	valid = false;
+      }
+    };
+    std::vector<fadc_sample_results> fSampleResults;
+
     Bool_t data_type_4, data_type_6, data_type_7, data_type_8, data_type_9, data_type_10;
     Bool_t block_header_found, block_trailer_found, event_header_found, slots_match;
 
     void ClearDataVectors();
     void PopulateDataVector( std::vector<uint32_t>& data_vector, uint32_t data );
-    static uint32_t SumVectorElements( const std::vector<uint32_t>& data_vector );
+    void PopulateDataVector( std::vector<uint16_t>& data_vector, uint32_t data );
+    static uint32_t SumVectorElements( const std::vector<uint16_t>& data_vector );
     void LoadTHaSlotDataObj( THaSlotData* sldat );
-    UInt_t LoadThisBlock( THaSlotData *sldat, const std::vector<UInt_t>& evb );
+    UInt_t LoadThisBlock( THaSlotData *sldat, const EventBlock_t& evb );
     void PrintDataType() const;
 
     static TypeIter_t fgThisType;
@@ -0,0 +1,109 @@
+#ifndef Podd_FadcWaveform_h_
+#define Podd_FadcWaveform_h_
+
+/////////////////////////////////////////////////////////////////////
+//
+//   Decoder::FadcWaveform
+//
+//   Kernels for processing flash ADC raw samples in software:
+//   sums (pedestal, integral), threshold crossing and peak search,
+//   and delta encoding of waveforms for compact storage.
+//
+//   The loops are written without data-dependent branches in their
+//   inner parts so that the compiler can vectorize them for whatever
+//   instruction set the build targets (SSE/AVX on x86, NEON on ARM).
+//   No intrinsics are used, so the code stays portable.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace Decoder {
+namespace FadcWaveform {
+
+// Number of samples tested per step in FirstAbove
+const size_t kBlock = 16;
+
+//_____________________________________________________________________________
+template< typename T >
+inline uint32_t Sum( const T* s, size_t first, size_t last )
+{
+  // Sum of samples in [first,last)
+  uint32_t sum = 0;
+  for( size_t i = first; i < last; ++i )
+    sum += s[i];
+  return sum;
+}
+
+//_____________________________________________________________________________
+template< typename T >
+inline size_t FirstAbove( const T* s, size_t first, size_t last,
+                          uint32_t thr )
+{
+  // Index of the first sample in [first,last) that is greater than 'thr'.
+  // Returns 'last' if there is none.
+  size_t i = first;
+  for( ; i + kBlock <= last; i += kBlock ) {
+    // Test a whole block at once; only branch once per block
+    uint32_t any = 0;
+    for( size_t j = 0; j < kBlock; ++j )
+      any |= (s[i+j] > thr);
+    if( any )
+      break;
+  }
+  for( ; i < last; ++i ) {
+    if( s[i] > thr )
+      return i;
+  }
+  return last;
+}
+
+//_____________________________________________________________________________
+template< typename T >
+inline uint32_t Max( const T* s, size_t first, size_t last,
+                     size_t& imax )
+{
+  // Largest sample in [first,last) and, in 'imax', the index of its first
+  // occurrence. Returns 0 and imax = last if the range is empty.
+  uint32_t vmax = 0;
+  for( size_t i = first; i < last; ++i )
+    vmax = (s[i] > vmax) ? s[i] : vmax;
+  imax = (vmax > 0) ? FirstAbove(s, first, last, vmax-1) : first;
+  if( first >= last )
+    imax = last;
+  return vmax;
+}
+
+//_____________________________________________________________________________
+inline void DeltaEncode( const uint16_t* s, size_t n, std::vector<int16_t>& out )
+{
+  // Store the first of the 'n' samples 's' and then the differences between
+  // successive samples. FADC samples have 13 bits, so the differences always
+  // fit. Waveforms are mostly flat, so the result compresses much better
+  // than the samples themselves, e.g. in ROOT output files.
+  out.resize(n);
+  uint16_t prev = 0;
+  for( size_t i = 0; i < n; ++i ) {
+    out[i] = static_cast<int16_t>(s[i] - prev);
+    prev = s[i];
+  }
+}
+
+//_____________________________________________________________________________
+inline void DeltaDecode( const int16_t* d, size_t n, std::vector<uint16_t>& out )
+{
+  // Inverse of DeltaEncode
+  out.resize(n);
+  uint16_t val = 0;
+  for( size_t i = 0; i < n; ++i ) {
+    val = static_cast<uint16_t>(val + d[i]);
+    out[i] = val;
+  }
+}
+
+} // namespace FadcWaveform
+} // namespace Decoder
+
+#endif
@@ -35,6 +35,16 @@ Int_t FastbusModule::Decode(const UInt_t *evbuffer) {
   return 1;
 }
 
+Bool_t FastbusModule::GetHeaderPattern( UInt_t& header, UInt_t& mask ) const {
+  // IsSlot tests the slot number in the upper bits of each data word
+  header = mask = 0;
+  if( fSlotShift == 0 || fSlotShift >= 32 || (fSlot >> (32-fSlotShift)) != 0 )
+    return false;
+  mask = ~0U << fSlotShift;
+  header = fSlot << fSlotShift;
+  return true;
+}
+
 void FastbusModule::SetSlot( UInt_t crate, UInt_t slot, UInt_t header,
                              UInt_t mask, Int_t modelnum )
 {
@@ -54,7 +64,7 @@ UInt_t FastbusModule::LoadSlot( THaSlotData* sldat, const UInt_t* evbuffer,
   fWordsSeen = 0;
   fHeader=0;
   const UInt_t *p = evbuffer;
-  if (fDebugFile) {
+  if (DEBUG_FILE(fDebugFile)) {
      *fDebugFile << "FastbusModule:: loadslot "<<endl;
      if (fHasHeader) {
          *fDebugFile << "TFB:: Has header "<<endl;
@@ -66,10 +76,10 @@ UInt_t FastbusModule::LoadSlot( THaSlotData* sldat, const UInt_t* evbuffer,
   while (IsSlot( *p )) {
     if (fHasHeader && fWordsSeen==0) {
       fHeader = *p;
-      if (fDebugFile) *fDebugFile << "FastbusModule:: header "<<hex<<fHeader<<dec<<endl;
+      if (DEBUG_FILE(fDebugFile)) *fDebugFile << "FastbusModule:: header "<<hex<<fHeader<<dec<<endl;
     } else {
       Decode(p);
-      if (fDebugFile) *fDebugFile << "FastbusModule:: chan "<<dec<<fChan<<"  data "<<fData<<"   raw "<<hex<<*p<<dec<<endl;
+      if (DEBUG_FILE(fDebugFile)) *fDebugFile << "FastbusModule:: chan "<<dec<<fChan<<"  data "<<fData<<"   raw "<<hex<<*p<<dec<<endl;
       sldat->loadData(fChan, fData, fRawData);
     }
     fWordsSeen++;
@@ -78,9 +88,9 @@ UInt_t FastbusModule::LoadSlot( THaSlotData* sldat, const UInt_t* evbuffer,
   }
   if (fHeader) {
     UInt_t fWordsExpect = (fHeader&fWdcntMask);
-    if (fDebugFile) *fDebugFile << "FastbusModule:: words expected  "<<dec<<fWordsExpect<<endl;
+    if (DEBUG_FILE(fDebugFile)) *fDebugFile << "FastbusModule:: words expected  "<<dec<<fWordsExpect<<endl;
     if (fWordsExpect != fWordsSeen) {
-      if (fDebugFile) *fDebugFile << "ERROR:  FastbusModule:  crate "<<fCrate<<"   slot "<<fSlot<<" number of words expected "<<fWordsExpect<<"  not equal num words seen "<<fWordsSeen<<endl;
+      if (DEBUG_FILE(fDebugFile)) *fDebugFile << "ERROR:  FastbusModule:  crate "<<fCrate<<"   slot "<<fSlot<<" number of words expected "<<fWordsExpect<<"  not equal num words seen "<<fWordsSeen<<endl;
 // This happens a lot for some modules, and appears to be harmless, so I suppress it.
 //      cerr << "ERROR:  FastbusModule:   number of words expected "<<fWordsExpect<<"  not equal num words seen "<<fWordsSeen<<endl;
     }
@@ -90,7 +100,7 @@ UInt_t FastbusModule::LoadSlot( THaSlotData* sldat, const UInt_t* evbuffer,
 
 void FastbusModule::DoPrint() const {
 
-  if (fDebugFile) {
+  if (DEBUG_FILE(fDebugFile)) {
        *fDebugFile << "FastbusModule   DoPrint.   name = "<<fName<<
            "  Crate  "<<fCrate<<"     slot "<<fSlot<<endl;
        *fDebugFile << "FastbusModule   model num  "<<fModelNum;
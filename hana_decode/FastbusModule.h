@@ -10,6 +10,7 @@
 /////////////////////////////////////////////////////////////////////
 
 #include "Module.h"
+#include "THaSlotData.h"
 
 namespace Decoder {
 
@@ -29,6 +30,7 @@ public:
 
    virtual Int_t  Decode(const UInt_t *evbuffer);
    virtual Bool_t IsSlot(UInt_t rdata) { return (Slot(rdata)==fSlot); };
+   virtual Bool_t GetHeaderPattern( UInt_t& header, UInt_t& mask ) const;
    virtual UInt_t LoadSlot( THaSlotData *sldat, const UInt_t* evbuffer, const UInt_t *pstop);
    void DoPrint() const;
 
@@ -42,6 +44,22 @@ public:
   virtual void SetSlot( UInt_t crate, UInt_t slot, UInt_t header = 0,
                         UInt_t mask = 0, Int_t modelnum = 0 );
 
+   // Data word layout known at compile time. Standard modules that are
+   // fully described by their masks define one of these and decode with
+   // LoadSlotFixed, avoiding virtual calls and run-time masks per word.
+   template< UInt_t CHANMASK, UInt_t CHANSHIFT, UInt_t DATAMASK,
+             UInt_t OPTMASK, UInt_t OPTSHIFT, UInt_t WDCNTMASK,
+             bool HASHEADER >
+   struct Layout {
+     static constexpr UInt_t chanmask  = CHANMASK;
+     static constexpr UInt_t chanshift = CHANSHIFT;
+     static constexpr UInt_t datamask  = DATAMASK;
+     static constexpr UInt_t optmask   = OPTMASK;
+     static constexpr UInt_t optshift  = OPTSHIFT;
+     static constexpr UInt_t wdcntmask = WDCNTMASK;
+     static constexpr bool   hasheader = HASHEADER;
+   };
+
 protected:
 
    Bool_t fHasHeader;
@@ -53,6 +71,11 @@ protected:
 
    virtual void Init();
 
+   template<typename L> void   SetLayout();
+   template<typename L> UInt_t LoadSlotFixed( THaSlotData* sldat,
+                                              const UInt_t* evbuffer,
+                                              const UInt_t* pstop );
+
 private:
 
    static TypeIter_t fgThisType;
@@ -61,6 +84,56 @@ private:
 
 };
 
+//_____________________________________________________________________________
+template<typename L>
+inline void FastbusModule::SetLayout()
+{
+  // Set the run-time masks from layout L, so that the generic methods
+  // (Decode, GetOpt, debug printout) agree with LoadSlotFixed<L>
+  fChanMask  = L::chanmask;
+  fChanShift = L::chanshift;
+  fDataMask  = L::datamask;
+  fOptMask   = L::optmask;
+  fOptShift  = L::optshift;
+  fWdcntMask = L::wdcntmask;
+  fHasHeader = L::hasheader;
+}
+
+//_____________________________________________________________________________
+template<typename L>
+inline UInt_t FastbusModule::LoadSlotFixed( THaSlotData* sldat,
+                                            const UInt_t* evbuffer,
+                                            const UInt_t* pstop )
+{
+  // Same as FastbusModule::LoadSlot, but with the word layout fixed at
+  // compile time. No debug output; callers use LoadSlot when debugging.
+  // As in LoadSlot, the caller has verified that *evbuffer is in this slot.
+  // The extent of the slot's block is found first, and its data words are
+  // then stored with a single THaSlotData::loadBlock call.
+
+  const UInt_t shift = fSlotShift, slot = fSlot;
+  const UInt_t* p = evbuffer;
+  fHeader = 0;
+  if( L::hasheader )
+    fHeader = *p++;
+  const UInt_t* first = p;
+  while( p <= pstop && (*p >> shift) == slot )
+    ++p;
+  UInt_t ndata = p - first;
+  fWordsSeen = ndata + (L::hasheader ? 1 : 0);
+  sldat->loadBlock(first, ndata, L::chanmask, L::chanshift, L::datamask);
+  if( ndata > 0 ) {
+    // Leave the last data word decoded, like Decode would
+    fRawData = p[-1];
+    fChan = (fRawData & L::chanmask) >> L::chanshift;
+    fData = fRawData & L::datamask;
+  }
+  // Word count check, once per block. A mismatch is common for some
+  // modules and harmless, so, as in LoadSlot, it is not reported.
+  fWordsExpect = L::hasheader ? (fHeader & L::wdcntmask) : fWordsSeen;
+  return fWordsSeen;
+}
+
 }
 
 #endif
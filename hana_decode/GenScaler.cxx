@@ -8,6 +8,7 @@
 #include "GenScaler.h"
 #include "THaEvData.h"
 #include "TMath.h"
+#include <algorithm>
 #include <iostream>
 #include <string>
 
@@ -45,12 +46,10 @@ namespace Decoder {
     fNumChanMask = 0xff;
     fNumChanShift = 0;
     fDeltaT = DEFAULT_DELTAT;  // a default time interval between readings
-    fDataArray.resize(fWordsExpect);
-    fPrevData.resize(fWordsExpect);
-    fRate.resize(fWordsExpect);
-    fDataArray.assign(fDataArray.size(), 0);
-    fPrevData.assign(fPrevData.size(), 0);
-    fRate.assign(fRate.size(), 0.0);
+    fDataArray.assign(fWordsExpect, 0);
+    fPrevData.assign(fWordsExpect, 0);
+    fDelta.assign(fWordsExpect, 0);
+    fRate.assign(fWordsExpect, 0.0);
   }
 
   void GenScaler::SetBank(Int_t bank) {
@@ -116,19 +115,27 @@ namespace Decoder {
     Int_t doload=0;
     Int_t nfound=1;
     if (IsDecoded()) return nfound;
+    if (fDataArray.size() != fWordsExpect) {
+      fDataArray.resize(fWordsExpect);
+      fPrevData.resize(fWordsExpect);
+      fDelta.resize(fWordsExpect);
+      fRate.resize(fWordsExpect);
+    }
+    if ( !IsSlot(*evbuffer) ) return nfound;
     if (fFirstTime) {
       fFirstTime = false;
     } else {
       doload=1;
-      fPrevData = fDataArray;
+      fPrevData.swap(fDataArray);
     }
-    if ( !IsSlot(*evbuffer) ) return nfound;
-    if (fDebugFile) *fDebugFile << "is slot 0x"<<hex<<*evbuffer<<dec<<" num chan "<<fNumChan<<endl;
+    if (DEBUG_FILE(fDebugFile)) *fDebugFile << "is slot 0x"<<hex<<*evbuffer<<dec<<" num chan "<<fNumChan<<endl;
     evbuffer++;
     fIsDecoded = true;
-    fDataArray.assign( evbuffer, evbuffer+fNumChan );
+    // All arrays keep fWordsExpect channels. Channels not read out are zero.
+    std::copy( evbuffer, evbuffer+fNumChan, fDataArray.begin() );
+    std::fill( fDataArray.begin()+fNumChan, fDataArray.end(), 0 );
     nfound += fNumChan;
-    if (fDebugFile) {
+    if (DEBUG_FILE(fDebugFile)) {
       for( UInt_t i = 0; i < fNumChan; i++ )
         *fDebugFile << "   data[" << i << "] = 0x" << hex << fDataArray[i] << dec << endl;
     }
@@ -144,22 +151,16 @@ namespace Decoder {
 
     if (fNormScaler) return fNormScaler->GetTimeSincePrev();
     Double_t dtime = 0;
-    if (fDebugFile) {
+    if (DEBUG_FILE(fDebugFile)) {
       *fDebugFile << "Into GetTimeSincePrev "<<endl;
       if (IsDecoded()) *fDebugFile << "Is Decoded "<<endl;
       if (fHasClock) *fDebugFile << "has Clock "<<endl;
     }
     if (IsDecoded() && fHasClock && fClockRate>0 && checkchan(fClockChan)) {
-      // Check for scaler overflow
-      UInt_t clockdif;
-      if(fDataArray[fClockChan] < fPrevData[fClockChan]) {
-	clockdif = (kMaxUInt-(fPrevData[fClockChan]-1))
-	  + fDataArray[fClockChan];
-      } else {
-	clockdif = fDataArray[fClockChan]-fPrevData[fClockChan];
-      }
+      // Unsigned subtraction takes care of scaler overflow
+      UInt_t clockdif = fDataArray[fClockChan] - fPrevData[fClockChan];
       dtime = clockdif/fClockRate;
-      if (fDebugFile) *fDebugFile << "GetTimeSincePrev  "<<fClockRate<<"   "<<fClockChan<<"   "<<dtime<<endl;
+      if (DEBUG_FILE(fDebugFile)) *fDebugFile << "GetTimeSincePrev  "<<fClockRate<<"   "<<fClockChan<<"   "<<dtime<<endl;
     } else {
       if (fDeltaT > 0) dtime = fDeltaT;   // default
     }
@@ -167,23 +168,25 @@ namespace Decoder {
   }
 
   void GenScaler::LoadRates() {
-    if (IsDecoded()) {
-      Double_t dtime = GetTimeSincePrev();
-      if (dtime==0) {
-	fRate.assign(fRate.size(), 0);
-	return;
-      }
-      for( UInt_t i = 0; i < fWordsExpect; i++ ) {
-	// Check for scaler overflow
-	UInt_t diff;
-	if(fDataArray[i] < fPrevData[i]) {
-	  diff = (kMaxUInt-(fPrevData[i]-1)) + fDataArray[i];
-	} else {
-	  diff = fDataArray[i]-fPrevData[i];
-	}
-	fRate[i] = diff/dtime;
-      }
+    // Counts since the previous reading and rates of all channels.
+    // Unsigned subtraction takes care of scaler overflow, so the loops
+    // have no branches and can be vectorized by the compiler.
+    if (!IsDecoded()) return;
+    const UInt_t n = fWordsExpect;
+    const UInt_t* cur = fDataArray.data();
+    const UInt_t* prev = fPrevData.data();
+    UInt_t* delta = fDelta.data();
+    for( UInt_t i = 0; i < n; i++ )
+      delta[i] = cur[i] - prev[i];
+    Double_t dtime = GetTimeSincePrev();
+    if (dtime==0) {
+      fRate.assign(fRate.size(), 0);
+      return;
     }
+    const Double_t norm = 1.0/dtime;
+    Double_t* rate = fRate.data();
+    for( UInt_t i = 0; i < n; i++ )
+      rate[i] = norm*delta[i];
   }
 
   UInt_t GenScaler::GetData( UInt_t chan) const {
@@ -269,7 +272,7 @@ UInt_t GenScaler::LoadSlot( THaSlotData* sldat, const UInt_t* evbuffer, const UI
     Clear();
     while( p < pstop ) {
       if( IsSlot(*p) ) {
-	if (fDebugFile) *fDebugFile << "GenScaler:: Loadslot "<<endl;
+	if (DEBUG_FILE(fDebugFile)) *fDebugFile << "GenScaler:: Loadslot "<<endl;
 	if (!fHeader) cerr << "GenScaler::LoadSlot::ERROR : no header ?"<<endl;
 	Decode(p);
         for( UInt_t ichan = 0; ichan < fNumChan; ichan++ ) {
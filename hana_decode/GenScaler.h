@@ -38,6 +38,10 @@ namespace Decoder {
     Double_t GetTimeSincePrev() const;  // returns deltaT since last reading
     Bool_t   IsDecoded() const { return fIsDecoded; };
     void LoadNormScaler(GenScaler *scal);  // loads pointer to norm. scaler
+    // Results of the last reading for all channels, as contiguous arrays
+    const std::vector<UInt_t>&   GetCounts() const { return fDataArray; }
+    const std::vector<UInt_t>&   GetDeltas() const { return fDelta; }
+    const std::vector<Double_t>& GetRates()  const { return fRate; }
     void DebugPrint(std::ofstream *file=nullptr) const;
 
     // Loads sldat
@@ -55,6 +59,7 @@ namespace Decoder {
     Bool_t fIsDecoded, fFirstTime;
     Double_t fDeltaT;
     std::vector<UInt_t> fDataArray, fPrevData;
+    std::vector<UInt_t> fDelta;  // Counts since previous reading
     std::vector<Double_t> fRate;
     UInt_t fClockChan, fNumChanMask, fNumChanShift;
     Bool_t fHasClock;
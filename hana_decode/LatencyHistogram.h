@@ -0,0 +1,86 @@
+#ifndef Podd_LatencyHistogram_h_
+#define Podd_LatencyHistogram_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::LatencyHistogram
+//
+// Log-linear histogram of durations for latency percentiles
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <vector>
+#include <iosfwd>
+
+namespace Podd {
+
+class LatencyHistogram {
+
+public:
+  LatencyHistogram();
+
+  void      Record( ULong64_t ns );
+  void      Add( const LatencyHistogram& rhs );
+  void      Clear();
+
+  ULong64_t GetCount() const { return fCount; }
+  ULong64_t GetMin()   const { return fCount ? fMin : 0; }
+  ULong64_t GetMax()   const { return fMax; }
+  Double_t  GetMean()  const;
+  ULong64_t GetPercentile( Double_t pct ) const;
+
+  void      Print( std::ostream& os ) const;
+
+  // Values below 2^kSubBits ns are recorded exactly, larger ones with a
+  // relative resolution of 2^(1-kSubBits), i.e. better than 1.6%
+  static const UInt_t kSubBits = 7;
+  static const UInt_t kNsub    = 1U << kSubBits;
+
+private:
+  std::vector<ULong64_t> fBins;   // Counts, grown on demand
+  ULong64_t fCount;   // Number of recorded values
+  ULong64_t fMin;     // Smallest recorded value (ns)
+  ULong64_t fMax;     // Largest recorded value (ns)
+  Double_t  fSum;     // Sum of recorded values (ns)
+
+  static UInt_t    Bin( ULong64_t ns );
+  static ULong64_t BinHigh( UInt_t bin );
+};
+
+//___________________________________________________________________________
+inline UInt_t LatencyHistogram::Bin( ULong64_t ns )
+{
+  // Index of the bin containing 'ns'. Bins 0..kNsub-1 hold the values
+  // 0..kNsub-1. Above that, each power of two is split into kNsub/2 bins.
+
+  if( ns < kNsub )
+    return static_cast<UInt_t>(ns);
+  UInt_t msb = 0;
+#if __clang__ || __GNUC__ > 4
+  msb = 63 - __builtin_clzll(ns);
+#else
+  for( ULong64_t v = ns; v >>= 1; )
+    ++msb;
+#endif
+  UInt_t shift = msb - kSubBits + 1;
+  return kNsub + (shift-1) * (kNsub/2) +
+    static_cast<UInt_t>((ns >> shift) - kNsub/2);
+}
+
+//___________________________________________________________________________
+inline void LatencyHistogram::Record( ULong64_t ns )
+{
+  UInt_t bin = Bin(ns);
+  if( bin >= fBins.size() )
+    fBins.resize(bin+1);
+  ++fBins[bin];
+  if( ns < fMin ) fMin = ns;
+  if( ns > fMax ) fMax = ns;
+  fSum += ns;
+  ++fCount;
+}
+
+} // namespace Podd
+
+#endif
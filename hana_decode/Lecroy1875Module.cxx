@@ -22,17 +22,20 @@ Lecroy1875Module::Lecroy1875Module( UInt_t crate, UInt_t slot )
 void Lecroy1875Module::Init()
 {
   FastbusModule::Init();
-  fChanMask = 0x7f0000;
-  fDataMask = 0xfff;
-  fWdcntMask = 0;
-  fOptMask = 0x800000;
-  fChanShift = 16;
-  fOptShift = 23;
-  fHasHeader = false;
+  SetLayout<Layout_t>();
   fHeader = 0;
   fModelNum = 1875;
 }
 
+UInt_t Lecroy1875Module::LoadSlot( THaSlotData* sldat, const UInt_t* evbuffer,
+                                   const UInt_t* pstop )
+{
+  // Decode with the word layout of this model fixed at compile time
+  if( DEBUG_FILE(fDebugFile) )
+    return FastbusModule::LoadSlot(sldat, evbuffer, pstop);
+  return LoadSlotFixed<Layout_t>(sldat, evbuffer, pstop);
+}
+
 
 }
 
@@ -20,10 +20,16 @@ public:
    Lecroy1875Module( UInt_t crate, UInt_t slot );
    Lecroy1875Module() = default;
    virtual ~Lecroy1875Module() = default;
-   virtual void Init();
+   using FastbusModule::LoadSlot;
+
+   virtual void   Init();
+   virtual UInt_t LoadSlot( THaSlotData* sldat, const UInt_t* evbuffer,
+                            const UInt_t* pstop );
 
 private:
 
+   typedef Layout<0x7f0000,16,0xfff,0x800000,23,0,false> Layout_t;
+
    static TypeIter_t fgThisType;
 
    ClassDef(Lecroy1875Module,0)  // Lecroy 1875 TDC module
@@ -22,17 +22,20 @@ Lecroy1877Module::Lecroy1877Module( UInt_t crate, UInt_t slot )
 void Lecroy1877Module::Init()
 {
   FastbusModule::Init();
-  fChanMask = 0xfe0000;
-  fDataMask = 0xffff;
-  fWdcntMask = 0x7ff;
-  fOptMask = 0x10000;
-  fChanShift = 17;
-  fOptShift = 16;
-  fHasHeader = true;
+  SetLayout<Layout_t>();
   fHeader = 0;
   fModelNum = 1877;
 }
 
+UInt_t Lecroy1877Module::LoadSlot( THaSlotData* sldat, const UInt_t* evbuffer,
+                                   const UInt_t* pstop )
+{
+  // Decode with the word layout of this model fixed at compile time
+  if( DEBUG_FILE(fDebugFile) )
+    return FastbusModule::LoadSlot(sldat, evbuffer, pstop);
+  return LoadSlotFixed<Layout_t>(sldat, evbuffer, pstop);
+}
+
 }
 
 ClassImp(Decoder::Lecroy1877Module)
@@ -20,10 +20,16 @@ public:
    Lecroy1877Module( UInt_t crate, UInt_t slot );
    Lecroy1877Module() = default;
    virtual ~Lecroy1877Module() = default;
-   virtual void Init();
+   using FastbusModule::LoadSlot;
+
+   virtual void   Init();
+   virtual UInt_t LoadSlot( THaSlotData* sldat, const UInt_t* evbuffer,
+                            const UInt_t* pstop );
 
 private:
 
+   typedef Layout<0xfe0000,17,0xffff,0x10000,16,0x7ff,true> Layout_t;
+
    static TypeIter_t fgThisType;
 
    ClassDef(Lecroy1877Module,0)  // Lecroy 1877 TDC module
@@ -22,17 +22,20 @@ Lecroy1881Module::Lecroy1881Module( UInt_t crate, UInt_t slot )
 void Lecroy1881Module::Init()
 {
   FastbusModule::Init();
-  fChanMask = 0x7e0000;
-  fDataMask = 0x3fff;
-  fWdcntMask = 0x7f;
-  fOptMask = 0x3000000;
-  fChanShift = 17;
-  fOptShift = 24;
-  fHasHeader = true;
+  SetLayout<Layout_t>();
   fHeader = 0;
   fModelNum = 1881;
 }
 
+UInt_t Lecroy1881Module::LoadSlot( THaSlotData* sldat, const UInt_t* evbuffer,
+                                   const UInt_t* pstop )
+{
+  // Decode with the word layout of this model fixed at compile time
+  if( DEBUG_FILE(fDebugFile) )
+    return FastbusModule::LoadSlot(sldat, evbuffer, pstop);
+  return LoadSlotFixed<Layout_t>(sldat, evbuffer, pstop);
+}
+
 }
 
 ClassImp(Decoder::Lecroy1881Module)
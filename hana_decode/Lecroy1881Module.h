@@ -20,10 +20,16 @@ public:
    Lecroy1881Module( UInt_t crate, UInt_t slot );
    Lecroy1881Module() = default;
    virtual ~Lecroy1881Module() = default;
-   virtual void Init();
+   using FastbusModule::LoadSlot;
+
+   virtual void   Init();
+   virtual UInt_t LoadSlot( THaSlotData* sldat, const UInt_t* evbuffer,
+                            const UInt_t* pstop );
 
 private:
 
+   typedef Layout<0x7e0000,17,0x3fff,0x3000000,24,0x7f,true> Layout_t;
+
    static TypeIter_t fgThisType;
 
    ClassDef(Lecroy1881Module,0)  // Lecroy 1881 ADC module
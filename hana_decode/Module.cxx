@@ -155,7 +155,7 @@ Bool_t Module::IsSlot(UInt_t rdata) {
 
 //_____________________________________________________________________________
 void Module::DoPrint() const {
-  if (fDebugFile) {
+  if (DEBUG_FILE(fDebugFile)) {
     *fDebugFile << "Module   name = "<<fName<<endl;
     *fDebugFile << "Module::    Crate  "<<fCrate<<"     slot "<<fSlot<<endl;
     *fDebugFile << "Module::    fWdcntMask "<<hex<<fWdcntMask<<dec<<endl;
@@ -207,13 +207,13 @@ UInt_t Module::LoadSlot( THaSlotData *sldat, const UInt_t* evbuffer,
   // Load slot from pos to pos+len
 
   // Basic example of how this could be done
-  // if (fDebugFile) {
+  // if (DEBUG_FILE(fDebugFile)) {
   //      *fDebugFile << "Module:: Loadslot "<<endl;
   //      *fDebugFile << "pos"<<dec<<pos<<"   len "<<len<<endl;
   // }
   // fWordsSeen=0;
   // while ( fWordsSeen<len ) {
-  //   if (fDebugFile) *fDebugFile <<endl;
+  //   if (DEBUG_FILE(fDebugFile)) *fDebugFile <<endl;
   //   for (size_t ichan = 0, nchan = GetNumChan(); ichan < nchan; ichan++) {
   //     Int_t mdata,rdata;
   //     rdata = evbuffer[pos+fWordsSeen];
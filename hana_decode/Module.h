@@ -66,6 +66,8 @@ namespace Decoder {
     virtual UInt_t LoadSlot( THaSlotData* sldat, const UInt_t *evbuffer,
                              UInt_t pos, UInt_t len);
     virtual UInt_t LoadNextEvBuffer( THaSlotData* /* sldat */) { return 0; };
+    // Make the next LoadNextEvBuffer load event 'ievent' of the block
+    virtual Bool_t SetBlockIndex( UInt_t /* ievent */ ) { return false; };
 
     virtual UInt_t GetNumChan()         const { return fNumChan; };
 
@@ -93,8 +95,26 @@ namespace Decoder {
 
     virtual void   Clear( Option_t* = "" ) { fWordsSeen = 0; };
 
+    // Memory reserved for per-event data (bytes). Buffers are cleared, but
+    // not released, between events, so this stops changing once the
+    // largest events have been seen. From then on, decoding does not
+    // allocate from the heap.
+    virtual size_t GetCapacity() const {
+      return fData.capacity() * sizeof(UInt_t);
+    }
+
     virtual Bool_t IsSlot( UInt_t rdata );
 
+    // Bit pattern that IsSlot requires, i.e. IsSlot(rdata) can only be true
+    // if (rdata & mask) == header. The decoder uses this to look up slots
+    // by header. Returns false if there is no such pattern, in which case
+    // IsSlot is tried for every word. Classes that override IsSlot must
+    // keep this consistent.
+    virtual Bool_t GetHeaderPattern( UInt_t& header, UInt_t& mask ) const {
+      header = fHeader; mask = fHeaderMask;
+      return mask != 0;
+    }
+
     virtual UInt_t GetCrate() const { return fCrate; };
     virtual UInt_t GetSlot()  const { return fSlot; };
 
@@ -142,6 +162,16 @@ namespace Decoder {
     static void ParseConfigStr( const char* configstr,
                                 const std::vector<ConfigStrReq>& req );
 
+    // Time 'raw' relative to reference time 'ref', plus 'offset', wrapped
+    // into the range [0,rollover) of a counter that rolls over at 'rollover'
+    static UInt_t ReferencedTime( UInt_t raw, UInt_t ref, UInt_t offset,
+                                  UInt_t rollover ) {
+      Long64_t t = (static_cast<Long64_t>(raw) + offset - ref) % rollover;
+      if( t < 0 )
+        t += rollover;
+      return static_cast<UInt_t>(t);
+    }
+
   private:
 
     ClassDef(Module,0)  // A module in a crate and slot
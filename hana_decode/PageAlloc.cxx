@@ -0,0 +1,154 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::PageAlloc
+//
+// Allocation of large, long-lived buffers such as the raw event buffer
+// (EvtBuffer) and the per-slot arrays of THaSlotData, with a run-time
+// selectable policy. These buffers are accessed in every event, so the
+// TLB misses and page faults they cause are paid continuously at high
+// event rates:
+//
+//  kHuge:     Align the buffer to a huge page boundary and ask the kernel
+//             to back it with transparent huge pages (madvise
+//             MADV_HUGEPAGE). Needs /sys/kernel/mm/transparent_hugepage
+//             /enabled set to "always" or "madvise"; ignored elsewhere.
+//  kPrefault: Write to every page when the buffer is allocated, so that
+//             page faults occur during initialization rather than in
+//             the event loop.
+//
+// By default (kDefault), buffers are page-aligned but otherwise left to
+// the system. The mode applies to buffers allocated after SetMode(), so
+// it should be set before the analysis is initialized. Allocate() is
+// used via Decoder::page_allocator for buffers of at least kMinSize
+// bytes; smaller ones come from operator new as usual.
+//
+// The effect can be measured with the replay benchmark (replaybench -P),
+// which reports the page faults incurred by the replay.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "PageAlloc.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <new>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+namespace Podd {
+
+static atomic<UInt_t> gPageMode(PageAlloc::kDefault);
+
+static constexpr size_t kHugePageSize = 2*1024*1024;
+
+//_____________________________________________________________________________
+static size_t PageSize()
+{
+  static const size_t pgsiz = [] {
+    long sz = sysconf(_SC_PAGESIZE);
+    return sz > 0 ? static_cast<size_t>(sz) : size_t(4096);
+  }();
+  return pgsiz;
+}
+
+//_____________________________________________________________________________
+void PageAlloc::SetMode( UInt_t mode )
+{
+  // Set the allocation policy for buffers allocated from now on
+  // (bit pattern of EMode values)
+
+  gPageMode = mode & (kHuge | kPrefault);
+}
+
+//_____________________________________________________________________________
+UInt_t PageAlloc::GetMode()
+{
+  return gPageMode;
+}
+
+//_____________________________________________________________________________
+Bool_t PageAlloc::IsHugeAvailable()
+{
+  // Transparent huge pages can be requested on this platform
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  return true;
+#else
+  return false;
+#endif
+}
+
+//_____________________________________________________________________________
+Int_t PageAlloc::ParseMode( const char* str )
+{
+  // Parse a comma-separated list of "huge" and "prefault", or "off"
+
+  if( !str )
+    return -1;
+  Int_t mode = kDefault;
+  string s(str);
+  string::size_type pos = 0;
+  while( pos <= s.size() ) {
+    auto end = s.find(',', pos);
+    if( end == string::npos )
+      end = s.size();
+    string item = s.substr(pos, end-pos);
+    if( item == "huge" )
+      mode |= kHuge;
+    else if( item == "prefault" )
+      mode |= kPrefault;
+    else if( item != "off" && item != "default" && !item.empty() )
+      return -1;
+    pos = end+1;
+  }
+  return mode;
+}
+
+//_____________________________________________________________________________
+void* PageAlloc::Allocate( size_t bytes )
+{
+  // Allocate a page-aligned buffer of 'bytes' bytes according to the
+  // current mode. Throws std::bad_alloc on failure.
+
+  UInt_t mode = gPageMode;
+  bool huge = (mode & kHuge) != 0 && IsHugeAvailable() &&
+              bytes >= kHugePageSize;
+  size_t align = huge ? kHugePageSize : PageSize();
+  void* ptr = nullptr;
+  if( bytes == 0 )
+    bytes = 1;
+  if( posix_memalign(&ptr, align, bytes) != 0 || !ptr )
+    throw bad_alloc();
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if( huge ) {
+    // Failure only means ordinary pages
+    size_t len = bytes & ~(kHugePageSize-1);
+    madvise(ptr, len, MADV_HUGEPAGE);
+  }
+#endif
+  if( (mode & kPrefault) != 0 ) {
+    // One write per page faults it in. The contents are left unspecified,
+    // as with operator new.
+    auto* p = static_cast<volatile char*>(ptr);
+    size_t step = PageSize();
+    for( size_t i = 0; i < bytes; i += step )
+      p[i] = 0;
+  }
+  return ptr;
+}
+
+//_____________________________________________________________________________
+void PageAlloc::Deallocate( void* ptr, size_t )
+{
+  // Free a buffer obtained from Allocate()
+
+  free(ptr);
+}
+
+} // namespace Podd
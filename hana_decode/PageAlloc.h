@@ -0,0 +1,44 @@
+#ifndef Podd_PageAlloc_h_
+#define Podd_PageAlloc_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::PageAlloc
+//
+// Page-aligned allocation of large buffers, optionally backed by huge
+// pages and/or pre-faulted
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <cstddef>
+
+namespace Podd {
+
+class PageAlloc {
+
+public:
+  // Allocation policy for large buffers (bit pattern)
+  enum EMode {
+    kDefault  = 0,       // Ordinary pages, faulted in on first access
+    kHuge     = BIT(0),  // Request transparent huge pages (Linux)
+    kPrefault = BIT(1)   // Touch all pages when allocating
+  };
+
+  // Buffers of at least this size are allocated by Allocate()
+  static constexpr size_t kMinSize = 64*1024;
+
+  static void    SetMode( UInt_t mode );
+  static UInt_t  GetMode();
+  static Bool_t  IsHugeAvailable();
+  // Parse a mode string ("huge", "prefault", "huge,prefault", "off").
+  // Returns the mode, or -1 on error.
+  static Int_t   ParseMode( const char* str );
+
+  static void*   Allocate( size_t bytes );
+  static void    Deallocate( void* ptr, size_t bytes );
+};
+
+} // namespace Podd
+
+#endif
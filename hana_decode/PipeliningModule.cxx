@@ -26,20 +26,35 @@ PipeliningModule::PipeliningModule( UInt_t crate, UInt_t slot )
   ReStart();
 }
 
-Int_t PipeliningModule::SplitBuffer( const std::vector<UInt_t>& codabuffer ) {
+void PipeliningModule::AppendWord( EventBlock_t& evblk, const UInt_t* p ) {
+// Extend 'evblk' to include the word at 'p'. The words of one event are
+// contiguous in the CODA buffer; if not, the skipped words are included.
+  if( !evblk.data || evblk.len == 0 ) {
+    evblk.data = p;
+    evblk.len = 1;
+    return;
+  }
+  if( p != evblk.data + evblk.len && (fNWarnings++ % 100) == 0 )
+    cerr << "PipeliningModule::WARNING : event data not contiguous" << endl;
+  evblk.len = p - evblk.data + 1;
+}
+
+Int_t PipeliningModule::SplitBuffer( const UInt_t* evbuffer, const UInt_t* pend ) {
 
 // Split a CODA buffer into blocks.   A block is data from a traditional physics event.
 // In MultiBlock Mode, a pipelining module can have several events in each CODA buffer.
 // If block level is 1, then the buffer is a traditional physics event.
 // If finding >1 block, this will set fMultiBlockMode = true
+// The words of [evbuffer,pend) are not copied; eventblock records where
+// each event starts and how long it is.
 
-  std::vector<UInt_t> oneEventBuffer;
+  EventBlock_t oneEvent;
   eventblock.clear();
   fBlockIsDone = false;
   UInt_t eventnum = 1;
 
   if ( !fFirstTime && !IsMultiBlockMode() ) {
-     eventblock.push_back(codabuffer);
+     eventblock.emplace_back(evbuffer, pend-evbuffer);
      index_buffer=1;
      return 1;
   }
@@ -49,10 +64,11 @@ Int_t PipeliningModule::SplitBuffer( const std::vector<UInt_t>& codabuffer ) {
 
   block_size = 0;   // member of the base class Module.h
 
-  for( UInt_t data : codabuffer ) {
+  for( const UInt_t* p = evbuffer; p < pend; ++p ) {
+    UInt_t data = *p;
 
     if ( fDebug >= 1) {
-      if (fDebugFile) *fDebugFile << hex <<"SplitBuffer, data = "<<hex<<data<<dec<<endl;
+      if (DEBUG_FILE(fDebugFile)) *fDebugFile << hex <<"SplitBuffer, data = "<<hex<<data<<dec<<endl;
     }
 
     UInt_t data_type_id = (data >> 31) & 0x1;  // Data type identification, mask 1 bit
@@ -61,7 +77,7 @@ Int_t PipeliningModule::SplitBuffer( const std::vector<UInt_t>& codabuffer ) {
       data_type_def = (data >> 27) & 0xF;
 
     if ( fDebug == 1) {
-      if (fDebugFile) *fDebugFile << "SplitBuffer: data types: data_type_id = " << data_type_id
+      if (DEBUG_FILE(fDebugFile)) *fDebugFile << "SplitBuffer: data types: data_type_id = " << data_type_id
 			<< " data_type_def = " << data_type_def << endl;
     }
 
@@ -75,7 +91,7 @@ Int_t PipeliningModule::SplitBuffer( const std::vector<UInt_t>& codabuffer ) {
           if (block_size > 1) fMultiBlockMode = true;
           if (fMultiBlockMode && slot_blk_hdr==fSlot) BlockStart=1;
           // Debug output
-          if ( fDebug >= 1 && fDebugFile) {
+          if ( fDebug >= 1 && DEBUG_FILE(fDebugFile)) {
             UInt_t iblock_num = (data >> 8) & 0x3FF;  // Event block number, mask 10 bits
             *fDebugFile << "SplitBuffer:  %% data BLOCK header: slot_blk_hdr = " << dec<<slot_blk_hdr
                 << " iblock_num = " << iblock_num << " block_size = " << block_size << endl;
@@ -87,14 +103,14 @@ Int_t PipeliningModule::SplitBuffer( const std::vector<UInt_t>& codabuffer ) {
           UInt_t slot_blk_trl = (data >> 22) & 0x1F;  // Slot number (set by VME64x backplane), mask 5 bits
           if (fMultiBlockMode && slot_blk_trl==fSlot) {
             BlockStart++;
-            oneEventBuffer.push_back(data);
+            AppendWord(oneEvent, p);
             // There is no "event trailer", but a block trailer indicates the last event in a block.
-            eventblock.push_back(oneEventBuffer);
-            oneEventBuffer.clear();
+            eventblock.push_back(oneEvent);
+            oneEvent = EventBlock_t();
           }
 
           // Debug output
-          if ( fDebug >= 1 && fDebugFile) {
+          if ( fDebug >= 1 && DEBUG_FILE(fDebugFile)) {
             UInt_t nwords_inblock = (data >> 0) & 0x3FFFFF;  // Total number of words in block of events, mask 22 bits
             *fDebugFile << "SplitBuffer: %% data BLOCK trailer: slot_blk_trl = " <<  slot_blk_trl
                 << " nwords_inblock = " << nwords_inblock << endl;
@@ -108,7 +124,7 @@ Int_t PipeliningModule::SplitBuffer( const std::vector<UInt_t>& codabuffer ) {
           UInt_t evt_num_modblock = (block_size == 0) ? 0 : (evt_num % block_size);
           if (slot_blk_hdr==fSlot) {
             BlockStart++;
-            if (fDebugFile) *fDebugFile << "evt_num logic "<< evt_num<<"  "<<block_size<<"  "<<evt_num_modblock<<"   "<<eventnum<<endl;
+            if (DEBUG_FILE(fDebugFile)) *fDebugFile << "evt_num logic "<< evt_num<<"  "<<block_size<<"  "<<evt_num_modblock<<"   "<<eventnum<<endl;
           }
           // for some older firmware, slot_evt_hdr is zero, so use slot_blk_hdr
           if (fMultiBlockMode && slot_blk_hdr==fSlot) {
@@ -116,19 +132,18 @@ Int_t PipeliningModule::SplitBuffer( const std::vector<UInt_t>& codabuffer ) {
 // One could look for the (evt_num_modblock != eventnum) but I find that for some data files the
 // evt_num makes no sense and is a random number.  Instead, the following logic works.
             if (BlockStart != 2) {
-              eventblock.push_back(oneEventBuffer);
-              oneEventBuffer.clear();
+              eventblock.push_back(oneEvent);
             }
             eventnum = evt_num_modblock;
-            oneEventBuffer.push_back(fBlockHeader);  // put block header with each event, e.g. FADC250 needs it.
-            oneEventBuffer.push_back(data);
+            // put block header with each event, e.g. FADC250 needs it.
+            oneEvent = EventBlock_t(p, 1, fBlockHeader, true);
           }
 
           // Debug output
-          if ( fDebug >= 1 && fDebugFile) {
+          if ( fDebug >= 1 && DEBUG_FILE(fDebugFile)) {
             *fDebugFile << "SplitBuffer:  %% data EVENT header: slot_evt_hdr = " << slot_evt_hdr
                 << " evt_num = " << evt_num << "  "
-                << oneEventBuffer.size() <<"   "<<eventblock.size()<<endl;
+                << oneEvent.size() <<"   "<<eventblock.size()<<endl;
           }
         }
         break;
@@ -139,7 +154,7 @@ Int_t PipeliningModule::SplitBuffer( const std::vector<UInt_t>& codabuffer ) {
             cerr << "PipeliningModule::WARNING : inconsistent slot num  "<<endl;
         }
         // all other data goes here
-        if ( fMultiBlockMode && slot_blk_hdr == fSlot) oneEventBuffer.push_back(data);
+        if ( fMultiBlockMode && slot_blk_hdr == fSlot) AppendWord(oneEvent, p);
 
       }
 
@@ -148,13 +163,13 @@ Int_t PipeliningModule::SplitBuffer( const std::vector<UInt_t>& codabuffer ) {
   fFirstTime = false;
 
   if (!IsMultiBlockMode()) {
-    eventblock.push_back(codabuffer);
+    eventblock.emplace_back(evbuffer, pend-evbuffer);
     index_buffer=1;
     return 1;
   } else {
     if (static_cast<size_t>(block_size) != eventblock.size()) {
       cerr << "PipeliningModule::ERROR:  num events in block inconsistent"<<endl;
-      if (fDebugFile) *fDebugFile << "block_size = "<<dec<<block_size<<"   "<<eventblock.size()<<endl;
+      if (DEBUG_FILE(fDebugFile)) *fDebugFile << "block_size = "<<dec<<block_size<<"   "<<eventblock.size()<<endl;
     }
     if ( fDebug >= 1) PrintBlocks();  // debug
   }
@@ -171,11 +186,11 @@ void PipeliningModule::PrintBlocks() {
 // and all buffers will have an event header
   const UInt_t maxloops = 5000000;
   if (!IsMultiBlockMode()) {
-     if (fDebugFile) *fDebugFile << "PipeliningModule:  Not in multiblock mode.  Bye."<<endl;
+     if (DEBUG_FILE(fDebugFile)) *fDebugFile << "PipeliningModule:  Not in multiblock mode.  Bye."<<endl;
      return;
   }
   ReStart();
-  if (fDebugFile) {
+  if (DEBUG_FILE(fDebugFile)) {
       *fDebugFile << "PipeliningModule :: Number of events in block = "<<eventblock.size()<<endl;
       *fDebugFile << "fSlot = "<<fSlot<<endl;
   }
@@ -185,10 +200,10 @@ void PipeliningModule::PrintBlocks() {
     if( icnt++ > maxloops ) {
       throw runtime_error("PipeliningModule:: ERROR: infinite loop PrintBlocks ");
     }
-    std::vector<UInt_t> evbuffer = GetNextBlock();
-    if (fDebugFile) *fDebugFile << "Block number " << iblk++ <<endl;
-    for (size_t j = 0; j < evbuffer.size(); j++) {
-      if (fDebugFile) *fDebugFile << "            evbuffer["<<j<<"] =   0x"<<hex<<evbuffer[j]<<dec<<endl;
+    const EventBlock_t& evbuffer = GetNextBlock();
+    if (DEBUG_FILE(fDebugFile)) *fDebugFile << "Block number " << iblk++ <<endl;
+    for (UInt_t j = 0; j < evbuffer.size(); j++) {
+      if (DEBUG_FILE(fDebugFile)) *fDebugFile << "            evbuffer["<<j<<"] =   0x"<<hex<<evbuffer[j]<<dec<<endl;
     }
   }
   ReStart();
@@ -199,8 +214,18 @@ void PipeliningModule::ReStart() {
    fBlockIsDone = false;
 }
 
-std::vector< UInt_t > PipeliningModule::GetNextBlock() {
-  std::vector< UInt_t > vnothing;  vnothing.clear();
+Bool_t PipeliningModule::SetBlockIndex( UInt_t ievent ) {
+// Position at event 'ievent' (0 = first) of the current block, so that
+// GetNextBlock returns it next. Returns false if there is no such event.
+  if( !IsMultiBlockMode() || ievent >= eventblock.size() )
+    return false;
+  index_buffer = ievent;
+  fBlockIsDone = false;
+  return true;
+}
+
+const PipeliningModule::EventBlock_t& PipeliningModule::GetNextBlock() {
+  static const EventBlock_t vnothing;
   if (eventblock.empty()) {
       cerr << "ERROR:  No event buffers ! "<<endl;   // Should never happen
       return vnothing;
@@ -25,6 +25,11 @@
 //   the last event buffer will have the block trailer
 //   and all event buffers will have an event header
 //
+//   The event buffers are not copies. Each one refers to a range of words
+//   in the CODA buffer passed to SplitBuffer, plus the block header word.
+//   That buffer must therefore remain valid until the last event of the
+//   block has been loaded, i.e. until the next CODA event is read.
+//
 /////////////////////////////////////////////////////////////////////
 
 #include "VmeModule.h"
@@ -45,24 +50,45 @@ public:
    virtual ~PipeliningModule() = default;
 
    void PrintBlocks();
+   virtual Bool_t SetBlockIndex( UInt_t ievent );
 
 protected:
 
-   virtual Int_t SplitBuffer( const std::vector<UInt_t>& bigbuffer );
+   // Location of the data of one event in the CODA buffer. If has_header
+   // is set, the block header word precedes the 'len' words at 'data'.
+   class EventBlock_t {
+   public:
+     EventBlock_t( const UInt_t* _data = nullptr, UInt_t _len = 0,
+                   UInt_t _header = 0, Bool_t _has_header = false )
+       : data(_data), len(_len), header(_header), has_header(_has_header) {}
+     UInt_t size() const { return has_header ? len+1 : len; }
+     UInt_t operator[]( UInt_t i ) const {
+       return has_header ? (i == 0 ? header : data[i-1]) : data[i];
+     }
+     const UInt_t* data;
+     UInt_t        len;
+     UInt_t        header;
+     Bool_t        has_header;
+   };
+
+   virtual Int_t SplitBuffer( const UInt_t* evbuffer, const UInt_t* pend );
    void ReStart();
-   std::vector< UInt_t >GetNextBlock();
+   const EventBlock_t& GetNextBlock();
    virtual UInt_t LoadNextEvBuffer( THaSlotData *sldat )=0;
-   virtual UInt_t LoadThisBlock( THaSlotData *sldat, const std::vector<UInt_t>& evb ) = 0;
+   virtual UInt_t LoadThisBlock( THaSlotData *sldat, const EventBlock_t& evb ) = 0;
    UInt_t fNWarnings;
    UInt_t fBlockHeader;
    UInt_t data_type_def;
 
    Bool_t fFirstTime;
 
-   std::vector<std::vector<UInt_t>> eventblock;
+   std::vector<EventBlock_t> eventblock;
    UInt_t index_buffer;
    UInt_t GetIndex();
 
+private:
+   void AppendWord( EventBlock_t& evblk, const UInt_t* p );
+
    ClassDef(Decoder::PipeliningModule,0)  // A pipelining module
 
 };
@@ -0,0 +1,162 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::ProfMarkers
+//
+// Named task markers for external profilers, so that VTune or Tracy show
+// the analysis stages and modules of a replay (e.g. "Decode" containing
+// "R.vdc") along with their own samples. Each Profiler timer has a
+// marker of the same name, begun and ended in Profiler::Start/Stop, i.e.
+// wherever THaAnalyzer and THaEvData time their work when benchmarks are
+// enabled.
+//
+// Markers are only compiled in with one of the build options
+//    PODD_WITH_ITT    Intel ITT API (VTune), cmake -DPODD_WITH_ITT=ON
+//    PODD_WITH_TRACY  Tracy client,          cmake -DPODD_WITH_TRACY=ON
+// Otherwise, IsAvailable() is false and the inline no-op functions in
+// ProfMarkers.h leave no code behind.
+//
+// Markers must be ended on the thread that began them, in reverse order,
+// which the Profiler's nested Start/Stop calls guarantee.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "ProfMarkers.h"
+
+#ifdef PODD_PROF_MARKERS
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#if defined(PODD_WITH_ITT)
+#include <ittnotify.h>
+#elif defined(PODD_WITH_TRACY)
+#include <vector>
+#include "tracy/TracyC.h"
+#endif
+
+using namespace std;
+
+namespace Podd {
+
+// Marker data, one per distinct name. Handles point to these.
+struct ProfMarker {
+  explicit ProfMarker( const string& _name ) : name(_name) {
+#if defined(PODD_WITH_ITT)
+    handle = __itt_string_handle_create(name.c_str());
+#elif defined(PODD_WITH_TRACY)
+    srcloc = { name.c_str(), name.c_str(), __FILE__, 0, 0 };
+#endif
+  }
+  string name;
+#if defined(PODD_WITH_ITT)
+  __itt_string_handle* handle;
+#elif defined(PODD_WITH_TRACY)
+  ___tracy_source_location_data srcloc;  // Must outlive the zones
+#endif
+};
+
+} // namespace Podd
+
+namespace {
+
+// All markers. Elements of a deque do not move, so handles remain valid
+// while new markers are registered.
+mutex gMarkerLock;
+deque<Podd::ProfMarker> gMarkers;
+unordered_map<string,Podd::ProfMarker*> gMarkerIndex;
+
+#if defined(PODD_WITH_ITT)
+__itt_domain* gDomain = nullptr;
+#elif defined(PODD_WITH_TRACY)
+thread_local vector<TracyCZoneCtx> tZones;  // Open zones of this thread
+#endif
+
+} // namespace
+#endif
+
+namespace Podd {
+
+constexpr ProfMarkers::Handle_t ProfMarkers::kNone;
+
+//_____________________________________________________________________________
+Bool_t ProfMarkers::IsAvailable()
+{
+#ifdef PODD_PROF_MARKERS
+  return true;
+#else
+  return false;
+#endif
+}
+
+//_____________________________________________________________________________
+const char* ProfMarkers::GetBackend()
+{
+  // Name of the profiler API compiled in, or "none"
+
+#if defined(PODD_WITH_ITT)
+  return "ITT";
+#elif defined(PODD_WITH_TRACY)
+  return "Tracy";
+#else
+  return "none";
+#endif
+}
+
+#ifdef PODD_PROF_MARKERS
+//_____________________________________________________________________________
+ProfMarkers::Handle_t ProfMarkers::Register( const char* name )
+{
+  // Get the marker with the given name, creating it if necessary.
+  // Thread-safe. Markers are never deleted.
+
+  if( !name || !*name )
+    return kNone;
+  lock_guard<mutex> lock(gMarkerLock);
+#ifdef PODD_WITH_ITT
+  if( !gDomain )
+    gDomain = __itt_domain_create("Podd");
+#endif
+  auto it = gMarkerIndex.find(name);
+  if( it != gMarkerIndex.end() )
+    return it->second;
+  gMarkers.emplace_back(name);
+  Handle_t h = &gMarkers.back();
+  gMarkerIndex.emplace(name, h);
+  return h;
+}
+
+//_____________________________________________________________________________
+void ProfMarkers::Begin( Handle_t h )
+{
+  // Begin the task/zone of marker 'h' on the calling thread
+
+  if( h == kNone )
+    return;
+#if defined(PODD_WITH_ITT)
+  __itt_task_begin(gDomain, __itt_null, __itt_null, h->handle);
+#elif defined(PODD_WITH_TRACY)
+  tZones.push_back(___tracy_emit_zone_begin(&h->srcloc, 1));
+#endif
+}
+
+//_____________________________________________________________________________
+void ProfMarkers::End( Handle_t h )
+{
+  // End the innermost task/zone of the calling thread, which must be
+  // the one of marker 'h'
+
+  if( h == kNone )
+    return;
+#if defined(PODD_WITH_ITT)
+  __itt_task_end(gDomain);
+#elif defined(PODD_WITH_TRACY)
+  if( !tZones.empty() ) {
+    ___tracy_emit_zone_end(tZones.back());
+    tZones.pop_back();
+  }
+#endif
+}
+#endif
+
+} // namespace Podd
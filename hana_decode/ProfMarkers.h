@@ -0,0 +1,46 @@
+#ifndef Podd_ProfMarkers_h_
+#define Podd_ProfMarkers_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::ProfMarkers
+//
+// Optional task markers for external profilers (VTune, Tracy)
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+
+#if defined(PODD_WITH_ITT) || defined(PODD_WITH_TRACY)
+#define PODD_PROF_MARKERS
+#endif
+
+namespace Podd {
+
+struct ProfMarker;
+
+class ProfMarkers {
+
+public:
+  typedef ProfMarker* Handle_t;
+  static constexpr Handle_t kNone = nullptr;
+
+  // Markers compiled in (build option PODD_WITH_ITT or PODD_WITH_TRACY)
+  static Bool_t      IsAvailable();
+  static const char* GetBackend();
+
+#ifdef PODD_PROF_MARKERS
+  static Handle_t    Register( const char* name );
+  static void        Begin( Handle_t h );
+  static void        End( Handle_t h );
+#else
+  // Without a profiler backend, markers compile to nothing
+  static Handle_t    Register( const char* ) { return kNone; }
+  static void        Begin( Handle_t ) {}
+  static void        End( Handle_t ) {}
+#endif
+};
+
+} // namespace Podd
+
+#endif
@@ -0,0 +1,303 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::Profiler
+//
+// Wall-clock timers for analysis code, meant to be cheap enough to remain
+// enabled in production replays.
+//
+// Timers are registered once, typically during initialization, and are
+// then addressed by an integer handle. Start() and Stop() read
+// std::chrono::steady_clock and do not look anything up, unlike
+// TBenchmark/THaBenchmark, which searches its list of timers by name on
+// every call. There is no limit on the number of timers.
+//
+// Each timer may have a parent, which makes timers hierarchical, e.g.
+//    Total -> Decode -> R.vdc
+// Registering the same name under the same parent again returns the
+// existing handle. The parent's time includes that of its children.
+// Optionally, a timer can also measure process CPU time (std::clock),
+// which costs an extra system call per Start/Stop.
+//
+// With SetCountAllocs(), timers also record the heap allocations made
+// between Start() and Stop() by the thread that calls them, as counted by
+// AllocCounter. This requires a build with PODD_ALLOC_TRACKING.
+//
+// With SetRecordLatency(), a timer also keeps a LatencyHistogram of the
+// durations of its individual Start/Stop cycles, from which GetLatency()
+// gives percentiles, e.g. of the per-event time of an analysis stage.
+//
+// If built with support for an external profiler (see ProfMarkers),
+// Start() and Stop() also begin and end a task of the timer's name, which
+// VTune or Tracy then show alongside their samples.
+//
+// At the end of a run, Print() shows an indented summary of all timers.
+// WriteFolded() writes the "self" time of each timer (its time minus that
+// of its children) in microseconds in the folded-stack format used by
+// flame graph tools, one line per timer:
+//    Analyzer;Total;Decode;R.vdc 123456
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Profiler.h"
+#include "TError.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cassert>
+
+using namespace std;
+
+namespace Podd {
+
+const Profiler::Handle_t Profiler::kNoParent;
+
+//_____________________________________________________________________________
+Profiler::Profiler( const char* name )
+  : fName(name ? name : ""), fCountAllocs(false)
+{
+  // Constructor. 'name' is used as root of the output paths.
+}
+
+//_____________________________________________________________________________
+Profiler::Handle_t Profiler::Register( const char* name, Handle_t parent,
+                                       Bool_t cputime )
+{
+  // Register a timer with the given name and parent (kNoParent for a
+  // top-level timer). Returns the handle of the new timer, or of the
+  // existing one if a timer of this name is already registered
+  // for this parent.
+
+  assert( name && *name );
+  assert( parent == kNoParent || parent < fTimers.size() );
+
+  string path = (parent == kNoParent) ? string(name)
+                                      : GetPath(parent) + ";" + name;
+  auto it = fIndex.find(path);
+  if( it != fIndex.end() )
+    return it->second;
+
+  UInt_t depth = (parent == kNoParent) ? 0 : fTimers[parent].depth + 1;
+  auto h = static_cast<Handle_t>(fTimers.size());
+  fTimers.emplace_back(name, parent, depth, cputime);
+  fTimers.back().marker = ProfMarkers::Register(name);
+  fIndex.emplace(path, h);
+  return h;
+}
+
+//_____________________________________________________________________________
+Profiler::Handle_t Profiler::Find( const char* name, Handle_t parent ) const
+{
+  // Find handle of timer with the given name and parent.
+  // Returns kNoParent if not found.
+
+  if( !name || (parent != kNoParent && parent >= fTimers.size()) )
+    return kNoParent;
+  string path = (parent == kNoParent) ? string(name)
+                                      : GetPath(parent) + ";" + name;
+  auto it = fIndex.find(path);
+  return (it != fIndex.end()) ? it->second : kNoParent;
+}
+
+//_____________________________________________________________________________
+void Profiler::Reset()
+{
+  // Zero all timers. Registered timers and handles remain valid.
+
+  for( auto& t : fTimers ) {
+    t.running = false;
+    t.ncalls  = 0;
+    t.real    = Clock::duration::zero();
+    t.cpu     = 0;
+    t.alloc   = AllocCounter::Count_t();
+    if( t.latency )
+      t.latency->Clear();
+  }
+}
+
+//_____________________________________________________________________________
+void Profiler::SetRecordLatency( Handle_t h, Bool_t b )
+{
+  // Enable/disable recording the duration of each Start/Stop cycle of
+  // timer 'h' in a histogram, see GetLatency(). Disabling discards the
+  // histogram.
+
+  assert( h < fTimers.size() );
+  Timer& t = fTimers[h];
+  if( !b )
+    t.latency.reset();
+  else if( !t.latency )
+    t.latency.reset(new LatencyHistogram);
+}
+
+//_____________________________________________________________________________
+Double_t Profiler::GetRealTime( Handle_t h ) const
+{
+  // Accumulated real time of timer 'h' in seconds
+
+  assert( h < fTimers.size() );
+  return chrono::duration<Double_t>(fTimers[h].real).count();
+}
+
+//_____________________________________________________________________________
+Double_t Profiler::GetCpuTime( Handle_t h ) const
+{
+  // Accumulated CPU time of timer 'h' in seconds. Zero unless the timer
+  // was registered with 'cputime' set.
+
+  assert( h < fTimers.size() );
+  return static_cast<Double_t>(fTimers[h].cpu) / CLOCKS_PER_SEC;
+}
+
+//_____________________________________________________________________________
+ULong64_t Profiler::GetNCalls( Handle_t h ) const
+{
+  // Number of times timer 'h' was started and stopped
+
+  assert( h < fTimers.size() );
+  return fTimers[h].ncalls;
+}
+
+//_____________________________________________________________________________
+ULong64_t Profiler::GetNAllocs( Handle_t h ) const
+{
+  // Number of heap allocations made while timer 'h' was running. Zero
+  // unless allocation counting is enabled.
+
+  assert( h < fTimers.size() );
+  return fTimers[h].alloc.n;
+}
+
+//_____________________________________________________________________________
+ULong64_t Profiler::GetAllocBytes( Handle_t h ) const
+{
+  // Number of bytes allocated while timer 'h' was running
+
+  assert( h < fTimers.size() );
+  return fTimers[h].alloc.bytes;
+}
+
+//_____________________________________________________________________________
+string Profiler::GetPath( Handle_t h ) const
+{
+  // Full name of timer 'h', i.e. the names of all its parents and its own
+  // name, separated by semicolons
+
+  assert( h < fTimers.size() );
+  string path = fTimers[h].name;
+  for( Handle_t p = fTimers[h].parent; p != kNoParent; p = fTimers[p].parent )
+    path.insert(0, fTimers[p].name + ";");
+  return path;
+}
+
+//_____________________________________________________________________________
+Double_t Profiler::GetSelfTime( Handle_t h ) const
+{
+  // Real time of timer 'h' in seconds, minus the time of its children
+
+  Double_t t = GetRealTime(h);
+  for( Handle_t i = h+1; i < fTimers.size(); ++i ) {
+    if( fTimers[i].parent == h )
+      t -= GetRealTime(i);
+  }
+  return (t > 0) ? t : 0;
+}
+
+//_____________________________________________________________________________
+void Profiler::Print( Handle_t h, ostream& os ) const
+{
+  // Print one line summarizing timer 'h'
+
+  assert( h < fTimers.size() );
+  const Timer& t = fTimers[h];
+  const int width = (t.depth < 10) ? 24 - 2*t.depth : 4;
+  os << setw(2*t.depth) << "" << left << setw(width) << t.name << right
+     << " Real Time = " << fixed << setprecision(3) << setw(9)
+     << GetRealTime(h) << " s";
+  if( t.cputime )
+    os << "  Cpu Time = " << setw(9) << GetCpuTime(h) << " s";
+  os << "  Calls = " << t.ncalls;
+  if( fCountAllocs )
+    os << "  Allocs = " << t.alloc.n << " (" << t.alloc.bytes << " B)";
+  if( t.parent != kNoParent ) {
+    Double_t tp = GetRealTime(t.parent);
+    if( tp > 0 )
+      os << "  (" << setprecision(1) << setw(5)
+         << 100.0 * GetRealTime(h) / tp << "%)";
+  }
+  os << defaultfloat << endl;
+  if( t.latency && t.latency->GetCount() > 0 ) {
+    os << setw(2*t.depth+2) << "" << "Latency: ";
+    t.latency->Print(os);
+    os << defaultfloat << endl;
+  }
+}
+
+//_____________________________________________________________________________
+void Profiler::PrintTree( Handle_t h, ostream& os ) const
+{
+  // Print timer 'h' followed by all its children. Timers never started
+  // are not shown.
+
+  if( fTimers[h].ncalls == 0 )
+    return;
+  Print(h, os);
+  for( Handle_t i = h+1; i < fTimers.size(); ++i ) {
+    if( fTimers[i].parent == h )
+      PrintTree(i, os);
+  }
+}
+
+//_____________________________________________________________________________
+void Profiler::Print( ostream& os ) const
+{
+  // Print summary of all timers, children indented below their parents
+
+  for( Handle_t h = 0; h < fTimers.size(); ++h ) {
+    if( fTimers[h].parent == kNoParent )
+      PrintTree(h, os);
+  }
+}
+
+//_____________________________________________________________________________
+void Profiler::Print() const
+{
+  Print(cout);
+}
+
+//_____________________________________________________________________________
+void Profiler::WriteFolded( ostream& os, const char* prefix ) const
+{
+  // Write self time of all timers, in microseconds, in folded-stack format.
+  // Paths start with 'prefix' (if given) and the name of this profiler.
+
+  string root = (prefix && *prefix) ? string(prefix) + ";" : string();
+  if( !fName.empty() )
+    root += fName + ";";
+  for( Handle_t h = 0; h < fTimers.size(); ++h ) {
+    if( fTimers[h].ncalls == 0 )
+      continue;
+    auto us = static_cast<ULong64_t>(1e6 * GetSelfTime(h) + 0.5);
+    if( us > 0 )
+      os << root << GetPath(h) << " " << us << endl;
+  }
+}
+
+//_____________________________________________________________________________
+Int_t Profiler::WriteFolded( const char* filename, Bool_t append ) const
+{
+  // Write self times of all timers in folded-stack format to 'filename'.
+  // If 'append' is true, append to the file if it exists.
+  // Returns 0 on success, -1 if the file cannot be written.
+
+  if( !filename || !*filename )
+    return -1;
+  ofstream ofs(filename, append ? ios::app : ios::trunc);
+  if( !ofs ) {
+    ::Error( "Profiler::WriteFolded", "Cannot open file %s", filename );
+    return -1;
+  }
+  WriteFolded(ofs);
+  return ofs.good() ? 0 : -1;
+}
+
+} // namespace Podd
@@ -0,0 +1,148 @@
+#ifndef Podd_Profiler_h_
+#define Podd_Profiler_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::Profiler
+//
+// Low-overhead hierarchical timers addressed by integer handles
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include "AllocCounter.h"
+#include "LatencyHistogram.h"
+#include "ProfMarkers.h"
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <iosfwd>
+
+namespace Podd {
+
+class Profiler {
+
+public:
+  typedef UInt_t Handle_t;
+  static const Handle_t kNoParent = kMaxUInt;
+
+  explicit Profiler( const char* name = "" );
+
+  Handle_t    Register( const char* name, Handle_t parent = kNoParent,
+                        Bool_t cputime = false );
+  Handle_t    Find( const char* name, Handle_t parent = kNoParent ) const;
+  void        Reset();
+  void        SetCountAllocs( Bool_t b = true ) { fCountAllocs = b; }
+  Bool_t      IsCountAllocs() const { return fCountAllocs; }
+  void        SetRecordLatency( Handle_t h, Bool_t b = true );
+
+  void        Start( Handle_t h );
+  void        Stop( Handle_t h );
+
+  const char* GetName()     const { return fName.c_str(); }
+  const char* GetName( Handle_t h ) const { return fTimers.at(h).name.c_str(); }
+  UInt_t      GetSize()     const { return fTimers.size(); }
+  Double_t    GetRealTime( Handle_t h ) const;
+  Double_t    GetCpuTime( Handle_t h ) const;
+  ULong64_t   GetNCalls( Handle_t h ) const;
+  ULong64_t   GetNAllocs( Handle_t h ) const;
+  ULong64_t   GetAllocBytes( Handle_t h ) const;
+  std::string GetPath( Handle_t h ) const;
+  const LatencyHistogram* GetLatency( Handle_t h ) const
+  { return fTimers.at(h).latency.get(); }
+
+  void        Print( std::ostream& os ) const;
+  void        Print( Handle_t h, std::ostream& os ) const;
+  void        Print() const;
+  void        WriteFolded( std::ostream& os, const char* prefix = "" ) const;
+  Int_t       WriteFolded( const char* filename, Bool_t append = false ) const;
+
+  // Start a timer on construction and stop it on destruction
+  class Scope {
+  public:
+    Scope( Profiler* prof, Handle_t h ) : fProf(prof), fHandle(h)
+    { if( fProf ) fProf->Start(fHandle); }
+    ~Scope() { if( fProf ) fProf->Stop(fHandle); }
+    Scope( const Scope& ) = delete;
+    Scope& operator=( const Scope& ) = delete;
+  private:
+    Profiler* fProf;
+    Handle_t  fHandle;
+  };
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  class Timer {
+  public:
+    Timer( const char* _name, Handle_t _parent, UInt_t _depth, Bool_t _cpu )
+      : name(_name), parent(_parent), depth(_depth), cputime(_cpu),
+        running(false), ncalls(0), real(Clock::duration::zero()),
+        cpu(0), cpustart(0), marker(ProfMarkers::kNone) {}
+    std::string       name;     // Timer name
+    Handle_t          parent;   // Parent timer, or kNoParent
+    UInt_t            depth;    // Nesting depth (0 = top level)
+    Bool_t            cputime;  // Also measure CPU time
+    Bool_t            running;  // Timer started
+    ULong64_t         ncalls;   // Number of Start/Stop cycles
+    Clock::duration   real;     // Accumulated real time
+    Clock::time_point start;    // Time of last Start()
+    std::clock_t      cpu;      // Accumulated CPU time
+    std::clock_t      cpustart; // CPU time at last Start()
+    AllocCounter::Count_t alloc;      // Accumulated heap allocations
+    AllocCounter::Count_t allocstart; // Allocation count at last Start()
+    std::unique_ptr<LatencyHistogram> latency; // Durations of single calls
+    ProfMarkers::Handle_t marker; // External profiler marker of this name
+  };
+
+  std::string                               fName;   // Profiler name
+  Bool_t                                    fCountAllocs; // Record allocations
+  std::vector<Timer>                        fTimers; // All timers
+  std::unordered_map<std::string,Handle_t>  fIndex;  // Path -> handle
+
+  void     PrintTree( Handle_t h, std::ostream& os ) const;
+  Double_t GetSelfTime( Handle_t h ) const;
+};
+
+//___________________________________________________________________________
+inline void Profiler::Start( Handle_t h )
+{
+  Timer& t = fTimers[h];
+  ProfMarkers::Begin(t.marker);
+  t.running = true;
+  if( fCountAllocs )
+    t.allocstart = AllocCounter::Get();
+  if( t.cputime )
+    t.cpustart = std::clock();
+  t.start = Clock::now();
+}
+
+//___________________________________________________________________________
+inline void Profiler::Stop( Handle_t h )
+{
+  Clock::time_point now = Clock::now();
+  Timer& t = fTimers[h];
+  if( !t.running )
+    return;
+  t.real += now - t.start;
+  if( t.latency )
+    t.latency->Record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        now - t.start).count());
+  if( t.cputime )
+    t.cpu += std::clock() - t.cpustart;
+  if( fCountAllocs ) {
+    AllocCounter::Count_t c = AllocCounter::Get();
+    t.alloc.n     += c.n - t.allocstart.n;
+    t.alloc.bytes += c.bytes - t.allocstart.bytes;
+  }
+  t.running = false;
+  ++t.ncalls;
+  ProfMarkers::End(t.marker);
+}
+
+} // namespace Podd
+
+#endif
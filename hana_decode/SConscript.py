@@ -11,6 +11,8 @@ libname = 'dc'
 altname = 'haDecode'
 
 src = """
+AllocCounter.cxx
+BankDirectory.cxx
 Caen1190Module.cxx
 Caen775Module.cxx
 Caen792Module.cxx
@@ -19,11 +21,15 @@ F1TDCModule.cxx
 Fadc250Module.cxx
 FastbusModule.cxx
 GenScaler.cxx
+LatencyHistogram.cxx
 Lecroy1875Module.cxx
 Lecroy1877Module.cxx
 Lecroy1881Module.cxx
 Module.cxx
+PageAlloc.cxx
 PipeliningModule.cxx
+ProfMarkers.cxx
+Profiler.cxx
 Scaler1151.cxx
 Scaler3800.cxx
 Scaler3801.cxx
@@ -55,7 +61,7 @@ else:
 
 # Decoder library
 dclib = build_library(dcenv, libname, src,
-                      extrahdrs = ['Decoder.h','CustomAlloc.h'],
+                      extrahdrs = ['Decoder.h','CustomAlloc.h','FadcWaveform.h'],
                       extradicthdrs = ['THaBenchmark.h'],
                       dictname = altname,
                       install_rpath = dc_install_rpath,
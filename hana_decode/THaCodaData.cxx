@@ -29,6 +29,7 @@ namespace Decoder {
 
 //_____________________________________________________________________________
 THaCodaData::THaCodaData() :
+  fEvPtr(nullptr),
   handle(0),
   fIsGood(true)
 {
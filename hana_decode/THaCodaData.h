@@ -29,6 +29,7 @@
 #define CODA_EOF    EOF    // End of file
 #define CODA_ERROR  -128   // Generic error return code
 #define CODA_FATAL  -255   // Fatal error
+#define CODA_EMPTY  -64    // No data available yet (non-blocking read)
 
 #define CODA_VERBOSE 1    // Errors explained verbosely (recommended)
 #define CODA_DEBUG  0     // Lots of printout (recommend to set = 0)
@@ -49,6 +50,7 @@ public:
   Bool_t  grow( UInt_t newsize = 0 );
   UInt_t  operator[]( UInt_t i ) { assert(i < size()); return fBuffer[i]; }
   UInt_t* get()        { return fBuffer.data(); }
+  const UInt_t* get() const { return fBuffer.data(); }
   UInt_t  size() const { return fBuffer.size(); }
   void    reset();
 
@@ -76,7 +78,9 @@ public:
    virtual Int_t codaOpen(const char* file_name, const char* session, Int_t mode=1) = 0;
    virtual Int_t codaClose()=0;
    virtual Int_t codaRead()=0;
-   UInt_t*       getEvBuffer() { return evbuffer.get(); }
+   const UInt_t* getEvBuffer() const {
+     return fEvPtr ? fEvPtr : evbuffer.get();
+   }
    UInt_t        getBuffSize() const { return evbuffer.size(); }
    virtual Bool_t isOpen() const = 0;
    virtual Int_t getCodaVersion();
@@ -87,6 +91,7 @@ protected:
    void staterr(const char* tried_to, Int_t status) const;
 
    EvtBuffer     evbuffer;    // Dynamically-sized event buffer
+   const UInt_t* fEvPtr;      // Current event if not in evbuffer (zero-copy)
    TString       filename;
    Int_t         handle;       // EVIO data handle
    Bool_t        fIsGood;
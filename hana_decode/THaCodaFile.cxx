@@ -8,6 +8,29 @@
 //
 //  This is largely a wrapper around the JLAB EVIO library.
 //
+//  Compressed files (by default *.zst and *.lz4, see SetDecompressor)
+//  are read sequentially through a pipe from the decompression program,
+//  which runs as a separate process in parallel with the analysis. With
+//  the analyzer's pipeline mode, the read-ahead thread then drains the
+//  pipe while earlier events are analyzed. For parallel decompression of
+//  files written in independent frames, use e.g.
+//     THaCodaFile::SetDecompressor(".zst", "pzstd -dcq -p 8");
+//
+//  Remote files given as URLs (root://, xroot://, http://, https://, see
+//  SetStreamCommand) are streamed the same way by a transfer program
+//  (xrdcp or curl), without a staging copy, and decompressed on the fly
+//  if the name also has a compression suffix.
+//
+//  Random access (Seek, event lists, zero-copy) needs an uncompressed
+//  local file.
+//
+//  Local uncompressed files written on a host of the other byte order
+//  are read through the memory-mapped random access handle, and the
+//  events are byte-swapped here rather than by EVIO (see SetFastSwap).
+//  Bulk data are swapped in tight loops that the compiler vectorizes.
+//  With SetSwapRocs, the ROC banks of physics events that the decoder
+//  skips anyway (see THaEvData::SetRocDemand) are not swapped at all.
+//
 //  author  Robert Michaels (rom@jlab.org)
 //
 /////////////////////////////////////////////////////////////////////
@@ -16,8 +39,20 @@
 #include "TSystem.h"
 #include "evio.h"
 #include <iostream>
+#include <fstream>
 #include <memory>
 #include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <chrono>
+#include <thread>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
@@ -25,18 +60,94 @@ using namespace std;
 
 namespace Decoder {
 
+//_____________________________________________________________________________
+// Decompression commands by file name suffix. The file name is appended.
+static vector<pair<string,string>>& Decompressors()
+{
+  static vector<pair<string,string>> cmds = {
+    { ".zst", "zstd -dcq" },
+    { ".lz4", "lz4 -dcq" }
+  };
+  return cmds;
+}
+
+//_____________________________________________________________________________
+// Commands streaming remote files to stdout, by URL prefix. The URL is
+// appended.
+static vector<pair<string,string>>& StreamCommands()
+{
+  static vector<pair<string,string>> cmds = {
+    { "root://",  "xrdcp -s -f" },
+    { "xroot://", "xrdcp -s -f" },
+    { "http://",  "curl -sSfL" },
+    { "https://", "curl -sSfL" }
+  };
+  return cmds;
+}
+
+//_____________________________________________________________________________
+static void SetCommand( vector<pair<string,string>>& cmds, const char* key,
+                        const char* command )
+{
+  // Replace or remove (if 'command' is empty) the entry for 'key' in 'cmds'
+
+  if( !key || !*key )
+    return;
+  auto it = find_if(ALL(cmds), [key]( const pair<string,string>& c ) {
+    return c.first == key; });
+  if( it != cmds.end() )
+    cmds.erase(it);
+  if( command && *command )
+    cmds.emplace_back(key, command);
+}
+
+//_____________________________________________________________________________
+static TString ShellQuote( const char* s )
+{
+  TString quoted(s);
+  quoted.ReplaceAll("'", "'\\''");
+  return "'" + quoted + "'";
+}
+
+//_____________________________________________________________________________
+static Long64_t GetFileSize( const char* fname )
+{
+  FileStat_t st;
+  if( gSystem->GetPathInfo(fname, st) != 0 )
+    return -1;
+  return st.fSize;
+}
+
+//_____________________________________________________________________________
+static Double_t Now()
+{
+  // Monotonic wall clock time in seconds
+  using namespace std::chrono;
+  return duration<Double_t>(steady_clock::now().time_since_epoch()).count();
+}
+
 //Constructors
 
 //_____________________________________________________________________________
   THaCodaFile::THaCodaFile()
-    : max_to_filt(0), maxflist(0), maxftype(0)
+    : max_to_filt(0), maxflist(0), maxftype(0), fRAHandle(0),
+      fRATable(nullptr), fRANevents(0), fRANext(0), fUseRA(false),
+      fZeroCopy(false), fSwapped(false), fFastSwap(true),
+      fSwapRocs(kMaxUInt), fCompressed(false), fRemote(false), fSeqNext(0),
+      fSelNext(0), fFollow(false), fFollowIdle(0), fFollowWait(1), fFollowSize(-1),
+      fLastGrowth(0), fNotifyFd(-1)
   {
     // Default constructor. Do nothing (must open file separately).
   }
 
 //_____________________________________________________________________________
   THaCodaFile::THaCodaFile(const char* fname, const char* readwrite)
-    : max_to_filt(0), maxflist(0), maxftype(0)
+    : max_to_filt(0), maxflist(0), maxftype(0), fRAHandle(0),
+      fRATable(nullptr), fRANevents(0), fRANext(0), fUseRA(false),
+      fZeroCopy(false), fSwapped(false), fFastSwap(true),
+      fSwapRocs(kMaxUInt), fCompressed(false), fRemote(false), fSeqNext(0),
+      fSelNext(0), fFollow(false), fFollowIdle(0), fFollowWait(1), fFollowSize(-1),
+      fLastGrowth(0), fNotifyFd(-1)
   {
     // Standard constructor. Pass read or write flag
     THaCodaFile::codaOpen(fname, readwrite);
@@ -62,15 +173,77 @@ namespace Decoder {
   {
     // Open CODA file 'fname' with 'readwrite' access
     init(fname);
-    Int_t status = evOpen((char*)fname, (char*)readwrite, &handle);
+    TString cmd = GetInputCommand(fname);
+    fCompressed = !GetDecompressor(fname).IsNull();
+    fRemote = !GetStreamCommand(fname).IsNull();
+    Int_t status = S_SUCCESS;
+    if( !cmd.IsNull() ) {
+      // Let EVIO read the output of the decompressor or transfer program
+      // through a pipe
+      if( *readwrite != 'r' ) {
+        cerr << "codaOpen ERROR: cannot write compressed or remote file "
+             << fname << endl;
+        fIsGood = false;
+        return CODA_ERROR;
+      }
+      if( !fRemote && gSystem->AccessPathName(fname, kReadPermission) ) {
+        cerr << "codaOpen ERROR: cannot read " << fname << endl;
+        fIsGood = false;
+        return CODA_ERROR;
+      }
+      TString pipe = "|" + cmd;
+      status = evOpen((char*)pipe.Data(), (char*)"r", &handle);
+    } else
+      status = evOpen((char*)fname, (char*)readwrite, &handle);
     fIsGood = (status == S_SUCCESS);
     staterr("open",status);
+    fFollowSize = -1;
+    if( status == S_SUCCESS && fFollow ) {
+      if( !cmd.IsNull() || *readwrite != 'r' ) {
+        cerr << "codaOpen WARNING: cannot follow " << fname << ", "
+             << "only local uncompressed files can be followed" << endl;
+      } else {
+        fFollowSize = GetFileSize(fname);
+        fLastGrowth = Now();
+        StartWatch();
+      }
+    }
+    if( status == S_SUCCESS && fZeroCopy && !cmd.IsNull() ) {
+      cerr << "codaOpen WARNING: " << fname << " is compressed or remote, "
+           << "zero-copy reading disabled" << endl;
+    } else if( status == S_SUCCESS && fZeroCopy && fFollow ) {
+      cerr << "codaOpen WARNING: " << fname << " is followed, "
+           << "zero-copy reading disabled" << endl;
+    } else if( status == S_SUCCESS && fZeroCopy && *readwrite == 'r' ) {
+      // Read events via the memory-mapped random access handle. Events
+      // in native byte order are then returned without copying.
+      if( OpenRandomAccess() == CODA_OK ) {
+        fRANext = 0;
+        fUseRA = true;
+      } else
+        cerr << "codaOpen WARNING: cannot memory-map " << fname
+             << ", zero-copy reading disabled" << endl;
+    } else if( status == S_SUCCESS && fFastSwap && !fFollow &&
+               cmd.IsNull() && *readwrite == 'r' && IsForeignFile(fname) ) {
+      // Foreign byte order: read via the random access handle as well,
+      // so that the events are swapped by ReadRandom instead of EVIO.
+      // Falls back to EVIO's sequential reading if this fails.
+      if( OpenRandomAccess() == CODA_OK ) {
+        fRANext = 0;
+        fUseRA = true;
+      }
+    }
     return ReturnCode(status);
   }
 
 //_____________________________________________________________________________
   Int_t THaCodaFile::codaClose() {
 // Close the file. Do nothing if file not opened.
+    CloseRandomAccess();
+    StopWatch();
+    fIndex.clear();
+    fSelect.clear();
+    fSeqNext = fSelNext = 0;
     if( !handle ) {
       return ReturnCode(S_SUCCESS);
     }
@@ -94,23 +267,43 @@ namespace Decoder {
       return ReturnCode(S_EVFILE_BADHANDLE);
     }
     Int_t status = S_SUCCESS;
-    do {
-      evbuffer.updateSize();
-      status = evRead(handle, getEvBuffer(), getBuffSize());
-      if( status == S_EVFILE_TRUNC ) {
-        // At least with EVIO version 5.2, probably earlier and hopefully later
-        // versions too, evRead has not consumed any buffer data if this
-        // error occurs. Thus growing the buffer and retrying is safe.
-        // Unfortunately, the EVIO C-API does not provide any means to access
-        // the actual event length here, so we have to guess how much more
-        // space is needed.  TODO: Make an EVIO feature request?
-        if( !evbuffer.grow() )
-          break;
+    fEvPtr = nullptr;
+    if( fUseRA ) {
+      // Memory-mapped mode (after Seek() or with zero-copy enabled):
+      // read sequentially from the random access table, or only the
+      // selected events
+      if( !fSelect.empty() )
+        fRANext = (fSelNext < fSelect.size()) ? fSelect[fSelNext++]
+                                              : fRANevents;
+      if( fRANext >= fRANevents )
+        status = EOF;
+      else if( fZeroCopy && !fSwapped ) {
+        // Point directly into the mapped file. Data that need byte
+        // swapping are copied (and swapped) by evReadRandom instead.
+        fEvPtr = fRATable[fRANext++];
+        fIsGood = true;
+        return CODA_OK;
+      } else {
+        status = ReadRandom(fRATable[fRANext]);
+        if( status == S_SUCCESS )
+          ++fRANext;
       }
-    } while( status == S_EVFILE_TRUNC );
+    } else {
+      status = ReadSequential();
+      // In follow mode, wait for more data at the current end of the file.
+      // If none arrive within fFollowWait, report that no data are
+      // available yet.
+      if( fFollow && fFollowSize >= 0 &&
+          (status == EOF || status == S_EVFILE_UNXPTDEOF) &&
+          !Follow(status) )
+        return CODA_EMPTY;
+    }
 
-    if( status == S_SUCCESS )
+    if( status == S_SUCCESS ) {
       evbuffer.recordSize();
+      if( !fUseRA )
+        ++fSeqNext;
+    }
 
     fIsGood = (status == S_SUCCESS || status == EOF );
     staterr("read",status);
@@ -175,10 +368,34 @@ Int_t THaCodaFile::filterToFile( const char* output_file )
     return CODA_FATAL;
   }
 
+  // When selecting by event number, use the event index to read only the
+  // selected events instead of the entire file
+  if( !evlist.empty() && !HasIndex() )
+    BuildIndex();  // on failure, fall back to sequential reading
+  bool use_index = HasIndex() && !(evtypes.empty() && evlist.empty());
+  vector<UInt_t> selected;
+  if( use_index ) {
+    for( UInt_t i = 0; i < fIndex.size(); ++i ) {
+      const auto& e = fIndex[i];
+      if( (evtypes.empty() || any_of(ALL(evtypes), Equals<UInt_t>(e.evtype))) &&
+          (evlist.empty()  || any_of(ALL(evlist),  Equals<UInt_t>(e.evnum))) )
+        selected.push_back(i);
+    }
+  }
+  auto isel = selected.begin();
+  auto next_event = [&]() -> Int_t {
+    if( !use_index )
+      return codaRead();
+    if( isel == selected.end() )
+      return CODA_EOF;
+    Int_t st = Seek(*isel++);
+    return (st == CODA_OK) ? codaRead() : st;
+  };
+
   UInt_t nfilt = 0;
   Int_t status = CODA_OK, fout_status = CODA_OK;
-  while( (status = codaRead()) == CODA_OK ) {
-    UInt_t* rawbuff = getEvBuffer();
+  while( (status = next_event()) == CODA_OK ) {
+    const UInt_t* rawbuff = getEvBuffer();
     UInt_t evtype = rawbuff[1] >> 16;
     UInt_t evnum = rawbuff[4];
     if( CODA_DEBUG ) {
@@ -261,6 +478,768 @@ Int_t THaCodaFile::filterToFile( const char* output_file )
      max_to_filt = max_event;
   }
 
+//_____________________________________________________________________________
+  static inline uint32_t swap32( uint32_t w )
+  {
+    return ((w & 0xffU) << 24) | ((w & 0xff00U) << 8) |
+           ((w >> 8) & 0xff00U) | (w >> 24);
+  }
+
+//_____________________________________________________________________________
+// Byte-swap 'n' 32-bit words. Plain loops like this one are vectorized
+// by the compiler (pshufb/vpshufb on x86).
+  static inline void SwapWords32( const uint32_t* src, uint32_t* dst, size_t n )
+  {
+    for( size_t i = 0; i < n; ++i )
+      dst[i] = swap32(src[i]);
+  }
+
+//_____________________________________________________________________________
+// Byte-swap each 16-bit half of 'n' 32-bit words
+  static inline void SwapWords16( const uint32_t* src, uint32_t* dst, size_t n )
+  {
+    for( size_t i = 0; i < n; ++i ) {
+      uint32_t w = src[i];
+      dst[i] = ((w & 0xff00ff00U) >> 8) | ((w & 0x00ff00ffU) << 8);
+    }
+  }
+
+//_____________________________________________________________________________
+// Byte-swap 'n' 32-bit words holding 64-bit values
+  static inline void SwapWords64( const uint32_t* src, uint32_t* dst, size_t n )
+  {
+    for( size_t i = 0; i+1 < n; i += 2 ) {
+      uint32_t lo = src[i];
+      dst[i]   = swap32(src[i+1]);
+      dst[i+1] = swap32(lo);
+    }
+  }
+
+//_____________________________________________________________________________
+// Byte-swap the 'n' words of EVIO structure contents of data type 'type'
+// from 'src' to 'dst', recursing into container structures. For contents
+// of a bank of banks, child banks with a tag below MAXROC whose bit in
+// 'rocs' is not set are copied unswapped except for their header. Returns
+// false if the data are malformed or of a type not handled here
+// (composite data), in which case the caller falls back to EVIO.
+  static_assert( MAXROC <= 32, "ROC mask must fit into 32 bits" );
+
+  static bool SwapContents( const uint32_t* src, uint32_t* dst, size_t n,
+                            uint32_t type, uint32_t rocs, int depth )
+  {
+    if( depth > 16 )
+      return false;
+    switch( type ) {
+    case 0x0: case 0x1: case 0x2: case 0xb:  // 32-bit data
+      SwapWords32(src, dst, n);
+      return true;
+    case 0x3: case 0x6: case 0x7:            // 8-bit data, strings
+      if( src != dst )
+        memcpy(dst, src, n*sizeof(uint32_t));
+      return true;
+    case 0x4: case 0x5:                      // 16-bit data
+      SwapWords16(src, dst, n);
+      return true;
+    case 0x8: case 0x9: case 0xa:            // 64-bit data
+      if( n % 2 != 0 )
+        return false;
+      SwapWords64(src, dst, n);
+      return true;
+    case 0xe: case 0x10:                     // banks
+      for( size_t i = 0; i < n; ) {
+        if( n - i < 2 )
+          return false;
+        uint32_t len = swap32(src[i]), hdr = swap32(src[i+1]);
+        if( len < 1 || len > n - i - 1 )
+          return false;
+        dst[i] = len; dst[i+1] = hdr;
+        uint32_t tag = hdr >> 16;
+        if( tag < MAXROC && (rocs & (1U << tag)) == 0 ) {
+          if( src != dst )
+            memcpy(dst+i+2, src+i+2, (len-1)*sizeof(uint32_t));
+        } else if( !SwapContents(src+i+2, dst+i+2, len-1, (hdr >> 8) & 0x3f,
+                                 kMaxUInt, depth+1) )
+          return false;
+        i += len + 1;
+      }
+      return true;
+    case 0xd: case 0x20:                     // segments
+    case 0xc:                                // tagsegments
+      for( size_t i = 0; i < n; ) {
+        uint32_t hdr = swap32(src[i]);
+        uint32_t len = hdr & 0xffff;
+        if( len > n - i - 1 )
+          return false;
+        dst[i] = hdr;
+        uint32_t ctype = (type == 0xc) ? (hdr >> 16) & 0xf : (hdr >> 16) & 0x3f;
+        if( !SwapContents(src+i+1, dst+i+1, len, ctype, kMaxUInt, depth+1) )
+          return false;
+        i += len + 1;
+      }
+      return true;
+    default:
+      return false;
+    }
+  }
+
+//_____________________________________________________________________________
+// Byte-swap the event at 'src' of 'n' words into 'dst'. ROC banks of
+// physics events are swapped only for the ROCs set in 'rocs'.
+  static bool SwapEvent( const uint32_t* src, uint32_t* dst, size_t n,
+                         uint32_t rocs )
+  {
+    if( n < 2 )
+      return false;
+    uint32_t hdr = swap32(src[1]);
+    dst[0] = swap32(src[0]);
+    dst[1] = hdr;
+    uint32_t tag = hdr >> 16;
+    bool physics = (tag >= 1 && tag <= MAX_PHYS_EVTYPE) ||    // CODA 2
+                   (tag >= 0xff50 && tag <= 0xff8f);          // CODA 3
+    return SwapContents(src+2, dst+2, n-2, (hdr >> 8) & 0x3f,
+                        physics ? rocs : kMaxUInt, 0);
+  }
+
+//_____________________________________________________________________________
+  void THaCodaFile::SetSwapRocs( const std::vector<UInt_t>& rocs )
+  {
+    // With byte-swapped files, swap the ROC banks of physics events only
+    // for the given ROCs. The banks of other ROCs keep the byte order of
+    // the file, except for their headers, so the decoder finds and can
+    // skip them. Use only if the decoder never looks at those ROCs, i.e.
+    // they are not in the ROC demand (THaEvData::SetRocDemand). An empty
+    // list (the default) swaps all ROCs. Has no effect on files in
+    // native byte order or with fast swapping disabled.
+
+    UInt_t mask = rocs.empty() ? kMaxUInt : 0;
+    for( auto roc : rocs ) {
+      if( roc < MAXROC )
+        mask |= 1U << roc;
+    }
+    fSwapRocs = mask;
+  }
+
+//_____________________________________________________________________________
+  Bool_t THaCodaFile::IsForeignFile( const char* fname ) const
+  {
+    // True if 'fname' is an EVIO file in non-native byte order, judging
+    // by the magic number in the first block header
+
+    static const uint32_t kEvioMagic = 0xc0da0100;
+    uint32_t header[8];
+    unique_ptr<FILE, decltype(&fclose)> fp(fopen(fname, "rb"), &fclose);
+    if( !fp || fread(header, sizeof(uint32_t), 8, fp.get()) != 8 )
+      return false;
+    return header[7] != kEvioMagic && swap32(header[7]) == kEvioMagic;
+  }
+
+//_____________________________________________________________________________
+  Int_t THaCodaFile::OpenRandomAccess()
+  {
+    // Open a second EVIO handle to the current file in random access mode
+    // and retrieve the table of pointers to all events. EVIO memory-maps
+    // the file in this mode. Also determines whether the data need to be
+    // byte-swapped. Does nothing if already open.
+    //
+    // Note: This reads the first event into the event buffer.
+
+    if( fRAHandle )
+      return CODA_OK;
+    if( fCompressed || fRemote ) {
+      cerr << "THaCodaFile ERROR: random access requires an uncompressed "
+           << "local file: " << filename << endl;
+      return CODA_ERROR;
+    }
+    Int_t status = evOpen((char*)filename.Data(), (char*)"ra", &fRAHandle);
+    if( status != S_SUCCESS ) {
+      staterr("open for random access", status);
+      fRAHandle = 0;
+      return ReturnCode(status);
+    }
+    uint32_t len = 0;
+    status = evGetRandomAccessTable(fRAHandle, &fRATable, &len);
+    if( status != S_SUCCESS || (len > 0 && !fRATable) ) {
+      staterr("get random access table for", status);
+      CloseRandomAccess();
+      return status != S_SUCCESS ? ReturnCode(status) : CODA_ERROR;
+    }
+    fRANevents = len;
+    if( fRANevents == 0 )
+      return CODA_OK;
+
+    // Find out if the data need byte swapping by comparing the raw first
+    // word of the first event with the one returned by EVIO
+    status = ReadRandom(fRATable[0]);
+    if( status != S_SUCCESS ) {
+      staterr("read", status);
+      CloseRandomAccess();
+      return ReturnCode(status);
+    }
+    fSwapped = (evbuffer[0] != fRATable[0][0]);
+    return CODA_OK;
+  }
+
+//_____________________________________________________________________________
+  Int_t THaCodaFile::ReadSequential()
+  {
+    // Read the next event from the regular handle into the event buffer.
+    // Returns EVIO status code.
+
+    Int_t status = S_SUCCESS;
+    do {
+      evbuffer.updateSize();
+      status = evRead(handle, evbuffer.get(), getBuffSize());
+      if( status == S_EVFILE_TRUNC ) {
+        // At least with EVIO version 5.2, probably earlier and hopefully
+        // later versions too, evRead has not consumed any buffer data if
+        // this error occurs. Thus growing the buffer and retrying is safe.
+        // Unfortunately, the EVIO C-API does not provide any means to
+        // access the actual event length here, so we have to guess how
+        // much more space is needed.  TODO: Make an EVIO feature request?
+        if( !evbuffer.grow() )
+          break;
+      }
+    } while( status == S_EVFILE_TRUNC );
+    return status;
+  }
+
+//_____________________________________________________________________________
+  Int_t THaCodaFile::ReadRandom( const uint32_t* evptr )
+  {
+    // Copy the event at 'evptr' in the mapped file into the event buffer,
+    // swapping bytes if necessary. Returns EVIO status code.
+
+    if( fSwapped && fFastSwap ) {
+      evbuffer.updateSize();
+      UInt_t n = swap32(evptr[0]) + 1;
+      if( n > 1 && evbuffer.grow(n) && n <= getBuffSize() &&
+          SwapEvent(evptr, evbuffer.get(), n, fSwapRocs) )
+        return S_SUCCESS;
+      // Unusual structure. Let EVIO deal with it.
+    }
+    Int_t status = S_SUCCESS;
+    do {
+      evbuffer.updateSize();
+      status = evReadRandom(fRAHandle, evptr, evbuffer.get(), getBuffSize());
+    } while( status == S_EVFILE_TRUNC && evbuffer.grow() );
+    return status;
+  }
+
+//_____________________________________________________________________________
+  void THaCodaFile::CloseRandomAccess()
+  {
+    // Close the random access handle, if open. Subsequent reads continue
+    // sequentially from the regular handle.
+
+    if( fRAHandle ) {
+      evClose(fRAHandle);
+      fRAHandle = 0;
+    }
+    fRATable = nullptr;
+    fRANevents = 0;
+    fRANext = 0;
+    fUseRA = false;
+    fSwapped = false;
+    fEvPtr = nullptr;
+  }
+
+//_____________________________________________________________________________
+  TString THaCodaFile::IndexFileName() const
+  {
+    // Default name of the index file for the current file
+
+    return filename + ".idx";
+  }
+
+//_____________________________________________________________________________
+  Bool_t THaCodaFile::HasIndexFile() const
+  {
+    // True if a sidecar index file for the current file exists, so that
+    // BuildIndex() can most likely read it instead of scanning the file
+
+    return !gSystem->AccessPathName(IndexFileName(), kReadPermission);
+  }
+
+//_____________________________________________________________________________
+  static const char kIndexMagic[8] = { 'P','O','D','D','E','V','X','1' };
+
+//_____________________________________________________________________________
+  Int_t THaCodaFile::BuildIndex( Bool_t use_sidecar )
+  {
+    // Build the index of all events in the current file, which enables
+    // Seek() and SeekEvent(). The file must be open for reading.
+    //
+    // If 'use_sidecar' is true, the index is read from the file
+    // <filename>.idx if that exists and matches the data file. Otherwise,
+    // the index is built by scanning the event headers and then saved
+    // to <filename>.idx, if possible, for use next time.
+    //
+    // Event types and numbers are taken from the CODA 2 event header
+    // layout, as in filterToFile().
+    //
+    // Note: Unless the file was opened in zero-copy mode, this reads the
+    // first event into the event buffer.
+
+    if( !handle ) {
+      cerr << "BuildIndex ERROR: file not open" << endl;
+      return CODA_ERROR;
+    }
+    if( HasIndex() )
+      return CODA_OK;
+
+    Int_t status = OpenRandomAccess();
+    if( status != CODA_OK )
+      return status;
+    UInt_t nev = fRANevents;
+    if( nev == 0 )
+      return CODA_OK;
+
+    if( use_sidecar && ReadIndex(IndexFileName()) == CODA_OK ) {
+      if( fIndex.size() == nev )
+        return CODA_OK;
+      fIndex.clear();
+    }
+
+    bool swap = fSwapped;
+    fIndex.reserve(nev);
+    const uint32_t* first = fRATable[0];
+    for( UInt_t i = 0; i < nev; ++i ) {
+      const uint32_t* p = fRATable[i];
+      uint32_t len = swap ? swap32(p[0]) : p[0];
+      uint32_t tag = swap ? swap32(p[1]) : p[1];
+      uint32_t num = 0;
+      if( len >= 4 )
+        num = swap ? swap32(p[4]) : p[4];
+      fIndex.emplace_back(p - first, tag >> 16, num);
+    }
+
+    if( use_sidecar )
+      WriteIndex();  // Failure is not an error, just slower next time
+
+    return CODA_OK;
+  }
+
+//_____________________________________________________________________________
+  Int_t THaCodaFile::WriteIndex( const char* idxfile ) const
+  {
+    // Write the event index to 'idxfile' (default: <filename>.idx)
+
+    if( !HasIndex() )
+      return CODA_ERROR;
+    TString fname = (idxfile && *idxfile) ? TString(idxfile) : IndexFileName();
+    ofstream ofs(fname.Data(), ios::binary | ios::trunc);
+    if( !ofs )
+      return CODA_ERROR;
+    Long64_t fsize = GetFileSize(filename.Data());
+    auto nev = static_cast<UInt_t>(fIndex.size());
+    ofs.write(kIndexMagic, sizeof(kIndexMagic));
+    ofs.write(reinterpret_cast<const char*>(&fsize), sizeof(fsize));
+    ofs.write(reinterpret_cast<const char*>(&nev), sizeof(nev));
+    for( const auto& e : fIndex ) {
+      ofs.write(reinterpret_cast<const char*>(&e.offset), sizeof(e.offset));
+      ofs.write(reinterpret_cast<const char*>(&e.evtype), sizeof(e.evtype));
+      ofs.write(reinterpret_cast<const char*>(&e.evnum),  sizeof(e.evnum));
+    }
+    if( !ofs ) {
+      ofs.close();
+      gSystem->Unlink(fname.Data());
+      return CODA_ERROR;
+    }
+    return CODA_OK;
+  }
+
+//_____________________________________________________________________________
+  Int_t THaCodaFile::ReadIndex( const char* idxfile )
+  {
+    // Read the event index from 'idxfile'. The index is accepted only if
+    // the size of the data file matches the one recorded in the index.
+
+    ifstream ifs(idxfile, ios::binary);
+    if( !ifs )
+      return CODA_ERROR;
+    char magic[sizeof(kIndexMagic)];
+    Long64_t fsize = 0;
+    UInt_t nev = 0;
+    ifs.read(magic, sizeof(magic));
+    ifs.read(reinterpret_cast<char*>(&fsize), sizeof(fsize));
+    ifs.read(reinterpret_cast<char*>(&nev), sizeof(nev));
+    if( !ifs || memcmp(magic, kIndexMagic, sizeof(magic)) != 0 ||
+        fsize != GetFileSize(filename.Data()) )
+      return CODA_ERROR;
+    fIndex.resize(nev);
+    for( auto& e : fIndex ) {
+      ifs.read(reinterpret_cast<char*>(&e.offset), sizeof(e.offset));
+      ifs.read(reinterpret_cast<char*>(&e.evtype), sizeof(e.evtype));
+      ifs.read(reinterpret_cast<char*>(&e.evnum),  sizeof(e.evnum));
+    }
+    if( !ifs ) {
+      fIndex.clear();
+      return CODA_ERROR;
+    }
+    return CODA_OK;
+  }
+
+//_____________________________________________________________________________
+  Int_t THaCodaFile::Seek( UInt_t ievent )
+  {
+    // Position the file so that the next codaRead() returns the event at
+    // position 'ievent' (0 = first event in file, any type). Builds the
+    // index if necessary.
+
+    if( !HasIndex() ) {
+      Int_t status = BuildIndex();
+      if( status != CODA_OK )
+        return status;
+    }
+    if( ievent >= fIndex.size() )
+      return CODA_EOF;
+    fSelect.clear();
+    fRANext = ievent;
+    fUseRA = true;
+    return CODA_OK;
+  }
+
+//_____________________________________________________________________________
+  UInt_t THaCodaFile::GetEventPos() const
+  {
+    // Position in the file of the event last returned by codaRead
+    // (0 = first event in file, any type), as used by Seek().
+    // Returns kMaxUInt if no event has been read yet.
+
+    if( fUseRA )
+      return fRANext > 0 ? fRANext-1 : kMaxUInt;
+    return fSeqNext > 0 ? fSeqNext-1 : kMaxUInt;
+  }
+
+//_____________________________________________________________________________
+  Int_t THaCodaFile::SelectEvents( const vector<UInt_t>& positions )
+  {
+    // Restrict reading to the events at 'positions' (see GetEventPos),
+    // in the given order. Subsequent codaRead() calls return only these
+    // events, then EOF. An empty list restores sequential reading from
+    // the first event. Builds the index if necessary.
+
+    Int_t status = Seek(0);
+    if( status != CODA_OK )
+      return status;
+    for( auto pos : positions ) {
+      if( pos >= fIndex.size() ) {
+        cerr << "SelectEvents ERROR: event position " << pos
+             << " beyond end of file (" << fIndex.size() << " events)"
+             << endl;
+        return CODA_ERROR;
+      }
+    }
+    fSelect = positions;
+    fSelNext = 0;
+    if( fSelect.empty() )
+      fRANext = 0;
+    return CODA_OK;
+  }
+
+//_____________________________________________________________________________
+  Int_t THaCodaFile::ReadEventList( const char* evlistfile, Int_t run )
+  {
+    // Read only the events listed in 'evlistfile', as written by THaFilter
+    // (lines of "run evnum evtype position", '#' starts a comment). If 'run'
+    // >= 0, only entries of that run are used. Entries without a known
+    // position (-1) are located by event number and type in the index.
+
+    ifstream ifs(evlistfile);
+    if( !ifs ) {
+      cerr << "ReadEventList ERROR: cannot open " << evlistfile << endl;
+      return CODA_ERROR;
+    }
+    if( !HasIndex() ) {
+      Int_t status = BuildIndex();
+      if( status != CODA_OK )
+        return status;
+    }
+    vector<UInt_t> positions;
+    string line;
+    while( getline(ifs, line) ) {
+      auto pos = line.find('#');
+      if( pos != string::npos )
+        line.erase(pos);
+      Long64_t r = 0, evnum = 0, evtype = 0, evpos = 0;
+      istringstream is(line);
+      if( !(is >> r >> evnum >> evtype >> evpos) )
+        continue;
+      if( run >= 0 && r != run )
+        continue;
+      if( evpos < 0 ) {
+        auto it = find_if(ALL(fIndex), [evnum,evtype]( const IndexEntry& e ) {
+          return e.evnum == evnum && e.evtype == evtype;
+        });
+        if( it == fIndex.end() ) {
+          cerr << "ReadEventList WARNING: event " << evnum << " of type "
+               << evtype << " not found, skipped" << endl;
+          continue;
+        }
+        evpos = it - fIndex.begin();
+      }
+      positions.push_back(evpos);
+    }
+    return SelectEvents(positions);
+  }
+
+//_____________________________________________________________________________
+  Int_t THaCodaFile::SetWriteBlockSize( UInt_t nwords )
+  {
+    // Set the size of the blocks written to this file to 'nwords' 32-bit
+    // words. Larger blocks mean fewer, larger writes. Must be called after
+    // opening the file for writing and before the first codaWrite().
+
+    if( !handle )
+      return ReturnCode(S_EVFILE_BADHANDLE);
+    Int_t status = evIoctl(handle, (char*)"B", &nwords);
+    staterr("ioctl",status);
+    return ReturnCode(status);
+  }
+
+//_____________________________________________________________________________
+  Int_t THaCodaFile::SeekEvent( UInt_t evnum, Int_t evtype )
+  {
+    // Position the file at the first event with event number 'evnum'.
+    // If 'evtype' >= 0, only consider events of that type, otherwise
+    // consider only physics events. Builds the index if necessary.
+    // Returns CODA_ERROR if no such event exists.
+
+    if( !HasIndex() ) {
+      Int_t status = BuildIndex();
+      if( status != CODA_OK )
+        return status;
+    }
+    auto it = find_if(ALL(fIndex), [evnum,evtype]( const IndexEntry& e ) {
+      if( e.evnum != evnum )
+        return false;
+      if( evtype >= 0 )
+        return e.evtype == static_cast<UInt_t>(evtype);
+      return e.evtype > 0 && e.evtype <= MAX_PHYS_EVTYPE;
+    });
+    if( it == fIndex.end() )
+      return CODA_ERROR;
+    return Seek(it - fIndex.begin());
+  }
+
+//_____________________________________________________________________________
+  void THaCodaFile::SetDecompressor( const char* suffix, const char* command )
+  {
+    // Read files ending in 'suffix' (e.g. ".zst") through the decompression
+    // program 'command', which must write the decompressed data to standard
+    // output when given the file name as last argument. An empty command
+    // removes the suffix. Applies to files opened afterwards.
+
+    SetCommand(Decompressors(), suffix, command);
+  }
+
+//_____________________________________________________________________________
+  void THaCodaFile::SetStreamCommand( const char* prefix, const char* command )
+  {
+    // Read files whose name starts with 'prefix' (e.g. "root://") through
+    // 'command', which must write the file to standard output when given
+    // the URL as last argument. An empty command removes the prefix.
+
+    SetCommand(StreamCommands(), prefix, command);
+  }
+
+//_____________________________________________________________________________
+  TString THaCodaFile::GetStreamCommand( const char* fname )
+  {
+    // Transfer command for remote file 'fname', or empty if it is local
+
+    TString name(fname);
+    for( const auto& c : StreamCommands() ) {
+      if( name.BeginsWith(c.first.c_str()) )
+        return c.second.c_str();
+    }
+    return "";
+  }
+
+//_____________________________________________________________________________
+  TString THaCodaFile::GetInputCommand( const char* fname )
+  {
+    // Shell command that writes the uncompressed contents of 'fname' to
+    // standard output, or empty if the file can be read directly
+
+    TString stream = GetStreamCommand(fname);
+    TString decomp = GetDecompressor(fname);
+    if( stream.IsNull() )
+      return decomp.IsNull() ? decomp : decomp + " " + ShellQuote(fname);
+    TString cmd = stream + " " + ShellQuote(fname);
+    if( stream.BeginsWith("xrdcp") )
+      cmd += " -";  // xrdcp needs the destination
+    if( !decomp.IsNull() )
+      cmd += " | " + decomp;
+    return cmd;
+  }
+
+//_____________________________________________________________________________
+  TString THaCodaFile::GetDecompressor( const char* fname )
+  {
+    // Decompression command for file 'fname', or empty if it is not a
+    // compressed file
+
+    TString name(fname);
+    for( const auto& c : Decompressors() ) {
+      if( name.EndsWith(c.first.c_str()) )
+        return c.second.c_str();
+    }
+    return "";
+  }
+
+//_____________________________________________________________________________
+  void THaCodaFile::SetFollow( Bool_t enable, Double_t idle, Double_t wait )
+  {
+    // Follow mode for files that are still being written, e.g. by the DAQ.
+    // At the end of the file, codaRead() waits for more data to be
+    // appended and continues with them, like "tail -f". On Linux, the
+    // file is watched with inotify, so waiting costs no CPU time.
+    //
+    // idle: end of file is reported once the file has not grown for this
+    //       many seconds (0 = never, i.e. follow until SetFollowEnd's file
+    //       appears or the analysis is stopped)
+    // wait: codaRead() waits at most this many seconds for new data and
+    //       then returns CODA_EMPTY, so that the caller can do periodic
+    //       work such as flushing its output
+    //
+    // Only local, uncompressed files can be followed. Follow mode
+    // disables zero-copy reading. Enabling takes effect at the next
+    // codaOpen(), disabling immediately.
+
+    fFollow = enable;
+    fFollowIdle = std::max(idle, 0.0);
+    fFollowWait = std::max(wait, 0.0);
+  }
+
+//_____________________________________________________________________________
+  Bool_t THaCodaFile::Follow( Int_t& status )
+  {
+    // Called in follow mode when a sequential read hit the current end of
+    // the file. Waits up to fFollowWait seconds for the file to grow, then
+    // reads the next event. Returns false if no new event is available
+    // yet. Returns true if 'status' holds the final status of the read:
+    // S_SUCCESS for a new event, EOF if the file is complete (idle timeout
+    // or fFollowEnd exists), or an EVIO error code.
+
+    Double_t start = Now();
+    while( true ) {
+      Long64_t size = GetFileSize(filename);
+      if( size < 0 )
+        return true;        // File is gone. Report original status
+      if( size > fFollowSize ) {
+        fLastGrowth = Now();
+        status = Reopen();
+        if( status != S_SUCCESS )
+          return true;
+        status = ReadSequential();
+        if( status != EOF && status != S_EVFILE_UNXPTDEOF )
+          return true;
+        // Only part of a block written so far
+      }
+      // Once the following segment exists, the DAQ has finished this file
+      if( !fFollowEnd.IsNull() &&
+          !gSystem->AccessPathName(fFollowEnd, kReadPermission) ) {
+        status = EOF;
+        return true;
+      }
+      Double_t now = Now();
+      if( fFollowIdle > 0 && now - fLastGrowth >= fFollowIdle ) {
+        status = EOF;
+        return true;
+      }
+      Double_t left = fFollowWait - (now - start);
+      if( left <= 0 )
+        return false;
+      WaitForChange(left);
+    }
+  }
+
+//_____________________________________________________________________________
+  Int_t THaCodaFile::Reopen()
+  {
+    // Reopen the followed file to see the data appended since it was last
+    // opened, and skip the events already read. EVIO cannot resume reading
+    // at the end of a file, hence this approach. The events are skipped
+    // at the speed of reading from the page cache. Returns EVIO status.
+
+    UInt_t nread = fSeqNext;
+    if( handle ) {
+      evClose(handle);
+      handle = 0;
+    }
+    fFollowSize = GetFileSize(filename);
+    Int_t status = evOpen((char*)filename.Data(), (char*)"r", &handle);
+    if( status != S_SUCCESS ) {
+      handle = 0;
+      return status;
+    }
+    for( UInt_t i = 0; i < nread; ++i ) {
+      status = ReadSequential();
+      if( status != S_SUCCESS ) {
+        cerr << "THaCodaFile ERROR: followed file " << filename << " "
+             << "has fewer events than already read. Truncated?" << endl;
+        return (status == EOF) ? S_EVFILE_UNXPTDEOF : status;
+      }
+    }
+    return S_SUCCESS;
+  }
+
+//_____________________________________________________________________________
+  void THaCodaFile::StartWatch()
+  {
+    // Watch the followed file for modifications, if supported
+
+    StopWatch();
+#ifdef __linux__
+    fNotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if( fNotifyFd < 0 )
+      return;
+    if( inotify_add_watch(fNotifyFd, filename.Data(),
+                          IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+                          IN_MOVE_SELF | IN_DELETE_SELF) < 0 ) {
+      close(fNotifyFd);
+      fNotifyFd = -1;
+    }
+#endif
+  }
+
+//_____________________________________________________________________________
+  void THaCodaFile::StopWatch()
+  {
+#ifdef __linux__
+    if( fNotifyFd >= 0 )
+      close(fNotifyFd);
+#endif
+    fNotifyFd = -1;
+  }
+
+//_____________________________________________________________________________
+  void THaCodaFile::WaitForChange( Double_t timeout )
+  {
+    // Wait up to 'timeout' seconds for the followed file to change. Without
+    // inotify, sleep for a fraction of a second; the caller checks the
+    // file size.
+
+    static const Double_t kPollInterval = 0.2;
+#ifdef __linux__
+    if( fNotifyFd >= 0 ) {
+      pollfd pfd{};
+      pfd.fd = fNotifyFd;
+      pfd.events = POLLIN;
+      int ms = static_cast<int>(timeout*1e3) + 1;
+      if( poll(&pfd, 1, ms) > 0 ) {
+        // Discard the events; only the file size matters
+        alignas(inotify_event) char buf[4096];
+        while( read(fNotifyFd, buf, sizeof(buf)) > 0 ) {}
+      }
+      return;
+    }
+#endif
+    Double_t t = std::min(timeout, kPollInterval);
+    std::this_thread::sleep_for(std::chrono::duration<Double_t>(t));
+  }
+
 //_____________________________________________________________________________
   void THaCodaFile::init(const char* fname) {
     if( filename != fname ) {
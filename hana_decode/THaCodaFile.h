@@ -20,6 +20,8 @@
 #include "THaCodaData.h"
 #include "Decoder.h"
 #include <vector>
+#include <cstdint>
+#include <atomic>
 
 namespace Decoder {
 
@@ -43,6 +45,50 @@ public:
   void  setMaxEvFilt(UInt_t max_event);        // max num events to filter
   virtual bool isOpen() const;
 
+  // Event index for random access
+  Int_t  BuildIndex( Bool_t use_sidecar = true );
+  Bool_t HasIndex() const { return !fIndex.empty(); }
+  UInt_t GetNevents() const { return fIndex.size(); }
+  Int_t  Seek( UInt_t ievent );
+  Int_t  SeekEvent( UInt_t evnum, Int_t evtype = -1 );
+  Int_t  WriteIndex( const char* idxfile = nullptr ) const;
+  Bool_t HasIndexFile() const;
+  // Bank tag (CODA 2: event type) of the event at index position 'ievent'
+  UInt_t GetEventTag( UInt_t ievent ) const
+  { return ievent < fIndex.size() ? fIndex[ievent].evtype : 0; }
+  // Position of the last event read (for Seek), kMaxUInt if unknown
+  UInt_t GetEventPos() const;
+  // Read only the events listed in an event list file (see THaFilter)
+  Int_t  ReadEventList( const char* evlistfile, Int_t run = -1 );
+  Int_t  SelectEvents( const std::vector<UInt_t>& positions );
+
+  // Block size for writing (32-bit words), before the first codaWrite
+  Int_t  SetWriteBlockSize( UInt_t nwords );
+
+  // Zero-copy reading from memory-mapped file
+  void   SetZeroCopy( Bool_t enable = true ) { fZeroCopy = enable; }
+  Bool_t IsZeroCopy() const { return fZeroCopy; }
+
+  // Byte swapping of files written on a host of the other byte order
+  void   SetFastSwap( Bool_t enable = true ) { fFastSwap = enable; }
+  Bool_t IsFastSwap() const { return fFastSwap; }
+  Bool_t IsSwapped() const  { return fSwapped; }
+  void   SetSwapRocs( const std::vector<UInt_t>& rocs );
+
+  // Follow a file that is still being written, like "tail -f"
+  void   SetFollow( Bool_t enable = true, Double_t idle = 0, Double_t wait = 1 );
+  void   SetFollowEnd( const char* nextfile ) { fFollowEnd = nextfile; }
+  Bool_t IsFollow() const { return fFollow; }
+
+  // Compressed and remote input files, read through external programs
+  Bool_t IsCompressed() const { return fCompressed; }
+  Bool_t IsRemote()     const { return fRemote; }
+  static void    SetDecompressor( const char* suffix, const char* command );
+  static TString GetDecompressor( const char* filename );
+  static void    SetStreamCommand( const char* prefix, const char* command );
+  static TString GetStreamCommand( const char* filename );
+  static TString GetInputCommand( const char* filename );
+
 private:
 
   void init(const char* fname="");
@@ -50,6 +96,52 @@ private:
   UInt_t maxflist,maxftype;
   std::vector<UInt_t> evlist, evtypes;
 
+  // Index entry for one event in the file
+  class IndexEntry {
+  public:
+    IndexEntry() : offset(0), evtype(0), evnum(0) {}
+    IndexEntry( ULong64_t _off, UInt_t _type, UInt_t _num )
+      : offset(_off), evtype(_type), evnum(_num) {}
+    ULong64_t offset;  // Offset of event from first event (32-bit words)
+    UInt_t    evtype;  // Event type (tag of event bank)
+    UInt_t    evnum;   // Event number from event ID bank (0 if none)
+  };
+  std::vector<IndexEntry> fIndex;     // Event index
+  Int_t                   fRAHandle;  // EVIO handle for random access
+  const uint32_t**        fRATable;   // Pointers to events (owned by EVIO)
+  UInt_t                  fRANevents; // Number of entries in fRATable
+  UInt_t                  fRANext;    // Next event to read via fRATable
+  Bool_t                  fUseRA;     // Read via fRATable (after Seek)
+  Bool_t                  fZeroCopy;  // Deliver events from mapped file
+  Bool_t                  fSwapped;   // File data are not in native byte order
+  Bool_t                  fFastSwap;  // Swap bytes ourselves, not via EVIO
+  std::atomic<UInt_t>     fSwapRocs;  // ROCs to swap in physics events (bits)
+  Bool_t                  fCompressed;// File is read through a decompressor
+  Bool_t                  fRemote;    // File is streamed from a URL
+  UInt_t                  fSeqNext;   // Position of next event (sequential)
+  std::vector<UInt_t>     fSelect;    // Positions of selected events
+  UInt_t                  fSelNext;   // Next entry of fSelect to read
+  Bool_t                  fFollow;    // Wait for data appended to the file
+  Double_t                fFollowIdle;// Follow: end after no growth for (s)
+  Double_t                fFollowWait;// Follow: max wait per codaRead (s)
+  TString                 fFollowEnd; // Follow: end once this file exists
+  Long64_t                fFollowSize;// Follow: file size when last opened
+  Double_t                fLastGrowth;// Follow: time file last grew (s)
+  Int_t                   fNotifyFd;  // Follow: inotify descriptor, or -1
+
+  Int_t  OpenRandomAccess();
+  void   CloseRandomAccess();
+  Int_t  ReadRandom( const uint32_t* evptr );
+  Bool_t IsForeignFile( const char* fname ) const;
+  Int_t  ReadSequential();
+  Bool_t Follow( Int_t& status );
+  Int_t  Reopen();
+  void   StartWatch();
+  void   StopWatch();
+  void   WaitForChange( Double_t timeout );
+  Int_t  ReadIndex( const char* idxfile );
+  TString IndexFileName() const;
+
   ClassDef(THaCodaFile,0)   //  File of CODA data
 
 };
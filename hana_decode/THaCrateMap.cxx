@@ -28,10 +28,12 @@
 #include <iomanip>
 #include <sstream>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <cstring>  // for strerror_r
 #include <memory>   // for unique_ptr
 #include <algorithm> // for std::find, std::sort
 #include <array>
+#include <type_traits>
 
 #define ALL(c) (c).begin(), (c).end()
 
@@ -42,6 +44,77 @@
 
 using namespace std;
 
+//_____________________________________________________________________________
+// Helpers for the binary crate map cache
+namespace {
+
+const char   kCacheMagic[8] = { 'P','O','D','D','C','M','A','P' };
+const UInt_t kCacheVersion  = 1;
+
+ULong64_t HashString( const string& s )
+{
+  // 64-bit FNV-1a hash of the given string
+  ULong64_t h = 14695981039346656037ULL;
+  for( unsigned char c : s ) {
+    h ^= c;
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+class CacheWriter {
+public:
+  template<typename T> void put( T val ) {
+    static_assert(std::is_arithmetic<T>::value, "arithmetic type required");
+    buf.append(reinterpret_cast<const char*>(&val), sizeof(T));
+  }
+  void put( const string& str ) {
+    put<UInt_t>(str.size());
+    buf.append(str);
+  }
+  void put( const vector<UInt_t>& v ) {
+    put<UInt_t>(v.size());
+    for( auto i : v ) put(i);
+  }
+  string buf;
+};
+
+class CacheReader {
+public:
+  explicit CacheReader( const string& b ) : buf(b), pos(0), good(true) {}
+  template<typename T> void get( T& val ) {
+    static_assert(std::is_arithmetic<T>::value, "arithmetic type required");
+    if( !check(sizeof(T)) ) return;
+    memcpy(&val, buf.data()+pos, sizeof(T));
+    pos += sizeof(T);
+  }
+  void get( string& str ) {
+    UInt_t n = 0; get(n);
+    if( !check(n) ) return;
+    str.assign(buf, pos, n);
+    pos += n;
+  }
+  void get( vector<UInt_t>& v ) {
+    UInt_t n = 0; get(n);
+    if( !check(size_t(n)*sizeof(UInt_t)) ) return;
+    v.resize(n);
+    for( auto& i : v ) get(i);
+  }
+  bool ok() const { return good; }
+  bool atEnd() const { return pos == buf.size(); }
+private:
+  bool check( size_t n ) {
+    if( good && n > buf.size()-pos )
+      good = false;
+    return good;
+  }
+  const string& buf;
+  size_t pos;
+  bool   good;
+};
+
+} // end anonymous namespace
+
 //_____________________________________________________________________________
 static string StrError()
 {
@@ -66,8 +139,12 @@ const UInt_t THaCrateMap::MAXDATA = 65536;
 const Int_t  THaCrateMap::CM_OK = 1;
 const Int_t  THaCrateMap::CM_ERR = -1;
 
+string THaCrateMap::fgCacheDir;
+bool   THaCrateMap::fgCacheDirSet = false;
+
 //_____________________________________________________________________________
 THaCrateMap::THaCrateMap( const char* db_filename )
+  : fInitTloc(0), fInitOK(false)
 {
   // Construct uninitialized crate map. The argument is the name of
   // the database file to use for initialization
@@ -244,6 +321,13 @@ int THaCrateMap::init( FILE* fi, const char* fname )
         fname, StrError().c_str() );
     return CM_ERR;
   }
+  // Modification time and size of the file, part of the cache key
+  Long64_t mtime = 0, size = 0;
+  struct stat st;
+  if( fstat(fileno(fi), &st) == 0 ) {
+    mtime = st.st_mtime;
+    size  = st.st_size;
+  }
   // Build the string to parse
   string db;
   if( readFile(fi, db) != CM_OK || ferror(fi) ) {
@@ -254,8 +338,203 @@ int THaCrateMap::init( FILE* fi, const char* fname )
   }
   fclose(fi);
 
+  // If a cache directory is configured, try to load the already parsed
+  // crate map from there. The cache entry is keyed by the hash of the file
+  // contents and is only accepted if the file's time stamp and size, as well
+  // as the contents of any included module database files, are unchanged.
+  ULong64_t hash = HashString(db);
+  string cachefile = cacheFileName(hash);
+  if( !cachefile.empty() && readCache(cachefile, hash, mtime, size) == CM_OK )
+    return CM_OK;
+
   // Parse the crate map definition
-  return init(db);
+  Int_t ret = init(db);
+  if( ret == CM_OK && !cachefile.empty() &&
+      writeCache(cachefile, hash, mtime, size) != CM_OK ) {
+    ::Warning( here, "Cannot write crate map cache file %s: %s",
+               cachefile.c_str(), StrError().c_str() );
+  }
+  return ret;
+}
+
+//_____________________________________________________________________________
+void THaCrateMap::SetCacheDir( const char* dir )
+{
+  // Set directory for binary crate map caches. Caching is disabled if 'dir'
+  // is null or empty. Overrides the environment variable
+  // ANALYZER_CRATEMAP_CACHE.
+
+  fgCacheDir = dir ? dir : "";
+  fgCacheDirSet = true;
+}
+
+//_____________________________________________________________________________
+const char* THaCrateMap::GetCacheDir()
+{
+  // Directory for binary crate map caches. Empty if caching is disabled.
+
+  if( !fgCacheDirSet ) {
+    const char* dir = gSystem->Getenv("ANALYZER_CRATEMAP_CACHE");
+    fgCacheDir = dir ? dir : "";
+    fgCacheDirSet = true;
+  }
+  return fgCacheDir.c_str();
+}
+
+//_____________________________________________________________________________
+string THaCrateMap::cacheFileName( ULong64_t hash ) const
+{
+  // Name of the cache file for the crate map text with the given hash.
+  // Returns an empty string if caching is disabled.
+
+  string dir = GetCacheDir();
+  if( dir.empty() )
+    return dir;
+  string name = fDBfileName;
+  auto pos = name.find_last_of('/');
+  if( pos != string::npos )
+    name.erase(0, pos+1);
+  ostringstream ostr;
+  ostr << dir << "/db_" << name << "." << hex << setfill('0') << setw(16)
+       << hash << ".cmap";
+  return ostr.str();
+}
+
+//_____________________________________________________________________________
+Int_t THaCrateMap::readCache( const string& path, ULong64_t hash,
+                              Long64_t mtime, Long64_t size )
+{
+  // Load the parsed crate map from binary cache file 'path'. Returns CM_ERR,
+  // leaving this object unchanged, if the file does not exist or does not
+  // match the given key.
+
+  const char* const here = "THaCrateMap::readCache";
+
+  FILE* fi = fopen(path.c_str(), "rb");
+  if( !fi )
+    return CM_ERR;
+  string buf;
+  Int_t st = readFile(fi, buf);
+  fclose(fi);
+  if( st != CM_OK || buf.size() < sizeof(kCacheMagic) ||
+      buf.compare(0, sizeof(kCacheMagic), kCacheMagic, sizeof(kCacheMagic)) )
+    return CM_ERR;
+
+  CacheReader r(buf.substr(sizeof(kCacheMagic)));
+  UInt_t version = 0, maxroc = 0, maxslot = 0;
+  ULong64_t chash = 0;
+  Long64_t cmtime = 0, csize = 0;
+  r.get(version); r.get(maxroc); r.get(maxslot);
+  r.get(chash); r.get(cmtime); r.get(csize);
+  if( !r.ok() || version != kCacheVersion || maxroc != MAXROC ||
+      maxslot != MAXSLOT || chash != hash || cmtime != mtime || csize != size )
+    return CM_ERR;
+
+  // Any module database files must be unchanged, too
+  vector<DepFile_t> deps;
+  UInt_t ndeps = 0; r.get(ndeps);
+  for( UInt_t i = 0; i < ndeps && r.ok(); ++i ) {
+    string name; ULong64_t dhash = 0;
+    r.get(name); r.get(dhash);
+    FILE* df = Podd::OpenDBFile(name.c_str(), fInitTime, here);
+    if( !df )
+      return CM_ERR;
+    string text;
+    st = readFile(df, text);
+    fclose(df);
+    if( st != CM_OK || HashString(text) != dhash )
+      return CM_ERR;
+    deps.emplace_back(name, dhash);
+  }
+
+  vector<UInt_t> ucrates;
+  r.get(ucrates);
+  UInt_t ncrates = 0; r.get(ncrates);
+  if( !r.ok() || ncrates != MAXROC )
+    return CM_ERR;
+  vector<CrateInfo_t> cdat(ncrates);
+  for( auto& cr : cdat ) {
+    Int_t code = kUnknown;
+    UChar_t used = 0, bank_structure = 0;
+    r.get(code);
+    r.get(cr.crate_type_name);
+    r.get(cr.scalerloc);
+    r.get(used); r.get(bank_structure);
+    r.get(cr.used_slots);
+    cr.crate_code = static_cast<ECrateCode>(code);
+    cr.crate_used = used;
+    cr.bank_structure = bank_structure;
+    for( auto& slt : cr.sltdat ) {
+      UChar_t sused = 0, sclear = 0;
+      r.get(slt.model); r.get(slt.header); r.get(slt.headmask);
+      r.get(slt.bank); r.get(slt.nchan); r.get(slt.ndata);
+      r.get(slt.cfgstr);
+      r.get(sused); r.get(sclear);
+      slt.used = sused;
+      slt.clear = sclear;
+    }
+    if( !r.ok() )
+      return CM_ERR;
+  }
+  if( !r.ok() || !r.atEnd() )
+    return CM_ERR;
+
+  crdat.swap(cdat);
+  used_crates.swap(ucrates);
+  fDepFiles.swap(deps);
+  return CM_OK;
+}
+
+//_____________________________________________________________________________
+Int_t THaCrateMap::writeCache( const string& path, ULong64_t hash,
+                               Long64_t mtime, Long64_t size ) const
+{
+  // Write the parsed crate map to binary cache file 'path'. The file is
+  // written under a temporary name and then renamed, so concurrent jobs
+  // never see a partially written cache.
+
+  CacheWriter w;
+  w.buf.assign(kCacheMagic, sizeof(kCacheMagic));
+  w.put(kCacheVersion);
+  w.put<UInt_t>(MAXROC);
+  w.put<UInt_t>(MAXSLOT);
+  w.put(hash); w.put(mtime); w.put(size);
+  w.put<UInt_t>(fDepFiles.size());
+  for( const auto& dep : fDepFiles ) {
+    w.put(dep.name);
+    w.put(dep.hash);
+  }
+  w.put(used_crates);
+  w.put<UInt_t>(crdat.size());
+  for( const auto& cr : crdat ) {
+    w.put<Int_t>(cr.crate_code);
+    w.put(cr.crate_type_name);
+    w.put(cr.scalerloc);
+    w.put<UChar_t>(cr.crate_used);
+    w.put<UChar_t>(cr.bank_structure);
+    w.put(cr.used_slots);
+    for( const auto& slt : cr.sltdat ) {
+      w.put(slt.model); w.put(slt.header); w.put(slt.headmask);
+      w.put(slt.bank); w.put(slt.nchan); w.put(slt.ndata);
+      w.put(slt.cfgstr);
+      w.put<UChar_t>(slt.used);
+      w.put<UChar_t>(slt.clear);
+    }
+  }
+
+  ostringstream tmpname;
+  tmpname << path << ".tmp" << getpid();
+  errno = 0;
+  FILE* fo = fopen(tmpname.str().c_str(), "wb");
+  if( !fo )
+    return CM_ERR;
+  size_t nwr = fwrite(w.buf.data(), 1, w.buf.size(), fo);
+  if( fclose(fo) != 0 || nwr != w.buf.size() ||
+      rename(tmpname.str().c_str(), path.c_str()) != 0 ) {
+    remove(tmpname.str().c_str());
+    return CM_ERR;
+  }
+  return CM_OK;
 }
 
 //_____________________________________________________________________________
@@ -266,8 +545,11 @@ int THaCrateMap::init(ULong64_t tloc)
 
   const char* const here = "THaCrateMap::init(tloc)";
   fInitTime = tloc;
+  fInitTloc = tloc;
   FILE* fi = Podd::OpenDBFile(fDBfileName.c_str(), fInitTime, here, "r", 1);
-  return init(fi, fDBfileName.c_str());
+  int ret = init(fi, fDBfileName.c_str());
+  fInitOK = (ret == CM_OK);
+  return ret;
 }
 
 //_____________________________________________________________________________
@@ -334,6 +616,7 @@ Int_t THaCrateMap::loadConfig( string& line, string& cfgstr )
         return CM_ERR;
       }
       fclose(fi);
+      fDepFiles.emplace_back(fname, HashString(cfgstr));
       line.erase(pos2);
     }
     Podd::Trim(cfgstr);
@@ -360,6 +643,7 @@ int THaCrateMap::init(const string& the_map)
   crdat.clear();   // support re-init
   crdat.resize(ncrates);
   used_crates.clear(); used_crates.reserve(ncrates/2);
+  fDepFiles.clear();
 
   UInt_t crate = kMaxUInt; // current CRATE
   string line; line.reserve(128);
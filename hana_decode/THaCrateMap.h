@@ -27,6 +27,7 @@
 #include <string>
 #include <vector>
 #include <array>
+#include <utility>
 
 namespace Decoder {
 
@@ -73,6 +74,13 @@ class THaCrateMap {
      static const Int_t CM_ERR;
 
      const char* GetName() const { return fDBfileName.c_str(); }
+     // True if successfully initialized by init(tloc) for this time stamp
+     bool IsInitFor( ULong64_t tloc ) const { return fInitOK && fInitTloc == tloc; }
+
+     // Directory for binary caches of parsed crate maps. Empty = no caching.
+     // Defaults to $ANALYZER_CRATEMAP_CACHE.
+     static void        SetCacheDir( const char* dir );
+     static const char* GetCacheDir();
 
  private:
 
@@ -80,6 +88,8 @@ class THaCrateMap {
 
      std::string fDBfileName;       // Database file name
      TDatime     fInitTime;         // Database time stamp
+     ULong64_t   fInitTloc;         // Argument of last init(tloc)
+     bool        fInitOK;           // Last init(tloc) succeeded
 
      class SlotInfo_t {
      public:
@@ -112,6 +122,19 @@ class THaCrateMap {
 
      std::vector<UInt_t> used_crates;
 
+     // Module database files read via "dbfile:" during parsing, together
+     // with the hash of their contents. Needed to validate cache entries.
+     class DepFile_t {
+     public:
+       DepFile_t( std::string n, ULong64_t h ) : name(std::move(n)), hash(h) {}
+       std::string name;
+       ULong64_t   hash;
+     };
+     std::vector<DepFile_t> fDepFiles;
+
+     static std::string fgCacheDir;
+     static bool        fgCacheDirSet;
+
      Int_t  loadConfig( std::string& line, std::string& cfgstr );
      Int_t  setCrateType( UInt_t crate, const char* stype ); // set the crate type
      Int_t  setModel( UInt_t crate, UInt_t slot, Int_t mod,
@@ -122,6 +145,12 @@ class THaCrateMap {
 
      static Int_t readFile( FILE* fi, std::string& text );
 
+     std::string cacheFileName( ULong64_t hash ) const;
+     Int_t  readCache( const std::string& path, ULong64_t hash,
+                       Long64_t mtime, Long64_t size );
+     Int_t  writeCache( const std::string& path, ULong64_t hash,
+                        Long64_t mtime, Long64_t size ) const;
+
      ClassDef(THaCrateMap,0) // Map of modules in DAQ crates
 };
 
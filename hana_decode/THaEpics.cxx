@@ -11,9 +11,11 @@
 //   All data are received as characters and are parsed.
 //   'tags' remain characters, 'values' are either character 
 //   or double, and 'units' are characters.
-//   Data are stored in an STL map and retrievable by
-//   'tag' (e.g. IPM1H04B.XPOS) and by proximity to
-//   a physics event number (closest one is picked).
+//   Data are stored per tag in arrays sorted by event number and
+//   retrievable by 'tag' (e.g. IPM1H04B.XPOS), or by the tag's id
+//   (see GetTagId), and by proximity to a physics event number
+//   (closest one is picked). Optionally, only the most recent
+//   entries of each tag are kept (SetMaxHistory).
 //
 //   Replaces THaEpicsStack (obsolete)
 //
@@ -24,10 +26,16 @@
 #include "THaEpics.h"
 #include <iostream>
 #include <string>
-#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <cerrno>
 
 using namespace std;
 
+#define ALL(c) (c).begin(), (c).end()
+
 static int DEBUGL = 0;
 
 namespace Decoder {
@@ -35,20 +43,14 @@ namespace Decoder {
 void THaEpics::Print() {
   cout << "\n\n====================== \n";
   cout << "Print of Epics Data : "<<endl;
-  Int_t j = 0;
-  for( auto& pm : epicsData ) {
-    const vector<EpicsChan>& vepics = pm.second;
-    const string& tag = pm.first;
-    j++;
-    cout << "\n\nEpics Var #" << j;
+  for( UInt_t j = 0; j < fTags.size(); j++ ) {
+    const History_t& vepics = fHist[j];
+    const string& tag = fTags[j];
+    cout << "\n\nEpics Var #" << j+1;
     cout << "   Var Name =  \""<<tag<<"\""<<endl;
     cout << "Size of epics vector "<<vepics.size();
     for( const auto& chan : vepics ) {
       cout << "\n Tag = " << chan.GetTag();
-      //      if (strstr(vepics[k].GetTag().c_str(),"VMI3128")!=nullptr) {
-      //	cout << "\n GOT ONE "<<k<<endl;
-      //        exit(0);
-      //      }
       cout << "   Evnum = " << chan.GetEvNum();
       cout << "   Date = " << chan.GetDate();
       cout << "   Timestamp = " << chan.GetTimeStamp();
@@ -60,75 +62,178 @@ void THaEpics::Print() {
   }
 }
 
+UInt_t THaEpics::GetTagId( const char* tag ) const
+{
+  // Return the id of the Epics variable 'tag', or kMaxUInt if no data
+  // for it have been loaded
+  if( !tag ) return kMaxUInt;
+  auto it = fTagIndex.find(tag);
+  return (it != fTagIndex.end()) ? it->second : kMaxUInt;
+}
+
 Bool_t THaEpics::IsLoaded(const char* tag) const
 {
-  const vector<EpicsChan> ep = GetChan(tag);
-  return !ep.empty();
+  return GetTagId(tag) != kMaxUInt;
 }
 
 Double_t THaEpics::GetData ( const char* tag, UInt_t event) const
 {
-  const vector<EpicsChan> ep = GetChan(tag);
-  UInt_t k = FindEvent(ep, event);
-  if( k == kMaxUInt ) return 0;
-  return ep[k].GetData();
-}  
+  return GetData(GetTagId(tag), event);
+}
 
-string THaEpics::GetString ( const char* tag, UInt_t event) const
+const string& THaEpics::GetString ( const char* tag, UInt_t event) const
 {
-  const vector<EpicsChan> ep = GetChan(tag);
-  UInt_t k = FindEvent(ep, event);
-  if( k == kMaxUInt ) return "";
-  return ep[k].GetString();
-}  
+  return GetString(GetTagId(tag), event);
+}
 
 Double_t THaEpics::GetTimeStamp( const char* tag, UInt_t event) const
 {
-  const vector<EpicsChan> ep = GetChan(tag);
-  UInt_t k = FindEvent(ep, event);
-  if( k == kMaxUInt ) return 0;
-  return ep[k].GetTimeStamp();
+  return GetTimeStamp(GetTagId(tag), event);
+}
+
+Double_t THaEpics::GetData( UInt_t id, UInt_t event ) const
+{
+  const EpicsChan* ep = FindEntry(id, event);
+  return ep ? ep->GetData() : 0;
+}
+
+const string& THaEpics::GetString( UInt_t id, UInt_t event ) const
+{
+  // The returned reference is valid until the next call to LoadData
+
+  static const string kEmpty;
+  const EpicsChan* ep = FindEntry(id, event);
+  return ep ? ep->GetString() : kEmpty;
 }
 
-vector<EpicsChan> THaEpics::GetChan(const char *tag) const
+Double_t THaEpics::GetTimeStamp( UInt_t id, UInt_t event ) const
 {
-  // Return the vector of Epics data for 'tag' 
-  // where 'tag' is the name of the Epics variable.
-  vector<EpicsChan> ep;
-  ep.clear();
-  auto pm = epicsData.find(string(tag));
-  if (pm != epicsData.end()) ep = pm->second;
-  return ep;
+  const EpicsChan* ep = FindEntry(id, event);
+  return ep ? ep->GetTimeStamp() : 0;
 }
 
+void THaEpics::SetMaxHistory( UInt_t n )
+{
+  // Keep at most the 'n' most recent entries (by event number) of each
+  // Epics variable. n = 0 means no limit. Older entries are discarded.
+  fMaxHist = n;
+  if( fMaxHist == 0 ) return;
+  for( auto& h : fHist ) {
+    if( h.size() > fMaxHist )
+      h.erase(h.begin(), h.end() - fMaxHist);
+  }
+}
 
-UInt_t THaEpics::FindEvent( const vector<EpicsChan>& ep, UInt_t event )
+UInt_t THaEpics::InternTag( const string& tag )
 {
-  // Return the index in the vector of Epics data 
-  // nearest in event number to event 'event'.
+  // Return the id of 'tag', assigning a new one if 'tag' is not yet known
+  auto ins = fTagIndex.emplace(tag, static_cast<UInt_t>(fTags.size()));
+  if( ins.second ) {
+    fTags.push_back(tag);
+    fHist.emplace_back();
+  }
+  return ins.first->second;
+}
+
+void THaEpics::AddEntry( UInt_t id, EpicsChan&& chan )
+{
+  // Add 'chan' to the history of variable 'id', keeping the history sorted
+  // by event number, and apply the retention limit
+  History_t& h = fHist[id];
+  if( h.empty() || h.back().GetEvNum() <= chan.GetEvNum() )
+    h.push_back(std::move(chan));
+  else {
+    auto pos = upper_bound(ALL(h), chan.GetEvNum(),
+      []( UInt_t ev, const EpicsChan& c ) { return ev < c.GetEvNum(); });
+    h.insert(pos, std::move(chan));
+  }
+  if( fMaxHist > 0 && h.size() > fMaxHist )
+    h.pop_front();
+}
+
+const EpicsChan* THaEpics::FindEntry( UInt_t id, UInt_t event ) const
+{
+  // Entry of variable 'id' nearest in event number to 'event'
+  if( id >= fHist.size() ) return nullptr;
+  size_t k = FindEvent(fHist[id], event);
+  return (k != kMaxUInt) ? &fHist[id][k] : nullptr;
+}
+
+size_t THaEpics::FindEvent( const History_t& ep, UInt_t event )
+{
+  // Return the index in the event-sorted history 'ep' of the entry
+  // nearest in event number to event 'event'. If two entries are equally
+  // near, return the earlier one. event = 0 means the most recent entry.
   if (ep.empty())
     return kMaxUInt;
-  UInt_t myidx = ep.size()-1;
-  if (event == 0) return myidx;  // return last event 
-  Long64_t min = 9999999;
-  for( size_t k = 0; k < ep.size(); k++ ) {
-    Long64_t diff = event - ep[k].GetEvNum();
-    if( diff < 0 ) diff = -diff;
-    if( diff < min ) {
-      min = diff;
-      myidx = k;
-    }
-  }
-  return myidx;
+  if (event == 0) return ep.size()-1;  // return last event
+  auto hi = lower_bound(ALL(ep), event,
+    []( const EpicsChan& c, UInt_t ev ) { return c.GetEvNum() < ev; });
+  if( hi == ep.begin() )
+    return 0;
+  auto lo = hi - 1;
+  if( hi != ep.end() && hi->GetEvNum() - event < event - lo->GetEvNum() )
+    return hi - ep.begin();
+  // First of possibly several entries for the same event
+  UInt_t lo_ev = lo->GetEvNum();
+  lo = lower_bound(ep.begin(), hi, lo_ev,
+    []( const EpicsChan& c, UInt_t ev ) { return c.GetEvNum() < ev; });
+  return lo - ep.begin();
+}
+
+
+// Helpers for parsing the EPICS text buffer in place
+
+// Whitespace as recognized by istream
+static inline bool IsSpace( char c )
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' ||
+    c == '\r';
+}
+
+// Find next whitespace-delimited token in [p,end), starting at p.
+// On return, [tok,p) is the token (empty if none).
+static inline const char* NextToken( const char*& p, const char* end )
+{
+  while( p != end && IsSpace(*p) ) ++p;
+  const char* tok = p;
+  while( p != end && !IsSpace(*p) ) ++p;
+  return tok;
+}
+
+// Convert the leading part of token [p,p+len) to a double, like
+// istream >> double. Returns false if it does not start with a number.
+static bool ParseDouble( const char* p, size_t len, Double_t& val )
+{
+  const size_t MAX_VAL_LEN = 32;
+  if( len == 0 || len > MAX_VAL_LEN )
+    return false;
+  // Reject what istream would not parse, e.g. "nan", "inf", "0x1p3"
+  const char* q = p;
+  if( *q == '+' || *q == '-' ) ++q;
+  if( q == p+len || !(isdigit(*q) || *q == '.') )
+    return false;
+  char buf[MAX_VAL_LEN+1];
+  memcpy(buf, p, len);
+  buf[len] = 0;
+  if( len > static_cast<size_t>(q-p) + 1 && buf[q-p] == '0' &&
+      (buf[q-p+1] == 'x' || buf[q-p+1] == 'X') )
+    return false;
+  char* e = nullptr;
+  errno = 0;
+  val = strtod(buf, &e);
+  return e != buf && errno != ERANGE;
 }
-        
 
 int THaEpics::LoadData( const UInt_t* evbuffer, UInt_t event)
 { 
   // load data from the event buffer 'evbuffer' 
   // for event nearest 'evnum'.
-
-  const string::size_type MAX_VAL_LEN = 32;
+  //
+  // The text is parsed in place, line by line: the first line is the time
+  // stamp, each following line is "tag value [units]". If 'value' does not
+  // start with a number, the rest of the line after the tag is taken as
+  // the (string) value.
 
   const char* cbuff = (const char*)evbuffer;
   size_t len = sizeof(UInt_t)*(evbuffer[0]+1);
@@ -137,51 +242,50 @@ int THaEpics::LoadData( const UInt_t* evbuffer, UInt_t event)
   // The first 16 bytes of the buffer are the event header
   len -= 16;
   cbuff += 16;
-  
-  // Copy data to internal string buffer
-  string buf( cbuff, len );
+  const char* const end = cbuff + len;
 
   // The first line is the time stamp
-  string date;
-  istringstream ib(buf);
-  if( !getline(ib,date) || date.size() < 16 ) {
+  const char* p = cbuff;
+  const char* eol = static_cast<const char*>(memchr(p, '\n', end-p));
+  if( !eol ) eol = end;
+  if( eol - p < 16 ) {
     cerr << "Invalid time stamp for EPICS event at evnum = " << event << endl;
     return 0;
   }
+  string date(p, eol);
   if(DEBUGL>1) cout << "Timestamp: " << date <<endl;
 
-  string line;
-  istringstream il, iv;
-  while( getline(ib,line) ) {
+  string wval, wunits;
+  while( eol != end ) {
     // Here we parse each line
-    if(DEBUGL>2) cout << "epics line : "<<line<<endl;
-    il.clear(); il.str(line);
-    string wtag, wval, wunits;
-    il >> wtag;
-    if( wtag.empty() || wtag[0] == 0 ) continue;
-    istringstream::pos_type spos = il.tellg();
-    il >> wval;
+    p = eol + 1;
+    eol = static_cast<const char*>(memchr(p, '\n', end-p));
+    if( !eol ) eol = end;
+    if(DEBUGL>2) cout << "epics line : "<<string(p, eol)<<endl;
+    const char* tag = NextToken(p, eol);
+    if( tag == p || *tag == 0 ) continue;  // empty line or padding
+    fTagBuf.assign(tag, p);
+    const char* tagend = p;
+    const char* val = NextToken(p, eol);
     Double_t dval = 0;
-    bool got_val = false;
-    if( !wval.empty() && wval.length() <= MAX_VAL_LEN ) {
-      iv.clear(); iv.str(wval);
-      if( iv >> dval )
-        got_val = true;
-    }
-    if( got_val ) {
-      il >> wunits; // Assumes that wunits contains no whitespace
+    if( ParseDouble(val, p-val, dval) ) {
+      wval.assign(val, p);
+      const char* un = NextToken(p, eol); // Assumes that units contain no whitespace
+      wunits.assign(un, p);
     } else {
       // Mimic the old behavior: if the string doesn't convert to a number,
       // then wval = rest of string after tag, dval = 0, sunit = empty
-      string::size_type lpos = line.find_first_not_of(" \t",spos);
-      wval = ( lpos != string::npos ) ? line.substr(lpos) : "";
+      p = tagend;
+      while( p != eol && (*p == ' ' || *p == '\t') ) ++p;
+      wval.assign(p, eol);
+      wunits.clear();
       dval = 0;
     }
-    if(DEBUGL>2) cout << "wtag = "<<wtag<<"   wval = "<<wval
+    if(DEBUGL>2) cout << "wtag = "<<fTagBuf<<"   wval = "<<wval
 		      << "   dval = "<<dval<<"   wunits = "<<wunits<<endl;
 
     // Add tag/value/units to the EPICS data.    
-    epicsData[wtag].push_back( EpicsChan(wtag, date, event, wval, wunits, dval) );
+    AddEntry( InternTag(fTagBuf), EpicsChan(fTagBuf, date, event, wval, wunits, dval) );
   }
   if(DEBUGL) Print();
   return 1;
@@ -11,7 +11,8 @@
 
 #include "Rtypes.h"
 #include <string>
-#include <map>
+#include <unordered_map>
+#include <deque>
 #include <utility>
 #include <vector>
 //#include "Decoder.h"
@@ -38,7 +39,7 @@ public:
   std::string GetTag()       const { return tag;    };
   std::string GetDate()      const { return dtime;  };
   Double_t    GetTimeStamp() const { return timestamp; };
-  std::string GetString()    const { return svalue; };
+  const std::string& GetString() const { return svalue; };
   std::string GetUnits()     const { return units;  };
     
 private:
@@ -62,22 +63,44 @@ class THaEpics {
 
 public:
 
-   THaEpics() = default;
+   THaEpics() : fMaxHist(0) {}
    virtual ~THaEpics() = default;
 // Get tagged value nearest 'event'
    Double_t GetData( const char* tag, UInt_t event= 0 ) const;
 // Get tagged string value nearest 'event'
-   std::string GetString( const char* tag, UInt_t event= 0 ) const;
+   const std::string& GetString( const char* tag, UInt_t event= 0 ) const;
    Double_t GetTimeStamp( const char* tag, UInt_t event= 0 ) const;
    Int_t LoadData( const UInt_t* evbuffer, UInt_t event= 0 );  // load the data
    Bool_t IsLoaded(const char* tag) const;
    void Print();
 
+// Access by tag id. Ids stay valid for the lifetime of this object.
+   UInt_t GetTagId( const char* tag ) const;  // kMaxUInt if never loaded
+   UInt_t GetNtags() const { return fTags.size(); }
+   const std::string& GetTagName( UInt_t id ) const { return fTags.at(id); }
+   Bool_t IsLoaded( UInt_t id ) const { return id < fHist.size(); }
+   Double_t GetData( UInt_t id, UInt_t event= 0 ) const;
+   const std::string& GetString( UInt_t id, UInt_t event= 0 ) const;
+   Double_t GetTimeStamp( UInt_t id, UInt_t event= 0 ) const;
+
+// Maximum number of entries kept per tag (0 = unlimited)
+   void   SetMaxHistory( UInt_t n );
+   UInt_t GetMaxHistory() const { return fMaxHist; }
+
 private:
 
-   std::map< std::string, std::vector<EpicsChan> > epicsData;
-   std::vector<EpicsChan> GetChan(const char *tag) const;
-   static UInt_t FindEvent( const std::vector<EpicsChan>& ep, UInt_t event );
+   typedef std::deque<EpicsChan> History_t;  // Entries sorted by event number
+
+   std::vector<std::string>                fTags;     // Tag names [id]
+   std::unordered_map<std::string,UInt_t>  fTagIndex; // Tag name -> id
+   std::vector<History_t>                  fHist;     // History of each tag [id]
+   UInt_t                                  fMaxHist;  // Retention limit per tag
+   std::string                             fTagBuf;   // Scratch, for LoadData
+
+   UInt_t InternTag( const std::string& tag );
+   void   AddEntry( UInt_t id, EpicsChan&& chan );
+   const EpicsChan* FindEntry( UInt_t id, UInt_t event ) const;
+   static size_t FindEvent( const History_t& ep, UInt_t event );
 
    ClassDef(THaEpics,0)  // EPICS data
 
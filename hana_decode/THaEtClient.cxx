@@ -39,6 +39,7 @@ namespace Decoder {
 #define initflags \
 nread(0), nused(0), timeout(BIG_TIMEOUT),               \
 id(0), sconfig(0), my_stat(0), my_att(0), openconfig(0),\
+chunksize(ET_CHUNK_SIZE), zerocopy(false),              \
 daqhost(nullptr), session(nullptr), etfile(nullptr),    \
 waitflag(0), didclose(0), notopened(0), firstread(1),   \
 firstRateCalc(1), evsum(0), xcnt(0), daqt1(-1), ratesum(0)
@@ -136,6 +137,9 @@ Int_t THaEtClient::codaClose() {
   if (didclose || firstread) return CODA_OK;
   didclose = 1;
   if (notopened) return CODA_ERROR;
+  if (putEvents() != CODA_OK) {
+    cout << "ERROR: codaClose: returning events to ET"<<endl;
+  }
   if (et_station_detach(id, my_att) != ET_OK) {
     cout << "ERROR: codaClose: detaching from ET"<<endl;
     return CODA_ERROR;
@@ -152,8 +156,11 @@ Int_t THaEtClient::codaRead()
   //  Read a chunk of data, return read status (0 = ok, else not).
   //  To try to use network efficiently, it actually gets
   //  the events in chunks, and passes them to the user.
+  //  In zero-copy mode, getEvBuffer() points directly to the event in
+  //  ET memory, valid until the next call to codaRead(). The chunk is
+  //  returned to ET only when the next chunk is requested.
+  //  In poll mode (mode 2), returns CODA_EMPTY if no events are available.
 
-  et_event *evs[ET_CHUNK_SIZE];
   struct timespec twait;
   Int_t *data;
   Int_t err;
@@ -177,16 +184,29 @@ Int_t THaEtClient::codaRead()
     }
   }
 
-// pull out a ET_CHUNK_SIZE of events from ET
+// pull out a chunk of events from ET
   if (nused >= nread) {
+    // Return the previous chunk first, if still held (zero-copy mode)
+    if (putEvents() != CODA_OK) {
+      cout<<"THaEtClient::codaRead: ERROR: calling et_events_put"<<endl;
+      cout<<"This is potentially very bad !!\n"<<endl;
+      cout<<"best not continue.... exiting... \n"<<endl;
+      exit(1);
+    }
+    evs.resize(chunksize);
     if (waitflag == 0) {
-      err = et_events_get(id, my_att, evs, ET_SLEEP, nullptr, ET_CHUNK_SIZE, &nread);
+      err = et_events_get(id, my_att, evs.data(), ET_SLEEP, nullptr, chunksize, &nread);
+    } else if (waitflag == 2) {
+      err = et_events_get(id, my_att, evs.data(), ET_ASYNC, nullptr, chunksize, &nread);
     } else {
       twait.tv_sec  = timeout;
       twait.tv_nsec = 0;
-      err = et_events_get(id, my_att, evs, ET_TIMED, &twait, ET_CHUNK_SIZE, &nread);
+      err = et_events_get(id, my_att, evs.data(), ET_TIMED, &twait, chunksize, &nread);
     }
     if (err < ET_OK) {
+      nread = nused = 0;
+      if (waitflag == 2 && (err == ET_ERROR_EMPTY || err == ET_ERROR_BUSY))
+        return CODA_EMPTY;
       if (err == ET_ERROR_TIMEOUT) {
 	 printf("et_netclient: timeout calling et_events_get\n");
 	 printf("Probably means CODA is not running...\n");
@@ -194,7 +214,6 @@ Int_t THaEtClient::codaRead()
       else {
 	 printf("et_netclient: error calling et_events_get, %d\n", err);
       }
-      nread = nused = 0;
       return CODA_ERROR;
     }
 
@@ -217,7 +236,7 @@ Int_t THaEtClient::codaRead()
 #endif
       Int_t* pdata = data;
       Int_t event_size = *pdata + 1;
-      if ( event_size > MAXEVLEN ) {
+      if ( !zerocopy && event_size > MAXEVLEN ) {
          printf("\nET:codaRead:ERROR:  Event from ET truncated\n");
          printf("-> Need a larger value than MAXEVLEN = %d \n",MAXEVLEN);
          return CODA_ERROR;
@@ -248,7 +267,7 @@ Int_t THaEtClient::codaRead()
          if (CODA_VERBOSE)
            printf("ET rate %4.1f Hz in %2.0f sec, avg %4.1f Hz\n",
           	      daqrate, tdiff, avgrate);
-         if (waitflag != 0) {
+         if (waitflag == 1) {
            timeout = (avgrate > FAST) ? SMALL_TIMEOUT : BIG_TIMEOUT;
          }
          daqt1 = time(0);
@@ -258,6 +277,12 @@ Int_t THaEtClient::codaRead()
 
 // return an event
   et_event_getdata(evs[nused], (void **) &data);
+  if (zerocopy) {
+    fEvPtr = reinterpret_cast<const UInt_t*>(data);
+    nused++;
+    return CODA_OK;
+  }
+  fEvPtr = nullptr;
   et_event_getlength(evs[nused], &nbytes);
   lencpy = (nbytes < bpi*MAXEVLEN) ? nbytes : bpi*MAXEVLEN;
   memcpy(evbuffer.get(), data, lencpy);
@@ -270,8 +295,7 @@ Int_t THaEtClient::codaRead()
 
 // if we've used all our events, put them back
   if (nused >= nread) {
-    err = et_events_put(id, my_att, evs, nread);
-    if (err < ET_OK) {
+    if (putEvents() != CODA_OK) {
       cout<<"THaEtClient::codaRead: ERROR: calling et_events_put"<<endl;
       cout<<"This is potentially very bad !!\n"<<endl;
       cout<<"best not continue.... exiting... \n"<<endl;
@@ -281,6 +305,25 @@ Int_t THaEtClient::codaRead()
   return CODA_OK;
 }
 
+Int_t THaEtClient::putEvents()
+{
+  // Return the events of the current chunk to ET
+  if (nread <= 0)
+    return CODA_OK;
+  Int_t err = et_events_put(id, my_att, evs.data(), nread);
+  nread = nused = 0;
+  fEvPtr = nullptr;
+  return (err < ET_OK) ? CODA_ERROR : CODA_OK;
+}
+
+void THaEtClient::setChunkSize(Int_t n)
+{
+  // Set the number of events to get from ET at a time. Takes effect
+  // with the next chunk.
+  if (n > 0)
+    chunksize = n;
+}
+
 Int_t THaEtClient::codaOpen(const char* computer,
 			    const char* mysession,
 			    Int_t smode)
@@ -288,7 +331,8 @@ Int_t THaEtClient::codaOpen(const char* computer,
   // To run codaOpen, you need to know:
   // 1) What computer is ET running on ? (e.g. computer='adaql2')
   // 2) What session ? (usually env. variable $SESSION, e.g. 'onla')
-  // 3) mode (0 = wait forever for data,  1 = time-out in a few seconds)
+  // 3) mode (0 = wait forever for data,  1 = time-out in a few seconds,
+  //    2 = poll, i.e. codaRead returns CODA_EMPTY at once if no data)
   delete [] daqhost;
   delete [] session;
   delete [] etfile;
@@ -18,6 +18,7 @@
 
 #include "THaCodaData.h"
 #include <ctime>
+#include <vector>
 
 #define ET_CHUNK_SIZE 50
 #ifndef __CINT__
@@ -57,6 +58,13 @@ public:
     Int_t codaRead();            // codaRead() must be called once per event
     virtual bool isOpen() const;
 
+// Number of events to get from ET at a time (default ET_CHUNK_SIZE)
+    void   setChunkSize(Int_t n);
+    Int_t  getChunkSize() const { return chunksize; }
+// Hand out events directly from ET memory instead of copying them
+    void   setZeroCopy(Bool_t enable = true) { zerocopy = enable; }
+    Bool_t isZeroCopy() const { return zerocopy; }
+
 private:
 
     THaEtClient(const THaEtClient &fn);
@@ -68,10 +76,14 @@ private:
     et_stat_id my_stat;
     et_att_id my_att;
     et_openconfig openconfig;
+    std::vector<et_event*> evs;   // Events currently held from ET
 #endif
+    Int_t chunksize;
+    Bool_t zerocopy;
     char *daqhost,*session,*etfile;
     Int_t waitflag,didclose,notopened,firstread;
     Int_t init(const char* computer="hana_sta");
+    Int_t putEvents();
 
 // rate calculation
     Int_t firstRateCalc;
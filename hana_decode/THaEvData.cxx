@@ -24,6 +24,7 @@
 #include "THaSlotData.h"
 #include "THaCrateMap.h"
 #include "THaBenchmark.h"
+#include "Profiler.h"
 #include "TError.h"
 #include <cstdio>
 #include <cctype>
@@ -33,8 +34,10 @@
 #include <algorithm>
 #include <cassert>
 #include <utility>
+#include <mutex>
 #include <stdexcept>
 #include <sstream>
+#include <initializer_list>
 
 using namespace std;
 using namespace Decoder;
@@ -43,6 +46,7 @@ using namespace Decoder;
 
 // Instances of this object
 TBits THaEvData::fgInstances;
+static mutex gInstanceMutex;  // Protects fgInstances
 
 const Double_t THaEvData::kBig = 1e38;
 
@@ -54,6 +58,7 @@ Bool_t THaEvData::fgAllowUnimpl = true;
 #endif
 
 TString THaEvData::fgDefaultCrateMapName = "cratemap";
+const UShort_t THaEvData::kNoSlot;
 
 //_____________________________________________________________________________
 THaEvData::THaEvData() :
@@ -83,13 +88,19 @@ THaEvData::THaEvData() :
   synchmiss{false},
   synchextra{false},
   fDoBench{false},
-  fInstance{fgInstances.FirstNullBit()},
+  fInstance{0},
   fNeedInit{true},
+  fDemandOnly{false},
   fDebug{0},
   fExtra{nullptr}
 {
   fSlotUsed.reserve(MAXROC*MAXSLOT/4);  // Generous space for a typical setup
   fSlotClear.reserve(MAXROC*MAXSLOT/4);
+  fDenseIdx.assign(MAXROC*MAXSLOT, kNoSlot);
+  fActiveSlots.reserve(MAXROC*MAXSLOT/4);
+  fClearSlots.reserve(MAXROC*MAXSLOT/4);
+  lock_guard<mutex> lock(gInstanceMutex);
+  fInstance = fgInstances.FirstNullBit();
   fgInstances.SetBitNumber(fInstance);
   fInstance++;
 }
@@ -97,11 +108,12 @@ THaEvData::THaEvData() :
 //_____________________________________________________________________________
 THaEvData::~THaEvData() {
   if( fDoBench ) {
-    Float_t a,b;
-    fBench->Summary(a,b);
+    cout << "Decoder timing summary:" << endl;
+    fBench->Print();
   }
   delete fExtra;
   fInstance--;
+  lock_guard<mutex> lock(gInstanceMutex);
   fgInstances.ResetBitNumber(fInstance);
 }
 
@@ -112,6 +124,29 @@ const char* THaEvData::DevType( UInt_t crate, UInt_t slot) const {
     crateslot[idx(crate,slot)]->devType() : " ";
 }
 
+//_____________________________________________________________________________
+Int_t THaEvData::PeekEvent( const UInt_t* /*evbuffer*/,
+                            EvHeader_t& /*hdr*/ ) const
+{
+  // Get header information of the event in 'evbuffer' without decoding it.
+  // Allows callers to skip events without the cost of LoadEvent.
+  //
+  // This default version is not supported and returns HED_ERR. Callers
+  // must then always use LoadEvent.
+
+  return HED_ERR;
+}
+
+//_____________________________________________________________________________
+Int_t THaEvData::SkipEvent( const UInt_t* evbuffer )
+{
+  // Advance past the event in 'evbuffer' without decoding its data, keeping
+  // event counters etc. consistent. Derived classes whose PeekEvent is
+  // supported should override this. This default version decodes the event.
+
+  return LoadEvent(evbuffer);
+}
+
 //_____________________________________________________________________________
 Int_t THaEvData::Init()
 {
@@ -121,7 +156,7 @@ Int_t THaEvData::Init()
                                "Cannot continue. Fix database.");
     return ret;
   }
-  if( fDebugFile ) {
+  if( DEBUG_FILE(fDebugFile) ) {
     *fDebugFile << endl << " THaEvData:: Print of Crate Map" << endl;
     fMap->print(*fDebugFile);
   }
@@ -134,6 +169,20 @@ Int_t THaEvData::Init()
   return ret;
 }
 
+//_____________________________________________________________________________
+void THaEvData::SetDebugFile( std::ofstream* file )
+{
+  // Write decoder debug output to 'file'. The output is only compiled in
+  // tracing builds (see DEBUG_FILE in Decoder.h).
+
+#ifndef DECODER_TRACE
+  if( file )
+    ::Warning( "THaEvData::SetDebugFile", "Decoder debug tracing is not "
+               "compiled in. Rebuild with DECODER_TRACE to get debug output." );
+#endif
+  fDebugFile = file;
+}
+
 //_____________________________________________________________________________
 void THaEvData::SetRunTime( ULong64_t tloc )
 {
@@ -153,11 +202,12 @@ void THaEvData::EnableBenchmarks( Bool_t enable )
   fDoBench = enable;
   if( fDoBench ) {
     if( !fBench ) {
-#if __cplusplus >= 201402L
-      fBench = make_unique<THaBenchmark>();
-#else
-      fBench.reset(new THaBenchmark);
-#endif
+      fBench.reset(new Podd::Profiler("Decoder"));
+      // Register in the order of EBench so that handles equal enum values
+      for( const char* name : { "clearEvent", "roc_decode", "bank_decode",
+                                "physics_decode" } )
+        fBench->Register(name);
+      assert( fBench->GetSize() == kBenchPhysicsDecode+1 );
     }
   } else {
     fBench = nullptr;
@@ -178,6 +228,46 @@ void THaEvData::EnableScalers( Bool_t enable )
   SetBit(kScalersEnabled, enable);
 }
 
+//_____________________________________________________________________________
+void THaEvData::SetRocDemand( const vector<UInt_t>& rocs )
+{
+  // Decode only the given ROCs in physics events. The slots of all other
+  // ROCs are left empty. The raw data of all ROCs remain accessible
+  // (GetRawData etc.). THaAnalyzer sets this from the crates referenced
+  // by the analysis modules (see THaAnalyzer::EnableDemandDecoding).
+
+  fRocDemand.reset();
+  for( auto roc : rocs ) {
+    if( roc < MAXROC )
+      fRocDemand.set(roc);
+  }
+  fDemandOnly = true;
+}
+
+//_____________________________________________________________________________
+Int_t THaEvData::LoadRocs( const UInt_t* evbuffer, const vector<UInt_t>& rocs )
+{
+  // Load the event in 'evbuffer', decoding only the given ROCs. The ROC
+  // demand set with SetRocDemand, if any, is restored afterwards.
+
+  auto save_demand = fRocDemand;
+  Bool_t save_only = fDemandOnly;
+  SetRocDemand(rocs);
+  Int_t ret = LoadEvent(evbuffer);
+  fRocDemand = save_demand;
+  fDemandOnly = save_only;
+  return ret;
+}
+
+//_____________________________________________________________________________
+void THaEvData::ClearRocDemand()
+{
+  // Decode all ROCs (the default)
+
+  fRocDemand.reset();
+  fDemandOnly = false;
+}
+
 //_____________________________________________________________________________
 void THaEvData::SetVerbose( Int_t level )
 {
@@ -279,18 +369,61 @@ void THaEvData::SetCrateMapName( const char* name )
   }
 }
 
+//_____________________________________________________________________________
+Int_t THaEvData::ShareCrateMap( const THaEvData& other )
+{
+  // Use the crate map of decoder 'other', which must have been initialized.
+  // The crate map, including the module configurations it holds (firmware
+  // settings etc. from the database), is then parsed and stored only once
+  // for all decoders sharing it, e.g. the per-thread decoders of an
+  // event-parallel replay. Each decoder still has its own slot data and
+  // module objects for the per-event data.
+  //
+  // The shared map is modified only by Init() and SetRunTime() of the
+  // sharing decoders, so call these serially, before decoding events
+  // concurrently. Decoding only reads the crate map.
+  // Returns HED_OK on success, HED_ERR if 'other' has no crate map.
+
+  if( &other == this )
+    return HED_OK;
+  if( !other.fMap ) {
+    ::Error( "THaEvData::ShareCrateMap", "Source decoder has no crate "
+             "map. Initialize it first." );
+    return HED_ERR;
+  }
+  fMap = other.fMap;
+  fCrateMapName = fMap->GetName();
+  fRunTime = other.fRunTime;
+  fNeedInit = true;   // Set up slot data for the new map
+  return HED_OK;
+}
+
+//_____________________________________________________________________________
+Int_t THaEvData::ReloadCrateMap()
+{
+  // Re-read the crate map from the database for the current run time,
+  // e.g. after the crate map file has been edited, and set up the slot
+  // data for it. A new crate map object is made, so other decoders sharing
+  // the old map (see ShareCrateMap) keep using it. Call only between events.
+  // Returns HED_OK on success.
+
+  fMap.reset();
+  return Init();
+}
+
 //_____________________________________________________________________________
 // Set up and initialize the crate map
 int THaEvData::init_cmap()  {
   if( fCrateMapName.IsNull() )
     fCrateMapName = fgDefaultCrateMapName;
   // Make a new crate map object unless we already have one
-  if( !fMap || fCrateMapName != fMap->GetName() ) {
-#if __cplusplus >= 201402L
-    fMap = make_unique<THaCrateMap>(fCrateMapName);
-#else
-    fMap.reset(new THaCrateMap(fCrateMapName));
-#endif
+  if( !fMap || fCrateMapName != fMap->GetName() )
+    fMap = make_shared<THaCrateMap>(fCrateMapName);
+  // A crate map shared with other decoders is initialized only once
+  // for a given run time, by whichever decoder gets there first
+  if( fMap.use_count() > 1 && fMap->IsInitFor(GetRunTime()) ) {
+    fNeedInit = false;
+    return HED_OK;
   }
   // Initialize the newly created crate map
   if( fDebug>0 )
@@ -320,7 +453,7 @@ void THaEvData::makeidx( UInt_t crate, UInt_t slot )
            crateslot[idx]->getSlot() == slot);
   }
 #endif
-  if (fDebugFile) crateslot[idx]->SetDebugFile(fDebugFile);
+  if (DEBUG_FILE(fDebugFile)) crateslot[idx]->SetDebugFile(fDebugFile);
   if( !fMap ) return;
   if( fMap->crateUsed(crate) && fMap->slotUsed(crate,slot)) {
     crateslot[idx]
@@ -328,12 +461,19 @@ void THaEvData::makeidx( UInt_t crate, UInt_t slot )
 // ndata no longer used
 //    ->define( crate, slot, fMap->getNchan(crate,slot),
 //		fMap->getNdata(crate,slot) );
-    // Prevent duplicates in fSlotUsed and fSlotClear
-    if( find(ALL(fSlotUsed), idx) == fSlotUsed.end() )
+    // Prevent duplicates in fSlotUsed and fSlotClear. Keep the dense
+    // tables current for slots activated while decoding; init_slotdata
+    // re-sorts them.
+    if( find(ALL(fSlotUsed), idx) == fSlotUsed.end() ) {
       fSlotUsed.push_back(idx);
+      fDenseIdx[idx] = fActiveSlots.size();
+      fActiveSlots.push_back(crateslot[idx].get());
+    }
     if( fMap->slotClear(crate,slot) &&
-        find(ALL(fSlotClear), idx) == fSlotClear.end() )
+        find(ALL(fSlotClear), idx) == fSlotClear.end() ) {
       fSlotClear.push_back(idx);
+      fClearSlots.push_back(crateslot[idx].get());
+    }
     if( crateslot[idx]->loadModule(fMap.get()) != SD_OK ) {
       ostringstream ostr;
       ostr << "Failed to initialize decoder for crate " << crate << " "
@@ -349,6 +489,80 @@ void THaEvData::PrintOut() const {
   cout << "THaEvData::PrintOut() called" << endl;
 }
 
+//_____________________________________________________________________________
+size_t THaEvData::GetCapacity() const
+{
+  // Memory reserved for the per-event data of all slots and their modules
+  // (bytes). Once this stays constant from event to event, decoding is
+  // done without heap allocations.
+
+  size_t n = 0;
+  for( const auto& sd : crateslot ) {
+    if( sd )
+      n += sd->GetCapacity();
+  }
+  return n;
+}
+
+//_____________________________________________________________________________
+void THaEvData::PrintSlotMemory( std::ostream& os ) const
+{
+  // Print the memory used by the hit arrays of each active slot, to help
+  // identify crate map entries with far more channels than are used
+  // (see THaSlotData::define)
+
+  os << "crate slot   nchan  nalloc   maxhits   datacap       bytes" << endl;
+  for( const auto* sd : fActiveSlots )
+    sd->printMemory(os);
+  os << "Total " << GetCapacity() << " bytes in " << fActiveSlots.size()
+     << " slots" << endl;
+}
+
+//_____________________________________________________________________________
+void THaEvData::PackSlotData()
+{
+  // Lay out the hits of all slots cleared for this event contiguously per
+  // channel (see THaSlotData::pack). Decoders should call this once the
+  // event has been fully loaded, so that detectors only read the packed
+  // arrays.
+
+  for( auto* sd : fClearSlots )
+    sd->pack();
+}
+
+//_____________________________________________________________________________
+void THaEvData::ClearSlotData()
+{
+  // Reset the hit data of all slots marked to be cleared each event.
+  // Uses the flat list of slot pointers rather than looking up each entry
+  // in the sparse crateslot[] array.
+
+  for( auto* sd : fClearSlots )
+    sd->clearEvent();
+}
+
+//_____________________________________________________________________________
+void THaEvData::BuildSlotIndex()
+{
+  // Rebuild the dense tables of active slots from fSlotUsed and fSlotClear.
+  // The active slots are ordered by crate and slot number.
+
+  fDenseIdx.assign(crateslot.size(), kNoSlot);
+  fActiveSlots.clear();
+  fClearSlots.clear();
+  sort(ALL(fSlotUsed));
+  sort(ALL(fSlotClear));
+  for( auto i : fSlotUsed ) {
+    assert(crateslot[i]);
+    fDenseIdx[i] = fActiveSlots.size();
+    fActiveSlots.push_back(crateslot[i].get());
+  }
+  for( auto i : fSlotClear ) {
+    assert(crateslot[i]);
+    fClearSlots.push_back(crateslot[i].get());
+  }
+}
+
 //_____________________________________________________________________________
 void THaEvData::PrintSlotData( UInt_t crate, UInt_t slot) const {
   // Print the contents of (crate, slot).
@@ -383,6 +597,7 @@ int THaEvData::init_slotdata()
     } else
       ++it;
   }
+  BuildSlotIndex();
   return HED_OK;
 }
 
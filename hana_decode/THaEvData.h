@@ -13,15 +13,19 @@
 #include "TObject.h"
 #include "TString.h"
 #include "THaSlotData.h"
+#include "BankDirectory.h"
 #include "TBits.h"
 #include <cassert>
 #include <iostream>
 #include <cstdio>
 #include <vector>
 #include <array>
+#include <bitset>
 #include <memory>
 
-class THaBenchmark;
+namespace Podd {
+  class Profiler;
+}
 
 class THaEvData : public TObject {
 
@@ -36,6 +40,27 @@ public:
   // Derived classes MUST implement this function.
   virtual Int_t LoadEvent( const UInt_t* evbuffer ) = 0;
 
+  // Event header information that can be obtained without decoding
+  struct EvHeader_t {
+    EvHeader_t() : type(0), length(0), evnum(0) {}
+    UInt_t type;      // Event type
+    UInt_t length;    // Event length (words)
+    UInt_t evnum;     // Event number (physics events only, else 0)
+  };
+  // Get header information of the event in 'evbuffer' without changing
+  // the state of the decoder. Returns HED_OK if 'hdr' was filled.
+  virtual Int_t PeekEvent( const UInt_t* evbuffer, EvHeader_t& hdr ) const;
+  // Advance past the event in 'evbuffer' without decoding it. Only the
+  // header information (event type, length, number) is updated. The data
+  // of modules are undefined afterwards.
+  virtual Int_t SkipEvent( const UInt_t* evbuffer );
+  // Decode only the given ROCs of the event in 'evbuffer', for a quick
+  // look at e.g. trigger data before deciding whether to decode it fully.
+  // Event counters are not advanced, so that the event can then be loaded
+  // with LoadEvent or skipped with SkipEvent as usual.
+  virtual Int_t LoadRocs( const UInt_t* evbuffer,
+                          const std::vector<UInt_t>& rocs );
+
   // return a pointer to a full event
   const UInt_t*  GetRawDataBuffer() const { return buffer;}
 
@@ -84,6 +109,13 @@ public:
   UInt_t    GetNumChan( UInt_t crate, UInt_t slot ) const;
   // List unique chan
   UInt_t    GetNextChan( UInt_t crate, UInt_t slot, UInt_t index ) const;
+  // All hit channels with their data in one call
+  Decoder::SlotHits GetSlotHits( UInt_t crate, UInt_t slot ) const;
+  // Directory of the EVIO banks in the raw event, built on first use
+  const Decoder::BankDirectory& GetBankDirectory() const;
+  // Data of the first bank with the given tag (and num), without copying
+  Decoder::BankView GetBank( UInt_t tag,
+                             UInt_t num = Decoder::BankDirectory::kAnyNum ) const;
   const char* DevType( UInt_t crate, UInt_t slot ) const;
 
   Bool_t    HasCapability( Decoder::EModuleType type, UInt_t crate, UInt_t slot ) const;
@@ -110,7 +142,7 @@ public:
   virtual UInt_t GetScaler( const TString& /*spec*/,
                             UInt_t /*slot*/, UInt_t /*chan*/ ) const
   { return GetScaler(0,0,0); }
-  virtual void SetDebugFile( std::ofstream *file ) { fDebugFile = file; };
+  virtual void SetDebugFile( std::ofstream *file );
   virtual Decoder::Module* GetModule( UInt_t roc, UInt_t slot ) const;
 
   // Access functions for EPICS (slow control) data
@@ -122,16 +154,23 @@ public:
 
   UInt_t GetNslots() const { return fSlotUsed.size(); };
   virtual void PrintSlotData( UInt_t crate, UInt_t slot ) const;
+  size_t GetCapacity() const;  // Memory for per-event slot data (bytes)
+  void   PrintSlotMemory( std::ostream& os ) const;
   virtual void PrintOut() const;
   virtual void SetRunTime( ULong64_t tloc );
   virtual Int_t SetDataVersion( Int_t version );
 
   // Status control
   void    EnableBenchmarks( Bool_t enable=true );
+  const Podd::Profiler* GetProfiler() const { return fBench.get(); }
   void    EnableHelicity( Bool_t enable=true );
   Bool_t  HelicityEnabled() const;
   void    EnableScalers( Bool_t enable=true );
   Bool_t  ScalersEnabled() const;
+  // Decode only the ROCs needed by the analysis (see SetRocDemand)
+  void    SetRocDemand( const std::vector<UInt_t>& rocs );
+  void    ClearRocDemand();
+  Bool_t  IsRocDemanded( UInt_t roc ) const;
   void    SetOrigPS( Int_t event_type );
   TString GetOrigPS() const;
 
@@ -139,6 +178,8 @@ public:
   static UInt_t GetInstances() { return fgInstances.CountBits(); }
 
   Decoder::THaCrateMap* GetCrateMap() const { return fMap.get(); }
+  Int_t   ShareCrateMap( const THaEvData& other );
+  Int_t   ReloadCrateMap();
 
   // Reporting level
   void SetVerbose( Int_t level );
@@ -163,6 +204,15 @@ protected:
   virtual void  makeidx( UInt_t crate, UInt_t slot );
   virtual void  FindUsedSlots();
 
+  // Build the packed hit arrays of all slots after decoding an event
+  void  PackSlotData();
+
+  // Dense tables of active slots, rebuilt whenever the slot lists change
+  void  BuildSlotIndex();
+  // Reset the hit data of all slots that are cleared every event
+  void  ClearSlotData();
+  Decoder::THaSlotData* GetActiveSlot( UInt_t crate, UInt_t slot ) const;
+
   // Helper functions
   UInt_t idx( UInt_t crate, UInt_t slot ) const;
   UInt_t idx( UInt_t crate, UInt_t slot );
@@ -170,7 +220,7 @@ protected:
   Bool_t GoodIndex( UInt_t crate, UInt_t slot ) const;
 
   // Data
-  std::unique_ptr<Decoder::THaCrateMap> fMap;  // Pointer to active crate map
+  std::shared_ptr<Decoder::THaCrateMap> fMap;  // Active crate map, possibly shared
 
   class RocDat_t {            // Coordinates of ROC data in raw event
   public:
@@ -190,6 +240,7 @@ protected:
   UInt_t fEpicsEvtType;
 
   const UInt_t *buffer;
+  mutable Decoder::BankDirectory fBankDir;  // Banks of buffer, see GetBankDirectory
 
   std::ofstream *fDebugFile;  // debug output
 
@@ -206,8 +257,18 @@ protected:
   std::vector<UShort_t> fSlotUsed;    // Indices of crateslot[] used
   std::vector<UShort_t> fSlotClear;   // Indices of crateslot[] to clear
 
+  // Dense remapping of the sparse crateslot[] array. Active slots are
+  // ordered by crate and slot, so the slots of each crate are adjacent.
+  static const UShort_t kNoSlot = 0xFFFF;
+  std::vector<UShort_t> fDenseIdx;    // crateslot[] index -> fActiveSlots index
+  std::vector<Decoder::THaSlotData*> fActiveSlots; // Slot data of fSlotUsed
+  std::vector<Decoder::THaSlotData*> fClearSlots;  // Slot data of fSlotClear
+
+  // Benchmark timers, registered in this order by EnableBenchmarks
+  enum EBench { kBenchClear = 0, kBenchRocDecode, kBenchBankDecode,
+                kBenchPhysicsDecode };
   Bool_t fDoBench;
-  std::unique_ptr<THaBenchmark> fBench;
+  std::unique_ptr<Podd::Profiler> fBench;
 
   UInt_t fInstance;            // My instance
   static TBits fgInstances;    // Number of instances of this object
@@ -219,6 +280,9 @@ protected:
   TString fCrateMapName; // Crate map database file name to use
   Bool_t fNeedInit;  // Crate map needs to be (re-)initialized
 
+  std::bitset<Decoder::MAXROC> fRocDemand; // ROCs to decode if fDemandOnly
+  Bool_t fDemandOnly;  // Decode only the ROCs in fRocDemand
+
   Int_t  fDebug;     // Debug/verbosity level
 
   TBits fMsgPrinted; // Flags indicating one-time warnings printed
@@ -250,6 +314,14 @@ inline Bool_t THaEvData::GoodIndex( UInt_t crate, UInt_t slot ) const {
   return (GoodCrateSlot(crate,slot) && crateslot[idx(crate,slot)] );
 }
 
+inline Decoder::THaSlotData* THaEvData::GetActiveSlot( UInt_t crate,
+                                                       UInt_t slot ) const {
+  // Slot data of active (crate,slot), or nullptr if not in use
+  assert( GoodCrateSlot(crate,slot) );
+  UShort_t i = fDenseIdx[idx(crate,slot)];
+  return (i != kNoSlot) ? fActiveSlots[i] : nullptr;
+}
+
 inline UInt_t THaEvData::GetRocLength( UInt_t crate ) const {
   assert( crate < rocdat.size() );
   return rocdat[crate].len;
@@ -338,6 +410,34 @@ inline UInt_t THaEvData::GetNextChan( UInt_t crate, UInt_t slot,
   return crateslot[idx(crate,slot)]->getNextChan(index);
 }
 
+inline Decoder::SlotHits THaEvData::GetSlotHits( UInt_t crate,
+                                                 UInt_t slot ) const {
+  // Get channel numbers and contiguous data/raw arrays of all hits
+  // in (crate,slot). Valid until the next event is loaded.
+  assert( GoodCrateSlot(crate,slot) );
+  if( crateslot[idx(crate,slot)] )
+    return crateslot[idx(crate,slot)]->getSlotHits();
+  return {};
+}
+
+inline
+const Decoder::BankDirectory& THaEvData::GetBankDirectory() const {
+  // Directory of all EVIO banks in the current raw event. The event is
+  // parsed only once, on the first call, so that all users of the banks
+  // (e.g. event type handlers) share one pass. Valid until the next
+  // event is loaded.
+  if( !fBankDir.IsFor(buffer, event_length) )
+    fBankDir.Build(buffer, event_length);
+  return fBankDir;
+}
+
+inline
+Decoder::BankView THaEvData::GetBank( UInt_t tag, UInt_t num ) const {
+  // View of the data words of the first bank in the current event with
+  // the given tag and num (any num by default). Empty if not found.
+  return GetBankDirectory().GetView(tag, num);
+}
+
 inline
 Bool_t THaEvData::IsPhysicsTrigger() const {
   return ((event_type > 0) && (event_type <= Decoder::MAX_PHYS_EVTYPE));
@@ -386,6 +486,12 @@ Bool_t THaEvData::ScalersEnabled() const {
   return TestBit(kScalersEnabled);
 }
 
+inline
+Bool_t THaEvData::IsRocDemanded( UInt_t roc ) const {
+  // Test if the given ROC is to be decoded
+  return !fDemandOnly || (roc < Decoder::MAXROC && fRocDemand.test(roc));
+}
+
 // Dummy versions of EPICS data access functions. These will always fail
 // in debug mode unless IsLoadedEpics is changed. This is by design -
 // clients should never try to retrieve data that are not loaded.
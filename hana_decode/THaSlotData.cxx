@@ -22,6 +22,8 @@
 #include "THaCrateMap.h"
 #include "TClass.h"
 #include <iostream>
+#include <iomanip>
+#include <algorithm>
 #include <stdexcept>
 #include <sstream>
 
@@ -38,13 +40,13 @@ const UInt_t THaSlotData::DEFNHITCHAN = 1; // Default number of hits per channel
 THaSlotData::THaSlotData() :
   crate(-1), slot(-1), fModule(nullptr), numhitperchan(0), numraw(0), numchanhit(0),
   firstfreedataidx(0), numholesdataidx(0), fDebugFile(nullptr),
-  didini(false), fNchan(0) {}
+  didini(false), fNchan(0), fMaxRaw(0), fPacked(false) {}
 
 //_____________________________________________________________________________
 THaSlotData::THaSlotData(UInt_t cra, UInt_t slo) :
   crate(cra), slot(slo), fModule(nullptr), numhitperchan(0), numraw(0), numchanhit(0),
   firstfreedataidx(0), numholesdataidx(0), fDebugFile(nullptr),
-  didini(false), fNchan(0)
+  didini(false), fNchan(0), fMaxRaw(0), fPacked(false)
 {
 }
 
@@ -58,21 +60,34 @@ void THaSlotData::define(UInt_t cra, UInt_t slo, UInt_t nchan,
 			 UInt_t nhitperchan ) {
   // Must call define once if you are really going to use this slot.
   // Otherwise its an empty slot which does not use much memory.
+  //
+  // 'nchan' is the number of channels from the crate map, which is
+  // MAXCHAN for modules of unknown size. The arrays are only allocated
+  // for DEFNCHAN channels and hits at first and grow to the highest
+  // channel number and number of hits actually seen (see loadData), so
+  // after the first events they are sized by the observed occupancy.
+  // See printMemory for the resulting sizes.
   crate = cra;
   slot = slo;
   didini = true;
   fNchan = nchan;
   numhitperchan=nhitperchan;
-  numHits.resize(fNchan);
-  chanlist.resize(fNchan);
-  idxlist.resize(fNchan);
-  chanindex.resize(fNchan);
-  rawData.resize(fNchan);
-  data.resize(fNchan);
-  dataindex.resize(fNchan);
-  numMaxHits.resize(fNchan);
+  UInt_t nalloc = std::min(fNchan, DEFNCHAN);
+  numHits.assign(nalloc, 0);
+  chanlist.resize(nalloc);
+  idxlist.resize(nalloc);
+  chanindex.resize(nalloc);
+  rawData.resize(std::max(nalloc, 1U));
+  data.resize(std::max(nalloc, 1U));
+  dataindex.resize(std::max(nalloc, 1U));
+  numMaxHits.resize(nalloc);
+  fPackOffset.resize(nalloc);
+  fPackStart.resize(nalloc+1);
+  fPackData.resize(nalloc);
+  fPackRaw.resize(nalloc);
+  fPacked = false;
   numchanhit = numraw = firstfreedataidx = numholesdataidx= 0;
-  numHits.assign(numHits.size(),0);
+  fMaxRaw = 0;
 }
 
 //_____________________________________________________________________________
@@ -87,7 +102,7 @@ int THaSlotData::loadModule(const THaCrateMap *map) {
     const auto& loctype = *found;
     assert(modelnum == loctype.fMapNum);  // else set::find lied
 
-    if (fDebugFile) {
+    if (DEBUG_FILE(fDebugFile)) {
       *fDebugFile << "THaSlotData:: loctype.fClassName  "<< loctype.fClassName<<endl;
       *fDebugFile << "THaSlotData:: loctype.fMapNum  "<< loctype.fMapNum<<endl;
       *fDebugFile << "THaSlotData:: fTClass ptr =  "<<loctype.fTClass<<endl;
@@ -96,35 +111,35 @@ int THaSlotData::loadModule(const THaCrateMap *map) {
     // Get the ROOT class for this type
     if( !loctype.fTClass ) {
       loctype.fTClass = TClass::GetClass( loctype.fClassName );
-      if (fDebugFile) {
+      if (DEBUG_FILE(fDebugFile)) {
 	 *fDebugFile << "defining fTClass ptr =  "<<loctype.fTClass<<endl;
       }
       if (!loctype.fTClass) {
-        if (fDebugFile) {
+        if (DEBUG_FILE(fDebugFile)) {
           *fDebugFile << "THaSlotData:: SERIOUS problem :  fTClass still zero " << endl;
         }
         return SD_OK;
       }
     }
 
-    if (fDebugFile) *fDebugFile << "THaSlotData::  Found Module !!!! "<<dec<<modelnum<<endl;
+    if (DEBUG_FILE(fDebugFile)) *fDebugFile << "THaSlotData::  Found Module !!!! "<<dec<<modelnum<<endl;
 
-    if (fDebugFile) *fDebugFile << "THaSlotData:: Creating fModule"<<endl;
+    if (DEBUG_FILE(fDebugFile)) *fDebugFile << "THaSlotData:: Creating fModule"<<endl;
     if( !fModule || fModule->IsA() != loctype.fTClass ) {
       fModule.reset(static_cast<Module*>( loctype.fTClass->New() ));
-    } else if (fDebugFile) {
+    } else if (DEBUG_FILE(fDebugFile)) {
       *fDebugFile << "THaSlotData:: Reusing existing fModule" << endl;
     }
 
     if (!fModule) {
       cerr << "ERROR: Failure to make module on crate "<<dec<<crate<<"  slot "<<slot<<endl;
       cerr << "usually because the module class is abstract; make sure base class methods are defined"<<endl;
-      if (fDebugFile)
+      if (DEBUG_FILE(fDebugFile))
         *fDebugFile << "failure to make module on crate "<<dec<<crate<<"  slot "<<slot<<endl;
       return SD_ERR;
     }
 
-    if (fDebugFile) {
+    if (DEBUG_FILE(fDebugFile)) {
       *fDebugFile << "THaSlotData: fModule successfully created" << endl;
       *fDebugFile << "THaSlotData:: about to init  module   "
                   << crate << "  " << slot
@@ -143,7 +158,7 @@ int THaSlotData::loadModule(const THaCrateMap *map) {
       ostr << "ERROR initializing module for crate " << dec << crate
            << " slot " << slot << ": " << e.what() << endl;
       cerr << ostr.str();
-      if( fDebugFile )
+      if( DEBUG_FILE(fDebugFile) )
         *fDebugFile << ostr.str();
       return SD_ERR;
     }
@@ -152,7 +167,7 @@ int THaSlotData::loadModule(const THaCrateMap *map) {
                      map->getMask(crate, slot),
                      map->getModel(crate, slot));
     fModule->SetBank(map->getBank(crate, slot));
-    if (fDebugFile) {
+    if (DEBUG_FILE(fDebugFile)) {
       fModule->SetDebugFile(fDebugFile);
       fModule->DoPrint();
     }
@@ -169,7 +184,7 @@ UInt_t THaSlotData::LoadIfSlot( const UInt_t* evbuffer, const UInt_t *pstop) {
     cerr << "THaSlotData::ERROR:   No module defined for slot. "<<crate<<"  "<<slot<<endl;
     return 0;
   }
-  if (fDebugFile)
+  if (DEBUG_FILE(fDebugFile))
     *fDebugFile << "THaSlotData::LoadIfSlot:  "
                 << dec << crate << "  " << slot
                 << "   p " << hex << evbuffer << "  " << *evbuffer
@@ -177,13 +192,13 @@ UInt_t THaSlotData::LoadIfSlot( const UInt_t* evbuffer, const UInt_t *pstop) {
                 << hex << "  " << pstop << "  " << fModule.get()
                 << dec << endl;
   if ( !fModule->IsSlot( *evbuffer ) ) {
-    if(fDebugFile) *fDebugFile << "THaSlotData:: Not slot ... return ... "<<endl;
+    if(DEBUG_FILE(fDebugFile)) *fDebugFile << "THaSlotData:: Not slot ... return ... "<<endl;
     return 0;
   }
-  if (fDebugFile) fModule->DoPrint();
+  if (DEBUG_FILE(fDebugFile)) fModule->DoPrint();
   fModule->Clear("");
   UInt_t wordseen = fModule->LoadSlot(this, evbuffer, pstop);
-  if (fDebugFile)
+  if (DEBUG_FILE(fDebugFile))
     *fDebugFile << "THaSlotData:: after LoadIfSlot:  wordseen =  "
                 << dec << "  " << wordseen << endl;
   return wordseen;
@@ -198,14 +213,14 @@ UInt_t THaSlotData::LoadBank( const UInt_t* p, UInt_t pos, UInt_t len) {
     cerr << "THaSlotData::ERROR:   No module defined for slot. "<<crate<<"  "<<slot<<endl;
     return 0;
   }
-  if (fDebugFile)
+  if (DEBUG_FILE(fDebugFile))
     *fDebugFile << "THaSlotData::LoadBank:  " << dec << crate << "  "<<slot
                 << "  pos " << pos << "   len " << len << "   start word "
                 << hex << *p << "  module ptr  " << fModule.get() << dec << endl;
-  if (fDebugFile) fModule->DoPrint();
+  if (DEBUG_FILE(fDebugFile)) fModule->DoPrint();
   fModule->Clear("");
   UInt_t wordseen = fModule->LoadSlot(this, p, pos, len);
-  if (fDebugFile) *fDebugFile << "THaSlotData:: after LoadBank:  wordseen =  "<<dec<<"  "<<wordseen<<endl;
+  if (DEBUG_FILE(fDebugFile)) *fDebugFile << "THaSlotData:: after LoadBank:  wordseen =  "<<dec<<"  "<<wordseen<<endl;
   return wordseen;
 }
 
@@ -249,6 +264,123 @@ Int_t THaSlotData::loadData(const char* type, UInt_t chan, UInt_t dat, UInt_t ra
     return SD_WARN;
   }
   if( device.empty() && type ) device = type;
+  fPacked = false;
+  if( chan >= numHits.size() )
+    growChannels(chan);
+
+  indexHit(chan);
+
+  // Grow data arrays if necessary
+  if( numraw >= data.size() ) {
+    size_t allocd = 2*data.size();
+    rawData.resize(allocd);
+    data.resize(allocd);
+  }
+  rawData[numraw] = raw;
+  data[numraw++]  = dat;
+  if( numHits[chan] == kMaxUInt ) {
+    cout << "THaSlotData: numchanhit, numraw = "<<numchanhit<<"  "<<numraw<<endl;
+    if( VERBOSE )
+      cout << "THaSlotData: Warning in loadData: too many hits "
+	   << "for module " << device << " in crate/slot = "
+	   << dec << crate << " " << slot
+	   << " chan = " << chan << endl;
+    return SD_WARN;
+  }
+  numHits[chan]++;
+  return SD_OK;
+}
+
+//_____________________________________________________________________________
+Int_t THaSlotData::loadBlock( const UInt_t* raw, UInt_t n, UInt_t chanmask,
+                              UInt_t chanshift, UInt_t datamask )
+{
+  // Load 'n' consecutive raw data words of this slot at once. The channel
+  // of each word is (raw & chanmask) >> chanshift, the data raw & datamask.
+  // Equivalent to calling loadData for each word, but the per-call checks
+  // and the growth of the data arrays are done once for the whole block.
+  // Returns the worst status of the individual hits.
+
+  if( !didini ) {
+    cout << "THaSlotData: ERROR: Did not init slot."<<endl;
+    cout << "  Fix your cratemap."<<endl;
+    return SD_ERR;
+  }
+  if( n == 0 )
+    return SD_OK;
+  fPacked = false;
+  if( numraw + n > data.size() ) {
+    size_t allocd = std::max<size_t>(2*data.size(), numraw + n);
+    rawData.resize(allocd);
+    data.resize(allocd);
+  }
+  Int_t status = SD_OK;
+  for( const UInt_t* p = raw; p != raw + n; ++p ) {
+    UInt_t chan = (*p & chanmask) >> chanshift;
+    if( chan < fNchan && chan >= numHits.size() )
+      growChannels(chan);
+    if( chan >= fNchan || numchanhit > fNchan || numHits[chan] == kMaxUInt ) {
+      // Rare cases: let loadData print the warning
+      if( loadData(chan, *p & datamask, *p) != SD_OK )
+        status = SD_WARN;
+      continue;
+    }
+    indexHit(chan);
+    rawData[numraw] = *p;
+    data[numraw++]  = *p & datamask;
+    numHits[chan]++;
+  }
+  return status;
+}
+
+//_____________________________________________________________________________
+Int_t THaSlotData::loadBlock( const char* type, const UInt_t* chan,
+                              const UInt_t* dat, UInt_t n )
+{
+  // Load 'n' hits of this slot, given as packed arrays of channel numbers
+  // and data. The raw words are set equal to the data. Equivalent to
+  // calling loadData(type,chan[i],dat[i],dat[i]) for each hit, but the
+  // per-call checks and the growth of the data arrays are done once for
+  // the whole block. Returns the worst status of the individual hits.
+
+  if( !didini ) {
+    cout << "THaSlotData: ERROR: Did not init slot."<<endl;
+    cout << "  Fix your cratemap."<<endl;
+    return SD_ERR;
+  }
+  if( n == 0 )
+    return SD_OK;
+  if( device.empty() && type ) device = type;
+  fPacked = false;
+  if( numraw + n > data.size() ) {
+    size_t allocd = std::max<size_t>(2*data.size(), numraw + n);
+    rawData.resize(allocd);
+    data.resize(allocd);
+  }
+  Int_t status = SD_OK;
+  for( UInt_t i = 0; i < n; ++i ) {
+    UInt_t ch = chan[i];
+    if( ch < fNchan && ch >= numHits.size() )
+      growChannels(ch);
+    if( ch >= fNchan || numchanhit > fNchan || numHits[ch] == kMaxUInt ) {
+      // Rare cases: let loadData print the warning
+      if( loadData(type, ch, dat[i], dat[i]) != SD_OK )
+        status = SD_WARN;
+      continue;
+    }
+    indexHit(ch);
+    rawData[numraw] = dat[i];
+    data[numraw++]  = dat[i];
+    numHits[ch]++;
+  }
+  return status;
+}
+
+//_____________________________________________________________________________
+void THaSlotData::indexHit( UInt_t chan )
+{
+  // Record the position, numraw, of the next hit of channel 'chan' in the
+  // data index. The channel must be allocated.
 
   if (( numchanhit == 0 )||(numHits[chan]==0)) {
     compressdataindex(numhitperchan);
@@ -280,26 +412,38 @@ Int_t THaSlotData::loadData(const char* type, UInt_t chan, UInt_t dat, UInt_t ra
       }
     }
   }
+}
 
-  // Grow data arrays if necessary
-  if( numraw >= data.size() ) {
-    size_t allocd = 2*data.size();
-    rawData.resize(allocd);
-    data.resize(allocd);
-  }
-  rawData[numraw] = raw;
-  data[numraw++]  = dat;
-  if( numHits[chan] == kMaxUInt ) {
-    cout << "THaSlotData: numchanhit, numraw = "<<numchanhit<<"  "<<numraw<<endl;
-    if( VERBOSE )
-      cout << "THaSlotData: Warning in loadData: too many hits "
-	   << "for module " << device << " in crate/slot = "
-	   << dec << crate << " " << slot
-	   << " chan = " << chan << endl;
-    return SD_WARN;
-  }
-  numHits[chan]++;
-  return SD_OK;
+//_____________________________________________________________________________
+void THaSlotData::growChannels( UInt_t chan )
+{
+  // Grow the per-channel arrays so that they can hold channel 'chan'.
+  // Sizes double, up to the number of channels of the module, fNchan.
+
+  assert(chan < fNchan);
+  size_t nalloc = std::max<size_t>(2*numHits.size(), chan+1);
+  if( nalloc > fNchan )
+    nalloc = fNchan;
+  numHits.resize(nalloc, 0);
+  chanlist.resize(nalloc);
+  idxlist.resize(nalloc);
+  chanindex.resize(nalloc);
+  numMaxHits.resize(nalloc);
+  fPackOffset.resize(nalloc);
+  fPackStart.resize(nalloc+1);
+}
+
+//_____________________________________________________________________________
+void THaSlotData::printMemory( ostream& os ) const
+{
+  // Print the sizes of the hit arrays of this slot: crate, slot, number of
+  // channels in the crate map, channels allocated, most hits seen in one
+  // event, capacity of the data arrays, and total memory (bytes).
+
+  os << setw(5) << crate << setw(5) << slot
+     << setw(8) << fNchan << setw(8) << numHits.size()
+     << setw(10) << fMaxRaw << setw(10) << data.capacity()
+     << setw(12) << GetCapacity() << endl;
 }
 
 //_____________________________________________________________________________
@@ -308,10 +452,27 @@ int THaSlotData::loadData(UInt_t chan, UInt_t dat, UInt_t raw) {
   return loadData(nullptr, chan, dat, raw);
 }
 
+//_____________________________________________________________________________
+size_t THaSlotData::GetCapacity() const
+{
+  // Memory reserved for per-event data of this slot, including the module's
+  // buffers (bytes). Arrays only grow, so once this stays constant, loading
+  // events no longer allocates from the heap.
+
+  size_t n = numHits.capacity() + chanlist.capacity() + idxlist.capacity()
+    + chanindex.capacity() + dataindex.capacity() + numMaxHits.capacity()
+    + rawData.capacity() + data.capacity() + fPackOffset.capacity()
+    + fPackStart.capacity() + fPackData.capacity() + fPackRaw.capacity();
+  n *= sizeof(UInt_t);
+  if( fModule )
+    n += fModule->GetCapacity();
+  return n;
+}
+
 //_____________________________________________________________________________
 void THaSlotData::print() const
 {
-  if (fDebugFile) {
+  if (DEBUG_FILE(fDebugFile)) {
     print_to_file();
     return;
   }
@@ -353,7 +514,7 @@ void THaSlotData::print() const
 
 //_____________________________________________________________________________
 void THaSlotData::print_to_file() const {
-  if (!fDebugFile) return;
+  if (!DEBUG_FILE(fDebugFile)) return;
   *fDebugFile << "\n THaSlotData contents : " << endl;
   *fDebugFile << "This is crate "<<dec<<crate<<" and slot "<<slot<<endl;
   *fDebugFile << "Total Amount of Data : " << dec << getNumRaw() << endl;
@@ -388,6 +549,35 @@ void THaSlotData::print_to_file() const {
   }
 }
 
+//_____________________________________________________________________________
+void THaSlotData::packImpl() const
+{
+  // Copy the hits of the current event into fPackData/fPackRaw, grouped
+  // by channel in the order of chanlist. Each hit occupies exactly one
+  // raw word, so the packed arrays hold numraw entries. fPackStart holds
+  // the row offsets for getSlotHits().
+
+  if( numraw > fPackData.size() ) {
+    fPackData.resize(data.size());
+    fPackRaw.resize(data.size());
+  }
+  UInt_t n = 0;
+  for( UInt_t i = 0; i < numchanhit; i++ ) {
+    UInt_t chan = chanlist[i];
+    const UInt_t* pidx = &dataindex[idxlist[chan]];
+    fPackOffset[chan] = fPackStart[i] = n;
+    for( UInt_t j = 0; j < numHits[chan]; j++ ) {
+      UInt_t index = pidx[j];
+      assert(index < numraw);
+      fPackData[n] = data[index];
+      fPackRaw[n++] = rawData[index];
+    }
+  }
+  fPackStart[numchanhit] = n;
+  assert(n <= numraw);
+  fPacked = true;
+}
+
 //_____________________________________________________________________________
 void THaSlotData::compressdataindexImpl( UInt_t numidx )
 {
@@ -15,6 +15,11 @@
 //   hit counters are zero'd each event, not the data
 //   arrays, see below.
 //
+//   After an event has been decoded, pack() copies the hits into
+//   a compact per-channel layout (all hits of a channel adjacent,
+//   channels in the order in which they were first hit). getData()
+//   and getHits() then read from it without any index indirection.
+//
 //   author  Robert Michaels (rom@jlab.org)
 //
 /////////////////////////////////////////////////////////////////////
@@ -34,6 +39,54 @@ const int SD_OK = 1;
 
 namespace Decoder {
 
+// Read-only view of the hits of one channel, see THaSlotData::getHits()
+class HitSpan {
+public:
+  HitSpan() : fData(nullptr), fRaw(nullptr), fN(0) {}
+  HitSpan( const UInt_t* dat, const UInt_t* raw, UInt_t n )
+    : fData(dat), fRaw(raw), fN(n) {}
+  UInt_t        size()  const { return fN; }
+  bool          empty() const { return fN == 0; }
+  UInt_t        operator[]( UInt_t hit ) const { assert(hit < fN); return fData[hit]; }
+  UInt_t        raw( UInt_t hit ) const { assert(hit < fN); return fRaw[hit]; }
+  const UInt_t* data()    const { return fData; }
+  const UInt_t* rawdata() const { return fRaw; }
+  const UInt_t* begin()   const { return fData; }
+  const UInt_t* end()     const { return fData+fN; }
+private:
+  const UInt_t* fData;  // Data words (adc,tdc,scaler)
+  const UInt_t* fRaw;   // Raw words (all bits)
+  UInt_t        fN;     // Number of hits
+};
+
+// Read-only view of all hits in one slot, grouped by channel. Index i runs
+// over the channels hit, see THaSlotData::getSlotHits()
+class SlotHits {
+public:
+  SlotHits()
+    : fNchan(0), fChan(nullptr), fStart(nullptr), fData(nullptr), fRaw(nullptr) {}
+  SlotHits( UInt_t nchan, const UInt_t* chan, const UInt_t* start,
+            const UInt_t* dat, const UInt_t* raw )
+    : fNchan(nchan), fChan(chan), fStart(start), fData(dat), fRaw(raw) {}
+  UInt_t  size()  const { return fNchan; }
+  bool    empty() const { return fNchan == 0; }
+  UInt_t  chan( UInt_t i ) const { assert(i < fNchan); return fChan[i]; }
+  UInt_t  nhit( UInt_t i ) const { assert(i < fNchan); return fStart[i+1]-fStart[i]; }
+  HitSpan hits( UInt_t i ) const {
+    assert(i < fNchan);
+    return { fData+fStart[i], fRaw+fStart[i], fStart[i+1]-fStart[i] };
+  }
+  UInt_t  GetTotalHits() const { return fNchan ? fStart[fNchan] : 0; }
+  const UInt_t* data()    const { return fData; }
+  const UInt_t* rawdata() const { return fRaw; }
+private:
+  UInt_t        fNchan;  // Number of channels hit
+  const UInt_t* fChan;   // [fNchan] channel numbers
+  const UInt_t* fStart;  // [fNchan+1] index of 1st hit of each channel
+  const UInt_t* fData;   // Data words of all hits
+  const UInt_t* fRaw;    // Raw words of all hits
+};
+
 class THaSlotData {
 
 public:
@@ -54,12 +107,20 @@ public:
        UInt_t getNumChan() const;                    // Num unique channels hit
        UInt_t getNextChan(UInt_t index) const;       // List of unique channels hit
        UInt_t getData(UInt_t chan, UInt_t hit) const;// Data (adc,tdc,scaler) on 1 chan
+       HitSpan getHits(UInt_t chan) const;           // All hits on 1 chan
+       SlotHits getSlotHits() const;                 // All hits in this slot
+       void   pack() const;                          // Build packed hit layout
+       Bool_t isPacked() const { return fPacked; }
        UInt_t getCrate() const { return crate; }
        UInt_t getSlot()  const { return slot; }
        UInt_t getNchan() const { return fNchan; }
        void   clearEvent();                          // clear event counters
        Int_t  loadData( const char* type, UInt_t chan, UInt_t dat, UInt_t raw );
        Int_t  loadData( UInt_t chan, UInt_t dat, UInt_t raw );
+       Int_t  loadBlock( const UInt_t* raw, UInt_t n, UInt_t chanmask,
+                         UInt_t chanshift, UInt_t datamask );
+       Int_t  loadBlock( const char* type, const UInt_t* chan,
+                         const UInt_t* dat, UInt_t n );
 
        // new
        UInt_t LoadIfSlot( const UInt_t* evbuffer, const UInt_t* pstop );
@@ -77,6 +138,10 @@ public:
        void print() const;
        void print_to_file() const;
        void compressdataindex(UInt_t numidx);
+       size_t GetCapacity() const;  // Memory for per-event data (bytes)
+       UInt_t getMaxRaw()   const { return fMaxRaw; }  // Most hits in one event
+       UInt_t getNchanAlloc() const { return numHits.size(); }
+       void   printMemory( std::ostream& os ) const;
 
 private:
 
@@ -100,8 +165,19 @@ private:
        std::ofstream *fDebugFile; // debug output to this file, if nonzero
        bool didini;         // true if object initialized via define()
        UInt_t fNchan;       // Number of channels for this device
+       UInt_t fMaxRaw;      // High-water mark of numraw
+
+       // Packed copy of the hits of the current event, built by pack()
+       mutable VectorUIntNI fPackOffset; // [channel] 1st hit in fPackData
+       mutable VectorUIntNI fPackStart;  // [hitindex] 1st hit in fPackData
+       mutable VectorUIntNI fPackData;   // data of all hits, by channel
+       mutable VectorUIntNI fPackRaw;    // raw words of all hits, by channel
+       mutable bool fPacked;             // packed arrays are up to date
 
        void compressdataindexImpl(UInt_t numidx);
+       void growChannels(UInt_t chan);
+       void indexHit(UInt_t chan);
+       void packImpl() const;
 
        ClassDef(THaSlotData,0)   //  Data in one slot of fastbus, vme, camac
 };
@@ -118,9 +194,11 @@ inline UInt_t THaSlotData::getRawData(UInt_t hit) const {
 // Data (words on 1 chan)
 inline
 UInt_t THaSlotData::getRawData(UInt_t chan, UInt_t hit) const {
-  assert(chan < fNchan && hit < numHits[chan] );
-  if ( chan >= fNchan || numHits[chan] <= hit)
+  assert(chan < fNchan);
+  if ( chan >= numHits.size() || numHits[chan] <= hit)
     return 0;
+  if( fPacked )
+    return fPackRaw[fPackOffset[chan]+hit];
   UInt_t index = dataindex[idxlist[chan]+hit];
   assert(index < numraw);
   if (index < numraw) return rawData[index];
@@ -132,7 +210,7 @@ inline
 UInt_t THaSlotData::getNumHits(UInt_t chan) const {
   // Num hits on a channel
   assert(chan < fNchan );
-  return (chan < fNchan) ? numHits[chan] : 0;
+  return (chan < numHits.size()) ? numHits[chan] : 0;
 }
 
 //_____________________________________________________________________________
@@ -156,15 +234,52 @@ UInt_t THaSlotData::getNextChan(UInt_t index) const {
 // Data (words on 1 chan)
 inline
 UInt_t THaSlotData::getData(UInt_t chan, UInt_t hit) const {
-  assert(chan < fNchan && hit < numHits[chan] );
-  if ( chan >= fNchan || numHits[chan] <= hit)
+  assert(chan < fNchan);
+  if ( chan >= numHits.size() || numHits[chan] <= hit)
     return 0;
+  if( fPacked )
+    return fPackData[fPackOffset[chan]+hit];
   UInt_t index = dataindex[idxlist[chan]+hit];
   assert(index < numraw);
   if (index < numraw) return data[index];
   return 0;
 }
 
+//_____________________________________________________________________________
+inline
+void THaSlotData::pack() const {
+  if( !fPacked )
+    packImpl();
+}
+
+//_____________________________________________________________________________
+inline
+HitSpan THaSlotData::getHits(UInt_t chan) const {
+  // All hits on channel 'chan', contiguous in memory. The span remains
+  // valid until the next clearEvent() or loadData().
+  // Normally the decoder has already called pack(). If not, the packed
+  // arrays are built here, which is not safe if other threads read this
+  // slot at the same time.
+  assert(chan < fNchan);
+  if( chan >= numHits.size() || numHits[chan] == 0 )
+    return {};
+  pack();
+  UInt_t off = fPackOffset[chan];
+  return { fPackData.data()+off, fPackRaw.data()+off, numHits[chan] };
+}
+
+//_____________________________________________________________________________
+inline
+SlotHits THaSlotData::getSlotHits() const {
+  // All hits in this slot, channel by channel in the order of getNextChan().
+  // Same validity and thread-safety caveats as for getHits().
+  if( numchanhit == 0 )
+    return {};
+  pack();
+  return { numchanhit, chanlist.data(), fPackStart.data(),
+           fPackData.data(), fPackRaw.data() };
+}
+
 //_____________________________________________________________________________
 // Device type (adc, tdc, scaler)
 inline
@@ -177,7 +292,9 @@ inline
 void THaSlotData::clearEvent() {
   // Only the minimum is cleared; e.g. data array is not cleared.
   // CAUTION: this code is critical for performance
+  if( numraw > fMaxRaw ) fMaxRaw = numraw;
   numraw = 0;
+  fPacked = false;
   firstfreedataidx=0;
   numholesdataidx=0;
   while( numchanhit>0 ) numHits[chanlist[--numchanhit]] = 0;
@@ -19,6 +19,7 @@
 #include <algorithm> // find_if_not
 #include <iterator>  // for std::distance
 #include <iostream>
+#include <vector>
 
 using namespace std;
 
@@ -164,6 +165,97 @@ void THaUsrstrutils::string_from_evbuffer( const UInt_t* evbuffer, UInt_t nlen )
 #endif
 }
       
+//_____________________________________________________________________________
+static const char* find_config_line( const char* buf, const char* end,
+                                     const char*& line_end )
+{
+  // Find the configuration line in [buf,end), selected in the same way as
+  // in string_from_evbuffer. Returns the start of the line, with leading
+  // whitespace and trailing comment removed (end in 'line_end'), or
+  // nullptr if there is none.
+
+  const char* pos = buf;
+  while( pos < end ) {
+    const char* eol = static_cast<const char*>(memchr(pos, '\n', end - pos));
+    if( !eol )
+      eol = end;
+    // Skip lines starting with a comment character
+    if( *pos != COMMENT_CHAR ) {
+      const char* cmt = static_cast<const char*>(memchr(pos, COMMENT_CHAR,
+                                                        eol - pos));
+      const char* stop = cmt ? cmt : eol;
+      const char* p = pos;
+      while( p < stop && isspace(static_cast<unsigned char>(*p)) )
+        ++p;
+      if( p < stop ) {
+        line_end = stop;
+        return p;
+      }
+    }
+    pos = eol + 1;
+  }
+  return nullptr;
+}
+
+//_____________________________________________________________________________
+UInt_t THaUsrstrutils::getints_from_evbuffer( const UInt_t* evbuffer,
+                                              UInt_t nlen,
+                                              const char* const* keys,
+                                              UInt_t nkeys, UInt_t* values )
+{
+  // Set values[i] to the integer value of keyword keys[i] in the
+  // configuration string contained in 'evbuffer' (length 'nlen' longwords),
+  // with the same result as string_from_evbuffer followed by getint(keys[i]).
+  // The keyword=value list is tokenized once in place. Returns the number
+  // of keywords found.
+
+  const char* buf = reinterpret_cast<const char*>(evbuffer);
+  const char* end = buf + sizeof(UInt_t) * nlen;
+  // Ignore trailing zero padding
+  const char* nul = static_cast<const char*>(memchr(buf, '\0', end - buf));
+  if( nul )
+    end = nul;
+
+  fill_n(values, nkeys, 0U);
+  const char* line_end = nullptr;
+  const char* tok = find_config_line(buf, end, line_end);
+  if( !tok )
+    return 0;
+
+  UInt_t nfound = 0;
+  vector<bool> found(nkeys, false);
+  while( tok <= line_end ) {
+    const char* tok_end = static_cast<const char*>(memchr(tok, ',',
+                                                          line_end - tok));
+    if( !tok_end )
+      tok_end = line_end;
+    const char* eq = static_cast<const char*>(memchr(tok, '=', tok_end - tok));
+    const char* key_end = eq ? eq : tok_end;
+    size_t klen = key_end - tok;
+    for( UInt_t i = 0; i < nkeys; ++i ) {
+      // The first occurrence of a keyword counts, like in getflagpos
+      if( found[i] || strlen(keys[i]) != klen ||
+          strncmp(tok, keys[i], klen) != 0 )
+        continue;
+      found[i] = true;
+      ++nfound;
+      if( eq ) {
+        // Interpret the value like getint does
+        char sval[32];
+        size_t vlen = min<size_t>(tok_end - eq - 1, sizeof(sval) - 1);
+        memcpy(sval, eq + 1, vlen);
+        sval[vlen] = '\0';
+        long val = strtol(sval, nullptr, 0);
+        if( val >= 0 && val <= kMaxUInt )
+          values[i] = val;
+      }
+      break;
+    }
+    tok = tok_end + 1;
+  }
+  return nfound;
+}
+
 // This routine reads a file to load file_configustr.
 // It is like what is used by the DAQ code to load prescale factors, etc.
 
@@ -97,6 +97,12 @@ public:
   void string_from_evbuffer(const UInt_t* evbuffer, UInt_t nlen);
   void string_from_file(const char *ffile_name);
 
+  // Look up the integer values of several keywords directly in the event
+  // buffer, without copying the configuration string
+  static UInt_t getints_from_evbuffer( const UInt_t* evbuffer, UInt_t nlen,
+                                       const char* const* keys, UInt_t nkeys,
+                                       UInt_t* values );
+
 protected:
 
   std::string configstr;
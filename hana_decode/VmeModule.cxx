@@ -30,7 +30,7 @@ UInt_t VmeModule::LoadSlot( THaSlotData *sldat, const UInt_t* evbuffer,
 {
   // This is a simple, default method for loading a slot
   const UInt_t *p = evbuffer;
-  if (fDebugFile) {
+  if (DEBUG_FILE(fDebugFile)) {
        *fDebugFile << "Module:: Loadslot "<<endl;
        *fDebugFile << "header  0x"<<hex<<fHeader<<dec<<endl;
        *fDebugFile << "masks  "<<hex<<fHeaderMask<<endl;
@@ -39,7 +39,7 @@ UInt_t VmeModule::LoadSlot( THaSlotData *sldat, const UInt_t* evbuffer,
   fWordsSeen=0;
   while (IsSlot( *p )) {
     if (p >= pstop) break;
-    if (fDebugFile) *fDebugFile << "IsSlot ... data = "<<*p<<endl;
+    if (DEBUG_FILE(fDebugFile)) *fDebugFile << "IsSlot ... data = "<<*p<<endl;
     p++;
     Decode(p);
     for( UInt_t ichan = 0, nchan = GetNumChan(); ichan < nchan; ichan++ ) {
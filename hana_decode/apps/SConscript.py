@@ -11,7 +11,7 @@ thisdir = os.path.basename(os.path.normpath(thisdir_fullpath))
 # Executables
 appnames = ['tstfadc', 'tstfadcblk', 'tstf1tdc', 'tstio',
             'tstoo', 'tdecpr', 'prfact', 'epicsd', 'tdecex',
-            'tst1190']
+            'tst1190', 'gencoda', 'decbench']
 apps = []
 sources = []
 env = dcenv.Clone()
@@ -37,6 +37,8 @@ for a in appnames:
         src = [a+'_main.cxx']
     if a == 'tdecex':
         src.append('THaGenDetTest.cxx')
+    if a == 'gencoda' or a == 'decbench':
+        src.append('SyntheticCoda.cxx')
 
     app = env.Program(target = a, source = src)
     apps.append(app)
@@ -0,0 +1,614 @@
+/////////////////////////////////////////////////////////////////////
+//
+//   Decoder::SyntheticCoda
+//
+//   Generates synthetic CODA events for reproducible decoder and
+//   analysis benchmarks without real data. The layout of the events
+//   (crates, slots, module types, banks) is taken from a crate map.
+//   Each supported module gets random data with a configurable
+//   occupancy, i.e. probability of each channel to have data, and
+//   number of hits per channel with data:
+//
+//     1875, 1877, 1881   Fastbus TDC/ADC, with header word if applicable
+//     1190               CAEN TDC, global header and trailer
+//     3201               F1TDC, header/trailer and data words
+//     250                FADC250 in mode 1 (raw window), 7 (pulse
+//                        integral, time and pedestal), 9 (pulse
+//                        parameters) or 10 (raw window + parameters)
+//
+//   Other modules in the crate map get no data.
+//
+//   Events can be written in CODA 2 or CODA 3 format. With a block
+//   level n > 1, each physics event carries n events: the FADC250s
+//   write their data in multiblock format, and the CODA 3 trigger bank
+//   has n event numbers, time stamps and event types. The other modules
+//   have data for the first event of the block only. Trigger times
+//   follow a Poisson process with the given event rate.
+//
+//   The version of the output file is that of the EVIO library. To read
+//   a CODA 2 event stream from it, set the CODA version explicitly,
+//   e.g. with THaAnalyzer::SetCodaVersion(2).
+//
+//   The data are fully determined by the crate map, the configuration
+//   and the random seed, except for the run time, which defaults to the
+//   time of construction.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include "SyntheticCoda.h"
+#include "THaCrateMap.h"
+#include "THaCodaFile.h"
+#include "Decoder.h"
+#include "TError.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
+using namespace std;
+
+namespace Decoder {
+
+// Module models with data generation
+static const Int_t kModels[] = { 1875, 1877, 1881, 1190, 3201, 250 };
+
+// Clock of CODA 3 time stamps and FADC trigger times (4 ns ticks)
+static const Double_t kClock = 250e6;
+
+//_____________________________________________________________________________
+SyntheticCoda::SyntheticCoda( const THaCrateMap* map, UInt_t seed )
+  : fMap(map), fRandom(seed), fCodaVersion(3), fFadcMode(9),
+    fFadcWindow(50), fBlockLevel(1), fTicksPerEvent(kClock/1e3),
+    fEventType(1), fRunNumber(1), fRunType(0),
+    fRunTime(static_cast<UInt_t>(time(nullptr))), fEvNum(0),
+    fTimeStamp(0), fNwords(0), fFile(nullptr)
+{
+  // Constructor. 'map' must be initialized and must outlive this object.
+
+  for( auto model : kModels )
+    fModels[model] = ModelConfig_t();
+}
+
+//_____________________________________________________________________________
+SyntheticCoda::~SyntheticCoda()
+{
+  // Destructor. Closes any open output file.
+
+  Close();
+}
+
+//_____________________________________________________________________________
+Bool_t SyntheticCoda::IsSupported( Int_t model )
+{
+  // True if data are generated for module 'model'
+
+  return find(begin(kModels), end(kModels), model) != end(kModels);
+}
+
+//_____________________________________________________________________________
+Int_t SyntheticCoda::SetCodaVersion( Int_t version )
+{
+  // Set the format of the generated events (2 or 3)
+
+  if( version != 2 && version != 3 ) {
+    ::Error("SyntheticCoda::SetCodaVersion", "Unsupported CODA version %d",
+            version);
+    return -1;
+  }
+  fCodaVersion = version;
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t SyntheticCoda::SetOccupancy( Int_t model, Double_t occupancy,
+                                   UInt_t nhits )
+{
+  // Set the probability of each channel of modules of type 'model' to have
+  // data, and the number of hits of these channels. Multiple hits are
+  // generated for the multihit TDCs (1877, 1190) and the FADC250 in pulse
+  // modes (7, 9, 10; at most 4 pulses).
+
+  if( !IsSupported(model) ) {
+    ::Error("SyntheticCoda::SetOccupancy", "No data generation for "
+            "module type %d", model);
+    return -1;
+  }
+  if( !(occupancy >= 0.0 && occupancy <= 1.0) || nhits == 0 ) {
+    ::Error("SyntheticCoda::SetOccupancy", "Invalid occupancy %lf or number "
+            "of hits %u for module type %d", occupancy, nhits, model);
+    return -2;
+  }
+  auto& cfg = fModels[model];
+  cfg.occupancy = occupancy;
+  cfg.nhits = nhits;
+  return 0;
+}
+
+//_____________________________________________________________________________
+void SyntheticCoda::SetOccupancy( Double_t occupancy )
+{
+  // Set the occupancy of all supported module types
+
+  for( auto model : kModels )
+    SetOccupancy(model, occupancy, fModels[model].nhits);
+}
+
+//_____________________________________________________________________________
+Int_t SyntheticCoda::SetFadcMode( Int_t mode )
+{
+  // Set the FADC250 readout mode (1, 7, 9 or 10)
+
+  if( mode != 1 && mode != 7 && mode != 9 && mode != 10 ) {
+    ::Error("SyntheticCoda::SetFadcMode", "Unsupported FADC250 mode %d",
+            mode);
+    return -1;
+  }
+  fFadcMode = mode;
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t SyntheticCoda::SetFadcWindow( UInt_t nsamples )
+{
+  // Set the number of samples of the FADC250 raw window (modes 1 and 10)
+
+  if( nsamples == 0 || nsamples > 0xfff ) {
+    ::Error("SyntheticCoda::SetFadcWindow", "Invalid window width %u",
+            nsamples);
+    return -1;
+  }
+  fFadcWindow = nsamples;
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t SyntheticCoda::SetBlockLevel( UInt_t nevents )
+{
+  // Set the number of events per block (1-255)
+
+  if( nevents == 0 || nevents > 0xff ) {
+    ::Error("SyntheticCoda::SetBlockLevel", "Invalid block level %u",
+            nevents);
+    return -1;
+  }
+  fBlockLevel = nevents;
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t SyntheticCoda::SetEventRate( Double_t hz )
+{
+  // Set the mean trigger rate (Hz), which determines the time stamps
+
+  if( !(hz > 0.0 && hz < kClock) ) {
+    ::Error("SyntheticCoda::SetEventRate", "Invalid event rate %lf", hz);
+    return -1;
+  }
+  fTicksPerEvent = kClock / hz;
+  return 0;
+}
+
+//_____________________________________________________________________________
+UInt_t SyntheticCoda::Pattern( UInt_t word, UInt_t header, UInt_t mask )
+{
+  // Impose the slot header pattern from the crate map on 'word'. Words
+  // are left unchanged if the crate map has no header for the slot.
+
+  if( header == 0 )
+    return word;
+  return (word & ~mask) | (header & mask);
+}
+
+//_____________________________________________________________________________
+UInt_t SyntheticCoda::Channels( UInt_t nchan, const ModelConfig_t& cfg,
+                                vector<UInt_t>& chans )
+{
+  // Select the channels with data for the current event
+
+  chans.clear();
+  for( UInt_t chan = 0; chan < nchan; ++chan ) {
+    if( fRandom.Rndm() < cfg.occupancy )
+      chans.push_back(chan);
+  }
+  return chans.size();
+}
+
+//_____________________________________________________________________________
+const UInt_t* SyntheticCoda::MakeControl( UInt_t type2, UInt_t tag3,
+                                          UInt_t w2, UInt_t w3, UInt_t w4 )
+{
+  // Make a control event with CODA 2 event type 'type2' or CODA 3 bank
+  // tag 'tag3' and the given data words
+
+  UInt_t head = (fCodaVersion == 2) ? (type2 << 16) | 0x01cc
+    : (tag3 << 16) | 0x01cc;
+  fBuf.assign({4, head, w2, w3, w4});
+  fNwords += fBuf.size();
+  return fBuf.data();
+}
+
+//_____________________________________________________________________________
+const UInt_t* SyntheticCoda::MakePrestart()
+{
+  return MakeControl(PRESTART_EVTYPE, 0xffd1, fRunTime, fRunNumber, fRunType);
+}
+
+//_____________________________________________________________________________
+const UInt_t* SyntheticCoda::MakeGo()
+{
+  return MakeControl(GO_EVTYPE, 0xffd2, fRunTime, 0, 0);
+}
+
+//_____________________________________________________________________________
+const UInt_t* SyntheticCoda::MakeEnd()
+{
+  // End event with the elapsed trigger time and the number of events
+
+  auto elapsed = static_cast<UInt_t>(fTimeStamp / kClock);
+  return MakeControl(END_EVTYPE, 0xffd4, fRunTime + elapsed, 0,
+                     static_cast<UInt_t>(fEvNum));
+}
+
+//_____________________________________________________________________________
+const UInt_t* SyntheticCoda::MakeEvent()
+{
+  // Make the next physics event, containing a block of fBlockLevel events
+
+  fStamps.resize(fBlockLevel);
+  for( auto& stamp : fStamps ) {
+    fTimeStamp += 1 + static_cast<ULong64_t>(fRandom.Exp(fTicksPerEvent));
+    stamp = fTimeStamp;
+  }
+  vector<UInt_t> rocs;
+  for( auto roc : fMap->GetUsedCrates() ) {
+    if( fMap->isFastBus(roc) || fMap->isVme(roc) )
+      rocs.push_back(roc);
+  }
+
+  fBuf.clear();
+  fSlots.clear();
+  if( fCodaVersion == 2 ) {
+    // Header and event ID bank
+    fBuf.assign({0, (fEventType << 16) | 0x10cc, 4, 0xc0000100,
+                 static_cast<UInt_t>(fEvNum + 1), 0, 0});
+  } else {
+    fBuf.assign({0, (0xff50u << 16) | (0x10 << 8) | fBlockLevel});
+    AddTriggerBank(rocs.size());
+  }
+  for( auto roc : rocs )
+    AddRoc(roc);
+  fBuf[0] = fBuf.size() - 1;
+
+  fEvNum += fBlockLevel;
+  fNwords += fBuf.size();
+  return fBuf.data();
+}
+
+//_____________________________________________________________________________
+void SyntheticCoda::AddTriggerBank( UInt_t nrocs )
+{
+  // Add CODA 3 trigger bank with time stamps, but without run info and
+  // ROC segments
+
+  size_t pos = fBuf.size();
+  fBuf.push_back(0);
+  fBuf.push_back((0xff21u << 16) | (0x20 << 8) | (nrocs & 0xff));
+  // Segment with first event number and time stamps (64 bits each)
+  fBuf.push_back((0x01 << 24) | (0x0a << 16) | (2 + 2 * fBlockLevel));
+  ULong64_t evnum = fEvNum + 1;
+  fBuf.push_back(static_cast<UInt_t>(evnum));
+  fBuf.push_back(static_cast<UInt_t>(evnum >> 32));
+  for( auto stamp : fStamps ) {
+    fBuf.push_back(static_cast<UInt_t>(stamp));
+    fBuf.push_back(static_cast<UInt_t>(stamp >> 32));
+  }
+  // Segment with event types (16 bits each)
+  UInt_t ntypewords = (fBlockLevel + 1) / 2;
+  fBuf.push_back((0x01 << 24) | (0x05 << 16) | ntypewords);
+  for( UInt_t i = 0; i < ntypewords; ++i ) {
+    UInt_t word = fEventType & 0xffff;
+    if( 2 * i + 1 < fBlockLevel )
+      word |= (fEventType & 0xffff) << 16;
+    fBuf.push_back(word);
+  }
+  fBuf[pos] = fBuf.size() - pos - 1;
+}
+
+//_____________________________________________________________________________
+void SyntheticCoda::AddRoc( UInt_t roc )
+{
+  // Add the data bank of ROC 'roc'. In crates with bank structure, the
+  // modules are grouped into banks by bank number. Slots without a bank
+  // go into a bank with an otherwise unused number.
+
+  size_t pos = fBuf.size();
+  fBuf.push_back(0);
+  if( fCodaVersion == 2 )
+    fBuf.push_back((roc << 16) | 0x0100 | (fEventType & 0xff));
+  else
+    fBuf.push_back(((roc & 0xfff) << 16) | (0x10 << 8) | fBlockLevel);
+
+  const auto& slots = fMap->GetUsedSlots(roc);
+  if( fMap->isBankStructure(roc) ) {
+    vector<Int_t> banks;
+    for( auto slot : slots ) {
+      Int_t bank = fMap->getBank(roc, slot);
+      if( find(banks.begin(), banks.end(), bank) == banks.end() )
+        banks.push_back(bank);
+    }
+    Int_t spare = 0;
+    while( find(banks.begin(), banks.end(), spare) != banks.end() )
+      ++spare;
+    for( auto bank : banks ) {
+      size_t bankpos = fBuf.size();
+      UInt_t tag = (bank >= 0) ? bank : spare;
+      fBuf.push_back(0);
+      fBuf.push_back(((tag & 0xffff) << 16) | (0x01 << 8) | fBlockLevel);
+      for( auto slot : slots ) {
+        if( fMap->getBank(roc, slot) == bank )
+          AddSlot(roc, slot);
+      }
+      if( fBuf.size() == bankpos + 2 )
+        fBuf.resize(bankpos);  // Drop empty bank
+      else
+        fBuf[bankpos] = fBuf.size() - bankpos - 1;
+    }
+  } else {
+    for( auto slot : slots )
+      AddSlot(roc, slot);
+  }
+  fBuf[pos] = fBuf.size() - pos - 1;
+}
+
+//_____________________________________________________________________________
+void SyntheticCoda::AddSlot( UInt_t roc, UInt_t slot )
+{
+  // Add the data of one module
+
+  Int_t model = fMap->getModel(roc, slot);
+  auto it = fModels.find(model);
+  if( it == fModels.end() )
+    return;
+  const auto& cfg = it->second;
+  UInt_t nchan  = fMap->getNchan(roc, slot);
+  UInt_t header = fMap->getHeader(roc, slot);
+  UInt_t mask   = fMap->getMask(roc, slot);
+  size_t pos    = fBuf.size();
+
+  switch( model ) {
+  case 1875:
+  case 1877:
+  case 1881:
+    AddFastbus(slot, model, nchan, cfg);
+    break;
+  case 1190:
+    AddCaen1190(slot, header, mask, nchan, cfg);
+    break;
+  case 3201:
+    AddF1TDC(slot, header, mask, nchan, cfg);
+    break;
+  case 250:
+    AddFadc250(slot, header, mask, cfg);
+    break;
+  default:
+    break;
+  }
+  if( fBuf.size() > pos )
+    fSlots.emplace_back(roc, slot, pos, fBuf.size() - pos);
+}
+
+//_____________________________________________________________________________
+void SyntheticCoda::AddFastbus( UInt_t slot, Int_t model, UInt_t nchan,
+                                const ModelConfig_t& cfg )
+{
+  // Add Fastbus module data. The slot number is in the upper 5 bits of
+  // each word. The 1877 and 1881 start with a header with the word count.
+
+  UInt_t maxchan = 64, chanshift = 17, datamask = 0x3fff, wdcntmask = 0x7f;
+  UInt_t nhits = 1;
+  switch( model ) {
+  case 1875:
+    chanshift = 16; datamask = 0xfff; wdcntmask = 0;
+    break;
+  case 1877:
+    maxchan = 96; datamask = 0xffff; wdcntmask = 0x7ff; nhits = cfg.nhits;
+    break;
+  default:
+    break;
+  }
+  if( Channels(min(nchan, maxchan), cfg, fChans) == 0 )
+    return;
+
+  UInt_t base = slot << 27;
+  size_t pos = fBuf.size();
+  if( wdcntmask )
+    fBuf.push_back(base);
+  for( auto chan : fChans ) {
+    for( UInt_t ihit = 0; ihit < nhits; ++ihit )
+      fBuf.push_back(base | (chan << chanshift) |
+                     fRandom.Integer(datamask + 1));
+  }
+  if( wdcntmask )
+    fBuf[pos] |= (fBuf.size() - pos) & wdcntmask;
+}
+
+//_____________________________________________________________________________
+void SyntheticCoda::AddCaen1190( UInt_t slot, UInt_t header, UInt_t mask,
+                                 UInt_t nchan, const ModelConfig_t& cfg )
+{
+  // Add CAEN 1190 data: global header, measurements, global trailer
+
+  if( Channels(min(nchan, 128u), cfg, fChans) == 0 )
+    return;
+
+  UInt_t evnum = static_cast<UInt_t>(fEvNum + 1) & 0x3fffff;
+  size_t pos = fBuf.size();
+  fBuf.push_back(Pattern(0x40000000 | (evnum << 5) | (slot & 0x1f),
+                         header, mask));
+  for( auto chan : fChans ) {
+    for( UInt_t ihit = 0; ihit < cfg.nhits; ++ihit )
+      fBuf.push_back((chan << 19) | fRandom.Integer(0x80000));
+  }
+  UInt_t nwords = fBuf.size() - pos + 1;
+  fBuf.push_back(0x80000000 | ((nwords & 0xffff) << 5) | (slot & 0x1f));
+}
+
+//_____________________________________________________________________________
+void SyntheticCoda::AddF1TDC( UInt_t slot, UInt_t header, UInt_t mask,
+                              UInt_t nchan, const ModelConfig_t& cfg )
+{
+  // Add F1TDC data with resolution lock. All words carry the slot header
+  // pattern. Data words have bit 23 set, header and trailer do not.
+
+  if( Channels(min(nchan, 64u), cfg, fChans) == 0 )
+    return;
+
+  const UInt_t kDataMarker = BIT(23), kResLock = BIT(26);
+  UInt_t base = slot << 27;
+  UInt_t evnum = static_cast<UInt_t>(fEvNum + 1) & 0x1ff;
+  fBuf.push_back(Pattern(base | (evnum << 16), header, mask));
+  for( auto chan : fChans ) {
+    for( UInt_t ihit = 0; ihit < cfg.nhits; ++ihit )
+      fBuf.push_back(Pattern(base | kResLock | kDataMarker | (chan << 16) |
+                             fRandom.Integer(0x10000), header, mask));
+  }
+  fBuf.push_back(Pattern(base | (evnum << 16), header, mask));
+}
+
+//_____________________________________________________________________________
+void SyntheticCoda::AddFadc250( UInt_t slot, UInt_t header, UInt_t mask,
+                                const ModelConfig_t& cfg )
+{
+  // Add FADC250 data for all events of the block: block header, event
+  // header and trigger time of each event, channel data according to
+  // the readout mode, block trailer
+
+  const UInt_t kNchan = 16;
+  UInt_t sl = (slot & 0x1f) << 22;
+  UInt_t iblock = static_cast<UInt_t>(fEvNum / fBlockLevel) & 0x3ff;
+  size_t pos = fBuf.size();
+  fBuf.push_back(Pattern(0x80000000 | sl | (1 << 18) | (iblock << 8) |
+                         fBlockLevel, header, mask));
+  for( UInt_t ievt = 0; ievt < fBlockLevel; ++ievt ) {
+    UInt_t evnum = static_cast<UInt_t>(fEvNum + 1 + ievt);
+    ULong64_t stamp = fStamps[ievt];
+    fBuf.push_back(0x80000000 | (2 << 27) | sl | (evnum & 0x3fffff));
+    fBuf.push_back(0x80000000 | (3 << 27) | (stamp & 0xffffff));
+    fBuf.push_back((stamp >> 24) & 0xffffff);
+    Channels(kNchan, cfg, fChans);
+    for( auto chan : fChans ) {
+      if( fFadcMode == 1 || fFadcMode == 10 )
+        AddFadcWindow(chan);
+      if( fFadcMode != 1 )
+        AddFadcPulse(chan, ievt);
+    }
+  }
+  UInt_t nwords = fBuf.size() - pos + 1;
+  fBuf.push_back(0x80000000 | (1 << 27) | sl | (nwords & 0x3fffff));
+}
+
+//_____________________________________________________________________________
+void SyntheticCoda::AddFadcWindow( UInt_t chan )
+{
+  // Add FADC250 raw window (type 4): pedestal with noise plus a pulse.
+  // Two 13-bit samples per word.
+
+  fBuf.push_back(0x80000000 | (4 << 27) | (chan << 23) | fFadcWindow);
+  UInt_t peak = 200 + fRandom.Integer(3000);
+  Double_t t0 = fFadcWindow * (0.2 + 0.3 * fRandom.Rndm());
+  for( UInt_t i = 0; i < fFadcWindow; i += 2 ) {
+    UInt_t s[2];
+    for( UInt_t k = 0; k < 2; ++k ) {
+      Double_t dt = i + k - t0, amp = 100 + fRandom.Gaus(0, 2);
+      if( dt > 0 )
+        amp += peak * (dt / 4) * exp(1.0 - dt / 4);
+      s[k] = min(static_cast<UInt_t>(max(amp, 0.0)), 0xfffu);
+    }
+    UInt_t word = (s[0] << 16) | s[1];
+    if( i + 1 >= fFadcWindow )
+      word |= BIT(13);  // Sample x+1 not valid
+    fBuf.push_back(word);
+  }
+}
+
+//_____________________________________________________________________________
+void SyntheticCoda::AddFadcPulse( UInt_t chan, UInt_t ievt )
+{
+  // Add FADC250 pulse data of one channel in mode 7 (types 7, 8 and 10)
+  // or modes 9/10 (type 9)
+
+  UInt_t npulse = min(fModels[250].nhits, 4u);
+  if( fFadcMode == 7 ) {
+    for( UInt_t ip = 0; ip < npulse; ++ip ) {
+      UInt_t hdr = 0x80000000 | (chan << 23) | (ip << 21);
+      fBuf.push_back(hdr | (7 << 27) | fRandom.Integer(0x80000));
+      fBuf.push_back(hdr | (8 << 27) | fRandom.Integer(0x8000));
+      fBuf.push_back(hdr | (10 << 27) | ((100 + fRandom.Integer(20)) << 12) |
+                     fRandom.Integer(0x1000));
+    }
+  } else {
+    fBuf.push_back(0x80000000 | (9 << 27) | ((ievt & 0xff) << 19) |
+                   (chan << 15) | (400 + fRandom.Integer(80)));
+    for( UInt_t ip = 0; ip < npulse; ++ip ) {
+      UInt_t nover = fRandom.Integer(0x1ff);
+      fBuf.push_back(BIT(30) | (fRandom.Integer(0x40000) << 12) | nover);
+      fBuf.push_back((fRandom.Integer(0x200) << 21) |
+                     (fRandom.Integer(0x40) << 15) |
+                     (fRandom.Integer(0x1000) << 3));
+    }
+  }
+}
+
+//_____________________________________________________________________________
+Int_t SyntheticCoda::Open( const char* filename )
+{
+  // Open output file 'filename' and write the prestart and go events
+
+  Close();
+  fFile = new THaCodaFile;
+  if( fFile->codaOpen(filename, "w") != CODA_OK ) {
+    ::Error("SyntheticCoda::Open", "Cannot open CODA file %s", filename);
+    delete fFile;
+    fFile = nullptr;
+    return -1;
+  }
+  if( fFile->codaWrite(MakePrestart()) != CODA_OK ||
+      fFile->codaWrite(MakeGo()) != CODA_OK )
+    return -2;
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t SyntheticCoda::Write( ULong64_t nevents )
+{
+  // Generate physics events and write them to the output file until at
+  // least 'nevents' events have been generated since construction
+
+  if( !fFile ) {
+    ::Error("SyntheticCoda::Write", "No output file open");
+    return -1;
+  }
+  while( fEvNum < nevents ) {
+    if( fFile->codaWrite(MakeEvent()) != CODA_OK )
+      return -2;
+  }
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t SyntheticCoda::Close()
+{
+  // Write the end event and close the output file
+
+  if( !fFile )
+    return 0;
+  Int_t ret = 0;
+  if( fFile->codaWrite(MakeEnd()) != CODA_OK )
+    ret = -1;
+  if( fFile->codaClose() != CODA_OK )
+    ret = -2;
+  delete fFile;
+  fFile = nullptr;
+  return ret;
+}
+
+} // namespace Decoder
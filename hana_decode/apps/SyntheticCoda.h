@@ -0,0 +1,127 @@
+#ifndef Podd_SyntheticCoda_h_
+#define Podd_SyntheticCoda_h_
+
+/////////////////////////////////////////////////////////////////////
+//
+//   Decoder::SyntheticCoda
+//
+//   Generator of synthetic CODA events for decoder and analysis
+//   benchmarks. The event layout follows a crate map.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include "TRandom3.h"
+#include <vector>
+#include <map>
+
+namespace Decoder {
+
+class THaCrateMap;
+class THaCodaFile;
+
+class SyntheticCoda {
+
+public:
+  explicit SyntheticCoda( const THaCrateMap* map, UInt_t seed = 4357 );
+  SyntheticCoda( const SyntheticCoda& ) = delete;
+  SyntheticCoda& operator=( const SyntheticCoda& ) = delete;
+  ~SyntheticCoda();
+
+  // Configuration, before generating events
+  Int_t  SetCodaVersion( Int_t version );
+  Int_t  SetOccupancy( Int_t model, Double_t occupancy, UInt_t nhits = 1 );
+  void   SetOccupancy( Double_t occupancy ); // All supported models
+  Int_t  SetFadcMode( Int_t mode );
+  Int_t  SetFadcWindow( UInt_t nsamples );
+  Int_t  SetBlockLevel( UInt_t nevents );
+  Int_t  SetEventRate( Double_t hz );
+  void   SetEventType( UInt_t type ) { fEventType = type; }
+  void   SetRunNumber( UInt_t run, UInt_t runtype = 0 )
+  { fRunNumber = run; fRunType = runtype; }
+  void   SetRunTime( UInt_t unixtime ) { fRunTime = unixtime; }
+
+  Int_t  GetCodaVersion() const { return fCodaVersion; }
+  UInt_t GetBlockLevel()  const { return fBlockLevel; }
+  static Bool_t IsSupported( Int_t model );
+
+  // Event buffers. The returned buffer is valid until the next call.
+  const UInt_t* MakePrestart();
+  const UInt_t* MakeGo();
+  const UInt_t* MakeEnd();
+  const UInt_t* MakeEvent();   // Physics event (block of events, if CODA3)
+
+  // File output: prestart, go, physics events, end
+  Int_t  Open( const char* filename );
+  Int_t  Write( ULong64_t nevents );
+  Int_t  Close();
+
+  ULong64_t GetNevents() const { return fEvNum; }
+  ULong64_t GetNwords()  const { return fNwords; }
+
+  // Location of the data of each module in the last physics event
+  class SlotRange_t {
+  public:
+    SlotRange_t( UInt_t _roc, UInt_t _slot, UInt_t _pos, UInt_t _len )
+      : roc(_roc), slot(_slot), pos(_pos), len(_len) {}
+    UInt_t roc;
+    UInt_t slot;
+    UInt_t pos;   // Index of first word in event buffer
+    UInt_t len;   // Number of words
+  };
+  const std::vector<SlotRange_t>& GetSlotRanges() const { return fSlots; }
+
+private:
+  class ModelConfig_t {
+  public:
+    ModelConfig_t() : occupancy(0.1), nhits(1) {}
+    Double_t occupancy;  // Probability of a channel to have data
+    UInt_t   nhits;      // Hits per channel with data (multihit TDCs)
+  };
+
+  const THaCrateMap*  fMap;
+  TRandom3            fRandom;
+  Int_t               fCodaVersion;  // CODA event format (2 or 3)
+  Int_t               fFadcMode;     // FADC250 readout mode
+  UInt_t              fFadcWindow;   // FADC250 samples per window
+  UInt_t              fBlockLevel;   // Events per block
+  Double_t            fTicksPerEvent; // Mean trigger spacing (4 ns ticks)
+  UInt_t              fEventType;
+  UInt_t              fRunNumber;
+  UInt_t              fRunType;
+  UInt_t              fRunTime;
+  std::map<Int_t,ModelConfig_t> fModels;
+
+  ULong64_t           fEvNum;        // Physics events generated
+  ULong64_t           fTimeStamp;    // Current trigger time (4 ns ticks)
+  ULong64_t           fNwords;       // Words generated
+  std::vector<ULong64_t> fStamps;    // Trigger times of current block
+  std::vector<UInt_t> fBuf;          // Event buffer
+  std::vector<SlotRange_t> fSlots;   // Module data in fBuf
+  THaCodaFile*        fFile;         // Output file
+
+  const UInt_t* MakeControl( UInt_t type2, UInt_t tag3, UInt_t w2,
+                             UInt_t w3, UInt_t w4 );
+  void   AddTriggerBank( UInt_t nrocs );
+  void   AddRoc( UInt_t roc );
+  void   AddSlot( UInt_t roc, UInt_t slot );
+  void   AddFastbus( UInt_t slot, Int_t model, UInt_t nchan,
+                     const ModelConfig_t& cfg );
+  void   AddCaen1190( UInt_t slot, UInt_t header, UInt_t mask, UInt_t nchan,
+                      const ModelConfig_t& cfg );
+  void   AddF1TDC( UInt_t slot, UInt_t header, UInt_t mask, UInt_t nchan,
+                   const ModelConfig_t& cfg );
+  void   AddFadc250( UInt_t slot, UInt_t header, UInt_t mask,
+                     const ModelConfig_t& cfg );
+  void   AddFadcWindow( UInt_t chan );
+  void   AddFadcPulse( UInt_t chan, UInt_t ievt );
+  UInt_t Channels( UInt_t nchan, const ModelConfig_t& cfg,
+                   std::vector<UInt_t>& chans );
+  static UInt_t Pattern( UInt_t word, UInt_t header, UInt_t mask );
+
+  std::vector<UInt_t> fChans;        // Scratch: channels with data
+};
+
+} // namespace Decoder
+
+#endif
@@ -0,0 +1,347 @@
+// Decoder microbenchmarks on synthetic CODA data
+//
+// Measures the throughput of CodaDecoder::LoadEvent, of its roc_decode
+// and bank_decode stages, of THaSlotData::loadData and of the LoadSlot
+// method of each module type in the crate map. The events are made by
+// SyntheticCoda from the given crate map and kept in memory, so no I/O
+// is timed. Each benchmark repeats passes over all events for at least
+// the minimum time.
+//
+// Results are written as JSON in the layout of Google Benchmark
+// ("context" and "benchmarks"), with additional fields events_per_second
+// and ns_per_word, so that runs can be compared with the usual tools.
+
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "CodaDecoder.h"
+#include "THaCrateMap.h"
+#include "THaSlotData.h"
+#include "Module.h"
+#include "Profiler.h"
+#include "SyntheticCoda.h"
+
+using namespace std;
+using namespace Decoder;
+
+typedef chrono::steady_clock Clock;
+
+// Result of one benchmark
+class Result_t {
+public:
+  explicit Result_t( string _name )
+    : name(std::move(_name)), passes(0), time(0), events(0), items(0),
+      words(0) {}
+  string    name;
+  ULong64_t passes;  // Passes over the data
+  Double_t  time;    // Total real time (s)
+  ULong64_t events;  // Events processed
+  ULong64_t items;   // Calls of the measured function
+  ULong64_t words;   // Data words processed
+};
+
+// The data of one module in one event, for the LoadSlot benchmarks
+class Sample_t {
+public:
+  Sample_t( THaSlotData* _sd, size_t _pos, UInt_t _len )
+    : sd(_sd), pos(_pos), len(_len) {}
+  THaSlotData* sd;
+  size_t       pos;   // Start in sample buffer
+  UInt_t       len;   // Number of words, followed by a guard word
+};
+
+//_____________________________________________________________________________
+static void usage( const char* prog )
+{
+  cout << "Usage: " << prog << " [options] cratemap_file" << endl
+       << "Options:" << endl
+       << "  -n <events>         number of events (default 2000)" << endl
+       << "  -c <2|3>            CODA version (default 3)" << endl
+       << "  -o <occupancy>      occupancy of all module types (default 0.1)"
+       << endl
+       << "  -m <model:occ[:n]>  occupancy and hits/channel of one module type"
+       << endl
+       << "  -f <mode>           FADC250 mode 1, 7, 9 or 10 (default 9)" << endl
+       << "  -w <samples>        FADC250 window width (default 50)" << endl
+       << "  -b <events>         block level (default 1)" << endl
+       << "  -s <seed>           random seed (default 4357)" << endl
+       << "  -t <seconds>        minimum time per benchmark (default 1)"
+       << endl
+       << "  -O <file>           JSON output file (default stdout)" << endl;
+  exit(1);
+}
+
+//_____________________________________________________________________________
+template< typename Func >
+static Result_t Measure( const string& name, Double_t mintime, Func pass )
+{
+  // Call 'pass' until 'mintime' seconds have elapsed. 'pass' processes
+  // all data once and adds to the counters of the result.
+
+  Result_t res(name);
+  auto start = Clock::now();
+  do {
+    pass(res);
+    ++res.passes;
+    res.time = chrono::duration<Double_t>(Clock::now() - start).count();
+  } while( res.time < mintime );
+  return res;
+}
+
+//_____________________________________________________________________________
+static void WriteJSON( ostream& os, const map<string,string>& context,
+                       const vector<Result_t>& results )
+{
+  os << "{" << endl << "  \"context\": {" << endl;
+  size_t n = 0;
+  for( const auto& item : context ) {
+    os << "    \"" << item.first << "\": " << item.second;
+    os << (++n < context.size() ? "," : "") << endl;
+  }
+  os << "  }," << endl << "  \"benchmarks\": [" << endl;
+  n = 0;
+  for( const auto& r : results ) {
+    Double_t t = (r.time > 0) ? r.time : 1e-30;
+    os << "    {" << endl
+       << "      \"name\": \"" << r.name << "\"," << endl
+       << "      \"run_type\": \"iteration\"," << endl
+       << "      \"iterations\": " << r.items << "," << endl
+       << "      \"passes\": " << r.passes << "," << endl
+       << "      \"real_time\": " << (r.items ? 1e9*r.time/r.items : 0.)
+       << "," << endl
+       << "      \"time_unit\": \"ns\"," << endl
+       << "      \"items_per_second\": " << r.items/t << "," << endl
+       << "      \"events_per_second\": " << r.events/t << "," << endl
+       << "      \"ns_per_word\": " << (r.words ? 1e9*r.time/r.words : 0.)
+       << "," << endl
+       << "      \"words\": " << r.words << endl
+       << "    }" << (++n < results.size() ? "," : "") << endl;
+  }
+  os << "  ]" << endl << "}" << endl;
+}
+
+//_____________________________________________________________________________
+int main(int argc, char* argv[])
+{
+  ULong64_t nev = 2000;
+  UInt_t seed = 4357;
+  Double_t mintime = 1.0;
+  const char* outfile = nullptr;
+  vector<const char*> opts, files;
+  for( int i = 1; i < argc; ++i ) {
+    if( argv[i][0] == '-' && strlen(argv[i]) == 2 ) {
+      if( i+1 >= argc )
+        usage(argv[0]);
+      switch( argv[i][1] ) {
+      case 'n': nev = strtoull(argv[i+1], nullptr, 0); break;
+      case 's': seed = strtoul(argv[i+1], nullptr, 0); break;
+      case 't': mintime = atof(argv[i+1]); break;
+      case 'O': outfile = argv[i+1]; break;
+      default:
+        opts.push_back(argv[i]);
+        opts.push_back(argv[i+1]);
+      }
+      ++i;
+    } else
+      files.push_back(argv[i]);
+  }
+  if( files.size() != 1 || nev == 0 )
+    usage(argv[0]);
+
+  // The decoder looks up crate map names without a directory in the
+  // database. Give it a path so that it reads exactly this file.
+  string mapfile = files[0];
+  if( mapfile.find('/') == string::npos )
+    mapfile.insert(0, "./");
+  THaCrateMap cmap(mapfile.c_str());
+  if( cmap.init(fopen(mapfile.c_str(), "r"), mapfile.c_str())
+      != THaCrateMap::CM_OK ) {
+    cerr << "ERROR: cannot read crate map " << mapfile << endl;
+    exit(2);
+  }
+
+  SyntheticCoda gen(&cmap, seed);
+  map<string,string> context;
+  for( size_t i = 0; i < opts.size(); i += 2 ) {
+    const char* val = opts[i+1];
+    Int_t st = 0;
+    switch( opts[i][1] ) {
+    case 'c':
+      st = gen.SetCodaVersion(atoi(val));
+      break;
+    case 'o':
+      gen.SetOccupancy(atof(val));
+      break;
+    case 'm': {
+      Int_t model = 0;
+      Double_t occ = 0;
+      UInt_t nhits = 1;
+      if( sscanf(val, "%d:%lf:%u", &model, &occ, &nhits) < 2 )
+        usage(argv[0]);
+      st = gen.SetOccupancy(model, occ, nhits);
+      break;
+    }
+    case 'f':
+      st = gen.SetFadcMode(atoi(val));
+      break;
+    case 'w':
+      st = gen.SetFadcWindow(strtoul(val, nullptr, 0));
+      break;
+    case 'b':
+      st = gen.SetBlockLevel(strtoul(val, nullptr, 0));
+      break;
+    default:
+      usage(argv[0]);
+    }
+    if( st != 0 )
+      exit(1);
+    context[string("option_") + opts[i][1]] = string("\"") + val + "\"";
+  }
+
+  // Generate the events. For the LoadSlot benchmarks, also copy the data
+  // of each module, followed by a guard word that no module accepts as
+  // its own, and set up one slot object per module.
+  const UInt_t* ps = gen.MakePrestart();
+  vector<UInt_t> prestart(ps, ps + ps[0] + 1);
+  vector<vector<UInt_t>> events;
+  ULong64_t nwords = 0;
+  map<Int_t, vector<Sample_t>> samples;
+  map<UInt_t, unique_ptr<THaSlotData>> slots;
+  vector<UInt_t> slotbuf;
+  while( gen.GetNevents() < nev ) {
+    const UInt_t* evbuf = gen.MakeEvent();
+    events.emplace_back(evbuf, evbuf + evbuf[0] + 1);
+    nwords += evbuf[0] + 1;
+    for( const auto& r : gen.GetSlotRanges() ) {
+      auto& sd = slots[(r.roc << 16) + r.slot];
+      if( !sd ) {
+        sd.reset(new THaSlotData(r.roc, r.slot));
+        sd->define(r.roc, r.slot, cmap.getNchan(r.roc, r.slot));
+        if( sd->loadModule(&cmap) != SD_OK || !sd->GetModule() ) {
+          cerr << "ERROR: cannot create module for crate " << r.roc
+               << " slot " << r.slot << endl;
+          exit(3);
+        }
+      }
+      samples[cmap.getModel(r.roc, r.slot)].emplace_back(sd.get(),
+                                                         slotbuf.size(), r.len);
+      slotbuf.insert(slotbuf.end(), evbuf + r.pos, evbuf + r.pos + r.len);
+      slotbuf.push_back(kMaxUInt);
+    }
+  }
+  ULong64_t nphys = gen.GetNevents();
+
+  CodaDecoder dec;
+  dec.SetCodaVersion(gen.GetCodaVersion());
+  dec.SetCrateMapName(mapfile.c_str());
+  if( dec.LoadEvent(prestart.data()) != CodaDecoder::HED_OK ) {
+    cerr << "ERROR: cannot initialize decoder" << endl;
+    exit(4);
+  }
+
+  vector<Result_t> results;
+  auto decode_all = [&]( Result_t& res ) {
+    for( const auto& ev : events ) {
+      do {
+        dec.LoadEvent(ev.data());
+        ++res.events;
+      } while( dec.DataCached() );
+    }
+    res.items = res.events;
+    res.words += nwords;
+  };
+
+  // Full event decoding
+  results.push_back(Measure("CodaDecoder::LoadEvent", mintime, decode_all));
+
+  // Decoding stages, timed by the decoder's own profiler
+  dec.EnableBenchmarks(true);
+  Result_t prof = Measure("profiled", mintime, decode_all);
+  const Podd::Profiler* bench = dec.GetProfiler();
+  for( const char* stage : { "roc_decode", "bank_decode" } ) {
+    auto h = bench->Find(stage);
+    if( h == Podd::Profiler::kNoParent || bench->GetNCalls(h) == 0 )
+      continue;
+    Result_t res(string("CodaDecoder::") + stage);
+    res.passes = prof.passes;
+    res.time   = bench->GetRealTime(h);
+    res.events = prof.events;
+    res.items  = bench->GetNCalls(h);
+    res.words  = prof.words;
+    results.push_back(res);
+  }
+  dec.EnableBenchmarks(false);
+
+  // Storing hits in a slot, with the hit counts of the generated data
+  {
+    THaSlotData sd(0, 1);
+    sd.define(0, 1, 128);
+    UInt_t nhit = 0;
+    for( const auto& s : samples )
+      for( const auto& smp : s.second )
+        nhit += smp.len;
+    nhit = max(nhit / static_cast<UInt_t>(nphys), 1u);
+    results.push_back(Measure("THaSlotData::loadData", mintime,
+      [&]( Result_t& res ) {
+        for( ULong64_t iev = 0; iev < nphys; ++iev ) {
+          sd.clearEvent();
+          for( UInt_t i = 0; i < nhit; ++i )
+            sd.loadData(i & 0x7f, i, i);
+        }
+        res.events += nphys;
+        res.items  += nphys * nhit;
+        res.words  += nphys * nhit;
+      }));
+  }
+
+  // Module decoding, per module type
+  for( const auto& s : samples ) {
+    const auto& list = s.second;
+    string name = string("Module::LoadSlot/") +
+      list.front().sd->GetModule()->ClassName();
+    results.push_back(Measure(name, mintime, [&]( Result_t& res ) {
+        for( const auto& smp : list ) {
+          const UInt_t* p = slotbuf.data() + smp.pos;
+          Module* mod = smp.sd->GetModule();
+          smp.sd->clearEvent();
+          mod->Clear();
+          mod->LoadSlot(smp.sd, p, p + smp.len);
+          res.words += smp.len;
+        }
+        res.events += list.size();
+        res.items  += list.size();
+      }));
+  }
+
+  // Context of the measurements
+  char date[32];
+  time_t now = time(nullptr);
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+  context["date"]            = string("\"") + date + "\"";
+  context["executable"]      = string("\"") + argv[0] + "\"";
+  context["cratemap"]        = "\"" + mapfile + "\"";
+  context["coda_version"]    = to_string(gen.GetCodaVersion());
+  context["block_level"]     = to_string(gen.GetBlockLevel());
+  context["events"]          = to_string(nphys);
+  context["words"]           = to_string(nwords);
+  context["seed"]            = to_string(seed);
+
+  if( outfile ) {
+    ofstream ofs(outfile);
+    if( !ofs ) {
+      cerr << "ERROR: cannot open output file " << outfile << endl;
+      exit(5);
+    }
+    WriteJSON(ofs, context, results);
+  } else
+    WriteJSON(cout, context, results);
+  return 0;
+}
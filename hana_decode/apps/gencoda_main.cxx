@@ -0,0 +1,119 @@
+// Generate a file of synthetic CODA events for benchmarking,
+// laid out according to a crate map
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "THaCrateMap.h"
+#include "SyntheticCoda.h"
+
+using namespace std;
+using namespace Decoder;
+
+static void usage( const char* prog )
+{
+  cout << "Usage: " << prog << " [options] cratemap_file output_file" << endl
+       << "Options:" << endl
+       << "  -n <events>         number of events (default 10000)" << endl
+       << "  -c <2|3>            CODA version (default 3)" << endl
+       << "  -o <occupancy>      occupancy of all module types (default 0.1)"
+       << endl
+       << "  -m <model:occ[:n]>  occupancy and hits/channel of one module type"
+       << endl
+       << "  -f <mode>           FADC250 mode 1, 7, 9 or 10 (default 9)" << endl
+       << "  -w <samples>        FADC250 window width (default 50)" << endl
+       << "  -b <events>         block level (default 1)" << endl
+       << "  -r <Hz>             event rate (default 1000)" << endl
+       << "  -s <seed>           random seed (default 4357)" << endl
+       << "  -R <run>            run number (default 1)" << endl
+       << "  -t <unix time>      run time (default now)" << endl;
+  exit(1);
+}
+
+int main(int argc, char* argv[])
+{
+  ULong64_t nev = 10000;
+  UInt_t seed = 4357;
+  vector<const char*> opts, files;
+  for( int i = 1; i < argc; ++i ) {
+    if( argv[i][0] == '-' && strlen(argv[i]) == 2 ) {
+      if( i+1 >= argc )
+        usage(argv[0]);
+      if( argv[i][1] == 's' )
+        seed = strtoul(argv[i+1], nullptr, 0);
+      else {
+        opts.push_back(argv[i]);
+        opts.push_back(argv[i+1]);
+      }
+      ++i;
+    } else
+      files.push_back(argv[i]);
+  }
+  if( files.size() != 2 )
+    usage(argv[0]);
+
+  THaCrateMap map(files[0]);
+  if( map.init(fopen(files[0], "r"), files[0]) != THaCrateMap::CM_OK ) {
+    cerr << "ERROR: cannot read crate map " << files[0] << endl;
+    exit(2);
+  }
+
+  SyntheticCoda gen(&map, seed);
+  for( size_t i = 0; i < opts.size(); i += 2 ) {
+    const char* val = opts[i+1];
+    Int_t st = 0;
+    switch( opts[i][1] ) {
+    case 'n':
+      nev = strtoull(val, nullptr, 0);
+      break;
+    case 'c':
+      st = gen.SetCodaVersion(atoi(val));
+      break;
+    case 'o':
+      gen.SetOccupancy(atof(val));
+      break;
+    case 'm': {
+      Int_t model = 0;
+      Double_t occ = 0;
+      UInt_t nhits = 1;
+      if( sscanf(val, "%d:%lf:%u", &model, &occ, &nhits) < 2 )
+        usage(argv[0]);
+      st = gen.SetOccupancy(model, occ, nhits);
+      break;
+    }
+    case 'f':
+      st = gen.SetFadcMode(atoi(val));
+      break;
+    case 'w':
+      st = gen.SetFadcWindow(strtoul(val, nullptr, 0));
+      break;
+    case 'b':
+      st = gen.SetBlockLevel(strtoul(val, nullptr, 0));
+      break;
+    case 'r':
+      st = gen.SetEventRate(atof(val));
+      break;
+    case 'R':
+      gen.SetRunNumber(strtoul(val, nullptr, 0));
+      break;
+    case 't':
+      gen.SetRunTime(strtoul(val, nullptr, 0));
+      break;
+    default:
+      usage(argv[0]);
+    }
+    if( st != 0 )
+      exit(1);
+  }
+
+  if( gen.Open(files[1]) != 0 || gen.Write(nev) != 0 || gen.Close() != 0 ) {
+    cerr << "ERROR: cannot write " << files[1] << endl;
+    exit(3);
+  }
+  cout << "Wrote " << gen.GetNevents() << " events, " << gen.GetNwords()
+       << " words (CODA " << gen.GetCodaVersion() << ") to " << files[1]
+       << endl;
+  return 0;
+}
@@ -11,7 +11,7 @@ using namespace std;
 using namespace Decoder;
 
 void usage();
-void do_something(UInt_t* data);
+void do_something(const UInt_t* data);
 
 int main(int argc, char* argv[])
 {
@@ -101,7 +101,7 @@ void usage() {
   cout << "If ET connection, you have 3 choices "<<endl;
 }
 
-void do_something (UInt_t* data) {
+void do_something (const UInt_t* data) {
   unsigned len = data[0] + 1;
   unsigned evtype = data[1]>>16;
   unsigned evnum = data[4];
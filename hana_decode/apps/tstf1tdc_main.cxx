@@ -23,7 +23,7 @@ using namespace Decoder;
 TH1F *h1,*h2,*h3,*h4,*h5;
 TH1F *hinteg;
 
-void dump(UInt_t *data, ofstream *file);
+void dump(const UInt_t *data, ofstream *file);
 void process(Int_t i, THaEvData *evdata, ofstream *file);
 
 int main(int /* argc */, char** /* argv */)
@@ -74,7 +74,7 @@ int main(int /* argc */, char** /* argv */)
       }
     } else {
 
-      UInt_t* data = datafile.getEvBuffer();
+      const UInt_t* data = datafile.getEvBuffer();
       dump(data, debugfile);
 
       *debugfile << "\nAbout to Load Event "<<endl;
@@ -95,7 +95,7 @@ int main(int /* argc */, char** /* argv */)
 }
 
 
-void dump( UInt_t* data, ofstream *debugfile) {
+void dump( const UInt_t* data, ofstream *debugfile) {
   // Crude event dump
   unsigned evnum = data[4];
   unsigned len = data[0] + 1;
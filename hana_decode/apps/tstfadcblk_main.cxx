@@ -35,7 +35,7 @@ TH1F *hinteg, *hinteg2;
 Bool_t use_module = false;
 UInt_t nsnaps = 5;
 
-void dump(UInt_t *data, ofstream *file);
+void dump(const UInt_t *data, ofstream *file);
 void process(UInt_t trignum, THaEvData *evdata, ofstream *file);
 
 int main(int /* argc */, char** /* argv */)
@@ -116,7 +116,7 @@ int main(int /* argc */, char** /* argv */)
 
       } else {
 
-        UInt_t *data = datafile.getEvBuffer();
+        const UInt_t *data = datafile.getEvBuffer();
         dump(data, debugfile);
 
         cout << "LoadEvent --- "<<endl;
@@ -155,7 +155,7 @@ int main(int /* argc */, char** /* argv */)
 }
 
 
-void dump( UInt_t* data, ofstream *debugfile) {
+void dump( const UInt_t* data, ofstream *debugfile) {
   // Crude event dump
   if (!debugfile) return;
   UInt_t evnum = data[4];
@@ -49,7 +49,7 @@ int main(int argc, char* argv[])
           exit(status);
         }
       } else {
-        UInt_t *data = datafile.getEvBuffer();
+        const UInt_t *data = datafile.getEvBuffer();
         UInt_t len = data[0] + 1;
         UInt_t evtype = data[1]>>16;
         // Crude event dump
@@ -97,7 +97,7 @@ int main(int argc, char* argv[])
     while (datafile.codaRead() == CODA_OK) {
       if( (nevt%1000)==0 ) cout << "." << flush;
       nevt++;
-      UInt_t* dbuff = datafile.getEvBuffer();
+      const UInt_t* dbuff = datafile.getEvBuffer();
       unsigned event_type = dbuff[1]>>16;
       if (event_type < MAXEVTYPE) {
         evtype_sum[event_type]++;
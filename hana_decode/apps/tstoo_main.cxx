@@ -12,7 +12,7 @@
 using namespace std;
 using namespace Decoder;
 
-void dump(UInt_t *data, ofstream *file);
+void dump(const UInt_t *data, ofstream *file);
 void process(THaEvData *evdata, ofstream *file);
 
 int main(int /* argc */, char** /* argv */)
@@ -49,7 +49,7 @@ int main(int /* argc */, char** /* argv */)
       }
     } else {
 
-      UInt_t *data = datafile.getEvBuffer();
+      const UInt_t *data = datafile.getEvBuffer();
       dump(data, debugfile);
 
       *debugfile << "\nAbout to Load Event "<<endl;
@@ -69,7 +69,7 @@ int main(int /* argc */, char** /* argv */)
 }
 
 
-void dump( UInt_t* data, ofstream *debugfile)
+void dump( const UInt_t* data, ofstream *debugfile)
 {
   // Crude event dump
   unsigned evnum = data[4];
@@ -10,7 +10,7 @@
 
 #include "THaVDCSimDecoder.h"
 #include "THaVDCSim.h"
-#include "THaBenchmark.h"
+#include "Profiler.h"
 #include "VarDef.h"
 
 using namespace std;
@@ -110,11 +110,10 @@ int THaVDCSimDecoder::LoadEvent(const UInt_t* evbuffer )
     if (init_slotdata() == HED_ERR) return HED_ERR;
     first_decode = false;
   }
-  if( fDoBench ) fBench->Begin("clearEvent");
+  if( fDoBench ) fBench->Start(kBenchClear);
   Clear();
-  for( auto i : fSlotClear )
-    crateslot[i]->clearEvent();
-  if( fDoBench ) fBench->Stop("clearEvent");
+  ClearSlotData();
+  if( fDoBench ) fBench->Stop(kBenchClear);
 
   evscaler = 0;
 
@@ -126,7 +125,7 @@ int THaVDCSimDecoder::LoadEvent(const UInt_t* evbuffer )
   event_num = simEvent->event_num;
   recent_event = event_num;
 
-  if( fDoBench ) fBench->Begin("physics_decode");
+  if( fDoBench ) fBench->Start(kBenchPhysicsDecode);
 
 
   // Decode the digitized data.  Populate crateslot array.
@@ -158,7 +157,7 @@ int THaVDCSimDecoder::LoadEvent(const UInt_t* evbuffer )
 
   fTracks.assign( simEvent->tracks.begin(), simEvent->tracks.end() );
 
-  if( fDoBench ) fBench->Stop("physics_decode");
+  if( fDoBench ) fBench->Stop(kBenchPhysicsDecode);
 
   // DEBUG:
   //  cout << "SimDecoder: nTracks = " << GetNTracks() << endl;
@@ -23,6 +23,7 @@ class THaVDCSimDecoder : public THaEvData {
 
   void   Clear( Option_t* opt="" );
   Int_t  GetNTracks() const;
+  const std::vector<THaVDCSimTrack>& GetTracks() const { return fTracks; }
   Int_t  DefineVariables( THaAnalysisObject::EMode mode =
 			  THaAnalysisObject::kDefine );
 
@@ -0,0 +1,324 @@
+// VDC tracking benchmark and regression check on simulated data
+//
+// Analyzes one or more files made by vdcsimgen with THaVDCSimDecoder and
+// a left HRS containing only the VDC, and compares the reconstructed
+// tracks with the simulated ones. For each file, reports
+//  - throughput (events/s) and per-event latency of the tracking stages,
+//  - the mean number of hits per wire plane,
+//  - the tracking efficiency, i.e. the fraction of events where the
+//    trigger track was found within the matching window, and
+//  - the RMS residuals of the track parameters at the U1 plane
+// as JSON. Scanning hit multiplicity and noise is done by generating
+// several input files, e.g.
+//    vdcsimgen -s rate2.root  -r 2
+//    vdcsimgen -s noise1.root -c 0.01
+//    vdcsimbench -O report.json rate2.root noise1.root
+// The exit status is 1 if any file fails the -E, -X or -T limits, so
+// that tracking changes can be checked for lost efficiency or precision.
+//
+// Requires the analysis database (db_L.vdc.dat etc.) via $DB_DIR, as
+// for vdcsimgen.
+
+#include "THaVDCSim.h"
+#include "THaVDCSimDecoder.h"
+#include "THaVDCSimRun.h"
+
+#include "THaInterface.h"
+#include "THaGlobals.h"
+#include "THaAnalyzer.h"
+#include "THaHRS.h"
+#include "THaVDC.h"
+#include "THaVDCChamber.h"
+#include "THaVDCPlane.h"
+#include "THaTrack.h"
+#include "InterStageModule.h"
+#include "Profiler.h"
+
+#include "TROOT.h"
+#include "TFile.h"
+#include "TList.h"
+#include "TClonesArray.h"
+#include "TError.h"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <getopt.h>
+
+using namespace std;
+
+//_____________________________________________________________________________
+// Match reconstructed tracks to the simulated trigger track after the
+// Tracking stage and accumulate efficiency, residuals and hit counts
+class VDCTruthCheck : public Podd::InterStageModule {
+public:
+  VDCTruthCheck( THaSpectrometer* spectro, Double_t winx, Double_t winth )
+    : InterStageModule("vdccheck", "VDC truth comparison",
+                       THaAnalyzer::kTracking),
+      fSpectro(spectro), fWinX(winx), fWinTh(winth)
+  { Reset(); }
+
+  virtual Int_t Process( const THaEvData& evdata );
+  void Reset();
+
+  ULong64_t fNev;       // Events with a simulated trigger track
+  ULong64_t fNfound;    // ... of which a track was matched
+  ULong64_t fNtracks;   // Reconstructed tracks, all events
+  ULong64_t fNhits[4];  // Hits in u1, v1, u2, v2
+  Double_t  fSum2[4];   // Sum of squared residuals x, y, th, ph
+
+private:
+  THaSpectrometer* fSpectro;
+  Double_t  fWinX;      // Matching window in x (m)
+  Double_t  fWinTh;     // Matching window in tan(theta)
+};
+
+//_____________________________________________________________________________
+void VDCTruthCheck::Reset()
+{
+  fNev = fNfound = fNtracks = 0;
+  for( int i = 0; i < 4; ++i ) {
+    fNhits[i] = 0;
+    fSum2[i] = 0;
+  }
+}
+
+//_____________________________________________________________________________
+Int_t VDCTruthCheck::Process( const THaEvData& evdata )
+{
+  const auto* sim = dynamic_cast<const THaVDCSimDecoder*>(&evdata);
+  if( !sim )
+    return -1;
+
+  auto* vdc = dynamic_cast<THaVDC*>(fSpectro->GetDetector("vdc"));
+  if( vdc ) {
+    const THaVDCPlane* planes[4] = {
+      vdc->GetLower()->GetUPlane(), vdc->GetLower()->GetVPlane(),
+      vdc->GetUpper()->GetUPlane(), vdc->GetUpper()->GetVPlane()
+    };
+    for( int i = 0; i < 4; ++i )
+      fNhits[i] += planes[i]->GetNHits();
+  }
+
+  const TClonesArray* tracks = fSpectro->GetTracks();
+  Int_t ntr = fSpectro->GetNTracks();
+  fNtracks += ntr;
+  for( const auto& mc : sim->GetTracks() ) {
+    if( mc.type != 0 )
+      continue;
+    ++fNev;
+    // Closest reconstructed track in x within the matching window
+    const THaTrack* best = nullptr;
+    for( Int_t i = 0; i < ntr; ++i ) {
+      const auto* tr = static_cast<const THaTrack*>(tracks->At(i));
+      Double_t dx = tr->GetDX() - mc.TX();
+      if( fabs(dx) > fWinX || fabs(tr->GetDTheta() - mc.TTheta()) > fWinTh )
+        continue;
+      if( !best || fabs(dx) < fabs(best->GetDX() - mc.TX()) )
+        best = tr;
+    }
+    if( best ) {
+      ++fNfound;
+      Double_t d[4] = { best->GetDX() - mc.TX(), best->GetDY() - mc.TY(),
+                        best->GetDTheta() - mc.TTheta(),
+                        best->GetDPhi() - mc.TPhi() };
+      for( int i = 0; i < 4; ++i )
+        fSum2[i] += d[i]*d[i];
+    }
+    break;
+  }
+  fDataValid = true;
+  return 0;
+}
+
+//_____________________________________________________________________________
+static void usage( const char* prgname )
+{
+  cerr << "Usage: " << prgname << " [options] sim1.root [sim2.root ...]"
+       << endl
+       << "  -n <events>   analyze at most this many events per file" << endl
+       << "  -O <file>     JSON report file (default vdcsimbench.json)" << endl
+       << "  -w <x:th>     matching window in x (m) and tan(theta)"
+       << " (default 0.005:0.01)" << endl
+       << "  -E <eff>      fail if efficiency is below this" << endl
+       << "  -X <rms>      fail if x residual RMS (m) exceeds this" << endl
+       << "  -T <rms>      fail if theta residual RMS exceeds this" << endl
+       << "  -v            verbose analyzer output" << endl;
+  exit(255);
+}
+
+//_____________________________________________________________________________
+int main( int argc, char* argv[] )
+{
+  UInt_t nev = 0;
+  Int_t verbose = 0;
+  Double_t winx = 0.005, winth = 0.01, mineff = 0, maxx = 0, maxth = 0;
+  string report = "vdcsimbench.json";
+  int opt;
+  while( (opt = getopt(argc, argv, "n:O:w:E:X:T:vh")) != -1 ) {
+    switch( opt ) {
+    case 'n':
+      nev = strtoul(optarg, nullptr, 0);
+      break;
+    case 'O':
+      report = optarg;
+      break;
+    case 'w':
+      if( sscanf(optarg, "%lf:%lf", &winx, &winth) != 2 )
+        usage(argv[0]);
+      break;
+    case 'E':
+      mineff = atof(optarg);
+      break;
+    case 'X':
+      maxx = atof(optarg);
+      break;
+    case 'T':
+      maxth = atof(optarg);
+      break;
+    case 'v':
+      ++verbose;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if( optind >= argc )
+    usage(argv[0]);
+
+  int rargc = 1;
+  THaInterface theApp("vdcsimbench", &rargc, argv, nullptr, 0, true);
+  gROOT->SetBatch(true);
+  gHaDecoder = THaVDCSimDecoder::Class();
+
+  auto* HRSL = new THaHRS("L", "Left HRS, VDC only");
+  HRSL->AddDetector( new THaVDC("vdc", "Vertical Drift Chamber") );
+  gHaApps->Add( HRSL );
+
+  const string odef = report + ".odef";
+  {
+    ofstream ofs(odef);
+    ofs << "block L.tr.*" << endl << "block MC.tr.*" << endl;
+  }
+
+  THaAnalyzer analyzer;
+  auto* check = new VDCTruthCheck(HRSL, winx, winth);
+  analyzer.AddInterStage(check);  // analyzer takes ownership
+  analyzer.SetOutFile("vdcsimbench.root");
+  analyzer.SetOdefFile(odef.c_str());
+  analyzer.SetVerbosity(verbose);
+  analyzer.EnableLatencyStats();
+
+  ofstream os(report);
+  if( !os ) {
+    ::Error( "vdcsimbench", "Cannot open report file %s", report.c_str() );
+    return 2;
+  }
+  os << "{" << endl
+     << "  \"context\": {" << endl
+     << "    \"version\": \"" << THaInterface::GetVersionString() << "\","
+     << endl
+     << "    \"window_x_m\": " << winx << "," << endl
+     << "    \"window_th\": " << winth << endl
+     << "  }," << endl
+     << "  \"runs\": [";
+
+  int ret = 0;
+  const char* sep = "";
+  for( int i = optind; i < argc; ++i ) {
+    const char* input = argv[i];
+
+    // Simulation conditions, saved by vdcsimgen
+    Double_t noise = -1, rate = -1;
+    {
+      TFile f(input);
+      auto* s = dynamic_cast<THaVDCSimConditions*>(f.Get("s"));
+      if( s ) {
+        noise = s->probWireNoise;
+        rate = s->emissionRate * 1e6;  // kHz
+        delete s;
+      }
+    }
+
+    THaVDCSimRun run(input);
+    if( nev > 0 )
+      run.SetLastEvent(nev);
+    check->Reset();
+    auto start = chrono::steady_clock::now();
+    Int_t nread = analyzer.Process(run);
+    Double_t real_time =
+      chrono::duration<Double_t>(chrono::steady_clock::now() - start).count();
+    if( nread <= 0 ) {
+      ::Error( "vdcsimbench", "Analysis of %s failed", input );
+      ret = 3;
+      break;
+    }
+
+    Double_t eff = check->fNev ? Double_t(check->fNfound) / check->fNev : 0;
+    Double_t rms[4];
+    for( int k = 0; k < 4; ++k )
+      rms[k] = check->fNfound ? sqrt(check->fSum2[k] / check->fNfound) : 0;
+    bool pass = eff >= mineff && (maxx <= 0 || rms[0] <= maxx) &&
+                (maxth <= 0 || rms[2] <= maxth);
+    if( !pass )
+      ret = 1;
+
+    os << sep << endl
+       << "    {" << endl
+       << "      \"input\": \"" << input << "\"," << endl
+       << "      \"prob_wire_noise\": " << noise << "," << endl
+       << "      \"emission_rate_khz\": " << rate << "," << endl
+       << "      \"events\": " << nread << "," << endl
+       << "      \"events_per_second\": " << nread / real_time << "," << endl
+       << "      \"mean_hits\": [";
+    for( int k = 0; k < 4; ++k )
+      os << (k ? ", " : "") << Double_t(check->fNhits[k]) / nread;
+    os << "]," << endl
+       << "      \"mean_tracks\": " << Double_t(check->fNtracks) / nread << ","
+       << endl;
+
+    // Time of the tracking stages, and of the VDC (apparatus "L") in them
+    const Podd::Profiler* prof = analyzer.GetProfiler();
+    auto total = prof->Find("Total");
+    for( const char* name : { "CoarseTracking", "Tracking" } ) {
+      auto h = prof->Find(name, total);
+      if( h == Podd::Profiler::kNoParent )
+        continue;
+      auto hl = prof->Find("L", h);
+      const Podd::LatencyHistogram* lat = prof->GetLatency(h);
+      os << "      \"" << name << "\": { \"real_time_s\": "
+         << prof->GetRealTime(h);
+      if( hl != Podd::Profiler::kNoParent )
+        os << ", \"vdc_time_s\": " << prof->GetRealTime(hl);
+      if( lat && lat->GetCount() > 0 )
+        os << ", \"p50_ns\": " << lat->GetPercentile(50)
+           << ", \"p99_ns\": " << lat->GetPercentile(99)
+           << ", \"max_ns\": " << lat->GetMax();
+      os << " }," << endl;
+    }
+
+    os << "      \"efficiency\": " << eff << "," << endl
+       << "      \"rms_x_m\": " << rms[0] << "," << endl
+       << "      \"rms_y_m\": " << rms[1] << "," << endl
+       << "      \"rms_th\": " << rms[2] << "," << endl
+       << "      \"rms_ph\": " << rms[3] << "," << endl
+       << "      \"pass\": " << (pass ? "true" : "false") << endl
+       << "    }";
+    sep = ",";
+
+    cout << input << ": " << nread / real_time << " events/s, efficiency "
+         << eff << ", x rms " << rms[0] << " m"
+         << (pass ? "" : "  FAILED") << endl;
+
+    // Start from scratch (timers, database) for the next file
+    analyzer.Close();
+  }
+  os << endl << "  ]" << endl << "}" << endl;
+
+  return ret;
+}
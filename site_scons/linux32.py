@@ -11,6 +11,8 @@ def config(env,args):
         env.Append(CPPDEFINES= 'NDEBUG')
 
     env.Append(CPPDEFINES= 'WITH_DEBUG')
+    if int(args.get('trace',0)):
+        env.Append(CPPDEFINES= 'DECODER_TRACE')
 
     env.Append(CXXFLAGS = env.Split('-m32 -Wall -fPIC'))
     env.Append(CPPDEFINES = 'LINUXVERS')
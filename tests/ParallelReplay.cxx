@@ -0,0 +1,353 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// ParallelReplay - Regression test for multithreaded replays                //
+//                                                                           //
+// Replays the same run twice, first single-threaded, then with the given   //
+// number of threads (THaAnalyzer::SetNumThreads and EnableParallelApps),   //
+// and verifies that the results are identical:                             //
+//                                                                           //
+//  - all trees in the two output files (the event tree, scaler and EPICS   //
+//    trees, etc.) are compared entry by entry and leaf by leaf,            //
+//  - the pass/fail counts of all cuts (THaCutList summary) are compared.   //
+//                                                                           //
+// The first differing tree entry, and its event number if the tree has     //
+// an event header, is reported along with the speedup of the parallel      //
+// replay. The analyzer and modules must be set up as for a normal replay.  //
+// The analyzer's output file name and thread settings are restored         //
+// afterwards.                                                              //
+//                                                                           //
+// Test() returns 0 if the replays agree, 1 if the trees differ, 2 if only  //
+// the cut statistics differ, and a negative value on setup errors.         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ParallelReplay.h"
+#include "THaAnalyzer.h"
+#include "THaRunBase.h"
+#include "THaCutList.h"
+#include "THaCut.h"
+#include "THaGlobals.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TLeaf.h"
+#include "TLeafC.h"
+#include "TObjArray.h"
+#include "TKey.h"
+#include "TClass.h"
+#include "TStopwatch.h"
+#include "TMath.h"
+#include <iostream>
+#include <memory>
+#include <set>
+#include <vector>
+#include <cstring>
+
+using namespace std;
+
+namespace Podd {
+namespace Tests {
+
+//_____________________________________________________________________________
+ParallelReplay::ParallelReplay( const char* name, const char* description ) :
+  UnitTest(name,description), fRun(nullptr), fNThreads(4),
+  fFileS("replay_serial.root"), fFileP("replay_parallel.root"),
+  fTimeS(0), fTimeP(0), fFirstDiff(-1), fFirstDiffEvt(0), fNDiffs(0)
+{
+  // Constructor
+}
+
+//_____________________________________________________________________________
+ParallelReplay::~ParallelReplay() = default;
+
+//_____________________________________________________________________________
+void ParallelReplay::SetOutputFiles( const char* serial, const char* parallel )
+{
+  // Set the names of the output files of the two replays
+
+  fFileS = serial;
+  fFileP = parallel;
+}
+
+//_____________________________________________________________________________
+Double_t ParallelReplay::GetSpeedup() const
+{
+  // Real time of the serial replay divided by that of the parallel one
+
+  return (fTimeP > 0) ? fTimeS/fTimeP : 0;
+}
+
+//_____________________________________________________________________________
+Int_t ParallelReplay::Replay( THaAnalyzer* analyzer, UInt_t nthreads,
+                              const char* file, Double_t& time,
+                              CutStats_t& cuts )
+{
+  // Replay fRun with 'nthreads' threads into 'file'. Return the real time
+  // taken and the statistics of all cuts.
+
+  analyzer->SetNumThreads(nthreads);
+  analyzer->EnableParallelApps(nthreads > 1);
+  analyzer->SetOutFile(file);
+
+  TStopwatch timer;
+  Int_t ret = analyzer->Process(fRun);
+  timer.Stop();
+  time = timer.RealTime();
+
+  cuts.clear();
+  if( ret >= 0 && gHaCuts ) {
+    TIter next( gHaCuts->GetCutList() );
+    while( auto* cut = static_cast<THaCut*>(next()) )
+      cuts[cut->GetName()] = make_pair(cut->GetNCalled(), cut->GetNPassed());
+  }
+  analyzer->Close();
+  return ret;
+}
+
+//_____________________________________________________________________________
+Int_t ParallelReplay::CompareCuts()
+{
+  // Compare the cut statistics of the two replays. Returns the number of
+  // cuts that differ.
+
+  Int_t ndiff = 0;
+  for( const auto& cs : fCutsS ) {
+    auto cp = fCutsP.find(cs.first);
+    if( cp == fCutsP.end() ) {
+      Error( Here("CompareCuts"), "Cut %s missing in parallel replay",
+             cs.first.Data() );
+      ++ndiff;
+    } else if( cp->second != cs.second ) {
+      Error( Here("CompareCuts"), "Cut %s: called/passed = %u/%u serial, "
+             "%u/%u parallel", cs.first.Data(), cs.second.first,
+             cs.second.second, cp->second.first, cp->second.second );
+      ++ndiff;
+    }
+  }
+  for( const auto& cp : fCutsP ) {
+    if( fCutsS.find(cp.first) == fCutsS.end() ) {
+      Error( Here("CompareCuts"), "Cut %s missing in serial replay",
+             cp.first.Data() );
+      ++ndiff;
+    }
+  }
+  return ndiff;
+}
+
+//_____________________________________________________________________________
+Int_t ParallelReplay::CompareTrees( TTree* ts, TTree* tp )
+{
+  // Compare trees 'ts' (serial) and 'tp' (parallel) entry by entry and
+  // leaf by leaf. Returns the number of differing entries.
+
+  const char* const here = "CompareTrees";
+  const char* tname = ts->GetName();
+
+  // Pair up the leaves of the two trees
+  vector<pair<TLeaf*,TLeaf*>> leaves;
+  TIter next( ts->GetListOfLeaves() );
+  while( auto* ls = static_cast<TLeaf*>(next()) ) {
+    TLeaf* lp = tp->GetLeaf(ls->GetBranch()->GetName(), ls->GetName());
+    if( !lp ) {
+      Error( Here(here), "Tree %s: leaf %s missing in parallel replay",
+             tname, ls->GetName() );
+      return 1;
+    }
+    leaves.emplace_back(ls, lp);
+  }
+  if( tp->GetListOfLeaves()->GetSize() != (Int_t)leaves.size() ) {
+    Error( Here(here), "Tree %s: %d leaves in parallel replay, %d in serial",
+           tname, tp->GetListOfLeaves()->GetSize(), (Int_t)leaves.size() );
+    return 1;
+  }
+  Long64_t nentries = ts->GetEntries();
+  if( tp->GetEntries() != nentries ) {
+    Error( Here(here), "Tree %s: %lld entries in parallel replay, %lld in "
+           "serial", tname, tp->GetEntries(), nentries );
+    // Compare the common entries anyway to find the first difference
+    nentries = TMath::Min(nentries, tp->GetEntries());
+  }
+  TLeaf* evnum = ts->FindLeaf("fEvtHdr.fEvtNum");
+
+  Long64_t ndiff = 0;
+  for( Long64_t i = 0; i < nentries; ++i ) {
+    ts->GetEntry(i);
+    tp->GetEntry(i);
+    const TLeaf* bad = nullptr;
+    Int_t ibad = 0;
+    Double_t vs = 0, vp = 0;
+    for( const auto& lsp : leaves ) {
+      TLeaf* ls = lsp.first, *lp = lsp.second;
+      Int_t len = ls->GetLen();
+      if( lp->GetLen() != len ) {
+        bad = ls; ibad = -1; vs = len; vp = lp->GetLen();
+        break;
+      }
+      if( ls->InheritsFrom(TLeafC::Class()) ) {
+        const char* ss = static_cast<const char*>(ls->GetValuePointer());
+        const char* sp = static_cast<const char*>(lp->GetValuePointer());
+        if( ss && sp && strcmp(ss,sp) != 0 ) {
+          bad = ls;
+          break;
+        }
+        continue;
+      }
+      for( Int_t j = 0; j < len; ++j ) {
+        vs = ls->GetValue(j); vp = lp->GetValue(j);
+        // Results must agree exactly. NaNs agree with each other.
+        if( vs != vp && !(TMath::IsNaN(vs) && TMath::IsNaN(vp)) ) {
+          bad = ls; ibad = j;
+          break;
+        }
+      }
+      if( bad )
+        break;
+    }
+    if( !bad )
+      continue;
+    if( ndiff++ == 0 ) {
+      UInt_t evt = evnum ? static_cast<UInt_t>(evnum->GetValue()) : 0;
+      if( ibad < 0 )
+        Error( Here(here), "Tree %s: first difference at entry %lld "
+               "(event %u), leaf %s length %g serial, %g parallel",
+               tname, i, evt, bad->GetName(), vs, vp );
+      else
+        Error( Here(here), "Tree %s: first difference at entry %lld "
+               "(event %u), leaf %s[%d] = %.17g serial, %.17g parallel",
+               tname, i, evt, bad->GetName(), ibad, vs, vp );
+      if( fFirstDiff < 0 || i < fFirstDiff ) {
+        fFirstDiff = i;
+        fFirstDiffEvt = evt;
+      }
+    }
+  }
+  if( ndiff == 0 && ts->GetEntries() != tp->GetEntries() )
+    ndiff = 1;
+  return (ndiff > kMaxInt) ? kMaxInt : static_cast<Int_t>(ndiff);
+}
+
+//_____________________________________________________________________________
+Int_t ParallelReplay::CompareFiles()
+{
+  // Compare all trees in the two output files. Returns the total number
+  // of differing entries, or -1 if a file cannot be opened.
+
+  const char* const here = "CompareFiles";
+
+  unique_ptr<TFile> fs( TFile::Open(fFileS) ), fp( TFile::Open(fFileP) );
+  if( !fs || fs->IsZombie() || !fp || fp->IsZombie() ) {
+    Error( Here(here), "Cannot open output files %s and %s",
+           fFileS.Data(), fFileP.Data() );
+    return -1;
+  }
+
+  // Collect the names of the trees in both files (one cycle each)
+  set<TString> trees;
+  for( auto* file : { fs.get(), fp.get() } ) {
+    TIter next( file->GetListOfKeys() );
+    while( auto* key = static_cast<TKey*>(next()) ) {
+      TClass* cl = TClass::GetClass(key->GetClassName());
+      if( cl && cl->InheritsFrom(TTree::Class()) )
+        trees.insert(key->GetName());
+    }
+  }
+
+  Int_t ndiff = 0;
+  for( const auto& name : trees ) {
+    auto* ts = static_cast<TTree*>(fs->Get(name));
+    auto* tp = static_cast<TTree*>(fp->Get(name));
+    if( !ts || !tp ) {
+      Error( Here(here), "Tree %s missing in %s replay",
+             name.Data(), ts ? "parallel" : "serial" );
+      ++ndiff;
+      continue;
+    }
+    Int_t n = CompareTrees(ts, tp);
+    if( fDebug > 0 )
+      Info( Here(here), "Tree %s: %lld entries, %d differ",
+            name.Data(), ts->GetEntries(), n );
+    ndiff += n;
+  }
+  return ndiff;
+}
+
+//_____________________________________________________________________________
+Int_t ParallelReplay::Test()
+{
+  // Run the serial and the parallel replay and compare their results
+
+  const char* const here = "Test";
+
+  if( !fRun ) {
+    Error( Here(here), "No run set. Call SetRun() first." );
+    return -1;
+  }
+  if( fNThreads < 2 ) {
+    Error( Here(here), "Parallel replay needs at least 2 threads, got %u",
+           fNThreads );
+    return -1;
+  }
+  if( fFileS == fFileP ) {
+    Error( Here(here), "Output files of serial and parallel replay must "
+           "differ" );
+    return -1;
+  }
+
+  // Use the configured analyzer, if any, else a default one
+  unique_ptr<THaAnalyzer> local;
+  THaAnalyzer* analyzer = THaAnalyzer::GetInstance();
+  if( !analyzer ) {
+    local.reset( new THaAnalyzer );
+    analyzer = local.get();
+  }
+  TString outfile = analyzer->GetOutFileName();
+  UInt_t nthreads = analyzer->GetNumThreads();
+  Bool_t parallel = analyzer->ParallelAppsEnabled();
+
+  fTimeS = fTimeP = 0;
+  fFirstDiff = -1;
+  fFirstDiffEvt = 0;
+  fNDiffs = 0;
+  Int_t ret = Replay(analyzer, 1, fFileS, fTimeS, fCutsS);
+  if( ret >= 0 )
+    ret = Replay(analyzer, fNThreads, fFileP, fTimeP, fCutsP);
+
+  analyzer->SetOutFile(outfile);
+  analyzer->SetNumThreads(nthreads);
+  analyzer->EnableParallelApps(parallel);
+
+  if( ret < 0 ) {
+    Error( Here(here), "Replay failed with code %d", ret );
+    return -2;
+  }
+
+  Int_t ntree = CompareFiles();
+  if( ntree < 0 )
+    return -3;
+  fNDiffs = ntree;
+  Int_t ncut = CompareCuts();
+
+  cout << "Serial vs. " << fNThreads << "-thread replay of run "
+       << fRun->GetNumber() << ":" << endl;
+  cout << "  Real time:       " << fTimeS << " s serial, " << fTimeP
+       << " s parallel, speedup " << GetSpeedup() << endl;
+  cout << "  Tree entries differing: " << fNDiffs;
+  if( fFirstDiff >= 0 )
+    cout << ", first at entry " << fFirstDiff << " (event "
+         << fFirstDiffEvt << ")";
+  cout << endl;
+  cout << "  Cuts differing:         " << ncut << " of " << fCutsS.size()
+       << endl;
+
+  if( ntree > 0 )
+    return 1;
+  if( ncut > 0 )
+    return 2;
+  return 0;
+}
+
+} // namespace Tests
+} // namespace Podd
+
+////////////////////////////////////////////////////////////////////////////////
+
+ClassImp(Podd::Tests::ParallelReplay)
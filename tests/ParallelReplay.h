@@ -0,0 +1,72 @@
+#ifndef Podd_Tests_ParallelReplay_h_
+#define Podd_Tests_ParallelReplay_h_
+
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// ParallelReplay regression test                                            //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include "UnitTest.h"
+#include "TString.h"
+#include <map>
+#include <utility>
+
+class THaRunBase;
+class THaAnalyzer;
+class TTree;
+
+namespace Podd {
+namespace Tests {
+
+class ParallelReplay : public UnitTest {
+
+public:
+  explicit ParallelReplay( const char* name = "parallel_replay",
+                           const char* description =
+                           "Serial vs. parallel replay regression test" );
+  virtual ~ParallelReplay();
+
+  virtual Int_t Test();
+
+  void        SetRun( THaRunBase* run )    { fRun = run; }
+  void        SetNumThreads( UInt_t n )     { fNThreads = n; }
+  void        SetOutputFiles( const char* serial, const char* parallel );
+
+  Double_t    GetSpeedup()      const;
+  Long64_t    GetFirstDiff()    const { return fFirstDiff; }
+  UInt_t      GetFirstDiffEvt() const { return fFirstDiffEvt; }
+  Long64_t    GetNDiffs()       const { return fNDiffs; }
+
+protected:
+
+  // Cut name -> (number of times called, number passed)
+  typedef std::map<TString, std::pair<UInt_t,UInt_t>> CutStats_t;
+
+  THaRunBase* fRun;          // Run to replay (not owned)
+  UInt_t      fNThreads;     // Number of threads of parallel replay
+  TString     fFileS;        // Output file of serial replay
+  TString     fFileP;        // Output file of parallel replay
+  Double_t    fTimeS;        // Real time of serial replay (s)
+  Double_t    fTimeP;        // Real time of parallel replay (s)
+  Long64_t    fFirstDiff;    // First differing tree entry (-1: none)
+  UInt_t      fFirstDiffEvt; // Event number of fFirstDiff, if known
+  Long64_t    fNDiffs;       // Number of differing entries, all trees
+  CutStats_t  fCutsS;        // Cut statistics of serial replay
+  CutStats_t  fCutsP;        // Cut statistics of parallel replay
+
+  Int_t  Replay( THaAnalyzer* analyzer, UInt_t nthreads, const char* file,
+                 Double_t& time, CutStats_t& cuts );
+  Int_t  CompareCuts();
+  Int_t  CompareFiles();
+  Int_t  CompareTrees( TTree* ts, TTree* tp );
+
+  ClassDef(ParallelReplay,0)   // Serial vs. parallel replay test
+};
+
+} // namespace Tests
+} // namespace Podd
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
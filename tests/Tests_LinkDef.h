@@ -6,5 +6,6 @@
 
 #pragma link C++ class Podd::Tests::UnitTest+;
 #pragma link C++ class Podd::Tests::ArrayRTTI+;
+#pragma link C++ class Podd::Tests::ParallelReplay+;
 
 #endif